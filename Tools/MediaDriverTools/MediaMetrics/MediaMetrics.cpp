@@ -0,0 +1,259 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      MediaMetrics.cpp
+//! \brief     Reads the metrics a running media driver publishes in shared memory
+//! \details   The driver publishes its segment when the "Media Metrics Export"
+//!            user feature is set.
+//!            media_metrics                 list the processes publishing metrics
+//!            media_metrics -p pid          print the metrics of a process
+//!            media_metrics -p pid -i sec   print the rates every sec seconds
+//!            media_metrics -c              remove segments of exited processes
+//!
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "mos_metrics.h"
+
+static const char *SHM_DIR = "/dev/shm";
+
+static void PrintUsage()
+{
+    printf("Usage: media_metrics [-c] [-p pid [-i seconds]]\n");
+    printf("  no option     list the processes publishing metrics\n");
+    printf("  -p pid        print the metrics of a process\n");
+    printf("  -i seconds    with -p, print the activity of each interval until the process exits\n");
+    printf("  -c            remove segments left by processes that exited\n");
+}
+
+static bool IsProcessAlive(int32_t pid)
+{
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+//!
+//! \brief    Call func with the pid of every segment in the shared memory directory
+//!
+template <typename Func>
+static void ForEachSegment(Func func)
+{
+    // Name without the leading '/'
+    const char *prefix    = MOS_METRICS_SHM_PREFIX + 1;
+    size_t      prefixLen = strlen(prefix);
+
+    DIR *dir = opendir(SHM_DIR);
+    if (dir == nullptr)
+    {
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (strncmp(entry->d_name, prefix, prefixLen) == 0)
+        {
+            func(atoi(entry->d_name + prefixLen));
+        }
+    }
+    closedir(dir);
+}
+
+static const MOS_METRICS_SEGMENT *OpenSegment(int32_t pid)
+{
+    char name[64];
+    snprintf(name, sizeof(name), MOS_METRICS_SHM_PREFIX "%d", pid);
+
+    int32_t fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Process %d does not publish metrics\n", pid);
+        return nullptr;
+    }
+
+    void *addr = mmap(nullptr, sizeof(MOS_METRICS_SEGMENT), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        fprintf(stderr, "Failed to map the metrics of process %d\n", pid);
+        return nullptr;
+    }
+
+    const MOS_METRICS_SEGMENT *segment = (const MOS_METRICS_SEGMENT *)addr;
+    if (__atomic_load_n(&segment->magic, __ATOMIC_ACQUIRE) != MOS_METRICS_MAGIC ||
+        segment->version   != MOS_METRICS_VERSION   ||
+        segment->metricNum != MOS_METRIC_NUM        ||
+        segment->bucketNum != MOS_METRICS_BUCKET_NUM ||
+        segment->shardNum  != MOS_METRICS_SHARD_NUM)
+    {
+        fprintf(stderr, "Metrics of process %d have an unknown layout\n", pid);
+        munmap(addr, sizeof(MOS_METRICS_SEGMENT));
+        return nullptr;
+    }
+
+    return segment;
+}
+
+//!
+//! \brief    Print the difference of two snapshots
+//! \param    [in] cur
+//!           Newer snapshot
+//! \param    [in] prev
+//!           Older snapshot, all zero to print the totals
+//! \param    [in] seconds
+//!           Time between the snapshots
+//!
+static void PrintMetrics(const MOS_METRICS_SHARD *cur, const MOS_METRICS_SHARD *prev, double seconds)
+{
+    printf("%-22s %12s %10s %10s %10s %10s %10s\n",
+        "metric", "count", "per sec", "avg us", "p50 us", "p99 us", "max us");
+
+    for (uint32_t id = 0; id < MOS_METRIC_NUM; id++)
+    {
+        uint64_t count = cur->count[id] - prev->count[id];
+        if (count == 0)
+        {
+            continue;
+        }
+
+        uint64_t histogram[MOS_METRICS_BUCKET_NUM];
+        uint64_t timed = 0;
+        int32_t  top   = -1;
+        for (uint32_t b = 0; b < MOS_METRICS_BUCKET_NUM; b++)
+        {
+            histogram[b] = cur->histogram[id][b] - prev->histogram[id][b];
+            timed       += histogram[b];
+            top          = histogram[b] ? (int32_t)b : top;
+        }
+
+        printf("%-22s %12llu %10.1f", g_mosMetricNames[id], (unsigned long long)count, count / seconds);
+        if (timed)
+        {
+            printf(" %10.2f %10.2f %10.2f %10.2f\n",
+                (cur->totalNs[id] - prev->totalNs[id]) / 1000.0 / timed,
+                MosMetrics_GetPercentile(histogram, 50) / 1000.0,
+                MosMetrics_GetPercentile(histogram, 99) / 1000.0,
+                ((2ull << top) - 1) / 1000.0);
+        }
+        else
+        {
+            printf("\n");
+        }
+    }
+}
+
+static uint64_t GetTimeNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int main(int argc, char *argv[])
+{
+    int32_t pid      = 0;
+    int32_t interval = 0;
+    bool    clean    = false;
+    int32_t opt;
+
+    while ((opt = getopt(argc, argv, "p:i:ch")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+                pid = atoi(optarg);
+                break;
+            case 'i':
+                interval = atoi(optarg);
+                break;
+            case 'c':
+                clean = true;
+                break;
+            default:
+                PrintUsage();
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (clean)
+    {
+        ForEachSegment([](int32_t segmentPid) {
+            if (!IsProcessAlive(segmentPid))
+            {
+                char name[64];
+                snprintf(name, sizeof(name), MOS_METRICS_SHM_PREFIX "%d", segmentPid);
+                shm_unlink(name);
+                printf("Removed metrics of exited process %d\n", segmentPid);
+            }
+        });
+        return 0;
+    }
+
+    if (pid == 0)
+    {
+        ForEachSegment([](int32_t segmentPid) {
+            printf("%d%s\n", segmentPid, IsProcessAlive(segmentPid) ? "" : " (exited)");
+        });
+        return 0;
+    }
+
+    const MOS_METRICS_SEGMENT *segment = OpenSegment(pid);
+    if (segment == nullptr)
+    {
+        return 1;
+    }
+
+    MOS_METRICS_SHARD prev, cur;
+    memset(&prev, 0, sizeof(prev));
+    MosMetrics_Merge(segment, &cur);
+
+    if (interval <= 0)
+    {
+        double seconds = (GetTimeNs() - segment->startNs) / 1e9;
+        printf("Process %d, %.1f s since export\n", pid, seconds);
+        PrintMetrics(&cur, &prev, seconds > 0 ? seconds : 1);
+        return 0;
+    }
+
+    uint64_t prevNs = GetTimeNs();
+    while (IsProcessAlive(pid))
+    {
+        sleep(interval);
+
+        prev = cur;
+        MosMetrics_Merge(segment, &cur);
+        uint64_t curNs = GetTimeNs();
+
+        printf("\nProcess %d, last %.1f s\n", pid, (curNs - prevNs) / 1e9);
+        PrintMetrics(&cur, &prev, (curNs - prevNs) / 1e9);
+        prevNs = curNs;
+    }
+
+    return 0;
+}
@@ -63,7 +63,7 @@ struct CM_SET_CAPS
 
 namespace CMRT_UMD
 {
-CSync CmDeviceRT::m_globalCriticalSectionSurf2DUserDataLock = CSync();
+CSync CmDeviceRT::m_globalCriticalSectionSurf2DUserDataLock("CmSurface2DUserData");
 
 //*-----------------------------------------------------------------------------
 //| Purpose:    Create Cm Device
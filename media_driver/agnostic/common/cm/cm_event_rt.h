@@ -164,7 +164,7 @@ protected:
     CM_HAL_SURFACE_ENTRY_INFO_ARRAYS m_surEntryInfoArrays;
     CmTaskInternal *m_task;
 
-    CSync m_criticalSectionQuery;
+    CSync m_criticalSectionQuery{"CmEventQuery"};
 
     //Vtune call back
     EventCallBackFunction m_callbackFunction;  //CallBack Function
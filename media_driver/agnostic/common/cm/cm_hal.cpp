@@ -10218,7 +10218,7 @@ MOS_STATUS HalCm_Create(
     CM_CHK_NULL_RETURN_MOSSTATUS(state->perfProfiler);
     CM_CHK_MOSSTATUS(state->perfProfiler->Initialize((void*)state, state->osInterface));
 
-    state->criticalSectionDSH = MOS_New(CMRT_UMD::CSync);
+    state->criticalSectionDSH = MOS_New(CMRT_UMD::CSync, "CmHalDsh");
     CM_CHK_NULL_RETURN_MOSSTATUS(state->criticalSectionDSH);
 
     state->cmDeviceParam.maxKernelsPerTask        = CM_MAX_KERNELS_PER_TASK;
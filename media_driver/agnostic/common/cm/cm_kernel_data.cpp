@@ -64,6 +64,39 @@ int32_t CmKernelData::Create( CmKernelRT* kernel, CmKernelData*& kernelData )
     return result;
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Create a copy of a kernel data which is still held by a task.
+//|             The copy is idle so that the kernel can patch the arguments
+//|             changed since the source was built instead of recreating it.
+//| Returns:    Result of the operation.
+//*-----------------------------------------------------------------------------
+int32_t CmKernelData::Clone( CmKernelData* source, CmKernelData*& kernelData )
+{
+    if(!source)
+    {
+        CM_ASSERTMESSAGE("Error: Invalid source kernel data.");
+        return CM_NULL_POINTER;
+    }
+
+    int32_t result = Create( source->m_kernel, kernelData );
+    if( result != CM_SUCCESS )
+    {
+        return result;
+    }
+
+    result = kernelData->CopyHalKernelParam( source->m_halKernelParam );
+    if( result != CM_SUCCESS )
+    {
+        CmKernelData::Destroy( kernelData );
+        return result;
+    }
+
+    kernelData->m_kerneldatasize = source->m_kerneldatasize;
+    kernelData->m_isInUse        = false; // not handed to a task yet
+
+    return CM_SUCCESS;
+}
+
 //*-----------------------------------------------------------------------------
 //| Purpose:    Destroy CM Kernel Data
 //| Returns:    Result of the operation.
@@ -128,6 +161,105 @@ CmKernelData::~CmKernelData( void )
     MosSafeDelete(m_halKernelParam.samplerHeap);
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Duplicate an array owned by a HAL kernel param
+//| Returns:    Result of the operation.
+//*-----------------------------------------------------------------------------
+template <typename T>
+static int32_t DuplicateArray( T *&dst, const T *src, uint32_t count )
+{
+    dst = nullptr;
+    if( src == nullptr || count == 0 )
+    {
+        return CM_SUCCESS;
+    }
+
+    dst = MOS_NewArray( T, count );
+    if( dst == nullptr )
+    {
+        return CM_OUT_OF_HOST_MEMORY;
+    }
+    CmFastMemCopy( dst, src, count * sizeof( T ) );
+
+    return CM_SUCCESS;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Deep copy of a HAL kernel param. The sampler heap is not copied,
+//|             it is rebuilt by the kernel when the copy is updated.
+//| Returns:    Result of the operation.
+//*-----------------------------------------------------------------------------
+int32_t CmKernelData::CopyHalKernelParam( const CM_HAL_KERNEL_PARAM& source )
+{
+    int32_t                          result       = CM_SUCCESS;
+    std::list<SamplerParam>          *samplerHeap = m_halKernelParam.samplerHeap;
+    PCM_HAL_KERNEL_THREADSPACE_PARAM threadSpace  = &m_halKernelParam.kernelThreadSpaceParam;
+    // numArgs already counts the GPGPU walker implicit args of pre-3.3 CISA
+    // kernels, see CmKernelRT::CreateKernelDataInternal
+    uint32_t                         lastArg      = minimum( source.numArgs, CM_MAX_ARGS_PER_KERNEL );
+
+    CmFastMemCopy( &m_halKernelParam, &source, sizeof( CM_HAL_KERNEL_PARAM ) );
+    m_halKernelParam.samplerHeap = samplerHeap;
+
+    // Drop the pointers owned by the source before duplicating, so that a
+    // partial copy is released by the destructor
+    for( uint32_t i = 0; i < CM_MAX_ARGS_PER_KERNEL; i++ )
+    {
+        m_halKernelParam.argParams[i].firstValue = nullptr;
+    }
+    m_halKernelParam.indirectDataParam.indirectData  = nullptr;
+    m_halKernelParam.indirectDataParam.surfaceInfo   = nullptr;
+    threadSpace->dispatchInfo.numThreadsInWave       = nullptr;
+    threadSpace->threadCoordinates                   = nullptr;
+    m_halKernelParam.movInsData                      = nullptr;
+
+    for( uint32_t i = 0; i < lastArg && result == CM_SUCCESS; i++ )
+    {
+        const CM_HAL_KERNEL_ARG_PARAM &arg  = source.argParams[i];
+        uint32_t                      size = arg.unitCount * arg.unitSize;
+
+        if( arg.kind == CM_ARGUMENT_IMPLICT_LOCALSIZE ||
+            arg.kind == CM_ARGUMENT_IMPLICT_GROUPSIZE ||
+            arg.kind == CM_ARGUMENT_IMPLICIT_LOCALID )
+        {
+            size = 3 * sizeof( uint32_t );
+        }
+        result = DuplicateArray( m_halKernelParam.argParams[i].firstValue, arg.firstValue, size );
+    }
+
+    if( result == CM_SUCCESS )
+    {
+        result = DuplicateArray( m_halKernelParam.indirectDataParam.indirectData,
+                                 source.indirectDataParam.indirectData,
+                                 (uint32_t)source.indirectDataParam.indirectDataSize );
+    }
+    if( result == CM_SUCCESS )
+    {
+        result = DuplicateArray( m_halKernelParam.indirectDataParam.surfaceInfo,
+                                 source.indirectDataParam.surfaceInfo,
+                                 (uint32_t)source.indirectDataParam.surfaceCount );
+    }
+    if( result == CM_SUCCESS )
+    {
+        result = DuplicateArray( threadSpace->dispatchInfo.numThreadsInWave,
+                                 source.kernelThreadSpaceParam.dispatchInfo.numThreadsInWave,
+                                 source.kernelThreadSpaceParam.dispatchInfo.numWaves );
+    }
+    if( result == CM_SUCCESS )
+    {
+        result = DuplicateArray( threadSpace->threadCoordinates,
+                                 source.kernelThreadSpaceParam.threadCoordinates,
+                                 (uint32_t)source.kernelThreadSpaceParam.threadSpaceWidth *
+                                 source.kernelThreadSpaceParam.threadSpaceHeight );
+    }
+    if( result == CM_SUCCESS )
+    {
+        result = DuplicateArray( m_halKernelParam.movInsData, source.movInsData, source.movInsDataSize );
+    }
+
+    return result;
+}
+
 //*-----------------------------------------------------------------------------
 //| Purpose:    Do nothing in initialization
 //| Returns:    CM_SUCCESS
@@ -39,6 +39,7 @@ class CmKernelData : public CmDynamicArray
 public:
 
     static int32_t Create( CmKernelRT* kernel, CmKernelData*& kernelData );
+    static int32_t Clone( CmKernelData* source, CmKernelData*& kernelData );
     static int32_t Destroy( CmKernelData* &kernelData );
 
     int32_t GetCmKernel( CmKernelRT*& kernel );
@@ -59,6 +60,8 @@ protected:
 
     int32_t Initialize( void );
 
+    int32_t CopyHalKernelParam( const CM_HAL_KERNEL_PARAM& source );
+
     uint32_t     m_kerneldatasize;
     CmKernelRT*  m_kernel;
     uint32_t     m_refCount;
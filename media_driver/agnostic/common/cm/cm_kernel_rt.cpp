@@ -495,7 +495,12 @@ int32_t CmKernelRT::Initialize( const char* kernelName, const char* options )
             CM_ASSERTMESSAGE("Error: Invalid VISA.");
             return CM_INVALID_COMMON_ISA;
         }
-        kernelBody = isaFile->getKernelsData().at(m_kernelIndexInProgram);
+        kernelBody = isaFile->getKernelBody(m_kernelIndexInProgram);
+        if (!kernelBody)
+        {
+            CM_ASSERTMESSAGE("Error: Invalid VISA kernel body.");
+            return CM_INVALID_COMMON_ISA;
+        }
     }
 
     uint8_t *buf = (uint8_t*)commonISACode;
@@ -3388,6 +3393,49 @@ int32_t CmKernelRT::IsKernelDataReusable( CmThreadSpaceRT* threadSpace)
     return true;
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Check if only kernel/thread args changed since the last kernel
+//|             data, so that a copy of it can be patched argument by argument
+//| Returns:    true if the last kernel data can be cloned and updated
+//*-----------------------------------------------------------------------------
+bool CmKernelRT::IsKernelDataClonable( CmThreadSpaceRT* threadSpace)
+{
+    const uint32_t argDirty = CM_KERNEL_DATA_KERNEL_ARG_DIRTY |
+                              CM_KERNEL_DATA_THREAD_ARG_DIRTY |
+                              CM_KERNEL_DATA_GLOBAL_SURFACE_DIRTY;
+
+    if(threadSpace && threadSpace->GetDirtyStatus() != CM_THREAD_SPACE_CLEAN)
+    {
+        return false;
+    }
+
+    if(m_threadSpace && m_threadSpace->GetDirtyStatus() != CM_THREAD_SPACE_CLEAN)
+    {
+        return false;
+    }
+
+    return (m_dirty & ~argDirty) == 0;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Copy the last kernel data, which is held by a task not flushed
+//|             yet. The copy is updated with the dirty args by the caller.
+//| Returns:    Result of the operation.
+//*-----------------------------------------------------------------------------
+int32_t CmKernelRT::CloneLastKernelData(
+    CmKernelData* & kernelData,  // out
+    uint32_t& kernelDataSize )        // out
+{
+    int32_t hr = CM_SUCCESS;
+
+    CMCHK_NULL(m_lastKernelData);
+    CMCHK_HR(CmKernelData::Clone(m_lastKernelData, kernelData));
+    kernelDataSize = kernelData->GetKernelDataSize();
+
+finish:
+    return hr;
+}
+
 //*-----------------------------------------------------------------------------
 //| Purpose:    Prepare Kernel Data including thread args, kernel args
 //| Returns:    Result of the operation.
@@ -3433,7 +3481,19 @@ int32_t CmKernelRT::CreateKernelData(
         }
         else
         {
-            if(m_lastKernelData->IsInUse())
+            if(m_lastKernelData->IsInUse() && IsKernelDataClonable(const_cast<CmThreadSpaceRT *>(threadSpace)))
+            { // Only args changed: patch a copy of the kernel data in use
+                CMCHK_HR(CloneLastKernelData(kernelData, kernelDataSize));
+                hr = UpdateKernelData(kernelData, threadSpace);
+                if(hr != CM_SUCCESS)
+                {
+                    CmKernelData::Destroy(kernelData);
+                    goto finish;
+                }
+                CMCHK_HR(AcquireKernelProgram()); // increase kernel/program's ref count
+                CMCHK_HR(UpdateLastKernelData(kernelData));
+            }
+            else if(m_lastKernelData->IsInUse())
             { // Need to Create a new one , if the kernel data is in use
                 CMCHK_HR(CreateKernelDataInternal(kernelData, kernelDataSize, threadSpace));
                 CMCHK_HR(AcquireKernelProgram()); // increase kernel/program's ref count
@@ -3520,7 +3580,19 @@ int32_t CmKernelRT::CreateKernelData(
         }
         else
         {
-            if(m_lastKernelData->IsInUse())
+            if(m_lastKernelData->IsInUse() && IsKernelDataClonable(nullptr))
+            { // Only args changed: patch a copy of the kernel data in use
+                CMCHK_HR(CloneLastKernelData(kernelData, kernelDataSize));
+                hr = UpdateKernelData(kernelData, usedThreadGroupSpace);
+                if(hr != CM_SUCCESS)
+                {
+                    CmKernelData::Destroy(kernelData);
+                    goto finish;
+                }
+                CMCHK_HR(AcquireKernelProgram()); // increase kernel/program's ref count
+                CMCHK_HR(UpdateLastKernelData(kernelData));
+            }
+            else if(m_lastKernelData->IsInUse())
             { // Need to Clone a new one
                 CMCHK_HR(CreateKernelDataInternal(kernelData, kernelDataSize, usedThreadGroupSpace));
                 CMCHK_HR(AcquireKernelProgram()); // increase kernel/program's ref count
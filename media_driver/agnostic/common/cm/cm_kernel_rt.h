@@ -311,6 +311,11 @@ protected:
 
     int32_t IsKernelDataReusable(CmThreadSpaceRT *threadSpace);
 
+    bool IsKernelDataClonable(CmThreadSpaceRT *threadSpace);
+
+    int32_t CloneLastKernelData(CmKernelData *&kernelData,
+                                uint32_t &kernelDataSize);
+
     int32_t CreateKernelArgDataGroup(uint8_t *&data, uint32_t value);
 
     int32_t CreateMovInstructions(uint32_t &movInstNum,
@@ -30,6 +30,7 @@
 #include <emmintrin.h>
 #include "cm_debug.h"
 #include "mos_utilities.h"
+#include "mos_copy.h"
 
 enum CPU_INSTRUCTION_LEVEL
 {
@@ -619,7 +620,7 @@ Inline Function:
     CmFastMemCopy
 
 Description:
-    Intel C++ Compiler Memory Copy function for large amounts of data
+    Memory copy between cached buffers, see MosCopy_Copy
 
 Input:
     dst - pointer to destination buffer
@@ -628,30 +629,7 @@ Input:
 \*****************************************************************************/
 inline void CmFastMemCopy( void* dst, const   void* src, const size_t bytes )
 {
-
-    // Cache pointers to memory
-    uint8_t *cacheDst = (uint8_t*)dst;
-    uint8_t *cacheSrc = (uint8_t*)src;
-
-    size_t count = bytes;
-
-    // Get the number of DQWORDs to be copied
-    const size_t doubleQuadWords = count / sizeof(DQWORD);
-
-    if( doubleQuadWords )
-    {
-        FastMemCopy_SSE2( cacheDst, cacheSrc, doubleQuadWords );
-
-        cacheDst += doubleQuadWords * sizeof(DQWORD);
-        cacheSrc += doubleQuadWords * sizeof(DQWORD);
-        count -= doubleQuadWords * sizeof(DQWORD);
-    }
-
-    // Copy remaining uint8_t(s)
-    if( count )
-    {
-        MOS_SecureMemcpy( cacheDst, count, cacheSrc, count );
-    }
+    MosCopy_Copy( dst, src, bytes, MOS_COPY_MEMORY_CACHED );
 }
 
 /*****************************************************************************\
@@ -659,8 +637,8 @@ Inline Function:
 CmFastMemCopyWC
 
 Description:
-Intel C++ Compiler Memory Copy function for large amounts of data, just now prefetch
-compared with FastMemCopyWC. It is the same as the FastMemCopyWC_NoPf in CMRT@APP.
+Memory copy to a write-combined buffer with streaming stores of the widest
+instruction set of the CPU, see MosCopy_Copy
 
 Input:
 dst - pointer to write-combined destination buffer
@@ -669,60 +647,6 @@ bytes - number of bytes to copy
 \*****************************************************************************/
 inline void CmFastMemCopyWC( void* dst,   const void* src, const size_t bytes )
 {
-  // Cache pointers to memory
-  uint8_t *cacheDst = (uint8_t*)dst;
-  uint8_t *cacheSrc = (uint8_t*)src;
-
-  size_t count = bytes;
-
-  if( count >= sizeof(DQWORD) )
-  {
-    const size_t doubleQuadwordAlignBytes =
-      GetAlignmentOffset( cacheDst, sizeof(DQWORD) );
-
-    // The destination pointer should be 128-bit aligned
-    if( doubleQuadwordAlignBytes )
-    {
-      MOS_SecureMemcpy( cacheDst, doubleQuadwordAlignBytes,cacheSrc, doubleQuadwordAlignBytes );
-
-      cacheDst += doubleQuadwordAlignBytes;
-      cacheSrc += doubleQuadwordAlignBytes;
-      count -= doubleQuadwordAlignBytes;
-    }
-
-    // Get the number of DQWORDs to be copied
-    const size_t doubleQuadWords = count / sizeof(DQWORD);
-
-    if( doubleQuadWords )
-    {
-      // Determine if the source and destination addresses are
-      // 128-bit aligned
-      CM_ASSERT( IsAligned( cacheDst, sizeof(DQWORD) ) );
-
-      const bool isSrcDoubleQuadWordAligned =
-        IsAligned( cacheSrc, sizeof(DQWORD) );
-
-      if( isSrcDoubleQuadWordAligned )
-      {
-        FastMemCopy_SSE2_movntdq_movdqa( cacheDst, cacheSrc,
-          doubleQuadWords );
-      }
-      else
-      {
-        FastMemCopy_SSE2_movntdq_movdqu( cacheDst, cacheSrc,
-          doubleQuadWords );
-      }
-
-      cacheDst += doubleQuadWords * sizeof(DQWORD);
-      cacheSrc += doubleQuadWords * sizeof(DQWORD);
-      count -= doubleQuadWords * sizeof(DQWORD);
-    }
-  }
-
-  // Copy remaining uint8_t(s)
-  if( count )
-  {
-    MOS_SecureMemcpy( cacheDst, count, cacheSrc, count );
-  }
+    MosCopy_Copy( dst, src, bytes, MOS_COPY_MEMORY_TO_WC );
 }
 
@@ -662,6 +662,12 @@ int32_t CmProgramRT::Initialize( void* cisaCode, const uint32_t cisaCodeSize, co
 
     //Copy CISA content
     CmFastMemCopy((void *)m_programCode, cisaCode, cisaCodeSize);
+    if (m_isaFile)
+    {
+        // Kernel bodies are parsed when the kernels are created, after the
+        // caller may have freed cisaCode
+        m_isaFile->setBuffer(m_programCode, m_programCodeSize);
+    }
 
     hr = CM_SUCCESS;
 
@@ -111,7 +111,7 @@ public:
 
 private:
     std::queue<CmTaskInternal*> mQueue;
-    CSync mCriticalSection;
+    CSync mCriticalSection{"CmQueueFlushedTasks"};
 };
 
 //!
@@ -318,17 +318,17 @@ protected:
     ThreadSafeQueue m_flushedTasks;
 
     CmDynamicArray m_eventArray;
-    CSync m_criticalSectionEvent;        // Protect m_eventArray
-    CSync m_criticalSectionHalExecute;   // Protect execution in HALCm, i.e HalCm_Execute
-    CSync m_criticalSectionFlushedTask;  // Protect QueryFlushedTask
-    CSync m_criticalSectionTaskInternal;
+    CSync m_criticalSectionEvent{"CmQueueEvent"};                   // Protect m_eventArray
+    CSync m_criticalSectionHalExecute{"CmQueueHalExecute"};         // Protect execution in HALCm, i.e HalCm_Execute
+    CSync m_criticalSectionFlushedTask{"CmQueueQueryFlushedTask"};  // Protect QueryFlushedTask
+    CSync m_criticalSectionTaskInternal{"CmQueueTaskInternal"};
 
     uint32_t m_eventCount;
 
     CmDynamicArray m_copyKernelParamArray;
     uint32_t m_copyKernelParamArrayCount;
 
-    CSync m_criticalSectionGPUCopyKrn;
+    CSync m_criticalSectionGPUCopyKrn{"CmQueueGpuCopyKernel"};
 
     CM_HAL_MAX_VALUES *m_halMaxValues;
     CM_QUEUE_CREATE_OPTION m_queueOption;
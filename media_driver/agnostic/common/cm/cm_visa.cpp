@@ -25,7 +25,6 @@
 //!
 
 #include "cm_visa.h"
-#include "cm_def_os.h"
 #include <fstream>
 
 using namespace vISA;
@@ -38,18 +37,19 @@ ISAfile::ISAfile(const ISAfile& other) {
     data = other.data;
     end = other.end;
     size = other.size;
-    delete[] error;
-    char *perror = new char[std::strlen(other.error)];
-    memcpy_s(perror, sizeof(perror), other.error, sizeof(other.error));
-    error = perror;
+    // error messages are string literals
+    error = other.error;
     kernel_data_loaded = other.kernel_data_loaded;
     function_data_loaded = other.function_data_loaded;
     errorIndex = other.errorIndex;
     header = new Header(other.version);
     *header = *other.header;
     for (KernelBody *kb : other.kernel_data) {
-        KernelBody *kb2 = new KernelBody(other.version);
-        *kb2 = *kb;
+        KernelBody *kb2 = nullptr;
+        if (kb) {
+            kb2 = new KernelBody(other.version);
+            *kb2 = *kb;
+        }
         kernel_data.push_back(kb2);
     }
     for (FunctionBody *fb : other.function_data) {
@@ -65,10 +65,7 @@ ISAfile& ISAfile::operator= (const ISAfile& other) {
         data = other.data;
         end = other.end;
         size = other.size;
-        delete[] error;
-        char *perror = new char[std::strlen(other.error)];
-        memcpy_s(perror, sizeof perror, other.error, sizeof other.error);
-        error = perror;
+        error = other.error;
         kernel_data_loaded = other.kernel_data_loaded;
         function_data_loaded = other.function_data_loaded;
         errorIndex = other.errorIndex;
@@ -94,13 +91,33 @@ ISAfile::~ISAfile() {
 }
 
 bool ISAfile::readFile() {
-    bool status = true;
-    status &= loadHeader();
+    if (!loadHeader())
+        return false;
     if (version < 302)
         return false;
-    status &= loadKernelData();
-    status &= loadFunctionData();
-    return status;
+    // bodies are parsed on demand, only check that they are in the buffer
+    std::vector<Kernel*> &kernels = header->getKernelInfo();
+    for (unsigned i = 0; i < kernels.size(); i++) {
+        if (!isBodyInBuffer(kernels[i]->getOffset(), kernels[i]->getSize())) {
+            setError("bad offset/size for kernel body", i);
+            return false;
+        }
+    }
+    std::vector<Function*> &functions = header->getFunctionInfo();
+    for (unsigned i = 0; i < functions.size(); i++) {
+        if (!isBodyInBuffer(functions[i]->getOffset(), functions[i]->getSize())) {
+            setError("bad offset/size for function body", i);
+            return false;
+        }
+    }
+    kernel_data.assign(kernels.size(), nullptr);
+    return true;
+}
+
+void ISAfile::setBuffer(const uint8_t *data, unsigned size) {
+    this->data = data;
+    this->end = data + size;
+    this->size = size;
 }
 
 bool ISAfile::loadHeader() {
@@ -108,29 +125,29 @@ bool ISAfile::loadHeader() {
     const uint8_t *p = header->parse(data, end, this);
     if (!p) {
         delete header;
+        header = nullptr;
         return false; //error loading header
     }
     return true;
 }
 
 bool ISAfile::loadKernelData() {
-    const uint8_t *p = 0;
-    for (Kernel *k : header->getKernelInfo()) {
-        KernelBody *kb = new KernelBody(version);
-        p = kb->parse(data + k->getOffset(), end, this);
-        if (!p) {
-            delete kb;
-            return false; //error loading kernel_data
-        }
-        kernel_data.push_back(kb);
+    bool status = true;
+    for (unsigned i = 0; i < kernel_data.size(); i++) {
+        if (!getKernelBody(i))
+            status = false; //error loading kernel_data
     }
-    kernel_data_loaded = true;
-    return true;
+    kernel_data_loaded = status;
+    return status;
 }
 
 bool ISAfile::loadFunctionData() {
+    if (!header)
+        return false;
     const uint8_t *p = 0;
     for (Function *f : header->getFunctionInfo()) {
+        if (!isBodyInBuffer(f->getOffset(), f->getSize()))
+            return false;
         FunctionBody *fb = new FunctionBody(version);
         p = fb->parse(data + f->getOffset(), end, this);
         if (!p) {
@@ -143,6 +160,24 @@ bool ISAfile::loadFunctionData() {
     return true;
 }
 
+KernelBody *ISAfile::getKernelBody(unsigned index) {
+    if (index >= kernel_data.size()) {
+        setError("bad kernel index", index);
+        return nullptr;
+    }
+    if (!kernel_data[index]) {
+        Kernel *k = header->getKernelInfo()[index];
+        KernelBody *kb = new KernelBody(version);
+        const uint8_t *p = kb->parse(data + k->getOffset(), end, this);
+        if (!p) {
+            delete kb;
+            return nullptr; //error loading kernel_data
+        }
+        kernel_data[index] = kb;
+    }
+    return kernel_data[index];
+}
+
 std::vector<KernelBody*> &ISAfile::getKernelsData() {
     if (!kernel_data_loaded) loadKernelData();
     return kernel_data;
@@ -156,10 +191,22 @@ std::vector<FunctionBody*> &ISAfile::getFunctionsData() {
 const uint8_t* ISAfile::readField(const uint8_t *p, const uint8_t *buffEnd,
     Field &field, unsigned dataSize) {
     switch (field.type) {
-    case Datatype::ONE: field.number8 = *((int8_t *)p); p++; break;
-    case Datatype::TWO: field.number16 = *((int16_t *)p); p += 2; break;
-    case Datatype::FOUR: field.number32 = *((int32_t *)p); p += 4; break;
-    case Datatype::EIGHT: field.number64 = *((int64_t *)p); p += 8; break;
+    case Datatype::ONE:
+    case Datatype::TWO:
+    case Datatype::FOUR:
+    case Datatype::EIGHT:
+    {
+        // ONE, TWO, FOUR and EIGHT are 0 to 3
+        unsigned fieldSize = 1u << field.type;
+        if (p + fieldSize > buffEnd) {
+            // error: truncated
+            return 0;
+        }
+        field.number64 = 0;
+        std::memcpy(&field.number64, p, fieldSize);
+        p += fieldSize;
+        break;
+    }
     case Datatype::VARCHAR:
     {
         if (p + dataSize > buffEnd) {
@@ -168,7 +215,7 @@ const uint8_t* ISAfile::readField(const uint8_t *p, const uint8_t *buffEnd,
             return 0;
         }
         char *string = new char[dataSize + 1];
-        memcpy_s(string, dataSize + 1, p, dataSize);
+        std::memcpy(string, p, dataSize);
         string[dataSize] = '\0';
         field.size = dataSize;
         field.varchar = string;
@@ -177,10 +224,18 @@ const uint8_t* ISAfile::readField(const uint8_t *p, const uint8_t *buffEnd,
     }
     case Datatype::VARCHAR_POOL:
     {
-        const uint8_t *strEnd = (const uint8_t *)std::memchr(p, 0, end - p);
+        if (p >= buffEnd) {
+            // error: truncated
+            return 0;
+        }
+        const uint8_t *strEnd = (const uint8_t *)std::memchr(p, 0, buffEnd - p);
+        if (!strEnd) {
+            // error: string not terminated
+            return 0;
+        }
         auto len = strEnd - p;
         char *string = new char[len + 1];
-        memcpy_s(string, len + 1, p, len);
+        std::memcpy(string, p, len);
         string[len] = '\0';
         field.size = (uint32_t)len + 1;
         field.varchar = string;
@@ -192,7 +247,7 @@ const uint8_t* ISAfile::readField(const uint8_t *p, const uint8_t *buffEnd,
         // copy only if no out of bound.
         if (p + dataSize < end) {
             uint8_t *gdata = new uint8_t[dataSize];
-            memcpy_s(gdata, dataSize , p, dataSize);
+            std::memcpy(gdata, p, dataSize);
             field.gdata = gdata;
             field.size = dataSize;
             p += dataSize;
@@ -218,8 +273,8 @@ bool ISAfile::writeToFile(const char *filename, std::vector<uint8_t> &originalBu
         setError("Header not loaded", 0);
         return false;
     }
-    if (!kernel_data_loaded)
-        loadKernelData();
+    if (!kernel_data_loaded && !loadKernelData())
+        return false;
     if (!function_data_loaded)
         loadFunctionData();
 
@@ -117,6 +117,8 @@ namespace vISA {
 
         //!
         //! \brief      Reads and parses the kernels from ISA file.
+        //! \details    Only the kernels not parsed yet by getKernelBody are
+        //!             parsed.
         //! \retval     True if sucessfully parsers all the kernels.
         //!             False otherwise.
         //!
@@ -128,6 +130,18 @@ namespace vISA {
         //!             False otherwise.
         //!
         bool loadFunctionData();
+
+        //!
+        //! \brief      Checks that a kernel or function body is inside the buffer.
+        //! \param      [in] offset.
+        //!             Offset of the body from the start of the buffer.
+        //! \param      [in] bodySize.
+        //!             Size of the body.
+        //! \retval     True if the body is inside the buffer.
+        //!
+        bool isBodyInBuffer(uint32_t offset, uint32_t bodySize) {
+            return offset < size && bodySize <= size - offset;
+        }
     public:
         //!
         //! \brief      Constructor of ISAfile class.
@@ -159,18 +173,45 @@ namespace vISA {
 
         //!
         //! \brief      Reads the ISA file.
+        //! \details    Only the header is parsed. The offsets of the kernel
+        //!             and function bodies are checked, and the bodies are
+        //!             parsed when they are first asked for.
         //! \retval     True if it reads successfully.
         //!
         bool readFile();
 
+        //!
+        //! \brief      Points the file to another copy of the buffer it was
+        //!             read from.
+        //! \details    The bodies not parsed yet are parsed from the new
+        //!             buffer, which has to live as long as this object.
+        //! \param      [in] data.
+        //!             Pointer to the copy of the ISA file buffer.
+        //! \param      [in] size.
+        //!             Size of the copy, the same as the original.
+        //!
+        void setBuffer(const uint8_t *data, unsigned size);
+
         //!
         //! \brief      Returns the Header object.
         //! \retval     The pointer to Header object.
         //!
         Header *getHeader() { return header; }
 
+        //!
+        //! \brief      Returns the body of a kernel, parsing it on first use.
+        //! \param      [in] index.
+        //!             Index of the kernel in the header.
+        //! \retval     The pointer to the KernelBody object.
+        //!             nullptr if the index is out of range or the body
+        //!             can not be parsed.
+        //!
+        KernelBody *getKernelBody(unsigned index);
+
         //!
         //! \brief      Returns the vector of kernels.
+        //! \details    Parses all the kernel bodies not parsed yet. The
+        //!             bodies that fail to parse are left as nullptr.
         //! \retval     The reference to the vector with the kernels.
         //!
         std::vector<KernelBody*> &getKernelsData();
@@ -784,14 +784,12 @@ MOS_STATUS CodechalDecodeAvc::AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resMfdDeblockingFilterRowStoreScratchBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resMfdDeblockingFilterRowStoreScratchBuffer);
+            FreeScratchBuffer(&m_resMfdDeblockingFilterRowStoreScratchBuffer);
         }
 
         // Deblocking Filter Row Store Scratch buffer
         //(Num MacroBlock Width) * (Num Cachlines) * (Cachline size)
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resMfdDeblockingFilterRowStoreScratchBuffer,
                                                       picWidthInMB * 4 * CODECHAL_CACHELINE_SIZE,
                                                       "DeblockingScratchBuffer"),
@@ -808,13 +806,11 @@ MOS_STATUS CodechalDecodeAvc::AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resBsdMpcRowStoreScratchBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resBsdMpcRowStoreScratchBuffer);
+                FreeScratchBuffer(&m_resBsdMpcRowStoreScratchBuffer);
             }
             // BSD/MPC Row Store Scratch buffer
             // (FrameWidth in MB) * (2) * (CacheLine size per MB)
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resBsdMpcRowStoreScratchBuffer,
                                                           tempBsdMpcRowStoreScratchBufferPicWidthInMB * 2 * CODECHAL_CACHELINE_SIZE,
                                                           "MpcScratchBuffer"),
@@ -835,13 +831,11 @@ MOS_STATUS CodechalDecodeAvc::AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resMfdIntraRowStoreScratchBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resMfdIntraRowStoreScratchBuffer);
+                FreeScratchBuffer(&m_resMfdIntraRowStoreScratchBuffer);
             }
             // Intra Row Store Scratch buffer
             // (FrameWidth in MB) * (CacheLine size per MB)
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resMfdIntraRowStoreScratchBuffer,
                                                           tempMfdIntraRowStoreScratchBufferPicWidthInMB * CODECHAL_CACHELINE_SIZE,
                                                           "IntraScratchBuffer"),
@@ -862,14 +856,12 @@ MOS_STATUS CodechalDecodeAvc::AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resMprRowStoreScratchBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resMprRowStoreScratchBuffer);
+                FreeScratchBuffer(&m_resMprRowStoreScratchBuffer);
             }
             // MPR Row Store Scratch buffer
             // (FrameWidth in MB) * (CacheLine size per MB) * 2
             // IVB+ platforms need to have double MPR size for MBAFF
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resMprRowStoreScratchBuffer,
                                                           tempMprRowStoreScratchBufferPicWidthInMB * CODECHAL_CACHELINE_SIZE * 2,
                                                           "MprScratchBuffer"),
@@ -978,6 +970,34 @@ MOS_STATUS CodechalDecodeAvc::InitSfcState()
     return MOS_STATUS_SUCCESS;
 }
 
+MOS_STATUS CodechalDecodeAvc::ResetStreamState()
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    CODECHAL_DECODE_CHK_NULL_RETURN(m_avcRefList[0]);
+
+    ResetBaseStreamState();
+
+    // The ref list entries are allocated as one block by CodecHalAllocateDataList
+    MOS_ZeroMemory(m_avcRefList[0], sizeof(CODEC_REF_LIST) * CODEC_AVC_NUM_UNCOMPRESSED_SURFACE);
+    MOS_ZeroMemory(m_avcFrameStoreId, sizeof(m_avcFrameStoreId));
+    MOS_ZeroMemory(m_avcDmvList, sizeof(m_avcDmvList));
+    MOS_ZeroMemory(m_avcPicIdx, sizeof(m_avcPicIdx));
+    MOS_ZeroMemory(m_presReferences, sizeof(m_presReferences));
+
+    for (uint8_t i = 0; i < CODECHAL_DECODE_AVC_MAX_NUM_MVC_VIEWS; i++)
+    {
+        m_firstFieldIdxList[i] = CODECHAL_DECODE_AVC_INVALID_FRAME_IDX;
+    }
+
+    m_avcMvBufferIndex = 0;
+    m_isSecondField    = false;
+    m_currPic.PicFlags = PICTURE_INVALID;
+    m_currPic.FrameIdx = CODEC_AVC_NUM_UNCOMPRESSED_SURFACE;
+
+    return MOS_STATUS_SUCCESS;
+}
+
 MOS_STATUS CodechalDecodeAvc::AllocateStandard(
     CodechalSetting *settings)
 {
@@ -1080,21 +1100,13 @@ CodechalDecodeAvc::~CodechalDecodeAvc()
 
     MOS_FreeMemory(m_vldSliceRecord);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMfdDeblockingFilterRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resMfdDeblockingFilterRowStoreScratchBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resBsdMpcRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resBsdMpcRowStoreScratchBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMfdIntraRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resMfdIntraRowStoreScratchBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMprRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resMprRowStoreScratchBuffer);
 
     if (!Mos_ResourceIsNull(&m_resMonoPictureChromaBuffer))
     {
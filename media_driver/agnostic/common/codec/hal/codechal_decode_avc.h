@@ -122,6 +122,13 @@ public:
     MOS_STATUS  AllocateStandard(
         CodechalSetting *          settings) override;
 
+    //!
+    //! \brief    Reset AVC reference tracking for a new stream
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS  ResetStreamState() override;
+
     //!
     //! \brief  Set states for each frame to prepare for AVC decode
     //! \return MOS_STATUS
@@ -233,9 +233,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resMfdDeblockingFilterRowStoreScratchBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resMfdDeblockingFilterRowStoreScratchBuffer);
+                FreeScratchBuffer(&m_resMfdDeblockingFilterRowStoreScratchBuffer);
             }
 
             // Deblocking Filter Row Store Scratch buffer
@@ -244,7 +242,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
                 MHW_VDBOX_HCP_INTERNAL_BUFFER_DBLK_LINE,
                 &hcpBufSizeParam));
 
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resMfdDeblockingFilterRowStoreScratchBuffer,
                                                           hcpBufSizeParam.dwBufferSize,
                                                           "DeblockingScratchBuffer"),
@@ -264,9 +262,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resDeblockingFilterTileRowStoreScratchBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resDeblockingFilterTileRowStoreScratchBuffer);
+            FreeScratchBuffer(&m_resDeblockingFilterTileRowStoreScratchBuffer);
         }
 
         // Deblocking Filter Tile Row Store Scratch data surface
@@ -275,7 +271,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
             MHW_VDBOX_HCP_INTERNAL_BUFFER_DBLK_TILE_LINE,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resDeblockingFilterTileRowStoreScratchBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "DeblockingTileScratchBuffer"),
@@ -291,9 +287,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resDeblockingFilterColumnRowStoreScratchBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resDeblockingFilterColumnRowStoreScratchBuffer);
+            FreeScratchBuffer(&m_resDeblockingFilterColumnRowStoreScratchBuffer);
         }
         // Deblocking Filter Column Row Store Scratch data surface
         hcpBufSizeParam.dwPicHeight = heightMax;
@@ -301,7 +295,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
             MHW_VDBOX_HCP_INTERNAL_BUFFER_DBLK_TILE_COL,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resDeblockingFilterColumnRowStoreScratchBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "DeblockingColumnScratchBuffer"),
@@ -323,9 +317,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resMetadataLineBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resMetadataLineBuffer);
+                FreeScratchBuffer(&m_resMetadataLineBuffer);
             }
 
             // Metadata Line buffer
@@ -334,7 +326,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
                 MHW_VDBOX_HCP_INTERNAL_BUFFER_META_LINE,
                 &hcpBufSizeParam));
 
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resMetadataLineBuffer,
                                                           hcpBufSizeParam.dwBufferSize,
                                                           "MetadataLineBuffer"),
@@ -354,9 +346,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resMetadataTileLineBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resMetadataTileLineBuffer);
+            FreeScratchBuffer(&m_resMetadataTileLineBuffer);
         }
         // Metadata Tile Line buffer
         hcpBufSizeParam.dwPicWidth = widthMax;
@@ -364,7 +354,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
             MHW_VDBOX_HCP_INTERNAL_BUFFER_META_TILE_LINE,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resMetadataTileLineBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "MetadataTileLineBuffer"),
@@ -380,9 +370,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resMetadataTileColumnBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resMetadataTileColumnBuffer);
+            FreeScratchBuffer(&m_resMetadataTileColumnBuffer);
         }
         // Metadata Tile Column buffer
         hcpBufSizeParam.dwPicHeight = heightMax;
@@ -390,7 +378,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
             MHW_VDBOX_HCP_INTERNAL_BUFFER_DBLK_TILE_COL,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resMetadataTileColumnBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "MetadataTileColumnBuffer"),
@@ -411,9 +399,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resSaoLineBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resSaoLineBuffer);
+                FreeScratchBuffer(&m_resSaoLineBuffer);
             }
 
             // SAO Line buffer
@@ -422,7 +408,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
                 MHW_VDBOX_HCP_INTERNAL_BUFFER_SAO_LINE,
                 &hcpBufSizeParam));
 
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resSaoLineBuffer,
                                                           hcpBufSizeParam.dwBufferSize,
                                                           "SaoLineBuffer"),
@@ -442,9 +428,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resSaoTileLineBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resSaoTileLineBuffer);
+            FreeScratchBuffer(&m_resSaoTileLineBuffer);
         }
         // SAO Tile Line buffer
         hcpBufSizeParam.dwPicWidth = widthMax;
@@ -452,7 +436,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
             MHW_VDBOX_HCP_INTERNAL_BUFFER_SAO_TILE_LINE,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resSaoTileLineBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "SaoTileLineBuffer"),
@@ -468,9 +452,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resSaoTileColumnBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resSaoTileColumnBuffer);
+            FreeScratchBuffer(&m_resSaoTileColumnBuffer);
         }
         // SAO Tile Column buffer
         hcpBufSizeParam.dwPicHeight = heightMax;
@@ -478,7 +460,7 @@ MOS_STATUS CodechalDecodeHevc::AllocateResourcesVariableSizes()
             MHW_VDBOX_HCP_INTERNAL_BUFFER_SAO_TILE_COL,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resSaoTileColumnBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "SaoTileColumnBuffer"),
@@ -575,48 +557,30 @@ CodechalDecodeHevc::~CodechalDecodeHevc ()
 
     if (!m_hcpInterface->IsHevcDfRowstoreCacheEnabled())
     {
-        m_osInterface->pfnFreeResource(
-            m_osInterface,
-            &m_resMfdDeblockingFilterRowStoreScratchBuffer);
+        FreeScratchBuffer(&m_resMfdDeblockingFilterRowStoreScratchBuffer);
     }
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resDeblockingFilterTileRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resDeblockingFilterTileRowStoreScratchBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resDeblockingFilterColumnRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resDeblockingFilterColumnRowStoreScratchBuffer);
 
     if (!m_hcpInterface->IsHevcDatRowstoreCacheEnabled())
     {
-        m_osInterface->pfnFreeResource(
-            m_osInterface,
-            &m_resMetadataLineBuffer);
+        FreeScratchBuffer(&m_resMetadataLineBuffer);
     }
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMetadataTileLineBuffer);
+    FreeScratchBuffer(&m_resMetadataTileLineBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMetadataTileColumnBuffer);
+    FreeScratchBuffer(&m_resMetadataTileColumnBuffer);
 
     if (!m_hcpInterface->IsHevcSaoRowstoreCacheEnabled())
     {
-        m_osInterface->pfnFreeResource(
-            m_osInterface,
-            &m_resSaoLineBuffer);
+        FreeScratchBuffer(&m_resSaoLineBuffer);
     }
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resSaoTileLineBuffer);
+    FreeScratchBuffer(&m_resSaoTileLineBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resSaoTileColumnBuffer);
+    FreeScratchBuffer(&m_resSaoTileColumnBuffer);
 
     for (uint32_t i = 0; i < CODEC_NUM_HEVC_MV_BUFFERS; i++)
     {
@@ -2509,6 +2473,27 @@ MOS_STATUS CodechalDecodeHevc::InitMmcState()
     return MOS_STATUS_SUCCESS;
 }
 
+MOS_STATUS CodechalDecodeHevc::ResetStreamState()
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    CODECHAL_DECODE_CHK_NULL_RETURN(m_hevcRefList[0]);
+
+    ResetBaseStreamState();
+
+    // The ref list entries are allocated as one block by CodecHalAllocateDataList
+    MOS_ZeroMemory(m_hevcRefList[0], sizeof(CODEC_REF_LIST) * CODECHAL_NUM_UNCOMPRESSED_SURFACE_HEVC);
+    MOS_ZeroMemory(m_hevcMvList, sizeof(m_hevcMvList));
+    MOS_ZeroMemory(m_frameUsedAsCurRef, sizeof(m_frameUsedAsCurRef));
+    MOS_ZeroMemory(m_presReferences, sizeof(m_presReferences));
+    MOS_ZeroMemory(&m_currPic, sizeof(m_currPic));
+
+    m_hevcMvBufferIndex = 0;
+    m_frameIdx          = 0;
+
+    return MOS_STATUS_SUCCESS;
+}
+
 MOS_STATUS CodechalDecodeHevc::AllocateStandard (
     CodechalSetting *settings)
 {
@@ -362,7 +362,7 @@ MOS_STATUS CodechalDecodeHistogramVebox::RenderHistogram(
     CODECHAL_HW_CHK_STATUS_RETURN(SetVeboxIecpParams(&veboxIecpParams));
 
     // send Vebox cmd
-    CODECHAL_HW_CHK_STATUS_RETURN(m_veboxInterface->AddVeboxIecpState(
+    CODECHAL_HW_CHK_STATUS_RETURN(m_veboxInterface->UpdateVeboxIecpState(
         &veboxIecpParams));
 
     CODECHAL_HW_CHK_STATUS_RETURN(m_veboxInterface->AddVeboxState(
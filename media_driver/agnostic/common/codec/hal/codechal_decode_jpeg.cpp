@@ -42,6 +42,9 @@ CodechalDecodeJpeg::~CodechalDecodeJpeg()
 {
     CODECHAL_DECODE_FUNCTION_ENTER;
 
+    // Pictures still held back by batching reference resources released below
+    SubmitPendingPictures();
+
     m_osInterface->pfnDestroySyncResource(m_osInterface, &m_resSyncObjectWaContextInUse);
     m_osInterface->pfnDestroySyncResource(m_osInterface, &m_resSyncObjectVideoContextInUse);
 
@@ -635,13 +638,7 @@ MOS_STATUS CodechalDecodeJpeg::DecodeStateLevel()
     }
 
     MOS_COMMAND_BUFFER cmdBuffer;
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(
-        m_osInterface,
-        &cmdBuffer,
-        0));
-
-    CODECHAL_DECODE_CHK_STATUS_RETURN(SendPrologWithFrameTracking(
-        &cmdBuffer, true));
+    CODECHAL_DECODE_CHK_STATUS_RETURN(GetPictureCommandBuffer(&cmdBuffer));
 
     // Set PIPE_MODE_SELECT
     MHW_VDBOX_PIPE_MODE_SELECT_PARAMS pipeModeSelectParams;
@@ -763,6 +760,234 @@ MOS_STATUS CodechalDecodeJpeg::DecodePrimitiveLevel()
         &cmdBuffer,
         0));
 
+    CODECHAL_DECODE_CHK_STATUS_RETURN(AddPictureDecodeCmds(&cmdBuffer));
+
+    // Check if destination surface needs to be synchronized
+    MOS_SYNC_PARAMS syncParams = g_cInitSyncParams;
+    syncParams.GpuContext = m_videoContext;
+    syncParams.presSyncResource         = &m_destSurface.OsResource;
+    syncParams.bReadOnly = false;
+    syncParams.bDisableDecodeSyncLock = m_disableDecodeSyncLock;
+    syncParams.bDisableLockForTranscode = m_disableLockForTranscode;
+
+    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnPerformOverlaySync(
+        m_osInterface,
+        &syncParams));
+    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnResourceWait(
+        m_osInterface,
+        &syncParams));
+
+    // Update the resource tag (s/w tag) for On-Demand Sync
+    m_osInterface->pfnSetResourceSyncTag(m_osInterface, &syncParams);
+
+    MHW_MI_FLUSH_DW_PARAMS flushDwParams;
+    MOS_ZeroMemory(&flushDwParams, sizeof(flushDwParams));
+    CODECHAL_DECODE_CHK_STATUS_RETURN(m_miInterface->AddMiFlushDwCmd(
+        &cmdBuffer,
+        &flushDwParams));
+
+    // Update the tag in GPU Sync eStatus buffer (H/W Tag) to match the current S/W tag
+    if (m_osInterface->bTagResourceSync)
+    {
+        CODECHAL_DECODE_CHK_STATUS_RETURN(m_hwInterface->WriteSyncTagToResource(
+            &cmdBuffer,
+            &syncParams));
+    }
+
+    if (m_statusQueryReportingEnabled)
+    {
+        CodechalDecodeStatusReport decodeStatusReport;
+        decodeStatusReport.m_statusReportNumber = m_statusReportFeedbackNumber;
+        decodeStatusReport.m_codecStatus = CODECHAL_STATUS_UNAVAILABLE;
+        decodeStatusReport.m_currDecodedPicRes  = m_destSurface.OsResource;
+
+        CODECHAL_DECODE_CHK_STATUS_RETURN(EndStatusReport(
+            decodeStatusReport,
+            &cmdBuffer));
+    }
+
+    CODECHAL_DECODE_CHK_STATUS_RETURN(SubmitPicture(&cmdBuffer));
+
+    CODECHAL_DEBUG_TOOL(
+        m_mmc->UpdateUserFeatureKey(&m_destSurface);)
+
+    if (m_statusQueryReportingEnabled)
+    {
+        CODECHAL_DECODE_CHK_STATUS_RETURN(ResetStatusReport(
+            m_videoContextUsesNullHw));
+        }
+
+    // Set output surface layout
+    SetOutputSurfaceLayout(&m_decodeParams.m_outputSurfLayout);
+
+    // Send the signal to indicate decode completion, in case On-Demand Sync is not present
+    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnResourceSignal(
+        m_osInterface,
+        &syncParams));
+
+    // A batched picture is only decoded once its command buffer is submitted
+    CODECHAL_DEBUG_TOOL(
+        if (m_numPendingPictures == 0)
+        {
+            CODECHAL_DECODE_CHK_STATUS_RETURN(m_debugInterface->DumpYUVSurface(
+                &m_destSurface,
+                CodechalDbgAttr::attrDecodeOutputSurface,
+                "DstSurf"));
+        })
+    return eStatus;
+}
+
+void CodechalDecodeJpeg::CalcRequestedSpace(
+    uint32_t       &requestedSize,
+    uint32_t       &additionalSizeNeeded,
+    uint32_t       &requestedPatchListSize)
+{
+    CodechalDecode::CalcRequestedSpace(requestedSize, additionalSizeNeeded, requestedPatchListSize);
+
+    // Room for a full batch, GetPictureCommandBuffer() submits early if pictures are larger
+    requestedSize          *= m_batchSize;
+    requestedPatchListSize *= m_batchSize;
+}
+
+MOS_STATUS CodechalDecodeJpeg::GetPictureCommandBuffer(
+    PMOS_COMMAND_BUFFER cmdBuffer)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    CODECHAL_DECODE_CHK_NULL_RETURN(cmdBuffer);
+
+    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(
+        m_osInterface,
+        cmdBuffer,
+        0));
+
+    if (m_numPendingPictures > 0)
+    {
+        uint32_t requestedSize = 0, additionalSizeNeeded = 0, requestedPatchListSize = 0;
+        CodechalDecode::CalcRequestedSpace(requestedSize, additionalSizeNeeded, requestedPatchListSize);
+
+        // Flush the pictures already recorded if this one does not fit behind them,
+        // or if it needs commands of its own in front
+        if (cmdBuffer->iRemaining < (int32_t)(requestedSize + additionalSizeNeeded) ||
+            m_decodeParams.m_setMarkerEnabled ||
+            m_decodeParams.m_predicationEnabled)
+        {
+            m_osInterface->pfnReturnCommandBuffer(m_osInterface, cmdBuffer, 0);
+            CODECHAL_DECODE_CHK_STATUS_RETURN(SubmitPendingPictures());
+            m_osInterface->pfnResetOsStates(m_osInterface);
+            CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(
+                m_osInterface,
+                cmdBuffer,
+                0));
+        }
+    }
+
+    if (m_numPendingPictures == 0)
+    {
+        CODECHAL_DECODE_CHK_STATUS_RETURN(SendPrologWithFrameTracking(
+            cmdBuffer, true));
+    }
+    else
+    {
+        // Pairs with the end command of EndStatusReport()
+        CODECHAL_DECODE_CHK_STATUS_RETURN(m_perfProfiler->AddPerfCollectStartCmd(
+            (void *)this,
+            m_osInterface,
+            m_miInterface,
+            cmdBuffer));
+    }
+
+    return MOS_STATUS_SUCCESS;
+}
+
+MOS_STATUS CodechalDecodeJpeg::AddCachedTableCmd(
+    PMOS_COMMAND_BUFFER          cmdBuffer,
+    const uint8_t               *key,
+    uint32_t                     keySize,
+    PMHW_VDBOX_QM_PARAMS         qmParams,
+    PMHW_VDBOX_HUFF_TABLE_PARAMS huffmanTableParams)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    CODECHAL_DECODE_CHK_NULL_RETURN(cmdBuffer);
+    CODECHAL_DECODE_CHK_NULL_RETURN(key);
+    CODECHAL_DECODE_ASSERT(keySize <= CODECHAL_DECODE_JPEG_TABLE_CACHE_DATA_SIZE);
+
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < keySize; i++)
+    {
+        hash = (hash ^ key[i]) * 16777619u;
+    }
+
+    m_tableCacheUseCount++;
+
+    CodechalDecodeJpegTableCacheEntry *entry  = nullptr;
+    CodechalDecodeJpegTableCacheEntry *victim = &m_tableCache[0];
+    for (uint32_t i = 0; i < CODECHAL_DECODE_JPEG_TABLE_CACHE_SIZE; i++)
+    {
+        CodechalDecodeJpegTableCacheEntry *candidate = &m_tableCache[i];
+        if (candidate->m_cmdSize != 0 &&
+            candidate->m_hash == hash &&
+            candidate->m_keySize == keySize &&
+            !memcmp(candidate->m_key, key, keySize))
+        {
+            entry = candidate;
+            break;
+        }
+        if (candidate->m_cmdSize == 0 ||
+            (victim->m_cmdSize != 0 && candidate->m_lastUse < victim->m_lastUse))
+        {
+            victim = candidate;
+        }
+    }
+
+    if (entry == nullptr)
+    {
+        // Build the command into the entry through a command buffer over its storage
+        entry            = victim;
+        entry->m_cmdSize = 0;
+
+        MOS_COMMAND_BUFFER tableCmdBuffer;
+        MOS_ZeroMemory(&tableCmdBuffer, sizeof(tableCmdBuffer));
+        tableCmdBuffer.pCmdBase   = (uint32_t *)entry->m_cmd;
+        tableCmdBuffer.pCmdPtr    = (uint32_t *)entry->m_cmd;
+        tableCmdBuffer.iRemaining = sizeof(entry->m_cmd);
+
+        if (qmParams)
+        {
+            CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxQmCmd(
+                &tableCmdBuffer,
+                qmParams));
+        }
+        else
+        {
+            CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxJpegHuffTableCmd(
+                &tableCmdBuffer,
+                huffmanTableParams));
+        }
+
+        entry->m_hash    = hash;
+        entry->m_keySize = keySize;
+        MOS_SecureMemcpy(entry->m_key, sizeof(entry->m_key), key, keySize);
+        entry->m_cmdSize = tableCmdBuffer.iOffset;
+    }
+
+    entry->m_lastUse = m_tableCacheUseCount;
+
+    return Mos_AddCommand(cmdBuffer, entry->m_cmd, entry->m_cmdSize);
+}
+
+MOS_STATUS CodechalDecodeJpeg::AddPictureDecodeCmds(
+    PMOS_COMMAND_BUFFER cmdBuffer)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    CODECHAL_DECODE_CHK_NULL_RETURN(cmdBuffer);
+
+    // Keys of the table commands, all the command builders read goes in
+    uint8_t key[CODECHAL_DECODE_JPEG_TABLE_CACHE_DATA_SIZE];
+
     // MFX_QM_STATE_CMD
     MHW_VDBOX_QM_PARAMS qmParams;
     MOS_ZeroMemory(&qmParams, sizeof(qmParams));
@@ -786,9 +1011,20 @@ MOS_STATUS CodechalDecodeJpeg::DecodePrimitiveLevel()
         uint32_t quantTableSelector                                      = m_jpegPicParams->m_quantTableSelector[scanCount];
         qmParams.pJpegQuantMatrix->m_jpegQMTableType[quantTableSelector] = scanCount;
         qmParams.JpegQMTableSelector = quantTableSelector;
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxQmCmd(
-            &cmdBuffer,
-            &qmParams));
+
+        uint32_t keySize = 0;
+        key[keySize++] = 0;
+        key[keySize++] = (uint8_t)scanCount;
+        key[keySize++] = qmParams.bJpegQMRotation;
+        MOS_SecureMemcpy(&key[keySize], JPEG_NUM_QUANTMATRIX, qmParams.pJpegQuantMatrix->m_quantMatrix[quantTableSelector], JPEG_NUM_QUANTMATRIX);
+        keySize += JPEG_NUM_QUANTMATRIX;
+
+        CODECHAL_DECODE_CHK_STATUS_RETURN(AddCachedTableCmd(
+            cmdBuffer,
+            key,
+            keySize,
+            &qmParams,
+            nullptr));
     }
 
     uint32_t dcCurHuffTblIndex[2] = { 0xff, 0xff };
@@ -835,8 +1071,23 @@ MOS_STATUS CodechalDecodeJpeg::DecodePrimitiveLevel()
                 huffmanTableParams.pACValues = &m_jpegHuffmanTable->HuffTable[AcTableSelector].AC_HUFFVAL[0];
                 huffmanTableParams.pDCValues = &m_jpegHuffmanTable->HuffTable[DcTableSelector].DC_HUFFVAL[0];
 
-                CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxJpegHuffTableCmd(
-                    &cmdBuffer,
+                uint32_t keySize = 0;
+                key[keySize++] = 1;
+                key[keySize++] = (uint8_t)huffTableID;
+                MOS_SecureMemcpy(&key[keySize], JPEG_NUM_HUFF_TABLE_DC_BITS, huffmanTableParams.pDCBits, JPEG_NUM_HUFF_TABLE_DC_BITS);
+                keySize += JPEG_NUM_HUFF_TABLE_DC_BITS;
+                MOS_SecureMemcpy(&key[keySize], JPEG_NUM_HUFF_TABLE_DC_HUFFVAL, huffmanTableParams.pDCValues, JPEG_NUM_HUFF_TABLE_DC_HUFFVAL);
+                keySize += JPEG_NUM_HUFF_TABLE_DC_HUFFVAL;
+                MOS_SecureMemcpy(&key[keySize], JPEG_NUM_HUFF_TABLE_AC_BITS, huffmanTableParams.pACBits, JPEG_NUM_HUFF_TABLE_AC_BITS);
+                keySize += JPEG_NUM_HUFF_TABLE_AC_BITS;
+                MOS_SecureMemcpy(&key[keySize], JPEG_NUM_HUFF_TABLE_AC_HUFFVAL, huffmanTableParams.pACValues, JPEG_NUM_HUFF_TABLE_AC_HUFFVAL);
+                keySize += JPEG_NUM_HUFF_TABLE_AC_HUFFVAL;
+
+                CODECHAL_DECODE_CHK_STATUS_RETURN(AddCachedTableCmd(
+                    cmdBuffer,
+                    key,
+                    keySize,
+                    nullptr,
                     &huffmanTableParams));
 
                 // Set the current huffman table indices for the next scan
@@ -882,63 +1133,69 @@ MOS_STATUS CodechalDecodeJpeg::DecodePrimitiveLevel()
         }
 
         CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxJpegBsdObjCmd(
-            &cmdBuffer,
+            cmdBuffer,
             &jpegBsdObject));
     }
 
-    // Check if destination surface needs to be synchronized
-    MOS_SYNC_PARAMS syncParams = g_cInitSyncParams;
-    syncParams.GpuContext = m_videoContext;
-    syncParams.presSyncResource         = &m_destSurface.OsResource;
-    syncParams.bReadOnly = false;
-    syncParams.bDisableDecodeSyncLock = m_disableDecodeSyncLock;
-    syncParams.bDisableLockForTranscode = m_disableLockForTranscode;
-
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnPerformOverlaySync(
-        m_osInterface,
-        &syncParams));
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnResourceWait(
-        m_osInterface,
-        &syncParams));
+    return MOS_STATUS_SUCCESS;
+}
 
-    // Update the resource tag (s/w tag) for On-Demand Sync
-    m_osInterface->pfnSetResourceSyncTag(m_osInterface, &syncParams);
+MOS_STATUS CodechalDecodeJpeg::SubmitPicture(
+    PMOS_COMMAND_BUFFER cmdBuffer)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
 
-    MHW_MI_FLUSH_DW_PARAMS flushDwParams;
-    MOS_ZeroMemory(&flushDwParams, sizeof(flushDwParams));
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_miInterface->AddMiFlushDwCmd(
-        &cmdBuffer,
-        &flushDwParams));
+    CODECHAL_DECODE_CHK_NULL_RETURN(cmdBuffer);
 
-    // Update the tag in GPU Sync eStatus buffer (H/W Tag) to match the current S/W tag
-    if (m_osInterface->bTagResourceSync)
+    if (m_multiFrameSubmission)
     {
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_hwInterface->WriteSyncTagToResource(
-            &cmdBuffer,
-            &syncParams));
-    }
+        if (m_statusQueryReportingEnabled)
+        {
+            // Complete the status report of this picture in place unless EndStatusReport()
+            // did, ResetStatusReport() does not send its own command buffer in batch mode
+            if (m_osInterface->bEnableKmdMediaFrameTracking || !m_osInterface->bInlineCodecStatusUpdate)
+            {
+                MHW_MI_FLUSH_DW_PARAMS flushDwParams;
+                MOS_ZeroMemory(&flushDwParams, sizeof(flushDwParams));
+                flushDwParams.pOsResource = &m_decodeStatusBuf.m_statusBuffer;
+                flushDwParams.dwDataDW1   = m_decodeStatusBuf.m_swStoreData;
+                CODECHAL_DECODE_CHK_STATUS_RETURN(m_miInterface->AddMiFlushDwCmd(
+                    cmdBuffer,
+                    &flushDwParams));
+            }
 
-    if (m_statusQueryReportingEnabled)
-    {
-        CodechalDecodeStatusReport decodeStatusReport;
-        decodeStatusReport.m_statusReportNumber = m_statusReportFeedbackNumber;
-        decodeStatusReport.m_codecStatus = CODECHAL_STATUS_UNAVAILABLE;
-        decodeStatusReport.m_currDecodedPicRes  = m_destSurface.OsResource;
+            // KMD frame tracking writes the tag once the whole command buffer completes
+            cmdBuffer->Attributes.dwMediaFrameTrackingTag = m_decodeStatusBuf.m_swStoreData;
+        }
 
-        CODECHAL_DECODE_CHK_STATUS_RETURN(EndStatusReport(
-            decodeStatusReport,
-            &cmdBuffer));
+        m_numPendingPictures++;
+        if (m_numPendingPictures < m_batchSize &&
+            !m_copiedDataBufferInUse &&
+            !m_decodeParams.m_setMarkerEnabled &&
+            !m_decodeParams.m_predicationEnabled)
+        {
+            m_osInterface->pfnReturnCommandBuffer(m_osInterface, cmdBuffer, 0);
+            return MOS_STATUS_SUCCESS;
+        }
     }
 
+    return SubmitBatch(cmdBuffer);
+}
+
+MOS_STATUS CodechalDecodeJpeg::SubmitBatch(
+    PMOS_COMMAND_BUFFER cmdBuffer)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
     CODECHAL_DECODE_CHK_STATUS_RETURN(m_miInterface->AddMiBatchBufferEnd(
-        &cmdBuffer,
+        cmdBuffer,
         nullptr));
 
-    m_osInterface->pfnReturnCommandBuffer(m_osInterface, &cmdBuffer, 0);
+    m_osInterface->pfnReturnCommandBuffer(m_osInterface, cmdBuffer, 0);
 
     CODECHAL_DEBUG_TOOL(
         CODECHAL_DECODE_CHK_STATUS_RETURN(m_debugInterface->DumpCmdBuffer(
-            &cmdBuffer,
+            cmdBuffer,
             CODECHAL_NUM_MEDIA_STATES,
             "_DEC"));
     )
@@ -946,7 +1203,7 @@ MOS_STATUS CodechalDecodeJpeg::DecodePrimitiveLevel()
     if (m_copiedDataBufferInUse)
     {
         //Sync up complete frame
-        syncParams = g_cInitSyncParams;
+        MOS_SYNC_PARAMS syncParams = g_cInitSyncParams;
         syncParams.GpuContext = m_videoContextForWa;
         syncParams.presSyncResource = &m_resSyncObjectWaContextInUse;
 
@@ -963,34 +1220,44 @@ MOS_STATUS CodechalDecodeJpeg::DecodePrimitiveLevel()
             &syncParams));
     }
 
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnSubmitCommandBuffer(
+    CODECHAL_DECODE_CHK_STATUS_RETURN(SubmitCommandBuffer(cmdBuffer));
+    m_numPendingPictures = 0;
+
+    return MOS_STATUS_SUCCESS;
+}
+
+MOS_STATUS CodechalDecodeJpeg::SubmitCommandBuffer(
+    PMOS_COMMAND_BUFFER cmdBuffer)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    return m_osInterface->pfnSubmitCommandBuffer(
         m_osInterface,
-        &cmdBuffer,
-        m_videoContextUsesNullHw));
+        cmdBuffer,
+        m_videoContextUsesNullHw);
+}
 
-    CODECHAL_DEBUG_TOOL(
-        m_mmc->UpdateUserFeatureKey(&m_destSurface);)
+MOS_STATUS CodechalDecodeJpeg::SubmitPendingPictures()
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
 
-    if (m_statusQueryReportingEnabled)
+    if (m_numPendingPictures == 0)
     {
-        CODECHAL_DECODE_CHK_STATUS_RETURN(ResetStatusReport(
-            m_videoContextUsesNullHw));
-        }
+        return MOS_STATUS_SUCCESS;
+    }
 
-    // Set output surface layout
-    SetOutputSurfaceLayout(&m_decodeParams.m_outputSurfLayout);
+    // The WA context of an earlier copy may be current
+    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnSetGpuContext(
+        m_osInterface,
+        m_videoContext));
 
-    // Send the signal to indicate decode completion, in case On-Demand Sync is not present
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnResourceSignal(
+    MOS_COMMAND_BUFFER cmdBuffer;
+    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(
         m_osInterface,
-        &syncParams));
+        &cmdBuffer,
+        0));
 
-    CODECHAL_DEBUG_TOOL(
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_debugInterface->DumpYUVSurface(
-            &m_destSurface,
-            CodechalDbgAttr::attrDecodeOutputSurface,
-            "DstSurf"));)
-    return eStatus;
+    return SubmitBatch(&cmdBuffer);
 }
 
 MOS_STATUS CodechalDecodeJpeg::InitMmcState()
@@ -1028,6 +1295,17 @@ MOS_STATUS CodechalDecodeJpeg::AllocateStandard(
     m_width = settings->width;
     m_height = settings->height;
 
+    MOS_USER_FEATURE_VALUE_DATA userFeatureData;
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_JPEG_DECODE_BATCH_SIZE_ID,
+        &userFeatureData);
+    m_batchSize = MOS_CLAMP_MIN_MAX(userFeatureData.u32Data, 1, CODECHAL_DECODE_JPEG_MAX_BATCH_SIZE);
+
+    // Several pictures are recorded into one command buffer before it is submitted
+    m_multiFrameSubmission = (m_batchSize > 1);
+
 #ifdef _DECODE_PROCESSING_SUPPORTED
     CODECHAL_DECODE_CHK_STATUS_RETURN(m_sfcState->InitializeSfcState(
         this,
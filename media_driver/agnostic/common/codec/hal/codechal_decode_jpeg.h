@@ -38,6 +38,24 @@
 //!
 #define CODECHAL_DECODE_JPEG_BLOCK_SIZE            8
 
+//!
+//! \def CODECHAL_DECODE_JPEG_MAX_BATCH_SIZE
+//! Max pictures in one command buffer, keeps the resources of a batch within the OS allocation list
+//!
+#define CODECHAL_DECODE_JPEG_MAX_BATCH_SIZE        16
+
+//!
+//! \def CODECHAL_DECODE_JPEG_TABLE_CACHE_SIZE
+//! Number of QM and Huffman table commands kept across pictures
+//!
+#define CODECHAL_DECODE_JPEG_TABLE_CACHE_SIZE      16
+
+//!
+//! \def CODECHAL_DECODE_JPEG_TABLE_CACHE_DATA_SIZE
+//! Max size of the key and of the command of a table cache entry
+//!
+#define CODECHAL_DECODE_JPEG_TABLE_CACHE_DATA_SIZE 256
+
 //!
 //! \struct _CODECHAL_DECODE_JPEG_HUFFMAN_TABLE
 //! \brief typedef of struct Huffman Table used by JPEG
@@ -54,6 +72,20 @@ typedef struct _CODECHAL_DECODE_JPEG_HUFFMAN_TABLE
     } HuffTable[JPEG_MAX_NUM_HUFF_TABLE_INDEX];
 } CODECHAL_DECODE_JPEG_HUFFMAN_TABLE, *PCODECHAL_DECODE_JPEG_HUFFMAN_TABLE;
 
+//!
+//! \struct CodechalDecodeJpegTableCacheEntry
+//! \brief  MFX_QM_STATE or MFX_JPEG_HUFF_TABLE_STATE built for a table content
+//!
+struct CodechalDecodeJpegTableCacheEntry
+{
+    uint32_t    m_hash;                                                 //!< FNV-1a hash of m_key
+    uint32_t    m_keySize;                                              //!< Bytes used in m_key
+    uint8_t     m_key[CODECHAL_DECODE_JPEG_TABLE_CACHE_DATA_SIZE];      //!< Command kind and table content the command was built from
+    uint32_t    m_cmdSize;                                              //!< Bytes used in m_cmd, 0 for a free entry
+    uint8_t     m_cmd[CODECHAL_DECODE_JPEG_TABLE_CACHE_DATA_SIZE];      //!< Command as added to the command buffer
+    uint32_t    m_lastUse;                                              //!< Use counter value of the last hit, for LRU replacement
+};
+
 typedef class CodechalDecodeJpeg *PCODECHAL_DECODE_JPEG_STATE;
 
 //!
@@ -133,6 +165,16 @@ public:
     //!
     bool IsIncompleteJpegScan() override { return m_incompleteJpegScan; }
 
+    //!
+    //! \brief    Submit the pictures recorded in the pending command buffer
+    //!
+    //! \details  Used in batch mode before the app waits on a picture or reuses its surfaces
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS SubmitPendingPictures();
+
     MOS_STATUS InitMmcState() override;
 
 #ifdef _DECODE_PROCESSING_SUPPORTED
@@ -209,7 +251,97 @@ protected:
     void SetOutputSurfaceLayout(
         CodecDecodeJpegImageLayout *outputSurfLayout);
 
+    //!
+    //! \brief    Calculate the command buffer and patch list size of a batch
+    //!
+    void CalcRequestedSpace(
+        uint32_t       &requestedSize,
+        uint32_t       &additionalSizeNeeded,
+        uint32_t       &requestedPatchListSize) override;
+
+    //!
+    //! \brief    Get the command buffer for the current picture
+    //! \details  Submits the pending pictures first if the picture does not fit
+    //!           behind them, and sends the prolog for the first picture of a batch
+    //! \param    [out] cmdBuffer
+    //!           Command buffer
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS GetPictureCommandBuffer(
+        PMOS_COMMAND_BUFFER cmdBuffer);
+
+    //!
+    //! \brief    Add the QM, Huffman table and BSD object commands of the current picture
+    //! \param    [in] cmdBuffer
+    //!           Command buffer
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS AddPictureDecodeCmds(
+        PMOS_COMMAND_BUFFER cmdBuffer);
+
+    //!
+    //! \brief    Complete the current picture in the command buffer
+    //! \details  In batch mode the command buffer is only submitted once it holds
+    //!           m_batchSize pictures, or when the picture needs the WA context
+    //! \param    [in] cmdBuffer
+    //!           Command buffer, returned to the OS interface
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS SubmitPicture(
+        PMOS_COMMAND_BUFFER cmdBuffer);
+
+    //!
+    //! \brief    Submit a command buffer to the video context
+    //! \param    [in] cmdBuffer
+    //!           Command buffer
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    virtual MOS_STATUS SubmitCommandBuffer(
+        PMOS_COMMAND_BUFFER cmdBuffer);
+
 private:
+    //!
+    //! \brief    End and submit the pending command buffer
+    //! \param    [in] cmdBuffer
+    //!           Command buffer
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS SubmitBatch(
+        PMOS_COMMAND_BUFFER cmdBuffer);
+
+    //!
+    //! \brief    Add a QM or Huffman table command, built once per table content
+    //! \param    [in] cmdBuffer
+    //!           Command buffer
+    //! \param    [in] key
+    //!           Command kind and all inputs of the command
+    //! \param    [in] keySize
+    //!           Size of key
+    //! \param    [in] qmParams
+    //!           Params to build MFX_QM_STATE with, nullptr for a Huffman table
+    //! \param    [in] huffmanTableParams
+    //!           Params to build MFX_JPEG_HUFF_TABLE_STATE with
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS AddCachedTableCmd(
+        PMOS_COMMAND_BUFFER          cmdBuffer,
+        const uint8_t               *key,
+        uint32_t                     keySize,
+        PMHW_VDBOX_QM_PARAMS         qmParams,
+        PMHW_VDBOX_HUFF_TABLE_PARAMS huffmanTableParams);
+
     //!
     //! \brief  Indicates whether or not the SFC is inuse
     //!         JPEG may not use SFC even when FtrSFCPipe == True, but it can't be known when creating device.
@@ -242,6 +374,11 @@ protected:
     MOS_RESOURCE m_resSyncObjectWaContextInUse;     //!< Signals on the video WA context
     MOS_RESOURCE m_resSyncObjectVideoContextInUse;  //!< Signals on the video context
 
+    uint32_t     m_batchSize = 1;                   //!< Number of pictures submitted in one command buffer
+
+    CodechalDecodeJpegTableCacheEntry m_tableCache[CODECHAL_DECODE_JPEG_TABLE_CACHE_SIZE] = {};  //!< Table commands of recent pictures
+    uint32_t                          m_tableCacheUseCount = 0;                                 //!< Bumped on every cache lookup
+
 #ifdef _DECODE_PROCESSING_SUPPORTED
     CodechalJpegSfcState *m_sfcState = nullptr;  //!< SFC state
 #endif
@@ -0,0 +1,270 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file     codechal_decode_scratch_pool.cpp
+//! \brief    Implements the pool of decode scratch buffers shared on one engine.
+//! \details  Decoders on the same device and GPU node share their row store buffers.
+//!
+#include "codechal_decoder.h"
+#include "codechal_decode_scratch_pool.h"
+
+CodechalDecodeScratchPool::CodechalDecodeScratchPool()
+{
+    MOS_USER_FEATURE_VALUE_DATA userFeatureData;
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_DECODE_SCRATCH_POOL_ENABLE_ID,
+        &userFeatureData);
+    m_enabled = userFeatureData.i32Data ? true : false;
+
+    if (!m_enabled)
+    {
+        return;
+    }
+
+    m_mutex = MOS_CreateMutex();
+
+    // m_mutex is destroyed after MemNinja report, this will cause fake memory leak,
+    // the following 2 lines is to circumvent Memninja counter validation and log parser
+    MosMemAllocCounter--;
+    MOS_MEMNINJA_FREE_MESSAGE(m_mutex, __FUNCTION__, __FILE__, __LINE__);
+
+    if (m_mutex == nullptr)
+    {
+        m_enabled = false;
+    }
+}
+
+CodechalDecodeScratchPool::~CodechalDecodeScratchPool()
+{
+    if (m_mutex != nullptr)
+    {
+        MOS_DestroyMutex(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+CodechalDecodeScratchPool *CodechalDecodeScratchPool::Instance()
+{
+    static CodechalDecodeScratchPool instance;
+    return &instance;
+}
+
+uint32_t CodechalDecodeScratchPool::GetSizeClass(uint32_t size)
+{
+    const uint32_t minSize = 4096;
+    if (size <= minSize)
+    {
+        return minSize;
+    }
+
+    uint32_t msb = 31;
+    while (!(size & (1u << msb)))
+    {
+        msb--;
+    }
+    uint32_t step = (1u << msb) >> 3;
+
+    return MOS_ALIGN_CEIL(size, step);
+}
+
+MOS_STATUS CodechalDecodeScratchPool::Attach(PMOS_INTERFACE osInterface, MOS_GPU_NODE node)
+{
+    CODECHAL_DECODE_CHK_NULL_RETURN(osInterface);
+
+    if (!m_enabled)
+    {
+        return MOS_STATUS_UNIMPLEMENTED;
+    }
+
+    void *device = (osInterface->pfnGetGpuContextMgr != nullptr) ?
+        (void *)osInterface->pfnGetGpuContextMgr(osInterface) : nullptr;
+    CODECHAL_DECODE_CHK_NULL_RETURN(device);
+
+    MOS_LockMutex(m_mutex);
+    Engine &engine = m_engines[EngineKey(device, node)];
+    engine.sessions.push_back(osInterface);
+    MOS_UnlockMutex(m_mutex);
+
+    return MOS_STATUS_SUCCESS;
+}
+
+void CodechalDecodeScratchPool::Detach(PMOS_INTERFACE osInterface, MOS_GPU_NODE node)
+{
+    if (!m_enabled || osInterface == nullptr || osInterface->pfnGetGpuContextMgr == nullptr)
+    {
+        return;
+    }
+
+    void *device = (void *)osInterface->pfnGetGpuContextMgr(osInterface);
+
+    MOS_LockMutex(m_mutex);
+    auto it = m_engines.find(EngineKey(device, node));
+    if (it == m_engines.end())
+    {
+        MOS_UnlockMutex(m_mutex);
+        return;
+    }
+
+    Engine &engine = it->second;
+    for (auto session = engine.sessions.begin(); session != engine.sessions.end(); session++)
+    {
+        if (*session == osInterface)
+        {
+            engine.sessions.erase(session);
+            break;
+        }
+    }
+
+    if (engine.sessions.empty())
+    {
+        for (auto &saved : engine.savedBytes)
+        {
+            CODECHAL_DECODE_NORMALMESSAGE("Scratch pool on node %d: %d sessions saved up to %llu bytes.",
+                node, saved.first, (unsigned long long)saved.second);
+        }
+
+        // Only left if a decoder did not release its buffers
+        for (auto &buffer : engine.buffers)
+        {
+            buffer.second.osInterface->pfnFreeResource(buffer.second.osInterface, &buffer.second.resource);
+        }
+        m_engines.erase(it);
+    }
+    else
+    {
+        // The OS interface goes away with the decoder
+        for (auto &buffer : engine.buffers)
+        {
+            if (buffer.second.osInterface == osInterface)
+            {
+                buffer.second.osInterface = engine.sessions.front();
+            }
+        }
+    }
+    MOS_UnlockMutex(m_mutex);
+}
+
+MOS_STATUS CodechalDecodeScratchPool::Acquire(
+    PMOS_INTERFACE  osInterface,
+    MOS_GPU_NODE    node,
+    const char      *name,
+    uint32_t        size,
+    PMOS_RESOURCE   resource)
+{
+    MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
+
+    CODECHAL_DECODE_CHK_NULL_RETURN(osInterface);
+    CODECHAL_DECODE_CHK_NULL_RETURN(name);
+    CODECHAL_DECODE_CHK_NULL_RETURN(resource);
+
+    void *device = (void *)osInterface->pfnGetGpuContextMgr(osInterface);
+    uint32_t sizeClass = GetSizeClass(size);
+
+    MOS_LockMutex(m_mutex);
+    auto engineIt = m_engines.find(EngineKey(device, node));
+    if (engineIt == m_engines.end())
+    {
+        MOS_UnlockMutex(m_mutex);
+        CODECHAL_DECODE_ASSERTMESSAGE("Scratch buffer requested before the decoder attached.");
+        return MOS_STATUS_INVALID_PARAMETER;
+    }
+
+    Engine &engine = engineIt->second;
+    auto key = std::make_pair(std::string(name), sizeClass);
+    auto bufferIt = engine.buffers.find(key);
+    if (bufferIt == engine.buffers.end())
+    {
+        Buffer buffer;
+        MOS_ZeroMemory(&buffer, sizeof(buffer));
+        buffer.size        = sizeClass;
+        buffer.osInterface = osInterface;
+
+        MOS_ALLOC_GFXRES_PARAMS allocParams;
+        MOS_ZeroMemory(&allocParams, sizeof(MOS_ALLOC_GFXRES_PARAMS));
+        allocParams.Type     = MOS_GFXRES_BUFFER;
+        allocParams.TileType = MOS_TILE_LINEAR;
+        allocParams.Format   = Format_Buffer;
+        allocParams.dwBytes  = sizeClass;
+        allocParams.pBufName = name;
+
+        eStatus = osInterface->pfnAllocateResource(
+            osInterface,
+            &allocParams,
+            &buffer.resource);
+        if (eStatus != MOS_STATUS_SUCCESS)
+        {
+            MOS_UnlockMutex(m_mutex);
+            CODECHAL_DECODE_ASSERTMESSAGE("Failed to allocate shared %s.", name);
+            return eStatus;
+        }
+
+        bufferIt = engine.buffers.insert(std::make_pair(key, buffer)).first;
+        engine.allocatedBytes += sizeClass;
+    }
+
+    *resource = bufferIt->second.resource;
+    bufferIt->second.users++;
+
+    engine.requestedBytes += size;
+    if (engine.requestedBytes > engine.allocatedBytes)
+    {
+        uint64_t &saved = engine.savedBytes[(uint32_t)engine.sessions.size()];
+        saved = MOS_MAX(saved, engine.requestedBytes - engine.allocatedBytes);
+    }
+    MOS_UnlockMutex(m_mutex);
+
+    return eStatus;
+}
+
+void CodechalDecodeScratchPool::Release(PMOS_INTERFACE osInterface, MOS_GPU_NODE node, const char *name, uint32_t size)
+{
+    if (!m_enabled || osInterface == nullptr || name == nullptr)
+    {
+        return;
+    }
+
+    void *device = (void *)osInterface->pfnGetGpuContextMgr(osInterface);
+
+    MOS_LockMutex(m_mutex);
+    auto it = m_engines.find(EngineKey(device, node));
+    if (it == m_engines.end())
+    {
+        MOS_UnlockMutex(m_mutex);
+        return;
+    }
+
+    Engine &engine = it->second;
+    engine.requestedBytes -= MOS_MIN(engine.requestedBytes, size);
+
+    // A size class nobody uses any more was superseded by a resolution change
+    auto bufferIt = engine.buffers.find(std::make_pair(std::string(name), GetSizeClass(size)));
+    if (bufferIt != engine.buffers.end() && --bufferIt->second.users == 0)
+    {
+        Buffer &buffer = bufferIt->second;
+        buffer.osInterface->pfnFreeResource(buffer.osInterface, &buffer.resource);
+        engine.allocatedBytes -= MOS_MIN(engine.allocatedBytes, buffer.size);
+        engine.buffers.erase(bufferIt);
+    }
+    MOS_UnlockMutex(m_mutex);
+}
@@ -0,0 +1,158 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file     codechal_decode_scratch_pool.h
+//! \brief    Defines the pool of decode scratch buffers shared on one engine.
+//! \details  Row store and similar scratch buffers hold no data across frames. Decoders
+//!           which submit to the same engine of a device share one copy of each buffer.
+//!
+#ifndef __CODECHAL_DECODE_SCRATCH_POOL_H__
+#define __CODECHAL_DECODE_SCRATCH_POOL_H__
+#include "mos_os.h"
+#include <map>
+#include <string>
+#include <vector>
+
+//!
+//! \class   CodechalDecodeScratchPool
+//! \brief   Device wide pool of decode scratch buffers
+//! \details Buffers are keyed by device, GPU node, buffer name and size class. Each
+//!          decoder gets its own buffer per name, so one submission never sees the same
+//!          buffer twice, but decoders on the same engine get the same buffer per name.
+//!          The buffers are registered as written by every submission that uses them,
+//!          so the kernel orders those submissions on the engine timeline.
+//!          A buffer is freed once no decoder uses it, so the size classes left
+//!          behind by a resolution change do not stay allocated until the last
+//!          decoder of the engine detaches.
+//!
+class CodechalDecodeScratchPool
+{
+public:
+    //!
+    //! \brief  Get the scratch pool
+    //! \return Pointer to the scratch pool
+    //!
+    static CodechalDecodeScratchPool *Instance();
+
+    //!
+    //! \brief  Check if scratch buffer sharing is enabled
+    //! \return true if enabled
+    //!
+    bool IsEnabled() { return m_enabled; }
+
+    //!
+    //! \brief  Register a decoder as user of the buffers of its engine
+    //! \param  [in] osInterface
+    //!         OS interface of the decoder
+    //! \param  [in] node
+    //!         GPU node the decoder submits to
+    //! \return MOS_STATUS
+    //!         MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS Attach(PMOS_INTERFACE osInterface, MOS_GPU_NODE node);
+
+    //!
+    //! \brief  Unregister a decoder
+    //! \details The decoder has released all its buffers. The buffers it allocated
+    //!          which other decoders still use are handed to one of them, so every
+    //!          buffer is freed with the OS interface of a live decoder.
+    //! \param  [in] osInterface
+    //!         OS interface of the decoder
+    //! \param  [in] node
+    //!         GPU node the decoder submits to
+    //! \return void
+    //!
+    void Detach(PMOS_INTERFACE osInterface, MOS_GPU_NODE node);
+
+    //!
+    //! \brief  Get the shared buffer for a scratch buffer request
+    //! \param  [in] osInterface
+    //!         OS interface of the decoder
+    //! \param  [in] node
+    //!         GPU node the decoder submits to
+    //! \param  [in] name
+    //!         Name of the scratch buffer, one buffer is shared per name
+    //! \param  [in] size
+    //!         Size requested by the decoder
+    //! \param  [out] resource
+    //!         Copy of the shared resource, valid until the last user of the engine detaches
+    //! \return MOS_STATUS
+    //!         MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS Acquire(
+        PMOS_INTERFACE  osInterface,
+        MOS_GPU_NODE    node,
+        const char      *name,
+        uint32_t        size,
+        PMOS_RESOURCE   resource);
+
+    //!
+    //! \brief  Return a scratch buffer request
+    //! \details The buffer is freed when this was its last user
+    //! \param  [in] osInterface
+    //!         OS interface of the decoder
+    //! \param  [in] node
+    //!         GPU node the decoder submits to
+    //! \param  [in] name
+    //!         Name passed to Acquire()
+    //! \param  [in] size
+    //!         Size passed to Acquire()
+    //! \return void
+    //!
+    void Release(PMOS_INTERFACE osInterface, MOS_GPU_NODE node, const char *name, uint32_t size);
+
+private:
+    CodechalDecodeScratchPool();
+    ~CodechalDecodeScratchPool();
+
+    //!
+    //! \brief  Round a size up to its size class
+    //! \details Size classes are 4KB minimum and 1/8 of a power of two apart above,
+    //!          which bounds the space wasted by sharing to 12.5%
+    //!
+    static uint32_t GetSizeClass(uint32_t size);
+
+    struct Buffer
+    {
+        MOS_RESOURCE    resource;
+        uint32_t        size;
+        uint32_t        users;          //!< Acquire() calls not yet released
+        PMOS_INTERFACE  osInterface;    //!< OS interface the buffer is freed with
+    };
+
+    struct Engine
+    {
+        std::map<std::pair<std::string, uint32_t>, Buffer> buffers;
+        std::vector<PMOS_INTERFACE> sessions;  //!< OS interfaces of the attached decoders
+        uint64_t        requestedBytes = 0;    //!< Bytes the decoders would have allocated on their own
+        uint64_t        allocatedBytes = 0;    //!< Bytes allocated for the shared buffers
+        std::map<uint32_t, uint64_t> savedBytes; //!< Max bytes saved per session count
+    };
+
+    typedef std::pair<void *, MOS_GPU_NODE> EngineKey;
+
+    std::map<EngineKey, Engine> m_engines;
+    PMOS_MUTEX                  m_mutex   = nullptr;
+    bool                        m_enabled = false;
+};
+
+#endif  // __CODECHAL_DECODE_SCRATCH_POOL_H__
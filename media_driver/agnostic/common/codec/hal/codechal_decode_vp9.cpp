@@ -47,41 +47,25 @@ CodechalDecodeVp9 :: ~CodechalDecodeVp9 ()
 
     if (!Mos_ResourceIsNull(&m_resDeblockingFilterLineRowStoreScratchBuffer))
     {
-        m_osInterface->pfnFreeResource(
-            m_osInterface,
-            &m_resDeblockingFilterLineRowStoreScratchBuffer);
+        FreeScratchBuffer(&m_resDeblockingFilterLineRowStoreScratchBuffer);
     }
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resDeblockingFilterTileRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resDeblockingFilterTileRowStoreScratchBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resDeblockingFilterColumnRowStoreScratchBuffer);
+    FreeScratchBuffer(&m_resDeblockingFilterColumnRowStoreScratchBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMetadataLineBuffer);
+    FreeScratchBuffer(&m_resMetadataLineBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMetadataTileLineBuffer);
+    FreeScratchBuffer(&m_resMetadataTileLineBuffer);
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resMetadataTileColumnBuffer);
+    FreeScratchBuffer(&m_resMetadataTileColumnBuffer);
 
     if (!Mos_ResourceIsNull(&m_resHvcLineRowstoreBuffer))
     {
-        m_osInterface->pfnFreeResource(
-            m_osInterface,
-            &m_resHvcLineRowstoreBuffer);
+        FreeScratchBuffer(&m_resHvcLineRowstoreBuffer);
     }
 
-    m_osInterface->pfnFreeResource(
-        m_osInterface,
-        &m_resHvcTileRowstoreBuffer);
+    FreeScratchBuffer(&m_resHvcTileRowstoreBuffer);
 
     for (uint8_t i = 0; i < CODEC_VP9_NUM_CONTEXTS + 1; i++)
     {
@@ -654,9 +638,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resDeblockingFilterLineRowStoreScratchBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resDeblockingFilterLineRowStoreScratchBuffer);
+                FreeScratchBuffer(&m_resDeblockingFilterLineRowStoreScratchBuffer);
             }
 
             // Deblocking Filter Line Row Store Scratch data surface
@@ -664,7 +646,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
                 MHW_VDBOX_HCP_INTERNAL_BUFFER_DBLK_LINE,
                 &hcpBufSizeParam));
 
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resDeblockingFilterLineRowStoreScratchBuffer,
                                                           hcpBufSizeParam.dwBufferSize,
                                                           "DeblockingLineScratchBuffer"),
@@ -680,9 +662,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resDeblockingFilterTileRowStoreScratchBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resDeblockingFilterTileRowStoreScratchBuffer);
+            FreeScratchBuffer(&m_resDeblockingFilterTileRowStoreScratchBuffer);
         }
 
         // Deblocking Filter Tile Row Store Scratch data surface
@@ -690,7 +670,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
             MHW_VDBOX_HCP_INTERNAL_BUFFER_DBLK_TILE_LINE,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resDeblockingFilterTileRowStoreScratchBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "DeblockingTileScratchBuffer"),
@@ -705,16 +685,14 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resDeblockingFilterColumnRowStoreScratchBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resDeblockingFilterColumnRowStoreScratchBuffer);
+            FreeScratchBuffer(&m_resDeblockingFilterColumnRowStoreScratchBuffer);
         }
         // Deblocking Filter Column Row Store Scratch data surface
         CODECHAL_DECODE_CHK_STATUS_RETURN(m_hcpInterface->GetVp9BufferSize(
             MHW_VDBOX_HCP_INTERNAL_BUFFER_DBLK_TILE_COL,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resDeblockingFilterColumnRowStoreScratchBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "DeblockingColumnScratchBuffer"),
@@ -731,9 +709,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resMetadataLineBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resMetadataLineBuffer);
+                FreeScratchBuffer(&m_resMetadataLineBuffer);
             }
 
             // Metadata Line buffer
@@ -741,7 +717,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
                 MHW_VDBOX_HCP_INTERNAL_BUFFER_META_LINE,
                 &hcpBufSizeParam));
 
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resMetadataLineBuffer,
                                                           hcpBufSizeParam.dwBufferSize,
                                                           "MetadataLineBuffer"),
@@ -757,16 +733,14 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resMetadataTileLineBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resMetadataTileLineBuffer);
+            FreeScratchBuffer(&m_resMetadataTileLineBuffer);
         }
         // Metadata Tile Line buffer
         CODECHAL_DECODE_CHK_STATUS_RETURN(m_hcpInterface->GetVp9BufferSize(
             MHW_VDBOX_HCP_INTERNAL_BUFFER_META_TILE_LINE,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resMetadataTileLineBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "MetadataTileLineBuffer"),
@@ -781,16 +755,14 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resMetadataTileColumnBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resMetadataTileColumnBuffer);
+            FreeScratchBuffer(&m_resMetadataTileColumnBuffer);
         }
         // Metadata Tile Column buffer
         CODECHAL_DECODE_CHK_STATUS_RETURN(m_hcpInterface->GetVp9BufferSize(
         MHW_VDBOX_HCP_INTERNAL_BUFFER_META_TILE_COL,
         &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resMetadataTileColumnBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "MetadataTileColumnBuffer"),
@@ -807,9 +779,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
         {
             if (!Mos_ResourceIsNull(&m_resHvcLineRowstoreBuffer))
             {
-                m_osInterface->pfnFreeResource(
-                    m_osInterface,
-                    &m_resHvcLineRowstoreBuffer);
+                FreeScratchBuffer(&m_resHvcLineRowstoreBuffer);
             }
 
             // HVC Line Row Store Buffer
@@ -817,7 +787,7 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
                 MHW_VDBOX_VP9_INTERNAL_BUFFER_HVD_LINE,
                 &hcpBufSizeParam));
 
-            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+            CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                           &m_resHvcLineRowstoreBuffer,
                                                           hcpBufSizeParam.dwBufferSize,
                                                           "HvcLineRowStoreBuffer"),
@@ -833,16 +803,14 @@ MOS_STATUS CodechalDecodeVp9 :: AllocateResourcesVariableSizes()
     {
         if (!Mos_ResourceIsNull(&m_resHvcTileRowstoreBuffer))
         {
-            m_osInterface->pfnFreeResource(
-                m_osInterface,
-                &m_resHvcTileRowstoreBuffer);
+            FreeScratchBuffer(&m_resHvcTileRowstoreBuffer);
         }
         // HVC Tile Row Store Buffer
         CODECHAL_DECODE_CHK_STATUS_RETURN(m_hcpInterface->GetVp9BufferSize(
             MHW_VDBOX_VP9_INTERNAL_BUFFER_HVD_TILE,
             &hcpBufSizeParam));
 
-        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateBuffer(
+        CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(AllocateScratchBuffer(
                                                       &m_resHvcTileRowstoreBuffer,
                                                       hcpBufSizeParam.dwBufferSize,
                                                       "HvcTileRowStoreBuffer"),
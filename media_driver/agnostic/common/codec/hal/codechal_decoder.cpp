@@ -28,6 +28,7 @@
 #include "codechal_decoder.h"
 #include "codechal_secure_decode_interface.h"
 #include "mos_solo_generic.h"
+#include "mos_metrics.h"
 #include "codechal_debug.h"
 #include "codechal_decode_histogram.h"
 
@@ -113,6 +114,47 @@ MOS_STATUS CodechalDecode::AllocateBuffer(
     return eStatus;
 }
 
+MOS_STATUS CodechalDecode::AllocateScratchBuffer(
+    PMOS_RESOURCE   resource,
+    uint32_t        size,
+    const char      *name)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    CODECHAL_DECODE_CHK_NULL_RETURN(resource);
+
+    if (m_scratchPool == nullptr)
+    {
+        return AllocateBuffer(resource, size, name);
+    }
+
+    CODECHAL_DECODE_CHK_STATUS_MESSAGE_RETURN(m_scratchPool->Acquire(
+        m_osInterface,
+        m_videoGpuNode,
+        name,
+        size,
+        resource),
+        "Failed to get shared scratch buffer.");
+    m_sharedScratchBuffers[resource] = std::make_pair(std::string(name), size);
+
+    return MOS_STATUS_SUCCESS;
+}
+
+void CodechalDecode::FreeScratchBuffer(PMOS_RESOURCE resource)
+{
+    auto it = m_sharedScratchBuffers.find(resource);
+    if (it == m_sharedScratchBuffers.end())
+    {
+        m_osInterface->pfnFreeResource(m_osInterface, resource);
+        return;
+    }
+
+    // The pool owns the buffer, drop the copy of the resource
+    m_scratchPool->Release(m_osInterface, m_videoGpuNode, it->second.first.c_str(), it->second.second);
+    m_sharedScratchBuffers.erase(it);
+    MOS_ZeroMemory(resource, sizeof(*resource));
+}
+
 MOS_STATUS CodechalDecode::AllocateSurface(
     PMOS_SURFACE    surface,
     uint32_t        width,
@@ -276,6 +318,11 @@ MOS_STATUS CodechalDecode::CreateGpuContexts(
     gpuNodeLimit.bHcpInUse = m_hcpInUse;
     gpuNodeLimit.bSfcInUse = IsSfcInUse(codecHalSettings);
 
+    // Weigh this session's submissions by frame size when balancing VDBoxes
+    m_osInterface->dwVdboxWorkload =
+        CODECHAL_GET_WIDTH_IN_MACROBLOCKS(codecHalSettings->width) *
+        CODECHAL_GET_HEIGHT_IN_MACROBLOCKS(codecHalSettings->height);
+
     CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->FindGpuNodeToUse(
         &gpuNodeLimit));
 
@@ -498,6 +545,15 @@ MOS_STATUS CodechalDecode::Allocate (CodechalSetting * codecHalSettings)
         // Set Vdbox index in use
         m_vdboxIndex = (m_videoGpuNode == MOS_GPU_NODE_VIDEO2)? MHW_VDBOX_NODE_2 : MHW_VDBOX_NODE_1;
 
+        // Share scratch buffers with the decoders on the same engine. With virtual engine the
+        // kernel may run the decoders on different VDBoxes, so keep the buffers private.
+        CodechalDecodeScratchPool *scratchPool = CodechalDecodeScratchPool::Instance();
+        if (scratchPool->IsEnabled() && !MOS_VE_SUPPORTED(m_osInterface) &&
+            scratchPool->Attach(m_osInterface, m_videoGpuNode) == MOS_STATUS_SUCCESS)
+        {
+            m_scratchPool = scratchPool;
+        }
+
         // Set FrameCrc reg offset
         if (m_standard == CODECHAL_HEVC)
         {
@@ -634,6 +690,17 @@ CodechalDecode::~CodechalDecode()
         m_decodeHistogram = nullptr;
     }
 
+    if (m_scratchPool != nullptr)
+    {
+        for (auto &buffer : m_sharedScratchBuffers)
+        {
+            m_scratchPool->Release(m_osInterface, m_videoGpuNode, buffer.second.first.c_str(), buffer.second.second);
+        }
+        m_sharedScratchBuffers.clear();
+        m_scratchPool->Detach(m_osInterface, m_videoGpuNode);
+        m_scratchPool = nullptr;
+    }
+
     if (MEDIA_IS_SKU(m_skuTable, FtrVcs2) && (m_videoGpuNode < MOS_GPU_NODE_MAX))
     {
         // Destroy decode video node association
@@ -702,6 +769,20 @@ void CodechalDecode::CalcRequestedSpace(
     additionalSizeNeeded = COMMAND_BUFFER_RESERVED_SPACE;
 }
 
+void CodechalDecode::ResetBaseStreamState()
+{
+    m_frameNum          = 0;
+    m_secondField       = false;
+    m_incompletePicture = false;
+    m_firstExecuteCall  = false;
+    MOS_ZeroMemory(&m_crrPic, sizeof(m_crrPic));
+
+    // Reports of the previous stream are never queried, drop them so the
+    // first report of the new stream is the first one returned
+    m_decodeStatusBuf.m_firstIndex = m_decodeStatusBuf.m_currIndex;
+    m_statusReportFeedbackNumber   = 0;
+}
+
 MOS_STATUS CodechalDecode::VerifySpaceAvailable ()
 {
     MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
@@ -1031,7 +1112,8 @@ MOS_STATUS CodechalDecode::Execute(void *params)
             m_osInterface,
             m_videoContext));
     }
-    if (!m_incompletePicture)
+    // Keep the OS states of pictures already recorded in the pending command buffer
+    if (!m_incompletePicture && m_numPendingPictures == 0)
     {
         m_osInterface->pfnResetOsStates(m_osInterface);
     }
@@ -1306,7 +1388,8 @@ MOS_STATUS CodechalDecode::ResetStatusReport(
     CODECHAL_DECODE_FUNCTION_ENTER;
 
     if (!m_osInterface->bEnableKmdMediaFrameTracking &&
-        !m_osInterface->bInlineCodecStatusUpdate)
+        !m_osInterface->bInlineCodecStatusUpdate &&
+        !m_multiFrameSubmission)
     {
         MOS_COMMAND_BUFFER cmdBuffer;
         CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(
@@ -1346,6 +1429,7 @@ MOS_STATUS CodechalDecode::GetStatusReport(
     MOS_STATUS  eStatus             = MOS_STATUS_SUCCESS;
 
     CODECHAL_DECODE_FUNCTION_ENTER;
+    MOS_METRICS_SCOPE(MOS_METRIC_DECODE_STATUS_REPORT);
 
     CODECHAL_DECODE_CHK_NULL_RETURN(status);
     CodechalDecodeStatusReport *codecStatus = (CodechalDecodeStatusReport *)status;
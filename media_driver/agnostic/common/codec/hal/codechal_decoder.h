@@ -40,6 +40,7 @@
 #include "cm_wrapper.h"
 #include "media_perf_profiler.h"
 #include "codec_def_cenc_decode.h"
+#include "codechal_decode_scratch_pool.h"
 
 class CodechalSecureDecodeInterface;
 class CodechalDecodeHistogram;
@@ -373,6 +374,32 @@ public:
         bool initialize = false,
         uint8_t value = 0);
 
+    //!
+    //! \brief  Help function to allocate a scratch buffer which holds no data across frames
+    //! \details The buffer is shared with the other decoders on the same engine when the
+    //!          decode scratch pool is enabled, else it is allocated by AllocateBuffer()
+    //! \param  [in,out] resource
+    //!         Pointer to allocated buffer
+    //! \param  [in] size
+    //!         Buffer size
+    //! \param  [in] name
+    //!         Buffer name, decoders share one buffer per name
+    //! \return MOS_STATUS
+    //!         MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS AllocateScratchBuffer(
+        PMOS_RESOURCE resource,
+        uint32_t size,
+        const char* name);
+
+    //!
+    //! \brief  Free a buffer allocated by AllocateScratchBuffer()
+    //! \param  [in,out] resource
+    //!         Pointer to the buffer
+    //! \return void
+    //!
+    void FreeScratchBuffer(PMOS_RESOURCE resource);
+
     //!
     //! \brief    Help function to allocate a NV12 TILE_Y surface
     //! \details  Help function to allocate a NV12 TILE_Y surface for each decode standard
@@ -589,12 +616,27 @@ public:
     //!
     bool IsIncompletePicture() { return m_incompletePicture; }
 
+    //!
+    //! \brief  Get number of pictures waiting for submission
+    //! \return Number of pending pictures \see m_numPendingPictures
+    //!
+    uint32_t GetNumPendingPictures() { return m_numPendingPictures; }
+
     //!
     //! \brief  Indicates whether or not the jpeg scan is incomplete
     //! \return If jpeg scan is incomplete \see m_incompleteJpegScan
     //!
     virtual bool IsIncompleteJpegScan() { return false; }
 
+    //!
+    //! \brief  Reset per-stream decode state so the instance can start a new stream
+    //! \details Resolution dependent allocations are kept. Used by the DDI to recycle
+    //!          decode contexts across vaDestroyContext/vaCreateContext.
+    //! \return MOS_STATUS
+    //!         MOS_STATUS_SUCCESS if reset, MOS_STATUS_UNIMPLEMENTED if the standard can't be recycled
+    //!
+    virtual MOS_STATUS ResetStreamState() { return MOS_STATUS_UNIMPLEMENTED; }
+
     //!
     //! \brief  Gets flags which indicates whether video context uses null hardware
     //! \return Flags which indicates whether video context uses null hardware \see m_videoContextUsesNullHw
@@ -784,8 +826,6 @@ protected:
 
 #endif
 
-private:
-
     //!
     //! \brief    Calculate command buffer size needed for picture level and slice level commands
     //! \param    [out] requestedSize
@@ -801,6 +841,8 @@ private:
         uint32_t       &additionalSizeNeeded,
         uint32_t       &requestedPatchListSize);
 
+private:
+
     //!
     //! \brief  Verify command buffer size and patch list size, reallocate if required
     //! \return MOS_STATUS
@@ -879,6 +921,14 @@ private:
     //!
     void DeallocateRefSurfaces();
 
+    //!
+    //! \brief    Reset the stream state shared by all decode standards
+    //! \details  Called by the ResetStreamState() overrides of the standards.
+    //!           Pending status reports of the previous stream are dropped.
+    //! \return   N/A
+    //!
+    void ResetBaseStreamState();
+
 protected:
     //! \brief Mfx Interface
     MhwVdboxMfxInterface        *m_mfxInterface     = nullptr;
@@ -940,6 +990,10 @@ protected:
     bool                        m_incompletePicture = false;
     //! \brief Indicates if current is frist execution call in multiple execution call mode
     bool                        m_firstExecuteCall  = false;
+    //! \brief Several pictures share one command buffer, status data is stored inline per picture
+    bool                        m_multiFrameSubmission = false;
+    //! \brief Pictures recorded in the command buffer but not submitted yet
+    uint32_t                    m_numPendingPictures = 0;
     //! \brief Indicates if current is frist execution call in multiple execution call mode
     bool                        m_consecutiveMbErrorConcealmentInUse = false;
     //! \brief Indicates if phantom MBs is required for MPEG2 decode
@@ -1022,6 +1076,11 @@ protected:
 
     // CencDecode buffer
     CencDecodeShareBuf          *m_cencBuf    = nullptr;
+
+    //! \brief Scratch buffer pool of the engine, nullptr if scratch buffers are private
+    CodechalDecodeScratchPool   *m_scratchPool = nullptr;
+    //! \brief Scratch buffers taken from the pool and their names and requested sizes
+    std::map<PMOS_RESOURCE, std::pair<std::string, uint32_t>> m_sharedScratchBuffers;
 };
 
 #endif  // __CODECHAL_DECODER_H__
@@ -28,6 +28,7 @@
 #include "codechal_encode_avc.h"
 #include "codechal_encode_wp.h"
 #include "codeckrnheader.h"
+#include "mos_copy.h"
 
 #define CODECHAL_ENCODE_AVC_BRC_CONSTANTSURFACE_POCS_IN_DPB_LIST_SIZE       128
 #define CODECHAL_ENCODE_AVC_BRC_CONSTANTSURFACE_POCS_IN_FINAL_LIST_SIZE     128
@@ -1856,6 +1857,7 @@ void CodechalEncodeAvcEnc::InitializeDataMember()
     MOS_ZeroMemory(&PreProcBindingTable, sizeof(CODECHAL_ENCODE_AVC_BINDING_TABLE_PREPROC));
 
     MOS_ZeroMemory(&BrcBuffers, sizeof(EncodeBrcBuffers));
+    MOS_ZeroMemory(MbBrcConstDataKey, sizeof(MbBrcConstDataKey));
     usAVBRAccuracy = 0;
     usAVBRConvergence = 0;
     dBrcInitCurrentTargetBufFullInBits = 0;
@@ -2574,15 +2576,8 @@ MOS_STATUS CodechalEncodeAvcEnc::InitMbBrcConstantDataBuffer(PCODECHAL_ENCODE_AV
 
     if (params->bPreProcEnable)
     {
-        eStatus = MOS_SecureMemcpy(pData, size * sizeof(uint32_t), (void*)PreProcFtqLut_Cm_Common, size * sizeof(uint32_t));
-        if (eStatus != MOS_STATUS_SUCCESS)
-        {
-            CODECHAL_ENCODE_ASSERTMESSAGE("Failed to copy memory.");
-            m_osInterface->pfnUnlockResource(
-                m_osInterface,
-                params->presBrcConstantDataBuffer);
-            return eStatus;
-        }
+        // The lock is uncached, stream whole lines into it
+        MosCopy_Copy(pData, PreProcFtqLut_Cm_Common, size * sizeof(uint32_t), MOS_COPY_MEMORY_TO_WC);
     }
     else
     {
@@ -2602,15 +2597,7 @@ MOS_STATUS CodechalEncodeAvcEnc::InitMbBrcConstantDataBuffer(PCODECHAL_ENCODE_AV
             return eStatus;
         }
 
-        eStatus = MOS_SecureMemcpy(pData, size * sizeof(uint32_t), (void*)MBBrcConstantData_Cm_Common[tableIdx], size * sizeof(uint32_t));
-        if (eStatus != MOS_STATUS_SUCCESS)
-        {
-            CODECHAL_ENCODE_ASSERTMESSAGE("Failed to copy memory.");
-            m_osInterface->pfnUnlockResource(
-                m_osInterface,
-                params->presBrcConstantDataBuffer);
-            return eStatus;
-        }
+        MosCopy_Copy(pData, MBBrcConstantData_Cm_Common[tableIdx], size * sizeof(uint32_t), MOS_COPY_MEMORY_TO_WC);
 
         uint32_t* databk = pData;
         uint8_t qp = 0;
@@ -2703,6 +2690,80 @@ MOS_STATUS CodechalEncodeAvcEnc::InitMbBrcConstantDataBuffer(PCODECHAL_ENCODE_AV
     return eStatus;
 }
 
+MOS_STATUS CodechalEncodeAvcEnc::UpdateMbBrcConstantDataBuffer(PCODECHAL_ENCODE_AVC_INIT_MBBRC_CONSTANT_DATA_BUFFER_PARAMS params)
+{
+    MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
+
+    CODECHAL_ENCODE_FUNCTION_ENTER;
+
+    CODECHAL_ENCODE_CHK_NULL_RETURN(params);
+
+    uint32_t bufIdx = 0;
+    while (bufIdx < CODECHAL_ENCODE_RECYCLED_BUFFER_NUM &&
+           params->presBrcConstantDataBuffer != &BrcBuffers.resMbBrcConstDataBuffer[bufIdx])
+    {
+        bufIdx++;
+    }
+    if (bufIdx == CODECHAL_ENCODE_RECYCLED_BUFFER_NUM)
+    {
+        return InitMbBrcConstantDataBuffer(params);
+    }
+
+    // Build the key the same way InitMbBrcConstantDataBuffer reads the params
+    CODECHAL_ENCODE_AVC_MBBRC_CONSTANT_DATA_KEY key;
+    MOS_ZeroMemory(&key, sizeof(key));
+    key.bValid          = true;
+    key.bPreProcEnable  = params->bPreProcEnable;
+    if (!params->bPreProcEnable)
+    {
+        CODECHAL_ENCODE_CHK_NULL_RETURN(params->pPicParams);
+
+        key.wPictureCodingType          = params->wPictureCodingType;
+        key.bBlockBasedSkipEnable       = params->dwMbEncBlockBasedSkipEn ? true : false;
+        key.bTransform8x8ModeFlag       = params->pPicParams->transform_8x8_mode_flag ? true : false;
+        key.bSkipBiasAdjustmentEnable   = params->bSkipBiasAdjustmentEnable;
+        key.bAdaptiveIntraScalingEnable = params->bAdaptiveIntraScalingEnable;
+        key.bOldModeCostEnable          = params->bOldModeCostEnable;
+        key.bEnableKernelTrellis        = params->bEnableKernelTrellis;
+        if (params->bEnableKernelTrellis)
+        {
+            MOS_SecureMemcpy(key.Lambda, sizeof(key.Lambda), params->Lambda, sizeof(params->Lambda));
+        }
+        if (params->pAvcQCParams)
+        {
+            key.bFTQSkipThresholdLUTInput    = params->pAvcQCParams->FTQSkipThresholdLUTInput ? true : false;
+            key.bNonFTQSkipThresholdLUTInput = params->pAvcQCParams->NonFTQSkipThresholdLUTInput ? true : false;
+            if (key.bFTQSkipThresholdLUTInput)
+            {
+                MOS_SecureMemcpy(key.FTQSkipThresholdLUT, sizeof(key.FTQSkipThresholdLUT),
+                    params->pAvcQCParams->FTQSkipThresholdLUT, sizeof(params->pAvcQCParams->FTQSkipThresholdLUT));
+            }
+            if (key.bNonFTQSkipThresholdLUTInput)
+            {
+                MOS_SecureMemcpy(key.NonFTQSkipThresholdLUT, sizeof(key.NonFTQSkipThresholdLUT),
+                    params->pAvcQCParams->NonFTQSkipThresholdLUT, sizeof(params->pAvcQCParams->NonFTQSkipThresholdLUT));
+            }
+        }
+    }
+
+    if (m_newSeq)
+    {
+        MOS_ZeroMemory(MbBrcConstDataKey, sizeof(MbBrcConstDataKey));
+    }
+
+    // The buffer is only read by the kernels, so a matching key means its content is still in place
+    if (memcmp(&MbBrcConstDataKey[bufIdx], &key, sizeof(key)) == 0)
+    {
+        return eStatus;
+    }
+
+    MbBrcConstDataKey[bufIdx].bValid = false;
+    CODECHAL_ENCODE_CHK_STATUS_RETURN(InitMbBrcConstantDataBuffer(params));
+    MbBrcConstDataKey[bufIdx] = key;
+
+    return eStatus;
+}
+
 MOS_STATUS CodechalEncodeAvcEnc::CalcLambdaTable(
         uint16_t slice_type,
         uint32_t* lambda)
@@ -3682,7 +3743,7 @@ MOS_STATUS CodechalEncodeAvcEnc::MbEncKernel(bool mbEncIFrameDistInUse)
                 &initMbBrcConstantDataBufferParams.Lambda[0][0]));
         }
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
 
         // dump MbBrcLut
         CODECHAL_DEBUG_TOOL(CODECHAL_ENCODE_CHK_STATUS_RETURN(m_debugInterface->DumpBuffer(
@@ -7599,6 +7660,7 @@ MOS_STATUS CodechalEncodeAvcEnc::AllocateResourcesBrc()
         m_osInterface->pfnUnlockResource(
             m_osInterface,
             &BrcBuffers.resMbBrcConstDataBuffer[i]);
+        MbBrcConstDataKey[i].bValid = false;
     }
 
     // Use a separate surface MbEnc DSH data
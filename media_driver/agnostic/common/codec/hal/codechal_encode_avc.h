@@ -111,6 +111,29 @@ typedef struct _CODECHAL_ENCODE_AVC_INIT_MBBRC_CONSTANT_DATA_BUFFER_PARAMS
     uint32_t                                    Lambda[52][2];
 } CODECHAL_ENCODE_AVC_INIT_MBBRC_CONSTANT_DATA_BUFFER_PARAMS, *PCODECHAL_ENCODE_AVC_INIT_MBBRC_CONSTANT_DATA_BUFFER_PARAMS;
 
+//!
+//! \brief    Inputs the content of an MbBrc constant data buffer depends on
+//! \details  Zeroed before it is filled so that two keys can be compared with memcmp.
+//!           Inputs that do not change the content in a given mode are left at zero.
+//!
+typedef struct _CODECHAL_ENCODE_AVC_MBBRC_CONSTANT_DATA_KEY
+{
+    bool                                        bValid;
+    bool                                        bPreProcEnable;
+    bool                                        bBlockBasedSkipEnable;
+    bool                                        bTransform8x8ModeFlag;
+    bool                                        bSkipBiasAdjustmentEnable;
+    bool                                        bAdaptiveIntraScalingEnable;
+    bool                                        bOldModeCostEnable;
+    bool                                        bEnableKernelTrellis;
+    bool                                        bFTQSkipThresholdLUTInput;
+    bool                                        bNonFTQSkipThresholdLUTInput;
+    uint16_t                                    wPictureCodingType;
+    uint8_t                                     FTQSkipThresholdLUT[CODEC_AVC_NUM_QP];
+    uint16_t                                    NonFTQSkipThresholdLUT[CODEC_AVC_NUM_QP];
+    uint32_t                                    Lambda[52][2];
+} CODECHAL_ENCODE_AVC_MBBRC_CONSTANT_DATA_KEY, *PCODECHAL_ENCODE_AVC_MBBRC_CONSTANT_DATA_KEY;
+
 typedef struct _CODECHAL_ENCODE_AVC_MBENC_CURBE_PARAMS
 {
     PCODEC_AVC_ENCODE_SEQUENCE_PARAMS           pSeqParams;
@@ -529,6 +552,7 @@ struct CodechalEncodeAvcEnc : public CodechalEncodeAvcBase
     CODECHAL_ENCODE_AVC_BINDING_TABLE_PREPROC       PreProcBindingTable;                                        //!< PreProc BindingTable
 
     EncodeBrcBuffers                    BrcBuffers;                                                     //!< BRC related buffers
+    CODECHAL_ENCODE_AVC_MBBRC_CONSTANT_DATA_KEY MbBrcConstDataKey[CODECHAL_ENCODE_RECYCLED_BUFFER_NUM];   //!< Content of each MbBrc constant data buffer
     uint16_t                            usAVBRAccuracy;                                                 //!< AVBR Accuracy
     uint16_t                            usAVBRConvergence;                                              //!< AVBR Convergence
     double                              dBrcInitCurrentTargetBufFullInBits;                             //!< BRC init current target buffer full in bits
@@ -930,6 +954,22 @@ struct CodechalEncodeAvcEnc : public CodechalEncodeAvcBase
     virtual MOS_STATUS InitMbBrcConstantDataBuffer(
         PCODECHAL_ENCODE_AVC_INIT_MBBRC_CONSTANT_DATA_BUFFER_PARAMS params);
 
+    //!
+    //! \brief    Initialize mbbrc constant buffer unless it already holds the same content
+    //! \details  The content only depends on the picture type and a few stream level
+    //!           settings, so once each recycled buffer has been filled most frames
+    //!           find it ready and skip the lock. Buffers outside BrcBuffers are
+    //!           always initialized.
+    //!
+    //! \param    [in] params
+    //!           Pointer to CODECHAL_ENCODE_AVC_INIT_MBBRC_CONSTANT_DATA_BUFFER_PARAMS
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS UpdateMbBrcConstantDataBuffer(
+        PCODECHAL_ENCODE_AVC_INIT_MBBRC_CONSTANT_DATA_BUFFER_PARAMS params);
+
     //!
     //! \brief    Get inter rounding value.
     //!
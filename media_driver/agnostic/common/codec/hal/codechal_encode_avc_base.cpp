@@ -566,28 +566,7 @@ MOS_STATUS CodecHalAvcEncode_GetProfileLevelMaxFrameSize(
 
 static void PutVLCCode(BSBuffer *bsbuffer, uint32_t code)
 {
-    uint8_t   leadingZeroBits, bitcount;
-    uint32_t  code1, bits;
-
-    code1 = code + 1;
-    bitcount = 0;
-    while (code1)
-    {
-        code1 >>= 1;
-        bitcount++;
-    }
-
-    if (bitcount == 1)
-    {
-        PutBit(bsbuffer, 1);
-    }
-    else
-    {
-        leadingZeroBits = bitcount - 1;
-        bits = code + 1 - (1 << leadingZeroBits);
-        PutBits(bsbuffer, 1, leadingZeroBits + 1);
-        PutBits(bsbuffer, bits, leadingZeroBits);
-    }
+    CodecHal_PutUe(bsbuffer, code);
 }
 
 //!
@@ -776,10 +755,7 @@ static void SetTrailingBits(BSBuffer *bsbuffer)
     // Write Stop Bit
     PutBits(bsbuffer, 1, 1);
     // Make byte aligned
-    while (bsbuffer->BitOffset)
-    {
-        PutBit(bsbuffer, 0);
-    }
+    CodecHal_ByteAlign(bsbuffer);
 }
 
 static void CodecHal_PackSliceHeader_SetInitialRefPicList(
@@ -1750,10 +1726,7 @@ MOS_STATUS CodecHalAvcEncode_PackSliceHeader(
     ref        = params->ppRefList[params->CurrReconPic.FrameIdx]->bUsedAsRef;
 
     // Make slice header uint8_t aligned
-    while (bsbuffer->BitOffset)
-    {
-        PutBit(bsbuffer, 0);
-    }
+    CodecHal_ByteAlign(bsbuffer);
 
     // zero byte shall exist when the byte stream NAL unit syntax structure contains the first
     // NAL unit of an access unit in decoding order, as specified by subclause 7.4.1.2.3.
@@ -57,6 +57,19 @@ MOS_STATUS CodechalEncodeJpegState::Initialize(CodechalSetting  *settings)
             &m_slicePatchListSize,
             0));
 
+    MOS_USER_FEATURE_VALUE_DATA userFeatureData;
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_JPEG_ENCODE_BATCH_SIZE_ID,
+        &userFeatureData);
+    m_batchSize = MOS_CLAMP_MIN_MAX(userFeatureData.u32Data, 1, CODECHAL_ENCODE_JPEG_MAX_BATCH_SIZE);
+
+    // Several pictures are recorded into one command buffer before it is submitted
+    m_multiFrameSubmission = (m_batchSize > 1);
+    m_picturePatchListSize *= m_batchSize;
+    m_slicePatchListSize   *= m_batchSize;
+
     return eStatus;
 }
 
@@ -80,6 +93,9 @@ void CodechalEncodeJpegState::FreeResources()
 {
     CODECHAL_ENCODE_FUNCTION_ENTER;
 
+    // Pictures still held back by batching reference resources released below
+    SubmitPendingPictures();
+
     CodechalEncoderState::FreeResources();
 
     // Release Ref Lists
@@ -577,6 +593,16 @@ MOS_STATUS CodechalEncodeJpegState::ExecutePictureLevel()
     MOS_COMMAND_BUFFER cmdBuffer;
     CODECHAL_ENCODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(m_osInterface, &cmdBuffer, 0));
 
+    // Flush the pictures already recorded if this one does not fit behind them
+    if (m_numPendingPictures > 0 &&
+        (uint32_t)cmdBuffer.iRemaining < CalculateCommandBufferSize() / m_batchSize)
+    {
+        m_osInterface->pfnReturnCommandBuffer(m_osInterface, &cmdBuffer, 0);
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(SubmitPendingPictures());
+        m_osInterface->pfnResetOsStates(m_osInterface);
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(m_osInterface, &cmdBuffer, 0));
+    }
+
     m_mode = CODECHAL_ENCODE_MODE_JPEG;
 
     // set MFX_PIPE_MODE_SELECT
@@ -628,7 +654,10 @@ MOS_STATUS CodechalEncodeJpegState::ExecutePictureLevel()
     jpegPicState.mode                   = m_mode;
 
     // Send command buffer header at the beginning (OS dependent)
-    CODECHAL_ENCODE_CHK_STATUS_RETURN(SendPrologWithFrameTracking(&cmdBuffer, true));
+    if (m_numPendingPictures == 0)
+    {
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(SendPrologWithFrameTracking(&cmdBuffer, true));
+    }
 
     CODECHAL_ENCODE_CHK_STATUS_RETURN(StartStatusReport(&cmdBuffer, CODECHAL_NUM_MEDIA_STATES));
 
@@ -669,18 +698,9 @@ MOS_STATUS CodechalEncodeJpegState::ExecuteSliceLevel()
                                         (surface->Format == Format_A8B8G8R8) ||
                                         (surface->Format == Format_X8B8G8R8)));
 
-    CodecJpegQuantMatrix *tempJpegQuantMatrix = (CodecJpegQuantMatrix *)MOS_AllocAndZeroMemory(sizeof(CodecJpegQuantMatrix));
-    CODECHAL_ENCODE_CHK_NULL_RETURN(tempJpegQuantMatrix);
-
     uint32_t numQuantTables = JPEG_MAX_NUM_QUANT_TABLE_INDEX;
     for (uint32_t scanCount = 0; scanCount < m_encodeParams.dwNumSlices; scanCount++)
     {
-        MHW_VDBOX_QM_PARAMS fqmParams;
-        MOS_ZeroMemory(&fqmParams, sizeof(fqmParams));
-
-        // set MFX_FQM_STATE
-        fqmParams.pJpegQuantMatrix = tempJpegQuantMatrix;
-
         // For monochrome inputs there will be only 1 quantization table and huffman table sent
         if (m_jpegPicParams->m_inputSurfaceFormat == codechalJpegY8)
         {
@@ -722,61 +742,6 @@ MOS_STATUS CodechalEncodeJpegState::ExecuteSliceLevel()
         }
         // else 3 quantization tables are sent by the application for non monochrome input formats. In that case, do nothing.
 
-        for (uint32_t i = 0; i < numQuantTables; i++)
-        {
-            fqmParams.pJpegQuantMatrix->m_jpegQMTableType[i] = m_jpegQuantTables->m_quantTable[i].m_tableID; // Used to distinguish between Y,U,V quantization tables for the same scan
-
-            for (auto j = 0; j < JPEG_NUM_QUANTMATRIX; j++)
-            {
-                uint32_t k = jpeg_qm_scan_8x8[j];
-
-                // copy over Quant matrix in raster order from zig zag
-                fqmParams.pJpegQuantMatrix->m_quantMatrix[i][k] = (uint8_t)m_jpegQuantTables->m_quantTable[i].m_qm[j];
-            }
-        }
-
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxJpegFqmCmd(&cmdBuffer, &fqmParams, numQuantTables));
-
-        // set MFC_JPEG_HUFF_TABLE - Convert encoded huffman table to actual table for HW
-        // We need a different params struct for JPEG Encode Huffman table because JPEG decode huffman table has Bits and codes,
-        // whereas JPEG encode huffman table has huffman code lengths and values
-        MHW_VDBOX_ENCODE_HUFF_TABLE_PARAMS   huffTableParams[JPEG_MAX_NUM_HUFF_TABLE_INDEX];
-        for (uint32_t i = 0; i < m_encodeParams.dwNumHuffBuffers; i++)
-        {
-            CodechalEncodeJpegHuffTable huffmanTable;// intermediate table for each AC/DC component which will be copied to huffTableParams
-            MOS_ZeroMemory(&huffmanTable, sizeof(huffmanTable));
-
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(ConvertHuffDataToTable(m_jpegHuffmanTable->m_huffmanData[i], &huffmanTable));
-
-            huffTableParams[m_jpegHuffmanTable->m_huffmanData[i].m_tableID].HuffTableID = m_jpegHuffmanTable->m_huffmanData[i].m_tableID;
-
-            if (m_jpegHuffmanTable->m_huffmanData[i].m_tableClass == 0) // DC table
-            {
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(
-                    huffTableParams[m_jpegHuffmanTable->m_huffmanData[i].m_tableID].pDCCodeValues,
-                    JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint16_t),
-                    &huffmanTable.m_huffCode,
-                    JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint16_t)));
-
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(huffTableParams[m_jpegHuffmanTable->m_huffmanData[i].m_tableID].pDCCodeLength,
-                    JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint8_t),
-                    &huffmanTable.m_huffSize,
-                    JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint8_t)));
-            }
-            else // AC Table
-            {
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(huffTableParams[m_jpegHuffmanTable->m_huffmanData[i].m_tableID].pACCodeValues,
-                    JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint16_t),
-                    &huffmanTable.m_huffCode,
-                    JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint16_t)));
-
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(huffTableParams[m_jpegHuffmanTable->m_huffmanData[i].m_tableID].pACCodeLength,
-                    JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint8_t),
-                    &huffmanTable.m_huffSize,
-                    JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint8_t)));
-            }
-        }
-
         // Send 2 huffman table commands - 1 for Luma and one for chroma for non-monchrome input formats
         // If only one table is sent by the app (2 buffers), send the same table for Luma and chroma
         bool repeatHuffTable = false;
@@ -813,15 +778,26 @@ MOS_STATUS CodechalEncodeJpegState::ExecuteSliceLevel()
             }
         }
 
+        // Quant matrices, Huffman tables and packed headers only change with their source data
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(UpdateTableCache(useSingleDefaultQuantTable, numQuantTables));
+
+        // set MFX_FQM_STATE
+        MHW_VDBOX_QM_PARAMS fqmParams;
+        MOS_ZeroMemory(&fqmParams, sizeof(fqmParams));
+        fqmParams.pJpegQuantMatrix = &m_cachedQuantMatrix;
+
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxJpegFqmCmd(&cmdBuffer, &fqmParams, numQuantTables));
+
+        // set MFC_JPEG_HUFF_TABLE
         // the number of huffman commands is half of the huffman buffers sent by the app, since AC and DC buffers are combined into one command
         for (uint32_t i = 0; i < m_encodeParams.dwNumHuffBuffers / 2; i++)
         {
             if (repeatHuffTable)
             {
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfcJpegHuffTableStateCmd(&cmdBuffer, &huffTableParams[i]));
+                CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfcJpegHuffTableStateCmd(&cmdBuffer, &m_cachedHuffTableParams[i]));
             }
 
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfcJpegHuffTableStateCmd(&cmdBuffer, &huffTableParams[i]));
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfcJpegHuffTableStateCmd(&cmdBuffer, &m_cachedHuffTableParams[i]));
         }
 
         // set MFC_JPEG_SCAN_OBJECT
@@ -833,34 +809,27 @@ MOS_STATUS CodechalEncodeJpegState::ExecuteSliceLevel()
         scanObjectParams.pJpegEncodeScanParams  = m_jpegScanParams;
 
         CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfcJpegScanObjCmd(&cmdBuffer, &scanObjectParams));
-        // set MFC_JPEG_PAK_INSERT_OBJECT
-        MHW_VDBOX_PAK_INSERT_PARAMS pakInsertObjectParams;
-        MOS_ZeroMemory(&pakInsertObjectParams, sizeof(pakInsertObjectParams));
 
-        // The largest component written through the MFC_JPEG_PAK_INSERT_OBJECT command is Huffman table
-        pakInsertObjectParams.pBsBuffer = (BSBuffer *)MOS_AllocAndZeroMemory(sizeof(CodechalEncodeJpegFrameHeader));
-        CODECHAL_ENCODE_CHK_NULL_RETURN(pakInsertObjectParams.pBsBuffer);
+        // set MFC_JPEG_PAK_INSERT_OBJECT
         if(!m_fullHeaderInAppData)
         {
             // Add SOI (0xFFD8) (only if it was sent by the application)
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(PackSOI(pakInsertObjectParams.pBsBuffer));
-            pakInsertObjectParams.dwOffset                      = 0;
-            pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-            pakInsertObjectParams.bLastHeader                   = false;
-            pakInsertObjectParams.bEndOfSlice                   = false;
-            pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr, &pakInsertObjectParams));
-            MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegmentCmd(&cmdBuffer, 0));
         }
         // Add Application data if it was sent by application
         if (m_applicationData != nullptr)
         {
-            uint8_t* appDataChunk = nullptr;
-            uint32_t appDataChunkSize = m_appDataSize;
+            BSBuffer bsBuffer;
+            MOS_ZeroMemory(&bsBuffer, sizeof(bsBuffer));
+
+            MHW_VDBOX_PAK_INSERT_PARAMS pakInsertObjectParams;
+            MOS_ZeroMemory(&pakInsertObjectParams, sizeof(pakInsertObjectParams));
+            pakInsertObjectParams.pBsBuffer = &bsBuffer;
 
             // We can write a maximum of 1020 words per command, so if the size of the app data is
             // more than 1020 we need to send multiple commands for writing out app data
-            uint32_t numAppDataCmdsNeeded = 1;
+            uint32_t appDataChunkSize      = m_appDataSize;
+            uint32_t numAppDataCmdsNeeded  = 1;
             uint32_t appDataCmdSizeResidue = 0;
             if (m_appDataSize > 1020)
             {
@@ -870,165 +839,68 @@ MOS_STATUS CodechalEncodeJpegState::ExecuteSliceLevel()
                 appDataChunkSize = 1020;
             }
 
-            appDataChunk = (uint8_t*)MOS_AllocAndZeroMemory(appDataChunkSize);
-            CODECHAL_ENCODE_CHK_NULL_RETURN(appDataChunk);
-
-            for (uint32_t i = 0; i < numAppDataCmdsNeeded; i++)
+            // The command carries a copy of the payload, so the chunks are inserted straight from the app data
+            for (uint32_t i = 0; i <= numAppDataCmdsNeeded; i++)
             {
-                uint8_t *copyAddress = (uint8_t*)(m_applicationData) + (i * appDataChunkSize);
-
-                MOS_SecureMemcpy(appDataChunk, appDataChunkSize,
-                    copyAddress, appDataChunkSize);
-
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(PackApplicationData(pakInsertObjectParams.pBsBuffer, appDataChunk, appDataChunkSize));
-                pakInsertObjectParams.dwOffset                      = 0;
-                pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-                //if full header is included in application data, it will be the last insert headers
-                if((appDataCmdSizeResidue == 0) && m_fullHeaderInAppData)
-                {
-                    pakInsertObjectParams.bLastHeader                   = true;
-                    pakInsertObjectParams.bEndOfSlice                   = true;
-                }
-                else
+                uint32_t chunkSize = (i < numAppDataCmdsNeeded) ? appDataChunkSize : appDataCmdSizeResidue;
+                if (chunkSize == 0)
                 {
-                    pakInsertObjectParams.bLastHeader                   = false;
-                    pakInsertObjectParams.bEndOfSlice                   = false;
+                    break;
                 }
-                pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-                    &pakInsertObjectParams));
-            }
 
-            if (appDataCmdSizeResidue != 0)
-            {
-                uint8_t* lastAddress = (uint8_t*)(m_applicationData) + (numAppDataCmdsNeeded * appDataChunkSize);
-                appDataChunkSize = appDataCmdSizeResidue;
-
-                MOS_SecureMemcpy(appDataChunk, appDataChunkSize,
-                    lastAddress,
-                    appDataChunkSize);
+                uint8_t *appDataChunk = (uint8_t*)(m_applicationData) + (i * appDataChunkSize);
+                bool     lastChunk    = (appDataCmdSizeResidue == 0) || (i == numAppDataCmdsNeeded);
 
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(PackApplicationData(pakInsertObjectParams.pBsBuffer, appDataChunk, appDataCmdSizeResidue));
+                CODECHAL_ENCODE_CHK_STATUS_RETURN(PackApplicationData(pakInsertObjectParams.pBsBuffer, appDataChunk, chunkSize));
                 pakInsertObjectParams.dwOffset                      = 0;
                 pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
                 //if full header is included in application data, it will be the last insert headers
-                if(m_fullHeaderInAppData)
-                {
-                    pakInsertObjectParams.bLastHeader                   = true;
-                    pakInsertObjectParams.bEndOfSlice                   = true;
-                }
-                else
-                {
-                    pakInsertObjectParams.bLastHeader                   = false;
-                    pakInsertObjectParams.bEndOfSlice                   = false;
-                }
+                pakInsertObjectParams.bLastHeader                   = lastChunk && m_fullHeaderInAppData;
+                pakInsertObjectParams.bEndOfSlice                   = lastChunk && m_fullHeaderInAppData;
                 pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
                 CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
                     &pakInsertObjectParams));
             }
-
-            MOS_FreeMemory(appDataChunk);
         }
         if(!m_fullHeaderInAppData)
         {
-        // Add Quant Table for Y
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(PackQuantTable(pakInsertObjectParams.pBsBuffer, jpegComponentY));
-
-        pakInsertObjectParams.dwOffset                      = 0;
-        pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-        pakInsertObjectParams.bLastHeader                   = false;
-        pakInsertObjectParams.bEndOfSlice                   = false;
-        pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-            &pakInsertObjectParams));
-        MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
-
-        if (!useSingleDefaultQuantTable)
-        {
-            // Since there is no U and V in monochrome format, donot add Quantization table header for U and V components
-            if (m_jpegPicParams->m_inputSurfaceFormat != codechalJpegY8)
+            // Add Quant Tables, Frame Header, Huffman Tables, Restart Interval and Scan Header
+            for (uint32_t i = 1; i < m_cachedHeaderSegments.size(); i++)
             {
-                // Add quant table for U
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(PackQuantTable(pakInsertObjectParams.pBsBuffer, jpegComponentU));
-                pakInsertObjectParams.dwOffset                      = 0;
-                pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-                pakInsertObjectParams.bLastHeader                   = false;
-                pakInsertObjectParams.bEndOfSlice                   = false;
-                pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-                    &pakInsertObjectParams));
-                MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
-
-                // Add quant table for V
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(PackQuantTable(pakInsertObjectParams.pBsBuffer, jpegComponentV));
-                pakInsertObjectParams.dwOffset                      = 0;
-                pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-                pakInsertObjectParams.bLastHeader                   = false;
-                pakInsertObjectParams.bEndOfSlice                   = false;
-                pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-                CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-                    &pakInsertObjectParams));
-                MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
+                CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegmentCmd(&cmdBuffer, i));
             }
         }
+    }
 
-        // Add Frame Header
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(PackFrameHeader(pakInsertObjectParams.pBsBuffer, useSingleDefaultQuantTable));
-        pakInsertObjectParams.dwOffset                      = 0;
-        pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-        pakInsertObjectParams.bLastHeader                   = false;
-        pakInsertObjectParams.bEndOfSlice                   = false;
-        pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-            &pakInsertObjectParams));
-        MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
+    CODECHAL_ENCODE_CHK_STATUS_RETURN(ReadMfcStatus(&cmdBuffer));
 
-        // Add Huffman Table for Y - DC table, Y- AC table, U/V - DC table, U/V - AC table
-        for (uint32_t i = 0; i < m_encodeParams.dwNumHuffBuffers; i++)
-        {
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(PackHuffmanTable(pakInsertObjectParams.pBsBuffer, i));
-            pakInsertObjectParams.dwOffset                      = 0;
-            pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-            pakInsertObjectParams.bLastHeader                   = false;
-            pakInsertObjectParams.bEndOfSlice                   = false;
-            pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-                &pakInsertObjectParams));
-            MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
-        }
+    CODECHAL_ENCODE_CHK_STATUS_RETURN(EndStatusReport(&cmdBuffer, CODECHAL_NUM_MEDIA_STATES));
 
-        // Restart Interval - Add only if the restart interval is not zero
-        if (m_jpegScanParams->m_restartInterval != 0)
+    if (m_multiFrameSubmission)
+    {
+        // Complete the status report of this picture in place, ResetStatusReport()
+        // does not send its own command buffer in batch mode
+        MHW_MI_FLUSH_DW_PARAMS flushDwParams;
+        MOS_ZeroMemory(&flushDwParams, sizeof(flushDwParams));
+        flushDwParams.pOsResource       = &m_encodeStatusBuf.resStatusBuffer;
+        flushDwParams.dwResourceOffset  = 0;
+        flushDwParams.dwDataDW1         = m_storeData;
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_miInterface->AddMiFlushDwCmd(&cmdBuffer, &flushDwParams));
+
+        // KMD frame tracking writes the tag once the whole command buffer completes
+        if (cmdBuffer.Attributes.bEnableMediaFrameTracking)
         {
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(PackRestartInterval(pakInsertObjectParams.pBsBuffer));
-            pakInsertObjectParams.dwOffset                      = 0;
-            pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-            pakInsertObjectParams.bLastHeader                   = false;
-            pakInsertObjectParams.bEndOfSlice                   = false;
-            pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-            CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-                &pakInsertObjectParams));
-            MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
+            cmdBuffer.Attributes.dwMediaFrameTrackingTag = m_storeData;
         }
 
-        // Add scan header
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(PackScanHeader(pakInsertObjectParams.pBsBuffer));
-        pakInsertObjectParams.dwOffset                      = 0;
-        pakInsertObjectParams.dwBitSize                     = pakInsertObjectParams.pBsBuffer->BufferSize;
-        pakInsertObjectParams.bLastHeader                   = true;
-        pakInsertObjectParams.bEndOfSlice                   = true;
-        pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxPakInsertObject(&cmdBuffer, nullptr,
-            &pakInsertObjectParams));
-        MOS_FreeMemory(pakInsertObjectParams.pBsBuffer->pBase);
+        m_numPendingPictures++;
+        if (m_numPendingPictures < m_batchSize)
+        {
+            m_osInterface->pfnReturnCommandBuffer(m_osInterface, &cmdBuffer, 0);
+            return eStatus;
         }
-        MOS_FreeMemory(pakInsertObjectParams.pBsBuffer);
     }
 
-    CODECHAL_ENCODE_CHK_STATUS_RETURN(ReadMfcStatus(&cmdBuffer));
-
-    CODECHAL_ENCODE_CHK_STATUS_RETURN(EndStatusReport(&cmdBuffer, CODECHAL_NUM_MEDIA_STATES));
-
     CODECHAL_ENCODE_CHK_STATUS_RETURN(m_miInterface->AddMiBatchBufferEnd(&cmdBuffer, nullptr));
 
     std::string pakPassName = "PAK_PASS" + std::to_string(static_cast<uint32_t>(m_currPass));
@@ -1046,16 +918,265 @@ MOS_STATUS CodechalEncodeJpegState::ExecuteSliceLevel()
     m_osInterface->pfnReturnCommandBuffer(m_osInterface, &cmdBuffer, 0);
 
     CODECHAL_ENCODE_CHK_STATUS_RETURN(m_osInterface->pfnSubmitCommandBuffer(m_osInterface, &cmdBuffer, m_renderContextUsesNullHw));
+    m_numPendingPictures = 0;
 
-    if (tempJpegQuantMatrix != nullptr)
+    return eStatus;
+}
+
+MOS_STATUS CodechalEncodeJpegState::SubmitPendingPictures()
+{
+    MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
+
+    CODECHAL_ENCODE_FUNCTION_ENTER;
+
+    if (m_numPendingPictures == 0)
     {
-        MOS_FreeMemory(tempJpegQuantMatrix);
-        tempJpegQuantMatrix = nullptr;
+        return eStatus;
     }
 
+    m_osInterface->pfnSetGpuContext(m_osInterface, m_videoContext);
+
+    MOS_COMMAND_BUFFER cmdBuffer;
+    CODECHAL_ENCODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(m_osInterface, &cmdBuffer, 0));
+
+    CODECHAL_ENCODE_CHK_STATUS_RETURN(m_miInterface->AddMiBatchBufferEnd(&cmdBuffer, nullptr));
+
+    CODECHAL_DEBUG_TOOL(
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(m_debugInterface->DumpCmdBuffer(
+            &cmdBuffer,
+            CODECHAL_NUM_MEDIA_STATES,
+            "PAK_PASS0"));
+    )
+
+    m_osInterface->pfnReturnCommandBuffer(m_osInterface, &cmdBuffer, 0);
+
+    CODECHAL_ENCODE_CHK_STATUS_RETURN(m_osInterface->pfnSubmitCommandBuffer(m_osInterface, &cmdBuffer, m_renderContextUsesNullHw));
+    m_numPendingPictures = 0;
+
     return eStatus;
 }
 
+MOS_STATUS CodechalEncodeJpegState::UpdateTableCache(
+    bool                            useSingleDefaultQuantTable,
+    uint32_t                        numQuantTables)
+{
+    CODECHAL_ENCODE_FUNCTION_ENTER;
+
+    MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
+
+    CodechalEncodeJpegTableCacheKey key;
+    MOS_ZeroMemory(&key, sizeof(key));
+    key.m_picWidth                   = m_jpegPicParams->m_picWidth;
+    key.m_picHeight                  = m_jpegPicParams->m_picHeight;
+    key.m_inputSurfaceFormat         = m_jpegPicParams->m_inputSurfaceFormat;
+    key.m_numComponent               = m_jpegPicParams->m_numComponent;
+    for (auto i = 0; i < 4; i++)
+    {
+        key.m_componentID[i]         = m_jpegPicParams->m_componentID[i];
+    }
+    key.m_restartInterval            = m_jpegScanParams->m_restartInterval;
+    key.m_numHuffBuffers             = m_encodeParams.dwNumHuffBuffers;
+    key.m_numQuantTables             = numQuantTables;
+    key.m_useSingleDefaultQuantTable = useSingleDefaultQuantTable;
+    key.m_fullHeaderInAppData        = m_fullHeaderInAppData;
+    key.m_quantTables                = *m_jpegQuantTables;
+    key.m_huffmanTable               = *m_jpegHuffmanTable;
+
+    // FNV-1a over the key rejects most changes without a full compare
+    uint32_t       hash    = 2166136261u;
+    const uint8_t *keyData = (const uint8_t *)&key;
+    for (uint32_t i = 0; i < sizeof(key); i++)
+    {
+        hash = (hash ^ keyData[i]) * 16777619u;
+    }
+
+    if (m_tableCacheValid &&
+        hash == m_tableCacheHash &&
+        memcmp(&key, &m_tableCacheKey, sizeof(key)) == 0)
+    {
+        return eStatus;
+    }
+
+    m_tableCacheValid = false;
+
+    // Quant matrices in raster order from zig zag
+    MOS_ZeroMemory(&m_cachedQuantMatrix, sizeof(m_cachedQuantMatrix));
+    for (uint32_t i = 0; i < numQuantTables; i++)
+    {
+        m_cachedQuantMatrix.m_jpegQMTableType[i] = m_jpegQuantTables->m_quantTable[i].m_tableID; // Used to distinguish between Y,U,V quantization tables for the same scan
+
+        for (auto j = 0; j < JPEG_NUM_QUANTMATRIX; j++)
+        {
+            uint32_t k = jpeg_qm_scan_8x8[j];
+            m_cachedQuantMatrix.m_quantMatrix[i][k] = (uint8_t)m_jpegQuantTables->m_quantTable[i].m_qm[j];
+        }
+    }
+
+    // Convert encoded huffman table to actual table for HW
+    // We need a different params struct for JPEG Encode Huffman table because JPEG decode huffman table has Bits and codes,
+    // whereas JPEG encode huffman table has huffman code lengths and values
+    MOS_ZeroMemory(m_cachedHuffTableParams, sizeof(m_cachedHuffTableParams));
+    for (uint32_t i = 0; i < m_encodeParams.dwNumHuffBuffers; i++)
+    {
+        uint32_t tableID = m_jpegHuffmanTable->m_huffmanData[i].m_tableID;
+        if (tableID >= JPEG_MAX_NUM_HUFF_TABLE_INDEX)
+        {
+            CODECHAL_ENCODE_ASSERTMESSAGE("Invalid Huffman table ID.");
+            return MOS_STATUS_INVALID_PARAMETER;
+        }
+
+        CodechalEncodeJpegHuffTable huffmanTable;// intermediate table for each AC/DC component which will be copied to huffTableParams
+        MOS_ZeroMemory(&huffmanTable, sizeof(huffmanTable));
+
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(ConvertHuffDataToTable(m_jpegHuffmanTable->m_huffmanData[i], &huffmanTable));
+
+        m_cachedHuffTableParams[tableID].HuffTableID = tableID;
+
+        if (m_jpegHuffmanTable->m_huffmanData[i].m_tableClass == 0) // DC table
+        {
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(
+                m_cachedHuffTableParams[tableID].pDCCodeValues,
+                JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint16_t),
+                &huffmanTable.m_huffCode,
+                JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint16_t)));
+
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(
+                m_cachedHuffTableParams[tableID].pDCCodeLength,
+                JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint8_t),
+                &huffmanTable.m_huffSize,
+                JPEG_NUM_HUFF_TABLE_DC_HUFFVAL * sizeof(uint8_t)));
+        }
+        else // AC Table
+        {
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(
+                m_cachedHuffTableParams[tableID].pACCodeValues,
+                JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint16_t),
+                &huffmanTable.m_huffCode,
+                JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint16_t)));
+
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(MOS_SecureMemcpy(
+                m_cachedHuffTableParams[tableID].pACCodeLength,
+                JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint8_t),
+                &huffmanTable.m_huffSize,
+                JPEG_NUM_HUFF_TABLE_AC_HUFFVAL * sizeof(uint8_t)));
+        }
+    }
+
+    m_cachedHeaderData.clear();
+    m_cachedHeaderSegments.clear();
+
+    if (!m_fullHeaderInAppData)
+    {
+        BSBuffer buffer;
+        MOS_ZeroMemory(&buffer, sizeof(buffer));
+
+        // SOI is inserted ahead of the application data, the other headers after it
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(PackSOI(&buffer));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+
+        // Add Quant Table for Y
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(PackQuantTable(&buffer, jpegComponentY));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+
+        // Since there is no U and V in monochrome format, donot add Quantization table header for U and V components
+        if (!useSingleDefaultQuantTable && m_jpegPicParams->m_inputSurfaceFormat != codechalJpegY8)
+        {
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(PackQuantTable(&buffer, jpegComponentU));
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(PackQuantTable(&buffer, jpegComponentV));
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+        }
+
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(PackFrameHeader(&buffer, useSingleDefaultQuantTable));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+
+        // Add Huffman Table for Y - DC table, Y- AC table, U/V - DC table, U/V - AC table
+        for (uint32_t i = 0; i < m_encodeParams.dwNumHuffBuffers; i++)
+        {
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(PackHuffmanTable(&buffer, i));
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+        }
+
+        // Restart Interval - Add only if the restart interval is not zero
+        if (m_jpegScanParams->m_restartInterval != 0)
+        {
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(PackRestartInterval(&buffer));
+            CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+        }
+
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(PackScanHeader(&buffer));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(AddHeaderSegment(&buffer));
+    }
+
+    m_tableCacheKey   = key;
+    m_tableCacheHash  = hash;
+    m_tableCacheValid = true;
+
+    return eStatus;
+}
+
+MOS_STATUS CodechalEncodeJpegState::AddHeaderSegment(
+    BSBuffer                        *buffer)
+{
+    CODECHAL_ENCODE_FUNCTION_ENTER;
+
+    MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
+
+    CODECHAL_ENCODE_CHK_NULL_RETURN(buffer);
+    CODECHAL_ENCODE_CHK_NULL_RETURN(buffer->pBase);
+
+    CodechalEncodeJpegHeaderSegment segment;
+    segment.m_offset  = (uint32_t)m_cachedHeaderData.size();
+    segment.m_bitSize = buffer->BufferSize;
+
+    uint32_t byteSize = (buffer->BufferSize + 7) >> 3;
+    m_cachedHeaderData.insert(m_cachedHeaderData.end(), buffer->pBase, buffer->pBase + byteSize);
+    // Keep every segment DWORD aligned
+    m_cachedHeaderData.resize(MOS_ALIGN_CEIL(m_cachedHeaderData.size(), sizeof(uint32_t)), 0);
+    m_cachedHeaderSegments.push_back(segment);
+
+    MOS_FreeMemory(buffer->pBase);
+    buffer->pBase = nullptr;
+
+    return eStatus;
+}
+
+MOS_STATUS CodechalEncodeJpegState::AddHeaderSegmentCmd(
+    PMOS_COMMAND_BUFFER             cmdBuffer,
+    uint32_t                        segmentIndex)
+{
+    CODECHAL_ENCODE_FUNCTION_ENTER;
+
+    CODECHAL_ENCODE_CHK_NULL_RETURN(cmdBuffer);
+
+    if (segmentIndex >= m_cachedHeaderSegments.size())
+    {
+        return MOS_STATUS_INVALID_PARAMETER;
+    }
+
+    CodechalEncodeJpegHeaderSegment &segment = m_cachedHeaderSegments[segmentIndex];
+
+    BSBuffer bsBuffer;
+    MOS_ZeroMemory(&bsBuffer, sizeof(bsBuffer));
+    bsBuffer.pBase      = m_cachedHeaderData.data() + segment.m_offset;
+    bsBuffer.BufferSize = segment.m_bitSize;
+
+    // The scan header is the last header of the picture
+    bool lastHeader = (segmentIndex == m_cachedHeaderSegments.size() - 1);
+
+    MHW_VDBOX_PAK_INSERT_PARAMS pakInsertObjectParams;
+    MOS_ZeroMemory(&pakInsertObjectParams, sizeof(pakInsertObjectParams));
+    pakInsertObjectParams.pBsBuffer                     = &bsBuffer;
+    pakInsertObjectParams.dwOffset                      = 0;
+    pakInsertObjectParams.dwBitSize                     = segment.m_bitSize;
+    pakInsertObjectParams.bLastHeader                   = lastHeader;
+    pakInsertObjectParams.bEndOfSlice                   = lastHeader;
+    pakInsertObjectParams.bResetBitstreamStartingPos    = 1; // from discussion with HW Architect
+
+    return m_mfxInterface->AddMfxPakInsertObject(cmdBuffer, nullptr, &pakInsertObjectParams);
+}
+
 uint32_t CodechalEncodeJpegState::CalculateCommandBufferSize()
 {
     uint32_t commandBufferSize =
@@ -1091,6 +1212,9 @@ uint32_t CodechalEncodeJpegState::CalculateCommandBufferSize()
         commandBufferSize *= (m_numPasses + 1);
     }
 
+    // Batched pictures share one command buffer
+    commandBufferSize *= m_batchSize;
+
     // 4K align since allocation is in chunks of 4K bytes.
     commandBufferSize = MOS_ALIGN_CEIL(commandBufferSize, 0x1000);
 
@@ -1106,6 +1230,9 @@ CodechalEncodeJpegState::CodechalEncodeJpegState(
     CODECHAL_ENCODE_FUNCTION_ENTER;
 
     memset(m_refList, 0, sizeof(m_refList));
+    MOS_ZeroMemory(&m_tableCacheKey, sizeof(m_tableCacheKey));
+    MOS_ZeroMemory(&m_cachedQuantMatrix, sizeof(m_cachedQuantMatrix));
+    MOS_ZeroMemory(m_cachedHuffTableParams, sizeof(m_cachedHuffTableParams));
 }
 
 #if USE_CODECHAL_DEBUG_TOOL
@@ -30,6 +30,8 @@
 
 #include "codechal_encoder_base.h"
 
+#define CODECHAL_ENCODE_JPEG_MAX_BATCH_SIZE     4   // Must stay below CODECHAL_ENCODE_RECYCLED_BUFFER_NUM
+
 //!
 //! \struct CodechalEncodeJpegHuffTable
 //! \brief Define the Huffman Table structure used by JPEG Encode
@@ -128,6 +130,36 @@ struct CodechalEncodeJpegScanHeader
 };
 #pragma pack(pop)
 
+//!
+//! \struct CodechalEncodeJpegTableCacheKey
+//! \brief  Source data of the HW tables and packed headers cached across pictures
+//!
+struct CodechalEncodeJpegTableCacheKey
+{
+    uint32_t                            m_picWidth;                     //!< Picture width
+    uint32_t                            m_picHeight;                    //!< Picture height
+    uint32_t                            m_inputSurfaceFormat;           //!< Input surface format
+    uint32_t                            m_numComponent;                 //!< Number of components
+    uint8_t                             m_componentID[4];               //!< Component IDs
+    uint32_t                            m_restartInterval;              //!< Restart interval
+    uint32_t                            m_numHuffBuffers;               //!< Number of Huffman buffers sent by the app
+    uint32_t                            m_numQuantTables;               //!< Number of quant tables sent to HW
+    uint32_t                            m_useSingleDefaultQuantTable;   //!< Luma quant table is used for all components
+    uint32_t                            m_fullHeaderInAppData;          //!< Headers are provided in application data
+    CodecEncodeJpegQuantTable           m_quantTables;                  //!< Quant tables after per-picture expansion
+    CodecEncodeJpegHuffmanDataArray     m_huffmanTable;                 //!< Huffman data after per-picture expansion
+};
+
+//!
+//! \struct CodechalEncodeJpegHeaderSegment
+//! \brief  One packed header inserted through MFC_JPEG_PAK_INSERT_OBJECT
+//!
+struct CodechalEncodeJpegHeaderSegment
+{
+    uint32_t    m_offset;   //!< Byte offset in the packed header data
+    uint32_t    m_bitSize;  //!< Size of the header in bits
+};
+
 //!  JPEG Encoder State class
 //!
 //!This class defines the JPEG encoder state, it includes
@@ -151,6 +183,24 @@ public:
     //!
     virtual ~CodechalEncodeJpegState() {};
 
+    //!
+    //! \brief    Submit the pictures recorded in the pending command buffer
+    //!
+    //! \details  Used in batch mode before the app waits on a picture or reuses its surfaces
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS SubmitPendingPictures();
+
+    //!
+    //! \brief    Get number of pictures waiting for submission
+    //!
+    //! \return   uint32_t
+    //!           Number of pending pictures
+    //!
+    uint32_t GetNumPendingPictures() { return m_numPendingPictures; }
+
     //derived from base class
     MOS_STATUS Initialize(CodechalSetting *settings);
 
@@ -205,6 +255,18 @@ public:
     bool                                        m_jpegQuantMatrixSent  = false;                                //!< JPEG: bool to tell if quant matrix was sent by the app or not
     bool                                        m_fullHeaderInAppData  = false;
 
+    // Batch submission
+    uint32_t                                    m_batchSize            = 1;                                     //!< Number of pictures submitted in one command buffer
+
+    // Tables and headers cached across pictures
+    bool                                        m_tableCacheValid      = false;                                 //!< Cached tables and headers match m_tableCacheKey
+    uint32_t                                    m_tableCacheHash       = 0;                                     //!< Hash of m_tableCacheKey
+    CodechalEncodeJpegTableCacheKey             m_tableCacheKey;                                                //!< Source data of the cached tables and headers
+    CodecJpegQuantMatrix                        m_cachedQuantMatrix;                                            //!< Raster order quant matrices for MFX_FQM_STATE
+    MHW_VDBOX_ENCODE_HUFF_TABLE_PARAMS          m_cachedHuffTableParams[JPEG_MAX_NUM_HUFF_TABLE_INDEX];         //!< HW Huffman tables for MFC_JPEG_HUFF_TABLE_STATE
+    std::vector<uint8_t>                        m_cachedHeaderData;                                             //!< Packed header bytes
+    std::vector<CodechalEncodeJpegHeaderSegment> m_cachedHeaderSegments;                                        //!< SOI first, then quant, frame, Huffman, restart and scan headers
+
 protected:
     //!
     //! \brief    Map Huffman value index, implemented based on table K.5 in JPEG spec.
@@ -382,6 +444,48 @@ protected:
     //!
     MOS_STATUS PackScanHeader(
         BSBuffer                        *buffer);
+
+    //!
+    //! \brief    Rebuild the HW tables and packed headers if their source data changed
+    //!
+    //! \param    [in] useSingleDefaultQuantTable
+    //!           The flag of using single default Quant Table
+    //! \param    [in] numQuantTables
+    //!           Number of quant tables sent to HW
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS UpdateTableCache(
+        bool                            useSingleDefaultQuantTable,
+        uint32_t                        numQuantTables);
+
+    //!
+    //! \brief    Append a packed header to the header cache and free the packed buffer
+    //!
+    //! \param    [in] buffer
+    //!           Bitstream buffer returned by one of the Pack functions
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS AddHeaderSegment(
+        BSBuffer                        *buffer);
+
+    //!
+    //! \brief    Add MFC_JPEG_PAK_INSERT_OBJECT for a cached header
+    //!
+    //! \param    [in] cmdBuffer
+    //!           Command buffer
+    //! \param    [in] segmentIndex
+    //!           Index in m_cachedHeaderSegments
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS AddHeaderSegmentCmd(
+        PMOS_COMMAND_BUFFER             cmdBuffer,
+        uint32_t                        segmentIndex);
 };
 
 #endif //__CODECHAL_ENCODER_JPEG_H__
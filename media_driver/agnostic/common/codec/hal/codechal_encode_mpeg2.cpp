@@ -1983,14 +1983,8 @@ MOS_STATUS CodechalEncodeMpeg2::SetSliceGroups()
             {
                 slcData->SliceOffset = bsBuffer->SliceOffset;
                 // Make slice header uint8_t aligned, all start codes are uint8_t aligned
-                while (bsBuffer->BitOffset)
-                {
-                    PutBit(bsBuffer, 0);
-                }
-                for (uint32_t i = 0; i < 8; i++)
-                {
-                    PutBit(bsBuffer, 0);
-                }
+                CodecHal_ByteAlign(bsBuffer);
+                PutBits(bsBuffer, 0, 8);
 
                 slcData->BitSize = bsBuffer->BitSize =
                     (uint32_t)((bsBuffer->pCurrent - bsBuffer->SliceOffset - bsBuffer->pBase) * 8 + bsBuffer->BitOffset);
@@ -2036,14 +2030,8 @@ MOS_STATUS CodechalEncodeMpeg2::SetSliceGroups()
 
                 slcData->SliceOffset = bsBuffer->SliceOffset;
                 // Make slice header uint8_t aligned, all start codes are uint8_t aligned
-                while (bsBuffer->BitOffset)
-                {
-                    PutBit(bsBuffer, 0);
-                }
-                for (uint32_t i = 0; i < 8; i++)
-                {
-                    PutBit(bsBuffer, 0);
-                }
+                CodecHal_ByteAlign(bsBuffer);
+                PutBits(bsBuffer, 0, 8);
 
                 slcData->BitSize = bsBuffer->BitSize =
                     (uint32_t)((bsBuffer->pCurrent - bsBuffer->SliceOffset - bsBuffer->pBase) * 8 + bsBuffer->BitOffset);
@@ -2086,10 +2074,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackDisplaySeqExtension()
     auto bsBuffer = &m_bsBuffer;
 
     // Make start code uint8_t aligned
-    while (bsBuffer->BitOffset)
-    {
-        PutBit(bsBuffer, 0);
-    }
+    CodecHal_ByteAlign(bsBuffer);
 
     // extension_start_code
     PutBits(bsBuffer, startCodePrefix, 24);
@@ -2138,10 +2123,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackSeqExtension()
     auto bsBuffer = &m_bsBuffer;
 
     // Make start code uint8_t aligned
-    while (bsBuffer->BitOffset)
-    {
-        PutBit(bsBuffer, 0);
-    }
+    CodecHal_ByteAlign(bsBuffer);
 
     // extension_start_code
     PutBits(bsBuffer, startCodePrefix, 24);
@@ -2196,10 +2178,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackSeqHeader()
     auto bsBuffer = &m_bsBuffer;
 
     // Make start code uint8_t aligned
-    while (bsBuffer->BitOffset)
-    {
-        PutBit(bsBuffer, 0);
-    }
+    CodecHal_ByteAlign(bsBuffer);
 
     // sequence_start_code
     PutBits(bsBuffer, startCodePrefix, 24);
@@ -2301,10 +2280,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackPicCodingExtension()
     auto bsBuffer = &m_bsBuffer;
 
     // All start codes are uint8_t aligned
-    while (bsBuffer->BitOffset)
-    {
-        PutBit(bsBuffer, 0);
-    }
+    CodecHal_ByteAlign(bsBuffer);
 
     // extension_start_code
     PutBits(bsBuffer, startCodePrefix, 24);
@@ -2439,10 +2415,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackPicUserData()
     {
         auto userData = (uint8_t*)p->m_userData;
 
-        while (bsBuffer->BitOffset)
-        {
-            PutBit(bsBuffer, 0);
-        }
+        CodecHal_ByteAlign(bsBuffer);
 
         for(unsigned int i = 0; i < p->m_userDataSize; ++i)
         {
@@ -2462,10 +2435,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackPicHeader()
     auto bsBuffer = &m_bsBuffer;
 
     // All start codes are uint8_t aligned
-    while (bsBuffer->BitOffset)
-    {
-        PutBit(bsBuffer, 0);
-    }
+    CodecHal_ByteAlign(bsBuffer);
 
     // picture_start_code
     PutBits(bsBuffer, startCodePrefix, 24);
@@ -2514,10 +2484,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackGroupOfPicHeader()
     auto bsBuffer = &m_bsBuffer;
 
     // All start codes are uint8_t aligned
-    while (bsBuffer->BitOffset)
-    {
-        PutBit(bsBuffer, 0);
-    }
+    CodecHal_ByteAlign(bsBuffer);
 
     // group_start_code
     PutBits(bsBuffer, startCodePrefix, 24);
@@ -2598,10 +2565,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackPictureHeader()
     CODECHAL_ENCODE_CHK_STATUS_RETURN(PackPictureParams());
 
     // HW will insert next slice start code, but need to byte align for HW
-    while (bsBuffer->BitOffset)
-    {
-        PutBit(bsBuffer, 0);
-    }
+    CodecHal_ByteAlign(bsBuffer);
     bsBuffer->BitSize = (uint32_t)(bsBuffer->pCurrent - bsBuffer->SliceOffset - bsBuffer->pBase) * 8 + bsBuffer->BitOffset;
 
     return eStatus;
@@ -4803,10 +4767,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackSkipSliceData()
     auto slcParams      = m_sliceParams;
     auto bsBuffer       = &m_bsBuffer;
 
-    while (bsBuffer->BitOffset)
-    {
-        PutBits(bsBuffer, 0, 1);
-    }
+    CodecHal_ByteAlign(bsBuffer);
 
     for (uint32_t slcCount = 0; slcCount < m_numSlices; slcCount++)
     {
@@ -4826,10 +4787,7 @@ MOS_STATUS CodechalEncodeMpeg2::PackSkipSliceData()
 
         PackSkippedMB(1);
         PackSkippedMB(slcParams->m_numMbsForSlice - 1);
-        while (bsBuffer->BitOffset)
-        {
-            PutBits(bsBuffer, 0, 1);
-        }
+        CodecHal_ByteAlign(bsBuffer);
         slcParams++;
     }
 
@@ -1147,7 +1147,7 @@ MOS_STATUS CodecHalEncodeSfc::RenderStart(
     CODECHAL_ENCODE_CHK_STATUS_RETURN(VeboxSetIecpParams(&veboxIecpParams));
 
     // send matrix into heap
-    CODECHAL_ENCODE_CHK_STATUS_RETURN(veboxInterface->AddVeboxIecpState(
+    CODECHAL_ENCODE_CHK_STATUS_RETURN(veboxInterface->UpdateVeboxIecpState(
         &veboxIecpParams));
 
     // send Vebox and SFC cmds
@@ -28,6 +28,7 @@
 #include "codechal_encoder_base.h"
 #include "codechal_encode_tracked_buffer_hevc.h"
 #include "mos_solo_generic.h"
+#include "mos_metrics.h"
 
 void CodechalEncoderState::PrepareNodes(
     MOS_GPU_NODE& videoGpuNode,
@@ -68,6 +69,9 @@ MOS_STATUS CodechalEncoderState::CreateGpuContexts()
         MOS_GPU_NODE videoGpuNode = MOS_GPU_NODE_VIDEO;
         bool setVideoNode = false;
 
+        // Weigh this session's submissions by frame size when balancing VDBoxes
+        m_osInterface->dwVdboxWorkload = m_picWidthInMb * m_picHeightInMb;
+
         // Create Video Context
         if (MEDIA_IS_SKU(m_skuTable, FtrVcs2))
         {
@@ -3420,7 +3424,7 @@ MOS_STATUS CodechalEncoderState::ResetStatusReport()
         (EncodeStatus*)(encodeStatusBuf->pEncodeStatus +
         encodeStatusBuf->wCurrIndex * encodeStatusBuf->dwReportSize);
 
-    if (!m_frameTrackingEnabled && !m_inlineEncodeStatusUpdate)
+    if (!m_frameTrackingEnabled && !m_inlineEncodeStatusUpdate && !m_multiFrameSubmission)
     {
         bool renderEngineInUse = m_osInterface->pfnGetGpuContext(m_osInterface) == m_renderContext;
         bool nullRendering = false;
@@ -3529,6 +3533,7 @@ MOS_STATUS CodechalEncoderState::GetStatusReport(
     MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
 
     CODECHAL_ENCODE_FUNCTION_ENTER;
+    MOS_METRICS_SCOPE(MOS_METRIC_ENCODE_STATUS_REPORT);
 
     CODECHAL_ENCODE_CHK_NULL_RETURN(status);
     EncodeStatusReport *codecStatus = (EncodeStatusReport *)status;
@@ -4317,7 +4322,11 @@ MOS_STATUS CodechalEncoderState::ExecuteEnc(
         {
             // Set to video context
             m_osInterface->pfnSetGpuContext(m_osInterface, m_videoContext);
-            m_osInterface->pfnResetOsStates(m_osInterface);
+            // Keep the OS states of pictures already recorded in the pending command buffer
+            if (m_numPendingPictures == 0)
+            {
+                m_osInterface->pfnResetOsStates(m_osInterface);
+            }
             m_currPass = 0;
 
             CODECHAL_ENCODE_CHK_STATUS_RETURN(VerifySpaceAvailable());
@@ -1416,6 +1416,8 @@ public:
     AtomicScratchBuffer             m_atomicScratchBuf;                             //!< Stores atomic operands and result
     bool                            m_skipFrameBasedHWCounterRead = false;          //!< Skip reading Frame base HW counter for status report
     bool                            m_disableStatusReport = false;                  //!< Indicate status report is not needed.
+    bool                            m_multiFrameSubmission = false;                 //!< Several pictures share one command buffer, status data is stored inline per picture
+    uint32_t                        m_numPendingPictures = 0;                       //!< Pictures recorded in the command buffer but not submitted yet
 
     // Shared Parameters
     BSBuffer                        m_bsBuffer;                                     //!< Bitstream buffer
@@ -2317,72 +2319,15 @@ public:
 
 static void PutBit(BSBuffer *bsbuffer, uint32_t code)
 {
-    if (code & 1)
-    {
-        *(bsbuffer->pCurrent) = (*(bsbuffer->pCurrent) | (uint8_t)(0x01 << (7 - bsbuffer->BitOffset)));
-    }
-
-    bsbuffer->BitOffset++;
-    if (bsbuffer->BitOffset == 8)
-    {
-        bsbuffer->BitOffset = 0;
-        bsbuffer->pCurrent++;
-        *(bsbuffer->pCurrent) = 0;
-    }
-}
-
-static void PutBitsSub(BSBuffer *bsbuffer, uint32_t code, uint32_t length)
-{
-    uint8_t *byte = bsbuffer->pCurrent;
-
-    // make sure that the number of bits given is <= 24
-    CODECHAL_ENCODE_ASSERT(length <= 24);
-
-    code <<= (32 - length);
-
-    // shift field so that the given code begins at the current bit
-    // offset in the most significant byte of the 32-bit word
-    length += bsbuffer->BitOffset;
-    code >>= bsbuffer->BitOffset;
-
-    // write bytes back into memory, big-endian
-    byte[0] = (uint8_t)((code >> 24) | byte[0]);
-    byte[1] = (uint8_t)(code >> 16);
-    if (length > 16)
-    {
-        byte[2] = (uint8_t)(code >> 8);
-        byte[3] = (uint8_t)code;
-    }
-    else
-    {
-        byte[2] = 0;
-    }
-
-    // update bitstream pointer and bit offset
-    bsbuffer->pCurrent += (length >> 3);
-    bsbuffer->BitOffset = (length & 7);
+    CodecHal_PutBits(bsbuffer, code & 1, 1);
 }
 
 static void PutBits(BSBuffer *bsbuffer, uint32_t code, uint32_t length)
 {
-    uint32_t code1, code2;
-
-    // temp solution, only support up to 32 bits based on current usage
+    // only support up to 32 bits based on current usage
     CODECHAL_ENCODE_ASSERT(length <= 32);
 
-    if (length >= 24)
-    {
-        code1 = code & 0xFFFF;
-        code2 = code >> 16;
-
-        // high bits go first
-        PutBitsSub(bsbuffer, code2, length - 16);
-        PutBitsSub(bsbuffer, code1, 16);
-    }
-    else
-    {
-        PutBitsSub(bsbuffer, code, length);
-    }
+    CodecHal_PutBits(bsbuffer, code, length);
 }
 
 template<typename ValueType>
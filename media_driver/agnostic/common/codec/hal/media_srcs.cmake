@@ -68,6 +68,7 @@ set(TMP_2_SOURCES_
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decoder.cpp
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_histogram.cpp
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_histogram_vebox.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_scratch_pool.cpp
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_singlepipe_virtualengine.cpp
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_scalability.cpp
 )
@@ -77,6 +78,7 @@ set(TMP_2_HEADERS_
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decoder.h
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_histogram.h
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_histogram_vebox.h
+    ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_scratch_pool.h
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_singlepipe_virtualengine.h
     ${CMAKE_CURRENT_LIST_DIR}/codechal_decode_scalability.h
     ${CMAKE_CURRENT_LIST_DIR}/codechal_secure_decode_interface.h
@@ -210,6 +210,87 @@ typedef struct _BSBuffer
     uint32_t  BufferSize;     // buffer size
 } BSBuffer, *PBSBuffer;
 
+//!
+//! \brief    Write up to 32 bits to a bitstream buffer, most significant bit first
+//! \details  The code is merged with the pending bits of the current byte in a 64-bit
+//!           word and stored with whole byte writes. Only the bytes holding the written
+//!           bits are stored, the unused bits of the last one are zeroed. The pending bits
+//!           are masked on the next call, so nothing past the last bit is read or written.
+//!
+//! \param    [in] bsBuffer
+//!           Bitstream buffer
+//! \param    [in] code
+//!           Value to write, bits above length are ignored
+//! \param    [in] length
+//!           Number of bits to write, 0 to 32
+//!
+static __inline void CodecHal_PutBits(BSBuffer *bsBuffer, uint32_t code, uint32_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    uint8_t  *byte      = bsBuffer->pCurrent;
+    uint32_t bitOffset  = bsBuffer->BitOffset;
+    uint32_t totalBits  = bitOffset + length;
+
+    uint64_t word = ((uint64_t)code << (64 - length)) >> bitOffset;
+    word |= (uint64_t)(byte[0] & (0xFF00 >> bitOffset)) << 56;
+
+    for (uint32_t i = 0; i < ((totalBits + 7) >> 3); i++)
+    {
+        byte[i] = (uint8_t)(word >> (56 - 8 * i));
+    }
+
+    bsBuffer->pCurrent  += (totalBits >> 3);
+    bsBuffer->BitOffset = (uint8_t)(totalBits & 7);
+}
+
+//!
+//! \brief    Write an unsigned Exp-Golomb code, ue(v)
+//! \details  Codes up to 32 bits long are written with a single CodecHal_PutBits call
+//!
+//! \param    [in] bsBuffer
+//!           Bitstream buffer
+//! \param    [in] code
+//!           Value to write
+//!
+static __inline void CodecHal_PutUe(BSBuffer *bsBuffer, uint32_t code)
+{
+    uint64_t codeNum         = (uint64_t)code + 1;
+    uint32_t leadingZeroBits = 0;
+    while ((codeNum >> (leadingZeroBits + 1)) != 0)
+    {
+        leadingZeroBits++;
+    }
+
+    if (2 * leadingZeroBits + 1 <= 32)
+    {
+        CodecHal_PutBits(bsBuffer, (uint32_t)codeNum, 2 * leadingZeroBits + 1);
+    }
+    else
+    {
+        CodecHal_PutBits(bsBuffer, 0, leadingZeroBits);
+        CodecHal_PutBits(bsBuffer, (uint32_t)(codeNum >> 16), leadingZeroBits + 1 - 16);
+        CodecHal_PutBits(bsBuffer, (uint32_t)(codeNum & 0xFFFF), 16);
+    }
+}
+
+//!
+//! \brief    Pad the bitstream with zero bits up to the next byte boundary
+//!
+//! \param    [in] bsBuffer
+//!           Bitstream buffer
+//!
+static __inline void CodecHal_ByteAlign(BSBuffer *bsBuffer)
+{
+    if (bsBuffer->BitOffset)
+    {
+        CodecHal_PutBits(bsBuffer, 0, 8 - bsBuffer->BitOffset);
+    }
+}
+
 typedef struct _CODEC_ENCODER_SLCDATA
 {
     uint32_t    SliceOffset;
@@ -25,6 +25,7 @@
 //!
 
 #include "heap_manager.h"
+#include "mos_metrics.h"
 
 HeapManager::~HeapManager()
 {
@@ -205,6 +206,7 @@ void HeapManager::FreeHeap()
 MOS_STATUS HeapManager::Wait()
 {
     HEAP_FUNCTION_ENTER_VERBOSE;
+    MOS_METRICS_SCOPE(MOS_METRIC_HEAP_WAIT);
 
     bool blocksUpdated = false;
 
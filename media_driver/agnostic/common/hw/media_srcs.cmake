@@ -32,11 +32,13 @@ set(TMP_1_HEADERS_
 
 set(TMP_2_SOURCES_
     ${CMAKE_CURRENT_LIST_DIR}/mhw_vebox.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/mhw_vebox_state_memo.cpp
 )
 
 set(TMP_2_HEADERS_
     ${CMAKE_CURRENT_LIST_DIR}/mhw_vebox.h
     ${CMAKE_CURRENT_LIST_DIR}/mhw_vebox_generic.h
+    ${CMAKE_CURRENT_LIST_DIR}/mhw_vebox_state_memo.h
 )
 
 
@@ -63,6 +65,7 @@ set(TMP_4_SOURCES_
     ${CMAKE_CURRENT_LIST_DIR}/mhw_render.c
     ${CMAKE_CURRENT_LIST_DIR}/mhw_state_heap.c
     ${CMAKE_CURRENT_LIST_DIR}/mhw_utilities.c
+    ${CMAKE_CURRENT_LIST_DIR}/mhw_polyphase_table_cache.cpp
 )
 
 set(TMP_4_HEADERS_
@@ -75,6 +78,7 @@ set(TMP_4_HEADERS_
     ${CMAKE_CURRENT_LIST_DIR}/mhw_state_heap.h
     ${CMAKE_CURRENT_LIST_DIR}/mhw_state_heap_generic.h
     ${CMAKE_CURRENT_LIST_DIR}/mhw_utilities.h
+    ${CMAKE_CURRENT_LIST_DIR}/mhw_polyphase_table_cache.h
     ${CMAKE_CURRENT_LIST_DIR}/mhw_mmio.h
 )
 
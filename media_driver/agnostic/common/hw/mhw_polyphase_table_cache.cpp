@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mhw_polyphase_table_cache.cpp
+//! \brief     Process wide cache of polyphase scaling coefficient tables
+//!
+
+#include <string.h>
+#include "mhw_polyphase_table_cache.h"
+
+MhwPolyphaseTableCache *MhwPolyphaseTableCache::GetInstance()
+{
+    static MhwPolyphaseTableCache cache;
+    return &cache;
+}
+
+bool MhwPolyphaseTableCache::Get(const void *key, uint32_t keySize, int32_t *coefs, uint32_t coefNum)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (uint32_t i = 0; i < m_entryNum; i++)
+    {
+        Entry &entry = m_entries[i];
+        if (entry.keySize == keySize &&
+            entry.coefNum == coefNum &&
+            memcmp(entry.key, key, keySize) == 0)
+        {
+            memcpy(coefs, entry.coefs, coefNum * sizeof(int32_t));
+            m_hitCount++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void MhwPolyphaseTableCache::Put(const void *key, uint32_t keySize, const int32_t *coefs, uint32_t coefNum)
+{
+    if (keySize > MHW_POLYPHASE_TABLE_CACHE_KEY_SIZE ||
+        coefNum > MHW_POLYPHASE_TABLE_CACHE_COEF_NUM)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Another thread may have generated the same table meanwhile
+    for (uint32_t i = 0; i < m_entryNum; i++)
+    {
+        if (m_entries[i].keySize == keySize &&
+            m_entries[i].coefNum == coefNum &&
+            memcmp(m_entries[i].key, key, keySize) == 0)
+        {
+            return;
+        }
+    }
+
+    Entry &entry = m_entries[m_nextEntry];
+    m_nextEntry  = (m_nextEntry + 1) % MHW_POLYPHASE_TABLE_CACHE_NUM;
+    if (m_entryNum < MHW_POLYPHASE_TABLE_CACHE_NUM)
+    {
+        m_entryNum++;
+    }
+
+    entry.keySize = keySize;
+    entry.coefNum = coefNum;
+    memcpy(entry.key, key, keySize);
+    memcpy(entry.coefs, coefs, coefNum * sizeof(int32_t));
+}
@@ -0,0 +1,100 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mhw_polyphase_table_cache.h
+//! \brief     Process wide cache of polyphase scaling coefficient tables
+//! \details   Tables are a pure function of their params, so a table generated
+//!            once is handed out again to every caller asking with the same
+//!            params, bit for bit. Only depends on the C++ library so that the
+//!            ULT can build it.
+//!
+
+#ifndef __MHW_POLYPHASE_TABLE_CACHE_H__
+#define __MHW_POLYPHASE_TABLE_CACHE_H__
+
+#include <stdint.h>
+#include <mutex>
+
+#define MHW_POLYPHASE_TABLE_CACHE_NUM       64      //!< Tables kept, a few planes and directions per output size
+#define MHW_POLYPHASE_TABLE_CACHE_KEY_SIZE  64      //!< Max size of the params of a table
+#define MHW_POLYPHASE_TABLE_CACHE_COEF_NUM  256     //!< Max coefficients of a table, 32 phases x 8 taps
+
+class MhwPolyphaseTableCache
+{
+public:
+    //!
+    //! \brief    Get the cache shared by the process
+    //! \return   MhwPolyphaseTableCache*
+    //!
+    static MhwPolyphaseTableCache *GetInstance();
+
+    //!
+    //! \brief    Copy out the table generated from the params
+    //! \param    [in] key
+    //!           Params of the table, all bytes set
+    //! \param    [in] keySize
+    //!           Size of the params
+    //! \param    [out] coefs
+    //!           Table to fill
+    //! \param    [in] coefNum
+    //!           Number of coefficients of the table
+    //! \return   bool
+    //!           true if the table was found, otherwise the caller generates
+    //!           it and calls Put
+    //!
+    bool Get(const void *key, uint32_t keySize, int32_t *coefs, uint32_t coefNum);
+
+    //!
+    //! \brief    Keep a generated table
+    //! \details  Tables too large for the cache are not kept. The oldest table
+    //!           is replaced when the cache is full.
+    //! \param    [in] key
+    //!           Params of the table, all bytes set
+    //! \param    [in] keySize
+    //!           Size of the params
+    //! \param    [in] coefs
+    //!           Generated table
+    //! \param    [in] coefNum
+    //!           Number of coefficients of the table
+    //! \return   void
+    //!
+    void Put(const void *key, uint32_t keySize, const int32_t *coefs, uint32_t coefNum);
+
+    uint32_t GetHitCount() { return m_hitCount; }
+
+private:
+    struct Entry
+    {
+        uint32_t    keySize;
+        uint32_t    coefNum;
+        uint8_t     key[MHW_POLYPHASE_TABLE_CACHE_KEY_SIZE];
+        int32_t     coefs[MHW_POLYPHASE_TABLE_CACHE_COEF_NUM];
+    };
+
+    std::mutex  m_mutex;
+    Entry       m_entries[MHW_POLYPHASE_TABLE_CACHE_NUM] = {};
+    uint32_t    m_entryNum  = 0;
+    uint32_t    m_nextEntry = 0;                    //!< Round robin replacement
+    uint32_t    m_hitCount  = 0;
+};
+
+#endif // __MHW_POLYPHASE_TABLE_CACHE_H__
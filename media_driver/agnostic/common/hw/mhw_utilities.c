@@ -26,6 +26,8 @@
 #include "mhw_utilities.h"
 #include "mhw_render.h"
 #include "mhw_state_heap.h"
+#include "mhw_polyphase_table_cache.h"
+#include "mos_metrics.h"
 
 #define MHW_NS_PER_TICK_RENDER_ENGINE 80  // 80 nano seconds per tick in render engine
 
@@ -519,7 +521,7 @@ finish:
 //! \return   MOS_STATUS
 //!           MOS_STATUS_SUCCESS if success, else fail reason
 //!
-MOS_STATUS Mhw_CalcPolyphaseTablesY(
+static MOS_STATUS Mhw_GenPolyphaseTablesY(
     int32_t         *iCoefs,
     float           fScaleFactor,
     uint32_t        dwPlane,
@@ -669,7 +671,7 @@ finish:
 //! \return   MOS_STATUS
 //!           MOS_STATUS_SUCCESS if success, else fail reason
 //!
-MOS_STATUS Mhw_CalcPolyphaseTablesUV(
+static MOS_STATUS Mhw_GenPolyphaseTablesUV(
     int32_t    *piCoefs,
     float      fLanczosT,
     float      fInverseScaleFactor)
@@ -761,7 +763,7 @@ finish:
 //! \return   MOS_STATUS
 //!           MOS_STATUS_SUCCESS if success, else fail reason
 //!
-MOS_STATUS Mhw_CalcPolyphaseTablesUVOffset(
+static MOS_STATUS Mhw_GenPolyphaseTablesUVOffset(
     int32_t     *piCoefs,
     float       fLanczosT,
     float       fInverseScaleFactor,
@@ -842,6 +844,156 @@ finish:
     return eStatus;
 }
 
+//!
+//! \brief    Params a polyphase table is generated from
+//! \details  Zeroed before filling, compared byte by byte. Floats are
+//!           compared exactly, any change of scale factor is a new table.
+//!
+typedef struct _MHW_POLYPHASE_TABLE_KEY
+{
+    uint32_t        dwTable;                    //!< 0: Y, 1: UV, 2: UV offset
+    float           fScaleFactor;
+    float           fLanczosT;
+    float           fHPStrength;
+    uint32_t        dwPlane;
+    MOS_FORMAT      srcFmt;
+    uint32_t        dwHwPhase;
+    int32_t         iUvPhaseOffset;
+    uint32_t        bUse8x8Filter;
+} MHW_POLYPHASE_TABLE_KEY;
+
+//!
+//! \brief      Calculate Polyphase tables for Y, across SFC and Render engine to set the sampler states
+//! \details    Hands out the table of an earlier call with the same params,
+//!             otherwise generates it with Mhw_GenPolyphaseTablesY
+//! \return   MOS_STATUS
+//!           MOS_STATUS_SUCCESS if success, else fail reason
+//!
+MOS_STATUS Mhw_CalcPolyphaseTablesY(
+    int32_t         *iCoefs,
+    float           fScaleFactor,
+    uint32_t        dwPlane,
+    MOS_FORMAT      srcFmt,
+    float           fHPStrength,
+    bool            bUse8x8Filter,
+    uint32_t        dwHwPhase)
+{
+    MOS_METRICS_SCOPE(MOS_METRIC_POLYPHASE_TABLE_CALC);
+
+    MhwPolyphaseTableCache  *pCache;
+    MHW_POLYPHASE_TABLE_KEY Key;
+    uint32_t                dwCoefNum;
+    MOS_STATUS              eStatus = MOS_STATUS_SUCCESS;
+
+    MHW_CHK_NULL(iCoefs);
+
+    dwCoefNum = dwHwPhase *
+        ((dwPlane == MHW_GENERIC_PLANE || dwPlane == MHW_Y_PLANE) ? NUM_POLYPHASE_Y_ENTRIES : NUM_POLYPHASE_UV_ENTRIES);
+
+    MOS_ZeroMemory(&Key, sizeof(Key));
+    Key.dwTable         = 0;
+    Key.fScaleFactor    = fScaleFactor;
+    Key.dwPlane         = dwPlane;
+    Key.srcFmt          = srcFmt;
+    Key.fHPStrength     = fHPStrength;
+    Key.bUse8x8Filter   = bUse8x8Filter;
+    Key.dwHwPhase       = dwHwPhase;
+
+    pCache = MhwPolyphaseTableCache::GetInstance();
+    if (pCache->Get(&Key, sizeof(Key), iCoefs, dwCoefNum))
+    {
+        MOS_METRICS_COUNT(MOS_METRIC_POLYPHASE_TABLE_CACHE_HIT);
+        goto finish;
+    }
+
+    MHW_CHK_STATUS(Mhw_GenPolyphaseTablesY(
+        iCoefs, fScaleFactor, dwPlane, srcFmt, fHPStrength, bUse8x8Filter, dwHwPhase));
+    pCache->Put(&Key, sizeof(Key), iCoefs, dwCoefNum);
+
+finish:
+    return eStatus;
+}
+
+//!
+//! \brief      Calculate Polyphase tables for UV for Gen9, across SFC and Render engine to set the sampler states
+//! \details    Hands out the table of an earlier call with the same params,
+//!             otherwise generates it with Mhw_GenPolyphaseTablesUV
+//! \return   MOS_STATUS
+//!           MOS_STATUS_SUCCESS if success, else fail reason
+//!
+MOS_STATUS Mhw_CalcPolyphaseTablesUV(
+    int32_t    *piCoefs,
+    float      fLanczosT,
+    float      fInverseScaleFactor)
+{
+    MOS_METRICS_SCOPE(MOS_METRIC_POLYPHASE_TABLE_CALC);
+
+    MhwPolyphaseTableCache  *pCache;
+    MHW_POLYPHASE_TABLE_KEY Key;
+    MOS_STATUS              eStatus = MOS_STATUS_SUCCESS;
+
+    MHW_CHK_NULL(piCoefs);
+
+    MOS_ZeroMemory(&Key, sizeof(Key));
+    Key.dwTable         = 1;
+    Key.fLanczosT       = fLanczosT;
+    Key.fScaleFactor    = fInverseScaleFactor;
+
+    pCache = MhwPolyphaseTableCache::GetInstance();
+    if (pCache->Get(&Key, sizeof(Key), piCoefs, MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT))
+    {
+        MOS_METRICS_COUNT(MOS_METRIC_POLYPHASE_TABLE_CACHE_HIT);
+        goto finish;
+    }
+
+    MHW_CHK_STATUS(Mhw_GenPolyphaseTablesUV(piCoefs, fLanczosT, fInverseScaleFactor));
+    pCache->Put(&Key, sizeof(Key), piCoefs, MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT);
+
+finish:
+    return eStatus;
+}
+
+//!
+//! \brief      Calculate polyphase tables UV offset for Gen9, across SFC and Render engine to set the sampler states
+//! \details    Hands out the table of an earlier call with the same params,
+//!             otherwise generates it with Mhw_GenPolyphaseTablesUVOffset
+//! \return   MOS_STATUS
+//!           MOS_STATUS_SUCCESS if success, else fail reason
+//!
+MOS_STATUS Mhw_CalcPolyphaseTablesUVOffset(
+    int32_t     *piCoefs,
+    float       fLanczosT,
+    float       fInverseScaleFactor,
+    int32_t     iUvPhaseOffset)
+{
+    MOS_METRICS_SCOPE(MOS_METRIC_POLYPHASE_TABLE_CALC);
+
+    MhwPolyphaseTableCache  *pCache;
+    MHW_POLYPHASE_TABLE_KEY Key;
+    MOS_STATUS              eStatus = MOS_STATUS_SUCCESS;
+
+    MHW_CHK_NULL(piCoefs);
+
+    MOS_ZeroMemory(&Key, sizeof(Key));
+    Key.dwTable         = 2;
+    Key.fLanczosT       = fLanczosT;
+    Key.fScaleFactor    = fInverseScaleFactor;
+    Key.iUvPhaseOffset  = iUvPhaseOffset;
+
+    pCache = MhwPolyphaseTableCache::GetInstance();
+    if (pCache->Get(&Key, sizeof(Key), piCoefs, MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT))
+    {
+        MOS_METRICS_COUNT(MOS_METRIC_POLYPHASE_TABLE_CACHE_HIT);
+        goto finish;
+    }
+
+    MHW_CHK_STATUS(Mhw_GenPolyphaseTablesUVOffset(piCoefs, fLanczosT, fInverseScaleFactor, iUvPhaseOffset));
+    pCache->Put(&Key, sizeof(Key), piCoefs, MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT);
+
+finish:
+    return eStatus;
+}
+
 //!
 //! \brief    Allocate BB
 //! \details  Allocated Batch Buffer
@@ -745,4 +745,77 @@ static __inline MOS_STATUS Mhw_AddCommandCmdOrBB(
     }
 }
 
+//*-----------------------------------------------------------------------------
+//| Purpose:    Default image of a hardware command
+//|             The generated constructors set the fields one at a time; the
+//|             image is built once per command type and then copied whole.
+//| Return:     Reference to the default constructed command
+//*-----------------------------------------------------------------------------
+template <class TCmd>
+inline const TCmd &Mhw_GetCmdDefault()
+{
+    static const TCmd cmdDefault;
+    return cmdDefault;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Check that the command buffer has room for a group of commands
+//|             The commands are then built in place with Mhw_BeginCmd and
+//|             Mhw_EndCmd without checking the space again.
+//| Return:     MOS_STATUS_SUCCESS if call succeeds
+//*-----------------------------------------------------------------------------
+static __inline MOS_STATUS Mhw_ReserveCmdSpace(
+    PMOS_COMMAND_BUFFER         pCmdBuffer,     // [in] Pointer to Command Buffer
+    uint32_t                    dwSize)         // [in] Size of the commands in bytes
+{
+    MHW_CHK_NULL_RETURN(pCmdBuffer);
+    MHW_CHK_NULL_RETURN(pCmdBuffer->pCmdPtr);
+
+    if (pCmdBuffer->iRemaining < (int32_t)MOS_ALIGN_CEIL(dwSize, sizeof(uint32_t)))
+    {
+        MHW_ASSERTMESSAGE("Unable to add command (no space).");
+        return MOS_STATUS_UNKNOWN;
+    }
+
+    return MOS_STATUS_SUCCESS;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Start a command in place at the end of the command buffer
+//|             The space must have been reserved by Mhw_ReserveCmdSpace. The
+//|             command is only appended by Mhw_EndCmd, so resources added to it
+//|             in between are patched at the offset the command will occupy.
+//| Return:     Reference to the command, set to its default image
+//*-----------------------------------------------------------------------------
+template <class TCmd>
+inline TCmd &Mhw_BeginCmd(
+    PMOS_COMMAND_BUFFER         pCmdBuffer)     // [in] Pointer to Command Buffer
+{
+    MHW_ASSERT(pCmdBuffer->iRemaining >= (int32_t)sizeof(TCmd));
+
+    // A plain copy of a fixed size, inlined unlike MOS_SecureMemcpy
+    TCmd *pCmd = (TCmd *)pCmdBuffer->pCmdPtr;
+    *pCmd = Mhw_GetCmdDefault<TCmd>();
+
+    return *pCmd;
+}
+
+//*-----------------------------------------------------------------------------
+//| Purpose:    Append a command started by Mhw_BeginCmd to the command buffer
+//| Return:     void
+//*-----------------------------------------------------------------------------
+template <class TCmd>
+inline void Mhw_EndCmd(
+    PMOS_COMMAND_BUFFER         pCmdBuffer,     // [in] Pointer to Command Buffer
+    const TCmd                  &cmd)           // [in] Command built in place
+{
+    uint32_t dwCmdSizeDwAligned = MOS_ALIGN_CEIL(sizeof(TCmd), sizeof(uint32_t));
+
+    MHW_ASSERT((const void *)&cmd == (const void *)pCmdBuffer->pCmdPtr);
+
+    pCmdBuffer->iOffset    += dwCmdSizeDwAligned;
+    pCmdBuffer->iRemaining -= dwCmdSizeDwAligned;
+    pCmdBuffer->pCmdPtr    += (dwCmdSizeDwAligned / sizeof(uint32_t));
+}
+
 #endif // __MHW_UTILITIES_H__
@@ -195,6 +195,137 @@ finish:
     return eStatus;
 }
 
+//!
+//! \brief    Params an IECP block is built from, with the CSC matrices pointed
+//!           to by the params in place of the pointers
+//!
+typedef struct _MHW_VEBOX_IECP_STATE_KEY
+{
+    MHW_VEBOX_IECP_PARAMS           Params;
+    float                           fCscCoeff[9];
+    float                           fCscInOffset[3];
+    float                           fCscOutOffset[3];
+} MHW_VEBOX_IECP_STATE_KEY;
+
+MOS_STATUS MhwVeboxInterface::UpdateVeboxDndiState(
+    PMHW_VEBOX_DNDI_PARAMS   pVeboxDndiParams,
+    bool                     bReusable)
+{
+    uint32_t                 uiCurState;
+    uint8_t                  *pState;
+    MOS_STATUS               eStatus = MOS_STATUS_SUCCESS;
+
+    MHW_FUNCTION_ENTER;
+
+    MHW_CHK_NULL(pVeboxDndiParams);
+    MHW_CHK_NULL(m_veboxHeap);
+
+    uiCurState = m_veboxHeap->uiCurState;
+    pState     = m_veboxHeap->pLockedDriverResourceMem +
+                 m_veboxHeap->uiDndiStateOffset +
+                 uiCurState * m_veboxHeap->uiInstanceSize;
+
+    if (bReusable && m_dndiStateMemo.Restore(uiCurState, pVeboxDndiParams, pState))
+    {
+        goto finish;
+    }
+
+    MHW_CHK_STATUS(AddVeboxDndiState(pVeboxDndiParams));
+
+    if (bReusable)
+    {
+        m_dndiStateMemo.Save(uiCurState, pVeboxDndiParams, pState);
+    }
+    else
+    {
+        m_dndiStateMemo.Forget(uiCurState);
+    }
+
+finish:
+    return eStatus;
+}
+
+MOS_STATUS MhwVeboxInterface::UpdateVeboxIecpState(
+    PMHW_VEBOX_IECP_PARAMS   pVeboxIecpParams)
+{
+    MHW_VEBOX_IECP_STATE_KEY Key;
+    uint32_t                 uiCurState;
+    uint8_t                  *pState;
+    bool                     bReusable;
+    MOS_STATUS               eStatus = MOS_STATUS_SUCCESS;
+
+    MHW_FUNCTION_ENTER;
+
+    MHW_CHK_NULL(pVeboxIecpParams);
+    MHW_CHK_NULL(m_veboxHeap);
+
+    uiCurState = m_veboxHeap->uiCurState;
+    pState     = m_veboxHeap->pLockedDriverResourceMem +
+                 m_veboxHeap->uiIecpStateOffset +
+                 uiCurState * m_veboxHeap->uiInstanceSize;
+
+    // Capture pipe also writes the gamma and capture pipe states, LUT params
+    // point to tables the key does not hold
+    bReusable = !pVeboxIecpParams->CapPipeParams.bActive &&
+                !pVeboxIecpParams->s3DLutParams.bActive  &&
+                !pVeboxIecpParams->s1DLutParams.bActive;
+
+    if (bReusable)
+    {
+        // Params are updated by AddVeboxIecpState, so the key is taken before
+        MOS_ZeroMemory(&Key, sizeof(Key));
+        MOS_SecureMemcpy(&Key.Params, sizeof(Key.Params), pVeboxIecpParams, sizeof(MHW_VEBOX_IECP_PARAMS));
+        Key.Params.pfCscCoeff     = nullptr;
+        Key.Params.pfCscInOffset  = nullptr;
+        Key.Params.pfCscOutOffset = nullptr;
+        if (pVeboxIecpParams->pfCscCoeff)
+        {
+            MOS_SecureMemcpy(Key.fCscCoeff, sizeof(Key.fCscCoeff), pVeboxIecpParams->pfCscCoeff, sizeof(Key.fCscCoeff));
+        }
+        if (pVeboxIecpParams->pfCscInOffset)
+        {
+            MOS_SecureMemcpy(Key.fCscInOffset, sizeof(Key.fCscInOffset), pVeboxIecpParams->pfCscInOffset, sizeof(Key.fCscInOffset));
+        }
+        if (pVeboxIecpParams->pfCscOutOffset)
+        {
+            MOS_SecureMemcpy(Key.fCscOutOffset, sizeof(Key.fCscOutOffset), pVeboxIecpParams->pfCscOutOffset, sizeof(Key.fCscOutOffset));
+        }
+
+        if (m_iecpStateMemo.Restore(uiCurState, &Key, pState))
+        {
+            goto finish;
+        }
+    }
+
+    MHW_CHK_STATUS(AddVeboxIecpState(pVeboxIecpParams));
+
+    if (bReusable)
+    {
+        m_iecpStateMemo.Save(uiCurState, &Key, pState);
+    }
+    else
+    {
+        m_iecpStateMemo.Forget(uiCurState);
+    }
+
+finish:
+    return eStatus;
+}
+
+void MhwVeboxInterface::ForgetVeboxStates()
+{
+    m_dndiStateMemo.Clear();
+    m_iecpStateMemo.Clear();
+}
+
+void MhwVeboxInterface::ForgetVeboxIecpState()
+{
+    if (m_veboxHeap)
+    {
+        m_iecpStateMemo.Forget(m_veboxHeap->uiCurState);
+    }
+}
+
 MOS_STATUS MhwVeboxInterface::GetVeboxHeapInfo(
     const MHW_VEBOX_HEAP     **ppVeboxHeap)
 {
@@ -261,6 +392,15 @@ MOS_STATUS MhwVeboxInterface::CreateHeap( )
 
     m_veboxHeap->uiInstanceSize = uiOffset;
 
+    m_dndiStateMemo.Init(
+        m_veboxSettings.uiNumInstances,
+        sizeof(MHW_VEBOX_DNDI_PARAMS),
+        m_veboxSettings.uiDndiStateSize);
+    m_iecpStateMemo.Init(
+        m_veboxSettings.uiNumInstances,
+        sizeof(MHW_VEBOX_IECP_STATE_KEY),
+        m_veboxSettings.uiIecpStateSize);
+
     // Appending VeboxHeap sync data after all vebox heap instances
     m_veboxHeap->uiOffsetSync   =
         m_veboxHeap->uiInstanceSize *
@@ -354,6 +494,9 @@ MOS_STATUS MhwVeboxInterface::DestroyHeap()
 
         MOS_FreeMemory(m_veboxHeap);
         m_veboxHeap = nullptr;
+
+        m_dndiStateMemo.Init(0, 0, 0);
+        m_iecpStateMemo.Init(0, 0, 0);
     }
 
 finish:
@@ -31,6 +31,7 @@
 #include "mos_os.h"
 #include "mhw_utilities.h"
 #include "mhw_cp_interface.h"
+#include "mhw_vebox_state_memo.h"
 
 #include <math.h>
 
@@ -1098,6 +1099,52 @@ public:
     //!
     MOS_STATUS UpdateVeboxSync();
 
+    //!
+    //! \brief    Update VEBOX DNDI State
+    //! \details  Same as AddVeboxDndiState, except that a block built before
+    //!           from the same params is reused, and not written at all if the
+    //!           current heap instance still holds it
+    //! \param    [in] pVeboxDndiParams
+    //!           Pointer to VEBOX DNDI State Params
+    //! \param    [in] bReusable
+    //!           false if the block is changed after build, e.g. by the
+    //!           denoise update kernel
+    //! \return   MOS_STATUS
+    //!
+    MOS_STATUS UpdateVeboxDndiState(
+        PMHW_VEBOX_DNDI_PARAMS                  pVeboxDndiParams,
+        bool                                    bReusable);
+
+    //!
+    //! \brief    Update VEBOX IECP State
+    //! \details  Same as AddVeboxIecpState, except that a block built before
+    //!           from the same params is reused, and not written at all if the
+    //!           current heap instance still holds it. Params with the capture
+    //!           pipe or LUTs active are always built.
+    //! \param    [in] pVeboxIecpParams
+    //!           Pointer to VEBOX IECP State Params
+    //! \return   MOS_STATUS
+    //!
+    MOS_STATUS UpdateVeboxIecpState(
+        PMHW_VEBOX_IECP_PARAMS                  pVeboxIecpParams);
+
+    //!
+    //! \brief    Forget VEBOX States
+    //! \details  Makes the next UpdateVeboxDndiState and UpdateVeboxIecpState
+    //!           build their blocks, for a change of interface state the blocks
+    //!           depend on besides the params
+    //! \return   void
+    //!
+    void ForgetVeboxStates();
+
+    //!
+    //! \brief    Forget VEBOX IECP State
+    //! \details  For the Add calls that change the IECP block of the current
+    //!           heap instance outside UpdateVeboxIecpState
+    //! \return   void
+    //!
+    void ForgetVeboxIecpState();
+
 private:
     //!
     //! \brief    Refresh Vebox Sync
@@ -1110,6 +1157,9 @@ private:
     //! \brief    Vebox heap instance in use
     int                    m_veboxHeapInUse = 0;
 
+    MhwVeboxStateMemo      m_dndiStateMemo;         //!< DNDI blocks of the heap instances
+    MhwVeboxStateMemo      m_iecpStateMemo;         //!< IECP blocks of the heap instances
+
  public:
     PMOS_INTERFACE         m_osInterface   = nullptr;
     PMHW_VEBOX_HEAP        m_veboxHeap     = nullptr;
@@ -92,7 +92,7 @@ public:
         MOS_STATUS eStatus;
         bool       bOutputValid;
 
-        typename TVeboxCmds::VEBOX_SURFACE_STATE_CMD cmd1, cmd2;
+        typename TVeboxCmds::VEBOX_SURFACE_STATE_CMD *cmd1, *cmd2;
 
         MHW_CHK_NULL(pCmdBuffer);
         MHW_CHK_NULL(pVeboxSurfaceStateCmdParams);
@@ -100,34 +100,39 @@ public:
         eStatus      = MOS_STATUS_SUCCESS;
         bOutputValid = pVeboxSurfaceStateCmdParams->bOutputValid;
 
+        // Both surface states are built in place after a single space check
+        MHW_CHK_STATUS(Mhw_ReserveCmdSpace(pCmdBuffer, (bOutputValid ? 2 : 1) * sizeof(*cmd1)));
+
         // Setup Surface State for Input surface
+        cmd1 = &Mhw_BeginCmd<typename TVeboxCmds::VEBOX_SURFACE_STATE_CMD>(pCmdBuffer);
         SetVeboxSurfaces(
             &pVeboxSurfaceStateCmdParams->SurfInput,
             &pVeboxSurfaceStateCmdParams->SurfSTMM,
             nullptr,
-            &cmd1,
+            cmd1,
             false,
             pVeboxSurfaceStateCmdParams->bDIEnable);
-        Mos_AddCommand(pCmdBuffer, &cmd1, cmd1.byteSize);
+        Mhw_EndCmd(pCmdBuffer, *cmd1);
 
         // Setup Surface State for Output surface
         if (bOutputValid)
         {
+            cmd2 = &Mhw_BeginCmd<typename TVeboxCmds::VEBOX_SURFACE_STATE_CMD>(pCmdBuffer);
             SetVeboxSurfaces(
                 &pVeboxSurfaceStateCmdParams->SurfOutput,
                 &pVeboxSurfaceStateCmdParams->SurfDNOutput,
                 &pVeboxSurfaceStateCmdParams->SurfSkinScoreOutput,
-                &cmd2,
+                cmd2,
                 true,
                 pVeboxSurfaceStateCmdParams->bDIEnable);
 
             // Reset Output Format When Input/Output Format are the same
             if (pVeboxSurfaceStateCmdParams->SurfInput.Format == pVeboxSurfaceStateCmdParams->SurfOutput.Format)
             {
-                cmd2.DW3.SurfaceFormat = cmd1.DW3.SurfaceFormat;
+                cmd2->DW3.SurfaceFormat = cmd1->DW3.SurfaceFormat;
             }
 
-            Mos_AddCommand(pCmdBuffer, &cmd2, cmd2.byteSize);
+            Mhw_EndCmd(pCmdBuffer, *cmd2);
         }
 
     finish:
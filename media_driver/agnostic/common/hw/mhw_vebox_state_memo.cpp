@@ -0,0 +1,110 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mhw_vebox_state_memo.cpp
+//! \brief     Memo of encoded VEBOX indirect state blocks
+//!
+
+#include <string.h>
+#include "mhw_vebox_state_memo.h"
+
+void MhwVeboxStateMemo::Init(uint32_t instanceNum, uint32_t keySize, uint32_t stateSize)
+{
+    m_keySize   = keySize;
+    m_stateSize = stateSize;
+    m_nextEntry = 0;
+    m_instanceIds.assign(instanceNum, 0);
+
+    for (auto &entry : m_entries)
+    {
+        entry.id = 0;
+        entry.key.assign(keySize, 0);
+        entry.state.assign(stateSize, 0);
+    }
+}
+
+bool MhwVeboxStateMemo::Restore(uint32_t instance, const void *key, uint8_t *state)
+{
+    if (instance >= m_instanceIds.size())
+    {
+        return false;
+    }
+
+    for (auto &entry : m_entries)
+    {
+        if (entry.id == 0 || memcmp(entry.key.data(), key, m_keySize) != 0)
+        {
+            continue;
+        }
+
+        if (m_instanceIds[instance] == entry.id)
+        {
+            // Written on an earlier round through the heap and not touched since
+            m_skipCount++;
+        }
+        else
+        {
+            memcpy(state, entry.state.data(), m_stateSize);
+            m_instanceIds[instance] = entry.id;
+            m_copyCount++;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void MhwVeboxStateMemo::Save(uint32_t instance, const void *key, const uint8_t *state)
+{
+    if (instance >= m_instanceIds.size())
+    {
+        return;
+    }
+
+    Entry &entry = m_entries[m_nextEntry];
+    m_nextEntry  = (m_nextEntry + 1) % MHW_VEBOX_STATE_MEMO_NUM;
+
+    // Instances holding the replaced entry still hold valid blocks, but they
+    // can no longer be matched since the id is not reused
+    entry.id = m_nextId++;
+    memcpy(entry.key.data(), key, m_keySize);
+    memcpy(entry.state.data(), state, m_stateSize);
+
+    m_instanceIds[instance] = entry.id;
+}
+
+void MhwVeboxStateMemo::Forget(uint32_t instance)
+{
+    if (instance < m_instanceIds.size())
+    {
+        m_instanceIds[instance] = 0;
+    }
+}
+
+void MhwVeboxStateMemo::Clear()
+{
+    for (auto &entry : m_entries)
+    {
+        entry.id = 0;
+    }
+    m_instanceIds.assign(m_instanceIds.size(), 0);
+}
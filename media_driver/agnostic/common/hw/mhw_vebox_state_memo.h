@@ -0,0 +1,121 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mhw_vebox_state_memo.h
+//! \brief     Memo of encoded VEBOX indirect state blocks
+//! \details   Remembers the last few blocks of one kind (DNDI, IECP) with the
+//!            params they were built from, and which block every VEBOX heap
+//!            instance holds. Building a block again with the same params is
+//!            replaced by nothing when the instance still holds it, otherwise
+//!            by one copy. Only depends on the C++ library so that the ULT can
+//!            build it.
+//!
+
+#ifndef __MHW_VEBOX_STATE_MEMO_H__
+#define __MHW_VEBOX_STATE_MEMO_H__
+
+#include <stdint.h>
+#include <vector>
+
+#define MHW_VEBOX_STATE_MEMO_NUM    4       //!< Blocks remembered, a few streams with different filter settings
+
+class MhwVeboxStateMemo
+{
+public:
+    //!
+    //! \brief    Set up the memo
+    //! \param    [in] instanceNum
+    //!           Number of VEBOX heap instances
+    //! \param    [in] keySize
+    //!           Size of the params a block is built from
+    //! \param    [in] stateSize
+    //!           Size of the block
+    //! \return   void
+    //!
+    void Init(uint32_t instanceNum, uint32_t keySize, uint32_t stateSize);
+
+    //!
+    //! \brief    Put a remembered block into a heap instance
+    //! \param    [in] instance
+    //!           Heap instance
+    //! \param    [in] key
+    //!           Params of the block, keySize bytes
+    //! \param    [out] state
+    //!           Block of the instance in the heap
+    //! \return   bool
+    //!           true if the instance holds the block, either already or by
+    //!           copy; false if the caller has to build it and call Save
+    //!
+    bool Restore(uint32_t instance, const void *key, uint8_t *state);
+
+    //!
+    //! \brief    Remember the block just built into a heap instance
+    //! \param    [in] instance
+    //!           Heap instance
+    //! \param    [in] key
+    //!           Params of the block, keySize bytes
+    //! \param    [in] state
+    //!           Block of the instance in the heap
+    //! \return   void
+    //!
+    void Save(uint32_t instance, const void *key, const uint8_t *state);
+
+    //!
+    //! \brief    Forget what a heap instance holds
+    //! \details  For blocks built without a key or changed after build, e.g.
+    //!           by a kernel
+    //! \param    [in] instance
+    //!           Heap instance
+    //! \return   void
+    //!
+    void Forget(uint32_t instance);
+
+    //!
+    //! \brief    Forget all blocks
+    //! \details  For a change of state the blocks are built from besides the
+    //!           params
+    //! \return   void
+    //!
+    void Clear();
+
+    uint32_t GetSkipCount() { return m_skipCount; }
+    uint32_t GetCopyCount() { return m_copyCount; }
+
+private:
+    struct Entry
+    {
+        uint32_t                id = 0;             //!< 0 if unused
+        std::vector<uint8_t>    key;
+        std::vector<uint8_t>    state;
+    };
+
+    Entry                   m_entries[MHW_VEBOX_STATE_MEMO_NUM];
+    std::vector<uint32_t>   m_instanceIds;          //!< Entry id held by each heap instance, 0 if unknown
+    uint32_t                m_keySize   = 0;
+    uint32_t                m_stateSize = 0;
+    uint32_t                m_nextEntry = 0;        //!< Round robin replacement
+    uint32_t                m_nextId    = 1;
+    uint32_t                m_skipCount = 0;
+    uint32_t                m_copyCount = 0;
+};
+
+#endif // __MHW_VEBOX_STATE_MEMO_H__
@@ -36,6 +36,8 @@ set(TMP_HEADERS_
     ${CMAKE_CURRENT_LIST_DIR}/mos_context.h
     ${CMAKE_CURRENT_LIST_DIR}/mos_defs.h
     ${CMAKE_CURRENT_LIST_DIR}/mos_graphicsresource.h
+    ${CMAKE_CURRENT_LIST_DIR}/mos_metrics.h
+    ${CMAKE_CURRENT_LIST_DIR}/mos_copy.h
     ${CMAKE_CURRENT_LIST_DIR}/mos_os.h
     ${CMAKE_CURRENT_LIST_DIR}/mos_os_hw.h
     ${CMAKE_CURRENT_LIST_DIR}/mos_os_trace_event.h
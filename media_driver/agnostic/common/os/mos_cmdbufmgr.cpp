@@ -57,10 +57,10 @@ MOS_STATUS CmdBufMgr::Initialize(OsContext *osContext, uint32_t cmdBufSize)
     {
         m_osContext          = osContext;
 
-        m_inUsePoolMutex     = MOS_CreateMutex();
+        m_inUsePoolMutex     = MOS_CreateNamedMutex("MosCmdBufInUsePool", true);
         MOS_OS_CHK_NULL_RETURN(m_inUsePoolMutex);
 
-        m_availablePoolMutex = MOS_CreateMutex();
+        m_availablePoolMutex = MOS_CreateNamedMutex("MosCmdBufAvailablePool", true);
         MOS_OS_CHK_NULL_RETURN(m_availablePoolMutex);
 
         for (int i = 0; i < m_initBufNum; i++)
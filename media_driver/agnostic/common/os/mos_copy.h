@@ -0,0 +1,183 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_copy.h
+//! \brief     CPU copy and fill for memory shared with the GPU
+//! \details   Write-combined and uncached mappings (GTT, WC and uncached
+//!            locks) are slow with the plain memcpy/memset of the C library:
+//!            stores to them should be streaming stores of full lines, and
+//!            loads from them streaming loads. The routines here take the
+//!            memory type of the copy and use the widest instruction set of
+//!            the CPU, picked once at run time (SSE2, SSE4.1, AVX2, AVX-512).
+//!            Copies between cached buffers go to the C library, which is
+//!            already tuned for them.
+//!            Every routine drains its streaming stores before returning, so
+//!            the destination can be unlocked and handed to the GPU right
+//!            away. The header only depends on libc so that the ULT can
+//!            include it.
+//!
+
+#ifndef __MOS_COPY_H__
+#define __MOS_COPY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MOS_COPY_MAX_THREADS            4
+
+//!
+//! \brief    Copies smaller than this stay on the calling thread
+//!
+#define MOS_COPY_PARALLEL_THRESHOLD     (4 * 1024 * 1024)
+
+//!
+//! \brief    Memory types of a copy
+//!
+typedef enum _MOS_COPY_MEMORY
+{
+    MOS_COPY_MEMORY_CACHED = 0,             //!< Both sides cached
+    MOS_COPY_MEMORY_TO_WC,                  //!< Destination is a write-combined or uncached mapping
+    MOS_COPY_MEMORY_FROM_WC                 //!< Source is a write-combined or uncached mapping
+} MOS_COPY_MEMORY;
+
+//!
+//! \brief    Instruction sets of the copy routines
+//!
+typedef enum _MOS_COPY_ISA
+{
+    MOS_COPY_ISA_C = 0,
+    MOS_COPY_ISA_SSE2,                      //!< Streaming stores
+    MOS_COPY_ISA_SSE4_1,                    //!< Streaming stores and loads
+    MOS_COPY_ISA_AVX2,
+    MOS_COPY_ISA_AVX512,
+    MOS_COPY_ISA_NUM
+} MOS_COPY_ISA;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//!
+//! \brief    Copy a buffer
+//! \param    [out] dst
+//!           Destination
+//! \param    [in] src
+//!           Source, not overlapping the destination
+//! \param    [in] bytes
+//!           Size to copy
+//! \param    [in] memory
+//!           Memory types of the copy
+//! \return   void
+//!
+void MosCopy_Copy(void *dst, const void *src, size_t bytes, MOS_COPY_MEMORY memory);
+
+//!
+//! \brief    Copy a buffer, split over threads when it is large
+//! \details  Same as MosCopy_Copy below MOS_COPY_PARALLEL_THRESHOLD. Worth it
+//!           for multi-megabyte copies from WC mappings, whose bandwidth is
+//!           bound by the loads one core has in flight.
+//! \param    [out] dst
+//!           Destination
+//! \param    [in] src
+//!           Source, not overlapping the destination
+//! \param    [in] bytes
+//!           Size to copy
+//! \param    [in] memory
+//!           Memory types of the copy
+//! \param    [in] maxThreads
+//!           Upper bound of threads to use, the calling thread included
+//! \return   void
+//!
+void MosCopy_CopyParallel(void *dst, const void *src, size_t bytes, MOS_COPY_MEMORY memory, uint32_t maxThreads);
+
+//!
+//! \brief    Copy a pitched region
+//! \param    [out] dst
+//!           First row of the destination
+//! \param    [in] dstPitch
+//!           Destination pitch in bytes
+//! \param    [in] src
+//!           First row of the source
+//! \param    [in] srcPitch
+//!           Source pitch in bytes
+//! \param    [in] rowBytes
+//!           Bytes to copy of each row
+//! \param    [in] rows
+//!           Number of rows
+//! \param    [in] memory
+//!           Memory types of the copy
+//! \param    [in] maxThreads
+//!           Upper bound of threads to use, 1 to stay on the calling thread
+//! \return   void
+//!
+void MosCopy_Copy2D(
+    void            *dst,
+    uint32_t        dstPitch,
+    const void      *src,
+    uint32_t        srcPitch,
+    uint32_t        rowBytes,
+    uint32_t        rows,
+    MOS_COPY_MEMORY memory,
+    uint32_t        maxThreads);
+
+//!
+//! \brief    Fill a buffer
+//! \param    [out] dst
+//!           Destination
+//! \param    [in] value
+//!           Byte to fill with
+//! \param    [in] bytes
+//!           Size to fill
+//! \param    [in] dstWC
+//!           true if the destination is a write-combined or uncached mapping
+//! \return   void
+//!
+void MosCopy_Fill(void *dst, uint8_t value, size_t bytes, bool dstWC);
+
+//!
+//! \brief    Get the instruction set in use
+//! \return   MOS_COPY_ISA
+//!
+MOS_COPY_ISA MosCopy_GetIsa();
+
+//!
+//! \brief    Use another instruction set, for tests and benchmarks
+//! \param    [in] isa
+//!           Instruction set
+//! \return   bool
+//!           false if the CPU does not support it, the current one is kept
+//!
+bool MosCopy_SetIsa(MOS_COPY_ISA isa);
+
+//!
+//! \brief    Get the name of an instruction set
+//! \param    [in] isa
+//!           Instruction set
+//! \return   const char*
+//!
+const char *MosCopy_GetIsaName(MOS_COPY_ISA isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MOS_COPY_H__
@@ -32,7 +32,7 @@ GpuContextMgr::GpuContextMgr(GT_SYSTEM_INFO *gtSystemInfo, OsContext *osContext)
 {
     MOS_OS_FUNCTION_ENTER;
 
-    m_gpuContextArrayMutex = MOS_CreateMutex();
+    m_gpuContextArrayMutex = MOS_CreateNamedMutex("MosGpuContextArray", false);
     MOS_OS_CHK_NULL_NO_STATUS_RETURN(m_gpuContextArrayMutex);
 
     MOS_LockMutex(m_gpuContextArrayMutex);
@@ -255,6 +255,20 @@ public:
     //!
     uint8_t* GetLockedAddr() {return m_pData; };
 
+    //!
+    //! \brief  Get the buf name of the graphic resource
+    //! \return buf name, valid until the name is set again
+    //!
+    const char* GetName() { return m_name.c_str(); };
+
+    //!
+    //! \brief  Set the buf name of the graphic resource
+    //! \param  [in] name
+    //!         buf name, nullptr for none
+    //! \return void
+    //!
+    void SetName(const char *name) { m_name = name ? name : ""; };
+
     //!
     //! \brief  Get allocation index of resource
     //! \param  [in] gpuContextHandle
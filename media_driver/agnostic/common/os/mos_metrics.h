@@ -0,0 +1,306 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_metrics.h
+//! \brief     Always-on counters and latency histograms for driver hot paths
+//! \details   Every metric has a call count, a total time and a histogram of
+//!            log2 nanosecond buckets. Threads are spread over a small set of
+//!            cache line aligned shards and only add to their own shard with
+//!            relaxed atomics, so recording never takes a lock or bounces a
+//!            line between cores. Readers merge the shards.
+//!            The shards live in one flat segment without pointers. When the
+//!            "Media Metrics Export" user feature is set the segment is moved
+//!            to shared memory (MOS_METRICS_SHM_PREFIX + pid) where the
+//!            media_metrics tool can read it while the process runs.
+//!            The layout part of this header only depends on libc so that the
+//!            tool can include it.
+//!
+
+#ifndef __MOS_METRICS_H__
+#define __MOS_METRICS_H__
+
+#include <stdint.h>
+
+#define MOS_METRICS_MAGIC           0x4d45544d      //!< "METM"
+#define MOS_METRICS_VERSION         1
+#define MOS_METRICS_SHARD_NUM       16
+#define MOS_METRICS_BUCKET_NUM      32              //!< Bucket i holds [2^i, 2^(i+1)) ns, the last one everything above
+#define MOS_METRICS_SHM_PREFIX      "/media_metrics."
+
+//!
+//! \brief    Instrumented points
+//! \details  Append only, the tool reads the names from the segment version
+//!           it was built with.
+//!
+typedef enum _MOS_METRIC_ID
+{
+    MOS_METRIC_DDI_CREATE_SURFACES = 0,
+    MOS_METRIC_DDI_BEGIN_PICTURE,
+    MOS_METRIC_DDI_RENDER_PICTURE,
+    MOS_METRIC_DDI_END_PICTURE,
+    MOS_METRIC_DDI_SYNC_SURFACE,
+    MOS_METRIC_DDI_GET_IMAGE,
+    MOS_METRIC_DDI_PUT_IMAGE,
+    MOS_METRIC_SUBMIT_CMD_BUFFER,
+    MOS_METRIC_GET_CMD_BUFFER,
+    MOS_METRIC_RESOURCE_ALLOCATE,
+    MOS_METRIC_RESOURCE_FREE,
+    MOS_METRIC_HEAP_WAIT,
+    MOS_METRIC_DECODE_STATUS_REPORT,
+    MOS_METRIC_ENCODE_STATUS_REPORT,
+    MOS_METRIC_SURFACE_STATE_SETUP,
+    MOS_METRIC_SURFACE_STATE_CACHE_HIT,
+    MOS_METRIC_POLYPHASE_TABLE_CALC,
+    MOS_METRIC_POLYPHASE_TABLE_CACHE_HIT,
+    MOS_METRIC_NUM
+} MOS_METRIC_ID;
+
+static const char * const g_mosMetricNames[MOS_METRIC_NUM] =
+{
+    "DdiCreateSurfaces",
+    "DdiBeginPicture",
+    "DdiRenderPicture",
+    "DdiEndPicture",
+    "DdiSyncSurface",
+    "DdiGetImage",
+    "DdiPutImage",
+    "SubmitCommandBuffer",
+    "GetCommandBuffer",
+    "ResourceAllocate",
+    "ResourceFree",
+    "HeapWait",
+    "DecodeStatusReport",
+    "EncodeStatusReport",
+    "SurfaceStateSetup",
+    "SurfaceStateCacheHit",
+    "PolyphaseTableCalc",
+    "PolyphaseTableCacheHit",
+};
+
+typedef struct _MOS_METRICS_SHARD
+{
+    uint64_t    count[MOS_METRIC_NUM];
+    uint64_t    totalNs[MOS_METRIC_NUM];
+    uint64_t    histogram[MOS_METRIC_NUM][MOS_METRICS_BUCKET_NUM];
+} __attribute__((aligned(64))) MOS_METRICS_SHARD, *PMOS_METRICS_SHARD;
+
+typedef struct _MOS_METRICS_SEGMENT
+{
+    uint32_t            magic;
+    uint32_t            version;
+    uint32_t            metricNum;
+    uint32_t            bucketNum;
+    uint32_t            shardNum;
+    uint32_t            pid;
+    uint64_t            startNs;                    //!< Monotonic time of the first record
+    MOS_METRICS_SHARD   shard[MOS_METRICS_SHARD_NUM];
+} __attribute__((aligned(64))) MOS_METRICS_SEGMENT, *PMOS_METRICS_SEGMENT;
+
+//!
+//! \brief    Get the histogram bucket of a duration
+//! \param    [in] ns
+//!           Duration in nanoseconds
+//! \return   uint32_t
+//!           Bucket index
+//!
+static inline uint32_t MosMetrics_GetBucket(uint64_t ns)
+{
+    uint32_t bucket = ns ? 63 - __builtin_clzll(ns) : 0;
+    return (bucket < MOS_METRICS_BUCKET_NUM) ? bucket : MOS_METRICS_BUCKET_NUM - 1;
+}
+
+//!
+//! \brief    Add one event to a shard
+//! \param    [in] shard
+//!           Shard of the calling thread
+//! \param    [in] id
+//!           Metric
+//! \param    [in] ns
+//!           Duration in nanoseconds
+//! \param    [in] timed
+//!           false to only count the event
+//! \return   void
+//!
+static inline void MosMetrics_AddToShard(
+    PMOS_METRICS_SHARD  shard,
+    MOS_METRIC_ID       id,
+    uint64_t            ns,
+    bool                timed)
+{
+    __atomic_fetch_add(&shard->count[id], 1, __ATOMIC_RELAXED);
+    if (timed)
+    {
+        __atomic_fetch_add(&shard->totalNs[id], ns, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&shard->histogram[id][MosMetrics_GetBucket(ns)], 1, __ATOMIC_RELAXED);
+    }
+}
+
+//!
+//! \brief    Merge all shards of a segment
+//! \param    [in] segment
+//!           Segment to read, may be in another process
+//! \param    [out] total
+//!           Sum of the shards
+//! \return   void
+//!
+static inline void MosMetrics_Merge(
+    const MOS_METRICS_SEGMENT   *segment,
+    PMOS_METRICS_SHARD          total)
+{
+    for (uint32_t id = 0; id < MOS_METRIC_NUM; id++)
+    {
+        total->count[id]   = 0;
+        total->totalNs[id] = 0;
+        for (uint32_t b = 0; b < MOS_METRICS_BUCKET_NUM; b++)
+        {
+            total->histogram[id][b] = 0;
+        }
+    }
+
+    for (uint32_t s = 0; s < MOS_METRICS_SHARD_NUM; s++)
+    {
+        const MOS_METRICS_SHARD *shard = &segment->shard[s];
+        for (uint32_t id = 0; id < MOS_METRIC_NUM; id++)
+        {
+            total->count[id]   += __atomic_load_n(&shard->count[id], __ATOMIC_RELAXED);
+            total->totalNs[id] += __atomic_load_n(&shard->totalNs[id], __ATOMIC_RELAXED);
+            for (uint32_t b = 0; b < MOS_METRICS_BUCKET_NUM; b++)
+            {
+                total->histogram[id][b] += __atomic_load_n(&shard->histogram[id][b], __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+//!
+//! \brief    Estimate a percentile from a histogram
+//! \param    [in] histogram
+//!           MOS_METRICS_BUCKET_NUM buckets of one metric
+//! \param    [in] percent
+//!           Percentile in [0, 100]
+//! \return   uint64_t
+//!           Upper bound in nanoseconds of the bucket holding the percentile,
+//!           0 if the histogram is empty
+//!
+static inline uint64_t MosMetrics_GetPercentile(const uint64_t *histogram, double percent)
+{
+    uint64_t events = 0;
+    for (uint32_t b = 0; b < MOS_METRICS_BUCKET_NUM; b++)
+    {
+        events += histogram[b];
+    }
+    if (events == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(events * percent / 100.0);
+    rank = (rank == 0) ? 1 : rank;
+
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < MOS_METRICS_BUCKET_NUM; b++)
+    {
+        seen += histogram[b];
+        if (seen >= rank)
+        {
+            return (2ull << b) - 1;
+        }
+    }
+    return UINT64_MAX;
+}
+
+#ifdef __cplusplus
+
+//!
+//! \brief    Get the current monotonic time
+//! \return   uint64_t
+//!           Time in nanoseconds
+//!
+uint64_t MosMetrics_GetTimeNs();
+
+//!
+//! \brief    Get the segment the driver records to
+//! \return   PMOS_METRICS_SEGMENT
+//!           Process private segment, or the shared one once exported
+//!
+PMOS_METRICS_SEGMENT MosMetrics_GetSegment();
+
+//!
+//! \brief    Record a timed event
+//! \param    [in] id
+//!           Metric
+//! \param    [in] ns
+//!           Duration in nanoseconds
+//! \return   void
+//!
+void MosMetrics_Record(MOS_METRIC_ID id, uint64_t ns);
+
+//!
+//! \brief    Record an event without duration
+//! \param    [in] id
+//!           Metric
+//! \return   void
+//!
+void MosMetrics_Count(MOS_METRIC_ID id);
+
+//!
+//! \brief    Move the metrics to a shared memory segment named after the pid
+//! \details  Counts recorded so far are carried over. Calls are reference
+//!           counted with MosMetrics_Unexport.
+//! \return   bool
+//!           true if the segment is exported
+//!
+bool MosMetrics_Export();
+
+//!
+//! \brief    Remove the name of the shared memory segment
+//! \details  The mapping stays in place since other threads may still be
+//!           recording to it; it goes away with the process.
+//! \return   void
+//!
+void MosMetrics_Unexport();
+
+//!
+//! \class    MosMetricsScope
+//! \brief    Record the time spent in a scope
+//!
+class MosMetricsScope
+{
+public:
+    MosMetricsScope(MOS_METRIC_ID id) : m_id(id), m_startNs(MosMetrics_GetTimeNs()) {}
+
+    ~MosMetricsScope()
+    {
+        MosMetrics_Record(m_id, MosMetrics_GetTimeNs() - m_startNs);
+    }
+
+private:
+    MOS_METRIC_ID   m_id;
+    uint64_t        m_startNs;
+};
+
+#define MOS_METRICS_SCOPE(id)   MosMetricsScope _mosMetricsScope(id)
+#define MOS_METRICS_COUNT(id)   MosMetrics_Count(id)
+
+#endif // __cplusplus
+
+#endif // __MOS_METRICS_H__
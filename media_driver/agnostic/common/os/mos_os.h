@@ -474,6 +474,7 @@ typedef struct _MOS_INTERFACE
 #endif
 
     bool                            bEnableVdboxBalancing;                            //!< Enable per BB VDBox balancing
+    uint32_t                        dwVdboxWorkload;                                  //!< Work charged to the VDBox node per submission, in macroblocks
 
 #if (_DEBUG || _RELEASE_INTERNAL)
     MOS_FORCE_VDBOX                 eForceVdbox;                                  //!< Force select Vdbox
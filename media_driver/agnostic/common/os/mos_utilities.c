@@ -199,6 +199,16 @@ int32_t MosMemAllocCounterNoUserFeature;
 int32_t MosMemAllocCounterNoUserFeatureGfx;
 uint8_t MosUltFlag;
 
+#define MOS_ULT_USER_FEATURE_MAX 16
+
+//! User feature values forced by the ULT, they take precedence over the user feature file
+static struct
+{
+    char    valueName[MAX_USER_FEATURE_FIELD_LENGTH];
+    int64_t value;
+} MosUltUserFeatures[MOS_ULT_USER_FEATURE_MAX];
+static uint32_t MosUltUserFeatureCount;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -208,6 +218,39 @@ extern "C" {
         MosUltFlag = ultFlag;
     }
 
+    //!
+    //! \brief    Force the value of a primitive user feature in the ULT
+    //! \details  Only read while the ULT flag is set. A nullptr value name
+    //!           clears all forced values.
+    //!
+    MOS_FUNC_EXPORT void MOS_SetUltUserFeature(const char *valueName, int64_t value)
+    {
+        if (valueName == nullptr)
+        {
+            MosUltUserFeatureCount = 0;
+            return;
+        }
+
+        uint32_t i;
+        for (i = 0; i < MosUltUserFeatureCount; i++)
+        {
+            if (!strcmp(MosUltUserFeatures[i].valueName, valueName))
+            {
+                break;
+            }
+        }
+        if (i == MOS_ULT_USER_FEATURE_MAX)
+        {
+            return;
+        }
+        if (i == MosUltUserFeatureCount)
+        {
+            MOS_SecureStrcpy(MosUltUserFeatures[i].valueName, sizeof(MosUltUserFeatures[i].valueName), valueName);
+            MosUltUserFeatureCount++;
+        }
+        MosUltUserFeatures[i].value = value;
+    }
+
     MOS_FUNC_EXPORT int32_t MOS_GetMemNinjaCounter()
     {
         return MosMemAllocCounterNoUserFeature;
@@ -411,6 +454,78 @@ static MOS_USER_FEATURE_VALUE MOSUserFeatureDescFields[__MOS_USER_FEATURE_KEY_MA
      MOS_USER_FEATURE_VALUE_TYPE_INT32,
      "1",
      "Enables/Disables MFE MBEnc Mode. This feature is only enabled for AVC encode."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_ENCODE_AUTO_MFE_ENABLE_ID,
+     "Encode Auto MFE Enable",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Encode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "0",
+     "Batches frames of independent AVC encode contexts into MFE submissions. This feature is only enabled for AVC encode."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_ENCODE_AUTO_MFE_WINDOW_ID,
+     "Encode Auto MFE Window",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Encode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "2000",
+     "Max time in microseconds a frame waits for frames of other streams in auto MFE mode."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_JPEG_ENCODE_BATCH_SIZE_ID,
+     "JPEG Encode Batch Size",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Encode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "1",
+     "Number of JPEG pictures submitted in one command buffer. 1 submits every picture on its own."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_SIZE_ID,
+     "Decode Context Pool Size",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Decode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "0",
+     "Number of destroyed decode contexts kept for reuse by a later vaCreateContext. 0 disables the pool."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_IDLE_TIME_ID,
+     "Decode Context Pool Idle Time",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Decode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "2000",
+     "Time in milliseconds a pooled decode context is kept before it is destroyed."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_MAX_MBS_ID,
+     "Decode Context Pool Max MBs",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Decode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "65280",
+     "Max sum of the frame sizes in macroblocks of all pooled decode contexts. Bounds the memory held by the pool."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_DECODE_SCRATCH_POOL_ENABLE_ID,
+     "Decode Scratch Pool Enable",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Decode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "0",
+     "Share row store scratch buffers between decoders submitting to the same engine."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_JPEG_DECODE_BATCH_SIZE_ID,
+     "JPEG Decode Batch Size",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Decode",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "1",
+     "Number of JPEG pictures decoded from one command buffer. 1 submits every picture on its own."),
     MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_RC_PANIC_ENABLE_ID,
      "RC Panic Mode",
      __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
@@ -1518,6 +1633,51 @@ MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_ENCODE_BRC_SOFTWARE_ID,
      MOS_USER_FEATURE_VALUE_TYPE_BOOL,
      "0",
      "Enable balancing of VDBox load by KMD hint. (Default FALSE: disabled"),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_VDBOX_LOAD_AWARE_BALANCING_ID,
+     "VDBox Load Aware Balancing",
+     __MEDIA_USER_FEATURE_SUBKEY_PERFORMANCE,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "Codec",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_BOOL,
+     "0",
+     "Balance VDBox nodes by recently submitted macroblocks across processes instead of by session count."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_MEDIA_METRICS_EXPORT_ID,
+     "Media Metrics Export",
+     __MEDIA_USER_FEATURE_SUBKEY_PERFORMANCE,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "MOS",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_BOOL,
+     "0",
+     "Publish the driver hot path counters in shared memory for the media_metrics tool."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_RENDERHAL_SURFACE_STATE_CACHE_ENABLE_ID,
+     "RenderHal Surface State Cache Enable",
+     __MEDIA_USER_FEATURE_SUBKEY_PERFORMANCE,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "VP",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_BOOL,
+     "0",
+     "Reuse the surface state of an earlier setup with the same surface and params instead of setting it up from scratch."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_MEDIA_LOCK_PROFILE_OUTPUT_FILE_ID,
+     "Media Lock Profile Output File",
+     __MEDIA_USER_FEATURE_SUBKEY_PERFORMANCE,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "MOS",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_STRING,
+     "",
+     "Profile the contention of the driver mutexes and write a report per site to this file when the driver closes. %d is replaced by the pid."),
+    MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_MEDIA_RESOURCE_RECYCLER_SIZE_ID,
+     "Media Resource Recycler Size",
+     __MEDIA_USER_FEATURE_SUBKEY_PERFORMANCE,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "MOS",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_INT32,
+     "0",
+     "Max MB of freed resources kept per device for allocations of the same description. 0 disables the recycler."),
     MOS_DECLARE_UF_KEY(__MEDIA_USER_FEATURE_VALUE_NUMBER_OF_CODEC_DEVICES_ON_VDBOX1_ID,
      "Num of Codec Devices on VDBOX1",
      __MEDIA_USER_FEATURE_SUBKEY_REPORT,//read path and write path are the same
@@ -2600,6 +2760,24 @@ MOS_DECLARE_UF_KEY_DBGONLY(__MEDIA_USER_FEATURE_VALUE_ENCODE_BRC_SOFTWARE_ID,
      MOS_USER_FEATURE_VALUE_TYPE_UINT32,
      "0",
      "VP Bypass Composition Mode"),
+    MOS_DECLARE_UF_KEY(__VPHAL_RNDR_BATCH_SIZE_ID,
+     "VP Render Batch Size",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "VP",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "1",
+     "Composite jobs submitted per command buffer, 1 to submit each job."),
+    MOS_DECLARE_UF_KEY(__VPHAL_RNDR_BATCH_WINDOW_ID,
+     "VP Render Batch Window",
+     __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
+     __MEDIA_USER_FEATURE_SUBKEY_REPORT,
+     "VP",
+     MOS_USER_FEATURE_TYPE_USER,
+     MOS_USER_FEATURE_VALUE_TYPE_UINT32,
+     "2000",
+     "Longest time in us a batched composite job waits for submission."),
     MOS_DECLARE_UF_KEY(__VPHAL_VEBOX_DISABLE_SFC_ID,
      "Disable SFC",
      __MEDIA_USER_FEATURE_SUBKEY_INTERNAL,
@@ -5376,6 +5554,54 @@ MOS_STATUS MOS_UserFeature_ReadValue (
 }
 #endif
 
+//!
+//! \brief    Read a user feature value forced by the ULT
+//! \param    [in] pUserFeature
+//!           User feature key definition
+//! \param    [out] pValueData
+//!           Pointer to User Feature Data
+//! \return   bool
+//!           true if the ULT forced the value
+//!
+static bool MOS_UserFeature_ReadUltValue(
+    PMOS_USER_FEATURE_VALUE         pUserFeature,
+    PMOS_USER_FEATURE_VALUE_DATA    pValueData)
+{
+    for (uint32_t i = 0; i < MosUltUserFeatureCount; i++)
+    {
+        if (strcmp(MosUltUserFeatures[i].valueName, pUserFeature->pValueName))
+        {
+            continue;
+        }
+
+        int64_t value = MosUltUserFeatures[i].value;
+        switch (pUserFeature->ValueType)
+        {
+            case MOS_USER_FEATURE_VALUE_TYPE_BOOL:
+                pValueData->bData = value ? true : false;
+                return true;
+            case MOS_USER_FEATURE_VALUE_TYPE_INT32:
+                pValueData->i32Data = (int32_t)value;
+                return true;
+            case MOS_USER_FEATURE_VALUE_TYPE_INT64:
+                pValueData->i64Data = value;
+                return true;
+            case MOS_USER_FEATURE_VALUE_TYPE_UINT32:
+                pValueData->u32Data = (uint32_t)value;
+                return true;
+            case MOS_USER_FEATURE_VALUE_TYPE_UINT64:
+                pValueData->u64Data = (uint64_t)value;
+                return true;
+            case MOS_USER_FEATURE_VALUE_TYPE_FLOAT:
+                pValueData->fData = (float)value;
+                return true;
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
 //!
 //! \brief    Read Single Value from User Feature based on value of enum type in MOS_USER_FEATURE_VALUE_TYPE with specified map table
 //! \details  This is a unified funtion to read user feature key for all components.
@@ -5470,6 +5696,11 @@ MOS_STATUS MOS_UserFeature_ReadValue_FromMap_ID(
         return eStatus;
     }
 
+    if (MosUltFlag && MOS_UserFeature_ReadUltValue(pUserFeature, pValueData))
+    {
+        return MOS_STATUS_SUCCESS;
+    }
+
     // Open the user feature
     // Assigned the pUserFeature to UFKey for future reading
     UFKey = pUserFeature;
@@ -96,6 +96,15 @@ private:
 //!
 double MOS_GetTime();
 
+//!
+//! \brief    Get current monotonic time
+//! \details  Get time in us from a clock that wall clock adjustments do not
+//!           move, for measuring intervals
+//! \return   double
+//!           Returns time in us
+//!
+double MOS_GetMonotonicTime();
+
 #ifndef __MOS_USER_FEATURE_WA_
 #define  __MOS_USER_FEATURE_WA_
 #endif
@@ -198,6 +207,14 @@ typedef enum _MOS_USER_FEATURE_VALUE_ID
     __MEDIA_USER_FEATURE_VALUE_DISABLE_KMD_WATCHDOG_ID,
     __MEDIA_USER_FEATURE_VALUE_SINGLE_TASK_PHASE_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_MFE_MBENC_ENABLE_ID,
+    __MEDIA_USER_FEATURE_VALUE_ENCODE_AUTO_MFE_ENABLE_ID,
+    __MEDIA_USER_FEATURE_VALUE_ENCODE_AUTO_MFE_WINDOW_ID,
+    __MEDIA_USER_FEATURE_VALUE_JPEG_ENCODE_BATCH_SIZE_ID,
+    __MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_SIZE_ID,
+    __MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_IDLE_TIME_ID,
+    __MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_MAX_MBS_ID,
+    __MEDIA_USER_FEATURE_VALUE_DECODE_SCRATCH_POOL_ENABLE_ID,
+    __MEDIA_USER_FEATURE_VALUE_JPEG_DECODE_BATCH_SIZE_ID,
     __MEDIA_USER_FEATURE_VALUE_RC_PANIC_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_SLICE_SHUTDOWN_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_FORCE_YFYS_ID,
@@ -320,6 +337,11 @@ typedef enum _MOS_USER_FEATURE_VALUE_ID
     __MEDIA_USER_FEATURE_VALUE_SLICE_COUNT_SET_SUPPORT_ID,
     __MEDIA_USER_FEATURE_VALUE_DYNAMIC_SLICE_SHUTDOWN_ID,
     __MEDIA_USER_FEATURE_VALUE_ENABLE_VDBOX_BALANCING_ID,
+    __MEDIA_USER_FEATURE_VALUE_VDBOX_LOAD_AWARE_BALANCING_ID,
+    __MEDIA_USER_FEATURE_VALUE_MEDIA_METRICS_EXPORT_ID,
+    __MEDIA_USER_FEATURE_VALUE_RENDERHAL_SURFACE_STATE_CACHE_ENABLE_ID,
+    __MEDIA_USER_FEATURE_VALUE_MEDIA_LOCK_PROFILE_OUTPUT_FILE_ID,
+    __MEDIA_USER_FEATURE_VALUE_MEDIA_RESOURCE_RECYCLER_SIZE_ID,
     __MEDIA_USER_FEATURE_VALUE_MPEG2_SLICE_STATE_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_MPEG2_ENCODE_BRC_DISTORTION_BUFFER_ENABLE_ID,
     __MEDIA_USER_FEATURE_VALUE_NUMBER_OF_CODEC_DEVICES_ON_VDBOX1_ID,
@@ -457,6 +479,8 @@ typedef enum _MOS_USER_FEATURE_VALUE_ID
 #endif
     __VPHAL_SET_SINGLE_SLICE_VEBOX_ID,
     __VPHAL_BYPASS_COMPOSITION_ID,
+    __VPHAL_RNDR_BATCH_SIZE_ID,
+    __VPHAL_RNDR_BATCH_WINDOW_ID,
     __VPHAL_VEBOX_DISABLE_SFC_ID,
     __VPHAL_ENABLE_MMC_ID,
     __VPHAL_ENABLE_VEBOX_MMC_DECOMPRESS_ID,
@@ -2265,6 +2289,20 @@ MOS_STATUS MOS_WaitThread(
 //!
 PMOS_MUTEX MOS_CreateMutex();
 
+//!
+//! \brief    Create mutex under a site name of the lock profile
+//! \details  All mutexes of a name are profiled as one site when the
+//!           "Media Lock Profile Output File" user feature is set.
+//! \param    [in] name
+//!           Static site name
+//! \param    [in] adaptiveSpin
+//!           Spin a while before sleeping when the mutex is locked, for
+//!           critical sections of a few hundred nanoseconds
+//! \return   PMOS_MUTEX
+//!           Pointer of mutex
+//!
+PMOS_MUTEX MOS_CreateNamedMutex(const char *name, bool adaptiveSpin);
+
 //!
 //! \brief    Destroy mutex for context protection across threads
 //! \details  Destroy mutex for context protection across threads
@@ -22,12 +22,14 @@ set(TMP_SOURCES_
     ${CMAKE_CURRENT_LIST_DIR}/renderhal.cpp
     ${CMAKE_CURRENT_LIST_DIR}/renderhal_dsh.cpp
     ${CMAKE_CURRENT_LIST_DIR}/renderhal_common.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/renderhal_surface_state_cache.cpp
 )
 
 set(TMP_HEADERS_
     ${CMAKE_CURRENT_LIST_DIR}/renderhal.h
     ${CMAKE_CURRENT_LIST_DIR}/renderhal_dsh.h
     ${CMAKE_CURRENT_LIST_DIR}/renderhal_platform_interface.h
+    ${CMAKE_CURRENT_LIST_DIR}/renderhal_surface_state_cache.h
     ${CMAKE_CURRENT_LIST_DIR}/vphal_renderhal_common.h
 )
 
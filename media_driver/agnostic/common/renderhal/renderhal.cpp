@@ -26,7 +26,9 @@
 //!
 
 #include "mos_os.h"
+#include "mos_metrics.h"
 #include "renderhal.h"
+#include "renderhal_surface_state_cache.h"
 #include "hal_kerneldll.h"
 #include "renderhal_platform_interface.h"
 #include "media_interfaces_renderhal.h"
@@ -4064,6 +4066,7 @@ PRENDERHAL_MEDIA_STATE RenderHal_AssignMediaState(
     // If this ever happens, please consider increasing the number of media states
     if (pCurMediaState->bBusy)
     {
+        MOS_METRICS_SCOPE(MOS_METRIC_HEAP_WAIT);
         dwWaitTag   = pCurMediaState->dwSyncTag;
 
         // Wait for Batch Buffer complete event OR timeout
@@ -4195,6 +4198,9 @@ MOS_STATUS RenderHal_Destroy(PRENDERHAL_INTERFACE pRenderHal)
     // Free Debug Surface
     RenderHal_FreeDebugSurface(pRenderHal);
 
+    // Free Surface State Cache
+    MOS_FreeMemAndSetNull(pRenderHal->pSurfaceStateCache);
+
     eStatus = MOS_STATUS_SUCCESS;
 
 finish:
@@ -4458,7 +4464,8 @@ finish:
 //!
 //! \brief    Assign Ssh Instance
 //! \details  Get a pointer to the next available SSH Buffer Instance in SSH,
-//!           Reset SSH allocations
+//!           Reset SSH allocations. While jobs are pending in the command
+//!           buffer the allocations are kept and the job starts after them.
 //! \param    PRENDERHAL_INTERFACE pRenderHal
 //!           [in] Pointer to RenderHal Interface Structure
 //! \return   MOS_STATUS
@@ -4481,8 +4488,12 @@ MOS_STATUS RenderHal_AssignSshInstance(
     // Init SSH Params
     if (pStateHeap)
     {
-        pStateHeap->iCurrentBindingTable = 0;
-        pStateHeap->iCurrentSurfaceState = 0;
+        if (pRenderHal->BatchState.iJobs == 0)
+        {
+            pStateHeap->iCurrentBindingTable = 0;
+            pStateHeap->iCurrentSurfaceState = 0;
+        }
+        pRenderHal->BatchState.iFirstBindingTable = pStateHeap->iCurrentBindingTable;
     }
     else
     {
@@ -6161,7 +6172,8 @@ finish:
 
 //!
 //! \brief    Setup Surface State
-//! \details  Setup Surface States
+//! \details  Setup Surface States. Surfaces set up before with the same
+//!           params are copied from the surface state cache.
 //! \param    PRENDERHAL_INTERFACE pRenderHal
 //!           [in] Pointer to Hardware Interface Structure
 //! \param    PRENDERHAL_SURFACE pRenderHalSurface
@@ -6185,15 +6197,49 @@ MOS_STATUS RenderHal_SetupSurfaceState(
     PRENDERHAL_SURFACE_STATE_ENTRY  *ppSurfaceEntries,
     PRENDERHAL_OFFSET_OVERRIDE      pOffsetOverride)
 {
-    MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
-    
+    MOS_METRICS_SCOPE(MOS_METRIC_SURFACE_STATE_SETUP);
+
+    RENDERHAL_SURFACE_STATE_CACHE_KEY       Key;
+    PRENDERHAL_SURFACE_STATE_CACHE_ENTRY    pCacheEntry;
+    bool                                    bCacheable;
+    MOS_STATUS                              eStatus = MOS_STATUS_SUCCESS;
+
     //-----------------------------------------------
     MHW_RENDERHAL_CHK_NULL(pRenderHal);
     MHW_RENDERHAL_CHK_NULL(pRenderHal->pRenderHalPltInterface);
     //-----------------------------------------------
 
+    // Offset overrides change the surface in place, they are rare enough to always go the long way
+    bCacheable = pRenderHal->pSurfaceStateCache &&
+                 pRenderHalSurface              &&
+                 pParams                        &&
+                 piNumEntries                   &&
+                 ppSurfaceEntries               &&
+                 pOffsetOverride == nullptr;
+
+    if (bCacheable)
+    {
+        RenderHal_GetSurfaceStateCacheKey(pRenderHalSurface, pParams, &Key);
+
+        pCacheEntry = RenderHal_FindSurfaceStateCacheEntry(pRenderHal->pSurfaceStateCache, &Key);
+        if (pCacheEntry)
+        {
+            MHW_RENDERHAL_CHK_STATUS(RenderHal_CopySurfaceStateCacheEntry(
+                pRenderHal, pCacheEntry, pRenderHalSurface, pParams, piNumEntries, ppSurfaceEntries));
+            MOS_METRICS_COUNT(MOS_METRIC_SURFACE_STATE_CACHE_HIT);
+            goto finish;
+        }
+    }
+
     MHW_RENDERHAL_CHK_STATUS(pRenderHal->pRenderHalPltInterface->SetupSurfaceState(
         pRenderHal, pRenderHalSurface, pParams, piNumEntries, ppSurfaceEntries, pOffsetOverride));
+
+    if (bCacheable)
+    {
+        RenderHal_AddSurfaceStateCacheEntry(
+            pRenderHal, &Key, pRenderHalSurface, pParams, *piNumEntries, ppSurfaceEntries);
+    }
+
 finish:
     return eStatus;
 }
@@ -6580,6 +6626,7 @@ MOS_STATUS RenderHal_InitInterface(
     PMOS_USER_FEATURE_INTERFACE     pUserFeatureInterface = nullptr;
     MOS_USER_FEATURE                UserFeature;
     MOS_USER_FEATURE_VALUE          UserFeatureValue;
+    MOS_USER_FEATURE_VALUE_DATA     UserFeatureData;
     MOS_STATUS                      eStatus = MOS_STATUS_SUCCESS;
     MHW_VFE_PARAMS                  *pVfeStateParams = nullptr;
 
@@ -6674,6 +6721,19 @@ MOS_STATUS RenderHal_InitInterface(
 #endif
     pRenderHal->MediaWalkerMode = (MHW_WALKER_MODE)UserFeature.pValues[0].u32Data;
 
+    // Surface state cache, opt-in, unless surface states of this platform do not fit
+    MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_RENDERHAL_SURFACE_STATE_CACHE_ENABLE_ID,
+        &UserFeatureData);
+    if (UserFeatureData.bData &&
+        pRenderHal->pHwSizes->dwSizeSurfaceState <= RENDERHAL_SURFACE_STATE_CACHE_MAX_SIZE)
+    {
+        pRenderHal->pSurfaceStateCache = (PRENDERHAL_SURFACE_STATE_CACHE)MOS_AllocAndZeroMemory(
+            sizeof(RENDERHAL_SURFACE_STATE_CACHE));
+    }
+
     pRenderHal->pPlaneDefinitions             = g_cRenderHal_SurfacePlanes;
 
     // disable RenderHal kernel debugging.
@@ -116,6 +116,13 @@ class XRenderHal_Platform_Interface;
 #define RENDERHAL_SSH_SURFACES_PER_BT_MIN  4
 #define RENDERHAL_SSH_SURFACES_PER_BT_MAX  256
 
+//!
+//! \brief  Surface state cache - sets of ways, and max size of a cached surface state
+//!
+#define RENDERHAL_SURFACE_STATE_CACHE_SETS      16
+#define RENDERHAL_SURFACE_STATE_CACHE_WAYS      4
+#define RENDERHAL_SURFACE_STATE_CACHE_MAX_SIZE  64
+
 //!
 //! \brief  Default size of area for sync, debugging, performance collecting
 //!
@@ -1054,6 +1061,44 @@ typedef struct _RENDERHAL_SURFACE_STATE_ENTRY
     uint16_t                        wVYOffset;                                      //
 } RENDERHAL_SURFACE_STATE_ENTRY, *PRENDERHAL_SURFACE_STATE_ENTRY;
 
+//!
+//! Structure RENDERHAL_SURFACE_STATE_CACHE_KEY
+//! \brief Inputs of a surface state setup
+//! \details The surface is copied with OsResource cleared, only the GMM resource
+//!          descriptor stands for the resource. Surface states do not hold the
+//!          resource address, it is patched from the surface token on submit,
+//!          so a re-allocated resource only hits if it has the same layout.
+//!
+typedef struct _RENDERHAL_SURFACE_STATE_CACHE_KEY
+{
+    GMM_RESOURCE_INFO               *pGmmResInfo;                                   // Resource identity
+    RENDERHAL_SURFACE               Surface;                                        // Surface, OsResource cleared
+    RENDERHAL_SURFACE_STATE_PARAMS  Params;                                         // Surface state params (incl. MOCS)
+} RENDERHAL_SURFACE_STATE_CACHE_KEY, *PRENDERHAL_SURFACE_STATE_CACHE_KEY;
+
+//!
+//! Structure RENDERHAL_SURFACE_STATE_CACHE_ENTRY
+//! \brief Surface state entries and encoded surface states of one setup
+//!
+typedef struct _RENDERHAL_SURFACE_STATE_CACHE_ENTRY
+{
+    bool                                bValid;
+    int32_t                             iNumEntries;                                // Number of planes
+    RENDERHAL_SURFACE_STATE_CACHE_KEY   Key;
+    RENDERHAL_SURFACE_STATE_ENTRY       SurfaceEntry[MHW_MAX_SURFACE_PLANES];
+    uint8_t                             SurfaceState[MHW_MAX_SURFACE_PLANES][RENDERHAL_SURFACE_STATE_CACHE_MAX_SIZE];
+} RENDERHAL_SURFACE_STATE_CACHE_ENTRY, *PRENDERHAL_SURFACE_STATE_CACHE_ENTRY;
+
+//!
+//! Structure RENDERHAL_SURFACE_STATE_CACHE
+//! \brief Set associative cache of surface state setups, set chosen by resource
+//!
+typedef struct _RENDERHAL_SURFACE_STATE_CACHE
+{
+    RENDERHAL_SURFACE_STATE_CACHE_ENTRY Entry[RENDERHAL_SURFACE_STATE_CACHE_SETS][RENDERHAL_SURFACE_STATE_CACHE_WAYS];
+    uint32_t                            dwNextWay[RENDERHAL_SURFACE_STATE_CACHE_SETS];  // Round robin replacement
+} RENDERHAL_SURFACE_STATE_CACHE, *PRENDERHAL_SURFACE_STATE_CACHE;
+
 //!
 // \brief   Helper parameters used by Mhw_SendGenericPrologCmd and to initiate command buffer attributes
 //!
@@ -1114,6 +1159,24 @@ typedef struct _RENDERHAL_SETMARKER_SETTINGS
     uint32_t                setMarkerNumTs;           // Number Timestamp for SetMarker
 } RENDERHAL_SETMARKER_SETTINGS;
 
+//!
+//! \brief   State of jobs accumulated in one command buffer
+//! \details Jobs other than the last one of a batch leave the command buffer
+//!          unsubmitted; their binding tables and surface states are kept so
+//!          that the next job appends to the same SSH instance.
+//!
+typedef struct _RENDERHAL_BATCH_STATE
+{
+    int32_t                 iMaxJobs;                 // Jobs per command buffer, 0 or 1 to disable batching
+    int32_t                 iJobs;                    // Jobs in the pending command buffer
+    int32_t                 iFirstBindingTable;       // First BT of the current job
+    int32_t                 iRemaining;               // Command buffer space before the first job
+    bool                    bSecondLevelBB;           // A job started a 2nd level batch buffer
+    uint32_t                dwFirstStatusTag;         // GPU status tag written by the first job
+    MOS_GPU_CONTEXT         GpuContext;               // GPU context of the pending command buffer
+    double                  dStartTime;               // Monotonic time the first job was added (us)
+} RENDERHAL_BATCH_STATE, *PRENDERHAL_BATCH_STATE;
+
 typedef MhwMiInterface *PMHW_MI_INTERFACE;
 //!
 // \brief   Hardware dependent render engine interface
@@ -1239,11 +1302,16 @@ typedef struct _RENDERHAL_INTERFACE
     // SetMarker
     RENDERHAL_SETMARKER_SETTINGS SetMarkerParams;   //!< SetMarker
 
+    // Batching of jobs in one command buffer
+    RENDERHAL_BATCH_STATE        BatchState;        //!< Batch state
+
     // Indicates whether it's AVS or not
     bool                        bIsAVS;
 
     MediaPerfProfiler               *pPerfProfiler = nullptr;  //!< Performance data profiler
 
+    PRENDERHAL_SURFACE_STATE_CACHE  pSurfaceStateCache = nullptr;  //!< Surface states of previous setups, nullptr if disabled
+
     //---------------------------
     // HW interface functions
     //---------------------------
@@ -0,0 +1,234 @@
+/*
+* Copyright (c) 2015-2017, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      renderhal_surface_state_cache.cpp
+//! \brief     Cache of RenderHal surface state setups
+//!
+
+#include "renderhal_surface_state_cache.h"
+
+//!
+//! \brief    Get surface state cache key
+//! \details  Builds the key of a surface state setup from the surface and params
+//! \param    PRENDERHAL_SURFACE pRenderHalSurface
+//!           [in] Pointer to Render Hal Surface
+//! \param    PRENDERHAL_SURFACE_STATE_PARAMS pParams
+//!           [in] Pointer to Surface State Params
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_KEY pKey
+//!           [out] Pointer to key
+//! \return   void
+//!
+void RenderHal_GetSurfaceStateCacheKey(
+    PRENDERHAL_SURFACE                  pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS     pParams,
+    PRENDERHAL_SURFACE_STATE_CACHE_KEY  pKey)
+{
+    // Zero first so that padding compares equal
+    MOS_ZeroMemory(pKey, sizeof(*pKey));
+
+    pKey->pGmmResInfo = pRenderHalSurface->OsSurface.OsResource.pGmmResInfo;
+    MOS_SecureMemcpy(&pKey->Surface, sizeof(pKey->Surface), pRenderHalSurface, sizeof(*pRenderHalSurface));
+    MOS_SecureMemcpy(&pKey->Params, sizeof(pKey->Params), pParams, sizeof(*pParams));
+
+    // Allocation indexes, mapping and sync state of the resource change from frame to frame
+    MOS_ZeroMemory(&pKey->Surface.OsSurface.OsResource, sizeof(pKey->Surface.OsSurface.OsResource));
+}
+
+//!
+//! \brief    Get surface state cache set
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_KEY pKey
+//!           [in] Pointer to key
+//! \return   uint32_t
+//!           Set index
+//!
+static inline uint32_t RenderHal_GetSurfaceStateCacheSet(
+    PRENDERHAL_SURFACE_STATE_CACHE_KEY  pKey)
+{
+    // GMM descriptors are heap allocated, drop the alignment bits
+    uint64_t uiIdentity = (uint64_t)(uintptr_t)pKey->pGmmResInfo >> 4;
+    return (uint32_t)((uiIdentity ^ (uiIdentity >> 8)) % RENDERHAL_SURFACE_STATE_CACHE_SETS);
+}
+
+//!
+//! \brief    Find surface state cache entry
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE pCache
+//!           [in] Pointer to surface state cache
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_KEY pKey
+//!           [in] Pointer to key
+//! \return   PRENDERHAL_SURFACE_STATE_CACHE_ENTRY
+//!           Entry with the same key, nullptr if none
+//!
+PRENDERHAL_SURFACE_STATE_CACHE_ENTRY RenderHal_FindSurfaceStateCacheEntry(
+    PRENDERHAL_SURFACE_STATE_CACHE      pCache,
+    PRENDERHAL_SURFACE_STATE_CACHE_KEY  pKey)
+{
+    PRENDERHAL_SURFACE_STATE_CACHE_ENTRY pSet = pCache->Entry[RenderHal_GetSurfaceStateCacheSet(pKey)];
+
+    for (int32_t i = 0; i < RENDERHAL_SURFACE_STATE_CACHE_WAYS; i++)
+    {
+        if (pSet[i].bValid && memcmp(&pSet[i].Key, pKey, sizeof(*pKey)) == 0)
+        {
+            return &pSet[i];
+        }
+    }
+
+    return nullptr;
+}
+
+//!
+//! \brief    Add surface state cache entry
+//! \details  Saves the surface state entries and surface states just set up.
+//!           Setups that changed the surface (e.g. the YUY2 VME workaround)
+//!           are not saved since a copy would not repeat the change.
+//! \param    PRENDERHAL_INTERFACE pRenderHal
+//!           [in] Pointer to RenderHal Interface
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_KEY pKey
+//!           [in] Key built before the setup
+//! \param    PRENDERHAL_SURFACE pRenderHalSurface
+//!           [in] Pointer to Render Hal Surface
+//! \param    PRENDERHAL_SURFACE_STATE_PARAMS pParams
+//!           [in] Pointer to Surface State Params
+//! \param    int32_t iNumEntries
+//!           [in] Number of Surface State Entries
+//! \param    PRENDERHAL_SURFACE_STATE_ENTRY * ppSurfaceEntries
+//!           [in] Array of Surface State Entries
+//! \return   void
+//!
+void RenderHal_AddSurfaceStateCacheEntry(
+    PRENDERHAL_INTERFACE                pRenderHal,
+    PRENDERHAL_SURFACE_STATE_CACHE_KEY  pKey,
+    PRENDERHAL_SURFACE                  pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS     pParams,
+    int32_t                             iNumEntries,
+    PRENDERHAL_SURFACE_STATE_ENTRY      *ppSurfaceEntries)
+{
+    PRENDERHAL_SURFACE_STATE_CACHE          pCache;
+    PRENDERHAL_SURFACE_STATE_CACHE_ENTRY    pCacheEntry;
+    RENDERHAL_SURFACE_STATE_CACHE_KEY       KeyAfter;
+    uint32_t                                dwSet;
+    uint32_t                                dwSize;
+
+    pCache = pRenderHal->pSurfaceStateCache;
+    dwSize = pRenderHal->pHwSizes->dwSizeSurfaceState;
+
+    if (iNumEntries <= 0 || iNumEntries > MHW_MAX_SURFACE_PLANES)
+    {
+        return;
+    }
+
+    RenderHal_GetSurfaceStateCacheKey(pRenderHalSurface, pParams, &KeyAfter);
+    if (memcmp(&KeyAfter, pKey, sizeof(KeyAfter)) != 0)
+    {
+        return;
+    }
+
+    dwSet       = RenderHal_GetSurfaceStateCacheSet(pKey);
+    pCacheEntry = &pCache->Entry[dwSet][pCache->dwNextWay[dwSet]];
+    pCache->dwNextWay[dwSet] = (pCache->dwNextWay[dwSet] + 1) % RENDERHAL_SURFACE_STATE_CACHE_WAYS;
+
+    pCacheEntry->bValid      = true;
+    pCacheEntry->iNumEntries = iNumEntries;
+    pCacheEntry->Key         = *pKey;
+
+    for (int32_t i = 0; i < iNumEntries; i++)
+    {
+        pCacheEntry->SurfaceEntry[i] = *ppSurfaceEntries[i];
+        MOS_SecureMemcpy(pCacheEntry->SurfaceState[i],
+            sizeof(pCacheEntry->SurfaceState[i]),
+            ppSurfaceEntries[i]->pSurfaceState,
+            dwSize);
+    }
+}
+
+//!
+//! \brief    Copy surface state cache entry
+//! \details  Assigns new surface state entries and fills them and their
+//!           surface states from a cache entry. The surface token holding the
+//!           resource address and allocation index is always set up again.
+//! \param    PRENDERHAL_INTERFACE pRenderHal
+//!           [in] Pointer to RenderHal Interface
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_ENTRY pCacheEntry
+//!           [in] Pointer to cache entry
+//! \param    PRENDERHAL_SURFACE pRenderHalSurface
+//!           [in] Pointer to Render Hal Surface
+//! \param    PRENDERHAL_SURFACE_STATE_PARAMS pParams
+//!           [in] Pointer to Surface State Params
+//! \param    int32_t *piNumEntries
+//!           [out] Pointer to Number of Surface State Entries (Num Planes)
+//! \param    PRENDERHAL_SURFACE_STATE_ENTRY * ppSurfaceEntries
+//!           [out] Array of Surface State Entries
+//! \return   MOS_STATUS
+//!
+MOS_STATUS RenderHal_CopySurfaceStateCacheEntry(
+    PRENDERHAL_INTERFACE                    pRenderHal,
+    PRENDERHAL_SURFACE_STATE_CACHE_ENTRY    pCacheEntry,
+    PRENDERHAL_SURFACE                      pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS         pParams,
+    int32_t                                 *piNumEntries,
+    PRENDERHAL_SURFACE_STATE_ENTRY          *ppSurfaceEntries)
+{
+    PRENDERHAL_SURFACE_STATE_ENTRY  pSurfaceEntry;
+    uint8_t                         *pSurfaceState;
+    int32_t                         iSurfStateID;
+    uint32_t                        dwSize;
+    MOS_STATUS                      eStatus = MOS_STATUS_SUCCESS;
+
+    //-----------------------------------------------
+    MHW_RENDERHAL_CHK_NULL(pRenderHal->pStateHeap);
+    MHW_RENDERHAL_CHK_NULL(pRenderHal->pHwSizes);
+    //-----------------------------------------------
+
+    dwSize = pRenderHal->pHwSizes->dwSizeSurfaceState;
+
+    // Side effect of pfnGetSurfaceStateEntries
+    pRenderHal->bIsAVS = pParams->bAVS;
+
+    for (int32_t i = 0; i < pCacheEntry->iNumEntries; i++)
+    {
+        MHW_RENDERHAL_CHK_STATUS(pRenderHal->pfnAssignSurfaceState(
+            pRenderHal,
+            pCacheEntry->SurfaceEntry[i].Type,
+            &pSurfaceEntry));
+
+        iSurfStateID  = pSurfaceEntry->iSurfStateID;
+        pSurfaceState = pSurfaceEntry->pSurfaceState;
+
+        *pSurfaceEntry                   = pCacheEntry->SurfaceEntry[i];
+        pSurfaceEntry->iSurfStateID      = iSurfStateID;
+        pSurfaceEntry->pSurfaceState     = pSurfaceState;
+        pSurfaceEntry->pSurface          = &pRenderHalSurface->OsSurface;
+        pSurfaceEntry->dwSurfStateOffset = pRenderHal->pStateHeap->iSurfaceStateOffset +
+                                           iSurfStateID * dwSize;
+
+        MOS_SecureMemcpy(pSurfaceState, dwSize, pCacheEntry->SurfaceState[i], dwSize);
+
+        MHW_RENDERHAL_CHK_STATUS(pRenderHal->pfnSetupSurfaceStateOs(
+            pRenderHal, pRenderHalSurface, pParams, pSurfaceEntry));
+
+        ppSurfaceEntries[i] = pSurfaceEntry;
+    }
+
+    *piNumEntries = pCacheEntry->iNumEntries;
+
+finish:
+    return eStatus;
+}
@@ -0,0 +1,122 @@
+/*
+* Copyright (c) 2015-2017, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      renderhal_surface_state_cache.h
+//! \brief     Cache of RenderHal surface state setups
+//! \details   VP composite and CM set up the same surfaces with the same params
+//!            frame after frame. RenderHal_SetupSurfaceState looks setups up
+//!            here first and copies the surface state entries and encoded
+//!            surface states of a hit into the SSH, only the surface token is
+//!            set up again. The cache is opt-in, see "RenderHal Surface State
+//!            Cache Enable". Only depends on the RenderHal structures and
+//!            callbacks so that the ULT can build it.
+//!
+
+#ifndef __RENDERHAL_SURFACE_STATE_CACHE_H__
+#define __RENDERHAL_SURFACE_STATE_CACHE_H__
+
+#include "renderhal.h"
+
+//!
+//! \brief    Get surface state cache key
+//! \details  Builds the key of a surface state setup from the surface and params
+//! \param    PRENDERHAL_SURFACE pRenderHalSurface
+//!           [in] Pointer to Render Hal Surface
+//! \param    PRENDERHAL_SURFACE_STATE_PARAMS pParams
+//!           [in] Pointer to Surface State Params
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_KEY pKey
+//!           [out] Pointer to key
+//! \return   void
+//!
+void RenderHal_GetSurfaceStateCacheKey(
+    PRENDERHAL_SURFACE                  pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS     pParams,
+    PRENDERHAL_SURFACE_STATE_CACHE_KEY  pKey);
+
+//!
+//! \brief    Find surface state cache entry
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE pCache
+//!           [in] Pointer to surface state cache
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_KEY pKey
+//!           [in] Pointer to key
+//! \return   PRENDERHAL_SURFACE_STATE_CACHE_ENTRY
+//!           Entry with the same key, nullptr if none
+//!
+PRENDERHAL_SURFACE_STATE_CACHE_ENTRY RenderHal_FindSurfaceStateCacheEntry(
+    PRENDERHAL_SURFACE_STATE_CACHE      pCache,
+    PRENDERHAL_SURFACE_STATE_CACHE_KEY  pKey);
+
+//!
+//! \brief    Add surface state cache entry
+//! \details  Saves the surface state entries and surface states just set up.
+//!           Setups that changed the surface (e.g. the YUY2 VME workaround)
+//!           are not saved since a copy would not repeat the change.
+//! \param    PRENDERHAL_INTERFACE pRenderHal
+//!           [in] Pointer to RenderHal Interface
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_KEY pKey
+//!           [in] Key built before the setup
+//! \param    PRENDERHAL_SURFACE pRenderHalSurface
+//!           [in] Pointer to Render Hal Surface
+//! \param    PRENDERHAL_SURFACE_STATE_PARAMS pParams
+//!           [in] Pointer to Surface State Params
+//! \param    int32_t iNumEntries
+//!           [in] Number of Surface State Entries
+//! \param    PRENDERHAL_SURFACE_STATE_ENTRY * ppSurfaceEntries
+//!           [in] Array of Surface State Entries
+//! \return   void
+//!
+void RenderHal_AddSurfaceStateCacheEntry(
+    PRENDERHAL_INTERFACE                pRenderHal,
+    PRENDERHAL_SURFACE_STATE_CACHE_KEY  pKey,
+    PRENDERHAL_SURFACE                  pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS     pParams,
+    int32_t                             iNumEntries,
+    PRENDERHAL_SURFACE_STATE_ENTRY      *ppSurfaceEntries);
+
+//!
+//! \brief    Copy surface state cache entry
+//! \details  Assigns new surface state entries and fills them and their
+//!           surface states from a cache entry. The surface token holding the
+//!           resource address and allocation index is always set up again.
+//! \param    PRENDERHAL_INTERFACE pRenderHal
+//!           [in] Pointer to RenderHal Interface
+//! \param    PRENDERHAL_SURFACE_STATE_CACHE_ENTRY pCacheEntry
+//!           [in] Pointer to cache entry
+//! \param    PRENDERHAL_SURFACE pRenderHalSurface
+//!           [in] Pointer to Render Hal Surface
+//! \param    PRENDERHAL_SURFACE_STATE_PARAMS pParams
+//!           [in] Pointer to Surface State Params
+//! \param    int32_t *piNumEntries
+//!           [out] Pointer to Number of Surface State Entries (Num Planes)
+//! \param    PRENDERHAL_SURFACE_STATE_ENTRY * ppSurfaceEntries
+//!           [out] Array of Surface State Entries
+//! \return   MOS_STATUS
+//!
+MOS_STATUS RenderHal_CopySurfaceStateCacheEntry(
+    PRENDERHAL_INTERFACE                    pRenderHal,
+    PRENDERHAL_SURFACE_STATE_CACHE_ENTRY    pCacheEntry,
+    PRENDERHAL_SURFACE                      pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS         pParams,
+    int32_t                                 *piNumEntries,
+    PRENDERHAL_SURFACE_STATE_ENTRY          *ppSurfaceEntries);
+
+#endif // __RENDERHAL_SURFACE_STATE_CACHE_H__
@@ -77,6 +77,7 @@ MOS_STATUS VphalState::Allocate(
     RENDERHAL_SETTINGS          RenderHalSettings;
     MOS_GPU_NODE                VeboxGpuNode;
     MOS_GPU_CONTEXT             VeboxGpuContext;
+    int32_t                     iRenderBatchSize;
     MOS_STATUS                  eStatus;
 
     VPHAL_PUBLIC_CHK_NULL(pVpHalSettings);
@@ -126,10 +127,33 @@ MOS_STATUS VphalState::Allocate(
             MOS_GPU_CONTEXT_VEBOX));
     }
 
+    // Size the SSH instance, the command buffer and its patch list for a batch
+    // of composite jobs, see VpHal_RndrSubmitCommands
+    iRenderBatchSize = MOS_MIN((int32_t)pVpHalSettings->renderBatchSize, VPHAL_RENDER_BATCH_JOBS_MAX);
+    if (iRenderBatchSize > 1 && GFX_IS_GEN_9_OR_LATER(m_platform))
+    {
+        m_renderHal->StateHeapSettings.iBindingTables = iRenderBatchSize * RENDERHAL_SSH_BINDING_TABLES;
+        m_renderHal->StateHeapSettings.iSurfaceStates = MOS_MIN(iRenderBatchSize * RENDERHAL_SSH_SURFACE_STATES,
+                                                                RENDERHAL_SSH_SURFACE_STATES_MAX);
+
+        VPHAL_PUBLIC_CHK_STATUS(m_osInterface->pfnResizeCommandBufferAndPatchList(
+            m_osInterface,
+            VPHAL_RENDER_BATCH_CMD_BUFFER_SIZE,
+            iRenderBatchSize * VPHAL_RENDER_BATCH_PATCH_LIST_SIZE,
+            0));
+    }
+    else
+    {
+        iRenderBatchSize = 1;
+    }
+
     // Allocate and initialize HW states
     RenderHalSettings.iMediaStates  = pVpHalSettings->mediaStates;
     VPHAL_PUBLIC_CHK_STATUS(m_renderHal->pfnInitialize(m_renderHal, &RenderHalSettings));
 
+    m_renderHal->BatchState.iMaxJobs = iRenderBatchSize;
+    m_renderBatchWindow              = pVpHalSettings->renderBatchWindow;
+
     if (m_veboxInterface &&
         m_veboxInterface->m_veboxSettings.uiNumInstances > 0 &&
         m_veboxInterface->m_veboxHeap == nullptr)
@@ -552,6 +576,9 @@ MOS_STATUS VphalState::Render(
 
     RenderParams    = *pcRenderParams;
 
+    // Jobs batched longer than the window are submitted before starting a new batch
+    VPHAL_PUBLIC_CHK_STATUS(FlushExpiredRenderBatch());
+
     if (VpHal_IsAvsSampleForMultiStreamsEnabled(pcRenderParams))
     {
         eStatus = VpHal_RenderWithAvsForMultiStreams(m_renderer, pcRenderParams);
@@ -562,10 +589,65 @@ MOS_STATUS VphalState::Render(
     RenderParams.bIsDefaultStream = true;
     eStatus = m_renderer->Render((PCVPHAL_RENDER_PARAMS)(&RenderParams));
 
+finish:
+    if (eStatus == MOS_STATUS_SUCCESS)
+    {
+        eStatus = FlushExpiredRenderBatch();
+    }
+    return eStatus;
+}
+
+//!
+//! \brief    Submit the batched render jobs
+//! \details  Submits the composite jobs left in the render command buffer
+//!           when render batching is enabled
+//! \return   MOS_STATUS
+//!           Return MOS_STATUS_SUCCESS if successful, otherwise failed
+//!
+MOS_STATUS VphalState::FlushRenderBatch()
+{
+    MOS_STATUS          eStatus = MOS_STATUS_SUCCESS;
+
+    if (IsRenderBatchPending())
+    {
+        VPHAL_PUBLIC_CHK_NULL(m_renderer);
+        VPHAL_PUBLIC_CHK_STATUS(VpHal_RndrCommonFlushBatch(m_renderHal, &m_renderer->StatusTable));
+    }
+
 finish:
     return eStatus;
 }
 
+//!
+//! \brief    Check if render jobs wait for submission
+//! \return   bool
+//!           true if the render command buffer holds batched jobs
+//!
+bool VphalState::IsRenderBatchPending()
+{
+    return m_renderHal && m_renderHal->BatchState.iJobs > 0;
+}
+
+//!
+//! \brief    Submit the batched render jobs if the first one waited too long
+//! \details  No timer runs behind the batch: the window is only checked when
+//!           Render is called, so the jobs of the last call before the
+//!           application goes idle wait until the next Render, a surface
+//!           sync or destruction flushes them.
+//! \return   MOS_STATUS
+//!           Return MOS_STATUS_SUCCESS if successful, otherwise failed
+//!
+MOS_STATUS VphalState::FlushExpiredRenderBatch()
+{
+    if (IsRenderBatchPending() &&
+        MOS_GetMonotonicTime() - m_renderHal->BatchState.dStartTime >= m_renderBatchWindow)
+    {
+        return FlushRenderBatch();
+    }
+
+    return MOS_STATUS_SUCCESS;
+}
+
 //!
 //! \brief    Get feature reporting from renderer
 //! \details  Get feature reporting from renderer
@@ -607,6 +689,7 @@ VphalState::VphalState(
         m_veboxInterface(nullptr),
         m_renderGpuNode(MOS_GPU_NODE_3D),
         m_renderGpuContext(MOS_GPU_CONTEXT_RENDER),
+        m_renderBatchWindow(0),
         m_gpuAppTaskEvent(nullptr)
 {
     MOS_STATUS                  eStatus;
@@ -641,6 +724,15 @@ VphalState::~VphalState()
 {
     MOS_STATUS              eStatus;
 
+    // The last submission point, for owners that did not flush before
+    // destroying (e.g. DdiVp_ConvertSurface); no other thread can reach the
+    // batch any more
+    eStatus = FlushRenderBatch();
+    if (eStatus != MOS_STATUS_SUCCESS)
+    {
+        VPHAL_PUBLIC_ASSERTMESSAGE("Failed to submit batched render jobs, eStatus:%d.\n", eStatus);
+    }
+
     // Destroy rendering objects (intermediate surfaces, BBs, etc)
     if (m_renderer)
     {
@@ -276,7 +276,9 @@ struct VphalSettings
         sameSampleThreshold(0),
         disableDnDi(0),
         kernelUpdate(0),
-        veboxParallelExecution(0)
+        veboxParallelExecution(0),
+        renderBatchSize(0),
+        renderBatchWindow(0)
     {
     };
 
@@ -286,6 +288,8 @@ struct VphalSettings
     uint32_t               disableDnDi;                                          //!< For validation purpose
     uint32_t               kernelUpdate;                                         //!< For VEBox Copy and Update kernels
     uint32_t               veboxParallelExecution;                               //!< Control VEBox parallel execution with render engine
+    uint32_t               renderBatchSize;                                      //!< Composite jobs per command buffer, 0 or 1 to submit each job
+    uint32_t               renderBatchWindow;                                    //!< Longest time a batched job waits for submission (us)
 };
 
 //!
@@ -438,6 +442,26 @@ public:
     MOS_STATUS GetStatusReportEntryLength(
         uint32_t                         *puiLength);
 
+    //!
+    //! \brief    Submit the batched render jobs
+    //! \details  Submits the composite jobs left in the render command buffer
+    //!           when render batching is enabled, see VphalSettings::renderBatchSize.
+    //!           Must be called before the CPU or another context accesses the
+    //!           surfaces of the jobs. GetStatusReport does not submit the batch,
+    //!           only the destructor does; callers on other threads than the one
+    //!           rendering hold the same lock as around Render.
+    //! \return   MOS_STATUS
+    //!           Return MOS_STATUS_SUCCESS if successful, otherwise failed
+    //!
+    MOS_STATUS FlushRenderBatch();
+
+    //!
+    //! \brief    Check if render jobs wait for submission
+    //! \return   bool
+    //!           true if the render command buffer holds batched jobs
+    //!
+    bool IsRenderBatchPending();
+
     MEDIA_FEATURE_TABLE*          GetSkuTable()
     {
         return m_skuTable;
@@ -483,6 +507,16 @@ protected:
     MOS_GPU_NODE                m_renderGpuNode;
     MOS_GPU_CONTEXT             m_renderGpuContext;
 
+    // Render batching
+    uint32_t                    m_renderBatchWindow;    //!< Longest time a batched job waits for submission (us)
+
+    //!
+    //! \brief    Submit the batched render jobs if the first one waited too long
+    //! \return   MOS_STATUS
+    //!           Return MOS_STATUS_SUCCESS if successful, otherwise failed
+    //!
+    MOS_STATUS FlushExpiredRenderBatch();
+
     //!
     //! \brief    Create instance of VphalRenderer
     //! \details  Create instance of VphalRenderer
@@ -618,9 +618,54 @@ finish:
     return eStatus;
 }
 
+//!
+//! \brief      Discard the jobs batched in the command buffer
+//! \details    Marks the status entries of the batch as failed and releases the
+//!             media states and batch buffers held by its jobs
+//! \param      [in] pRenderHal
+//!             Pointer to RenderHal Interface Structure
+//! \param      [in] pStatusTable
+//!             Pointer to the status table, may be nullptr
+//! \return     void
+//!
+static void VpHal_RndrCommonDiscardBatch(
+    PRENDERHAL_INTERFACE                pRenderHal,
+    PVPHAL_STATUS_TABLE                 pStatusTable)
+{
+    PRENDERHAL_BATCH_STATE              pBatchState;
+    PVPHAL_STATUS_ENTRY                 pStatusEntry;
+    uint32_t                            uiIndex;
+
+    pBatchState = &pRenderHal->BatchState;
+
+    VPHAL_RENDER_ASSERTMESSAGE("Discard %d batched render jobs.", pBatchState->iJobs);
+
+    if (pStatusTable)
+    {
+        for (uiIndex = pStatusTable->uiHead;
+             uiIndex != pStatusTable->uiCurrent;
+             uiIndex = (uiIndex + 1) & (VPHAL_STATUS_TABLE_MAX_SIZE - 1))
+        {
+            pStatusEntry = &pStatusTable->aTableEntries[uiIndex];
+            if (pStatusEntry->GpuContextOrdinal == pBatchState->GpuContext &&
+                (int32_t)(pStatusEntry->dwTag - pBatchState->dwFirstStatusTag) >= 0)
+            {
+                pStatusEntry->dwStatus = VPREP_ERROR;
+            }
+        }
+    }
+
+    // No submission carries the tag of the batch, skip it so that the
+    // media states of the batch are released by the next one
+    pRenderHal->pStateHeap->dwNextTag++;
+    pBatchState->iJobs = 0;
+}
+
 //!
 //! \brief      Submit commands for rendering
-//! \details    Submit commands for rendering with status table update enabling
+//! \details    Submit commands for rendering with status table update enabling.
+//!             When render batching is enabled the job is appended to the pending
+//!             command buffer and only the last job of the batch submits it.
 //! \param      [in] pRenderHal
 //!             Pointer to RenderHal Interface Structure
 //! \param      [in] pBatchBuffer
@@ -658,6 +703,8 @@ MOS_STATUS VpHal_RndrSubmitCommands(
     RENDERHAL_GENERIC_PROLOG_PARAMS     GenericPrologParams;
     MOS_RESOURCE                        GpuStatusBuffer;
     MediaPerfProfiler                   *pPerfProfiler;
+    PRENDERHAL_BATCH_STATE              pBatchState;
+    bool                                bSubmit;
 
     eStatus              = MOS_STATUS_UNKNOWN;
     pOsInterface         = pRenderHal->pOsInterface;
@@ -667,6 +714,11 @@ MOS_STATUS VpHal_RndrSubmitCommands(
     FlushParam           = g_cRenderHal_InitMediaStateFlushParams;
     MOS_ZeroMemory(&CmdBuffer, sizeof(CmdBuffer));
     pPerfProfiler       = pRenderHal->pPerfProfiler;
+    pBatchState         = &pRenderHal->BatchState;
+    bSubmit             = (pBatchState->iMaxJobs <= 1)                         ||
+                          (pBatchState->iJobs + 1 >= pBatchState->iMaxJobs)    ||
+                          bNullRendering                                       ||
+                          !GFX_IS_GEN_9_OR_LATER(pRenderHal->Platform);
 
     // Allocate all available space, unused buffer will be returned later
     VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnGetCommandBuffer(pOsInterface, &CmdBuffer, 0));
@@ -674,33 +726,46 @@ MOS_STATUS VpHal_RndrSubmitCommands(
     // Set initial state
     iRemaining = CmdBuffer.iRemaining;
 
+    if (pBatchState->iJobs == 0)
+    {
+        pBatchState->iRemaining       = iRemaining;
+        pBatchState->bSecondLevelBB   = false;
+        pBatchState->dwFirstStatusTag = pOsInterface->pfnGetGpuStatusTag(pOsInterface, pOsInterface->CurrentGpuContextOrdinal);
+        pBatchState->GpuContext       = pOsInterface->CurrentGpuContextOrdinal;
+        pBatchState->dStartTime       = MOS_GetMonotonicTime();
+    }
+
     VPHAL_RENDER_CHK_STATUS(VpHal_RndrCommonSetPowerMode(
         pRenderHal,
         KernelID));
 
     MOS_ZeroMemory(&GenericPrologParams, sizeof(GenericPrologParams));
 
-#ifndef EMUL
-    if (pOsInterface->bEnableKmdMediaFrameTracking)
+    // Jobs appended to a pending command buffer reuse its prolog and frame tracking
+    if (pBatchState->iJobs == 0)
     {
-        // Get GPU Status buffer
-        VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnGetGpuStatusBufferResource(pOsInterface, &GpuStatusBuffer));
+#ifndef EMUL
+        if (pOsInterface->bEnableKmdMediaFrameTracking)
+        {
+            // Get GPU Status buffer
+            VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnGetGpuStatusBufferResource(pOsInterface, &GpuStatusBuffer));
 
-        // Register the buffer
-        VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnRegisterResource(pOsInterface, &GpuStatusBuffer, true, true));
+            // Register the buffer
+            VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnRegisterResource(pOsInterface, &GpuStatusBuffer, true, true));
 
-        GenericPrologParams.bEnableMediaFrameTracking = true;
-        GenericPrologParams.presMediaFrameTrackingSurface = &GpuStatusBuffer;
-        GenericPrologParams.dwMediaFrameTrackingTag = pOsInterface->pfnGetGpuStatusTag(pOsInterface, pOsInterface->CurrentGpuContextOrdinal);
-        GenericPrologParams.dwMediaFrameTrackingAddrOffset = pOsInterface->pfnGetGpuStatusTagOffset(pOsInterface, pOsInterface->CurrentGpuContextOrdinal);
+            GenericPrologParams.bEnableMediaFrameTracking = true;
+            GenericPrologParams.presMediaFrameTrackingSurface = &GpuStatusBuffer;
+            GenericPrologParams.dwMediaFrameTrackingTag = pOsInterface->pfnGetGpuStatusTag(pOsInterface, pOsInterface->CurrentGpuContextOrdinal);
+            GenericPrologParams.dwMediaFrameTrackingAddrOffset = pOsInterface->pfnGetGpuStatusTagOffset(pOsInterface, pOsInterface->CurrentGpuContextOrdinal);
 
-        // Increment GPU Status Tag
-        pOsInterface->pfnIncrementGpuStatusTag(pOsInterface, pOsInterface->CurrentGpuContextOrdinal);
-    }
+            // Increment GPU Status Tag
+            pOsInterface->pfnIncrementGpuStatusTag(pOsInterface, pOsInterface->CurrentGpuContextOrdinal);
+        }
 #endif
 
-    // Initialize command buffer and insert prolog
-    VPHAL_RENDER_CHK_STATUS(pRenderHal->pfnInitCommandBuffer(pRenderHal, &CmdBuffer, &GenericPrologParams));
+        // Initialize command buffer and insert prolog
+        VPHAL_RENDER_CHK_STATUS(pRenderHal->pfnInitCommandBuffer(pRenderHal, &CmdBuffer, &GenericPrologParams));
+    }
 
     VPHAL_RENDER_CHK_STATUS(pPerfProfiler->AddPerfCollectStartCmd((void*)pRenderHal, pOsInterface, pMhwMiInterface, &CmdBuffer));
 
@@ -741,6 +806,8 @@ MOS_STATUS VpHal_RndrSubmitCommands(
         VPHAL_RENDER_CHK_STATUS(pMhwMiInterface->AddMiBatchBufferStartCmd(
             &CmdBuffer,
             pBatchBuffer));
+
+        pBatchState->bSecondLevelBB = true;
     }
 
     // Write back GPU Status tag
@@ -797,7 +864,25 @@ MOS_STATUS VpHal_RndrSubmitCommands(
         }
     }
 
-    if (pBatchBuffer)
+    if (!bSubmit)
+    {
+        // Leave the job in the command buffer, the last job of the batch submits it.
+        // Its media state and batch buffer are released with the tag of the batch.
+        pOsInterface->pfnReturnCommandBuffer(pOsInterface, &CmdBuffer, 0);
+
+        pRenderHal->pStateHeap->pCurMediaState->bBusy = true;
+        if (pBatchBuffer)
+        {
+            pBatchBuffer->bBusy     = true;
+            pBatchBuffer->dwSyncTag = pRenderHal->pStateHeap->dwNextTag;
+        }
+
+        pBatchState->iJobs++;
+        eStatus = MOS_STATUS_SUCCESS;
+        goto finish;
+    }
+
+    if (pBatchState->bSecondLevelBB)
     {
         // Send Batch Buffer end command (HW/OS dependent)
         VPHAL_RENDER_CHK_STATUS(pMhwMiInterface->AddMiBatchBufferEnd(&CmdBuffer, nullptr));
@@ -844,6 +929,7 @@ MOS_STATUS VpHal_RndrSubmitCommands(
         }
     }
 
+    pBatchState->iJobs = 0;
     eStatus = MOS_STATUS_SUCCESS;
 
 finish:
@@ -862,6 +948,16 @@ finish:
             VPHAL_RENDER_ASSERTMESSAGE("Command Buffer overflow by %d bytes", -CmdBuffer.iRemaining);
         }
 
+        // A failed submission takes the jobs batched before it along
+        if (bSubmit && pBatchState->iJobs > 0)
+        {
+            VpHal_RndrCommonDiscardBatch(pRenderHal, pStatusTableUpdateParams ? pStatusTableUpdateParams->pStatusTable : nullptr);
+            if (CmdBuffer.pCmdBase)
+            {
+                iRemaining = pBatchState->iRemaining;
+            }
+        }
+
         // Move command buffer back to beginning
         i = iRemaining - CmdBuffer.iRemaining;
         CmdBuffer.iRemaining  = iRemaining;
@@ -876,6 +972,169 @@ finish:
     return eStatus;
 }
 
+//!
+//! \brief      Submit the render jobs batched in the command buffer
+//! \details    Closes and submits the command buffer left pending by
+//!             VpHal_RndrSubmitCommands. Does nothing if no job is pending.
+//! \param      [in] pRenderHal
+//!             Pointer to RenderHal Interface Structure
+//! \param      [in] pStatusTable
+//!             Pointer to the status table holding the entries of the batch,
+//!             may be nullptr
+//! \return     MOS_STATUS
+//!
+MOS_STATUS VpHal_RndrCommonFlushBatch(
+    PRENDERHAL_INTERFACE                pRenderHal,
+    PVPHAL_STATUS_TABLE                 pStatusTable)
+{
+    PMOS_INTERFACE                      pOsInterface;
+    PMHW_MI_INTERFACE                   pMhwMiInterface;
+    PRENDERHAL_BATCH_STATE              pBatchState;
+    MOS_COMMAND_BUFFER                  CmdBuffer;
+    MOS_GPU_CONTEXT                     eGpuContext;
+    MOS_STATUS                          eStatus;
+
+    pOsInterface    = nullptr;
+    pBatchState     = nullptr;
+    MOS_ZeroMemory(&CmdBuffer, sizeof(CmdBuffer));
+
+    VPHAL_RENDER_CHK_NULL(pRenderHal);
+    VPHAL_RENDER_CHK_NULL(pRenderHal->pOsInterface);
+    VPHAL_RENDER_CHK_NULL(pRenderHal->pMhwMiInterface);
+
+    eStatus         = MOS_STATUS_SUCCESS;
+    pOsInterface    = pRenderHal->pOsInterface;
+    pMhwMiInterface = pRenderHal->pMhwMiInterface;
+    pBatchState     = &pRenderHal->BatchState;
+    eGpuContext     = pOsInterface->CurrentGpuContextOrdinal;
+
+    if (pBatchState->iJobs == 0)
+    {
+        goto finish;
+    }
+
+    if (eGpuContext != pBatchState->GpuContext)
+    {
+        VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnSetGpuContext(pOsInterface, pBatchState->GpuContext));
+    }
+
+    VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnGetCommandBuffer(pOsInterface, &CmdBuffer, 0));
+
+    if (pBatchState->bSecondLevelBB)
+    {
+        // Send Batch Buffer end command (HW/OS dependent)
+        VPHAL_RENDER_CHK_STATUS(pMhwMiInterface->AddMiBatchBufferEnd(&CmdBuffer, nullptr));
+    }
+    else if (VpHal_RndrCommonIsMiBBEndNeeded(pOsInterface))
+    {
+        // Send Batch Buffer end command for 1st level Batch Buffer
+        VPHAL_RENDER_CHK_STATUS(pMhwMiInterface->AddMiBatchBufferEnd(&CmdBuffer, nullptr));
+    }
+    else if (GFX_IS_GEN_8_OR_LATER(pRenderHal->Platform) &&
+                Mos_Solo_IsInUse(pOsInterface)  &&
+                pRenderHal->pOsInterface->bNoParsingAssistanceInKmd)
+    {
+        VPHAL_RENDER_CHK_STATUS(pMhwMiInterface->AddMiBatchBufferEnd(&CmdBuffer, nullptr));
+    }
+
+    // Return unused command buffer space to OS
+    pOsInterface->pfnReturnCommandBuffer(pOsInterface, &CmdBuffer, 0);
+
+    VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnSubmitCommandBuffer(pOsInterface, &CmdBuffer, false));
+
+    pRenderHal->pStateHeap->dwNextTag++;
+    pBatchState->iJobs = 0;
+
+finish:
+    if (pBatchState && pBatchState->iJobs > 0)
+    {
+        VpHal_RndrCommonDiscardBatch(pRenderHal, pStatusTable);
+
+        // Move command buffer back to the beginning of the batch
+        if (CmdBuffer.pCmdBase)
+        {
+            CmdBuffer.iOffset    -= pBatchState->iRemaining - CmdBuffer.iRemaining;
+            CmdBuffer.iRemaining  = pBatchState->iRemaining;
+            CmdBuffer.pCmdPtr     =
+                CmdBuffer.pCmdBase + CmdBuffer.iOffset / sizeof(uint32_t);
+            pOsInterface->pfnReturnCommandBuffer(pOsInterface, &CmdBuffer, 0);
+        }
+    }
+
+    if (pOsInterface && eGpuContext != pOsInterface->CurrentGpuContextOrdinal)
+    {
+        pOsInterface->pfnSetGpuContext(pOsInterface, eGpuContext);
+    }
+
+    return eStatus;
+}
+
+//!
+//! \brief      Reset states before a render job
+//! \details    Replaces the pfnResetOsStates/pfnReset pair of the renderers that
+//!             submit through VpHal_RndrSubmitCommands. The OS states are only
+//!             reset when the command buffer holds no pending job, and the pending
+//!             jobs are submitted first when the next one may not fit in the
+//!             command buffer, the SSH instance or the media states.
+//! \param      [in] pRenderHal
+//!             Pointer to RenderHal Interface Structure
+//! \param      [in] pStatusTable
+//!             Pointer to the status table, may be nullptr
+//! \return     MOS_STATUS
+//!
+MOS_STATUS VpHal_RndrCommonResetStates(
+    PRENDERHAL_INTERFACE                pRenderHal,
+    PVPHAL_STATUS_TABLE                 pStatusTable)
+{
+    PMOS_INTERFACE                      pOsInterface;
+    PRENDERHAL_STATE_HEAP               pStateHeap;
+    PRENDERHAL_BATCH_STATE              pBatchState;
+    MOS_COMMAND_BUFFER                  CmdBuffer;
+    bool                                bFlush;
+    MOS_STATUS                          eStatus;
+
+    VPHAL_RENDER_CHK_NULL(pRenderHal);
+    VPHAL_RENDER_CHK_NULL(pRenderHal->pOsInterface);
+    VPHAL_RENDER_CHK_NULL(pRenderHal->pStateHeap);
+
+    eStatus      = MOS_STATUS_SUCCESS;
+    pOsInterface = pRenderHal->pOsInterface;
+    pStateHeap   = pRenderHal->pStateHeap;
+    pBatchState  = &pRenderHal->BatchState;
+
+    if (pBatchState->iJobs > 0)
+    {
+        bFlush = (pStateHeap->iCurrentBindingTable >= pRenderHal->StateHeapSettings.iBindingTables)                           ||
+                 (pStateHeap->iCurrentSurfaceState + RENDERHAL_SSH_SURFACE_STATES > pRenderHal->StateHeapSettings.iSurfaceStates) ||
+                 (pBatchState->iJobs >= pRenderHal->StateHeapSettings.iMediaStateHeaps - 1)                                   ||
+                 (pOsInterface->CurrentGpuContextOrdinal != pBatchState->GpuContext);
+
+        if (!bFlush)
+        {
+            MOS_ZeroMemory(&CmdBuffer, sizeof(CmdBuffer));
+            VPHAL_RENDER_CHK_STATUS(pOsInterface->pfnGetCommandBuffer(pOsInterface, &CmdBuffer, 0));
+            bFlush = (CmdBuffer.iRemaining - (int32_t)pRenderHal->dwIndirectHeapSize < VPHAL_RENDER_BATCH_JOB_CMD_SIZE);
+            pOsInterface->pfnReturnCommandBuffer(pOsInterface, &CmdBuffer, 0);
+        }
+
+        if (bFlush)
+        {
+            VPHAL_RENDER_CHK_STATUS(VpHal_RndrCommonFlushBatch(pRenderHal, pStatusTable));
+        }
+    }
+
+    // Reset states before rendering (clear allocations, get GSH allocation index
+    //                                + any additional housekeeping)
+    if (pBatchState->iJobs == 0)
+    {
+        pOsInterface->pfnResetOsStates(pOsInterface);
+    }
+    VPHAL_RENDER_CHK_STATUS(pRenderHal->pfnReset(pRenderHal));
+
+finish:
+    return eStatus;
+}
+
 //!
 //! \brief    Initialized RenderHal Surface according to incoming VPHAL Surface
 //! \param    [in] pVpSurface
@@ -42,6 +42,16 @@
 //!
 #define VPHAL_USE_MEDIA_THREADS_MAX         0
 
+//!
+//! \brief  Render batching limits
+//! \details Jobs of a batch share the command buffer, its patch and allocation
+//!          lists and one SSH instance, which bounds the batch size.
+//!
+#define VPHAL_RENDER_BATCH_JOBS_MAX             4
+#define VPHAL_RENDER_BATCH_PATCH_LIST_SIZE      128             // Patch locations per job
+#define VPHAL_RENDER_BATCH_CMD_BUFFER_SIZE      (64 * 1024)     // Command buffer size with batching
+#define VPHAL_RENDER_BATCH_JOB_CMD_SIZE         (8 * 1024)      // Command space reserved for a job
+
 //!
 //! \brief  Similar definition from MHAL
 //!
@@ -2571,7 +2581,9 @@ MOS_STATUS VpHal_RndrCommonSubmitCommands(
 
 //!
 //! \brief      Submit commands for rendering
-//! \details    Submit commands for rendering with status table update enabling
+//! \details    Submit commands for rendering with status table update enabling.
+//!             When render batching is enabled the job is appended to the pending
+//!             command buffer and only the last job of the batch submits it.
 //! \param      [in] pRenderHal
 //!             Pointer to RenderHal Interface Structure
 //! \param      [in] pBatchBuffer
@@ -2597,6 +2609,35 @@ MOS_STATUS VpHal_RndrSubmitCommands(
     PSTATUS_TABLE_UPDATE_PARAMS            pStatusTableUpdateParams,
     VpKernelID                          KernelID);
 
+//!
+//! \brief      Submit the render jobs batched in the command buffer
+//! \details    Closes and submits the command buffer left pending by
+//!             VpHal_RndrSubmitCommands. Does nothing if no job is pending.
+//! \param      [in] pRenderHal
+//!             Pointer to RenderHal Interface Structure
+//! \param      [in] pStatusTable
+//!             Pointer to the status table holding the entries of the batch,
+//!             may be nullptr
+//! \return     MOS_STATUS
+//!
+MOS_STATUS VpHal_RndrCommonFlushBatch(
+    PRENDERHAL_INTERFACE                pRenderHal,
+    PVPHAL_STATUS_TABLE                 pStatusTable);
+
+//!
+//! \brief      Reset states before a render job
+//! \details    Resets the OS states unless jobs are pending in the command
+//!             buffer, submitting them first when the next job may not fit.
+//! \param      [in] pRenderHal
+//!             Pointer to RenderHal Interface Structure
+//! \param      [in] pStatusTable
+//!             Pointer to the status table, may be nullptr
+//! \return     MOS_STATUS
+//!
+MOS_STATUS VpHal_RndrCommonResetStates(
+    PRENDERHAL_INTERFACE                pRenderHal,
+    PVPHAL_STATUS_TABLE                 pStatusTable);
+
 //!
 //! \brief      Is Alignment WA needed
 //! \details    Decide WA is needed for VEBOX/Render engine
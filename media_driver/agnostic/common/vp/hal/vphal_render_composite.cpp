@@ -1402,181 +1402,373 @@ bool CompositeState::PreparePhases(
     PVPHAL_SURFACE              *ppSources,
     int32_t                     iSources)
 {
-    PMOS_INTERFACE          pOsInterface;
+    bool bMultiplePhases;
+
+    bMultiplePhases = DecidePhases(pcRenderParams, ppSources, iSources);
+    if (bMultiplePhases)
+    {
+        AllocatePhaseSurfaces(pcRenderParams);
+    }
+
+    return bMultiplePhases;
+}
+
+//!
+//! \brief    Check whether the layers fit into a single composite phase
+//! \details  Builds the filter for the first phase as a dry run. Layers that fit
+//!           get their final scaling mode assigned.
+//! \param    [in] pcRenderParams
+//!           Pointer to Render parameters
+//! \param    [in] ppSources
+//!           Pointer to the address of Source Surfaces
+//! \param    [in] iSources
+//!           Count of Source Surfaces
+//! \return   bool
+//!           Return true if multiple phases, otherwise false
+//!
+bool CompositeState::DecidePhases(
+    PCVPHAL_RENDER_PARAMS       pcRenderParams,
+    PVPHAL_SURFACE              *ppSources,
+    int32_t                     iSources)
+{
     VPHAL_COMPOSITE_PARAMS  Composite;
+    int32_t                 i;
+
+    // Constriction forces multiple phases
+    if (pcRenderParams->pConstriction)
+    {
+        return true;
+    }
+
+    // Check if multiple phases by building filter for first phase
+    ResetCompParams(&Composite);
+    for (i = 0; i < iSources; i++)
+    {
+        if (!AddCompLayer(&Composite, ppSources[i]))
+        {
+            return true;
+        }
+    }
+
+    // Add render target
+    if (!AddCompTarget(&Composite, pcRenderParams->pTarget[0]))
+    {
+        return true;
+    }
+
+    return false;
+}
+
+//!
+//! \brief    Allocate intermediate buffers for multiple phase rendering
+//! \param    [in] pcRenderParams
+//!           Pointer to Render parameters
+//!
+void CompositeState::AllocatePhaseSurfaces(
+    PCVPHAL_RENDER_PARAMS       pcRenderParams)
+{
+    PMOS_INTERFACE          pOsInterface;
     MOS_RESOURCE            OsResource;
     uint32_t                dwTempWidth;    // Temporary surface width
     uint32_t                dwTempHeight;   // Temporary surface height
     PVPHAL_SURFACE          pTarget;
     PVPHAL_SURFACE          pIntermediate;
-    int32_t                 i;
-    bool                    bMultiplePhases;
     MOS_ALLOC_GFXRES_PARAMS AllocParams;
     VPHAL_GET_SURFACE_INFO  Info;
 
     pTarget = pcRenderParams->pTarget[0];
 
-    // Constriction support
-    dwTempWidth = dwTempHeight = 0;
     if (pcRenderParams->pConstriction)
     {
-        // Force multiple phases
-        bMultiplePhases = true;
-
         // Temporary surface size = constriction rectangle
         dwTempWidth  = pcRenderParams->pConstriction->right;
         dwTempHeight = pcRenderParams->pConstriction->bottom;
     }
     else
     {
-        // Reset multiple phase support
-        bMultiplePhases = false;
-
         // Temporary surface has the same size as render target
         dwTempWidth  = pTarget->dwWidth;
         dwTempHeight = pTarget->dwHeight;
+    }
 
-        // Check if multiple phases by building filter for first phase
-        ResetCompParams(&Composite);
-        for (i = 0; i < iSources; i++)
-        {
-            if (!AddCompLayer(&Composite, ppSources[i]))
-            {
-                bMultiplePhases = true;
-                break;
-            }
-        }
+    pOsInterface  = m_pOsInterface;
+    pIntermediate = &m_Intermediate;
 
-        // Add render target
-        if (!AddCompTarget(&Composite, pTarget))
+    // Allocate/Reallocate temporary output
+    if (dwTempWidth  > pIntermediate->dwWidth ||
+        dwTempHeight > pIntermediate->dwHeight)
+    {
+        // Get max values
+        dwTempWidth  = MOS_MAX(dwTempWidth , pIntermediate->dwWidth);
+        dwTempHeight = MOS_MAX(dwTempHeight, pIntermediate->dwHeight);
+
+        // Allocate buffer in fixed increments
+        dwTempWidth  = MOS_ALIGN_CEIL(dwTempWidth , VPHAL_BUFFER_SIZE_INCREMENT);
+        dwTempHeight = MOS_ALIGN_CEIL(dwTempHeight, VPHAL_BUFFER_SIZE_INCREMENT);
+
+        MOS_ZeroMemory(&AllocParams, sizeof(MOS_ALLOC_GFXRES_PARAMS));
+        MOS_ZeroMemory(&OsResource, sizeof(MOS_RESOURCE));
+
+        AllocParams.Type     = MOS_GFXRES_2D;
+        AllocParams.TileType = MOS_TILE_Y;
+        AllocParams.dwWidth  = dwTempWidth;
+        AllocParams.dwHeight = dwTempHeight;
+        AllocParams.Format   = Format_A8R8G8B8;
+
+        pOsInterface->pfnAllocateResource(
+            pOsInterface,
+            &AllocParams,
+            &OsResource);
+
+        // Get Allocation index of source for rendering
+        pOsInterface->pfnRegisterResource(
+            pOsInterface,
+            &OsResource,
+            false,
+            true);
+
+        if (!Mos_ResourceIsNull(&OsResource))
         {
-            bMultiplePhases = true;
+            // Deallocate old resource
+            pOsInterface->pfnFreeResource(pOsInterface,
+                                          &pIntermediate->OsResource);
+
+            // Set new resource
+            pIntermediate->OsResource = OsResource;
+
+            // Get resource info (width, height, pitch, tiling, etc)
+            MOS_ZeroMemory(&Info, sizeof(VPHAL_GET_SURFACE_INFO));
+
+            VpHal_GetSurfaceInfo(
+                pOsInterface,
+                &Info,
+                pIntermediate);
         }
     }
 
-    // Reallocate Intermediate surface
-    if (bMultiplePhases)
-    {
-        pOsInterface  = m_pOsInterface;
-        pIntermediate = &m_Intermediate;
+    // Set output parameters
+    pIntermediate->SurfType          = SURF_IN_PRIMARY;
+    pIntermediate->SampleType        = SAMPLE_PROGRESSIVE;
+    pIntermediate->ColorSpace        = pTarget->ColorSpace;
+    pIntermediate->ExtendedGamut     = pTarget->ExtendedGamut;
+    pIntermediate->rcSrc             = pTarget->rcSrc;
+    pIntermediate->rcDst             = pTarget->rcDst;
+    pIntermediate->ScalingMode       = VPHAL_SCALING_BILINEAR;
+    pIntermediate->bIEF              = false;
 
-        // Allocate/Reallocate temporary output
-        if (dwTempWidth  > pIntermediate->dwWidth ||
-            dwTempHeight > pIntermediate->dwHeight)
-        {
-            // Get max values
-            dwTempWidth  = MOS_MAX(dwTempWidth , pIntermediate->dwWidth);
-            dwTempHeight = MOS_MAX(dwTempHeight, pIntermediate->dwHeight);
+    pIntermediate = &m_Intermediate2;
 
-            // Allocate buffer in fixed increments
-            dwTempWidth  = MOS_ALIGN_CEIL(dwTempWidth , VPHAL_BUFFER_SIZE_INCREMENT);
-            dwTempHeight = MOS_ALIGN_CEIL(dwTempHeight, VPHAL_BUFFER_SIZE_INCREMENT);
+    // Allocate/Reallocate temporary output
+    if (dwTempWidth  > pIntermediate->dwWidth ||
+        dwTempHeight > pIntermediate->dwHeight)
+    {
+        // Get max values
+        dwTempWidth  = MOS_MAX(dwTempWidth , pIntermediate->dwWidth);
+        dwTempHeight = MOS_MAX(dwTempHeight, pIntermediate->dwHeight);
 
-            MOS_ZeroMemory(&AllocParams, sizeof(MOS_ALLOC_GFXRES_PARAMS));
-            MOS_ZeroMemory(&OsResource, sizeof(MOS_RESOURCE));
+        // Allocate buffer in fixed increments
+        dwTempWidth  = MOS_ALIGN_CEIL(dwTempWidth , VPHAL_BUFFER_SIZE_INCREMENT);
+        dwTempHeight = MOS_ALIGN_CEIL(dwTempHeight, VPHAL_BUFFER_SIZE_INCREMENT);
 
-            AllocParams.Type     = MOS_GFXRES_2D;
-            AllocParams.TileType = MOS_TILE_Y;
-            AllocParams.dwWidth  = dwTempWidth;
-            AllocParams.dwHeight = dwTempHeight;
-            AllocParams.Format   = Format_A8R8G8B8;
+        MOS_ZeroMemory(&AllocParams, sizeof(MOS_ALLOC_GFXRES_PARAMS));
 
-            pOsInterface->pfnAllocateResource(
-                pOsInterface,
-                &AllocParams,
-                &OsResource);
+        AllocParams.Type     = MOS_GFXRES_2D;
+        AllocParams.TileType = MOS_TILE_Y;
+        AllocParams.dwWidth  = dwTempWidth;
+        AllocParams.dwHeight = dwTempHeight;
+        AllocParams.Format   = Format_A8R8G8B8;
 
-            // Get Allocation index of source for rendering
-            pOsInterface->pfnRegisterResource(
-                pOsInterface,
-                &OsResource,
-                false,
-                true);
+        pOsInterface->pfnAllocateResource(
+            pOsInterface,
+            &AllocParams,
+            &OsResource);
 
-            if (!Mos_ResourceIsNull(&OsResource))
-            {
-                // Deallocate old resource
-                pOsInterface->pfnFreeResource(pOsInterface,
-                                              &pIntermediate->OsResource);
+        if (!Mos_ResourceIsNull(&OsResource))
+        {
+            // Deallocate old resource
+            pOsInterface->pfnFreeResource(pOsInterface,
+                                          &pIntermediate->OsResource);
 
-                // Set new resource
-                pIntermediate->OsResource = OsResource;
+            // Set new resource
+            pIntermediate->OsResource = OsResource;
 
-                // Get resource info (width, height, pitch, tiling, etc)
-                MOS_ZeroMemory(&Info, sizeof(VPHAL_GET_SURFACE_INFO));
+            // Get resource info (width, height, pitch, tiling, etc)
+            MOS_ZeroMemory(&Info, sizeof(VPHAL_GET_SURFACE_INFO));
 
-                VpHal_GetSurfaceInfo(
-                    pOsInterface,
-                    &Info,
-                    pIntermediate);
-            }
+            VpHal_GetSurfaceInfo(
+                pOsInterface,
+                &Info,
+                pIntermediate);
         }
+    }
 
-        // Set output parameters
-        pIntermediate->SurfType          = SURF_IN_PRIMARY;
-        pIntermediate->SampleType        = SAMPLE_PROGRESSIVE;
-        pIntermediate->ColorSpace        = pTarget->ColorSpace;
-        pIntermediate->ExtendedGamut     = pTarget->ExtendedGamut;
-        pIntermediate->rcSrc             = pTarget->rcSrc;
-        pIntermediate->rcDst             = pTarget->rcDst;
-        pIntermediate->ScalingMode       = VPHAL_SCALING_BILINEAR;
-        pIntermediate->bIEF              = false;
+    // Set output parameters
+    pIntermediate->SurfType          = SURF_IN_PRIMARY;
+    pIntermediate->SampleType        = SAMPLE_PROGRESSIVE;
+    pIntermediate->ColorSpace        = pTarget->ColorSpace;
+    pIntermediate->ExtendedGamut     = pTarget->ExtendedGamut;
+    pIntermediate->rcSrc             = pTarget->rcSrc;
+    pIntermediate->rcDst             = pTarget->rcDst;
+    pIntermediate->ScalingMode       = VPHAL_SCALING_BILINEAR;
+    pIntermediate->bIEF              = false;
+}
 
-        pIntermediate = &m_Intermediate2;
+//!
+//! \brief    Build canonical composite plan key
+//! \details  Collects the fields read by PrepareCSC and DecidePhases into a zeroed
+//!           key. Only the layers in use are hashed; the rest stay zero.
+//! \param    [in] pcRenderParams
+//!           Pointer to Render parameters
+//! \param    [in] ppSources
+//!           Pointer to the address of Source Surfaces
+//! \param    [in] iSources
+//!           Count of Source Surfaces
+//! \param    [out] pKey
+//!           Pointer to plan key
+//! \return   uint32_t
+//!           Hash of the key
+//!
+uint32_t CompositeState::BuildPlanKey(
+    PCVPHAL_RENDER_PARAMS       pcRenderParams,
+    PVPHAL_SURFACE              *ppSources,
+    int32_t                     iSources,
+    PVPHAL_COMP_PLAN_KEY        pKey)
+{
+    PVPHAL_SURFACE              pTarget;
+    PVPHAL_SURFACE              pSrc;
+    PVPHAL_COMP_PLAN_LAYER_KEY  pLayer;
+    const uint8_t               *pData;
+    uint32_t                    dwSize;
+    uint32_t                    dwHash;
+    uint32_t                    i;
 
-        // Allocate/Reallocate temporary output
-        if (dwTempWidth  > pIntermediate->dwWidth ||
-            dwTempHeight > pIntermediate->dwHeight)
-        {
-            // Get max values
-            dwTempWidth  = MOS_MAX(dwTempWidth , pIntermediate->dwWidth);
-            dwTempHeight = MOS_MAX(dwTempHeight, pIntermediate->dwHeight);
+    MOS_ZeroMemory(pKey, sizeof(*pKey));
 
-            // Allocate buffer in fixed increments
-            dwTempWidth  = MOS_ALIGN_CEIL(dwTempWidth , VPHAL_BUFFER_SIZE_INCREMENT);
-            dwTempHeight = MOS_ALIGN_CEIL(dwTempHeight, VPHAL_BUFFER_SIZE_INCREMENT);
+    pTarget = pcRenderParams->pTarget[0];
 
-            MOS_ZeroMemory(&AllocParams, sizeof(MOS_ALLOC_GFXRES_PARAMS));
+    pKey->iSources          = iSources;
+    pKey->GpuContext        = m_pOsInterface->CurrentGpuContextOrdinal;
+    pKey->TargetFormat      = pTarget->Format;
+    pKey->dwTargetWidth     = pTarget->dwWidth;
+    pKey->dwTargetHeight    = pTarget->dwHeight;
+    pKey->bTargetProcamp    = (pTarget->pProcampParams != nullptr);
+    if (pcRenderParams->pConstriction)
+    {
+        pKey->bConstriction  = true;
+        pKey->rcConstriction = *pcRenderParams->pConstriction;
+    }
 
-            AllocParams.Type     = MOS_GFXRES_2D;
-            AllocParams.TileType = MOS_TILE_Y;
-            AllocParams.dwWidth  = dwTempWidth;
-            AllocParams.dwHeight = dwTempHeight;
-            AllocParams.Format   = Format_A8R8G8B8;
+    for (i = 0; i < (uint32_t)iSources; i++)
+    {
+        pSrc   = ppSources[i];
+        pLayer = &pKey->Layer[i];
 
-            pOsInterface->pfnAllocateResource(
-                pOsInterface,
-                &AllocParams,
-                &OsResource);
+        pLayer->Format          = pSrc->Format;
+        pLayer->SurfType        = pSrc->SurfType;
+        pLayer->SampleType      = pSrc->SampleType;
+        pLayer->ColorSpace      = pSrc->ColorSpace;
+        pLayer->ScalingMode     = pSrc->ScalingMode;
+        pLayer->Rotation        = pSrc->Rotation;
+        pLayer->PaletteType     = pSrc->Palette.PaletteType;
+        pLayer->dwWidth         = pSrc->dwWidth;
+        pLayer->dwHeight        = pSrc->dwHeight;
+        pLayer->rcSrc           = pSrc->rcSrc;
+        pLayer->rcDst           = pSrc->rcDst;
+        pLayer->rcMaxSrc        = pSrc->rcMaxSrc;
+        pLayer->bProcamp        = (pSrc->pProcampParams != nullptr);
+        pLayer->bProcampEnabled = (pSrc->pProcampParams != nullptr && pSrc->pProcampParams->bEnabled);
+        pLayer->bLumaKey        = (pSrc->pLumaKeyParams != nullptr);
+        pLayer->bDeinterlace    = (pSrc->pDeinterlaceParams != nullptr);
+    }
 
-            if (!Mos_ResourceIsNull(&OsResource))
-            {
-                // Deallocate old resource
-                pOsInterface->pfnFreeResource(pOsInterface,
-                                              &pIntermediate->OsResource);
+    // FNV-1a over the used part of the key
+    pData  = (const uint8_t *)pKey;
+    dwSize = sizeof(*pKey) - sizeof(pKey->Layer) + iSources * sizeof(pKey->Layer[0]);
+    dwHash = 2166136261u;
+    for (i = 0; i < dwSize; i++)
+    {
+        dwHash = (dwHash ^ pData[i]) * 16777619u;
+    }
 
-                // Set new resource
-                pIntermediate->OsResource = OsResource;
+    return dwHash;
+}
 
-                // Get resource info (width, height, pitch, tiling, etc)
-                MOS_ZeroMemory(&Info, sizeof(VPHAL_GET_SURFACE_INFO));
+//!
+//! \brief    Determine intermediate colorspace and phases, reusing a cached plan if possible
+//! \details  The CSC and phase decisions only depend on the fields captured by
+//!           BuildPlanKey, so a steady stream of identical frames can replay the
+//!           previous decision. Intermediate surfaces are still checked every frame.
+//! \param    [in] pcRenderParams
+//!           Pointer to Render parameters
+//! \param    [in] ppSources
+//!           Pointer to the address of Source Surfaces
+//! \param    [in] iSources
+//!           Count of Source Surfaces
+//! \param    [out] pColorSpace
+//!           Intermediate colorspace
+//! \return   bool
+//!           Return true if multiple phases, otherwise false
+//!
+bool CompositeState::PreparePlan(
+    PCVPHAL_RENDER_PARAMS       pcRenderParams,
+    PVPHAL_SURFACE              *ppSources,
+    int32_t                     iSources,
+    VPHAL_CSPACE                *pColorSpace)
+{
+    VPHAL_COMP_PLAN_KEY     Key;
+    PVPHAL_COMP_PLAN_ENTRY  pEntry;
+    uint32_t                dwHash;
+    uint32_t                dwKeySize;
+    double                  StartTime;
+    bool                    bMultiplePhases;
+    int32_t                 i, j;
 
-                VpHal_GetSurfaceInfo(
-                    pOsInterface,
-                    &Info,
-                    pIntermediate);
+    StartTime = MOS_GetTime();
+    dwHash    = BuildPlanKey(pcRenderParams, ppSources, iSources, &Key);
+    dwKeySize = sizeof(Key) - sizeof(Key.Layer) + iSources * sizeof(Key.Layer[0]);
+
+    for (i = 0; i < VPHAL_COMP_PLAN_CACHE_SIZE; i++)
+    {
+        pEntry = &m_PlanCache[i];
+        if (pEntry->bValid &&
+            pEntry->dwHash == dwHash &&
+            !memcmp(&pEntry->Key, &Key, dwKeySize))
+        {
+            for (j = 0; j < iSources; j++)
+            {
+                ppSources[j]->ScalingMode = pEntry->ScalingMode[j];
             }
+
+            m_PlanCacheHits++;
+            *pColorSpace    = pEntry->ColorSpace;
+            bMultiplePhases = pEntry->bMultiplePhases;
+            goto finish;
         }
+    }
+
+    // Miss - derive the plan and remember it
+    *pColorSpace    = PrepareCSC(pcRenderParams, ppSources, iSources);
+    bMultiplePhases = DecidePhases(pcRenderParams, ppSources, iSources);
+
+    pEntry = &m_PlanCache[m_iPlanEvictIndex];
+    pEntry->bValid          = true;
+    pEntry->dwHash          = dwHash;
+    pEntry->Key             = Key;
+    pEntry->ColorSpace      = *pColorSpace;
+    pEntry->bMultiplePhases = bMultiplePhases;
+    for (j = 0; j < iSources; j++)
+    {
+        pEntry->ScalingMode[j] = ppSources[j]->ScalingMode;
+    }
+    m_iPlanEvictIndex = (m_iPlanEvictIndex + 1) % VPHAL_COMP_PLAN_CACHE_SIZE;
+
+    m_PlanCacheMisses++;
+    m_PlanMissTime += MOS_GetTime() - StartTime;
 
-        // Set output parameters
-        pIntermediate->SurfType          = SURF_IN_PRIMARY;
-        pIntermediate->SampleType        = SAMPLE_PROGRESSIVE;
-        pIntermediate->ColorSpace        = pTarget->ColorSpace;
-        pIntermediate->ExtendedGamut     = pTarget->ExtendedGamut;
-        pIntermediate->rcSrc             = pTarget->rcSrc;
-        pIntermediate->rcDst             = pTarget->rcDst;
-        pIntermediate->ScalingMode       = VPHAL_SCALING_BILINEAR;
-        pIntermediate->bIEF              = false;
+finish:
+    if (bMultiplePhases)
+    {
+        AllocatePhaseSurfaces(pcRenderParams);
     }
 
     return bMultiplePhases;
@@ -1960,8 +2152,7 @@ MOS_STATUS CompositeState::RenderMultiPhase(
 
         // Reset states before rendering (clear allocations, get GSH allocation index
         //                                + any additional housekeeping)
-        pOsInterface->pfnResetOsStates(pOsInterface);
-        VPHAL_RENDER_CHK_STATUS(pRenderHal->pfnReset(pRenderHal));
+        VPHAL_RENDER_CHK_STATUS(VpHal_RndrCommonResetStates(pRenderHal, m_StatusTableUpdateParams.pStatusTable));
 
         // Set Slice Shutdown Mode
         if (m_bSingleSlice)
@@ -2074,8 +2265,7 @@ MOS_STATUS CompositeState::RenderMultiPhase(
 
                 // Reset states before rendering (clear allocations, get GSH allocation index
                 //                                + any additional housekeeping)
-                pOsInterface->pfnResetOsStates(pOsInterface);
-                VPHAL_RENDER_CHK_STATUS(pRenderHal->pfnReset(pRenderHal));
+                VPHAL_RENDER_CHK_STATUS(VpHal_RndrCommonResetStates(pRenderHal, m_StatusTableUpdateParams.pStatusTable));
 
                 // Set performance tag for current rotation phase
                 PerfTag = (VPHAL_PERFTAG)((int)VPHAL_ROT);
@@ -2154,8 +2344,7 @@ MOS_STATUS CompositeState::Render(
 
     // Reset states before rendering (clear allocations, get GSH allocation index
     //                                + any additional housekeeping)
-    pOsInterface->pfnResetOsStates(pOsInterface);
-    VPHAL_RENDER_CHK_STATUS(pRenderHal->pfnReset(pRenderHal));
+    VPHAL_RENDER_CHK_STATUS(VpHal_RndrCommonResetStates(pRenderHal, m_StatusTableUpdateParams.pStatusTable));
     pOsInterface->pfnResetPerfBufferID(pOsInterface);   // reset once per frame
 
     // Configure cache settings for this render operation
@@ -2295,14 +2484,11 @@ MOS_STATUS CompositeState::Render(
         goto finish;
     }
 
-    // Determine cspace for compositing
-    ColorSpace = PrepareCSC(pcRenderParams,
-                            pSources,
-                            iSources);
-
-    bMultiplePhases = PreparePhases(pcRenderParams,
-                                    pSources,
-                                    iSources);
+    // Determine cspace for compositing and number of phases
+    bMultiplePhases = PreparePlan(pcRenderParams,
+                                  pSources,
+                                  iSources,
+                                  &ColorSpace);
     if (!bMultiplePhases)
     {
         pOutput = pTarget;
@@ -2356,8 +2542,7 @@ MOS_STATUS CompositeState::Render(
 
         // Reset states before rendering (clear allocations, get GSH allocation index
         //                                + any additional housekeeping)
-        pOsInterface->pfnResetOsStates(pOsInterface);
-        VPHAL_RENDER_CHK_STATUS(pRenderHal->pfnReset(pRenderHal));
+        VPHAL_RENDER_CHK_STATUS(VpHal_RndrCommonResetStates(pRenderHal, m_StatusTableUpdateParams.pStatusTable));
 
         // Raise the flag to indicate the last comp render phase
         m_bLastPhase = true;
@@ -6588,6 +6773,15 @@ void CompositeState::Destroy()
 
     // Destroy sampler 8x8 state table parameters
     VpHal_RndrCommonDestroyAVSParams(&m_AvsParameters);
+
+    if (m_PlanCacheHits + m_PlanCacheMisses)
+    {
+        // Each hit saves roughly the average derivation cost of a miss
+        VPHAL_RENDER_NORMALMESSAGE("Composite plan cache: %llu hits, %llu misses, ~%.1f us saved.",
+            (unsigned long long)m_PlanCacheHits,
+            (unsigned long long)m_PlanCacheMisses,
+            m_PlanCacheMisses ? m_PlanMissTime * m_PlanCacheHits / m_PlanCacheMisses : 0.0);
+    }
 }
 
 //! \brief    Initialize interface for Composite
@@ -6632,7 +6826,11 @@ CompositeState::CompositeState(
     m_iCallID(0),
     m_need3DSampler(false),
     m_bYV12iAvsScaling(false),
-    m_bLastPhase(false)
+    m_bLastPhase(false),
+    m_iPlanEvictIndex(0),
+    m_PlanCacheHits(0),
+    m_PlanCacheMisses(0),
+    m_PlanMissTime(0)
 {
     MOS_STATUS                  eStatus;
     MOS_USER_FEATURE_VALUE_DATA UserFeatureData;
@@ -6654,6 +6852,7 @@ CompositeState::CompositeState(
     MOS_ZeroMemory(&m_mhwSamplerAvsTableParam, sizeof(m_mhwSamplerAvsTableParam));
     MOS_ZeroMemory(&m_BatchBuffer, sizeof(m_BatchBuffer));
     MOS_ZeroMemory(&m_BufferParam, sizeof(m_BufferParam));
+    MOS_ZeroMemory(&m_PlanCache, sizeof(m_PlanCache));
 
     // Reset Intermediate output surface (multiple phase)
     pOsInterface->pfnResetResourceAllocationIndex(pOsInterface, &m_Intermediate.OsResource);
@@ -50,6 +50,11 @@
 #define VPHAL_COMP_SAMPLER_LUMAKEY  4
 #define VPHAL_COMP_MAX_SAMPLER      (VPHAL_COMP_SAMPLER_NEAREST | VPHAL_COMP_SAMPLER_BILINEAR | VPHAL_COMP_SAMPLER_LUMAKEY)
 
+//!
+//! \brief Composite render plan cache
+//!
+#define VPHAL_COMP_PLAN_CACHE_SIZE  4
+
 // GRF 8 for unified kernel inline data (NLAS is enabled)
 struct MEDIA_OBJECT_NLAS_INLINE_DATA
 {
@@ -250,6 +255,61 @@ typedef struct _VPHAL_16X16BLOCK_COMPOSITE_MASK
     uint32_t       VerticalBlockCompositeMask      : 16;
 } VPHAL_16X16BLOCK_COMPOSITE_MASK, *PVPHAL_16X16BLOCK_COMPOSITE_MASK;
 
+//!
+//! \brief Per-layer fields that drive the composite CSC and phase decisions
+//!
+typedef struct _VPHAL_COMP_PLAN_LAYER_KEY
+{
+    MOS_FORMAT                          Format;
+    VPHAL_SURFACE_TYPE                  SurfType;
+    VPHAL_SAMPLE_TYPE                   SampleType;
+    VPHAL_CSPACE                        ColorSpace;
+    VPHAL_SCALING_MODE                  ScalingMode;
+    VPHAL_ROTATION                      Rotation;
+    VPHAL_PALETTE_TYPE                  PaletteType;
+    uint32_t                            dwWidth;
+    uint32_t                            dwHeight;
+    RECT                                rcSrc;
+    RECT                                rcDst;
+    RECT                                rcMaxSrc;
+    uint32_t                            bProcamp        : 1;
+    uint32_t                            bProcampEnabled : 1;
+    uint32_t                            bLumaKey        : 1;
+    uint32_t                            bDeinterlace    : 1;
+    uint32_t                            Reserved        : 28;
+} VPHAL_COMP_PLAN_LAYER_KEY, *PVPHAL_COMP_PLAN_LAYER_KEY;
+
+//!
+//! \brief Canonical key of a composite render plan
+//! \details Built zeroed so that padding does not disturb hash or memcmp
+//!
+typedef struct _VPHAL_COMP_PLAN_KEY
+{
+    int32_t                             iSources;
+    MOS_GPU_CONTEXT                     GpuContext;
+    MOS_FORMAT                          TargetFormat;
+    uint32_t                            dwTargetWidth;
+    uint32_t                            dwTargetHeight;
+    uint32_t                            bTargetProcamp  : 1;
+    uint32_t                            bConstriction   : 1;
+    uint32_t                            Reserved        : 30;
+    RECT                                rcConstriction;
+    VPHAL_COMP_PLAN_LAYER_KEY           Layer[VPHAL_MAX_SOURCES];
+} VPHAL_COMP_PLAN_KEY, *PVPHAL_COMP_PLAN_KEY;
+
+//!
+//! \brief Cached composite render plan
+//!
+typedef struct _VPHAL_COMP_PLAN_ENTRY
+{
+    bool                                bValid;
+    uint32_t                            dwHash;
+    VPHAL_COMP_PLAN_KEY                 Key;
+    VPHAL_CSPACE                        ColorSpace;                         //!< Intermediate colorspace from PrepareCSC
+    bool                                bMultiplePhases;                    //!< Phase decision from PreparePhases
+    VPHAL_SCALING_MODE                  ScalingMode[VPHAL_MAX_SOURCES];     //!< Layer scaling modes after the phase dry run
+} VPHAL_COMP_PLAN_ENTRY, *PVPHAL_COMP_PLAN_ENTRY;
+
 //!
 //! \brief Class to VPHAL Composite render
 //!
@@ -676,6 +736,68 @@ private:
         PVPHAL_SURFACE              *ppSources,
         int32_t                     iSources);
 
+    //!
+    //! \brief    Check whether the layers fit into a single composite phase
+    //! \param    [in] pcRenderParams
+    //!           Pointer to Render parameters
+    //! \param    [in] ppSources
+    //!           Pointer to the address of Source Surfaces
+    //! \param    [in] iSources
+    //!           Count of Source Surfaces
+    //! \return   bool
+    //!           Return true if multiple phases, otherwise false
+    //!
+    bool DecidePhases(
+        PCVPHAL_RENDER_PARAMS       pcRenderParams,
+        PVPHAL_SURFACE              *ppSources,
+        int32_t                     iSources);
+
+    //!
+    //! \brief    Allocate intermediate buffers for multiple phase rendering
+    //! \param    [in] pcRenderParams
+    //!           Pointer to Render parameters
+    //!
+    void AllocatePhaseSurfaces(
+        PCVPHAL_RENDER_PARAMS       pcRenderParams);
+
+    //!
+    //! \brief    Build canonical composite plan key
+    //! \param    [in] pcRenderParams
+    //!           Pointer to Render parameters
+    //! \param    [in] ppSources
+    //!           Pointer to the address of Source Surfaces
+    //! \param    [in] iSources
+    //!           Count of Source Surfaces
+    //! \param    [out] pKey
+    //!           Pointer to plan key
+    //! \return   uint32_t
+    //!           Hash of the key
+    //!
+    uint32_t BuildPlanKey(
+        PCVPHAL_RENDER_PARAMS       pcRenderParams,
+        PVPHAL_SURFACE              *ppSources,
+        int32_t                     iSources,
+        PVPHAL_COMP_PLAN_KEY        pKey);
+
+    //!
+    //! \brief    Determine intermediate colorspace and phases, reusing a cached plan if possible
+    //! \param    [in] pcRenderParams
+    //!           Pointer to Render parameters
+    //! \param    [in] ppSources
+    //!           Pointer to the address of Source Surfaces
+    //! \param    [in] iSources
+    //!           Count of Source Surfaces
+    //! \param    [out] pColorSpace
+    //!           Intermediate colorspace
+    //! \return   bool
+    //!           Return true if multiple phases, otherwise false
+    //!
+    bool PreparePlan(
+        PCVPHAL_RENDER_PARAMS       pcRenderParams,
+        PVPHAL_SURFACE              *ppSources,
+        int32_t                     iSources,
+        VPHAL_CSPACE                *pColorSpace);
+
     //!
     //! \brief    Composite multiple phase rendering
     //! \details  Composite render with multiple phases. In some cases we cannot process composition just in one phase
@@ -981,6 +1103,13 @@ private:
 
     bool                            m_bLastPhase;                 //!< Flag for indicating the last Comp render phase
 
+    // Render plan cache
+    VPHAL_COMP_PLAN_ENTRY           m_PlanCache[VPHAL_COMP_PLAN_CACHE_SIZE];
+    int32_t                         m_iPlanEvictIndex;            //!< Next plan cache entry to replace
+    uint64_t                        m_PlanCacheHits;
+    uint64_t                        m_PlanCacheMisses;
+    double                          m_PlanMissTime;               //!< Accumulated plan derivation time on misses, in us
+
 protected:
     // Feature flags
     float                           m_fSamplerLinearBiasX;        //!< Linear sampler bias X
@@ -1626,8 +1626,10 @@ MOS_STATUS VPHAL_VEBOX_STATE::VeboxSetupIndirectStates(
 
     if (pRenderData->GetVeboxStateParams()->pVphalVeboxDndiParams)
     {
-        VPHAL_RENDER_CHK_STATUS(pVeboxInterface->AddVeboxDndiState(
-            pRenderData->GetVeboxStateParams()->pVphalVeboxDndiParams));
+        // Auto denoise kernel updates the DNDI state in the heap, so it's not reused
+        VPHAL_RENDER_CHK_STATUS(pVeboxInterface->UpdateVeboxDndiState(
+            pRenderData->GetVeboxStateParams()->pVphalVeboxDndiParams,
+            !pRenderData->bAutoDenoise));
     }
 
     // Set IECP State Params
@@ -1644,7 +1646,7 @@ MOS_STATUS VPHAL_VEBOX_STATE::VeboxSetupIndirectStates(
         VPHAL_RENDER_CHK_STATUS(m_IECP->InitParams(
             pSrcSurface->ColorSpace,
             &VeboxIecpParams));
-        VPHAL_RENDER_CHK_STATUS(pVeboxInterface->AddVeboxIecpState(
+        VPHAL_RENDER_CHK_STATUS(pVeboxInterface->UpdateVeboxIecpState(
             &VeboxIecpParams));
     }
 
@@ -3789,6 +3791,11 @@ MOS_STATUS VpHal_RndrRenderVebox(
             VPHAL_SET_SURF_MEMOBJCTL(pVeboxState->DnDiSurfMemObjCtl.CurrentOutputSurfMemObjCtl, MOS_MP_RESOURCE_USAGE_DEFAULT);
         }
 
+        // Composite jobs batched in the render command buffer go first
+        VPHAL_RENDER_CHK_STATUS(VpHal_RndrCommonFlushBatch(
+            pRenderState->GetRenderHalInterface(),
+            &pRenderer->StatusTable));
+
         VPHAL_RENDER_CHK_STATUS(pRenderState->Render(
                                                 pcRenderParams,
                                                 pRenderPassData))
@@ -1830,22 +1830,20 @@ void KernelDll_UpdateCscCoefficients(Kdll_State      *pState,
 }
 
 /*----------------------------------------------------------------------------
-| Name      : KernelDll_FindRule
-| Purpose   : Find a rule that matches the current search/input state
+| Name      : KernelDll_MatchRuleSet
+| Purpose   : Check if all match rules of a rule set are satisfied by the
+|             current search/input state
 |
-| Input     : pState       - Kernel Dll state
-|             pSearchState - current DL search state
+| Input     : pSearchState - current DL search state
+|             pRuleSet     - rule set to evaluate
 |
-| Return    :
+| Return    : true if the rule set matches
 \---------------------------------------------------------------------------*/
-bool KernelDll_FindRule(
-    Kdll_State       *pState,
-    Kdll_SearchState *pSearchState)
+static bool KernelDll_MatchRuleSet(
+    Kdll_SearchState        *pSearchState,
+    const Kdll_RuleEntrySet *pRuleSet)
 {
-    uint32_t parser_state = (uint32_t)pSearchState->state;
-    Kdll_RuleEntrySet    *pRuleSet;
     const Kdll_RuleEntry *pRuleEntry;
-    int32_t              iRuleCount;
     int32_t              iMatchCount;
     bool                 bLayerFormatMatched;
     bool                 bSrc0FormatMatched;
@@ -1853,579 +1851,659 @@ bool KernelDll_FindRule(
     bool                 bTargetFormatMatched;
     bool                 bSrc0SampingMatched;
 
-    VPHAL_RENDER_FUNCTION_ENTER;
+    // Points to the first rule, get number of matches
+    pRuleEntry  = pRuleSet->pRuleEntry;
+    iMatchCount = pRuleSet->iMatchCount;
 
-    // All Custom states are handled as a single group
-    if (parser_state >= Parser_Custom)
-    {
-        parser_state = Parser_Custom;
-    }
-
-    pRuleSet   = pState->pDllRuleTable[parser_state];
-    iRuleCount = pState->iDllRuleCount[parser_state];
+    // Initialize for each Ruleset
+    bLayerFormatMatched  = false;
+    bSrc0FormatMatched   = false;
+    bSrc1FormatMatched   = false;
+    bTargetFormatMatched = false;
+    bSrc0SampingMatched  = false;
 
-    if (pRuleSet == nullptr || iRuleCount == 0)
+    // Match all rules within the same RuleSet
+    for (; iMatchCount > 0; iMatchCount--, pRuleEntry++)
     {
-        VPHAL_RENDER_NORMALMESSAGE("Search rules undefined.");
-        pSearchState->pMatchingRuleSet = nullptr;
-        return false;
-    }
+        switch (pRuleEntry->id)
+        {
+            // Match current Parser State
+            case RID_IsParserState:
+                if (pSearchState->state == (Kdll_ParserState) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-    // Search matching entry
-    for ( ; iRuleCount > 0; iRuleCount--, pRuleSet++)
-    {
-        // Points to the first rule, get number of matches
-        pRuleEntry  = pRuleSet->pRuleEntry;
-        iMatchCount = pRuleSet->iMatchCount;
+            // Match render method
+            case RID_IsRenderMethod:
+                if (pSearchState->pFilter->RenderMethod == (Kdll_RenderMethod)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-        // Initialize for each Ruleset
-        bLayerFormatMatched  = false;
-        bSrc0FormatMatched   = false;
-        bSrc1FormatMatched   = false;
-        bTargetFormatMatched = false;
-        bSrc0SampingMatched  = false;
+            // Match target color space
+            case RID_IsTargetCspace:
+                if (KernelDll_IsCspace(pSearchState->cspace, (VPHAL_CSPACE) pRuleEntry->value))
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-        // Match all rules within the same RuleSet
-        for (; iMatchCount > 0; iMatchCount--, pRuleEntry++)
-        {
-            switch (pRuleEntry->id)
-            {
-                // Match current Parser State
-                case RID_IsParserState:
-                    if (pSearchState->state == (Kdll_ParserState) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match current layer ID
+            case RID_IsLayerID:
+                if (pSearchState->pFilter->layer == (Kdll_Layer) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match render method
-                case RID_IsRenderMethod:
-                    if (pSearchState->pFilter->RenderMethod == (Kdll_RenderMethod)pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
+            // Match current layer format
+            case RID_IsLayerFormat:
+                if (pRuleEntry->logic == Kdll_Or && bLayerFormatMatched)
+                {
+                    // Already found matching format in the ruleset
+                    continue;
+                }
+                else
+                {
+                    // Check if the layer format matches the rule
+                    if (KernelDll_IsFormat(pSearchState->pFilter->format,
+                                            pSearchState->pFilter->cspace,
+                                            (MOS_FORMAT  ) pRuleEntry->value))
                     {
-                        break;
+                        bLayerFormatMatched = true;
                     }
 
-                // Match target color space
-                case RID_IsTargetCspace:
-                    if (KernelDll_IsCspace(pSearchState->cspace, (VPHAL_CSPACE) pRuleEntry->value))
-                    {
-                        continue;
-                    }
-                    else
+                    if (pRuleEntry->logic == Kdll_None && !bLayerFormatMatched)
                     {
+                        // Last entry and No matching format was found
                         break;
                     }
-
-                // Match current layer ID
-                case RID_IsLayerID:
-                    if (pSearchState->pFilter->layer == (Kdll_Layer) pRuleEntry->value)
-                    {
-                        continue;
-                    }
                     else
                     {
-                        break;
-                    }
-
-                // Match current layer format
-                case RID_IsLayerFormat:
-                    if (pRuleEntry->logic == Kdll_Or && bLayerFormatMatched)
-                    {
-                        // Already found matching format in the ruleset
                         continue;
                     }
-                    else
-                    {
-                        // Check if the layer format matches the rule
-                        if (KernelDll_IsFormat(pSearchState->pFilter->format,
-                                                pSearchState->pFilter->cspace,
-                                                (MOS_FORMAT  ) pRuleEntry->value))
-                        {
-                            bLayerFormatMatched = true;
-                        }
+                }
 
-                        if (pRuleEntry->logic == Kdll_None && !bLayerFormatMatched)
-                        {
-                            // Last entry and No matching format was found
-                            break;
-                        }
-                        else
-                        {
-                            continue;
-                        }
-                    }
+            // Match shuffling requirement
+            case RID_IsShuffling:
+                if (pSearchState->ShuffleSamplerData == (Kdll_Shuffling) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match shuffling requirement
-                case RID_IsShuffling:
-                    if (pSearchState->ShuffleSamplerData == (Kdll_Shuffling) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Check if RT rotates
+            case RID_IsRTRotate:
+                if (pSearchState->bRTRotate == (pRuleEntry->value ? true : false) )
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Check if RT rotates
-                case RID_IsRTRotate:
-                    if (pSearchState->bRTRotate == (pRuleEntry->value ? true : false) )
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match current layer rotation
+            case RID_IsLayerRotation:
+                if (pSearchState->pFilter->rotation == (VPHAL_ROTATION) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match current layer rotation
-                case RID_IsLayerRotation:
-                    if (pSearchState->pFilter->rotation == (VPHAL_ROTATION) pRuleEntry->value)
+            // Match Src0 source format (surface)
+            case RID_IsSrc0Format:
+                if (pRuleEntry->logic == Kdll_Or && bSrc0FormatMatched)
+                {
+                    // Already found matching format in the ruleset
+                    continue;
+                }
+                else
+                {
+                    // Check if the source 0 format matches the rule
+                    // The intermediate colorspace is used to determine
+                    // if palettized input is given in RGB or YUV format.
+                    if (KernelDll_IsFormat(pSearchState->src0_format,
+                                            pSearchState->cspace,
+                                            (MOS_FORMAT  ) pRuleEntry->value))
                     {
-                        continue;
+                        bSrc0FormatMatched = true;
                     }
-                    else
+
+                    if (pRuleEntry->logic == Kdll_None && !bSrc0FormatMatched)
                     {
+                        // Last entry and No matching format was found
                         break;
                     }
-
-                // Match Src0 source format (surface)
-                case RID_IsSrc0Format:
-                    if (pRuleEntry->logic == Kdll_Or && bSrc0FormatMatched)
+                    else
                     {
-                        // Already found matching format in the ruleset
                         continue;
                     }
-                    else
-                    {
-                        // Check if the source 0 format matches the rule
-                        // The intermediate colorspace is used to determine
-                        // if palettized input is given in RGB or YUV format.
-                        if (KernelDll_IsFormat(pSearchState->src0_format,
-                                                pSearchState->cspace,
-                                                (MOS_FORMAT  ) pRuleEntry->value))
-                        {
-                            bSrc0FormatMatched = true;
-                        }
+                }
 
-                        if (pRuleEntry->logic == Kdll_None && !bSrc0FormatMatched)
-                        {
-                            // Last entry and No matching format was found
-                            break;
-                        }
-                        else
-                        {
-                            continue;
-                        }
-                    }
+            // Match Src0 sampling mode
+            case RID_IsSrc0Sampling:
+                // Check if the layer format matches the rule
+                if (pSearchState->src0_sampling == (Kdll_Sampling) pRuleEntry->value)
+                {
+                    bSrc0SampingMatched = true;
+                    continue;
+                }
+                else if (bSrc0SampingMatched || pRuleEntry->logic == Kdll_Or)
+                {
+                    continue;
+                }
+                else if ((Kdll_Sampling) pRuleEntry->value == Sample_Any &&
+                        pSearchState->src0_sampling != Sample_None)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 sampling mode
-                case RID_IsSrc0Sampling:
-                    // Check if the layer format matches the rule
-                    if (pSearchState->src0_sampling == (Kdll_Sampling) pRuleEntry->value)
-                    {
-                        bSrc0SampingMatched = true;
-                        continue;
-                    }
-                    else if (bSrc0SampingMatched || pRuleEntry->logic == Kdll_Or)
-                    {
-                        continue;
-                    }
-                    else if ((Kdll_Sampling) pRuleEntry->value == Sample_Any &&
-                            pSearchState->src0_sampling != Sample_None)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 rotation
+            case RID_IsSrc0Rotation:
+                if (pSearchState->src0_rotation == (VPHAL_ROTATION) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 rotation
-                case RID_IsSrc0Rotation:
-                    if (pSearchState->src0_rotation == (VPHAL_ROTATION) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 Colorfill
+            case RID_IsSrc0ColorFill:
+                if (pSearchState->src0_colorfill == (int32_t)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 Colorfill
-                case RID_IsSrc0ColorFill:
-                    if (pSearchState->src0_colorfill == (int32_t)pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 Luma Key
+            case RID_IsSrc0LumaKey:
+                if (pSearchState->src0_lumakey == (int32_t)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 Luma Key
-                case RID_IsSrc0LumaKey:
-                    if (pSearchState->src0_lumakey == (int32_t)pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 Procamp
+            case RID_IsSrc0Procamp:
+                if (pSearchState->pFilter->procamp == (int32_t)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 Procamp
-                case RID_IsSrc0Procamp:
-                    if (pSearchState->pFilter->procamp == (int32_t)pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 internal pixel format
+            case RID_IsSrc0Internal:
+                if (pSearchState->src0_internal == (Kdll_IntFormat) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else if ((Kdll_IntFormat) pRuleEntry->value == Internal_Any &&
+                        pSearchState->src0_internal != Internal_None)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 internal pixel format
-                case RID_IsSrc0Internal:
-                    if (pSearchState->src0_internal == (Kdll_IntFormat) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else if ((Kdll_IntFormat) pRuleEntry->value == Internal_Any &&
-                            pSearchState->src0_internal != Internal_None)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 CSC coefficients
+            case RID_IsSrc0Coeff:
+                if (pSearchState->src0_coeff == (Kdll_CoeffID) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else if ((Kdll_CoeffID) pRuleEntry->value == CoeffID_Any &&
+                        pSearchState->src0_coeff != CoeffID_None)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 CSC coefficients
-                case RID_IsSrc0Coeff:
-                    if (pSearchState->src0_coeff == (Kdll_CoeffID) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else if ((Kdll_CoeffID) pRuleEntry->value == CoeffID_Any &&
-                            pSearchState->src0_coeff != CoeffID_None)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 CSC coefficients setting mode
+            case RID_IsSetCoeffMode:
+                if (pSearchState->pFilter->SetCSCCoeffMode == (Kdll_SetCSCCoeffMethod) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 CSC coefficients setting mode
-                case RID_IsSetCoeffMode:
-                    if (pSearchState->pFilter->SetCSCCoeffMode == (Kdll_SetCSCCoeffMethod) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 processing mode
+            case RID_IsSrc0Processing:
+                if (pSearchState->src0_process == (Kdll_Processing) pRuleEntry->value)
+                {
+                    continue;
+                }
+                if ((Kdll_Processing) pRuleEntry->value == Process_Any &&
+                    pSearchState->src0_process != Process_None)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 processing mode
-                case RID_IsSrc0Processing:
-                    if (pSearchState->src0_process == (Kdll_Processing) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    if ((Kdll_Processing) pRuleEntry->value == Process_Any &&
-                        pSearchState->src0_process != Process_None)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src0 chromasiting mode
+            case RID_IsSrc0Chromasiting:
+                if (pSearchState->Filter->chromasiting == (int32_t)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src0 chromasiting mode
-                case RID_IsSrc0Chromasiting:
-                    if (pSearchState->Filter->chromasiting == (int32_t)pRuleEntry->value)
+            // Match Src1 source format (surface)
+            case RID_IsSrc1Format:
+                if (pRuleEntry->logic == Kdll_Or && bSrc1FormatMatched)
+                {
+                    // Already found matching format in the ruleset
+                    continue;
+                }
+                else
+                {
+                    // Check if the source 1 format matches the rule
+                    // The intermediate colorspace is used to determine
+                    // if palettized input is given in RGB or YUV format.
+                    if (KernelDll_IsFormat(pSearchState->src1_format,
+                                            pSearchState->cspace,
+                                            (MOS_FORMAT) pRuleEntry->value))
                     {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
+                        bSrc1FormatMatched = true;
                     }
 
-                // Match Src1 source format (surface)
-                case RID_IsSrc1Format:
-                    if (pRuleEntry->logic == Kdll_Or && bSrc1FormatMatched)
+                    if (pRuleEntry->logic == Kdll_None && !bSrc1FormatMatched)
                     {
-                        // Already found matching format in the ruleset
-                        continue;
+                        // Last entry and No matching format was found
+                        break;
                     }
                     else
-                    {
-                        // Check if the source 1 format matches the rule
-                        // The intermediate colorspace is used to determine
-                        // if palettized input is given in RGB or YUV format.
-                        if (KernelDll_IsFormat(pSearchState->src1_format,
-                                                pSearchState->cspace,
-                                                (MOS_FORMAT) pRuleEntry->value))
-                        {
-                            bSrc1FormatMatched = true;
-                        }
-
-                        if (pRuleEntry->logic == Kdll_None && !bSrc1FormatMatched)
-                        {
-                            // Last entry and No matching format was found
-                            break;
-                        }
-                        else
-                        {
-                            continue;
-                        }
-                    }
-                // Match Src1 sampling mode
-                case RID_IsSrc1Sampling:
-                    if (pSearchState->src1_sampling == (Kdll_Sampling) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else if ((Kdll_Sampling) pRuleEntry->value == Sample_Any &&
-                            pSearchState->src1_sampling != Sample_None)
                     {
                         continue;
                     }
-                    else
-                    {
-                        break;
-                    }
+                }
+            // Match Src1 sampling mode
+            case RID_IsSrc1Sampling:
+                if (pSearchState->src1_sampling == (Kdll_Sampling) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else if ((Kdll_Sampling) pRuleEntry->value == Sample_Any &&
+                        pSearchState->src1_sampling != Sample_None)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src1 Luma Key
-                case RID_IsSrc1LumaKey:
-                    if (pSearchState->src1_lumakey == (int32_t)pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src1 Luma Key
+            case RID_IsSrc1LumaKey:
+                if (pSearchState->src1_lumakey == (int32_t)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src1 Procamp
-                case RID_IsSrc1Procamp:
-                    if (pSearchState->pFilter->procamp == (int32_t)pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src1 Procamp
+            case RID_IsSrc1Procamp:
+                if (pSearchState->pFilter->procamp == (int32_t)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src1 internal pixel format
-                case RID_IsSrc1Internal:
-                    // match
-                    if (pSearchState->src1_internal == (Kdll_IntFormat) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    // any format, but not empty
-                    else if ((Kdll_IntFormat) pRuleEntry->value == Internal_Any &&
-                            pSearchState->src1_internal != Internal_None)
-                    {
-                        continue;
-                    }
-                    // src1 and src0 have same internal format
-                    else if ((Kdll_IntFormat) pRuleEntry->value == Internal_SameSrc0 &&
-                            pSearchState->src0_internal == pSearchState->src1_internal)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src1 internal pixel format
+            case RID_IsSrc1Internal:
+                // match
+                if (pSearchState->src1_internal == (Kdll_IntFormat) pRuleEntry->value)
+                {
+                    continue;
+                }
+                // any format, but not empty
+                else if ((Kdll_IntFormat) pRuleEntry->value == Internal_Any &&
+                        pSearchState->src1_internal != Internal_None)
+                {
+                    continue;
+                }
+                // src1 and src0 have same internal format
+                else if ((Kdll_IntFormat) pRuleEntry->value == Internal_SameSrc0 &&
+                        pSearchState->src0_internal == pSearchState->src1_internal)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src1 CSC coefficients
-                case RID_IsSrc1Coeff:
-                    if (pSearchState->src1_coeff == (Kdll_CoeffID) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else if ((Kdll_CoeffID) pRuleEntry->value == CoeffID_Any &&
-                            pSearchState->src1_coeff != CoeffID_None)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src1 CSC coefficients
+            case RID_IsSrc1Coeff:
+                if (pSearchState->src1_coeff == (Kdll_CoeffID) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else if ((Kdll_CoeffID) pRuleEntry->value == CoeffID_Any &&
+                        pSearchState->src1_coeff != CoeffID_None)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src1 processing mode
-                case RID_IsSrc1Processing:
-                    if (pSearchState->src1_process == (Kdll_Processing) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    if ((Kdll_Processing) pRuleEntry->value == Process_Any &&
-                        pSearchState->src1_process != Process_None)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src1 processing mode
+            case RID_IsSrc1Processing:
+                if (pSearchState->src1_process == (Kdll_Processing) pRuleEntry->value)
+                {
+                    continue;
+                }
+                if ((Kdll_Processing) pRuleEntry->value == Process_Any &&
+                    pSearchState->src1_process != Process_None)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Src1 chromasiting mode
-                case RID_IsSrc1Chromasiting:
-                    //pSearchState->pFilter is pointed to the real sub layer
-                    if (pSearchState->pFilter->chromasiting == (int32_t)pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Match Src1 chromasiting mode
+            case RID_IsSrc1Chromasiting:
+                //pSearchState->pFilter is pointed to the real sub layer
+                if (pSearchState->pFilter->chromasiting == (int32_t)pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
+
+            // Match Layer number
+            case RID_IsLayerNumber:
+                if (pSearchState->layer_number == (int32_t) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
+
+            // Match quadrant
+            case RID_IsQuadrant:
+                if (pSearchState->quadrant == (int32_t) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
+
+            // Set CSC flag before Mix
+            case RID_IsCSCBeforeMix:
+                if (pSearchState->bCscBeforeMix == (pRuleEntry->value ? true : false))
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
+
+            case RID_IsDualOutput:
+                if (pSearchState->pFilter->dualout == (pRuleEntry->value ? true : false))
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                // Match Layer number
-                case RID_IsLayerNumber:
-                    if (pSearchState->layer_number == (int32_t) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
+            case RID_IsTargetFormat:
+                if (pRuleEntry->logic == Kdll_Or && bTargetFormatMatched)
+                {
+                    // Already found matching format in the ruleset
+                    continue;
+                }
+                else
+                {
+                    if (pSearchState->target_format == (MOS_FORMAT) pRuleEntry->value)
                     {
-                        break;
+                        bTargetFormatMatched = true;
                     }
 
-                // Match quadrant
-                case RID_IsQuadrant:
-                    if (pSearchState->quadrant == (int32_t) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
+                    if (pRuleEntry->logic == Kdll_None && !bTargetFormatMatched)
                     {
+                        // Last entry and No matching format was found
                         break;
                     }
-
-                // Set CSC flag before Mix
-                case RID_IsCSCBeforeMix:
-                    if (pSearchState->bCscBeforeMix == (pRuleEntry->value ? true : false))
-                    {
-                        continue;
-                    }
                     else
-                    {
-                        break;
-                    }
-
-                case RID_IsDualOutput:
-                    if (pSearchState->pFilter->dualout == (pRuleEntry->value ? true : false))
                     {
                         continue;
                     }
-                    else
-                    {
-                        break;
-                    }
+                }
 
-                case RID_IsTargetFormat:
-                    if (pRuleEntry->logic == Kdll_Or && bTargetFormatMatched)
-                    {
-                        // Already found matching format in the ruleset
-                        continue;
-                    }
-                    else
-                    {
-                        if (pSearchState->target_format == (MOS_FORMAT) pRuleEntry->value)
-                        {
-                            bTargetFormatMatched = true;
-                        }
+            case RID_Is64BSaveEnabled:
+                if (pSearchState->b64BSaveEnabled == (pRuleEntry->value ? true : false))
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                        if (pRuleEntry->logic == Kdll_None && !bTargetFormatMatched)
-                        {
-                            // Last entry and No matching format was found
-                            break;
-                        }
-                        else
-                        {
-                            continue;
-                        }
-                    }
+            case RID_IsTargetTileType:
+                if (pRuleEntry->logic == Kdll_None &&
+                    pSearchState->target_tiletype == (MOS_TILE_TYPE) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else if (pRuleEntry->logic == Kdll_Not &&
+                         pSearchState->target_tiletype != (MOS_TILE_TYPE) pRuleEntry->value)
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                case RID_Is64BSaveEnabled:
-                    if (pSearchState->b64BSaveEnabled == (pRuleEntry->value ? true : false))
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            case RID_IsProcampEnabled:
+                if (pSearchState->bProcamp == (pRuleEntry->value ? true : false))
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                case RID_IsTargetTileType:
-                    if (pRuleEntry->logic == Kdll_None &&
-                        pSearchState->target_tiletype == (MOS_TILE_TYPE) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else if (pRuleEntry->logic == Kdll_Not &&
-                             pSearchState->target_tiletype != (MOS_TILE_TYPE) pRuleEntry->value)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            case RID_IsConstOutAlpha:
+                if (pSearchState->pFilter->bFillOutputAlphaWithConstant == (pRuleEntry->value ? true : false))
+                {
+                    continue;
+                }
+                else
+                {
+                    break;
+                }
 
-                case RID_IsProcampEnabled:
-                    if (pSearchState->bProcamp == (pRuleEntry->value ? true : false))
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+            // Undefined search rule will fail
+            default:
+                VPHAL_RENDER_ASSERTMESSAGE("Invalid rule %d @ layer %d, state %d.", pRuleEntry->id, pSearchState->layer_number, pSearchState->state);
+                break;
+        }  // End of switch to deal with all matching rule IDs
 
-                case RID_IsConstOutAlpha:
-                    if (pSearchState->pFilter->bFillOutputAlphaWithConstant == (pRuleEntry->value ? true : false))
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        break;
-                    }
+        // Rule didn't match - try another RuleSet
+        break;
+    } // End of loop to test all rules for the current RuleSet
 
-                // Undefined search rule will fail
-                default:
-                    VPHAL_RENDER_ASSERTMESSAGE("Invalid rule %d @ layer %d, state %d.", pRuleEntry->id, pSearchState->layer_number, pSearchState->state);
-                    break;
-            }  // End of switch to deal with all matching rule IDs
+    return (iMatchCount == 0);
+}
 
-            // Rule didn't match - try another RuleSet
-            break;
-        } // End of file loop to test all rules for the current RuleSet
+/*----------------------------------------------------------------------------
+| Name      : KernelDll_IsFormatInMask
+| Purpose   : Check if a format may match a compiled rule set format mask
+|
+| Input     : pMask  - format mask (DL_RULE_FORMAT_MASK_SIZE dwords)
+|             format - format to check
+|
+| Return    : false only if the format cannot match the rule set
+\---------------------------------------------------------------------------*/
+static inline bool KernelDll_IsFormatInMask(const uint32_t *pMask, MOS_FORMAT format)
+{
+    int32_t slot;
+
+    // Formats outside of the compiled range are evaluated by the rule set itself
+    if (format < Format_None || format >= Format_Count)
+    {
+        return true;
+    }
+
+    slot = format - Format_None;
+    return ((pMask[slot >> 5] >> (slot & 31)) & 1) ? true : false;
+}
+
+/*----------------------------------------------------------------------------
+| Name      : KernelDll_FindRule
+| Purpose   : Find a rule that matches the current search/input state
+|
+| Input     : pState       - Kernel Dll state
+|             pSearchState - current DL search state
+|
+| Return    :
+\---------------------------------------------------------------------------*/
+bool KernelDll_FindRule(
+    Kdll_State       *pState,
+    Kdll_SearchState *pSearchState)
+{
+    uint32_t parser_state = (uint32_t)pSearchState->state;
+    Kdll_RuleEntrySet    *pRuleSet;
+    Kdll_RuleEntrySet    *pMatchingRuleSet = nullptr;
+    const Kdll_RuleSetMask *pMasks;
+    const int32_t        *pOffset;
+    MOS_FORMAT           layer_format;
+    int32_t              iRuleCount;
+    int32_t              i, j;
+
+    VPHAL_RENDER_FUNCTION_ENTER;
+
+    // All Custom states are handled as a single group
+    if (parser_state >= Parser_Custom)
+    {
+        parser_state = Parser_Custom;
+    }
+
+    pRuleSet   = pState->pDllRuleTable[parser_state];
+    iRuleCount = pState->iDllRuleCount[parser_state];
+
+    if (pRuleSet == nullptr || iRuleCount == 0)
+    {
+        VPHAL_RENDER_NORMALMESSAGE("Search rules undefined.");
+        pSearchState->pMatchingRuleSet = nullptr;
+        return false;
+    }
+
+    if (pState->pRuleIndex &&
+        pSearchState->src0_format >= Format_None &&
+        pSearchState->src0_format <  Format_Count)
+    {
+        // Compiled search - only visit rule sets that may match the current formats
+        pOffset      = pState->pRuleIndexOffset +
+                       parser_state * DL_RULE_INDEX_FORMATS + (pSearchState->src0_format - Format_None);
+        pMasks       = pState->pRuleSetMasks + (pRuleSet - pState->pSortedRules);
+        layer_format = pSearchState->pFilter ? pSearchState->pFilter->format : Format_Invalid;
 
-        // Match
-        if (iMatchCount == 0)
+        for (i = pOffset[0]; i < pOffset[1]; i++)
         {
-            pSearchState->pMatchingRuleSet = pRuleSet;
-            return true;
+            j = pState->pRuleIndex[i];
+
+            if (KernelDll_IsFormatInMask(pMasks[j].Src1Format, pSearchState->src1_format) &&
+                KernelDll_IsFormatInMask(pMasks[j].LayerFormat, layer_format) &&
+                KernelDll_MatchRuleSet(pSearchState, pRuleSet + j))
+            {
+                pMatchingRuleSet = pRuleSet + j;
+                break;
+            }
         }
-    }   // End of for loop to test all RuleSets for the current parser state
+    }
+    else
+    {
+        // Search matching entry
+        for ( ; iRuleCount > 0; iRuleCount--, pRuleSet++)
+        {
+            if (KernelDll_MatchRuleSet(pSearchState, pRuleSet))
+            {
+                pMatchingRuleSet = pRuleSet;
+                break;
+            }
+        }   // End of for loop to test all RuleSets for the current parser state
+    }
+
+    // Match
+    if (pMatchingRuleSet)
+    {
+        pSearchState->pMatchingRuleSet = pMatchingRuleSet;
+        return true;
+    }
 
     // Failed to find a matching rule -> kernel search will fail
     VPHAL_RENDER_NORMALMESSAGE("Fail to find a matching rule @ layer %d, state %d.", pSearchState->layer_number, pSearchState->state);
@@ -2940,6 +3018,164 @@ bool KernelDll_UpdateState(
     return true;
 }
 
+//-----------------------------------------------------------------------------------------
+// KernelDll_GetRuleFormatMask - Get formats that may satisfy a format condition of a rule set
+//
+// Parameters:
+//    Kdll_RuleEntrySet *pRuleSet - [in]  Rule set
+//    Kdll_RuleID        id       - [in]  Format condition (RID_IsLayerFormat, RID_IsSrc0Format, RID_IsSrc1Format)
+//    uint32_t          *pMask    - [out] Format mask
+//
+// Output: none
+//-----------------------------------------------------------------------------------------
+static void KernelDll_GetRuleFormatMask(
+    const Kdll_RuleEntrySet *pRuleSet,
+    Kdll_RuleID              id,
+    uint32_t                *pMask)
+{
+    const Kdll_RuleEntry *pRuleEntry;
+    int32_t              iMatchCount;
+    int32_t              format;
+    int32_t              slot;
+    bool                 bRequired = false;
+
+    MOS_ZeroMemory(pMask, DL_RULE_FORMAT_MASK_SIZE * sizeof(uint32_t));
+
+    pRuleEntry = pRuleSet->pRuleEntry;
+    for (iMatchCount = pRuleSet->iMatchCount; iMatchCount > 0; iMatchCount--, pRuleEntry++)
+    {
+        if (pRuleEntry->id != id)
+        {
+            continue;
+        }
+
+        // Only the last entry of an "Or" list fails the rule set
+        if (pRuleEntry->logic == Kdll_None)
+        {
+            bRequired = true;
+        }
+
+        // Palettized formats depend on color space - accept both RGB and YUV
+        for (format = Format_None; format < Format_Count; format++)
+        {
+            if (KernelDll_IsFormat((MOS_FORMAT)format, CSpace_sRGB,  (MOS_FORMAT)pRuleEntry->value) ||
+                KernelDll_IsFormat((MOS_FORMAT)format, CSpace_BT601, (MOS_FORMAT)pRuleEntry->value))
+            {
+                slot = format - Format_None;
+                pMask[slot >> 5] |= (1u << (slot & 31));
+            }
+        }
+    }
+
+    if (!bRequired)
+    {
+        // Format is not a condition of this rule set
+        MOS_FillMemory(pMask, DL_RULE_FORMAT_MASK_SIZE * sizeof(uint32_t), 0xff);
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+// KernelDll_CompileRuleTable - Compile sorted rule table into a format dispatch table
+//
+//    For each parser state and Src0 format, build the ordered list of rule sets whose
+//    format conditions may be satisfied. Candidates are still fully evaluated in the
+//    sorted order, so the selected rule set is the same as with a linear search.
+//
+// Parameters:
+//    char  *pState    - [in] Kernel Dll state
+//
+// Output: true  - Rule table successfully compiled
+//         false - Failed to compile rule table (linear search is used)
+//-----------------------------------------------------------------------------------------
+static bool KernelDll_CompileRuleTable(Kdll_State *pState)
+{
+    Kdll_RuleSetMask *pMasks;
+    int32_t           iTotal;
+    int32_t           iCandidates;
+    int32_t           iBase;
+    int32_t           state, slot, i;
+
+    VPHAL_RENDER_FUNCTION_ENTER;
+
+    iTotal = 0;
+    for (state = 0; state < Parser_Count; state++)
+    {
+        iTotal += pState->iDllRuleCount[state];
+    }
+
+    if (iTotal == 0 || iTotal > 0xffff)
+    {
+        return false;
+    }
+
+    // Format masks for each rule set
+    pState->pRuleSetMasks = (Kdll_RuleSetMask *)MOS_AllocAndZeroMemory(iTotal * sizeof(Kdll_RuleSetMask));
+    if (!pState->pRuleSetMasks)
+    {
+        VPHAL_RENDER_ASSERTMESSAGE("Failed to allocate rule set masks.");
+        return false;
+    }
+
+    for (i = 0; i < iTotal; i++)
+    {
+        pMasks = pState->pRuleSetMasks + i;
+        KernelDll_GetRuleFormatMask(pState->pSortedRules + i, RID_IsLayerFormat, pMasks->LayerFormat);
+        KernelDll_GetRuleFormatMask(pState->pSortedRules + i, RID_IsSrc0Format,  pMasks->Src0Format);
+        KernelDll_GetRuleFormatMask(pState->pSortedRules + i, RID_IsSrc1Format,  pMasks->Src1Format);
+    }
+
+    // Count candidates for each parser state and Src0 format
+    iCandidates = 0;
+    for (state = 0; state < Parser_Count; state++)
+    {
+        iBase  = (int32_t)(pState->pDllRuleTable[state] - pState->pSortedRules);
+        pMasks = pState->pRuleSetMasks + iBase;
+        for (slot = 0; slot < DL_RULE_INDEX_FORMATS; slot++)
+        {
+            for (i = 0; i < pState->iDllRuleCount[state]; i++)
+            {
+                if ((pMasks[i].Src0Format[slot >> 5] >> (slot & 31)) & 1)
+                {
+                    iCandidates++;
+                }
+            }
+        }
+    }
+
+    pState->pRuleIndexOffset = (int32_t *)MOS_AllocAndZeroMemory((Parser_Count * DL_RULE_INDEX_FORMATS + 1) * sizeof(int32_t));
+    pState->pRuleIndex       = (uint16_t *)MOS_AllocAndZeroMemory((iCandidates + 1) * sizeof(uint16_t));
+    if (!pState->pRuleIndexOffset || !pState->pRuleIndex)
+    {
+        VPHAL_RENDER_ASSERTMESSAGE("Failed to allocate compiled rule table.");
+        MOS_FreeMemAndSetNull(pState->pRuleIndexOffset);
+        MOS_FreeMemAndSetNull(pState->pRuleIndex);
+        MOS_FreeMemAndSetNull(pState->pRuleSetMasks);
+        return false;
+    }
+
+    // Fill candidate lists, preserving the sorted rule order
+    iCandidates = 0;
+    for (state = 0; state < Parser_Count; state++)
+    {
+        iBase  = (int32_t)(pState->pDllRuleTable[state] - pState->pSortedRules);
+        pMasks = pState->pRuleSetMasks + iBase;
+        for (slot = 0; slot < DL_RULE_INDEX_FORMATS; slot++)
+        {
+            pState->pRuleIndexOffset[state * DL_RULE_INDEX_FORMATS + slot] = iCandidates;
+            for (i = 0; i < pState->iDllRuleCount[state]; i++)
+            {
+                if ((pMasks[i].Src0Format[slot >> 5] >> (slot & 31)) & 1)
+                {
+                    pState->pRuleIndex[iCandidates++] = (uint16_t)i;
+                }
+            }
+        }
+    }
+    pState->pRuleIndexOffset[Parser_Count * DL_RULE_INDEX_FORMATS] = iCandidates;
+
+    return true;
+}
+
 //-----------------------------------------------------------------------------------------
 // KernelDll_SortRuleTable - Sort master dynamic linking rule table
 //
@@ -2974,6 +3210,11 @@ bool KernelDll_SortRuleTable(Kdll_State *pState)
         MOS_ZeroMemory(pState->iDllRuleCount, sizeof(pState->iDllRuleCount));
     }
 
+    // Release compiled rule table
+    MOS_FreeMemAndSetNull(pState->pRuleSetMasks);
+    MOS_FreeMemAndSetNull(pState->pRuleIndex);
+    MOS_FreeMemAndSetNull(pState->pRuleIndexOffset);
+
     // Zero counters
     MOS_ZeroMemory(iNoOverr, sizeof(iNoOverr));
     MOS_ZeroMemory(iDefault, sizeof(iDefault));
@@ -3177,6 +3418,12 @@ bool KernelDll_SortRuleTable(Kdll_State *pState)
         }
     }
 
+    // Compile rule table for fast search (linear search is used on failure)
+    if (!KernelDll_CompileRuleTable(pState))
+    {
+        VPHAL_RENDER_NORMALMESSAGE("Rule table not compiled, using linear search.");
+    }
+
     // Rule table is now sorted and integrated with custom rules
     return true;
 }
@@ -3497,6 +3744,9 @@ void KernelDll_ReleaseStates(Kdll_State *pState)
     MOS_FreeMemory(pState->ComponentKernelCache.pCache);
     MOS_FreeMemory(pState->CmFcPatchCache.pCache);
     MOS_FreeMemory(pState->pSortedRules);
+    MOS_FreeMemory(pState->pRuleSetMasks);
+    MOS_FreeMemory(pState->pRuleIndex);
+    MOS_FreeMemory(pState->pRuleIndexOffset);
     MOS_FreeMemory(pState);
 }
 
@@ -378,6 +378,18 @@ typedef struct tagKdll_RuleEntrySet
     uint32_t              iSetCount   : 12;   // Size of Set Rules (including variable length rules)
 } Kdll_RuleEntrySet;
 
+// Compiled rule table - formats are indexed from Format_None to Format_Count - 1
+#define DL_RULE_INDEX_FORMATS       (Format_Count - Format_None)
+#define DL_RULE_FORMAT_MASK_SIZE    ((DL_RULE_INDEX_FORMATS + 31) / 32)
+
+// Formats that may satisfy the format conditions of a rule set
+typedef struct tagKdll_RuleSetMask
+{
+    uint32_t LayerFormat[DL_RULE_FORMAT_MASK_SIZE];   // Layer formats that may match
+    uint32_t Src0Format [DL_RULE_FORMAT_MASK_SIZE];   // Src0 formats that may match
+    uint32_t Src1Format [DL_RULE_FORMAT_MASK_SIZE];   // Src1 formats that may match
+} Kdll_RuleSetMask;
+
 // Structure that defines a set of procamp parameters
 typedef struct tagKdll_Procamp
 {
@@ -617,6 +629,11 @@ typedef struct tagKdll_State
     Kdll_RuleEntrySet       *pDllRuleTable[Parser_Count]; // Rule acceleration table (one entry for each Parser State)
     int                     iDllRuleCount[Parser_Count]; // Rule count (number of entries for each Parser State)
 
+    // Compiled rule table (candidate rule sets for each Parser State, dispatched on Src0 format)
+    Kdll_RuleSetMask        *pRuleSetMasks;         // Format masks (one for each entry of pSortedRules)
+    uint16_t                *pRuleIndex;            // Candidate rule sets (relative to pDllRuleTable[state])
+    int32_t                 *pRuleIndexOffset;      // Start of candidates for [state][format], last entry is the total
+
     // Combined kernel cache and hash table
     Kdll_KernelCache        KernelCache;            // Output kernel cache
     Kdll_KernelHashTable    KernelHashTable;        // Hash table for resulting kernels
@@ -770,6 +787,9 @@ bool KernelDll_MapCSCMatrix(
     const float      *matrix,
     short            *coeff);
 
+// Sort the rule tables and compile the rule search index
+bool KernelDll_SortRuleTable(Kdll_State *pState);
+
 // Kernel Rule Search / State Update
 bool KernelDll_FindRule(
     Kdll_State       *pState,
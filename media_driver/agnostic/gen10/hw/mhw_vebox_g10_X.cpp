@@ -1093,6 +1093,9 @@ MOS_STATUS MhwVeboxInterfaceG10::AddVeboxGamutState(
     MHW_CHK_NULL(pVeboxGamutParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
@@ -1885,6 +1888,9 @@ MOS_STATUS MhwVeboxInterfaceG10::AddVeboxIecpAceState(
     MHW_CHK_NULL(pVeboxIecpParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
@@ -33,6 +33,9 @@ CodechalDecodeJpegG11::~CodechalDecodeJpegG11()
 {
     CODECHAL_DECODE_FUNCTION_ENTER;
 
+    // Submit while the VE hint can still be populated
+    SubmitPendingPictures();
+
     if (m_veState != nullptr)
     {
         MOS_FreeMemAndSetNull(m_veState);
@@ -142,13 +145,7 @@ MOS_STATUS CodechalDecodeJpegG11::DecodeStateLevel()
     }
 
     MOS_COMMAND_BUFFER cmdBuffer;
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnGetCommandBuffer(
-        m_osInterface,
-        &cmdBuffer,
-        0));
-
-    CODECHAL_DECODE_CHK_STATUS_RETURN(SendPrologWithFrameTracking(
-        &cmdBuffer, true));
+    CODECHAL_DECODE_CHK_STATUS_RETURN(GetPictureCommandBuffer(&cmdBuffer));
 
     // Set PIPE_MODE_SELECT
     MHW_VDBOX_PIPE_MODE_SELECT_PARAMS pipeModeSelectParams;
@@ -275,128 +272,7 @@ MOS_STATUS CodechalDecodeJpegG11::DecodePrimitiveLevel()
         &cmdBuffer,
         0));
 
-    // MFX_QM_STATE_CMD
-    MHW_VDBOX_QM_PARAMS qmParams;
-    MOS_ZeroMemory(&qmParams, sizeof(qmParams));
-    qmParams.Standard = CODECHAL_JPEG;
-    qmParams.pJpegQuantMatrix = (CodecJpegQuantMatrix *)m_jpegQMatrix;
-
-    // Swapping QM(x,y) to QM(y,x) for 90/270 degree rotation
-    if ((m_jpegPicParams->m_rotation == jpegRotation90) ||
-        (m_jpegPicParams->m_rotation == jpegRotation270))
-    {
-        qmParams.bJpegQMRotation = true;
-    }
-    else
-    {
-        qmParams.bJpegQMRotation = false;
-    }
-
-    for (uint16_t scanCount = 0; scanCount < m_jpegPicParams->m_numCompInFrame; scanCount++)
-    {
-        // Using scanCount here because the same command is used for JPEG decode and encode
-        uint32_t quantTableSelector                                      = m_jpegPicParams->m_quantTableSelector[scanCount];
-        qmParams.pJpegQuantMatrix->m_jpegQMTableType[quantTableSelector] = scanCount;
-        qmParams.JpegQMTableSelector = quantTableSelector;
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxQmCmd(
-            &cmdBuffer,
-            &qmParams));
-    }
-
-    uint32_t dcCurHuffTblIndex[2] = { 0xff, 0xff };
-    uint32_t acCurHuffTblIndex[2] = { 0xff, 0xff };
-
-    for (uint16_t scanCount = 0; scanCount < m_jpegScanParams->NumScans; scanCount++)
-    {
-        // MFX_JPEG_HUFF_TABLE
-        uint16_t numComponents = m_jpegScanParams->ScanHeader[scanCount].NumComponents;
-        for (uint16_t scanComponent = 0; scanComponent < numComponents; scanComponent++)
-        {
-            // Determine which huffman table we will be writing to
-            // For gray image, componentIdentifier[jpegComponentU] and componentIdentifier[jpegComponentV] are initialized to 0,
-            // and when componentSelector[scanComponent] is equal 0, variable huffTableID is set to 1, and wrong Huffman table is used,
-            // so it is more reasonable to use componentIdentifier[jpegComponentY] to determine which huffman table we will be writing to.
-            uint8_t componentSelector =
-                m_jpegScanParams->ScanHeader[scanCount].ComponentSelector[scanComponent];
-            uint16_t huffTableID = 0;
-            if (componentSelector == m_jpegPicParams->m_componentIdentifier[jpegComponentY])
-            {
-                huffTableID = 0;
-            }
-            else
-            {
-                huffTableID = 1;
-            }
-
-            int32_t acTableSelector =
-                m_jpegScanParams->ScanHeader[scanCount].AcHuffTblSelector[scanComponent];
-            int32_t dcTableSelector =
-                m_jpegScanParams->ScanHeader[scanCount].DcHuffTblSelector[scanComponent];
-
-            // Send the huffman table state command only if the table changed
-            if ((dcTableSelector != dcCurHuffTblIndex[huffTableID]) ||
-                (acTableSelector != acCurHuffTblIndex[huffTableID]))
-            {
-                MHW_VDBOX_HUFF_TABLE_PARAMS huffmanTableParams;
-                MOS_ZeroMemory(&huffmanTableParams, sizeof(huffmanTableParams));
-
-                huffmanTableParams.HuffTableID = huffTableID;
-
-                huffmanTableParams.pACBits   = &m_jpegHuffmanTable->HuffTable[acTableSelector].AC_BITS[0];
-                huffmanTableParams.pDCBits   = &m_jpegHuffmanTable->HuffTable[dcTableSelector].DC_BITS[0];
-                huffmanTableParams.pACValues = &m_jpegHuffmanTable->HuffTable[acTableSelector].AC_HUFFVAL[0];
-                huffmanTableParams.pDCValues = &m_jpegHuffmanTable->HuffTable[dcTableSelector].DC_HUFFVAL[0];
-
-                CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxJpegHuffTableCmd(
-                    &cmdBuffer,
-                    &huffmanTableParams));
-
-                // Set the current huffman table indices for the next scan
-                dcCurHuffTblIndex[huffTableID] = dcTableSelector;
-                acCurHuffTblIndex[huffTableID] = acTableSelector;
-            }
-        }
-
-        MHW_VDBOX_JPEG_BSD_PARAMS jpegBsdObject;
-        MOS_ZeroMemory(&jpegBsdObject, sizeof(jpegBsdObject));
-
-        // MFX_JPEG_BSD_OBJECT
-        jpegBsdObject.dwIndirectDataLength     = m_jpegScanParams->ScanHeader[scanCount].DataLength;
-        jpegBsdObject.dwDataStartAddress       = m_jpegScanParams->ScanHeader[scanCount].DataOffset;
-        jpegBsdObject.dwScanHorizontalPosition = m_jpegScanParams->ScanHeader[scanCount].ScanHoriPosition;
-        jpegBsdObject.dwScanVerticalPosition   = m_jpegScanParams->ScanHeader[scanCount].ScanVertPosition;
-        jpegBsdObject.bInterleaved = (numComponents > 1) ? 1 : 0;
-        jpegBsdObject.dwMCUCount               = m_jpegScanParams->ScanHeader[scanCount].MCUCount;
-        jpegBsdObject.dwRestartInterval        = m_jpegScanParams->ScanHeader[scanCount].RestartInterval;
-
-        uint16_t scanComponentIndex = 0;
-
-        for (uint16_t scanComponent = 0; scanComponent < numComponents; scanComponent++)
-        {
-            uint8_t componentSelector =
-                m_jpegScanParams->ScanHeader[scanCount].ComponentSelector[scanComponent];
-
-            if (componentSelector == m_jpegPicParams->m_componentIdentifier[jpegComponentY])
-            {
-                scanComponentIndex = 0;
-            }
-            else if (componentSelector == m_jpegPicParams->m_componentIdentifier[jpegComponentU])
-            {
-                scanComponentIndex = 1;
-            }
-            else if (componentSelector == m_jpegPicParams->m_componentIdentifier[jpegComponentV])
-            {
-                scanComponentIndex = 2;
-            }
-            // Add logic for component identifier JPEG_A
-
-            jpegBsdObject.sScanComponent |= (1 << scanComponentIndex);
-        }
-
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_mfxInterface->AddMfxJpegBsdObjCmd(
-            &cmdBuffer,
-            &jpegBsdObject));
-    }
+    CODECHAL_DECODE_CHK_STATUS_RETURN(AddPictureDecodeCmds(&cmdBuffer));
 
     // Check if destination surface needs to be synchronized
     MOS_SYNC_PARAMS syncParams = g_cInitSyncParams;
@@ -442,48 +318,7 @@ MOS_STATUS CodechalDecodeJpegG11::DecodePrimitiveLevel()
             &cmdBuffer));
     }
 
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_miInterface->AddMiBatchBufferEnd(
-        &cmdBuffer,
-        nullptr));
-
-    m_osInterface->pfnReturnCommandBuffer(m_osInterface, &cmdBuffer, 0);
-
-    CODECHAL_DEBUG_TOOL(
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_debugInterface->DumpCmdBuffer(
-            &cmdBuffer,
-            CODECHAL_NUM_MEDIA_STATES,
-            "_DEC"));
-    )
-
-    if (m_copiedDataBufferInUse)
-    {
-        //Sync up complete frame
-        syncParams                  = g_cInitSyncParams;
-        syncParams.GpuContext       = m_videoContextForWa;
-        syncParams.presSyncResource = &m_resSyncObjectWaContextInUse;
-
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnEngineSignal(
-            m_osInterface,
-            &syncParams));
-
-        syncParams                  = g_cInitSyncParams;
-        syncParams.GpuContext       = m_videoContext;
-        syncParams.presSyncResource = &m_resSyncObjectWaContextInUse;
-
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnEngineWait(
-            m_osInterface,
-            &syncParams));
-        }
-
-    if ( MOS_VE_SUPPORTED(m_osInterface))
-    {
-        CodecHalDecodeSinglePipeVE_PopulateHintParams(m_veState, &cmdBuffer, true);
-    }
-
-    CODECHAL_DECODE_CHK_STATUS_RETURN(m_osInterface->pfnSubmitCommandBuffer(
-        m_osInterface,
-        &cmdBuffer,
-        m_videoContextUsesNullHw));
+    CODECHAL_DECODE_CHK_STATUS_RETURN(SubmitPicture(&cmdBuffer));
 
     CODECHAL_DEBUG_TOOL(
         m_mmc->UpdateUserFeatureKey(&m_destSurface);)
@@ -502,15 +337,32 @@ MOS_STATUS CodechalDecodeJpegG11::DecodePrimitiveLevel()
         m_osInterface,
         &syncParams));
 
+    // A batched picture is only decoded once its command buffer is submitted
     CODECHAL_DEBUG_TOOL(
-        CODECHAL_DECODE_CHK_STATUS_RETURN(m_debugInterface->DumpYUVSurface(
-            &m_destSurface,
-            CodechalDbgAttr::attrDecodeOutputSurface,
-            "DstSurf"));)
+        if (m_numPendingPictures == 0)
+        {
+            CODECHAL_DECODE_CHK_STATUS_RETURN(m_debugInterface->DumpYUVSurface(
+                &m_destSurface,
+                CodechalDbgAttr::attrDecodeOutputSurface,
+                "DstSurf"));
+        })
     return eStatus;
 
 }
 
+MOS_STATUS CodechalDecodeJpegG11::SubmitCommandBuffer(
+    PMOS_COMMAND_BUFFER cmdBuffer)
+{
+    CODECHAL_DECODE_FUNCTION_ENTER;
+
+    if ( MOS_VE_SUPPORTED(m_osInterface))
+    {
+        CodecHalDecodeSinglePipeVE_PopulateHintParams(m_veState, cmdBuffer, true);
+    }
+
+    return CodechalDecodeJpeg::SubmitCommandBuffer(cmdBuffer);
+}
+
 MOS_STATUS CodechalDecodeJpegG11::AllocateStandard(
     CodechalSetting *          settings)
 {
@@ -89,6 +89,16 @@ protected:
     //!           MOS_STATUS_SUCCESS if success, else fail reason
     //!
     MOS_STATUS SetGpuCtxCreatOption(CodechalSetting * settings) override;
+
+    //!
+    //! \brief    Populate the VE hint and submit a command buffer to the video context
+    //! \param    [in] cmdBuffer
+    //!           Command buffer
+    //!
+    //! \return   MOS_STATUS
+    //!           MOS_STATUS_SUCCESS if success, else fail reason
+    //!
+    MOS_STATUS SubmitCommandBuffer(PMOS_COMMAND_BUFFER cmdBuffer) override;
     
     PCODECHAL_DECODE_SINGLEPIPE_VIRTUALENGINE_STATE m_veState = nullptr;  //!< single pipe virtual engine state
 };
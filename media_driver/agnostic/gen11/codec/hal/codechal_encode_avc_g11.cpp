@@ -4342,7 +4342,7 @@ MOS_STATUS CodechalEncodeAvcEncG11::MbEncKernel(bool mbEncIFrameDistInUse)
                 &initMbBrcConstantDataBufferParams.Lambda[0][0]));
         }
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
 
         // dump MbBrcLut
         CODECHAL_DEBUG_TOOL(CODECHAL_ENCODE_CHK_STATUS_RETURN(m_debugInterface->DumpBuffer(
@@ -1206,6 +1206,9 @@ MOS_STATUS MhwVeboxInterfaceG11::AddVeboxGamutState(
     MHW_CHK_NULL(pVeboxGamutParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
@@ -2034,6 +2037,9 @@ MOS_STATUS MhwVeboxInterfaceG11::AddVeboxIecpAceState(
     MHW_CHK_NULL(pVeboxIecpParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
@@ -2492,6 +2498,9 @@ MOS_STATUS MhwVeboxInterfaceG11::SetVeboxChromaParams(
     MHW_CHK_NULL_RETURN(chromaParams);
     MOS_SecureMemcpy(&m_chromaParams, sizeof(MHW_VEBOX_CHROMA_PARAMS), chromaParams, sizeof(MHW_VEBOX_CHROMA_PARAMS));
 
+    // DNDI blocks built before hold the old chroma params
+    ForgetVeboxStates();
+
     return MOS_STATUS_SUCCESS;
 }
 
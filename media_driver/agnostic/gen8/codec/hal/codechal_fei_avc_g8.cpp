@@ -5048,7 +5048,7 @@ MOS_STATUS CodechalEncodeAvcEncFeiG8::EncodeMbEncKernelFunctions()
                 &initMbBrcConstantDataBufferParams.Lambda[0][0]));
         }
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN( InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN( UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
     }
 
     CODECHAL_ENCODE_AVC_MBENC_SURFACE_PARAMS    mbEncSurfaceParams;
@@ -5313,7 +5313,7 @@ MOS_STATUS CodechalEncodeAvcEncFeiG8::PreProcKernel()
         initMbBrcConstantDataBufferParams.bPreProcEnable = true;
         initMbBrcConstantDataBufferParams.bEnableKernelTrellis = bKernelTrellis && m_trellisQuantParams.dwTqEnabled;;
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
     }
     SurfaceIndex    *cmSurfIdx[9];
     for(int i = 0; i < 9; i ++)
@@ -6344,7 +6344,7 @@ MOS_STATUS CodechalEncodeAvcEncFeiG8::PreProcKernel()
         initMbBrcConstantDataBufferParams.bPreProcEnable = true;
         initMbBrcConstantDataBufferParams.bEnableKernelTrellis = bKernelTrellis && m_trellisQuantParams.dwTqEnabled;;
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
     }
 
     // Add binding table
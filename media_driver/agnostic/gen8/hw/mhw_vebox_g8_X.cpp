@@ -907,6 +907,9 @@ MOS_STATUS MhwVeboxInterfaceG8::AddVeboxGamutState(
     MHW_CHK_NULL(pVeboxGamutParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
@@ -1509,6 +1512,9 @@ MOS_STATUS MhwVeboxInterfaceG8::AddVeboxIecpAceState(
     MHW_CHK_NULL(pVeboxIecpParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
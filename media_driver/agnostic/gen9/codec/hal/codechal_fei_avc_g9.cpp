@@ -3216,7 +3216,7 @@ MOS_STATUS CodechalEncodeAvcEncFeiG9::PreProcKernel()
         initMbBrcConstantDataBufferParams.bPreProcEnable = true;
         initMbBrcConstantDataBufferParams.bEnableKernelTrellis = bKernelTrellis && m_trellisQuantParams.dwTqEnabled;;
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
     }
     SurfaceIndex    *cmSurfIdx[9];
     for(int i = 0; i < 9; i ++)
@@ -3565,7 +3565,7 @@ MOS_STATUS CodechalEncodeAvcEncFeiG9::PreProcKernel()
         initMbBrcConstantDataBufferParams.bPreProcEnable = true;
         initMbBrcConstantDataBufferParams.bEnableKernelTrellis = bKernelTrellis && m_trellisQuantParams.dwTqEnabled;;
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN(InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN(UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
     }
 
     // Add binding table
@@ -6938,7 +6938,7 @@ MOS_STATUS CodechalEncodeAvcEncFeiG9::EncodeMbEncKernelFunctions()
                 &initMbBrcConstantDataBufferParams.Lambda[0][0]));
         }
 
-        CODECHAL_ENCODE_CHK_STATUS_RETURN( InitMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
+        CODECHAL_ENCODE_CHK_STATUS_RETURN( UpdateMbBrcConstantDataBuffer(&initMbBrcConstantDataBufferParams));
     }
 
     CODECHAL_ENCODE_AVC_MBENC_SURFACE_PARAMS    mbEncSurfaceParams;
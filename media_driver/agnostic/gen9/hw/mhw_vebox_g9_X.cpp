@@ -436,7 +436,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
     MHW_RESOURCE_PARAMS             ResourceParams;
     PMHW_VEBOX_HEAP                 pVeboxHeap;
     MOS_ALLOC_GFXRES_PARAMS         AllocParamsForBufferLinear;
-    mhw_vebox_g9_X::VEBOX_STATE_CMD cmd;
+    mhw_vebox_g9_X::VEBOX_STATE_CMD *cmd = nullptr;
 
     MHW_CHK_NULL(m_osInterface);
     MHW_CHK_NULL(pCmdBuffer);
@@ -447,8 +447,11 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
     pOsInterface = m_osInterface;
     pVeboxMode   = &pVeboxStateCmdParams->VeboxMode;
 
-    cmd.DW1.DownsampleMethod422to420 = 1;
-    cmd.DW1.DownsampleMethod444to422 = 1;
+    MHW_CHK_STATUS(Mhw_ReserveCmdSpace(pCmdBuffer, sizeof(*cmd)));
+    cmd = &Mhw_BeginCmd<mhw_vebox_g9_X::VEBOX_STATE_CMD>(pCmdBuffer);
+
+    cmd->DW1.DownsampleMethod422to420 = 1;
+    cmd->DW1.DownsampleMethod444to422 = 1;
 
     if (!pVeboxStateCmdParams->bNoUseVeboxHeap)
     {
@@ -476,7 +479,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             ResourceParams.presResource = pVeboxHeapResource;
             ResourceParams.dwOffset     = pVeboxHeap->uiDndiStateOffset + uiInstanceBaseAddr;
         }
-        ResourceParams.pdwCmd          = & (cmd.DW2.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW2.Value);
         ResourceParams.dwLocationInCmd = 2;
         ResourceParams.HwCommandType   = MOS_VEBOX_STATE;
 
@@ -496,7 +499,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             ResourceParams.presResource = pVeboxHeapResource;
             ResourceParams.dwOffset     = pVeboxHeap->uiIecpStateOffset + uiInstanceBaseAddr;
         }
-        ResourceParams.pdwCmd             = & (cmd.DW4.Value);
+        ResourceParams.pdwCmd             = & (cmd->DW4.Value);
         ResourceParams.dwLocationInCmd    = 4;
         ResourceParams.HwCommandType      = MOS_VEBOX_STATE;
         ResourceParams.dwSharedMocsOffset = 1 - ResourceParams.dwLocationInCmd;
@@ -518,7 +521,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             ResourceParams.presResource = pVeboxHeapResource;
             ResourceParams.dwOffset     = pVeboxHeap->uiGamutStateOffset + uiInstanceBaseAddr;
         }
-        ResourceParams.pdwCmd             = & (cmd.DW6.Value);
+        ResourceParams.pdwCmd             = & (cmd->DW6.Value);
         ResourceParams.dwLocationInCmd    = 6;
         ResourceParams.HwCommandType      = MOS_VEBOX_STATE;
         ResourceParams.dwSharedMocsOffset = 1 - ResourceParams.dwLocationInCmd;
@@ -539,7 +542,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             ResourceParams.presResource = pVeboxHeapResource;
             ResourceParams.dwOffset     = pVeboxHeap->uiVertexTableOffset + uiInstanceBaseAddr;
         }
-        ResourceParams.pdwCmd             = & (cmd.DW8.Value);
+        ResourceParams.pdwCmd             = & (cmd->DW8.Value);
         ResourceParams.dwLocationInCmd    = 8;
         ResourceParams.HwCommandType      = MOS_VEBOX_STATE;
         ResourceParams.dwSharedMocsOffset = 1 - ResourceParams.dwLocationInCmd;
@@ -560,7 +563,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             ResourceParams.presResource = pVeboxHeapResource;
             ResourceParams.dwOffset     = pVeboxHeap->uiCapturePipeStateOffset + uiInstanceBaseAddr;
         }
-        ResourceParams.pdwCmd             = & (cmd.DW10.Value);
+        ResourceParams.pdwCmd             = & (cmd->DW10.Value);
         ResourceParams.dwLocationInCmd    = 10;
         ResourceParams.HwCommandType      = MOS_VEBOX_STATE;
         ResourceParams.dwSharedMocsOffset = 1 - ResourceParams.dwLocationInCmd;
@@ -575,7 +578,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
             ResourceParams.presResource       = pVeboxStateCmdParams->pLaceLookUpTables;
             ResourceParams.dwOffset           = 0;
-            ResourceParams.pdwCmd             = & (cmd.DW12.Value);
+            ResourceParams.pdwCmd             = & (cmd->DW12.Value);
             ResourceParams.dwLocationInCmd    = 12;
             ResourceParams.HwCommandType      = MOS_VEBOX_STATE;
             ResourceParams.dwSharedMocsOffset = 1 - ResourceParams.dwLocationInCmd;
@@ -597,7 +600,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             ResourceParams.presResource = pVeboxHeapResource;
             ResourceParams.dwOffset     = pVeboxHeap->uiGammaCorrectionStateOffset + uiInstanceBaseAddr;
         }
-        ResourceParams.pdwCmd             = & (cmd.DW14_15.Value[0]);
+        ResourceParams.pdwCmd             = & (cmd->DW14_15.Value[0]);
         ResourceParams.dwLocationInCmd    = 14;
         ResourceParams.HwCommandType      = MOS_VEBOX_STATE;
         ResourceParams.dwSharedMocsOffset = 1 - ResourceParams.dwLocationInCmd;
@@ -629,7 +632,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource = &pVeboxStateCmdParams->DummyIecpResource;
         ResourceParams.dwOffset = 0;
-        ResourceParams.pdwCmd =  &(cmd.DW4.Value);
+        ResourceParams.pdwCmd =  &(cmd->DW4.Value);
         ResourceParams.dwLocationInCmd = 4;
         ResourceParams.HwCommandType = MOS_VEBOX_STATE;
         ResourceParams.dwSharedMocsOffset = 1 - ResourceParams.dwLocationInCmd;
@@ -640,25 +643,25 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxState(
             &ResourceParams));
     }
 
-    cmd.DW1.ColorGamutExpansionEnable    = pVeboxMode->ColorGamutExpansionEnable;
-    cmd.DW1.ColorGamutCompressionEnable  = pVeboxMode->ColorGamutCompressionEnable;
-    cmd.DW1.GlobalIecpEnable             = pVeboxMode->GlobalIECPEnable;
-    cmd.DW1.DnEnable                     = pVeboxMode->DNEnable;
-    cmd.DW1.DiEnable                     = pVeboxMode->DIEnable;
-    cmd.DW1.DnDiFirstFrame               = pVeboxMode->DNDIFirstFrame;
-    cmd.DW1.DiOutputFrames               = pVeboxMode->DIOutputFrames;
-    cmd.DW1.DemosaicEnable               = pVeboxMode->DemosaicEnable;
-    cmd.DW1.VignetteEnable               = pVeboxMode->VignetteEnable;
-    cmd.DW1.AlphaPlaneEnable             = pVeboxMode->AlphaPlaneEnable;
-    cmd.DW1.HotPixelFilteringEnable      = pVeboxMode->HotPixelFilteringEnable;
-    cmd.DW1.SingleSliceVeboxEnable       = pVeboxMode->SingleSliceVeboxEnable;
-    cmd.DW1.LaceCorrectionEnable         = pVeboxMode->LACECorrectionEnable;
-    cmd.DW1.DisableEncoderStatistics     = pVeboxMode->DisableEncoderStatistics;
-    cmd.DW1.DisableTemporalDenoiseFilter = pVeboxMode->DisableTemporalDenoiseFilter;
-    cmd.DW1.SinglePipeEnable             = pVeboxMode->SinglePipeIECPEnable;
-    cmd.DW1.ForwardGammaCorrectionEnable = pVeboxMode->ForwardGammaCorrectionEnable;
-
-    Mos_AddCommand(pCmdBuffer, &cmd, cmd.byteSize);
+    cmd->DW1.ColorGamutExpansionEnable    = pVeboxMode->ColorGamutExpansionEnable;
+    cmd->DW1.ColorGamutCompressionEnable  = pVeboxMode->ColorGamutCompressionEnable;
+    cmd->DW1.GlobalIecpEnable             = pVeboxMode->GlobalIECPEnable;
+    cmd->DW1.DnEnable                     = pVeboxMode->DNEnable;
+    cmd->DW1.DiEnable                     = pVeboxMode->DIEnable;
+    cmd->DW1.DnDiFirstFrame               = pVeboxMode->DNDIFirstFrame;
+    cmd->DW1.DiOutputFrames               = pVeboxMode->DIOutputFrames;
+    cmd->DW1.DemosaicEnable               = pVeboxMode->DemosaicEnable;
+    cmd->DW1.VignetteEnable               = pVeboxMode->VignetteEnable;
+    cmd->DW1.AlphaPlaneEnable             = pVeboxMode->AlphaPlaneEnable;
+    cmd->DW1.HotPixelFilteringEnable      = pVeboxMode->HotPixelFilteringEnable;
+    cmd->DW1.SingleSliceVeboxEnable       = pVeboxMode->SingleSliceVeboxEnable;
+    cmd->DW1.LaceCorrectionEnable         = pVeboxMode->LACECorrectionEnable;
+    cmd->DW1.DisableEncoderStatistics     = pVeboxMode->DisableEncoderStatistics;
+    cmd->DW1.DisableTemporalDenoiseFilter = pVeboxMode->DisableTemporalDenoiseFilter;
+    cmd->DW1.SinglePipeEnable             = pVeboxMode->SinglePipeIECPEnable;
+    cmd->DW1.ForwardGammaCorrectionEnable = pVeboxMode->ForwardGammaCorrectionEnable;
+
+    Mhw_EndCmd(pCmdBuffer, *cmd);
 
 finish:
     return eStatus;
@@ -678,6 +681,9 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxGamutState(
     MHW_CHK_NULL(pVeboxGamutParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
@@ -1354,6 +1360,9 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxIecpAceState(
     MHW_CHK_NULL(pVeboxIecpParams);
     MHW_CHK_NULL(m_veboxHeap);
 
+    // The IECP block no longer holds what UpdateVeboxIecpState built
+    ForgetVeboxIecpState();
+
     pVeboxHeap = m_veboxHeap;
     uiOffset   = pVeboxHeap->uiCurState * pVeboxHeap->uiInstanceSize;
 
@@ -1384,7 +1393,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
     MOS_STATUS                      eStatus;
     PMOS_INTERFACE                  pOsInterface;
     MHW_RESOURCE_PARAMS             ResourceParams;
-    mhw_vebox_g9_X::VEB_DI_IECP_CMD cmd;
+    mhw_vebox_g9_X::VEB_DI_IECP_CMD *cmd = nullptr;
 
     MHW_CHK_NULL(m_osInterface);
     MHW_CHK_NULL(pCmdBuffer);
@@ -1396,18 +1405,21 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
     eStatus      = MOS_STATUS_SUCCESS;
     pOsInterface = m_osInterface;
 
+    MHW_CHK_STATUS(Mhw_ReserveCmdSpace(pCmdBuffer, sizeof(*cmd)));
+    cmd = &Mhw_BeginCmd<mhw_vebox_g9_X::VEB_DI_IECP_CMD>(pCmdBuffer);
+
     if (pVeboxDiIecpCmdParams->pOsResCurrInput)
     {
-        cmd.DW2.CurrentFrameSurfaceControlBitsMemoryCompressionEnable =
+        cmd->DW2.CurrentFrameSurfaceControlBitsMemoryCompressionEnable =
             (pVeboxDiIecpCmdParams->CurInputSurfMMCState != MOS_MEMCOMP_DISABLED) ? 1 : 0;
-        cmd.DW2.CurrentFrameSurfaceControlBitsMemoryCompressionMode =
+        cmd->DW2.CurrentFrameSurfaceControlBitsMemoryCompressionMode =
             (pVeboxDiIecpCmdParams->CurInputSurfMMCState == MOS_MEMCOMP_HORIZONTAL) ? 0 : 1;
 
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.dwLsbNum        = MHW_VEBOX_DI_IECP_SHIFT;
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResCurrInput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->dwCurrInputSurfOffset;
-        ResourceParams.pdwCmd          = & (cmd.DW2.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW2.Value);
         ResourceParams.dwLocationInCmd = 2;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
         MHW_CHK_STATUS(pfnAddResourceToCmd(
@@ -1420,7 +1432,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
     if (pVeboxDiIecpCmdParams->CurInputSurfMMCState == 0)
     {
         // bit 0 ~ 10 is MOCS/MMC bits
-        cmd.DW2.Value = (cmd.DW2.Value & 0xFFFFF800) + pVeboxDiIecpCmdParams->CurrInputSurfCtrl.Value;
+        cmd->DW2.Value = (cmd->DW2.Value & 0xFFFFF800) + pVeboxDiIecpCmdParams->CurrInputSurfCtrl.Value;
     }
 
     if (pVeboxDiIecpCmdParams->pOsResPrevInput)
@@ -1428,7 +1440,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResPrevInput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->PrevInputSurfCtrl.Value + pVeboxDiIecpCmdParams->dwPrevInputSurfOffset;
-        ResourceParams.pdwCmd          = & (cmd.DW4.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW4.Value);
         ResourceParams.dwLocationInCmd = 4;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
 
@@ -1443,7 +1455,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResStmmInput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->StmmInputSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW6.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW6.Value);
         ResourceParams.dwLocationInCmd = 6;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
 
@@ -1458,7 +1470,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResStmmOutput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->StmmOutputSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW8.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW8.Value);
         ResourceParams.dwLocationInCmd = 8;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1474,7 +1486,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResDenoisedCurrOutput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->DenoisedCurrOutputSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW10.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW10.Value);
         ResourceParams.dwLocationInCmd = 10;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1490,7 +1502,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResCurrOutput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->CurrOutputSurfCtrl.Value + pVeboxDiIecpCmdParams->dwCurrOutputSurfOffset;
-        ResourceParams.pdwCmd          = & (cmd.DW12.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW12.Value);
         ResourceParams.dwLocationInCmd = 12;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1506,7 +1518,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResPrevOutput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->PrevOutputSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW14.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW14.Value);
         ResourceParams.dwLocationInCmd = 14;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1522,7 +1534,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResStatisticsOutput;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->StatisticsOutputSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW16.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW16.Value);
         ResourceParams.dwLocationInCmd = 16;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1538,7 +1550,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResAlphaOrVignette;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->AlphaOrVignetteSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW18.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW18.Value);
         ResourceParams.dwLocationInCmd = 18;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1554,7 +1566,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResLaceOrAceOrRgbHistogram;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->LaceOrAceOrRgbHistogramSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW20.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW20.Value);
         ResourceParams.dwLocationInCmd = 20;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1570,7 +1582,7 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
         MOS_ZeroMemory(&ResourceParams, sizeof(ResourceParams));
         ResourceParams.presResource    = pVeboxDiIecpCmdParams->pOsResSkinScoreSurface;
         ResourceParams.dwOffset        = pVeboxDiIecpCmdParams->SkinScoreSurfaceSurfCtrl.Value;
-        ResourceParams.pdwCmd          = & (cmd.DW22.Value);
+        ResourceParams.pdwCmd          = & (cmd->DW22.Value);
         ResourceParams.dwLocationInCmd = 22;
         ResourceParams.bIsWritable     = true;
         ResourceParams.HwCommandType   = MOS_VEBOX_DI_IECP;
@@ -1581,10 +1593,10 @@ MOS_STATUS MhwVeboxInterfaceG9::AddVeboxDiIecp(
             &ResourceParams));
     }
 
-    cmd.DW1.EndingX   = pVeboxDiIecpCmdParams->dwEndingX;
-    cmd.DW1.StartingX = pVeboxDiIecpCmdParams->dwStartingX;
+    cmd->DW1.EndingX   = pVeboxDiIecpCmdParams->dwEndingX;
+    cmd->DW1.StartingX = pVeboxDiIecpCmdParams->dwStartingX;
 
-    Mos_AddCommand(pCmdBuffer, &cmd, cmd.byteSize);
+    Mhw_EndCmd(pCmdBuffer, *cmd);
 
 finish:
     return eStatus;
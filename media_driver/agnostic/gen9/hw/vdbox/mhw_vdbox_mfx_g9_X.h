@@ -674,7 +674,8 @@ protected:
         MHW_MI_CHK_NULL(cmdBuffer);
         MHW_MI_CHK_NULL(params);
 
-        typename TMfxCmds::MFX_PIPE_MODE_SELECT_CMD cmd;
+        MHW_MI_CHK_STATUS(Mhw_ReserveCmdSpace(cmdBuffer, sizeof(typename TMfxCmds::MFX_PIPE_MODE_SELECT_CMD)));
+        auto &cmd = Mhw_BeginCmd<typename TMfxCmds::MFX_PIPE_MODE_SELECT_CMD>(cmdBuffer);
 
         MHW_MI_CHK_STATUS(this->m_cpInterface->SetProtectionSettingsForMfxPipeModeSelect((uint32_t *)&cmd));
 
@@ -721,7 +722,7 @@ protected:
             cmd.DW1.FrameStatisticsStreamoutEnable = 1;
         }
 
-        MHW_MI_CHK_STATUS(Mos_AddCommand(cmdBuffer, &cmd, sizeof(cmd)));
+        Mhw_EndCmd(cmdBuffer, cmd);
 
         return eStatus;
     }
@@ -751,7 +752,8 @@ protected:
             uvPlaneAlignment = MHW_VDBOX_MFX_UV_PLANE_ALIGNMENT_LEGACY;
         }
 
-        typename TMfxCmds::MFX_SURFACE_STATE_CMD cmd;
+        MHW_MI_CHK_STATUS(Mhw_ReserveCmdSpace(cmdBuffer, sizeof(typename TMfxCmds::MFX_SURFACE_STATE_CMD)));
+        auto &cmd = Mhw_BeginCmd<typename TMfxCmds::MFX_SURFACE_STATE_CMD>(cmdBuffer);
         cmd.DW1.SurfaceId = params->ucSurfaceStateId;
 
         cmd.DW2.Height = params->psSurface->dwHeight - 1;
@@ -794,7 +796,7 @@ protected:
                 MOS_ALIGN_CEIL(params->psSurface->VPlaneOffset.iYOffset, uvPlaneAlignment);
         }
 
-        MHW_MI_CHK_STATUS(Mos_AddCommand(cmdBuffer, &cmd, sizeof(cmd)));
+        Mhw_EndCmd(cmdBuffer, cmd);
 
         return eStatus;
     }
@@ -815,7 +817,8 @@ protected:
         resourceParams.dwLsbNum = MHW_VDBOX_MFX_UPPER_BOUND_STATE_SHIFT;
         resourceParams.HwCommandType = MOS_MFX_INDIRECT_OBJ_BASE_ADDR;
 
-        typename TMfxCmds::MFX_IND_OBJ_BASE_ADDR_STATE_CMD cmd;
+        MHW_MI_CHK_STATUS(Mhw_ReserveCmdSpace(cmdBuffer, sizeof(typename TMfxCmds::MFX_IND_OBJ_BASE_ADDR_STATE_CMD)));
+        auto &cmd = Mhw_BeginCmd<typename TMfxCmds::MFX_IND_OBJ_BASE_ADDR_STATE_CMD>(cmdBuffer);
 
         // mode specific settings
         if (CodecHalIsDecodeModeVLD(params->Mode) || (params->Mode == CODECHAL_ENCODE_MODE_VP8))
@@ -905,7 +908,7 @@ protected:
                 &resourceParams));
         }
 
-        MHW_MI_CHK_STATUS(Mos_AddCommand(cmdBuffer, &cmd, sizeof(cmd)));
+        Mhw_EndCmd(cmdBuffer, cmd);
 
         return eStatus;
     }
@@ -926,7 +929,8 @@ protected:
         resourceParams.dwLsbNum = MHW_VDBOX_MFX_GENERAL_STATE_SHIFT;
         resourceParams.HwCommandType = MOS_MFX_BSP_BUF_BASE_ADDR;
 
-        typename TMfxCmds::MFX_BSP_BUF_BASE_ADDR_STATE_CMD cmd;
+        MHW_MI_CHK_STATUS(Mhw_ReserveCmdSpace(cmdBuffer, sizeof(typename TMfxCmds::MFX_BSP_BUF_BASE_ADDR_STATE_CMD)));
+        auto &cmd = Mhw_BeginCmd<typename TMfxCmds::MFX_BSP_BUF_BASE_ADDR_STATE_CMD>(cmdBuffer);
 
         if (this->m_bsdMpcRowstoreCache.bEnabled)         // mbaff and non mbaff mode for all resolutions
         {
@@ -992,7 +996,7 @@ protected:
                 &resourceParams));
         }
 
-        MHW_MI_CHK_STATUS(Mos_AddCommand(cmdBuffer, &cmd, sizeof(cmd)));
+        Mhw_EndCmd(cmdBuffer, cmd);
 
         return eStatus;
     }
@@ -1014,7 +1018,8 @@ protected:
 
         auto avcPicParams = params->pAvcPicParams;
 
-        typename TMfxCmds::MFX_AVC_IMG_STATE_CMD cmd;
+        MHW_MI_CHK_STATUS(Mhw_ReserveCmdSpace(cmdBuffer, sizeof(typename TMfxCmds::MFX_AVC_IMG_STATE_CMD)));
+        auto &cmd = Mhw_BeginCmd<typename TMfxCmds::MFX_AVC_IMG_STATE_CMD>(cmdBuffer);
 
         uint32_t numMBs =
             (avcPicParams->pic_height_in_mbs_minus1 + 1) *
@@ -1072,7 +1077,7 @@ protected:
             cmd.DW16_17.InterViewOrderDisable = 0;
         }
 
-        MHW_MI_CHK_STATUS(Mos_AddCommand(cmdBuffer, &cmd, sizeof(cmd)));
+        Mhw_EndCmd(cmdBuffer, cmd);
 
         return eStatus;
     }
@@ -1277,7 +1282,8 @@ protected:
         resourceParams.dwLsbNum = MHW_VDBOX_MFX_GENERAL_STATE_SHIFT;
         resourceParams.HwCommandType = MOS_MFX_AVC_DIRECT_MODE;
 
-        typename TMfxCmds::MFX_AVC_DIRECTMODE_STATE_CMD cmd;
+        MHW_MI_CHK_STATUS(Mhw_ReserveCmdSpace(cmdBuffer, sizeof(typename TMfxCmds::MFX_AVC_DIRECTMODE_STATE_CMD)));
+        auto &cmd = Mhw_BeginCmd<typename TMfxCmds::MFX_AVC_DIRECTMODE_STATE_CMD>(cmdBuffer);
 
         if (!params->bDisableDmvBuffers)
         {
@@ -1402,7 +1408,7 @@ protected:
             }
         }
 
-        MHW_MI_CHK_STATUS(Mos_AddCommand(cmdBuffer, &cmd, sizeof(cmd)));
+        Mhw_EndCmd(cmdBuffer, cmd);
 
         return MOS_STATUS_SUCCESS;
     }
@@ -28,16 +28,22 @@
 #define MEDIADRIVER_LINUX_COMMON_CM_CMCSYNC_H_
 
 #include "cm_debug.h"
+#include "mos_lock_profile.h"
 
 namespace CMRT_UMD
 {
 class CSync
 {
 public:
-    CSync()
+    //!
+    //! \brief    Constructor
+    //! \param    [in] name
+    //!           Static site name in the lock profile, nullptr for unnamed
+    //!
+    explicit CSync(const char *name = nullptr)
     {
         int32_t ret = 0;
-        ret = pthread_mutex_init(&m_criticalSection, nullptr);
+        ret = MosLockProfile_InitMutex(&m_criticalSection, name, false);
         if (ret != 0)
         {
             CM_ASSERTMESSAGE("Error: Failed in pthread_mutex_init.");
@@ -47,7 +53,7 @@ public:
     ~CSync()
     {
         int32_t ret = 0 ;
-        ret = pthread_mutex_destroy(&m_criticalSection);
+        ret = MosLockProfile_DestroyMutex(&m_criticalSection);
         if (ret != 0)
         {
             CM_ASSERTMESSAGE("Error: Failed in pthread_mutex_destroy.");
@@ -57,7 +63,7 @@ public:
     void Acquire()
     {
         int32_t ret = 0;
-        ret = pthread_mutex_lock(&m_criticalSection);
+        ret = MosLockProfile_Lock(&m_criticalSection);
         if (ret != 0)
         {
             CM_ASSERTMESSAGE("Error: Failed in pthread_mutex_lock.");
@@ -67,7 +73,7 @@ public:
     void Release()
     {
         int32_t ret = 0;
-        ret = pthread_mutex_unlock(&m_criticalSection);
+        ret = MosLockProfile_Unlock(&m_criticalSection);
         if (ret != 0)
         {
             CM_ASSERTMESSAGE("Error: Failed in pthread_mutex_unlock.");
@@ -509,29 +509,29 @@ protected:
 #endif
 
     // synchronization objects
-    CSync m_criticalSectionProgramKernel;
+    CSync m_criticalSectionProgramKernel{"CmDeviceProgramKernel"};
 
-    CSync m_criticalSectionSurface;
+    CSync m_criticalSectionSurface{"CmDeviceSurface"};
 
-    CSync m_criticalSectionReadWriteSurface2D;
+    CSync m_criticalSectionReadWriteSurface2D{"CmDeviceReadWriteSurface2D"};
 
-    CSync m_criticalSectionSampler;
+    CSync m_criticalSectionSampler{"CmDeviceSampler"};
 
-    CSync m_criticalSectionSampler8x8;
+    CSync m_criticalSectionSampler8x8{"CmDeviceSampler8x8"};
 
-    CSync m_criticalSectionVmeState;
+    CSync m_criticalSectionVmeState{"CmDeviceVmeState"};
 
-    CSync m_criticalSectionThreadSpace;
+    CSync m_criticalSectionThreadSpace{"CmDeviceThreadSpace"};
 
-    CSync m_criticalSectionDeviceRefCount;
+    CSync m_criticalSectionDeviceRefCount{"CmDeviceRefCount"};
 
-    CSync m_criticalSectionThreadGroupSpace;
+    CSync m_criticalSectionThreadGroupSpace{"CmDeviceThreadGroupSpace"};
 
-    CSync m_criticalSectionTask;
+    CSync m_criticalSectionTask{"CmDeviceTask"};
 
-    CSync m_criticalSectionVebox;
+    CSync m_criticalSectionVebox{"CmDeviceVebox"};
 
-    CSync m_criticalSectionQueue;
+    CSync m_criticalSectionQueue{"CmDeviceQueue"};
 
     pCallBackReleaseVaSurface  m_pfnReleaseVaSurface;
 
@@ -139,111 +139,16 @@ inline void GetCPUID(int cpuInfo[4], int infoType)
 Inline Function:
     CmFastMemCopyFromWC
 Description:
-    Intel C++ Compiler Memory Copy function for large amounts of data
+    Memory copy from a write-combined buffer with streaming loads, see MosCopy_Copy
 Input:
-    dst - pointer to write-combined destination buffer
-    src - pointer to source buffer
+    dst - pointer to destination buffer
+    src - pointer to write-combined source buffer
     bytes - number of bytes to copy
 \*****************************************************************************/
 inline void CmFastMemCopyFromWC( void* dst, const void* src, const size_t bytes, CPU_INSTRUCTION_LEVEL cpuInstructionLevel )
 {
-    if( cpuInstructionLevel >= CPU_INSTRUCTION_LEVEL_SSE4_1 )
-    {
-        // Cache pointers to memory
-        uint8_t *tempDst = (uint8_t*)dst;
-        uint8_t *tempSrc = (uint8_t*)src;
-
-        size_t count = bytes;
-
-        if( count >= sizeof(DHWORD) )
-        {
-            //Streaming Load must be 16-byte aligned but should
-            //be 64-byte aligned for optimal performance
-            const size_t doubleHexWordAlignBytes =
-                GetAlignmentOffset( tempSrc, sizeof(DHWORD) );
-
-            // Copy portion of the source memory that is not aligned
-            if( doubleHexWordAlignBytes )
-            {
-                CmSafeMemCopy( tempDst, tempSrc, doubleHexWordAlignBytes );
-
-                tempDst += doubleHexWordAlignBytes;
-                tempSrc += doubleHexWordAlignBytes;
-                count -= doubleHexWordAlignBytes;
-            }
-
-            CM_ASSERT( IsAligned( tempSrc, sizeof(DHWORD) ) == true );
-
-            // Get the number of bytes to be copied (rounded down to nearets DHWORD)
-            const size_t doubleHexWordsToCopy = count / sizeof(DHWORD);
-
-            if( doubleHexWordsToCopy )
-            {
-                // Determine if the destination address is aligned
-                const bool isDstDoubleQuadWordAligned =
-                    IsAligned( tempDst, sizeof(DQWORD) );
-
-                __m128i* mmSrc = (__m128i*)(tempSrc);
-                __m128i* mmDst = reinterpret_cast<__m128i*>(tempDst);
-                __m128i  xmm0, xmm1, xmm2, xmm3;
-
-                if( isDstDoubleQuadWordAligned )
-                {
-                    for( size_t i=0; i<doubleHexWordsToCopy; i++ )
-                    {
-                        // Sync the WC memory data before issuing the MOVNTDQA instruction.
-                        _mm_mfence();
-                        xmm0 = _mm_stream_load_si128(mmSrc);
-                        xmm1 = _mm_stream_load_si128(mmSrc + 1);
-                        xmm2 = _mm_stream_load_si128(mmSrc + 2);
-                        xmm3 = _mm_stream_load_si128(mmSrc + 3);
-                        mmSrc += 4;
-
-                        _mm_store_si128(mmDst, xmm0);
-                        _mm_store_si128(mmDst + 1, xmm1);
-                        _mm_store_si128(mmDst + 2, xmm2);
-                        _mm_store_si128(mmDst + 3, xmm3);
-                        mmDst += 4;
-
-                        tempDst += sizeof(DHWORD);
-                        tempSrc += sizeof(DHWORD);
-                        count -= sizeof(DHWORD);
-                    }
-                }
-                else
-                {
-                    for( size_t i=0; i<doubleHexWordsToCopy; i++ )
-                    {
-                        // Sync the WC memory data before issuing the MOVNTDQA instruction.
-                        _mm_mfence();
-                        xmm0 = _mm_stream_load_si128(mmSrc);
-                        xmm1 = _mm_stream_load_si128(mmSrc + 1);
-                        xmm2 = _mm_stream_load_si128(mmSrc + 2);
-                        xmm3 = _mm_stream_load_si128(mmSrc + 3);
-                        mmSrc += 4;
-
-                        _mm_storeu_si128(mmDst, xmm0);
-                        _mm_storeu_si128(mmDst + 1, xmm1);
-                        _mm_storeu_si128(mmDst + 2, xmm2);
-                        _mm_storeu_si128(mmDst + 3, xmm3);
-                        mmDst += 4;
-                        tempDst += sizeof(DHWORD);
-                        tempSrc += sizeof(DHWORD);
-                        count -= sizeof(DHWORD);
-                    }
-                }
-            }
-        }
-
-        // Copy remaining uint8_t(s)
-        if( count )
-        {
-            CmSafeMemCopy( tempDst, tempSrc, count );
-        }
-    }
-    else
-    {
-        CmFastMemCopy( dst, src, bytes );
-    }
+    // The instruction set is picked by MosCopy at run time
+    MOS_UNUSED( cpuInstructionLevel );
+    MosCopy_Copy( dst, src, bytes, MOS_COPY_MEMORY_FROM_WC );
 }
 
@@ -192,6 +192,7 @@ VAStatus DdiMediaDecode::BeginPicture(
     DDI_CODEC_RENDER_TARGET_TABLE *RTtbl;
     RTtbl             = &(m_ddiDecodeCtx->RTtbl);
     RTtbl->pCurrentRT = curRT;
+    m_ddiDecodeCtx->curRTSurfaceID = renderTarget;
 
     m_streamOutEnabled              = false;
     m_ddiDecodeCtx->DecodeParams.m_numSlices       = 0;
@@ -662,6 +663,11 @@ VAStatus DdiMediaDecode::EndPicture(
         return VA_STATUS_ERROR_ALLOCATION_FAILED;
     }
 
+    CodechalDecode             *decoder         = dynamic_cast<CodechalDecode *>(m_ddiDecodeCtx->pCodecHal);
+    CodechalDecodeStatusBuffer *decodeStatusBuf = (decoder && decoder->IsStatusQueryReportingEnabled()) ?
+                                                  decoder->GetDecodeStatusBuf() : nullptr;
+    uint32_t                    statusIndex     = decodeStatusBuf ? decodeStatusBuf->m_currIndex : 0;
+
     MOS_STATUS status = m_ddiDecodeCtx->pCodecHal->Execute((void *)(&m_ddiDecodeCtx->DecodeParams));
     if (status != MOS_STATUS_SUCCESS)
     {
@@ -669,6 +675,16 @@ VAStatus DdiMediaDecode::EndPicture(
         return VA_STATUS_ERROR_DECODING_ERROR;
     }
 
+    // Only a frame that generated a status report takes a slot
+    if (decodeStatusBuf && decodeStatusBuf->m_currIndex != statusIndex)
+    {
+        m_ddiDecodeCtx->StatusReportSurfaceID[statusIndex] = m_ddiDecodeCtx->curRTSurfaceID;
+        if (m_ddiDecodeCtx->RTtbl.pCurrentRT != nullptr)
+        {
+            m_ddiDecodeCtx->RTtbl.pCurrentRT->decStatusReportIndex = statusIndex;
+        }
+    }
+
     (&(m_ddiDecodeCtx->RTtbl))->pCurrentRT = nullptr;
 
     status = m_ddiDecodeCtx->pCodecHal->EndFrame();
@@ -172,6 +172,17 @@ public:
         VADriverContextP ctx,
         VAContextID      context);
 
+    //!
+    //! \brief    Submit pictures recorded by codechal but not sent to HW yet.
+    //!
+    //! \return   VAStatus
+    //!           VA_STATUS_SUCCESS if success, else fail reason
+    //!
+    virtual VAStatus SubmitPendingPictures()
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
     //!
     //! \brief    the first step of Initializing internal structure of DdiMediaDecode
     //! \details  Initialize and allocate the internal structur of DdiMediaDecode. This
@@ -302,6 +313,32 @@ public:
     {
         return false;
     }
+
+    //!
+    //! \brief    Get the configuration attributes the context was created with
+    //!
+    //! \return   Pointer to DDI_DECODE_CONFIG_ATTR
+    //!
+    inline const DDI_DECODE_CONFIG_ATTR *GetDecodeConfigAttr()
+    {
+        return m_ddiDecodeAttr;
+    }
+
+    //!
+    //! \brief    Get the picture width the context was created with
+    //!
+    inline uint32_t GetWidth()
+    {
+        return m_width;
+    }
+
+    //!
+    //! \brief    Get the picture height the context was created with
+    //!
+    inline uint32_t GetHeight()
+    {
+        return m_height;
+    }
 protected:
     //! \brief    the decode_config_attr related with Decode_CONTEXT
     DDI_DECODE_CONFIG_ATTR *m_ddiDecodeAttr = nullptr;
@@ -58,6 +58,16 @@ static const uint32_t zigzag_order[64] =
     53, 60, 61, 54, 47, 55, 62, 63
 };
 
+DdiDecodeJPEG::DdiDecodeJPEG(DDI_DECODE_CONFIG_ATTR *ddiDecodeAttr) : DdiMediaDecode(ddiDecodeAttr)
+{
+    DdiMediaUtil_InitNamedMutex(&m_pendingMutex, "DdiDecodeJpegPending", false);
+}
+
+DdiDecodeJPEG::~DdiDecodeJPEG()
+{
+    DdiMediaUtil_DestroyMutex(&m_pendingMutex);
+}
+
 VAStatus DdiDecodeJPEG::ParseSliceParams(
     DDI_MEDIA_CONTEXT                   *mediaCtx,
     VASliceParameterBufferJPEGBaseline  *slcParam,
@@ -607,6 +617,7 @@ VAStatus DdiDecodeJPEG::SetDecodeParams()
     if((m_ddiDecodeCtx->RTtbl.pCurrentRT->format == Media_Format_NV12)
         &&(jpegPicParam->m_chromaType == jpegYUV444))
     {
+        // The old surface is freed, EndPicture has submitted the batched pictures writing it
         m_ddiDecodeCtx->RTtbl.pCurrentRT = DdiMedia_ReplaceSurfaceWithNewFormat(m_ddiDecodeCtx->RTtbl.pCurrentRT, Media_Format_444P);
     }
     if(m_ddiDecodeCtx->RTtbl.pCurrentRT != nullptr)
@@ -663,9 +674,110 @@ VAStatus DdiDecodeJPEG::AllocSliceParamContext(
     return VA_STATUS_SUCCESS;
 }
 
+VAStatus DdiDecodeJPEG::EndPicture(
+    VADriverContextP ctx,
+    VAContextID      context)
+{
+    DDI_CHK_NULL(m_ddiDecodeCtx, "nullptr m_ddiDecodeCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    // SetDecodeParams replaces the surface of a 4:4:4 picture and frees the
+    // old one. Submitting takes the PendingMutex of the media context, so it
+    // is done before m_pendingMutex is taken.
+    CodecDecodeJpegPicParams *jpegPicParam = (CodecDecodeJpegPicParams *)(m_ddiDecodeCtx->DecodeParams.m_picParams);
+    if (m_ddiDecodeCtx->RTtbl.pCurrentRT != nullptr && jpegPicParam != nullptr &&
+        m_ddiDecodeCtx->RTtbl.pCurrentRT->format == Media_Format_NV12 &&
+        jpegPicParam->m_chromaType == jpegYUV444)
+    {
+        DDI_CHK_RET(DdiDecode_SubmitPendingPictures(m_ddiDecodeCtx->RTtbl.pCurrentRT), "Failed to submit pending pictures!");
+    }
+
+    // A thread waiting on an earlier picture may submit the batch meanwhile
+    DdiMediaUtil_LockMutex(&m_pendingMutex);
+    VAStatus vaStatus = DdiMediaDecode::EndPicture(ctx, context);
+    if (vaStatus != VA_STATUS_SUCCESS)
+    {
+        DdiMediaUtil_UnLockMutex(&m_pendingMutex);
+        return vaStatus;
+    }
+
+    CodechalDecodeJpeg *jpegState = dynamic_cast<CodechalDecodeJpeg *>(m_ddiDecodeCtx->pCodecHal);
+    if (jpegState == nullptr || jpegState->IsIncompletePicture())
+    {
+        DdiMediaUtil_UnLockMutex(&m_pendingMutex);
+        return VA_STATUS_SUCCESS;
+    }
+
+    // Remember the destination surfaces of batched pictures so that waiting on them submits the batch
+    uint32_t numPendingPictures = jpegState->GetNumPendingPictures();
+    if (numPendingPictures <= 1)
+    {
+        // Everything recorded before this picture has been submitted
+        ReleasePendingPictures();
+    }
+    if (numPendingPictures > 0 && m_numPendingSurfaces < CODECHAL_DECODE_JPEG_MAX_BATCH_SIZE)
+    {
+        DDI_MEDIA_SURFACE *surface = DdiMedia_GetSurfaceFromVASurfaceID(
+            m_ddiDecodeCtx->pMediaCtx,
+            m_ddiDecodeCtx->curRTSurfaceID);
+        if (surface != nullptr)
+        {
+            surface->pPendingDecCtx = m_ddiDecodeCtx;
+        }
+
+        // The relocations of the bitstream buffer are only emitted when the batch is submitted
+        m_pendingSurfaces[m_numPendingSurfaces]      = surface;
+        m_pendingBitstreamBufs[m_numPendingSurfaces] = m_jpegBitstreamBuf;
+        m_numPendingSurfaces++;
+        m_jpegBitstreamBuf = nullptr;
+    }
+    DdiMediaUtil_UnLockMutex(&m_pendingMutex);
+
+    return VA_STATUS_SUCCESS;
+}
+
+void DdiDecodeJPEG::ReleasePendingPictures()
+{
+    for (uint32_t i = 0; i < m_numPendingSurfaces; i++)
+    {
+        if (m_pendingSurfaces[i] != nullptr)
+        {
+            m_pendingSurfaces[i]->pPendingDecCtx = nullptr;
+            m_pendingSurfaces[i]                 = nullptr;
+        }
+        if (m_pendingBitstreamBufs[i] != nullptr)
+        {
+            DdiMediaUtil_FreeBuffer(m_pendingBitstreamBufs[i]);
+            MOS_FreeMemory(m_pendingBitstreamBufs[i]);
+            m_pendingBitstreamBufs[i] = nullptr;
+        }
+    }
+    m_numPendingSurfaces = 0;
+}
+
+VAStatus DdiDecodeJPEG::SubmitPendingPictures()
+{
+    DDI_CHK_NULL(m_ddiDecodeCtx, "nullptr m_ddiDecodeCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    DdiMediaUtil_LockMutex(&m_pendingMutex);
+    MOS_STATUS status = MOS_STATUS_SUCCESS;
+    CodechalDecodeJpeg *jpegState = dynamic_cast<CodechalDecodeJpeg *>(m_ddiDecodeCtx->pCodecHal);
+    if (jpegState != nullptr && jpegState->GetNumPendingPictures() > 0)
+    {
+        status = jpegState->SubmitPendingPictures();
+    }
+    if (MOS_STATUS_SUCCESS == status)
+    {
+        ReleasePendingPictures();
+    }
+    DdiMediaUtil_UnLockMutex(&m_pendingMutex);
+
+    return (MOS_STATUS_SUCCESS == status) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_DECODING_ERROR;
+}
+
 void DdiDecodeJPEG::DestroyContext(
     VADriverContextP ctx)
 {
+    SubmitPendingPictures();
     FreeResourceBuffer();
     // explicitly call the base function to do the further clean-up
     DdiMediaDecode::DestroyContext(ctx);
@@ -838,6 +950,8 @@ void DdiDecodeJPEG::FreeResourceBuffer()
         m_jpegBitstreamBuf = nullptr;
     }
 
+    ReleasePendingPictures();
+
     // free decode bitstream buffer object
     MOS_FreeMemory(bufMgr->pSliceData);
     bufMgr->pSliceData = nullptr;
@@ -29,6 +29,7 @@
 
 #include <va/va.h>
 #include "media_ddi_decode_base.h"
+#include "codechal_decode_jpeg.h"
 
 //forward declaration of DDI_MEDIA_BUFFER
 struct _DDI_MEDIA_BUFFER;
@@ -43,12 +44,12 @@ public:
     //!
     //! \brief Constructor
     //!
-    DdiDecodeJPEG(DDI_DECODE_CONFIG_ATTR *ddiDecodeAttr) : DdiMediaDecode(ddiDecodeAttr){};
+    DdiDecodeJPEG(DDI_DECODE_CONFIG_ATTR *ddiDecodeAttr);
 
     //!
     //! \brief Destructor
     //!
-    virtual ~DdiDecodeJPEG(){};
+    virtual ~DdiDecodeJPEG();
 
     // inherited virtual functions
     virtual VAStatus BeginPicture(
@@ -71,6 +72,12 @@ public:
 
     virtual VAStatus SetDecodeParams() override;
 
+    virtual VAStatus EndPicture(
+        VADriverContextP ctx,
+        VAContextID      context) override;
+
+    VAStatus SubmitPendingPictures() override;
+
     virtual void ContextInit(
         int32_t picWidth,
         int32_t picHeight) override;
@@ -165,6 +172,11 @@ private:
     //!
     void FreeResourceBuffer();
 
+    //! \brief   Forget the pictures of the last batch
+    //! \details Called once codechal has submitted them, frees their bitstream buffers
+    //!
+    void ReleasePendingPictures();
+
     //! \brief   ParseHuffmanTbl for JPEG
     //! \details parse the Huffman table info required by JPEG decoding
     //!
@@ -194,6 +206,11 @@ private:
 
     //! \brief the total num of JPEG scans
     int32_t m_numScans = 0;
+
+    DDI_MEDIA_SURFACE        *m_pendingSurfaces[CODECHAL_DECODE_JPEG_MAX_BATCH_SIZE] = {};         //!< Destination surfaces of pictures batched in codechal
+    struct _DDI_MEDIA_BUFFER *m_pendingBitstreamBufs[CODECHAL_DECODE_JPEG_MAX_BATCH_SIZE] = {};    //!< Bitstream buffers kept until their pictures are submitted
+    uint32_t                  m_numPendingSurfaces = 0;                                             //!< Number of entries in m_pendingSurfaces and m_pendingBitstreamBufs
+    MEDIA_MUTEX_T             m_pendingMutex;                                                       //!< Protects the codechal batch and the pending surfaces and buffers
 };
 
 #endif
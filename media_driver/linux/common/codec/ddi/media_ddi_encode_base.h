@@ -105,6 +105,17 @@ public:
         DDI_MEDIA_BUFFER *mediaBuf,
         void             **buf);
 
+    //!
+    //! \brief    Submit pictures recorded by codechal but not sent to HW yet.
+    //!
+    //! \return   VAStatus
+    //!           VA_STATUS_SUCCESS if success, else fail reason
+    //!
+    virtual VAStatus SubmitPendingPictures()
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
     //!
     //! \brief    Report Status for Enc buffer.
     //!
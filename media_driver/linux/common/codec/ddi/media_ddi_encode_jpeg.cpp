@@ -34,8 +34,15 @@ extern template class MediaDdiFactoryNoArg<DdiEncodeBase>;
 static bool isEncodeJpegRegistered =
     MediaDdiFactoryNoArg<DdiEncodeBase>::RegisterCodec<DdiEncodeJpeg>(ENCODE_ID_JPEG);
 
+DdiEncodeJpeg::DdiEncodeJpeg()
+{
+    DdiMediaUtil_InitNamedMutex(&m_pendingMutex, "DdiEncodeJpegPending", false);
+}
+
 DdiEncodeJpeg::~DdiEncodeJpeg()
 {
+    DdiMediaUtil_DestroyMutex(&m_pendingMutex);
+
     if (m_encodeCtx == nullptr)
     {
         return;
@@ -570,15 +577,69 @@ VAStatus DdiEncodeJpeg::EncodeInCodecHal(uint32_t numSlices)
         encodeParams.dwNumHuffBuffers = 2;
     }
 
+    // A thread waiting on an earlier picture may submit the batch meanwhile
+    DdiMediaUtil_LockMutex(&m_pendingMutex);
     MOS_STATUS status = m_encodeCtx->pCodecHal->Execute(&encodeParams);
     if (MOS_STATUS_SUCCESS != status)
     {
+        DdiMediaUtil_UnLockMutex(&m_pendingMutex);
         return VA_STATUS_ERROR_ENCODING_ERROR;
     }
 
+    // Remember the input surfaces of batched pictures so that waiting on them submits the batch
+    CodechalEncodeJpegState *jpegState = dynamic_cast<CodechalEncodeJpegState *>(m_encodeCtx->pCodecHal);
+    uint32_t numPendingPictures = (jpegState != nullptr) ? jpegState->GetNumPendingPictures() : 0;
+    if (numPendingPictures <= 1)
+    {
+        // Everything recorded before this picture has been submitted
+        for (uint32_t i = 0; i < m_numPendingSurfaces; i++)
+        {
+            m_pendingSurfaces[i]->pPendingEncCtx = nullptr;
+        }
+        m_numPendingSurfaces = 0;
+    }
+    if (numPendingPictures > 0 && m_numPendingSurfaces < CODECHAL_ENCODE_JPEG_MAX_BATCH_SIZE)
+    {
+        rtTbl->pCurrentRT->pPendingEncCtx           = m_encodeCtx;
+        m_pendingSurfaces[m_numPendingSurfaces++]   = rtTbl->pCurrentRT;
+    }
+    DdiMediaUtil_UnLockMutex(&m_pendingMutex);
+
     return VA_STATUS_SUCCESS;
 }
 
+VAStatus DdiEncodeJpeg::SubmitPendingPictures()
+{
+    DDI_CHK_NULL(m_encodeCtx, "nullptr m_encodeCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    DdiMediaUtil_LockMutex(&m_pendingMutex);
+    for (uint32_t i = 0; i < m_numPendingSurfaces; i++)
+    {
+        m_pendingSurfaces[i]->pPendingEncCtx = nullptr;
+    }
+    m_numPendingSurfaces = 0;
+
+    MOS_STATUS status = MOS_STATUS_SUCCESS;
+    CodechalEncodeJpegState *jpegState = dynamic_cast<CodechalEncodeJpegState *>(m_encodeCtx->pCodecHal);
+    if (jpegState != nullptr && jpegState->GetNumPendingPictures() > 0)
+    {
+        status = jpegState->SubmitPendingPictures();
+    }
+    DdiMediaUtil_UnLockMutex(&m_pendingMutex);
+
+    return (MOS_STATUS_SUCCESS == status) ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_ENCODING_ERROR;
+}
+
+VAStatus DdiEncodeJpeg::StatusReport(
+    DDI_MEDIA_BUFFER *mediaBuf,
+    void             **buf)
+{
+    // The coded buffer may belong to a picture still held in the batch
+    DDI_CHK_RET(SubmitPendingPictures(), "Failed to submit pending pictures!");
+
+    return DdiEncodeBase::StatusReport(mediaBuf, buf);
+}
+
 uint32_t DdiEncodeJpeg::ConvertMediaFormatToInputSurfaceFormat(DDI_MEDIA_FORMAT format)
 {
     switch (format)
@@ -28,6 +28,7 @@
 #define __MEDIA_LIBVA_ENCODER_JPEG_H__
 
 #include "media_ddi_encode_base.h"
+#include "codechal_encode_jpeg.h"
 
 static const uint8_t maxNumQuantTableIndex = 3;
 static const uint8_t numQuantMatrix        = 64;
@@ -81,7 +82,7 @@ public:
     //!
     //! \brief    Constructor
     //!
-    DdiEncodeJpeg(){};
+    DdiEncodeJpeg();
 
     //!
     //! \brief    Destructor
@@ -121,6 +122,32 @@ public:
         VABufferID       *buffers,
         int32_t          numBuffers) override;
 
+    //!
+    //! \brief    Report Status for coded buffer, submitting batched pictures first.
+    //!
+    //! \param    [in] mediaBuf
+    //!           Pointer to DDI_MEDIA_BUFFER
+    //! \param    [out] buf
+    //!           Pointer to buffer
+    //!
+    //! \return   VAStatus
+    //!           VA_STATUS_SUCCESS if success, else fail reason
+    //!
+    VAStatus StatusReport(
+        DDI_MEDIA_BUFFER *mediaBuf,
+        void             **buf) override;
+
+    //!
+    //! \brief    Submit the pictures batched in codechal and release their input surfaces.
+    //!
+    //! \details  May be called from a thread waiting on one of the surfaces while
+    //!           the encode thread batches the next picture
+    //!
+    //! \return   VAStatus
+    //!           VA_STATUS_SUCCESS if success, else fail reason
+    //!
+    VAStatus SubmitPendingPictures() override;
+
 protected:
     //!
     //! \brief    Reset Encode Context At Frame Level
@@ -253,5 +280,8 @@ private:
     uint32_t                           m_appDataTotalSize   = 0;          //!< Total size of application data.
     uint32_t                           m_appDataSize   = 0;          //!< Size of application data.
     uint32_t                           m_appDataWholeHeader = false; //!< whether the app data include whole headers , such as SOI, DQT ...
+    DDI_MEDIA_SURFACE                  *m_pendingSurfaces[CODECHAL_ENCODE_JPEG_MAX_BATCH_SIZE] = {};  //!< Input surfaces of pictures batched in codechal.
+    uint32_t                           m_numPendingSurfaces = 0;     //!< Number of entries in m_pendingSurfaces.
+    MEDIA_MUTEX_T                      m_pendingMutex;               //!< Protects the codechal batch and m_pendingSurfaces.
 };
 #endif /* __MEDIA_LIBVA_ENCODER_JPEG_H__ */
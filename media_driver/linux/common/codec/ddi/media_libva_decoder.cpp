@@ -207,74 +207,482 @@ void DdiDecodeCleanUp(
     return;
 }
 
-/*
- *  vpgDecodeCreateContext - Create a decode context
- *  dpy: display
- *  config_id: configuration for the context
- *  picture_width: coded picture width
- *  picture_height: coded picture height
- *  render_targets: render targets (surfaces) tied to the context
- *  num_render_targets: number of render targets in the above array
- *  context: created context id upon return
- */
-VAStatus DdiDecode_CreateContext (
-    VADriverContextP    ctx,
-    VAConfigID          configId,
-    int32_t             pictureWidth,
-    int32_t             pictureHeight,
-    int32_t             flag,
-    VASurfaceID        *renderTargets,
-    int32_t             numRenderTargets,
-    VAContextID        *context
-)
+//!
+//! \brief  Current time of the decode context pool
+//!
+//! \details Park times and eviction deadlines are taken on the monotonic clock the
+//!          idle timer waits on, so that wall clock jumps do not shift evictions
+//!
+//! \return double
+//!     Monotonic time in microseconds
+//!
+static double DdiDecode_ContextPoolGetTime()
 {
-    MOS_CONTEXT                       mosCtx = {};
-    PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT contextHeapElement;
-    DdiMediaDecode                    *ddiDecBase;
-    DDI_DECODE_CONFIG_ATTR            decConfigAttr;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000000.0 + (double)now.tv_nsec / 1000.0;
+}
 
-    DDI_UNUSED(flag);
+//!
+//! \brief  Whether the contexts of a decode standard can be parked in the pool
+//!
+//! \details Only AVC and HEVC implement CodechalDecode::ResetStreamState(), the other
+//!          standards keep their references and are always destroyed
+//!
+//! \param  [in] standard
+//!     Decode standard, CODECHAL_STANDARD
+//!
+//! \return bool
+//!     true if the contexts of the standard are recycled
+//!
+static bool DdiDecode_ContextPoolIsSupported(uint32_t standard)
+{
+    return standard == CODECHAL_AVC || standard == CODECHAL_HEVC;
+}
 
-    VAStatus va            = VA_STATUS_SUCCESS;
-    decConfigAttr.uiDecSliceMode = VA_DEC_SLICE_MODE_BASE;
-    *context            = VA_INVALID_ID;
+//!
+//! \brief  Remove a parked context from the decode context pool
+//!
+//! \details The caller holds the pool mutex
+//!
+//! \param  [in] pool
+//!     Pointer to decode context pool
+//! \param  [in] index
+//!     Index of the entry to remove
+//!
+//! \return PDDI_DECODE_CONTEXT
+//!     The removed decode context
+//!
+static PDDI_DECODE_CONTEXT DdiDecode_ContextPoolRemove(
+    PDDI_DECODE_CONTEXT_POOL pool,
+    uint32_t                 index)
+{
+    PDDI_DECODE_CONTEXT decCtx = pool->entries[index].decCtx;
+    pool->pooledMbs -= pool->entries[index].numMbs;
 
-    uint16_t mode               = CODECHAL_DECODE_MODE_AVCVLD;
+    for (uint32_t i = index + 1; i < pool->numEntries; i++)
+    {
+        pool->entries[i - 1] = pool->entries[i];
+    }
+    pool->numEntries--;
 
-    DDI_CHK_NULL(ctx, "nullptr Ctx", VA_STATUS_ERROR_INVALID_CONTEXT);
+    return decCtx;
+}
 
-    PDDI_MEDIA_CONTEXT mediaCtx  = DdiMedia_GetMediaContext(ctx);
-    DDI_CHK_NULL(mediaCtx, "nullptr mediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+//!
+//! \brief  Destroy the parked contexts which exceeded the idle time
+//!
+//! \details The caller holds the pool mutex
+//!
+//! \param  [in] ctx
+//!     Pointer to VA driver context
+//! \param  [in] pool
+//!     Pointer to decode context pool
+//! \param  [in] now
+//!     Current time from DdiDecode_ContextPoolGetTime()
+//!
+static void DdiDecode_ContextPoolEvictIdle(
+    VADriverContextP         ctx,
+    PDDI_DECODE_CONTEXT_POOL pool,
+    double                   now)
+{
+    // Entries are ordered from oldest to newest
+    while (pool->numEntries > 0 && now - pool->entries[0].releaseTime > pool->idleTime)
+    {
+        DdiDecodeCleanUp(ctx, DdiDecode_ContextPoolRemove(pool, 0));
+        pool->evictions++;
+    }
+}
+
+//!
+//! \brief  Point the idle timer at the oldest parked context
+//!
+//! \details The caller holds the pool mutex
+//!
+//! \param  [in] pool
+//!     Pointer to decode context pool
+//!
+static void DdiDecode_ContextPoolArmTimer(PDDI_DECODE_CONTEXT_POOL pool)
+{
+    double deadline = (pool->numEntries > 0) ? pool->entries[0].releaseTime + pool->idleTime : 0;
+
+    pthread_mutex_lock(&pool->timerMutex);
+    if (deadline != pool->timerDeadline)
+    {
+        pool->timerDeadline = deadline;
+        pthread_cond_signal(&pool->timerCond);
+    }
+    pthread_mutex_unlock(&pool->timerMutex);
+}
+
+//!
+//! \brief  Destroy the parked contexts once their idle time is over
+//!
+//! \details Without it a parked context keeps its memory until the next
+//!          vaCreateContext or vaDestroyContext, however long that takes.
+//!
+//! \param  [in] arg
+//!     Pointer to decode context pool
+//!
+static void *DdiDecode_ContextPoolTimerThread(void *arg)
+{
+    PDDI_DECODE_CONTEXT_POOL pool = (PDDI_DECODE_CONTEXT_POOL)arg;
+
+    pthread_mutex_lock(&pool->timerMutex);
+    while (!pool->timerExit)
+    {
+        if (pool->timerDeadline == 0)
+        {
+            pthread_cond_wait(&pool->timerCond, &pool->timerMutex);
+            continue;
+        }
+
+        double remaining = pool->timerDeadline - DdiDecode_ContextPoolGetTime();
+        if (remaining > 0)
+        {
+            struct timespec wakeup;
+            clock_gettime(CLOCK_MONOTONIC, &wakeup);
+            uint64_t ns     = (uint64_t)wakeup.tv_nsec + (uint64_t)(remaining * 1000.0);
+            wakeup.tv_sec  += ns / 1000000000ull;
+            wakeup.tv_nsec  = ns % 1000000000ull;
+            pthread_cond_timedwait(&pool->timerCond, &pool->timerMutex, &wakeup);
+            continue;
+        }
 
+        pool->timerDeadline = 0;
+        pthread_mutex_unlock(&pool->timerMutex);
+
+        // The context may have been taken or more parked meanwhile
+        DdiMediaUtil_LockMutex(&pool->poolMutex);
+        uint64_t evictions = pool->evictions;
+        DdiDecode_ContextPoolEvictIdle(pool->ctx, pool, DdiDecode_ContextPoolGetTime());
+        pool->timerEvictions += pool->evictions - evictions;
+        DdiDecode_ContextPoolArmTimer(pool);
+        DdiMediaUtil_UnLockMutex(&pool->poolMutex);
+
+        pthread_mutex_lock(&pool->timerMutex);
+    }
+    pthread_mutex_unlock(&pool->timerMutex);
+
+    return nullptr;
+}
+
+//!
+//! \brief  Reset the per stream state a parked context kept from its last stream
+//!
+//! \details The codec status reports are dropped by ResetStreamState() on release.
+//!          The buffers of BufMgr and DecodeParams stay allocated for the new stream.
+//!
+//! \param  [in] decCtx
+//!     Pointer to ddi decode context
+//!
+static void DdiDecode_ContextPoolReset(PDDI_DECODE_CONTEXT decCtx)
+{
+    DDI_CODEC_COM_BUFFER_MGR *bufMgr = &decCtx->BufMgr;
+    bufMgr->dwNumSliceData            = 0;
+    bufMgr->dwNumSliceControl         = 0;
+    bufMgr->dwSizeOfRenderedSliceData = 0;
+    bufMgr->dwNumOfRenderedSliceData  = 0;
+    bufMgr->dwNumOfRenderedSlicePara  = 0;
+    bufMgr->bIsSliceOverSize          = false;
+    if (bufMgr->pSliceData != nullptr)
+    {
+        MOS_ZeroMemory(bufMgr->pSliceData, sizeof(bufMgr->pSliceData[0]) * bufMgr->m_maxNumSliceData);
+    }
+
+    CodechalDecodeParams *decodeParams = &decCtx->DecodeParams;
+    decodeParams->m_destSurface             = nullptr;
+    decodeParams->m_dataBuffer              = nullptr;
+    decodeParams->m_dataSize                = 0;
+    decodeParams->m_dataOffset              = 0;
+    decodeParams->m_numSlices               = 0;
+    decodeParams->m_numMacroblocks          = 0;
+    decodeParams->m_deblockDataSize         = 0;
+    decodeParams->m_refSurfaceNum           = 0;
+    decodeParams->m_refFrameCnt             = 0;
+    decodeParams->m_streamOutEnabled        = false;
+    decodeParams->m_externalStreamOutBuffer = nullptr;
+    decodeParams->m_presPredication         = nullptr;
+    decodeParams->m_predicationResOffset    = 0;
+    decodeParams->m_predicationNotEqualZero = false;
+    decodeParams->m_predicationEnabled      = false;
+    decodeParams->m_setMarkerEnabled        = false;
+    decodeParams->m_presSetMarker           = nullptr;
+    decodeParams->setMarkerNumTs            = 0;
+
+    decCtx->curRTSurfaceID = VA_INVALID_ID;
+    for (int32_t i = 0; i < CODECHAL_DECODE_STATUS_NUM; i++)
+    {
+        decCtx->StatusReportSurfaceID[i] = VA_INVALID_ID;
+    }
+    MOS_ZeroMemory(decCtx->vaSurfDecErrOutput, sizeof(decCtx->vaSurfDecErrOutput));
+}
+
+//!
+//! \brief  Take a parked context which matches the configuration out of the pool
+//!
+//! \param  [in] ctx
+//!     Pointer to VA driver context
+//! \param  [in] pool
+//!     Pointer to decode context pool
+//! \param  [in] decConfigAttr
+//!     Configuration attributes of the new context
+//! \param  [in] width
+//!     Picture width of the new context
+//! \param  [in] height
+//!     Picture height of the new context
+//!
+//! \return PDDI_DECODE_CONTEXT
+//!     The parked decode context, nullptr if no context matches
+//!
+static PDDI_DECODE_CONTEXT DdiDecode_ContextPoolAcquire(
+    VADriverContextP         ctx,
+    PDDI_DECODE_CONTEXT_POOL pool,
+    PDDI_DECODE_CONFIG_ATTR  decConfigAttr,
+    uint32_t                 width,
+    uint32_t                 height)
+{
     PDDI_DECODE_CONTEXT decCtx = nullptr;
-    if (numRenderTargets > DDI_MEDIA_MAX_SURFACE_NUMBER_CONTEXT)
+
+    DdiMediaUtil_LockMutex(&pool->poolMutex);
+    DdiDecode_ContextPoolEvictIdle(ctx, pool, DdiDecode_ContextPoolGetTime());
+
+    // Prefer the most recently parked context
+    for (int32_t i = (int32_t)pool->numEntries - 1; i >= 0; i--)
     {
-        return VA_STATUS_ERROR_MAX_NUM_EXCEEDED;
+        PDDI_DECODE_CONTEXT_POOL_ENTRY entry = &pool->entries[i];
+        if (entry->configAttr.profile             == decConfigAttr->profile             &&
+            entry->configAttr.entrypoint          == decConfigAttr->entrypoint          &&
+            entry->configAttr.uiDecSliceMode      == decConfigAttr->uiDecSliceMode      &&
+            entry->configAttr.uiEncryptionType    == decConfigAttr->uiEncryptionType    &&
+            entry->configAttr.uiDecProcessingType == decConfigAttr->uiDecProcessingType &&
+            entry->width  == width                                                      &&
+            entry->height == height)
+        {
+            decCtx = DdiDecode_ContextPoolRemove(pool, (uint32_t)i);
+            break;
+        }
     }
+    DdiDecode_ContextPoolArmTimer(pool);
+    DdiMediaUtil_UnLockMutex(&pool->poolMutex);
 
-    std::string codecKey = DECODE_ID_NONE;
+    if (decCtx != nullptr)
+    {
+        DdiDecode_ContextPoolReset(decCtx);
+    }
+    return decCtx;
+}
 
-    DDI_CHK_NULL(mediaCtx->m_caps, "nullptr m_caps", VA_STATUS_ERROR_INVALID_CONTEXT);
-    DDI_CHK_RET(mediaCtx->m_caps->GetDecConfigAttr(
-            configId + DDI_CODEC_GEN_CONFIG_ATTRIBUTES_DEC_BASE,
-            &decConfigAttr.profile,
-            &decConfigAttr.entrypoint,
-            &decConfigAttr.uiDecSliceMode,
-            &decConfigAttr.uiEncryptionType,
-            &decConfigAttr.uiDecProcessingType),"Invalide config_id!");
+//!
+//! \brief  Park a decode context in the pool instead of destroying it
+//!
+//! \details The context is reset for a new stream and detached from its render targets.
+//!          Older contexts are destroyed when the pool is full or over its memory cap.
+//!
+//! \param  [in] ctx
+//!     Pointer to VA driver context
+//! \param  [in] pool
+//!     Pointer to decode context pool
+//! \param  [in] decCtx
+//!     Pointer to ddi decode context
+//!
+//! \return bool
+//!     true if the context is parked, false if the caller has to destroy it
+//!
+static bool DdiDecode_ContextPoolRelease(
+    VADriverContextP         ctx,
+    PDDI_DECODE_CONTEXT_POOL pool,
+    PDDI_DECODE_CONTEXT      decCtx)
+{
+    DdiMediaDecode *ddiDecode = decCtx->m_ddiDecode;
+    CodechalDecode *decoder   = dynamic_cast<CodechalDecode *>(decCtx->pCodecHal);
+    if (ddiDecode == nullptr || decoder == nullptr || ddiDecode->GetDecodeConfigAttr() == nullptr)
+    {
+        return false;
+    }
 
-    mode = mediaCtx->m_caps->GetDecodeCodecMode(decConfigAttr.profile);
-    codecKey =  mediaCtx->m_caps->GetDecodeCodecKey(decConfigAttr.profile);
-    va       =  mediaCtx->m_caps->CheckDecodeResolution(
-                mode,
-                decConfigAttr.profile,
-                pictureWidth,
-                pictureHeight);
-    if (va != VA_STATUS_SUCCESS)
+    uint32_t numMbs = DDI_CODEC_NUM_MACROBLOCKS_WIDTH(ddiDecode->GetWidth()) *
+                      DDI_CODEC_NUM_MACROBLOCKS_HEIGHT(ddiDecode->GetHeight());
+    if (numMbs > pool->maxMbs)
     {
-        DdiDecodeCleanUp(ctx,decCtx);
-        return va;
+        return false;
+    }
+
+    // Only the standards which can drop their references are recycled
+    if (!DdiDecode_ContextPoolIsSupported(decoder->GetStandard()) ||
+        decoder->ResetStreamState() != MOS_STATUS_SUCCESS)
+    {
+        return false;
+    }
+
+    for (int32_t i = 0; i < DDI_MEDIA_MAX_SURFACE_NUMBER_CONTEXT; i++)
+    {
+        if ((decCtx->RTtbl.pRT[i] != nullptr) &&
+            (decCtx->RTtbl.pRT[i]->pDecCtx == decCtx))
+        {
+            decCtx->RTtbl.pRT[i]->pDecCtx = nullptr;
+        }
     }
+    MOS_ZeroMemory(&decCtx->RTtbl, sizeof(decCtx->RTtbl));
+
+    DdiMediaUtil_LockMutex(&pool->poolMutex);
+    double now = DdiDecode_ContextPoolGetTime();
+    DdiDecode_ContextPoolEvictIdle(ctx, pool, now);
+    while (pool->numEntries > 0 &&
+        (pool->numEntries >= pool->maxEntries || pool->pooledMbs + numMbs > pool->maxMbs))
+    {
+        DdiDecodeCleanUp(ctx, DdiDecode_ContextPoolRemove(pool, 0));
+        pool->evictions++;
+    }
+
+    PDDI_DECODE_CONTEXT_POOL_ENTRY entry = &pool->entries[pool->numEntries++];
+    entry->decCtx      = decCtx;
+    entry->configAttr  = *ddiDecode->GetDecodeConfigAttr();
+    entry->width       = ddiDecode->GetWidth();
+    entry->height      = ddiDecode->GetHeight();
+    entry->numMbs      = numMbs;
+    entry->releaseTime = now;
+    pool->pooledMbs   += numMbs;
+    DdiDecode_ContextPoolArmTimer(pool);
+    DdiMediaUtil_UnLockMutex(&pool->poolMutex);
+
+    return true;
+}
+
+VAStatus DdiDecode_ContextPoolInit(VADriverContextP ctx, PDDI_MEDIA_CONTEXT mediaCtx)
+{
+    DDI_CHK_NULL(ctx, "nullptr ctx", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(mediaCtx, "nullptr mediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    mediaCtx->pDecodeCtxPool = nullptr;
+
+    MOS_USER_FEATURE_VALUE_DATA userFeatureData;
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_SIZE_ID,
+        &userFeatureData);
+    if (userFeatureData.i32Data <= 0)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+    uint32_t maxEntries = MOS_MIN((uint32_t)userFeatureData.i32Data, DDI_DECODE_CONTEXT_POOL_MAX_SIZE);
+
+    PDDI_DECODE_CONTEXT_POOL pool = (PDDI_DECODE_CONTEXT_POOL)MOS_AllocAndZeroMemory(sizeof(DDI_DECODE_CONTEXT_POOL));
+    DDI_CHK_NULL(pool, "nullptr pool", VA_STATUS_ERROR_ALLOCATION_FAILED);
+
+    pool->maxEntries = maxEntries;
+    pool->ctx        = ctx;
+
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_IDLE_TIME_ID,
+        &userFeatureData);
+    pool->idleTime = (double)MOS_MAX(userFeatureData.i32Data, 0) * 1000.0;
+
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_DECODE_CONTEXT_POOL_MAX_MBS_ID,
+        &userFeatureData);
+    pool->maxMbs = (uint32_t)MOS_MAX(userFeatureData.i32Data, 0);
+
+    // The timer waits on the monotonic clock so that wall clock jumps do not delay it
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&pool->timerCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+    pthread_mutex_init(&pool->timerMutex, nullptr);
+    pool->timerDeadline = 0;
+    pool->timerExit     = false;
+
+    if (pthread_create(&pool->timerThread, nullptr, DdiDecode_ContextPoolTimerThread, pool) != 0)
+    {
+        // Without the timer an idle context could be kept forever
+        pthread_cond_destroy(&pool->timerCond);
+        pthread_mutex_destroy(&pool->timerMutex);
+        MOS_FreeMemory(pool);
+        return VA_STATUS_ERROR_OPERATION_FAILED;
+    }
+
+    DdiMediaUtil_InitNamedMutex(&pool->poolMutex, "DdiDecodeContextPool", true);
+
+    mediaCtx->pDecodeCtxPool = pool;
+    return VA_STATUS_SUCCESS;
+}
+
+void DdiDecode_ContextPoolDestroy(VADriverContextP ctx)
+{
+    PDDI_MEDIA_CONTEXT mediaCtx = (ctx != nullptr) ? DdiMedia_GetMediaContext(ctx) : nullptr;
+    if (mediaCtx == nullptr || mediaCtx->pDecodeCtxPool == nullptr)
+    {
+        return;
+    }
+
+    PDDI_DECODE_CONTEXT_POOL pool = mediaCtx->pDecodeCtxPool;
+
+    pthread_mutex_lock(&pool->timerMutex);
+    pool->timerExit = true;
+    pthread_cond_signal(&pool->timerCond);
+    pthread_mutex_unlock(&pool->timerMutex);
+    pthread_join(pool->timerThread, nullptr);
+    pthread_cond_destroy(&pool->timerCond);
+    pthread_mutex_destroy(&pool->timerMutex);
+
+    DDI_NORMALMESSAGE("Decode context pool: %llu hits, %llu misses, %llu evictions (%llu by the idle timer), avg create %.1f us on hit, %.1f us on miss.",
+        (unsigned long long)pool->hits,
+        (unsigned long long)pool->misses,
+        (unsigned long long)pool->evictions,
+        (unsigned long long)pool->timerEvictions,
+        pool->hits ? pool->hitCreateTime / pool->hits : 0.0,
+        pool->misses ? pool->missCreateTime / pool->misses : 0.0);
+
+    while (pool->numEntries > 0)
+    {
+        DdiDecodeCleanUp(ctx, DdiDecode_ContextPoolRemove(pool, pool->numEntries - 1));
+    }
+
+    DdiMediaUtil_DestroyMutex(&pool->poolMutex);
+    MOS_FreeMemory(pool);
+    mediaCtx->pDecodeCtxPool = nullptr;
+}
+
+//!
+//! \brief  Create the codec instance of a new decode context
+//!
+//! \param  [in] ctx
+//!     Pointer to VA driver context
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//! \param  [in] decConfigAttr
+//!     Configuration attributes of the context
+//! \param  [in] codecKey
+//!     Key of the codec in the decode factory
+//! \param  [in] pictureWidth
+//!     The width of picture
+//! \param  [in] pictureHeight
+//!     The height of picture
+//! \param  [out] decCtx
+//!     The created ddi decode context
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+static VAStatus DdiDecode_CreateCodecContext(
+    VADriverContextP        ctx,
+    PDDI_MEDIA_CONTEXT      mediaCtx,
+    PDDI_DECODE_CONFIG_ATTR decConfigAttr,
+    std::string             &codecKey,
+    int32_t                 pictureWidth,
+    int32_t                 pictureHeight,
+    PDDI_DECODE_CONTEXT     *decCtxOut)
+{
+    MOS_CONTEXT                       mosCtx = {};
+    DdiMediaDecode                    *ddiDecBase;
+    PDDI_DECODE_CONTEXT               decCtx;
+    VAStatus                          va = VA_STATUS_SUCCESS;
 
     ddiDecBase = DdiDecodeFactory::CreateCodec(codecKey, nullptr);
 
@@ -284,7 +692,7 @@ VAStatus DdiDecode_CreateContext (
         return VA_STATUS_ERROR_ALLOCATION_FAILED;
     }
 
-    if (ddiDecBase->BasicInit(&decConfigAttr) != VA_STATUS_SUCCESS)
+    if (ddiDecBase->BasicInit(decConfigAttr) != VA_STATUS_SUCCESS)
     {
         MOS_Delete(ddiDecBase);
         return VA_STATUS_ERROR_ALLOCATION_FAILED;
@@ -342,6 +750,108 @@ VAStatus DdiDecode_CreateContext (
         return va;
     }
 
+    *decCtxOut = decCtx;
+    return va;
+}
+
+/*
+ *  vpgDecodeCreateContext - Create a decode context
+ *  dpy: display
+ *  config_id: configuration for the context
+ *  picture_width: coded picture width
+ *  picture_height: coded picture height
+ *  render_targets: render targets (surfaces) tied to the context
+ *  num_render_targets: number of render targets in the above array
+ *  context: created context id upon return
+ */
+VAStatus DdiDecode_CreateContext (
+    VADriverContextP    ctx,
+    VAConfigID          configId,
+    int32_t             pictureWidth,
+    int32_t             pictureHeight,
+    int32_t             flag,
+    VASurfaceID        *renderTargets,
+    int32_t             numRenderTargets,
+    VAContextID        *context
+)
+{
+    PDDI_MEDIA_VACONTEXT_HEAP_ELEMENT contextHeapElement;
+    DdiMediaDecode                    *ddiDecBase;
+    DDI_DECODE_CONFIG_ATTR            decConfigAttr;
+
+    DDI_UNUSED(flag);
+
+    VAStatus va            = VA_STATUS_SUCCESS;
+    decConfigAttr.uiDecSliceMode = VA_DEC_SLICE_MODE_BASE;
+    *context            = VA_INVALID_ID;
+
+    uint16_t mode               = CODECHAL_DECODE_MODE_AVCVLD;
+
+    DDI_CHK_NULL(ctx, "nullptr Ctx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    PDDI_MEDIA_CONTEXT mediaCtx  = DdiMedia_GetMediaContext(ctx);
+    DDI_CHK_NULL(mediaCtx, "nullptr mediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    PDDI_DECODE_CONTEXT decCtx = nullptr;
+    if (numRenderTargets > DDI_MEDIA_MAX_SURFACE_NUMBER_CONTEXT)
+    {
+        return VA_STATUS_ERROR_MAX_NUM_EXCEEDED;
+    }
+
+    std::string codecKey = DECODE_ID_NONE;
+    double      startTime = MOS_GetTime();
+
+    DDI_CHK_NULL(mediaCtx->m_caps, "nullptr m_caps", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_RET(mediaCtx->m_caps->GetDecConfigAttr(
+            configId + DDI_CODEC_GEN_CONFIG_ATTRIBUTES_DEC_BASE,
+            &decConfigAttr.profile,
+            &decConfigAttr.entrypoint,
+            &decConfigAttr.uiDecSliceMode,
+            &decConfigAttr.uiEncryptionType,
+            &decConfigAttr.uiDecProcessingType),"Invalide config_id!");
+
+    mode = mediaCtx->m_caps->GetDecodeCodecMode(decConfigAttr.profile);
+    codecKey =  mediaCtx->m_caps->GetDecodeCodecKey(decConfigAttr.profile);
+    va       =  mediaCtx->m_caps->CheckDecodeResolution(
+                mode,
+                decConfigAttr.profile,
+                pictureWidth,
+                pictureHeight);
+    if (va != VA_STATUS_SUCCESS)
+    {
+        DdiDecodeCleanUp(ctx,decCtx);
+        return va;
+    }
+
+    PDDI_DECODE_CONTEXT_POOL pool = mediaCtx->pDecodeCtxPool;
+    if (pool != nullptr)
+    {
+        decCtx = DdiDecode_ContextPoolAcquire(
+            ctx,
+            pool,
+            &decConfigAttr,
+            (uint32_t)pictureWidth,
+            (uint32_t)pictureHeight);
+    }
+    bool reused = (decCtx != nullptr);
+
+    if (!reused)
+    {
+        va = DdiDecode_CreateCodecContext(
+            ctx,
+            mediaCtx,
+            &decConfigAttr,
+            codecKey,
+            pictureWidth,
+            pictureHeight,
+            &decCtx);
+        if (va != VA_STATUS_SUCCESS)
+        {
+            return va;
+        }
+    }
+    ddiDecBase = decCtx->m_ddiDecode;
+
     DdiDecode_GetDisplayInfo(ctx);
 
     // register render targets
@@ -386,6 +896,23 @@ VAStatus DdiDecode_CreateContext (
     {
         decCtx->RecListSurfaceID[i] = VA_INVALID_ID;
     }
+
+    if (pool != nullptr)
+    {
+        double createTime = MOS_GetTime() - startTime;
+        DdiMediaUtil_LockMutex(&pool->poolMutex);
+        if (reused)
+        {
+            pool->hits++;
+            pool->hitCreateTime += createTime;
+        }
+        else
+        {
+            pool->misses++;
+            pool->missCreateTime += createTime;
+        }
+        DdiMediaUtil_UnLockMutex(&pool->poolMutex);
+    }
     return va;
 }
 
@@ -408,6 +935,21 @@ VAStatus DdiDecode_DestroyContext (
     mediaCtx->uiNumDecoders--;
     DdiMediaUtil_UnLockMutex(&mediaCtx->DecoderMutex);
 
+    if (decCtx->m_ddiDecode)
+    {
+        // No other thread can reach the context through its surfaces afterwards
+        DdiMediaUtil_LockMutex(&mediaCtx->PendingMutex);
+        decCtx->m_ddiDecode->SubmitPendingPictures();
+        DdiMediaUtil_UnLockMutex(&mediaCtx->PendingMutex);
+    }
+
+    // Keep the codec instance for a later vaCreateContext with the same configuration
+    if (mediaCtx->pDecodeCtxPool != nullptr &&
+        DdiDecode_ContextPoolRelease(ctx, mediaCtx->pDecodeCtxPool, decCtx))
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
     if (decCtx->m_ddiDecode) {
     DdiDecodeCleanUp(ctx,decCtx);
         return VA_STATUS_SUCCESS;
@@ -415,3 +957,25 @@ VAStatus DdiDecode_DestroyContext (
 
     return VA_STATUS_SUCCESS;
 }
+
+VAStatus DdiDecode_SubmitPendingPictures(PDDI_MEDIA_SURFACE surface)
+{
+    if (surface == nullptr || surface->pMediaCtx == nullptr || surface->pPendingDecCtx == nullptr)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    // The owner clears pPendingDecCtx under its own lock; holding PendingMutex
+    // keeps the context from being destroyed or pooled while it is used here
+    PDDI_MEDIA_CONTEXT mediaCtx = surface->pMediaCtx;
+    VAStatus           vaStatus = VA_STATUS_SUCCESS;
+    DdiMediaUtil_LockMutex(&mediaCtx->PendingMutex);
+    PDDI_DECODE_CONTEXT decCtx = (PDDI_DECODE_CONTEXT)surface->pPendingDecCtx;
+    if (decCtx != nullptr && decCtx->m_ddiDecode != nullptr)
+    {
+        vaStatus = decCtx->m_ddiDecode->SubmitPendingPictures();
+    }
+    DdiMediaUtil_UnLockMutex(&mediaCtx->PendingMutex);
+
+    return vaStatus;
+}
@@ -79,10 +79,63 @@ struct DDI_DECODE_CONTEXT
     uint32_t                        dwSliceParamBufNum;
     uint32_t                        dwSliceCtrlBufNum;
     uint32_t                        uiDecProcessingType;
+    // Render target of each status report slot, so vaSyncSurface can find the
+    // surface of a report without searching the surface heap by bo
+    VASurfaceID                     curRTSurfaceID;
+    VASurfaceID                     StatusReportSurfaceID[CODECHAL_DECODE_STATUS_NUM];
 };
 
 typedef struct DDI_DECODE_CONTEXT *PDDI_DECODE_CONTEXT;
 
+#define DDI_DECODE_CONTEXT_POOL_MAX_SIZE            8
+
+//!
+//! \struct DDI_DECODE_CONTEXT_POOL_ENTRY
+//! \brief  Decode context parked in the context pool
+//!
+typedef struct _DDI_DECODE_CONTEXT_POOL_ENTRY
+{
+    PDDI_DECODE_CONTEXT     decCtx;
+    DDI_DECODE_CONFIG_ATTR  configAttr;
+    uint32_t                width;
+    uint32_t                height;
+    uint32_t                numMbs;                                 // Frame size in macroblocks, used to bound pool memory
+    double                  releaseTime;                            // Monotonic time when the context was parked (us)
+}DDI_DECODE_CONTEXT_POOL_ENTRY, *PDDI_DECODE_CONTEXT_POOL_ENTRY;
+
+//!
+//! \struct DDI_DECODE_CONTEXT_POOL
+//! \brief  Per display pool of decode contexts for fast vaDestroyContext/vaCreateContext churn
+//! \details Only AVC and HEVC contexts are parked, the other standards cannot reset
+//!          their stream state and are destroyed as before
+//!
+typedef struct _DDI_DECODE_CONTEXT_POOL
+{
+    DDI_DECODE_CONTEXT_POOL_ENTRY   entries[DDI_DECODE_CONTEXT_POOL_MAX_SIZE];   // Ordered from oldest to newest
+    uint32_t                        numEntries;
+    uint32_t                        maxEntries;
+    double                          idleTime;                       // Max time a context stays parked (us)
+    uint32_t                        maxMbs;                         // Max sum of numMbs of all parked contexts
+    uint32_t                        pooledMbs;
+    MEDIA_MUTEX_T                   poolMutex;
+    VADriverContextP                ctx;                            // Driver context the parked contexts are destroyed with
+
+    // Idle timer, destroys the oldest parked context once its idle time is over
+    pthread_t                       timerThread;
+    pthread_mutex_t                 timerMutex;                     // Protects timerDeadline and timerExit, taken after poolMutex
+    pthread_cond_t                  timerCond;
+    double                          timerDeadline;                  // Eviction time of the oldest parked context (us), 0 if none
+    bool                            timerExit;
+
+    // Statistics
+    uint64_t                        hits;
+    uint64_t                        misses;
+    uint64_t                        evictions;
+    uint64_t                        timerEvictions;                 // Evictions done by the idle timer
+    double                          hitCreateTime;                  // Accumulated vaCreateContext latency (us)
+    double                          missCreateTime;
+}DDI_DECODE_CONTEXT_POOL, *PDDI_DECODE_CONTEXT_POOL;
+
 static __inline PDDI_DECODE_CONTEXT DdiDecode_GetDecContextFromPVOID (void *decCtx)
 {
     return (PDDI_DECODE_CONTEXT)decCtx;
@@ -226,4 +279,43 @@ VAStatus DdiDecode_DestroyContext (
     VAContextID         context
 );
 
+//!
+//! \brief  Initialize the decode context pool
+//!
+//! \details Starts the idle timer which destroys the parked contexts
+//!          once their idle time is over
+//!
+//! \param  [in] ctx
+//!     Pointer to VA driver context
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success or disabled, else fail reason
+//!
+VAStatus DdiDecode_ContextPoolInit(VADriverContextP ctx, PDDI_MEDIA_CONTEXT mediaCtx);
+
+//!
+//! \brief  Destroy the parked decode contexts and the decode context pool
+//!
+//! \param  [in] ctx
+//!     Pointer to VA driver context
+//!
+void DdiDecode_ContextPoolDestroy(VADriverContextP ctx);
+
+//!
+//! \brief  Submit the batched decode pictures that write the surface
+//!
+//! \details Called before waiting on, querying, locking or destroying the surface,
+//!          from any thread; serialized against destroying the decode context by
+//!          the PendingMutex of the media context
+//!
+//! \param  [in] surface
+//!     Pointer to media surface
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+VAStatus DdiDecode_SubmitPendingPictures(PDDI_MEDIA_SURFACE surface);
+
 #endif
@@ -422,6 +422,12 @@ VAStatus DdiEncode_CreateContext(
     *context = (VAContextID)(vaContextHeapElmt->uiVaContextID + DDI_MEDIA_VACONTEXTID_OFFSET_ENCODER);
     DdiMediaUtil_UnLockMutex(&mediaDrvCtx->EncoderMutex);
 
+    // A failure here only means the stream is submitted on its own
+    if (DdiEncode_AutoMfeAttach(mediaDrvCtx, encCtx) != VA_STATUS_SUCCESS)
+    {
+        DDI_NORMALMESSAGE("Encode context is not attached to auto MFE.");
+    }
+
     return vaStatus;
 }
 
@@ -445,8 +451,14 @@ VAStatus DdiEncode_DestroyContext(VADriverContextP ctx, VAContextID context)
 
     Codechal *codecHal = encCtx->pCodecHal;
 
+    DdiEncode_AutoMfeDetach(mediaCtx, encCtx);
+
     if (nullptr != encCtx->m_encode)
     {
+        // No other thread can reach the context through its surfaces afterwards
+        DdiMediaUtil_LockMutex(&mediaCtx->PendingMutex);
+        encCtx->m_encode->SubmitPendingPictures();
+        DdiMediaUtil_UnLockMutex(&mediaCtx->PendingMutex);
         encCtx->m_encode->FreeCompBuffer();
         if(nullptr != encCtx->m_encode->m_codechalSettings)
         {
@@ -540,7 +552,11 @@ VAStatus DdiEncode_BeginPicture(
     DDI_CHK_NULL(encCtx, "nullptr encCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(encCtx->m_encode, "nullptr encCtx->m_encode", VA_STATUS_ERROR_INVALID_CONTEXT);
 
-    VAStatus vaStatus = encCtx->m_encode->BeginPicture(ctx, context, render_target);
+    // The previous frame of this stream must reach the hardware before its context is reused
+    VAStatus vaStatus = DdiEncode_AutoMfeFlushContext(encCtx->pMediaCtx, encCtx);
+    DDI_CHK_RET(vaStatus, "Failed to submit pending auto MFE frames!");
+
+    vaStatus = encCtx->m_encode->BeginPicture(ctx, context, render_target);
     DDI_FUNCTION_EXIT(vaStatus);
     return vaStatus;
 }
@@ -581,10 +597,98 @@ VAStatus DdiEncode_EndPicture(VADriverContextP ctx, VAContextID context)
     DDI_CHK_NULL(encCtx->m_encode, "nullptr encCtx->m_encode", VA_STATUS_ERROR_INVALID_CONTEXT);
 
     VAStatus vaStatus = encCtx->m_encode->EndPicture(ctx, context);
+    if (vaStatus == VA_STATUS_SUCCESS && encCtx->bAutoMfe)
+    {
+        vaStatus = DdiEncode_AutoMfeQueue(encCtx->pMediaCtx, encCtx);
+    }
     DDI_FUNCTION_EXIT(vaStatus);
     return vaStatus;
 }
 
+//!
+//! \brief  Execute ENC and PAK of all sub contexts in one MFE submission
+//!
+//! \param  [in] encodeMfeContext
+//!     Pointer to ddi encode MFE context
+//! \param  [in] encodeContexts
+//!     Sub contexts to submit, all of them have finished EndPicture
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+static VAStatus DdiEncode_MfeExecute(
+    PDDI_ENCODE_MFE_CONTEXT             encodeMfeContext,
+    std::vector<PDDI_ENCODE_CONTEXT>    &encodeContexts)
+{
+    PDDI_ENCODE_CONTEXT encodeContext = nullptr;
+    int32_t validContextNumber        = (int32_t)encodeContexts.size();
+
+    CmDevice *device = encodeMfeContext->mfeEncodeSharedState->pCmDev;
+    CmTask   *task   = encodeMfeContext->mfeEncodeSharedState->pCmTask;
+    CmQueue  *queue  = encodeMfeContext->mfeEncodeSharedState->pCmQueue;
+    CodechalEncodeMdfKernelResource *resMbencKernel = encodeMfeContext->mfeEncodeSharedState->resMbencKernel;
+    SurfaceIndex *vmeSurface    = encodeMfeContext->mfeEncodeSharedState->vmeSurface;
+    SurfaceIndex *commonSurface = encodeMfeContext->mfeEncodeSharedState->commonSurface;
+
+
+    MOS_ZeroMemory(encodeMfeContext->mfeEncodeSharedState, sizeof(MfeSharedState));
+
+    encodeMfeContext->mfeEncodeSharedState->pCmDev   = device;
+    encodeMfeContext->mfeEncodeSharedState->pCmTask  = task;
+    encodeMfeContext->mfeEncodeSharedState->pCmQueue = queue;
+    encodeMfeContext->mfeEncodeSharedState->resMbencKernel = resMbencKernel;
+    encodeMfeContext->mfeEncodeSharedState->vmeSurface     = vmeSurface;
+    encodeMfeContext->mfeEncodeSharedState->commonSurface  = commonSurface;
+
+    // Call Enc functions for all the sub contexts
+    MOS_STATUS status = MOS_STATUS_SUCCESS;
+    for (int32_t i = 0; i < validContextNumber; i++)
+    {
+        encodeContext  = encodeContexts[i];
+        if (encodeContext->vaEntrypoint != VAEntrypointFEI )
+        {
+            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_ENC;
+        }
+        else
+        {
+            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_FEI_ENC;
+        }
+
+        CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encodeContext->pCodecHal);
+
+        status = encoder->Execute(&encodeContext->EncodeParams);
+        if (MOS_STATUS_SUCCESS != status)
+        {
+            DDI_ASSERTMESSAGE("DDI:Failed in Execute Enc!");
+            return VA_STATUS_ERROR_ENCODING_ERROR;
+        }
+    }
+
+    // Call Pak functions for all the sub contexts
+    for (int32_t i = 0; i < validContextNumber; i++)
+    {
+        encodeContext  = encodeContexts[i];
+        if (encodeContext->vaEntrypoint != VAEntrypointFEI )
+        {
+            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_PAK;
+        }
+        else
+        {
+            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_FEI_PAK;
+        }
+
+        CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encodeContext->pCodecHal);
+        status = encoder->Execute(&encodeContext->EncodeParams);
+        if (MOS_STATUS_SUCCESS != status)
+        {
+            DDI_ASSERTMESSAGE("DDI:Failed in Execute Pak!");
+            return VA_STATUS_ERROR_ENCODING_ERROR;
+        }
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
 VAStatus DdiEncode_MfeSubmit(
     VADriverContextP    ctx,
     VAMFContextID      mfe_context,
@@ -631,69 +735,542 @@ VAStatus DdiEncode_MfeSubmit(
         validContextNumber++;
     }
 
-    CmDevice *device = encodeMfeContext->mfeEncodeSharedState->pCmDev;
-    CmTask   *task   = encodeMfeContext->mfeEncodeSharedState->pCmTask;
-    CmQueue  *queue  = encodeMfeContext->mfeEncodeSharedState->pCmQueue;
-    CodechalEncodeMdfKernelResource *resMbencKernel = encodeMfeContext->mfeEncodeSharedState->resMbencKernel;
-    SurfaceIndex *vmeSurface    = encodeMfeContext->mfeEncodeSharedState->vmeSurface;
-    SurfaceIndex *commonSurface = encodeMfeContext->mfeEncodeSharedState->commonSurface;
+    return DdiEncode_MfeExecute(encodeMfeContext, encodeContexts);
+}
 
 
-    MOS_ZeroMemory(encodeMfeContext->mfeEncodeSharedState, sizeof(MfeSharedState));
+static void *DdiEncode_AutoMfeTimerThread(void *arg);
 
-    encodeMfeContext->mfeEncodeSharedState->pCmDev   = device;
-    encodeMfeContext->mfeEncodeSharedState->pCmTask  = task;
-    encodeMfeContext->mfeEncodeSharedState->pCmQueue = queue;
-    encodeMfeContext->mfeEncodeSharedState->resMbencKernel = resMbencKernel;
-    encodeMfeContext->mfeEncodeSharedState->vmeSurface     = vmeSurface;
-    encodeMfeContext->mfeEncodeSharedState->commonSurface  = commonSurface;
+//!
+//! \brief  Current time of the automatic MFE scheduler
+//!
+//! \details Deadlines are taken on the monotonic clock the timer waits on, so that
+//!          wall clock jumps neither delay nor hasten a submission
+//!
+//! \return double
+//!     Monotonic time in microseconds
+//!
+static double DdiEncode_AutoMfeGetTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000000.0 + (double)now.tv_nsec / 1000.0;
+}
 
-    // Call Enc functions for all the sub contexts
-    MOS_STATUS status = MOS_STATUS_SUCCESS;
-    for (int32_t i = 0; i < validContextNumber; i++)
+VAStatus DdiEncode_AutoMfeInit(PDDI_MEDIA_CONTEXT mediaCtx)
+{
+    DDI_CHK_NULL(mediaCtx, "nullptr mediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    mediaCtx->pAutoMfe = nullptr;
+
+    // MFE is only supported on SKL
+    if (!GFX_IS_PRODUCT(mediaCtx->platform, IGFX_SKYLAKE))
     {
-        encodeContext  = encodeContexts[i];
-        if (encodeContext->vaEntrypoint != VAEntrypointFEI )
+        return VA_STATUS_SUCCESS;
+    }
+
+    MOS_USER_FEATURE_VALUE_DATA userFeatureData;
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_ENCODE_AUTO_MFE_ENABLE_ID,
+        &userFeatureData);
+    if (userFeatureData.i32Data == 0)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    PDDI_ENCODE_AUTO_MFE autoMfe = MOS_New(DDI_ENCODE_AUTO_MFE);
+    DDI_CHK_NULL(autoMfe, "nullptr autoMfe", VA_STATUS_ERROR_ALLOCATION_FAILED);
+
+    autoMfe->mfeContext = (PDDI_ENCODE_MFE_CONTEXT)MOS_AllocAndZeroMemory(sizeof(DDI_ENCODE_MFE_CONTEXT));
+    if (autoMfe->mfeContext != nullptr)
+    {
+        autoMfe->mfeContext->mfeEncodeSharedState = (MfeSharedState*)MOS_AllocAndZeroMemory(sizeof(MfeSharedState));
+    }
+    if (autoMfe->mfeContext == nullptr || autoMfe->mfeContext->mfeEncodeSharedState == nullptr)
+    {
+        if (autoMfe->mfeContext != nullptr)
         {
-            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_ENC;
+            MOS_FreeMemory(autoMfe->mfeContext);
+        }
+        MOS_Delete(autoMfe);
+        return VA_STATUS_ERROR_ALLOCATION_FAILED;
+    }
+    DdiMediaUtil_InitNamedMutex(&autoMfe->mfeContext->encodeMfeMutex, "DdiEncodeMfe", false);
+    DdiMediaUtil_InitNamedMutex(&autoMfe->autoMfeMutex, "DdiAutoMfe", false);
+
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_ENCODE_AUTO_MFE_WINDOW_ID,
+        &userFeatureData);
+    autoMfe->latencyWindow = userFeatureData.i32Data > 0 ?
+        (uint32_t)userFeatureData.i32Data : DDI_ENCODE_AUTO_MFE_DEFAULT_WINDOW;
+    autoMfe->maxBatchSize  = DDI_ENCODE_AUTO_MFE_MAX_BATCH;
+
+    // The timer waits on the monotonic clock so that wall clock jumps do not delay it
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&autoMfe->timerCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+    pthread_mutex_init(&autoMfe->timerMutex, nullptr);
+    autoMfe->timerDeadline = 0;
+    autoMfe->timerExit     = false;
+
+    if (pthread_create(&autoMfe->timerThread, nullptr, DdiEncode_AutoMfeTimerThread, autoMfe) != 0)
+    {
+        // Without the timer a lone frame could wait forever
+        pthread_cond_destroy(&autoMfe->timerCond);
+        pthread_mutex_destroy(&autoMfe->timerMutex);
+        DdiMediaUtil_DestroyMutex(&autoMfe->mfeContext->encodeMfeMutex);
+        DdiMediaUtil_DestroyMutex(&autoMfe->autoMfeMutex);
+        MOS_FreeMemory(autoMfe->mfeContext->mfeEncodeSharedState);
+        MOS_FreeMemory(autoMfe->mfeContext);
+        MOS_Delete(autoMfe);
+        return VA_STATUS_ERROR_OPERATION_FAILED;
+    }
+
+    mediaCtx->pAutoMfe = autoMfe;
+    return VA_STATUS_SUCCESS;
+}
+
+void DdiEncode_AutoMfeDestroy(PDDI_MEDIA_CONTEXT mediaCtx)
+{
+    if (mediaCtx == nullptr || mediaCtx->pAutoMfe == nullptr)
+    {
+        return;
+    }
+
+    PDDI_ENCODE_AUTO_MFE autoMfe = mediaCtx->pAutoMfe;
+
+    pthread_mutex_lock(&autoMfe->timerMutex);
+    autoMfe->timerExit = true;
+    pthread_cond_signal(&autoMfe->timerCond);
+    pthread_mutex_unlock(&autoMfe->timerMutex);
+    pthread_join(autoMfe->timerThread, nullptr);
+    pthread_cond_destroy(&autoMfe->timerCond);
+    pthread_mutex_destroy(&autoMfe->timerMutex);
+
+    DDI_NORMALMESSAGE("Auto MFE: %llu frames in %llu batches, %llu single submissions, %llu by the deadline timer.",
+        (unsigned long long)autoMfe->submittedFrames,
+        (unsigned long long)autoMfe->submittedBatches,
+        (unsigned long long)autoMfe->singleSubmissions,
+        (unsigned long long)autoMfe->timerSubmissions);
+
+    autoMfe->pendingContexts.clear();
+
+    PDDI_ENCODE_MFE_CONTEXT mfeContext = autoMfe->mfeContext;
+    mfeContext->pDdiEncodeContexts.clear();
+    mfeContext->pDdiEncodeContexts.shrink_to_fit();
+    mfeContext->mfeEncodeSharedState->encoders.clear();
+    mfeContext->mfeEncodeSharedState->encoders.shrink_to_fit();
+    DdiMediaUtil_DestroyMutex(&mfeContext->encodeMfeMutex);
+    MOS_FreeMemory(mfeContext->mfeEncodeSharedState);
+    MOS_FreeMemory(mfeContext);
+
+    DdiMediaUtil_DestroyMutex(&autoMfe->autoMfeMutex);
+    MOS_Delete(autoMfe);
+    mediaCtx->pAutoMfe = nullptr;
+}
+
+VAStatus DdiEncode_AutoMfeAttach(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx)
+{
+    DDI_CHK_NULL(mediaCtx, "nullptr mediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(encCtx, "nullptr encCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    PDDI_ENCODE_AUTO_MFE autoMfe = mediaCtx->pAutoMfe;
+    if (autoMfe == nullptr)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    // Only legacy AVC streams are batched, FEI keeps the explicit MFE interface
+    if (encCtx->vaEntrypoint != VAEntrypointEncSlice ||
+        !mediaCtx->m_caps->IsMfeSupportedProfile(encCtx->vaProfile))
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encCtx->pCodecHal);
+    DDI_CHK_NULL(encoder, "nullptr codechal encoder", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    PDDI_ENCODE_MFE_CONTEXT mfeContext = autoMfe->mfeContext;
+    DdiMediaUtil_LockMutex(&mfeContext->encodeMfeMutex);
+    mfeContext->pDdiEncodeContexts.push_back(encCtx);
+    mfeContext->currentStreamId++;
+    DdiMediaUtil_UnLockMutex(&mfeContext->encodeMfeMutex);
+
+    encoder->m_mfeEnabled           = true;
+    encoder->m_mfeEncodeSharedState = mfeContext->mfeEncodeSharedState;
+
+    encCtx->bAutoMfe        = true;
+    encCtx->bAutoMfePending = false;
+
+    return VA_STATUS_SUCCESS;
+}
+
+void DdiEncode_AutoMfeDetach(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx)
+{
+    if (mediaCtx == nullptr || mediaCtx->pAutoMfe == nullptr ||
+        encCtx == nullptr || !encCtx->bAutoMfe)
+    {
+        return;
+    }
+
+    DdiEncode_AutoMfeFlushContext(mediaCtx, encCtx);
+
+    PDDI_ENCODE_MFE_CONTEXT mfeContext = mediaCtx->pAutoMfe->mfeContext;
+    DdiMediaUtil_LockMutex(&mfeContext->encodeMfeMutex);
+    for (auto it = mfeContext->pDdiEncodeContexts.begin(); it != mfeContext->pDdiEncodeContexts.end(); ++it)
+    {
+        if (*it == encCtx)
+        {
+            mfeContext->pDdiEncodeContexts.erase(it);
+            break;
+        }
+    }
+    DdiMediaUtil_UnLockMutex(&mfeContext->encodeMfeMutex);
+
+    // The shared state belongs to the scheduler and goes away with it
+    CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encCtx->pCodecHal);
+    if (encoder != nullptr)
+    {
+        encoder->m_mfeEnabled           = false;
+        encoder->m_mfeEncodeSharedState = nullptr;
+    }
+
+    encCtx->bAutoMfe        = false;
+    encCtx->bAutoMfePending = false;
+}
+
+//!
+//! \brief  Submit the pending frames of the automatic MFE scheduler
+//!
+//! \details Caller must hold autoMfeMutex. Pending frames are split in batches of
+//!          maxBatchSize in EndPicture order; a frame without a batch partner goes
+//!          through the regular single stream path.
+//!
+//! \param  [in] autoMfe
+//!     Pointer to automatic MFE state
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+static VAStatus DdiEncode_AutoMfeSubmitPending(PDDI_ENCODE_AUTO_MFE autoMfe)
+{
+    VAStatus                         vaStatus = VA_STATUS_SUCCESS;
+    std::vector<PDDI_ENCODE_CONTEXT> batch;
+
+    while (!autoMfe->pendingContexts.empty())
+    {
+        size_t batchSize = MOS_MIN(autoMfe->pendingContexts.size(), (size_t)autoMfe->maxBatchSize);
+        batch.assign(autoMfe->pendingContexts.begin(), autoMfe->pendingContexts.begin() + batchSize);
+        autoMfe->pendingContexts.erase(autoMfe->pendingContexts.begin(), autoMfe->pendingContexts.begin() + batchSize);
+
+        for (auto encCtx : batch)
+        {
+            CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encCtx->pCodecHal);
+            encoder->m_mfeEncodeParams.submitIndex  = 0;
+            encoder->m_mfeEncodeParams.submitNumber = 1;
+            encoder->m_mfeEncodeParams.streamId     = 0;
+            encCtx->bAutoMfePending                 = false;
+        }
+
+        VAStatus status = VA_STATUS_SUCCESS;
+        if (batchSize == 1)
+        {
+            // Nothing to share the kernel dispatch with, take the regular path
+            PDDI_ENCODE_CONTEXT   encCtx  = batch[0];
+            CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encCtx->pCodecHal);
+
+            encCtx->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_ENC_PAK;
+            encoder->m_mfeEnabled = false;
+            if (encoder->Execute(&encCtx->EncodeParams) != MOS_STATUS_SUCCESS)
+            {
+                DDI_ASSERTMESSAGE("DDI:Failed in Execute!");
+                status = VA_STATUS_ERROR_ENCODING_ERROR;
+            }
+            encoder->m_mfeEnabled = true;
+            autoMfe->singleSubmissions++;
         }
         else
         {
-            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_FEI_ENC;
+            status = DdiEncode_MfeExecute(autoMfe->mfeContext, batch);
+            autoMfe->submittedBatches++;
         }
+        autoMfe->submittedFrames += batchSize;
 
-        CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encodeContext->pCodecHal);
+        // Keep submitting the remaining frames, report the first failure
+        if (status != VA_STATUS_SUCCESS && vaStatus == VA_STATUS_SUCCESS)
+        {
+            vaStatus = status;
+        }
+    }
 
-        status = encoder->Execute(&encodeContext->EncodeParams);
-        if (MOS_STATUS_SUCCESS != status)
+    return vaStatus;
+}
+
+//!
+//! \brief  Point the deadline timer at the oldest pending frame
+//!
+//! \details Caller must hold autoMfeMutex
+//!
+//! \param  [in] autoMfe
+//!     Pointer to automatic MFE state
+//!
+static void DdiEncode_AutoMfeArmTimer(PDDI_ENCODE_AUTO_MFE autoMfe)
+{
+    double deadline = 0;
+    for (auto pending : autoMfe->pendingContexts)
+    {
+        if (deadline == 0 || pending->autoMfeDeadline < deadline)
         {
-            DDI_ASSERTMESSAGE("DDI:Failed in Execute Enc!");
-            return VA_STATUS_ERROR_ENCODING_ERROR;
+            deadline = pending->autoMfeDeadline;
         }
     }
 
-    // Call Pak functions for all the sub contexts
-    for (int32_t i = 0; i < validContextNumber; i++)
+    pthread_mutex_lock(&autoMfe->timerMutex);
+    if (deadline != autoMfe->timerDeadline)
     {
-        encodeContext  = encodeContexts[i];
-        if (encodeContext->vaEntrypoint != VAEntrypointFEI )
+        autoMfe->timerDeadline = deadline;
+        pthread_cond_signal(&autoMfe->timerCond);
+    }
+    pthread_mutex_unlock(&autoMfe->timerMutex);
+}
+
+//!
+//! \brief  Submit the pending frames once the oldest of them is due
+//!
+//! \details Without it a frame whose partners never come would wait until the
+//!          application syncs on it, however long the latency cap.
+//!
+//! \param  [in] arg
+//!     Pointer to automatic MFE state
+//!
+static void *DdiEncode_AutoMfeTimerThread(void *arg)
+{
+    PDDI_ENCODE_AUTO_MFE autoMfe = (PDDI_ENCODE_AUTO_MFE)arg;
+
+    pthread_mutex_lock(&autoMfe->timerMutex);
+    while (!autoMfe->timerExit)
+    {
+        if (autoMfe->timerDeadline == 0)
         {
-            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_PAK;
+            pthread_cond_wait(&autoMfe->timerCond, &autoMfe->timerMutex);
+            continue;
         }
-        else
+
+        double remaining = autoMfe->timerDeadline - DdiEncode_AutoMfeGetTime();
+        if (remaining > 0)
         {
-            encodeContext->EncodeParams.ExecCodecFunction = CODECHAL_FUNCTION_FEI_PAK;
+            struct timespec wakeup;
+            clock_gettime(CLOCK_MONOTONIC, &wakeup);
+            uint64_t ns     = (uint64_t)wakeup.tv_nsec + (uint64_t)(remaining * 1000.0);
+            wakeup.tv_sec  += ns / 1000000000ull;
+            wakeup.tv_nsec  = ns % 1000000000ull;
+            pthread_cond_timedwait(&autoMfe->timerCond, &autoMfe->timerMutex, &wakeup);
+            continue;
         }
 
-        CodechalEncoderState *encoder = dynamic_cast<CodechalEncoderState *>(encodeContext->pCodecHal);
-        status = encoder->Execute(&encodeContext->EncodeParams);
-        if (MOS_STATUS_SUCCESS != status)
+        autoMfe->timerDeadline = 0;
+        pthread_mutex_unlock(&autoMfe->timerMutex);
+
+        // The frames may have been submitted or new ones queued meanwhile
+        DdiMediaUtil_LockMutex(&autoMfe->autoMfeMutex);
+        double now = DdiEncode_AutoMfeGetTime();
+        bool   due = false;
+        for (auto pending : autoMfe->pendingContexts)
         {
-            DDI_ASSERTMESSAGE("DDI:Failed in Execute Pak!");
-            return VA_STATUS_ERROR_ENCODING_ERROR;
+            due = due || now >= pending->autoMfeDeadline;
+        }
+        if (due)
+        {
+            if (DdiEncode_AutoMfeSubmitPending(autoMfe) != VA_STATUS_SUCCESS)
+            {
+                DDI_ASSERTMESSAGE("Failed to submit auto MFE frames on the deadline!");
+            }
+            autoMfe->timerSubmissions++;
         }
+        DdiEncode_AutoMfeArmTimer(autoMfe);
+        DdiMediaUtil_UnLockMutex(&autoMfe->autoMfeMutex);
+
+        pthread_mutex_lock(&autoMfe->timerMutex);
     }
+    pthread_mutex_unlock(&autoMfe->timerMutex);
 
-    return VA_STATUS_SUCCESS;
+    return nullptr;
 }
 
+//!
+//! \brief  Whether a frame can join the pending frames in one MFE submission
+//!
+//! \details The sub streams of an MFE submission share one kernel dispatch, so they
+//!          must be of the same codec, profile and resolution
+//!
+//! \param  [in] pending
+//!     Pointer to the context of a pending frame
+//! \param  [in] encCtx
+//!     Pointer to the context of the new frame
+//!
+//! \return bool
+//!     true if the frames can be batched
+//!
+static bool DdiEncode_AutoMfeIsCompatible(PDDI_ENCODE_CONTEXT pending, PDDI_ENCODE_CONTEXT encCtx)
+{
+    if (pending->wModeType != encCtx->wModeType ||
+        pending->vaProfile != encCtx->vaProfile)
+    {
+        return false;
+    }
+
+    PCODEC_AVC_ENCODE_SEQUENCE_PARAMS pendingSeq = (PCODEC_AVC_ENCODE_SEQUENCE_PARAMS)pending->pSeqParams;
+    PCODEC_AVC_ENCODE_SEQUENCE_PARAMS seq        = (PCODEC_AVC_ENCODE_SEQUENCE_PARAMS)encCtx->pSeqParams;
+    if (pendingSeq == nullptr || seq == nullptr)
+    {
+        return false;
+    }
+
+    return pendingSeq->FrameWidth  == seq->FrameWidth  &&
+           pendingSeq->FrameHeight == seq->FrameHeight &&
+           pendingSeq->Profile     == seq->Profile;
+}
+
+VAStatus DdiEncode_AutoMfeQueue(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx)
+{
+    DDI_CHK_NULL(mediaCtx, "nullptr mediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(mediaCtx->pAutoMfe, "nullptr mediaCtx->pAutoMfe", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(encCtx, "nullptr encCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    PDDI_ENCODE_AUTO_MFE autoMfe = mediaCtx->pAutoMfe;
+
+    // Never hold a frame longer than half of the stream frame interval
+    uint32_t latencyCap = autoMfe->latencyWindow;
+    PCODEC_AVC_ENCODE_SEQUENCE_PARAMS seqParams = (PCODEC_AVC_ENCODE_SEQUENCE_PARAMS)encCtx->pSeqParams;
+    if (seqParams != nullptr && seqParams->FramesPer100Sec != 0)
+    {
+        latencyCap = MOS_MIN(latencyCap, (uint32_t)(50000000ull / seqParams->FramesPer100Sec));
+    }
+
+    DdiMediaUtil_LockMutex(&autoMfe->autoMfeMutex);
+
+    // A frame that cannot share the submission of the pending ones closes their batch
+    VAStatus vaStatus = VA_STATUS_SUCCESS;
+    if (!autoMfe->pendingContexts.empty() &&
+        !DdiEncode_AutoMfeIsCompatible(autoMfe->pendingContexts.front(), encCtx))
+    {
+        vaStatus = DdiEncode_AutoMfeSubmitPending(autoMfe);
+    }
+
+    double now = DdiEncode_AutoMfeGetTime();
+    encCtx->autoMfeDeadline = now + latencyCap;
+    encCtx->bAutoMfePending = true;
+    autoMfe->pendingContexts.push_back(encCtx);
+
+    // Submit once every attached stream has a frame, the batch is full or the oldest frame is due
+    bool submit = autoMfe->pendingContexts.size() >= autoMfe->maxBatchSize ||
+                  autoMfe->pendingContexts.size() >= autoMfe->mfeContext->pDdiEncodeContexts.size();
+    for (auto pending : autoMfe->pendingContexts)
+    {
+        submit = submit || now >= pending->autoMfeDeadline;
+    }
+
+    if (submit)
+    {
+        VAStatus status = DdiEncode_AutoMfeSubmitPending(autoMfe);
+        vaStatus = (vaStatus == VA_STATUS_SUCCESS) ? status : vaStatus;
+    }
+    DdiEncode_AutoMfeArmTimer(autoMfe);
+
+    DdiMediaUtil_UnLockMutex(&autoMfe->autoMfeMutex);
+
+    return vaStatus;
+}
+
+VAStatus DdiEncode_AutoMfeFlush(PDDI_MEDIA_CONTEXT mediaCtx)
+{
+    if (mediaCtx == nullptr || mediaCtx->pAutoMfe == nullptr)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    PDDI_ENCODE_AUTO_MFE autoMfe = mediaCtx->pAutoMfe;
+
+    DdiMediaUtil_LockMutex(&autoMfe->autoMfeMutex);
+    VAStatus vaStatus = DdiEncode_AutoMfeSubmitPending(autoMfe);
+    DdiEncode_AutoMfeArmTimer(autoMfe);
+    DdiMediaUtil_UnLockMutex(&autoMfe->autoMfeMutex);
+
+    return vaStatus;
+}
+
+VAStatus DdiEncode_AutoMfeFlushContext(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx)
+{
+    if (mediaCtx == nullptr || mediaCtx->pAutoMfe == nullptr ||
+        encCtx == nullptr || !encCtx->bAutoMfe)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    PDDI_ENCODE_AUTO_MFE autoMfe  = mediaCtx->pAutoMfe;
+    VAStatus             vaStatus = VA_STATUS_SUCCESS;
+
+    // The pending flag is only stable under the lock, the timer may be submitting
+    DdiMediaUtil_LockMutex(&autoMfe->autoMfeMutex);
+    if (encCtx->bAutoMfePending)
+    {
+        vaStatus = DdiEncode_AutoMfeSubmitPending(autoMfe);
+        DdiEncode_AutoMfeArmTimer(autoMfe);
+    }
+    DdiMediaUtil_UnLockMutex(&autoMfe->autoMfeMutex);
+
+    return vaStatus;
+}
+
+VAStatus DdiEncode_AutoMfeFlushSurface(PDDI_MEDIA_CONTEXT mediaCtx, DDI_MEDIA_SURFACE *surface)
+{
+    if (mediaCtx == nullptr || mediaCtx->pAutoMfe == nullptr || surface == nullptr)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    PDDI_ENCODE_AUTO_MFE autoMfe  = mediaCtx->pAutoMfe;
+    VAStatus             vaStatus = VA_STATUS_SUCCESS;
+
+    DdiMediaUtil_LockMutex(&autoMfe->autoMfeMutex);
+    for (auto pending : autoMfe->pendingContexts)
+    {
+        if (pending->RTtbl.pCurrentRT == surface || pending->RTtbl.pCurrentReconTarget == surface)
+        {
+            vaStatus = DdiEncode_AutoMfeSubmitPending(autoMfe);
+            DdiEncode_AutoMfeArmTimer(autoMfe);
+            break;
+        }
+    }
+    DdiMediaUtil_UnLockMutex(&autoMfe->autoMfeMutex);
+
+    return vaStatus;
+}
+
+VAStatus DdiEncode_SubmitPendingPictures(PDDI_MEDIA_SURFACE surface)
+{
+    if (surface == nullptr || surface->pMediaCtx == nullptr || surface->pPendingEncCtx == nullptr)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    // The owner clears pPendingEncCtx under its own lock; holding PendingMutex
+    // keeps the context from being destroyed while it is used here
+    PDDI_MEDIA_CONTEXT mediaCtx = surface->pMediaCtx;
+    VAStatus           vaStatus = VA_STATUS_SUCCESS;
+    DdiMediaUtil_LockMutex(&mediaCtx->PendingMutex);
+    PDDI_ENCODE_CONTEXT encCtx = (PDDI_ENCODE_CONTEXT)surface->pPendingEncCtx;
+    if (encCtx != nullptr && encCtx->m_encode != nullptr)
+    {
+        vaStatus = encCtx->m_encode->SubmitPendingPictures();
+    }
+    DdiMediaUtil_UnLockMutex(&mediaCtx->PendingMutex);
+
+    return vaStatus;
+}
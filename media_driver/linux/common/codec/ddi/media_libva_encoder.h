@@ -36,6 +36,9 @@
 
 #define DDI_ENCODE_MAX_STATUS_REPORT_BUFFER    CODECHAL_ENCODE_STATUS_NUM
 
+#define DDI_ENCODE_AUTO_MFE_MAX_BATCH           4       // Max frames in one automatic MFE submission
+#define DDI_ENCODE_AUTO_MFE_DEFAULT_WINDOW      2000    // Default automatic MFE latency window (us)
+
 typedef enum _DDI_ENCODE_FEI_ENC_BUFFER_TYPE
 {
     FEI_ENC_BUFFER_TYPE_MVDATA     = 0,
@@ -170,6 +173,11 @@ typedef struct _DDI_ENCODE_CONTEXT
 
     uint8_t                           targetUsage;
 
+    // Automatic MFE batching
+    bool                              bAutoMfe;                 // Stream is attached to the automatic MFE scheduler
+    bool                              bAutoMfePending;          // A frame of this stream waits for submission
+    double                            autoMfeDeadline;          // Latest submission time of the pending frame (monotonic us)
+
 } DDI_ENCODE_CONTEXT, *PDDI_ENCODE_CONTEXT;
 
 typedef struct _DDI_ENCODE_MFE_CONTEXT
@@ -181,6 +189,28 @@ typedef struct _DDI_ENCODE_MFE_CONTEXT
     bool                             isFEI;                         // Support legacy only or FEI only
 }DDI_ENCODE_MFE_CONTEXT, *PDDI_ENCODE_MFE_CONTEXT;
 
+typedef struct _DDI_ENCODE_AUTO_MFE
+{
+    PDDI_ENCODE_MFE_CONTEXT          mfeContext;                    // Internal MFE context shared by the attached streams
+    std::vector<PDDI_ENCODE_CONTEXT> pendingContexts;               // Streams with a frame waiting for submission, in EndPicture order
+    MEDIA_MUTEX_T                    autoMfeMutex;
+    uint32_t                         latencyWindow;                 // Max time a frame waits for other streams (us)
+    uint32_t                         maxBatchSize;                  // Max frames in one submission
+
+    // Deadline timer, submits the pending frames when the oldest one is due
+    pthread_t                        timerThread;
+    pthread_mutex_t                  timerMutex;                    // Protects timerDeadline and timerExit, taken after autoMfeMutex
+    pthread_cond_t                   timerCond;
+    double                           timerDeadline;                 // Deadline of the oldest pending frame (monotonic us), 0 if none
+    bool                             timerExit;
+
+    // Statistics
+    uint64_t                         submittedFrames;
+    uint64_t                         submittedBatches;
+    uint64_t                         singleSubmissions;             // Frames submitted alone through the non-MFE path
+    uint64_t                         timerSubmissions;              // Submissions started by the deadline timer
+}DDI_ENCODE_AUTO_MFE, *PDDI_ENCODE_AUTO_MFE;
+
 static __inline PDDI_ENCODE_CONTEXT DdiEncode_GetEncContextFromPVOID (void *encCtx)
 {
     return (PDDI_ENCODE_CONTEXT)encCtx;
@@ -539,4 +569,120 @@ VAStatus DdiEncode_MfeSubmit(
     VAContextID        *contexts,
     int32_t             num_contexts
 );
+
+//!
+//! \brief  Initialize automatic MFE batching
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success or disabled, else fail reason
+//!
+VAStatus DdiEncode_AutoMfeInit(PDDI_MEDIA_CONTEXT mediaCtx);
+
+//!
+//! \brief  Destroy automatic MFE batching state
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//!
+void DdiEncode_AutoMfeDestroy(PDDI_MEDIA_CONTEXT mediaCtx);
+
+//!
+//! \brief  Attach an encode context to the automatic MFE scheduler
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//! \param  [in] encCtx
+//!     Pointer to ddi encode context
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if attached or not eligible, else fail reason
+//!
+VAStatus DdiEncode_AutoMfeAttach(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx);
+
+//!
+//! \brief  Detach an encode context from the automatic MFE scheduler
+//!
+//! \details Pending frames are submitted before the context is detached
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//! \param  [in] encCtx
+//!     Pointer to ddi encode context
+//!
+void DdiEncode_AutoMfeDetach(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx);
+
+//!
+//! \brief  Queue the current frame of an attached encode context
+//!
+//! \details The frame is submitted together with frames of other streams when the
+//!          batch is full or the latency cap of the oldest pending frame expires
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//! \param  [in] encCtx
+//!     Pointer to ddi encode context
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+VAStatus DdiEncode_AutoMfeQueue(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx);
+
+//!
+//! \brief  Submit all pending frames of the automatic MFE scheduler
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+VAStatus DdiEncode_AutoMfeFlush(PDDI_MEDIA_CONTEXT mediaCtx);
+
+//!
+//! \brief  Submit the pending frames if one of them belongs to an encode context
+//!
+//! \details Called before the context is reused or its coded buffer is mapped
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//! \param  [in] encCtx
+//!     Pointer to ddi encode context
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+VAStatus DdiEncode_AutoMfeFlushContext(PDDI_MEDIA_CONTEXT mediaCtx, PDDI_ENCODE_CONTEXT encCtx);
+
+//!
+//! \brief  Submit the pending frames if one of them reads or writes a surface
+//!
+//! \details Called before the application waits on or queries the surface
+//!
+//! \param  [in] mediaCtx
+//!     Pointer to media context
+//! \param  [in] surface
+//!     Pointer to the surface
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+VAStatus DdiEncode_AutoMfeFlushSurface(PDDI_MEDIA_CONTEXT mediaCtx, DDI_MEDIA_SURFACE *surface);
+
+//!
+//! \brief  Submit the batched pictures that read a surface
+//!
+//! \details Called before waiting on, querying or destroying the surface, from
+//!          any thread; serialized against destroying the encode context by
+//!          the PendingMutex of the media context
+//!
+//! \param  [in] surface
+//!     Pointer to media surface
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+VAStatus DdiEncode_SubmitPendingPictures(PDDI_MEDIA_SURFACE surface);
 #endif
@@ -43,6 +43,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include "media_libva_encoder.h"
+#include "codec_def_common_encode.h"
 #include "media_libvpx_vp9.h"
 
 struct vp9_write_bit_buffer {
@@ -51,30 +52,20 @@ struct vp9_write_bit_buffer {
 };
 
 static
-void vp9_wb_write_bit(struct vp9_write_bit_buffer *wb, int bit)
+void vp9_wb_write_literal(struct vp9_write_bit_buffer *wb, int data, int bits)
 {
-    const int off = wb->bit_offset;
-    const int p = off / 8;
-    const int q = 7 - off % 8;
+    BSBuffer bsBuffer;
+    bsBuffer.pCurrent  = wb->bit_buffer + wb->bit_offset / 8;
+    bsBuffer.BitOffset = (uint8_t)(wb->bit_offset % 8);
 
-    if (q == 7)
-    {
-        wb->bit_buffer[p] = bit << q;
-    }
-    else
-    {
-        wb->bit_buffer[p] &= ~(1 << q);
-        wb->bit_buffer[p] |= bit << q;
-    }
-    wb->bit_offset = off + 1;
+    CodecHal_PutBits(&bsBuffer, (uint32_t)data, (uint32_t)bits);
+    wb->bit_offset += bits;
 }
 
 static
-void vp9_wb_write_literal(struct vp9_write_bit_buffer *wb, int data, int bits)
+void vp9_wb_write_bit(struct vp9_write_bit_buffer *wb, int bit)
 {
-    int bit;
-    for (bit = bits - 1; bit >= 0; bit--)
-        vp9_wb_write_bit(wb, (data >> bit) & 1);
+    vp9_wb_write_literal(wb, bit & 1, 1);
 }
 
 static
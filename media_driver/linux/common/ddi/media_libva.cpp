@@ -46,11 +46,15 @@
 #endif
 #include "media_libva_vp.h"
 #include "mos_os.h"
+#include "mos_metrics.h"
+#include "mos_copy.h"
+#include "mos_resource_recycler.h"
 
 #include "hwinfo_linux.h"
 #include "codechal_memdecomp.h"
 #include "mos_solo_generic.h"
 #include "media_libva_caps.h"
+#include "media_libva_image_copy.h"
 #include "media_interfaces_mmd.h"
 #include "mos_util_user_interface.h"
 #include "cplib_utils.h"
@@ -1368,17 +1372,28 @@ VAStatus DdiMedia__Initialize (
     mediaCtx->pfnMemoryDecompress = DdiMedia_MediaMemoryDecompressInternal;
 #endif
     // init the mutexs
-    DdiMediaUtil_InitMutex(&mediaCtx->SurfaceMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->BufferMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->ImageMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->DecoderMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->EncoderMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->VpMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->CmMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->MfeMutex);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->SurfaceMutex, "DdiSurfaceHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->BufferMutex, "DdiBufferHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->ImageMutex, "DdiImageHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->DecoderMutex, "DdiDecoderContextHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->EncoderMutex, "DdiEncoderContextHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->VpMutex, "DdiVpContextHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->CmMutex, "DdiCmContextHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->MfeMutex, "DdiMfeContextHeap", true);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->PendingMutex, "DdiPendingContext", false);
+
+    if (DdiEncode_AutoMfeInit(mediaCtx) != VA_STATUS_SUCCESS)
+    {
+        DDI_NORMALMESSAGE("Auto MFE is not available.");
+    }
+
+    if (DdiDecode_ContextPoolInit(ctx, mediaCtx) != VA_STATUS_SUCCESS)
+    {
+        DDI_NORMALMESSAGE("Decode context pool is not available.");
+    }
 #ifndef ANDROID
-    DdiMediaUtil_InitMutex(&mediaCtx->PutSurfaceRenderMutex);
-    DdiMediaUtil_InitMutex(&mediaCtx->PutSurfaceSwapBufferMutex);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->PutSurfaceRenderMutex, "DdiPutSurfaceRender", false);
+    DdiMediaUtil_InitNamedMutex(&mediaCtx->PutSurfaceSwapBufferMutex, "DdiPutSurfaceSwapBuffer", false);
 
     // try to open X11 lib, if fail, assume no X11 environment
     if (VA_STATUS_SUCCESS != DdiMedia_ConnectX11(mediaCtx))
@@ -1526,14 +1541,19 @@ static VAStatus DdiMedia_Terminate (
 #endif
 
     //destory resources
+    DdiDecode_ContextPoolDestroy(ctx);
     DdiMedia_FreeSurfaceHeapElements(mediaCtx);
     DdiMedia_FreeBufferHeapElements(ctx);
     DdiMedia_FreeImageHeapElements(ctx);
     DdiMedia_FreeContextHeapElements(ctx);
     DdiMedia_FreeContextCMElements(ctx);
+    DdiEncode_AutoMfeDestroy(mediaCtx);
 
     if (mediaCtx->modularizedGpuCtxEnabled)
     {
+        // Resources kept for reuse are freed while the device can still free them
+        MosResourceRecycler::Instance()->Drain(mediaCtx->pDrmBufMgr, mediaCtx->m_osContext);
+
         mediaCtx->m_gpuContextMgr->CleanUp();
         MOS_Delete(mediaCtx->m_gpuContextMgr);
 
@@ -1594,6 +1614,11 @@ static VAStatus DdiMedia_Terminate (
     DdiMediaUtil_DestroyMutex(&mediaCtx->VpMutex);
     DdiMediaUtil_DestroyMutex(&mediaCtx->CmMutex);
     DdiMediaUtil_DestroyMutex(&mediaCtx->MfeMutex);
+    DdiMediaUtil_DestroyMutex(&mediaCtx->PendingMutex);
+#ifndef ANDROID
+    DdiMediaUtil_DestroyMutex(&mediaCtx->PutSurfaceRenderMutex);
+    DdiMediaUtil_DestroyMutex(&mediaCtx->PutSurfaceSwapBufferMutex);
+#endif
 
     //resource checking
     if (mediaCtx->uiNumSurfaces != 0)
@@ -1812,6 +1837,7 @@ static VAStatus DdiMedia_CreateSurfaces (
 )
 {
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_CREATE_SURFACES);
 
     DDI_CHK_NULL(ctx,               "nullptr ctx",             VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_LARGER(num_surfaces, 0, "Invalid num_surfaces", VA_STATUS_ERROR_INVALID_PARAMETER);
@@ -1879,6 +1905,9 @@ static VAStatus DdiMedia_DestroySurfaces (
         DDI_CHK_LESS((uint32_t)surfaces[i], mediaCtx->pSurfaceHeap->uiAllocatedHeapElements, "Invalid surfaces", VA_STATUS_ERROR_INVALID_SURFACE);
         surface = DdiMedia_GetSurfaceFromVASurfaceID(mediaCtx, surfaces[i]);
         DDI_CHK_NULL(surface, "nullptr surface", VA_STATUS_ERROR_INVALID_SURFACE);
+        DdiEncode_SubmitPendingPictures(surface);
+        DdiVp_SubmitPendingRender(surface);
+        DdiDecode_SubmitPendingPictures(surface);
         if(surface->pCurrentFrameSemaphore)
         {
             DdiMediaUtil_WaitSemaphore(surface->pCurrentFrameSemaphore);
@@ -1934,6 +1963,7 @@ DdiMedia_CreateSurfaces2(
     )
 {
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_CREATE_SURFACES);
 
     DDI_CHK_NULL  (ctx,             "nullptr ctx",             VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_LARGER(num_surfaces, 0, "Invalid num_surfaces", VA_STATUS_ERROR_INVALID_PARAMETER);
@@ -2252,7 +2282,7 @@ static VAStatus DdiMedia_CreateMfeContextInternal(
 
     encodeMfeContext->mfeEncodeSharedState = mfeEncodeSharedState;
 
-    DdiMediaUtil_InitMutex(&encodeMfeContext->encodeMfeMutex);
+    DdiMediaUtil_InitNamedMutex(&encodeMfeContext->encodeMfeMutex, "DdiEncodeMfe", false);
 
     return VA_STATUS_SUCCESS;
 }
@@ -2321,6 +2351,9 @@ static VAStatus DdiMedia_AddContextInternal(
         return VA_STATUS_ERROR_UNSUPPORTED_PROFILE;
     }
 
+    // Explicit MFE takes over the stream from the automatic scheduler
+    DdiEncode_AutoMfeDetach(mediaCtx, encodeContext);
+
     DdiMediaUtil_LockMutex(&encodeMfeContext->encodeMfeMutex);
     encodeMfeContext->pDdiEncodeContexts.push_back(encodeContext);
 
@@ -2629,6 +2662,9 @@ VAStatus DdiMedia_MapBufferInternal (
             encCtx = DdiEncode_GetEncContextFromPVOID(ctxPtr);
             DDI_CHK_NULL(encCtx, "nullptr encCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
             bufMgr = &(encCtx->BufMgr);
+
+            // Coded buffer of a frame held by the auto MFE scheduler
+            DdiEncode_AutoMfeFlushContext(mediaCtx, encCtx);
             break;
         case DDI_MEDIA_CONTEXT_TYPE_MEDIA:
             break;
@@ -3151,6 +3187,7 @@ static VAStatus DdiMedia_BeginPicture (
 )
 {
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_BEGIN_PICTURE);
 
     DDI_CHK_NULL(ctx, "nullptr ctx", VA_STATUS_ERROR_INVALID_CONTEXT);
 
@@ -3175,6 +3212,17 @@ static VAStatus DdiMedia_BeginPicture (
     }
     DdiMediaUtil_UnLockMutex(&mediaCtx->SurfaceMutex);
 
+    // Another engine must not access the surface before a batched VP job using it is submitted
+    if (ctxType != DDI_MEDIA_CONTEXT_TYPE_VP)
+    {
+        DdiVp_SubmitPendingRender(surface);
+    }
+    // Same for a batched JPEG decode picture writing it
+    if (ctxType != DDI_MEDIA_CONTEXT_TYPE_DECODER)
+    {
+        DdiDecode_SubmitPendingPictures(surface);
+    }
+
     switch (ctxType)
     {
         case DDI_MEDIA_CONTEXT_TYPE_DECODER:
@@ -3203,6 +3251,7 @@ static VAStatus DdiMedia_RenderPicture (
 {
 
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_RENDER_PICTURE);
 
     DDI_CHK_NULL(  ctx,            "nullptr ctx",                   VA_STATUS_ERROR_INVALID_CONTEXT);
     DDI_CHK_NULL(  buffers,        "nullptr buffers",               VA_STATUS_ERROR_INVALID_PARAMETER);
@@ -3248,6 +3297,7 @@ static VAStatus DdiMedia_EndPicture (
 )
 {
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_END_PICTURE);
 
     DDI_CHK_NULL(ctx, "nullptr ctx", VA_STATUS_ERROR_INVALID_CONTEXT);
 
@@ -3280,6 +3330,7 @@ static VAStatus DdiMedia_SyncSurface (
 )
 {
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_SYNC_SURFACE);
 
     DDI_CHK_NULL(ctx,    "nullptr ctx",    VA_STATUS_ERROR_INVALID_CONTEXT);
 
@@ -3291,6 +3342,13 @@ static VAStatus DdiMedia_SyncSurface (
 
     DDI_MEDIA_SURFACE  *surface = DdiMedia_GetSurfaceFromVASurfaceID(mediaCtx, render_target);
     DDI_CHK_NULL(surface,    "nullptr surface",      VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    // Frames held by the auto MFE scheduler must be submitted before waiting
+    DdiEncode_AutoMfeFlushSurface(mediaCtx, surface);
+    DdiEncode_SubmitPendingPictures(surface);
+    DdiVp_SubmitPendingRender(surface);
+    DdiDecode_SubmitPendingPictures(surface);
+
     if (surface->pCurrentFrameSemaphore)
     {
         DdiMediaUtil_WaitSemaphore(surface->pCurrentFrameSemaphore);
@@ -3324,23 +3382,17 @@ static VAStatus DdiMedia_SyncSurface (
                 DDI_CHK_CONDITION((uNumAvailableReport == 0),
                     "No report available at all", VA_STATUS_ERROR_OPERATION_FAILED);
 
-                for (i = 0; i < uNumAvailableReport; i++)
-                {
-                    int32_t index = (decodeStatusBuf->m_firstIndex + i) & (CODECHAL_DECODE_STATUS_NUM - 1);
-                    if ((decodeStatusBuf->m_decodeStatus[index].m_decodeStatusReport.m_currDecodedPicRes.bo == surface->bo) ||
-                        (decoder->GetStandard() == CODECHAL_VC1 && decodeStatusBuf->m_decodeStatus[index].m_decodeStatusReport.m_deblockedPicResOlp.bo == surface->bo))
-                    {
-                        break;
-                    }
-                }
-
-                DDI_CHK_CONDITION((i == uNumAvailableReport),
+                // EndPicture recorded the slot of the latest report of the surface,
+                // every report up to and including it is drained
+                uint32_t surfaceIndex = surface->decStatusReportIndex & (CODECHAL_DECODE_STATUS_NUM - 1);
+                uint32_t uNumCompletedReport = ((surfaceIndex - decodeStatusBuf->m_firstIndex) & (CODECHAL_DECODE_STATUS_NUM - 1)) + 1;
+                DDI_CHK_CONDITION((uNumCompletedReport > uNumAvailableReport || decCtx->StatusReportSurfaceID[surfaceIndex] != render_target),
                     "No report available for this surface", VA_STATUS_ERROR_OPERATION_FAILED);
 
-                uint32_t uNumCompletedReport = i+1;
-
                 for (i = 0; i < uNumCompletedReport; i++)
                 {
+                    uint32_t reportIndex = decodeStatusBuf->m_firstIndex;
+
                     CodechalDecodeStatusReport tempNewReport;
                     MOS_ZeroMemory(&tempNewReport, sizeof(CodechalDecodeStatusReport));
                     MOS_STATUS eStatus = decoder->GetStatusReport(&tempNewReport, 1);
@@ -3353,38 +3405,46 @@ static VAStatus DdiMedia_SyncSurface (
                         bo = (tempNewReport.m_deblockedPicResOlp.bo) ? tempNewReport.m_deblockedPicResOlp.bo : bo;
                     }
 
-                    if ((tempNewReport.m_codecStatus == CODECHAL_STATUS_SUCCESSFUL) || (tempNewReport.m_codecStatus == CODECHAL_STATUS_ERROR) || (tempNewReport.m_codecStatus == CODECHAL_STATUS_INCOMPLETE))
+                    // return failed if queried INCOMPLETE or UNAVAILABLE report.
+                    DDI_CHK_CONDITION((tempNewReport.m_codecStatus != CODECHAL_STATUS_SUCCESSFUL &&
+                                       tempNewReport.m_codecStatus != CODECHAL_STATUS_ERROR &&
+                                       tempNewReport.m_codecStatus != CODECHAL_STATUS_INCOMPLETE),
+                        "Status report not completed", VA_STATUS_ERROR_OPERATION_FAILED);
+
+                    // Only the surface lookup and update need the surface heap; the heap is
+                    // searched by bo when the surface of the slot was destroyed or replaced
+                    DdiMediaUtil_LockMutex(&mediaCtx->SurfaceMutex);
+                    PDDI_MEDIA_SURFACE_HEAP_ELEMENT mediaSurfaceHeapElmt = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)mediaCtx->pSurfaceHeap->pHeapBase;
+                    PDDI_MEDIA_SURFACE              reportSurface        = nullptr;
+                    uint32_t                        surfaceId            = decCtx->StatusReportSurfaceID[reportIndex];
+
+                    if (surfaceId < mediaCtx->pSurfaceHeap->uiAllocatedHeapElements &&
+                        mediaSurfaceHeapElmt[surfaceId].pSurface != nullptr &&
+                        bo == mediaSurfaceHeapElmt[surfaceId].pSurface->bo)
                     {
-                        DdiMediaUtil_LockMutex(&mediaCtx->SurfaceMutex);
-                        PDDI_MEDIA_SURFACE_HEAP_ELEMENT mediaSurfaceHeapElmt = (PDDI_MEDIA_SURFACE_HEAP_ELEMENT)mediaCtx->pSurfaceHeap->pHeapBase;
-
-                        int32_t j = 0;
-                        for (j = 0; j < mediaCtx->pSurfaceHeap->uiAllocatedHeapElements; j++, mediaSurfaceHeapElmt++)
-                        {
-                            if (mediaSurfaceHeapElmt != nullptr &&
-                                    mediaSurfaceHeapElmt->pSurface != nullptr &&
-                                    bo == mediaSurfaceHeapElmt->pSurface->bo)
-                            {
-                                mediaSurfaceHeapElmt->pSurface->curStatusReport.decode.status = (uint32_t)tempNewReport.m_codecStatus;
-                                mediaSurfaceHeapElmt->pSurface->curStatusReport.decode.errMbNum = (uint32_t)tempNewReport.m_numMbsAffected;
-                                mediaSurfaceHeapElmt->pSurface->curStatusReport.decode.crcValue = (decoder->GetStandard() == CODECHAL_AVC)?(uint32_t)tempNewReport.m_frameCrc:0;
-                                mediaSurfaceHeapElmt->pSurface->curStatusReportQueryState = DDI_MEDIA_STATUS_REPORT_QUREY_STATE_COMPLETED;
-                                break;
-                            }
-                        }
+                        reportSurface = mediaSurfaceHeapElmt[surfaceId].pSurface;
+                    }
 
-                        if (j == mediaCtx->pSurfaceHeap->uiAllocatedHeapElements)
+                    for (uint32_t j = 0; reportSurface == nullptr && j < mediaCtx->pSurfaceHeap->uiAllocatedHeapElements; j++)
+                    {
+                        if (mediaSurfaceHeapElmt[j].pSurface != nullptr &&
+                            bo == mediaSurfaceHeapElmt[j].pSurface->bo)
                         {
-                            DdiMediaUtil_UnLockMutex(&mediaCtx->SurfaceMutex);
-                            return VA_STATUS_ERROR_OPERATION_FAILED;
+                            reportSurface = mediaSurfaceHeapElmt[j].pSurface;
                         }
-                        DdiMediaUtil_UnLockMutex(&mediaCtx->SurfaceMutex);
                     }
-                    else
+
+                    if (reportSurface == nullptr)
                     {
-                        // return failed if queried INCOMPLETE or UNAVAILABLE report.
+                        DdiMediaUtil_UnLockMutex(&mediaCtx->SurfaceMutex);
                         return VA_STATUS_ERROR_OPERATION_FAILED;
                     }
+
+                    reportSurface->curStatusReport.decode.status   = (uint32_t)tempNewReport.m_codecStatus;
+                    reportSurface->curStatusReport.decode.errMbNum = (uint32_t)tempNewReport.m_numMbsAffected;
+                    reportSurface->curStatusReport.decode.crcValue = (decoder->GetStandard() == CODECHAL_AVC)?(uint32_t)tempNewReport.m_frameCrc:0;
+                    reportSurface->curStatusReportQueryState       = DDI_MEDIA_STATUS_REPORT_QUREY_STATE_COMPLETED;
+                    DdiMediaUtil_UnLockMutex(&mediaCtx->SurfaceMutex);
                 }
             }
 
@@ -3497,6 +3557,11 @@ static VAStatus DdiMedia_QuerySurfaceStatus (
     DDI_MEDIA_SURFACE *surface   = DdiMedia_GetSurfaceFromVASurfaceID(mediaCtx, render_target);
     DDI_CHK_NULL(surface,    "nullptr surface",    VA_STATUS_ERROR_INVALID_SURFACE);
 
+    DdiEncode_AutoMfeFlushSurface(mediaCtx, surface);
+    DdiEncode_SubmitPendingPictures(surface);
+    DdiVp_SubmitPendingRender(surface);
+    DdiDecode_SubmitPendingPictures(surface);
+
     if (surface->pDecCtx)
     {
         auto decCtx = (PDDI_DECODE_CONTEXT)surface->pDecCtx;
@@ -4307,6 +4372,263 @@ VAStatus DdiMedia_SetImagePalette(
     return VA_STATUS_ERROR_UNIMPLEMENTED;
 }
 
+//!
+//! \brief  Get the image copy format of a VA image format
+//!
+//! \param  [in] format
+//!         VA image format
+//!
+//! \return DDI_IMAGE_COPY_FORMAT
+//!     Copy format, DDI_IMAGE_COPY_FORMAT_UNKNOWN if the CPU copy does not handle it
+//!
+static DDI_IMAGE_COPY_FORMAT DdiMedia_GetImageCopyFormat(VAImageFormat *format)
+{
+    if (format->alpha_mask == RGB_10BIT_ALPHAMASK)
+    {
+        return DDI_IMAGE_COPY_FORMAT_UNKNOWN;
+    }
+
+    switch (format->fourcc)
+    {
+        case VA_FOURCC_NV12:
+            return DDI_IMAGE_COPY_FORMAT_NV12;
+        case VA_FOURCC_I420:
+        case VA_FOURCC_IYUV:
+            return DDI_IMAGE_COPY_FORMAT_I420;
+        case VA_FOURCC_YV12:
+            return DDI_IMAGE_COPY_FORMAT_YV12;
+        case VA_FOURCC_YUY2:
+            return DDI_IMAGE_COPY_FORMAT_YUY2;
+        case VA_FOURCC_UYVY:
+            return DDI_IMAGE_COPY_FORMAT_UYVY;
+        case VA_FOURCC_P010:
+            return DDI_IMAGE_COPY_FORMAT_P010;
+        case VA_FOURCC_P016:
+            return DDI_IMAGE_COPY_FORMAT_P016;
+        case VA_FOURCC_RGBA:
+            return DDI_IMAGE_COPY_FORMAT_RGBA;
+        case VA_FOURCC_BGRA:
+            return DDI_IMAGE_COPY_FORMAT_BGRA;
+        case VA_FOURCC_RGBX:
+            return DDI_IMAGE_COPY_FORMAT_RGBX;
+        case VA_FOURCC_BGRX:
+            return DDI_IMAGE_COPY_FORMAT_BGRX;
+        default:
+            return DDI_IMAGE_COPY_FORMAT_UNKNOWN;
+    }
+}
+
+//!
+//! \brief  Get the image copy format of a media surface format
+//!
+//! \param  [in] format
+//!         Media surface format
+//!
+//! \return DDI_IMAGE_COPY_FORMAT
+//!     Copy format, DDI_IMAGE_COPY_FORMAT_UNKNOWN if the CPU copy does not handle it
+//!
+static DDI_IMAGE_COPY_FORMAT DdiMedia_GetSurfaceCopyFormat(DDI_MEDIA_FORMAT format)
+{
+    switch (format)
+    {
+        case Media_Format_NV12:
+            return DDI_IMAGE_COPY_FORMAT_NV12;
+        case Media_Format_I420:
+            return DDI_IMAGE_COPY_FORMAT_I420;
+        case Media_Format_YV12:
+            return DDI_IMAGE_COPY_FORMAT_YV12;
+        case Media_Format_YUY2:
+            return DDI_IMAGE_COPY_FORMAT_YUY2;
+        case Media_Format_UYVY:
+            return DDI_IMAGE_COPY_FORMAT_UYVY;
+        case Media_Format_P010:
+            return DDI_IMAGE_COPY_FORMAT_P010;
+        case Media_Format_P016:
+            return DDI_IMAGE_COPY_FORMAT_P016;
+        case Media_Format_R8G8B8A8:
+        case Media_Format_A8B8G8R8:
+            return DDI_IMAGE_COPY_FORMAT_RGBA;
+        case Media_Format_A8R8G8B8:
+            return DDI_IMAGE_COPY_FORMAT_BGRA;
+        case Media_Format_X8B8G8R8:
+            return DDI_IMAGE_COPY_FORMAT_RGBX;
+        case Media_Format_X8R8G8B8:
+            return DDI_IMAGE_COPY_FORMAT_BGRX;
+        default:
+            return DDI_IMAGE_COPY_FORMAT_UNKNOWN;
+    }
+}
+
+//!
+//! \brief  Check if the CPU mapping of a locked surface is write-combined
+//! \details    Tiled surfaces are mapped through the GTT unless swizzled in a system shadow
+//!
+//! \param  [in] surface
+//!         Media surface
+//!
+//! \return bool
+//!     true if the mapping is write-combined
+//!
+static bool DdiMedia_IsSurfaceMappingWC(DDI_MEDIA_SURFACE *surface)
+{
+    return (surface->pSystemShadow == nullptr) &&
+           (surface->pMediaCtx->bIsAtomSOC || surface->TileType != I915_TILING_NONE);
+}
+
+//!
+//! \brief  Check if a region can be copied between a surface and an image on the CPU
+//!
+//! \param  [in] surface
+//!         Media surface
+//! \param  [in] surfX
+//!         X offset of the region in the surface
+//! \param  [in] surfY
+//!         Y offset of the region in the surface
+//! \param  [in] image
+//!         VA image
+//! \param  [in] imageX
+//!         X offset of the region in the image
+//! \param  [in] imageY
+//!         Y offset of the region in the image
+//! \param  [in] width
+//!         Width of the region
+//! \param  [in] height
+//!         Height of the region
+//!
+//! \return bool
+//!     true if DdiMedia_CopySurfaceImage can copy the region
+//!
+static bool DdiMedia_CanCopySurfaceImage(
+    DDI_MEDIA_SURFACE *surface,
+    int32_t            surfX,
+    int32_t            surfY,
+    VAImage           *image,
+    int32_t            imageX,
+    int32_t            imageY,
+    uint32_t           width,
+    uint32_t           height)
+{
+    DDI_IMAGE_COPY_FORMAT surfFormat  = DdiMedia_GetSurfaceCopyFormat(surface->format);
+    DDI_IMAGE_COPY_FORMAT imageFormat = DdiMedia_GetImageCopyFormat(&image->format);
+
+    if (!DdiImageCopy_IsSupported(surfFormat, imageFormat) ||
+        image->num_planes != DdiImageCopy_GetPlaneNum(imageFormat))
+    {
+        return false;
+    }
+
+    if (width == 0 || height == 0 || surfX < 0 || surfY < 0 || imageX < 0 || imageY < 0 ||
+        (uint64_t)surfX + width   > (uint64_t)surface->iWidth ||
+        (uint64_t)surfY + height  > (uint64_t)surface->iRealHeight ||
+        (uint64_t)imageX + width  > image->width ||
+        (uint64_t)imageY + height > image->height)
+    {
+        return false;
+    }
+
+    return DdiImageCopy_IsOriginAligned(surfFormat, surfX, surfY) &&
+           DdiImageCopy_IsOriginAligned(imageFormat, imageX, imageY);
+}
+
+//!
+//! \brief  Copy a region between a locked surface and a mapped image
+//! \details    Honors the pitch and plane offsets of both sides and converts
+//!             between layouts of the same family. The surface planes are laid
+//!             out the way DdiMedia_DeriveImage reports them.
+//!
+//! \param  [in] surface
+//!         Media surface
+//! \param  [in] surfData
+//!         Locked surface data
+//! \param  [in] surfX
+//!         X offset of the region in the surface
+//! \param  [in] surfY
+//!         Y offset of the region in the surface
+//! \param  [in] image
+//!         VA image
+//! \param  [in] imageData
+//!         Mapped image data
+//! \param  [in] imageX
+//!         X offset of the region in the image
+//! \param  [in] imageY
+//!         Y offset of the region in the image
+//! \param  [in] width
+//!         Width of the region
+//! \param  [in] height
+//!         Height of the region
+//! \param  [in] surfaceToImage
+//!         true for vaGetImage, false for vaPutImage
+//!
+//! \return VAStatus
+//!     VA_STATUS_SUCCESS if success, else fail reason
+//!
+static VAStatus DdiMedia_CopySurfaceImage(
+    DDI_MEDIA_SURFACE *surface,
+    uint8_t           *surfData,
+    int32_t            surfX,
+    int32_t            surfY,
+    VAImage           *image,
+    uint8_t           *imageData,
+    int32_t            imageX,
+    int32_t            imageY,
+    uint32_t           width,
+    uint32_t           height,
+    bool               surfaceToImage)
+{
+    DDI_CHK_CONDITION(!DdiMedia_CanCopySurfaceImage(surface, surfX, surfY, image, imageX, imageY, width, height),
+        "Unsupported CPU image copy", VA_STATUS_ERROR_UNIMPLEMENTED);
+
+    DDI_IMAGE_COPY_FRAME surfFrame;
+    DDI_IMAGE_COPY_FRAME imageFrame;
+    MOS_ZeroMemory(&surfFrame,  sizeof(surfFrame));
+    MOS_ZeroMemory(&imageFrame, sizeof(imageFrame));
+
+    uint32_t pitch      = surface->iPitch;
+    uint32_t lumaSize   = surface->iPitch * surface->iHeight;
+
+    surfFrame.format    = DdiMedia_GetSurfaceCopyFormat(surface->format);
+    surfFrame.plane[0]  = surfData;
+    surfFrame.pitch[0]  = pitch;
+    switch (surfFrame.format)
+    {
+        case DDI_IMAGE_COPY_FORMAT_NV12:
+        case DDI_IMAGE_COPY_FORMAT_P010:
+        case DDI_IMAGE_COPY_FORMAT_P016:
+            surfFrame.plane[1] = surfData + lumaSize;
+            surfFrame.pitch[1] = pitch;
+            break;
+        case DDI_IMAGE_COPY_FORMAT_YV12:
+            surfFrame.plane[1] = surfData + lumaSize;
+            surfFrame.plane[2] = surfData + lumaSize * 5 / 4;
+            surfFrame.pitch[1] = surfFrame.pitch[2] = pitch / 2;
+            break;
+        case DDI_IMAGE_COPY_FORMAT_I420:
+            surfFrame.plane[1] = surfData + lumaSize * 5 / 4;
+            surfFrame.plane[2] = surfData + lumaSize;
+            surfFrame.pitch[1] = surfFrame.pitch[2] = pitch / 2;
+            break;
+        default:
+            break;
+    }
+    surfFrame.writeCombined = DdiMedia_IsSurfaceMappingWC(surface);
+
+    imageFrame.format = DdiMedia_GetImageCopyFormat(&image->format);
+    for (uint32_t i = 0; i < image->num_planes; i++)
+    {
+        imageFrame.plane[i] = imageData + image->offsets[i];
+        imageFrame.pitch[i] = image->pitches[i];
+    }
+
+    DdiImageCopy_SetOrigin(&surfFrame,  surfX,  surfY);
+    DdiImageCopy_SetOrigin(&imageFrame, imageX, imageY);
+
+    bool copied = surfaceToImage ?
+        DdiImageCopy_CopyFrame(&surfFrame, &imageFrame, width, height, DDI_IMAGE_COPY_MAX_THREADS) :
+        DdiImageCopy_CopyFrame(&imageFrame, &surfFrame, width, height, DDI_IMAGE_COPY_MAX_THREADS);
+
+    return copied ? VA_STATUS_SUCCESS : VA_STATUS_ERROR_OPERATION_FAILED;
+}
+
 //!
 //! \brief  Retrive surface data into a VAImage
 //! \details    Image must be in a format supported by the implementation
@@ -4340,6 +4662,7 @@ VAStatus DdiMedia_GetImage(
 )
 {
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_GET_IMAGE);
 
     DDI_CHK_NULL(ctx,       "nullptr ctx.",         VA_STATUS_ERROR_INVALID_CONTEXT);
 
@@ -4364,10 +4687,17 @@ VAStatus DdiMedia_GetImage(
     VAStatus        vaStatus = VA_STATUS_SUCCESS;
     VASurfaceID     target_surface = VA_INVALID_SURFACE;
     VASurfaceID     output_surface = surface;
+    int32_t         surfX = x;
+    int32_t         surfY = y;
+
+    //Layout conversions of the same size are done by the CPU copy, without a VP pass.
+    bool cpuCopy = (width == vaimg->width && height == vaimg->height) &&
+                   DdiMedia_CanCopySurfaceImage(inputSurface, x, y, vaimg, 0, 0, width, height);
 
     //VP Pipeline will be called for CSC/Scaling if the surface format or data size is not consistent with image.
-    if (inputSurface->format != DdiMedia_OsFormatAlphaMaskToMediaFormat(vaimg->format.fourcc, vaimg->format.alpha_mask) ||
-        width != vaimg->width || height != vaimg->height)
+    if (!cpuCopy &&
+        (inputSurface->format != DdiMedia_OsFormatAlphaMaskToMediaFormat(vaimg->format.fourcc, vaimg->format.alpha_mask) ||
+        width != vaimg->width || height != vaimg->height))
     {
         VAContextID context = VA_INVALID_ID;
         
@@ -4396,6 +4726,8 @@ VAStatus DdiMedia_GetImage(
         }
 
         output_surface = target_surface;
+        surfX          = 0;
+        surfY          = 0;
     }
 
     //Get Media Surface from output surface ID
@@ -4403,6 +4735,8 @@ VAStatus DdiMedia_GetImage(
     DDI_CHK_NULL(mediaSurface,     "nullptr mediaSurface.",      VA_STATUS_ERROR_INVALID_PARAMETER);
     DDI_CHK_NULL(mediaSurface->bo, "nullptr mediaSurface->bo.",  VA_STATUS_ERROR_INVALID_PARAMETER);
 
+    cpuCopy = DdiMedia_CanCopySurfaceImage(mediaSurface, surfX, surfY, vaimg, 0, 0, vaimg->width, vaimg->height);
+
     //Lock Surface
     void *surfData = DdiMediaUtil_LockSurface(mediaSurface, (MOS_LOCKFLAG_READONLY | MOS_LOCKFLAG_WRITEONLY));
     if (surfData == nullptr)
@@ -4428,10 +4762,21 @@ VAStatus DdiMedia_GetImage(
     }
 
     //Copy data from surface to image
-    MOS_STATUS eStatus = MOS_SecureMemcpy(imageData, vaimg->data_size, surfData, vaimg->data_size);
-    if (eStatus != MOS_STATUS_SUCCESS)
+    if (cpuCopy)
+    {
+        vaStatus = DdiMedia_CopySurfaceImage(mediaSurface, (uint8_t *)surfData, surfX, surfY,
+                                             vaimg, (uint8_t *)imageData, 0, 0, vaimg->width, vaimg->height, true);
+    }
+    else
+    {
+        MosCopy_CopyParallel(imageData, surfData, vaimg->data_size,
+                             DdiMedia_IsSurfaceMappingWC(mediaSurface) ? MOS_COPY_MEMORY_FROM_WC : MOS_COPY_MEMORY_CACHED,
+                             MOS_COPY_MAX_THREADS);
+    }
+    if (vaStatus != VA_STATUS_SUCCESS)
     {
         DDI_ASSERTMESSAGE("DDI:Failed to copy surface to image buffer data!");
+        DdiMedia_UnmapBuffer(ctx, vaimg->buf);
         DdiMediaUtil_UnlockSurface(mediaSurface);
         if(target_surface != VA_INVALID_SURFACE)
         {
@@ -4506,16 +4851,8 @@ VAStatus DdiMedia_PutImage(
     uint32_t         dest_height
 )
 {
-    DDI_UNUSED(src_x);
-    DDI_UNUSED(src_y);
-    DDI_UNUSED(src_width);
-    DDI_UNUSED(src_height);
-    DDI_UNUSED(dest_x);
-    DDI_UNUSED(dest_y);
-    DDI_UNUSED(dest_width);
-    DDI_UNUSED(dest_height);
-
     DDI_FUNCTION_ENTER();
+    MOS_METRICS_SCOPE(MOS_METRIC_DDI_PUT_IMAGE);
 
     DDI_CHK_NULL(ctx,                     "nullptr ctx.",                    VA_STATUS_ERROR_INVALID_CONTEXT);
 
@@ -4541,7 +4878,13 @@ VAStatus DdiMedia_PutImage(
     DDI_MEDIA_BUFFER *buf   = DdiMedia_GetBufferFromVABufferID(mediaCtx, vaimg->buf);
     DDI_CHK_NULL(buf,       "Invalid buffer.",      VA_STATUS_ERROR_INVALID_PARAMETER);
 
-    if (mediaSurface->format != DdiMedia_OsFormatAlphaMaskToMediaFormat(vaimg->format.fourcc,vaimg->format.alpha_mask))
+    //No scaling here: the region is the part the source and destination rectangles have in common.
+    uint32_t width   = MOS_MIN(src_width,  dest_width);
+    uint32_t height  = MOS_MIN(src_height, dest_height);
+    bool     cpuCopy = DdiMedia_CanCopySurfaceImage(mediaSurface, dest_x, dest_y, vaimg, src_x, src_y, width, height);
+
+    if (!cpuCopy &&
+        mediaSurface->format != DdiMedia_OsFormatAlphaMaskToMediaFormat(vaimg->format.fourcc,vaimg->format.alpha_mask))
     {
         return VA_STATUS_ERROR_UNIMPLEMENTED;
     }
@@ -4563,10 +4906,25 @@ VAStatus DdiMedia_PutImage(
         return VA_STATUS_ERROR_UNKNOWN;
     }
 
-    //copy data from image to surferce
-    //this is temp solution, will copy by difference size and difference format in further
-    MOS_STATUS eStatus = MOS_SecureMemcpy(surfData, vaimg->data_size, imageData, vaimg->data_size);
-    DDI_CHK_CONDITION((eStatus != MOS_STATUS_SUCCESS), "DDI:Failed to copy image to surface buffer data!", VA_STATUS_ERROR_OPERATION_FAILED);
+    //copy data from image to surface
+    if (cpuCopy)
+    {
+        status = DdiMedia_CopySurfaceImage(mediaSurface, (uint8_t *)surfData, dest_x, dest_y,
+                                           vaimg, (uint8_t *)imageData, src_x, src_y, width, height, false);
+    }
+    else
+    {
+        MosCopy_CopyParallel(surfData, imageData, vaimg->data_size,
+                             DdiMedia_IsSurfaceMappingWC(mediaSurface) ? MOS_COPY_MEMORY_TO_WC : MOS_COPY_MEMORY_CACHED,
+                             MOS_COPY_MAX_THREADS);
+    }
+    if (status != VA_STATUS_SUCCESS)
+    {
+        DDI_ASSERTMESSAGE("DDI:Failed to copy image to surface buffer data!");
+        DdiMedia_UnmapBuffer(ctx, vaimg->buf);
+        DdiMediaUtil_UnlockSurface(mediaSurface);
+        return status;
+    }
 
     status = DdiMedia_UnmapBuffer(ctx, vaimg->buf);
     if (status != VA_STATUS_SUCCESS)
@@ -128,6 +128,73 @@ const VAImageFormat MediaLibvaCaps::m_supportedImageformats[] =
     {VA_FOURCC_Y410, VA_LSB_FIRST, 24, 0,0,0,0,0}
 };
 
+MediaLibvaCaps::CapsSnapshot *MediaLibvaCaps::m_snapshotList = nullptr;
+
+static MEDIA_MUTEX_T capsSnapshotMutex = MEDIA_MUTEX_INITIALIZER;
+
+//!
+//! \brief    Binary search of a sorted attribute list
+//!
+static const VAConfigAttrib* SearchAttribute(const VAConfigAttrib *attribs, int32_t attribNum, VAConfigAttribType type)
+{
+    int32_t low  = 0;
+    int32_t high = attribNum - 1;
+    while (low <= high)
+    {
+        int32_t mid = (low + high) >> 1;
+        if (attribs[mid].type == type)
+        {
+            return &attribs[mid];
+        }
+        else if (attribs[mid].type < type)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    return nullptr;
+}
+
+//!
+//! \brief    Check a flattened attribute list against the map it was built from
+//! \details  Every attribute type must be found, or not, with the same value as
+//!           by AttribMap::find(), and the list must walk in map order as
+//!           QueryConfigAttributes() did over the map.
+//!
+static bool AttributesMatch(AttribMap *attributes, const VAConfigAttrib *attribs, int32_t attribNum)
+{
+    if (attributes == nullptr || (int32_t)attributes->size() != attribNum)
+    {
+        return false;
+    }
+
+    int32_t k = 0;
+    for (auto it = attributes->begin(); it != attributes->end(); ++it, k++)
+    {
+        if (attribs[k].type != it->first || attribs[k].value != it->second)
+        {
+            return false;
+        }
+    }
+
+    for (int32_t type = 0; type < VAConfigAttribTypeMax; type++)
+    {
+        auto                  it     = attributes->find((VAConfigAttribType)type);
+        const VAConfigAttrib *attrib = SearchAttribute(attribs, attribNum, (VAConfigAttribType)type);
+        if ((it == attributes->end()) != (attrib == nullptr) ||
+            (attrib != nullptr && attrib->value != it->second))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 MediaLibvaCaps::MediaLibvaCaps(DDI_MEDIA_CONTEXT *mediaCtx)
 {
     m_mediaCtx = mediaCtx;
@@ -138,6 +205,7 @@ MediaLibvaCaps::MediaLibvaCaps(DDI_MEDIA_CONTEXT *mediaCtx)
 MediaLibvaCaps::~MediaLibvaCaps()
 {
     FreeAttributeList();
+    ReleaseSnapshot();
     Delete_MediaLibvaCapsCpInterface(m_CapsCp);
     m_CapsCp = nullptr;
 }
@@ -375,6 +443,178 @@ VAStatus MediaLibvaCaps::FreeAttributeList()
     return VA_STATUS_SUCCESS;
 }
 
+VAStatus MediaLibvaCaps::BuildSnapshot(CapsSnapshot *snapshot)
+{
+    DDI_CHK_NULL(snapshot, "Null pointer", VA_STATUS_ERROR_INVALID_PARAMETER);
+
+    // Flatten every attribute map once; std::map iterates in type order so each
+    // list is already sorted for the binary search in FindAttribute()
+    VAStatus status = VA_STATUS_SUCCESS;
+    uint32_t attribListCount = m_attributeLists.size();
+    std::vector<int32_t> listStartIdx(attribListCount);
+    for (uint32_t i = 0; i < attribListCount; i++)
+    {
+        listStartIdx[i] = snapshot->m_attribs.size();
+        for (auto it = m_attributeLists[i]->begin(); it != m_attributeLists[i]->end(); ++it)
+        {
+            VAConfigAttrib attrib;
+            attrib.type  = it->first;
+            attrib.value = it->second;
+            snapshot->m_attribs.push_back(attrib);
+        }
+    }
+
+    for (int32_t i = 0; i < m_profileEntryCount; i++)
+    {
+        ProfileEntrypoint *entry = &m_profileEntryTbl[i];
+        for (uint32_t j = 0; j < attribListCount; j++)
+        {
+            if (m_attributeLists[j] == entry->m_attributes)
+            {
+                entry->m_attribStartIdx = listStartIdx[j];
+                entry->m_attribNum      = m_attributeLists[j]->size();
+                break;
+            }
+        }
+
+        // The ULT holds every lookup of the flattened list against the map it replaces
+        if (MosUltFlag &&
+            !AttributesMatch(entry->m_attributes, snapshot->m_attribs.data() + entry->m_attribStartIdx, entry->m_attribNum))
+        {
+            DDI_ASSERTMESSAGE("Flattened attributes of profile %d entrypoint %d differ from the map.",
+                entry->m_profile, entry->m_entrypoint);
+            status = VA_STATUS_ERROR_OPERATION_FAILED;
+        }
+
+        entry->m_attributes = nullptr;
+        snapshot->m_profileEntryTbl[i] = *entry;
+    }
+    snapshot->m_profileEntryCount = m_profileEntryCount;
+
+    snapshot->m_encConfigs = m_encConfigs;
+    snapshot->m_decConfigs = m_decConfigs;
+    snapshot->m_vpConfigs  = m_vpConfigs;
+
+    VAStatus freeStatus = FreeAttributeList();
+    return (status == VA_STATUS_SUCCESS) ? freeStatus : status;
+}
+
+VAStatus MediaLibvaCaps::LoadSharedProfileEntrypoints()
+{
+    DDI_CHK_NULL(m_mediaCtx, "Null m_mediaCtx", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    double        startTime     = MOS_GetTime();
+    uint32_t      productFamily = m_mediaCtx->platform.eProductFamily;
+    uint32_t      revId         = m_mediaCtx->platform.usRevId;
+    int32_t       deviceId      = m_mediaCtx->iDeviceId;
+    bool          built         = false;
+    VAStatus      status        = VA_STATUS_SUCCESS;
+    CapsSnapshot *snapshot      = nullptr;
+
+    DdiMediaUtil_LockMutex(&capsSnapshotMutex);
+
+    for (snapshot = m_snapshotList; snapshot != nullptr; snapshot = snapshot->m_next)
+    {
+        if (snapshot->m_productFamily == productFamily &&
+            snapshot->m_deviceId == deviceId &&
+            snapshot->m_revId == revId &&
+            snapshot->m_isEntryptSupported == m_isEntryptSupported)
+        {
+            break;
+        }
+    }
+
+    if (snapshot == nullptr)
+    {
+        snapshot = MOS_New(CapsSnapshot);
+        if (snapshot == nullptr)
+        {
+            DdiMediaUtil_UnLockMutex(&capsSnapshotMutex);
+            return VA_STATUS_ERROR_ALLOCATION_FAILED;
+        }
+        snapshot->m_productFamily      = productFamily;
+        snapshot->m_deviceId           = deviceId;
+        snapshot->m_revId              = revId;
+        snapshot->m_isEntryptSupported = m_isEntryptSupported;
+        snapshot->m_refCount           = 0;
+        snapshot->m_profileEntryCount  = 0;
+        snapshot->m_next               = nullptr;
+
+        // A partially loaded table still serves this display but is never shared
+        status = LoadProfileEntrypoints();
+        VAStatus buildStatus = BuildSnapshot(snapshot);
+        snapshot->m_shared = (status == VA_STATUS_SUCCESS && buildStatus == VA_STATUS_SUCCESS);
+        if (snapshot->m_shared)
+        {
+            snapshot->m_next = m_snapshotList;
+            m_snapshotList   = snapshot;
+        }
+        status = (status == VA_STATUS_SUCCESS) ? buildStatus : status;
+        built  = true;
+    }
+    else
+    {
+        for (int32_t i = 0; i < snapshot->m_profileEntryCount; i++)
+        {
+            m_profileEntryTbl[i] = snapshot->m_profileEntryTbl[i];
+        }
+        m_profileEntryCount = snapshot->m_profileEntryCount;
+        m_encConfigs        = snapshot->m_encConfigs;
+        m_decConfigs        = snapshot->m_decConfigs;
+        m_vpConfigs         = snapshot->m_vpConfigs;
+    }
+
+    snapshot->m_refCount++;
+    m_snapshot = snapshot;
+
+    DdiMediaUtil_UnLockMutex(&capsSnapshotMutex);
+
+    DDI_NORMALMESSAGE("Caps tables %s in %.1f us for device 0x%x.",
+        built ? "built" : "shared", MOS_GetTime() - startTime, deviceId);
+
+    return status;
+}
+
+void MediaLibvaCaps::ReleaseSnapshot()
+{
+    if (m_snapshot == nullptr)
+    {
+        return;
+    }
+
+    DdiMediaUtil_LockMutex(&capsSnapshotMutex);
+
+    if (--m_snapshot->m_refCount == 0)
+    {
+        // Free with the last display so that no allocation outlives the driver
+        CapsSnapshot **link = &m_snapshotList;
+        while (*link != nullptr && *link != m_snapshot)
+        {
+            link = &(*link)->m_next;
+        }
+        if (*link != nullptr)
+        {
+            *link = m_snapshot->m_next;
+        }
+        MOS_Delete(m_snapshot);
+    }
+    m_snapshot = nullptr;
+
+    DdiMediaUtil_UnLockMutex(&capsSnapshotMutex);
+}
+
+const VAConfigAttrib* MediaLibvaCaps::FindAttribute(int32_t profileTableIdx, VAConfigAttribType type)
+{
+    if (m_snapshot == nullptr || profileTableIdx < 0 || profileTableIdx >= m_profileEntryCount)
+    {
+        return nullptr;
+    }
+
+    return SearchAttribute(m_snapshot->m_attribs.data() + m_profileEntryTbl[profileTableIdx].m_attribStartIdx,
+        m_profileEntryTbl[profileTableIdx].m_attribNum,
+        type);
+}
+
 VAStatus MediaLibvaCaps::CheckEncRTFormat(
         VAProfile profile,
         VAEntrypoint entrypoint,
@@ -1548,13 +1788,13 @@ VAStatus MediaLibvaCaps::GetConfigAttributes(VAProfile profile,
         return VA_STATUS_ERROR_INVALID_PARAMETER;
     }
 
-    DDI_CHK_NULL(m_profileEntryTbl[i].m_attributes, "Null pointer", VA_STATUS_ERROR_INVALID_PARAMETER);
+    DDI_CHK_NULL(m_snapshot, "Null pointer", VA_STATUS_ERROR_INVALID_PARAMETER);
     for (int32_t j = 0; j < numAttribs; j++)
     {
-        if (m_profileEntryTbl[i].m_attributes->find(attribList[j].type) !=
-                m_profileEntryTbl[i].m_attributes->end())
+        const VAConfigAttrib *attrib = FindAttribute(i, attribList[j].type);
+        if (attrib != nullptr)
         {
-            attribList[j].value = (*m_profileEntryTbl[i].m_attributes)[attribList[j].type];
+            attribList[j].value = attrib->value;
         }
         else
         {
@@ -1933,17 +2173,17 @@ VAStatus MediaLibvaCaps::QueryConfigAttributes(
     {
         return VA_STATUS_ERROR_INVALID_CONFIG;
     }
-    auto allAttribsList = m_profileEntryTbl[profileTableIdx].m_attributes;
+    DDI_CHK_NULL(m_snapshot, "Null pointer", VA_STATUS_ERROR_INVALID_CONFIG);
 
-    DDI_CHK_NULL(allAttribsList, "Null pointer", VA_STATUS_ERROR_INVALID_CONFIG);
+    const VAConfigAttrib *allAttribsList = m_snapshot->m_attribs.data() + m_profileEntryTbl[profileTableIdx].m_attribStartIdx;
+    int32_t allAttribsNum = m_profileEntryTbl[profileTableIdx].m_attribNum;
 
     uint32_t j = 0;
-    for (auto it = allAttribsList->begin(); it != allAttribsList->end(); ++it)
+    for (int32_t k = 0; k < allAttribsNum; k++)
     {
-        if (it->second != VA_ATTRIB_NOT_SUPPORTED)
+        if (allAttribsList[k].value != VA_ATTRIB_NOT_SUPPORTED)
         {
-            attribList[j].type = it->first;
-            attribList[j].value = it->second;
+            attribList[j] = allAttribsList[k];
             j++;
         }
     }
@@ -661,7 +661,9 @@ protected:
         public:
             VAProfile m_profile = VAProfileNone; //!< Profile
             VAEntrypoint m_entrypoint = (VAEntrypoint)0; //!< Entrypoint
-            AttribMap *m_attributes = nullptr; //!< Pointer to attributes map
+            AttribMap *m_attributes = nullptr; //!< Pointer to attributes map, only valid while loading
+            int32_t m_attribStartIdx = 0; //!< Offset of the sorted attributes in the shared snapshot
+            int32_t m_attribNum = 0; //!< Number of attributes of this profile & entrypoint combination
             int32_t m_configStartIdx = 0; //!< Config Id offset to the decode or encode or vp config Id base
             //! \brief  The number of config Id that this profile & entrypoint combination supports
             //!
@@ -750,6 +752,27 @@ protected:
         ENCODE_JPEG_MAX_PIC_WIDTH; //!< Maximum width for JPEG encoding
     static const uint32_t m_encJpegMaxHeight =
         ENCODE_JPEG_MAX_PIC_HEIGHT; //!< Maximum height for JPEG encoding
+    //!
+    //! \struct   CapsSnapshot
+    //! \brief    Immutable profile/entrypoint tables shared by all displays of one device
+    //!
+    struct CapsSnapshot
+    {
+        uint32_t m_productFamily; //!< Product family the snapshot was built for
+        int32_t m_deviceId; //!< Device id the snapshot was built for
+        uint32_t m_revId; //!< Revision id the snapshot was built for
+        bool m_isEntryptSupported; //!< Decode encryption support the snapshot was built with
+        bool m_shared; //!< Linked in the process-wide snapshot list
+        uint32_t m_refCount; //!< Number of MediaLibvaCaps instances using the snapshot
+        ProfileEntrypoint m_profileEntryTbl[m_maxProfileEntries]; //!< Profile and entrypoint combinations
+        uint16_t m_profileEntryCount; //!< Count valid entries in m_profileEntryTbl
+        std::vector<VAConfigAttrib> m_attribs; //!< Attribute lists of all entries, each sorted by type
+        std::vector<uint32_t> m_encConfigs; //!< Supported encode configs
+        std::vector<DecConfig> m_decConfigs; //!< Supported decode configs
+        std::vector<uint32_t> m_vpConfigs; //!< Supported vp configs
+        CapsSnapshot *m_next; //!< Next snapshot in the process-wide list
+    };
+
     DDI_MEDIA_CONTEXT *m_mediaCtx; //!< Pointer to media context
 
     MediaLibvaCapsCpInterface* m_CapsCp;
@@ -777,6 +800,10 @@ protected:
     std::vector<DecConfig> m_decConfigs; //!< Store supported decode configs
     std::vector<uint32_t> m_vpConfigs; //!< Store supported vp configs
 
+    CapsSnapshot *m_snapshot = nullptr; //!< Shared tables used by the queries
+
+    static CapsSnapshot *m_snapshotList; //!< Snapshots of all devices opened in this process
+
     //!
     //! \brief    Check entrypoint codec type
     //!
@@ -1083,6 +1110,49 @@ protected:
     //!
     virtual VAStatus LoadProfileEntrypoints() = 0;
 
+    //!
+    //! \brief    Initialize profiles, entrypoints and attributes from the shared snapshot
+    //! \details  The first display of a device runs LoadProfileEntrypoints() and publishes
+    //!           the result as an immutable snapshot. Later displays of the same device
+    //!           adopt the snapshot instead of rebuilding the attribute lists.
+    //!
+    //! \return   VAStatus
+    //!           VA_STATUS_SUCCESS if success
+    //!
+    VAStatus LoadSharedProfileEntrypoints();
+
+    //!
+    //! \brief    Move the loaded tables into a snapshot
+    //! \details  Attribute maps are flattened into sorted arrays and freed. Under the
+    //!           ULT every flattened list is first checked against its map.
+    //!
+    //! \param    [in,out] snapshot
+    //!           Pointer to the snapshot to fill
+    //!
+    //! \return   VAStatus
+    //!           VA_STATUS_SUCCESS if success
+    //!
+    VAStatus BuildSnapshot(CapsSnapshot *snapshot);
+
+    //!
+    //! \brief    Drop the reference to the shared snapshot
+    //!
+    void ReleaseSnapshot();
+
+    //!
+    //! \brief    Look up an attribute of a profile & entrypoint combination
+    //!
+    //! \param    [in] profileTableIdx
+    //!           The index in m_profileEntryTbl
+    //!
+    //! \param    [in] type
+    //!           Attribute type
+    //!
+    //! \return   const VAConfigAttrib*
+    //!           Pointer to the attribute, nullptr if not found
+    //!
+    const VAConfigAttrib* FindAttribute(int32_t profileTableIdx, VAConfigAttribType type);
+
     //!
     //! \brief    Create decode config by given attributes
     //!
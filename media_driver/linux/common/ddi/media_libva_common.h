@@ -264,10 +264,14 @@ typedef struct _DDI_MEDIA_SURFACE
     uint32_t                frame_idx;
     void                   *pDecCtx;
     void                   *pVpCtx;
+    void                   *pPendingEncCtx;     // encode context holding an unsubmitted picture that reads this surface
+    void                   *pPendingVpCtx;      // VP context holding an unsubmitted render job that uses this surface
+    void                   *pPendingDecCtx;     // decode context holding an unsubmitted picture that writes this surface
 
     uint32_t                            curCtxType;                // indicate current surface is using in which context type.
     DDI_MEDIA_STATUS_REPORT_QUERY_STATE curStatusReportQueryState; // indicate status report is queried or not.
     DDI_MEDIA_SURFACE_STATUS_REPORT     curStatusReport;           // union for both decode and vpp status.
+    uint32_t                            decStatusReportIndex;      // decode status report slot of the latest picture decoded into this surface
 
     PDDI_MEDIA_CONTEXT      pMediaCtx; // Media driver Context
     PMEDIA_SEM_T            pCurrentFrameSemaphore;   // to sync render target for hybrid decoding multi-threading mode
@@ -398,6 +402,12 @@ struct DDI_MEDIA_CONTEXT
     PDDI_MEDIA_HEAP     pMfeCtxHeap;
     uint32_t            uiNumMfes;
 
+    // Automatic MFE batching across encode contexts
+    struct _DDI_ENCODE_AUTO_MFE *pAutoMfe;
+
+    // Recently destroyed decode contexts kept for reuse
+    struct _DDI_DECODE_CONTEXT_POOL *pDecodeCtxPool;
+
     // display info
     uint32_t            uiDisplayWidth;
     uint32_t            uiDisplayHeight;
@@ -420,6 +430,7 @@ struct DDI_MEDIA_CONTEXT
     MEDIA_MUTEX_T       VpMutex;
     MEDIA_MUTEX_T       CmMutex;
     MEDIA_MUTEX_T       MfeMutex;
+    MEDIA_MUTEX_T       PendingMutex;   // protects the pPending*Ctx of surfaces against destroying the context
 
     // GT system Info
     MEDIA_SYSTEM_INFO  *pGtSystemInfo;
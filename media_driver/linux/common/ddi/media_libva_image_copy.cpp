@@ -0,0 +1,851 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      media_libva_image_copy.cpp
+//! \brief     Pitch aware CPU copy and format conversion for vaGetImage/vaPutImage
+//!
+
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <immintrin.h>
+#include "media_libva_image_copy.h"
+
+#define DDI_IMAGE_COPY_TARGET_SSE4      __attribute__((target("sse4.1")))
+#define DDI_IMAGE_COPY_TARGET_AVX2      __attribute__((target("avx2")))
+
+#define DDI_IMAGE_COPY_IS_ALIGNED(p, a) ((((uintptr_t)(p)) & ((a) - 1)) == 0)
+
+typedef enum _DDI_IMAGE_COPY_OP
+{
+    DDI_IMAGE_COPY_OP_COPY = 0,         //!< Plain row copy
+    DDI_IMAGE_COPY_OP_SHUFFLE,          //!< Byte shuffle, mask and set inside each 16 bytes
+    DDI_IMAGE_COPY_OP_SPLIT_UV,         //!< Interleaved UV to U and V planes
+    DDI_IMAGE_COPY_OP_MERGE_UV          //!< U and V planes to interleaved UV
+} DDI_IMAGE_COPY_OP;
+
+typedef enum _DDI_IMAGE_COPY_FAMILY
+{
+    DDI_IMAGE_COPY_FAMILY_NONE = 0,
+    DDI_IMAGE_COPY_FAMILY_YUV420,
+    DDI_IMAGE_COPY_FAMILY_YUV420_16,
+    DDI_IMAGE_COPY_FAMILY_YUV422,
+    DDI_IMAGE_COPY_FAMILY_RGB32
+} DDI_IMAGE_COPY_FAMILY;
+
+//!
+//! \brief    dst[i] = (src[ctrl[i]] & andMask[i]) | orMask[i] in every 16 bytes
+//!
+typedef struct _DDI_IMAGE_COPY_SHUFFLE
+{
+    uint8_t     ctrl[16];
+    uint8_t     andMask[16];
+    uint8_t     orMask[16];
+} DDI_IMAGE_COPY_SHUFFLE;
+
+typedef struct _DDI_IMAGE_COPY_KERNELS
+{
+    void (*pfnCopyRow)(uint8_t *dst, const uint8_t *src, uint32_t bytes, bool srcWC, bool dstWC);
+    void (*pfnShuffleRow)(uint8_t *dst, const uint8_t *src, uint32_t bytes, const DDI_IMAGE_COPY_SHUFFLE *shuffle, bool srcWC, bool dstWC);
+    void (*pfnSplitRow)(uint8_t *dstU, uint8_t *dstV, const uint8_t *srcUV, uint32_t pixels, bool srcWC, bool dstWC);
+    void (*pfnMergeRow)(uint8_t *dstUV, const uint8_t *srcU, const uint8_t *srcV, uint32_t pixels, bool srcWC, bool dstWC);
+} DDI_IMAGE_COPY_KERNELS;
+
+typedef struct _DDI_IMAGE_COPY_PLANE_OP
+{
+    DDI_IMAGE_COPY_OP   op;
+    uint8_t             *dst[2];
+    uint32_t            dstPitch[2];
+    const uint8_t       *src[2];
+    uint32_t            srcPitch[2];
+    uint32_t            count;          //!< Bytes for copy and shuffle, UV pairs for split and merge
+    uint32_t            rows;
+    uint32_t            rowShift;       //!< Vertical subsampling of the plane
+} DDI_IMAGE_COPY_PLANE_OP;
+
+typedef struct _DDI_IMAGE_COPY_JOB
+{
+    DDI_IMAGE_COPY_PLANE_OP         ops[DDI_IMAGE_COPY_MAX_PLANES];
+    uint32_t                        opNum;
+    DDI_IMAGE_COPY_SHUFFLE          shuffle;
+    bool                            srcWC;
+    bool                            dstWC;
+    const DDI_IMAGE_COPY_KERNELS    *kernels;
+} DDI_IMAGE_COPY_JOB;
+
+typedef struct _DDI_IMAGE_COPY_BAND
+{
+    const DDI_IMAGE_COPY_JOB    *job;
+    uint32_t                    startRow;
+    uint32_t                    endRow;
+} DDI_IMAGE_COPY_BAND;
+
+//------------------------------------------------------------------------------
+// C kernels, also used for the row tails of the SIMD kernels
+//------------------------------------------------------------------------------
+static void DdiImageCopy_CopyRow_C(uint8_t *dst, const uint8_t *src, uint32_t bytes, bool srcWC, bool dstWC)
+{
+    (void)srcWC;
+    (void)dstWC;
+    memcpy(dst, src, bytes);
+}
+
+static void DdiImageCopy_ShuffleRow_C(uint8_t *dst, const uint8_t *src, uint32_t bytes, const DDI_IMAGE_COPY_SHUFFLE *shuffle, bool srcWC, bool dstWC)
+{
+    (void)srcWC;
+    (void)dstWC;
+    for (uint32_t i = 0; i < bytes; i++)
+    {
+        uint32_t j = i & 15;
+        dst[i] = (src[(i & ~15u) + shuffle->ctrl[j]] & shuffle->andMask[j]) | shuffle->orMask[j];
+    }
+}
+
+static void DdiImageCopy_SplitRow_C(uint8_t *dstU, uint8_t *dstV, const uint8_t *srcUV, uint32_t pixels, bool srcWC, bool dstWC)
+{
+    (void)srcWC;
+    (void)dstWC;
+    for (uint32_t i = 0; i < pixels; i++)
+    {
+        dstU[i] = srcUV[2 * i];
+        dstV[i] = srcUV[2 * i + 1];
+    }
+}
+
+static void DdiImageCopy_MergeRow_C(uint8_t *dstUV, const uint8_t *srcU, const uint8_t *srcV, uint32_t pixels, bool srcWC, bool dstWC)
+{
+    (void)srcWC;
+    (void)dstWC;
+    for (uint32_t i = 0; i < pixels; i++)
+    {
+        dstUV[2 * i]     = srcU[i];
+        dstUV[2 * i + 1] = srcV[i];
+    }
+}
+
+//------------------------------------------------------------------------------
+// SSE4.1 kernels: movntdqa reads from WC sources, movntdq writes to WC targets
+//------------------------------------------------------------------------------
+static inline DDI_IMAGE_COPY_TARGET_SSE4 __m128i DdiImageCopy_Load128(const uint8_t *p, bool nt)
+{
+    return nt ? _mm_stream_load_si128((__m128i *)p) : _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline DDI_IMAGE_COPY_TARGET_SSE4 void DdiImageCopy_Store128(uint8_t *p, __m128i v, bool nt)
+{
+    if (nt)
+    {
+        _mm_stream_si128((__m128i *)p, v);
+    }
+    else
+    {
+        _mm_storeu_si128((__m128i *)p, v);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_SSE4 void DdiImageCopy_CopyRow_SSE4(uint8_t *dst, const uint8_t *src, uint32_t bytes, bool srcWC, bool dstWC)
+{
+    if (!srcWC && !dstWC)
+    {
+        memcpy(dst, src, bytes);
+        return;
+    }
+
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(src, 16);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dst, 16);
+    uint32_t i       = 0;
+
+    // Four lines in flight per iteration keeps the WC fill buffers busy
+    for (; i + 64 <= bytes; i += 64)
+    {
+        __m128i v0 = DdiImageCopy_Load128(src + i,      ntLoad);
+        __m128i v1 = DdiImageCopy_Load128(src + i + 16, ntLoad);
+        __m128i v2 = DdiImageCopy_Load128(src + i + 32, ntLoad);
+        __m128i v3 = DdiImageCopy_Load128(src + i + 48, ntLoad);
+        DdiImageCopy_Store128(dst + i,      v0, ntStore);
+        DdiImageCopy_Store128(dst + i + 16, v1, ntStore);
+        DdiImageCopy_Store128(dst + i + 32, v2, ntStore);
+        DdiImageCopy_Store128(dst + i + 48, v3, ntStore);
+    }
+    for (; i + 16 <= bytes; i += 16)
+    {
+        DdiImageCopy_Store128(dst + i, DdiImageCopy_Load128(src + i, ntLoad), ntStore);
+    }
+    if (i < bytes)
+    {
+        memcpy(dst + i, src + i, bytes - i);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_SSE4 void DdiImageCopy_ShuffleRow_SSE4(uint8_t *dst, const uint8_t *src, uint32_t bytes, const DDI_IMAGE_COPY_SHUFFLE *shuffle, bool srcWC, bool dstWC)
+{
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(src, 16);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dst, 16);
+    __m128i  ctrl    = _mm_loadu_si128((const __m128i *)shuffle->ctrl);
+    __m128i  andMask = _mm_loadu_si128((const __m128i *)shuffle->andMask);
+    __m128i  orMask  = _mm_loadu_si128((const __m128i *)shuffle->orMask);
+    uint32_t i       = 0;
+
+    for (; i + 16 <= bytes; i += 16)
+    {
+        __m128i v = _mm_shuffle_epi8(DdiImageCopy_Load128(src + i, ntLoad), ctrl);
+        v = _mm_or_si128(_mm_and_si128(v, andMask), orMask);
+        DdiImageCopy_Store128(dst + i, v, ntStore);
+    }
+    if (i < bytes)
+    {
+        DdiImageCopy_ShuffleRow_C(dst + i, src + i, bytes - i, shuffle, srcWC, dstWC);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_SSE4 void DdiImageCopy_SplitRow_SSE4(uint8_t *dstU, uint8_t *dstV, const uint8_t *srcUV, uint32_t pixels, bool srcWC, bool dstWC)
+{
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(srcUV, 16);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dstU, 16) && DDI_IMAGE_COPY_IS_ALIGNED(dstV, 16);
+    __m128i  ctrl    = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    uint32_t i       = 0;
+
+    for (; i + 16 <= pixels; i += 16)
+    {
+        __m128i a = _mm_shuffle_epi8(DdiImageCopy_Load128(srcUV + 2 * i,      ntLoad), ctrl);
+        __m128i b = _mm_shuffle_epi8(DdiImageCopy_Load128(srcUV + 2 * i + 16, ntLoad), ctrl);
+        DdiImageCopy_Store128(dstU + i, _mm_unpacklo_epi64(a, b), ntStore);
+        DdiImageCopy_Store128(dstV + i, _mm_unpackhi_epi64(a, b), ntStore);
+    }
+    if (i < pixels)
+    {
+        DdiImageCopy_SplitRow_C(dstU + i, dstV + i, srcUV + 2 * i, pixels - i, srcWC, dstWC);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_SSE4 void DdiImageCopy_MergeRow_SSE4(uint8_t *dstUV, const uint8_t *srcU, const uint8_t *srcV, uint32_t pixels, bool srcWC, bool dstWC)
+{
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(srcU, 16) && DDI_IMAGE_COPY_IS_ALIGNED(srcV, 16);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dstUV, 16);
+    uint32_t i       = 0;
+
+    for (; i + 16 <= pixels; i += 16)
+    {
+        __m128i u = DdiImageCopy_Load128(srcU + i, ntLoad);
+        __m128i v = DdiImageCopy_Load128(srcV + i, ntLoad);
+        DdiImageCopy_Store128(dstUV + 2 * i,      _mm_unpacklo_epi8(u, v), ntStore);
+        DdiImageCopy_Store128(dstUV + 2 * i + 16, _mm_unpackhi_epi8(u, v), ntStore);
+    }
+    if (i < pixels)
+    {
+        DdiImageCopy_MergeRow_C(dstUV + 2 * i, srcU + i, srcV + i, pixels - i, srcWC, dstWC);
+    }
+}
+
+//------------------------------------------------------------------------------
+// AVX2 kernels
+//------------------------------------------------------------------------------
+static inline DDI_IMAGE_COPY_TARGET_AVX2 __m256i DdiImageCopy_Load256(const uint8_t *p, bool nt)
+{
+    return nt ? _mm256_stream_load_si256((__m256i *)p) : _mm256_loadu_si256((const __m256i *)p);
+}
+
+static inline DDI_IMAGE_COPY_TARGET_AVX2 void DdiImageCopy_Store256(uint8_t *p, __m256i v, bool nt)
+{
+    if (nt)
+    {
+        _mm256_stream_si256((__m256i *)p, v);
+    }
+    else
+    {
+        _mm256_storeu_si256((__m256i *)p, v);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_AVX2 void DdiImageCopy_CopyRow_AVX2(uint8_t *dst, const uint8_t *src, uint32_t bytes, bool srcWC, bool dstWC)
+{
+    if (!srcWC && !dstWC)
+    {
+        memcpy(dst, src, bytes);
+        return;
+    }
+
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(src, 32);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dst, 32);
+    uint32_t i       = 0;
+
+    for (; i + 128 <= bytes; i += 128)
+    {
+        __m256i v0 = DdiImageCopy_Load256(src + i,      ntLoad);
+        __m256i v1 = DdiImageCopy_Load256(src + i + 32, ntLoad);
+        __m256i v2 = DdiImageCopy_Load256(src + i + 64, ntLoad);
+        __m256i v3 = DdiImageCopy_Load256(src + i + 96, ntLoad);
+        DdiImageCopy_Store256(dst + i,      v0, ntStore);
+        DdiImageCopy_Store256(dst + i + 32, v1, ntStore);
+        DdiImageCopy_Store256(dst + i + 64, v2, ntStore);
+        DdiImageCopy_Store256(dst + i + 96, v3, ntStore);
+    }
+    for (; i + 32 <= bytes; i += 32)
+    {
+        DdiImageCopy_Store256(dst + i, DdiImageCopy_Load256(src + i, ntLoad), ntStore);
+    }
+    if (i < bytes)
+    {
+        DdiImageCopy_CopyRow_SSE4(dst + i, src + i, bytes - i, srcWC, dstWC);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_AVX2 void DdiImageCopy_ShuffleRow_AVX2(uint8_t *dst, const uint8_t *src, uint32_t bytes, const DDI_IMAGE_COPY_SHUFFLE *shuffle, bool srcWC, bool dstWC)
+{
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(src, 32);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dst, 32);
+    // vpshufb works per 128-bit lane, which matches the 16 byte pattern
+    __m256i  ctrl    = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)shuffle->ctrl));
+    __m256i  andMask = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)shuffle->andMask));
+    __m256i  orMask  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)shuffle->orMask));
+    uint32_t i       = 0;
+
+    for (; i + 32 <= bytes; i += 32)
+    {
+        __m256i v = _mm256_shuffle_epi8(DdiImageCopy_Load256(src + i, ntLoad), ctrl);
+        v = _mm256_or_si256(_mm256_and_si256(v, andMask), orMask);
+        DdiImageCopy_Store256(dst + i, v, ntStore);
+    }
+    if (i < bytes)
+    {
+        DdiImageCopy_ShuffleRow_SSE4(dst + i, src + i, bytes - i, shuffle, srcWC, dstWC);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_AVX2 void DdiImageCopy_SplitRow_AVX2(uint8_t *dstU, uint8_t *dstV, const uint8_t *srcUV, uint32_t pixels, bool srcWC, bool dstWC)
+{
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(srcUV, 32);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dstU, 32) && DDI_IMAGE_COPY_IS_ALIGNED(dstV, 32);
+    __m256i  ctrl    = _mm256_setr_epi8(
+        0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15,
+        0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    uint32_t i       = 0;
+
+    for (; i + 32 <= pixels; i += 32)
+    {
+        // Each lane becomes {U x8, V x8}, then gather the U and V quadwords
+        __m256i a = _mm256_shuffle_epi8(DdiImageCopy_Load256(srcUV + 2 * i,      ntLoad), ctrl);
+        __m256i b = _mm256_shuffle_epi8(DdiImageCopy_Load256(srcUV + 2 * i + 32, ntLoad), ctrl);
+        a = _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3, 1, 2, 0));
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(3, 1, 2, 0));
+        DdiImageCopy_Store256(dstU + i, _mm256_permute2x128_si256(a, b, 0x20), ntStore);
+        DdiImageCopy_Store256(dstV + i, _mm256_permute2x128_si256(a, b, 0x31), ntStore);
+    }
+    if (i < pixels)
+    {
+        DdiImageCopy_SplitRow_SSE4(dstU + i, dstV + i, srcUV + 2 * i, pixels - i, srcWC, dstWC);
+    }
+}
+
+static DDI_IMAGE_COPY_TARGET_AVX2 void DdiImageCopy_MergeRow_AVX2(uint8_t *dstUV, const uint8_t *srcU, const uint8_t *srcV, uint32_t pixels, bool srcWC, bool dstWC)
+{
+    bool     ntLoad  = srcWC && DDI_IMAGE_COPY_IS_ALIGNED(srcU, 32) && DDI_IMAGE_COPY_IS_ALIGNED(srcV, 32);
+    bool     ntStore = dstWC && DDI_IMAGE_COPY_IS_ALIGNED(dstUV, 32);
+    uint32_t i       = 0;
+
+    for (; i + 32 <= pixels; i += 32)
+    {
+        __m256i u  = DdiImageCopy_Load256(srcU + i, ntLoad);
+        __m256i v  = DdiImageCopy_Load256(srcV + i, ntLoad);
+        __m256i lo = _mm256_unpacklo_epi8(u, v);
+        __m256i hi = _mm256_unpackhi_epi8(u, v);
+        DdiImageCopy_Store256(dstUV + 2 * i,      _mm256_permute2x128_si256(lo, hi, 0x20), ntStore);
+        DdiImageCopy_Store256(dstUV + 2 * i + 32, _mm256_permute2x128_si256(lo, hi, 0x31), ntStore);
+    }
+    if (i < pixels)
+    {
+        DdiImageCopy_MergeRow_SSE4(dstUV + 2 * i, srcU + i, srcV + i, pixels - i, srcWC, dstWC);
+    }
+}
+
+static const DDI_IMAGE_COPY_KERNELS g_ddiImageCopyKernels_C =
+{
+    DdiImageCopy_CopyRow_C,
+    DdiImageCopy_ShuffleRow_C,
+    DdiImageCopy_SplitRow_C,
+    DdiImageCopy_MergeRow_C
+};
+
+static const DDI_IMAGE_COPY_KERNELS g_ddiImageCopyKernels_SSE4 =
+{
+    DdiImageCopy_CopyRow_SSE4,
+    DdiImageCopy_ShuffleRow_SSE4,
+    DdiImageCopy_SplitRow_SSE4,
+    DdiImageCopy_MergeRow_SSE4
+};
+
+static const DDI_IMAGE_COPY_KERNELS g_ddiImageCopyKernels_AVX2 =
+{
+    DdiImageCopy_CopyRow_AVX2,
+    DdiImageCopy_ShuffleRow_AVX2,
+    DdiImageCopy_SplitRow_AVX2,
+    DdiImageCopy_MergeRow_AVX2
+};
+
+static const DDI_IMAGE_COPY_KERNELS *DdiImageCopy_GetKernels()
+{
+    static const DDI_IMAGE_COPY_KERNELS *kernels =
+        __builtin_cpu_supports("avx2")   ? &g_ddiImageCopyKernels_AVX2 :
+        __builtin_cpu_supports("sse4.1") ? &g_ddiImageCopyKernels_SSE4 :
+                                           &g_ddiImageCopyKernels_C;
+    return kernels;
+}
+
+//------------------------------------------------------------------------------
+// Frame level
+//------------------------------------------------------------------------------
+static DDI_IMAGE_COPY_FAMILY DdiImageCopy_GetFamily(DDI_IMAGE_COPY_FORMAT format)
+{
+    switch (format)
+    {
+        case DDI_IMAGE_COPY_FORMAT_NV12:
+        case DDI_IMAGE_COPY_FORMAT_I420:
+        case DDI_IMAGE_COPY_FORMAT_YV12:
+            return DDI_IMAGE_COPY_FAMILY_YUV420;
+        case DDI_IMAGE_COPY_FORMAT_P010:
+        case DDI_IMAGE_COPY_FORMAT_P016:
+            return DDI_IMAGE_COPY_FAMILY_YUV420_16;
+        case DDI_IMAGE_COPY_FORMAT_YUY2:
+        case DDI_IMAGE_COPY_FORMAT_UYVY:
+            return DDI_IMAGE_COPY_FAMILY_YUV422;
+        case DDI_IMAGE_COPY_FORMAT_RGBA:
+        case DDI_IMAGE_COPY_FORMAT_BGRA:
+        case DDI_IMAGE_COPY_FORMAT_RGBX:
+        case DDI_IMAGE_COPY_FORMAT_BGRX:
+            return DDI_IMAGE_COPY_FAMILY_RGB32;
+        default:
+            return DDI_IMAGE_COPY_FAMILY_NONE;
+    }
+}
+
+uint32_t DdiImageCopy_GetPlaneNum(DDI_IMAGE_COPY_FORMAT format)
+{
+    switch (format)
+    {
+        case DDI_IMAGE_COPY_FORMAT_NV12:
+        case DDI_IMAGE_COPY_FORMAT_P010:
+        case DDI_IMAGE_COPY_FORMAT_P016:
+            return 2;
+        case DDI_IMAGE_COPY_FORMAT_I420:
+        case DDI_IMAGE_COPY_FORMAT_YV12:
+            return 3;
+        case DDI_IMAGE_COPY_FORMAT_UNKNOWN:
+        case DDI_IMAGE_COPY_FORMAT_COUNT:
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+bool DdiImageCopy_IsOriginAligned(DDI_IMAGE_COPY_FORMAT format, uint32_t x, uint32_t y)
+{
+    switch (DdiImageCopy_GetFamily(format))
+    {
+        case DDI_IMAGE_COPY_FAMILY_YUV420:
+        case DDI_IMAGE_COPY_FAMILY_YUV420_16:
+            return ((x | y) & 1) == 0;
+        case DDI_IMAGE_COPY_FAMILY_YUV422:
+            return (x & 1) == 0;
+        case DDI_IMAGE_COPY_FAMILY_RGB32:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void DdiImageCopy_SetOrigin(PDDI_IMAGE_COPY_FRAME frame, uint32_t x, uint32_t y)
+{
+    if (frame == nullptr)
+    {
+        return;
+    }
+
+    // Bytes per pixel of the first plane and per chroma sample of the others
+    uint32_t lumaBytes   = 1;
+    uint32_t chromaBytes = 1;
+
+    switch (frame->format)
+    {
+        case DDI_IMAGE_COPY_FORMAT_NV12:
+            chromaBytes = 2;
+            break;
+        case DDI_IMAGE_COPY_FORMAT_P010:
+        case DDI_IMAGE_COPY_FORMAT_P016:
+            lumaBytes   = 2;
+            chromaBytes = 4;
+            break;
+        case DDI_IMAGE_COPY_FORMAT_YUY2:
+        case DDI_IMAGE_COPY_FORMAT_UYVY:
+            lumaBytes   = 2;
+            break;
+        case DDI_IMAGE_COPY_FORMAT_RGBA:
+        case DDI_IMAGE_COPY_FORMAT_BGRA:
+        case DDI_IMAGE_COPY_FORMAT_RGBX:
+        case DDI_IMAGE_COPY_FORMAT_BGRX:
+            lumaBytes   = 4;
+            break;
+        default:
+            break;
+    }
+
+    frame->plane[0] += (size_t)y * frame->pitch[0] + x * lumaBytes;
+    for (uint32_t i = 1; i < DdiImageCopy_GetPlaneNum(frame->format); i++)
+    {
+        frame->plane[i] += (size_t)(y / 2) * frame->pitch[i] + (x / 2) * chromaBytes;
+    }
+}
+
+bool DdiImageCopy_IsSupported(DDI_IMAGE_COPY_FORMAT srcFormat, DDI_IMAGE_COPY_FORMAT dstFormat)
+{
+    DDI_IMAGE_COPY_FAMILY family = DdiImageCopy_GetFamily(srcFormat);
+    return (family != DDI_IMAGE_COPY_FAMILY_NONE) && (family == DdiImageCopy_GetFamily(dstFormat));
+}
+
+static void DdiImageCopy_AddOp(
+    DDI_IMAGE_COPY_JOB  *job,
+    DDI_IMAGE_COPY_OP   op,
+    uint8_t             *dst0,
+    uint32_t            dstPitch0,
+    uint8_t             *dst1,
+    uint32_t            dstPitch1,
+    const uint8_t       *src0,
+    uint32_t            srcPitch0,
+    const uint8_t       *src1,
+    uint32_t            srcPitch1,
+    uint32_t            count,
+    uint32_t            rows,
+    uint32_t            rowShift)
+{
+    DDI_IMAGE_COPY_PLANE_OP *planeOp = &job->ops[job->opNum++];
+
+    planeOp->op          = op;
+    planeOp->dst[0]      = dst0;
+    planeOp->dstPitch[0] = dstPitch0;
+    planeOp->dst[1]      = dst1;
+    planeOp->dstPitch[1] = dstPitch1;
+    planeOp->src[0]      = src0;
+    planeOp->srcPitch[0] = srcPitch0;
+    planeOp->src[1]      = src1;
+    planeOp->srcPitch[1] = srcPitch1;
+    planeOp->count       = count;
+    planeOp->rows        = rows;
+    planeOp->rowShift    = rowShift;
+}
+
+//!
+//! \brief    Add a copy, or a shuffle when the pattern is not the identity
+//!
+static void DdiImageCopy_AddCopyOrShuffle(
+    DDI_IMAGE_COPY_JOB  *job,
+    uint8_t             *dst,
+    uint32_t            dstPitch,
+    const uint8_t       *src,
+    uint32_t            srcPitch,
+    uint32_t            bytes,
+    uint32_t            rows,
+    uint32_t            rowShift)
+{
+    bool identity = true;
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        if (job->shuffle.ctrl[i] != i || job->shuffle.andMask[i] != 0xff || job->shuffle.orMask[i] != 0)
+        {
+            identity = false;
+            break;
+        }
+    }
+
+    DdiImageCopy_AddOp(job, identity ? DDI_IMAGE_COPY_OP_COPY : DDI_IMAGE_COPY_OP_SHUFFLE,
+        dst, dstPitch, nullptr, 0, src, srcPitch, nullptr, 0, bytes, rows, rowShift);
+}
+
+//!
+//! \brief    Get the U and V planes of a planar 4:2:0 frame
+//!
+static void DdiImageCopy_GetUVPlanes(const DDI_IMAGE_COPY_FRAME *frame, uint32_t *uIndex, uint32_t *vIndex)
+{
+    bool yv12 = (frame->format == DDI_IMAGE_COPY_FORMAT_YV12);
+    *uIndex   = yv12 ? 2 : 1;
+    *vIndex   = yv12 ? 1 : 2;
+}
+
+static bool DdiImageCopy_BuildJob(
+    const DDI_IMAGE_COPY_FRAME  *src,
+    const DDI_IMAGE_COPY_FRAME  *dst,
+    uint32_t                    width,
+    uint32_t                    height,
+    DDI_IMAGE_COPY_JOB          *job)
+{
+    DDI_IMAGE_COPY_SHUFFLE *shuffle = &job->shuffle;
+
+    memset(job, 0, sizeof(*job));
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        shuffle->ctrl[i]    = (uint8_t)i;
+        shuffle->andMask[i] = 0xff;
+    }
+    job->srcWC   = src->writeCombined;
+    job->dstWC   = dst->writeCombined;
+    job->kernels = DdiImageCopy_GetKernels();
+
+    uint32_t chromaWidth  = (width + 1) / 2;
+    uint32_t chromaHeight = (height + 1) / 2;
+
+    switch (DdiImageCopy_GetFamily(src->format))
+    {
+        case DDI_IMAGE_COPY_FAMILY_YUV420:
+        {
+            DdiImageCopy_AddOp(job, DDI_IMAGE_COPY_OP_COPY,
+                dst->plane[0], dst->pitch[0], nullptr, 0,
+                src->plane[0], src->pitch[0], nullptr, 0,
+                width, height, 0);
+
+            uint32_t srcU, srcV, dstU, dstV;
+            DdiImageCopy_GetUVPlanes(src, &srcU, &srcV);
+            DdiImageCopy_GetUVPlanes(dst, &dstU, &dstV);
+
+            if (src->format == DDI_IMAGE_COPY_FORMAT_NV12 && dst->format == DDI_IMAGE_COPY_FORMAT_NV12)
+            {
+                DdiImageCopy_AddOp(job, DDI_IMAGE_COPY_OP_COPY,
+                    dst->plane[1], dst->pitch[1], nullptr, 0,
+                    src->plane[1], src->pitch[1], nullptr, 0,
+                    chromaWidth * 2, chromaHeight, 1);
+            }
+            else if (src->format == DDI_IMAGE_COPY_FORMAT_NV12)
+            {
+                DdiImageCopy_AddOp(job, DDI_IMAGE_COPY_OP_SPLIT_UV,
+                    dst->plane[dstU], dst->pitch[dstU], dst->plane[dstV], dst->pitch[dstV],
+                    src->plane[1], src->pitch[1], nullptr, 0,
+                    chromaWidth, chromaHeight, 1);
+            }
+            else if (dst->format == DDI_IMAGE_COPY_FORMAT_NV12)
+            {
+                DdiImageCopy_AddOp(job, DDI_IMAGE_COPY_OP_MERGE_UV,
+                    dst->plane[1], dst->pitch[1], nullptr, 0,
+                    src->plane[srcU], src->pitch[srcU], src->plane[srcV], src->pitch[srcV],
+                    chromaWidth, chromaHeight, 1);
+            }
+            else
+            {
+                DdiImageCopy_AddOp(job, DDI_IMAGE_COPY_OP_COPY,
+                    dst->plane[dstU], dst->pitch[dstU], nullptr, 0,
+                    src->plane[srcU], src->pitch[srcU], nullptr, 0,
+                    chromaWidth, chromaHeight, 1);
+                DdiImageCopy_AddOp(job, DDI_IMAGE_COPY_OP_COPY,
+                    dst->plane[dstV], dst->pitch[dstV], nullptr, 0,
+                    src->plane[srcV], src->pitch[srcV], nullptr, 0,
+                    chromaWidth, chromaHeight, 1);
+            }
+            break;
+        }
+        case DDI_IMAGE_COPY_FAMILY_YUV420_16:
+            // P010 keeps its 10 bits in the MSBs, so it is valid P016 as is;
+            // the other way clears the 6 LSBs P010 defines as zero.
+            if (src->format == DDI_IMAGE_COPY_FORMAT_P016 && dst->format == DDI_IMAGE_COPY_FORMAT_P010)
+            {
+                for (uint32_t i = 0; i < 16; i += 2)
+                {
+                    shuffle->andMask[i] = 0xc0;
+                }
+            }
+            DdiImageCopy_AddCopyOrShuffle(job, dst->plane[0], dst->pitch[0], src->plane[0], src->pitch[0], width * 2, height, 0);
+            DdiImageCopy_AddCopyOrShuffle(job, dst->plane[1], dst->pitch[1], src->plane[1], src->pitch[1], chromaWidth * 4, chromaHeight, 1);
+            break;
+        case DDI_IMAGE_COPY_FAMILY_YUV422:
+            if (src->format != dst->format)
+            {
+                for (uint32_t i = 0; i < 16; i++)
+                {
+                    shuffle->ctrl[i] = (uint8_t)(i ^ 1);
+                }
+            }
+            DdiImageCopy_AddCopyOrShuffle(job, dst->plane[0], dst->pitch[0], src->plane[0], src->pitch[0], chromaWidth * 4, height, 0);
+            break;
+        case DDI_IMAGE_COPY_FAMILY_RGB32:
+        {
+            bool srcBgr   = (src->format == DDI_IMAGE_COPY_FORMAT_BGRA || src->format == DDI_IMAGE_COPY_FORMAT_BGRX);
+            bool dstBgr   = (dst->format == DDI_IMAGE_COPY_FORMAT_BGRA || dst->format == DDI_IMAGE_COPY_FORMAT_BGRX);
+            bool srcAlpha = (src->format == DDI_IMAGE_COPY_FORMAT_RGBA || src->format == DDI_IMAGE_COPY_FORMAT_BGRA);
+            bool dstAlpha = (dst->format == DDI_IMAGE_COPY_FORMAT_RGBA || dst->format == DDI_IMAGE_COPY_FORMAT_BGRA);
+
+            for (uint32_t i = 0; i < 16; i += 4)
+            {
+                if (srcBgr != dstBgr)
+                {
+                    shuffle->ctrl[i]     = (uint8_t)(i + 2);
+                    shuffle->ctrl[i + 2] = (uint8_t)i;
+                }
+                if (dstAlpha && !srcAlpha)
+                {
+                    shuffle->orMask[i + 3] = 0xff;
+                }
+            }
+            DdiImageCopy_AddCopyOrShuffle(job, dst->plane[0], dst->pitch[0], src->plane[0], src->pitch[0], width * 4, height, 0);
+            break;
+        }
+        default:
+            return false;
+    }
+
+    // Validate every plane the job touches
+    for (uint32_t i = 0; i < job->opNum; i++)
+    {
+        DDI_IMAGE_COPY_PLANE_OP *op = &job->ops[i];
+        uint32_t dstBytes = (op->op == DDI_IMAGE_COPY_OP_SPLIT_UV) ? op->count : ((op->op == DDI_IMAGE_COPY_OP_MERGE_UV) ? op->count * 2 : op->count);
+        uint32_t srcBytes = (op->op == DDI_IMAGE_COPY_OP_MERGE_UV) ? op->count : ((op->op == DDI_IMAGE_COPY_OP_SPLIT_UV) ? op->count * 2 : op->count);
+        uint32_t dstNum   = (op->op == DDI_IMAGE_COPY_OP_SPLIT_UV) ? 2 : 1;
+        uint32_t srcNum   = (op->op == DDI_IMAGE_COPY_OP_MERGE_UV) ? 2 : 1;
+
+        for (uint32_t j = 0; j < dstNum; j++)
+        {
+            if (op->dst[j] == nullptr || (op->rows > 1 && op->dstPitch[j] < dstBytes))
+            {
+                return false;
+            }
+        }
+        for (uint32_t j = 0; j < srcNum; j++)
+        {
+            if (op->src[j] == nullptr || (op->rows > 1 && op->srcPitch[j] < srcBytes))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void DdiImageCopy_RunBand(const DDI_IMAGE_COPY_BAND *band)
+{
+    const DDI_IMAGE_COPY_JOB     *job     = band->job;
+    const DDI_IMAGE_COPY_KERNELS *kernels = job->kernels;
+
+    for (uint32_t i = 0; i < job->opNum; i++)
+    {
+        const DDI_IMAGE_COPY_PLANE_OP *op = &job->ops[i];
+        uint32_t startRow = band->startRow >> op->rowShift;
+        uint32_t endRow   = (band->endRow + (1 << op->rowShift) - 1) >> op->rowShift;
+
+        endRow = (endRow > op->rows) ? op->rows : endRow;
+
+        for (uint32_t y = startRow; y < endRow; y++)
+        {
+            uint8_t       *dst0 = op->dst[0] + (size_t)y * op->dstPitch[0];
+            const uint8_t *src0 = op->src[0] + (size_t)y * op->srcPitch[0];
+
+            switch (op->op)
+            {
+                case DDI_IMAGE_COPY_OP_COPY:
+                    kernels->pfnCopyRow(dst0, src0, op->count, job->srcWC, job->dstWC);
+                    break;
+                case DDI_IMAGE_COPY_OP_SHUFFLE:
+                    kernels->pfnShuffleRow(dst0, src0, op->count, &job->shuffle, job->srcWC, job->dstWC);
+                    break;
+                case DDI_IMAGE_COPY_OP_SPLIT_UV:
+                    kernels->pfnSplitRow(dst0, op->dst[1] + (size_t)y * op->dstPitch[1], src0, op->count, job->srcWC, job->dstWC);
+                    break;
+                case DDI_IMAGE_COPY_OP_MERGE_UV:
+                    kernels->pfnMergeRow(dst0, src0, op->src[1] + (size_t)y * op->srcPitch[1], op->count, job->srcWC, job->dstWC);
+                    break;
+            }
+        }
+    }
+
+    // Drain the streaming stores before the caller unmaps the surface
+    _mm_sfence();
+}
+
+static void *DdiImageCopy_BandThread(void *arg)
+{
+    DdiImageCopy_RunBand((const DDI_IMAGE_COPY_BAND *)arg);
+    return nullptr;
+}
+
+bool DdiImageCopy_CopyFrame(
+    const DDI_IMAGE_COPY_FRAME  *src,
+    const DDI_IMAGE_COPY_FRAME  *dst,
+    uint32_t                    width,
+    uint32_t                    height,
+    uint32_t                    maxThreads)
+{
+    DDI_IMAGE_COPY_JOB job;
+
+    if (src == nullptr || dst == nullptr || width == 0 || height == 0 ||
+        !DdiImageCopy_IsSupported(src->format, dst->format) ||
+        !DdiImageCopy_BuildJob(src, dst, width, height, &job))
+    {
+        return false;
+    }
+
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < job.opNum; i++)
+    {
+        bytes += (uint64_t)job.ops[i].count * job.ops[i].rows;
+    }
+
+    uint32_t threadNum = 1;
+    if (bytes >= DDI_IMAGE_COPY_PARALLEL_THRESHOLD && maxThreads > 1)
+    {
+        long cpuNum = sysconf(_SC_NPROCESSORS_ONLN);
+        threadNum   = (maxThreads < DDI_IMAGE_COPY_MAX_THREADS) ? maxThreads : DDI_IMAGE_COPY_MAX_THREADS;
+        threadNum   = (cpuNum > 0 && (uint32_t)cpuNum < threadNum) ? (uint32_t)cpuNum : threadNum;
+    }
+
+    // Bands start on even rows so 4:2:0 chroma rows are never shared
+    uint32_t bandRows = (((height + threadNum - 1) / threadNum) + 1) & ~1u;
+
+    DDI_IMAGE_COPY_BAND bands[DDI_IMAGE_COPY_MAX_THREADS];
+    pthread_t           threads[DDI_IMAGE_COPY_MAX_THREADS];
+    bool                started[DDI_IMAGE_COPY_MAX_THREADS] = {};
+    uint32_t            bandNum = 0;
+
+    for (uint32_t row = 0; row < height && bandNum < threadNum; row += bandRows, bandNum++)
+    {
+        bands[bandNum].job      = &job;
+        bands[bandNum].startRow = row;
+        bands[bandNum].endRow   = (row + bandRows < height) ? row + bandRows : height;
+    }
+
+    // The calling thread takes the first band; a band whose thread could
+    // not be created runs inline as well.
+    for (uint32_t i = 1; i < bandNum; i++)
+    {
+        started[i] = (pthread_create(&threads[i], nullptr, DdiImageCopy_BandThread, &bands[i]) == 0);
+    }
+
+    DdiImageCopy_RunBand(&bands[0]);
+
+    for (uint32_t i = 1; i < bandNum; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], nullptr);
+        }
+        else
+        {
+            DdiImageCopy_RunBand(&bands[i]);
+        }
+    }
+
+    return true;
+}
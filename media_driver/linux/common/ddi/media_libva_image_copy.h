@@ -0,0 +1,150 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      media_libva_image_copy.h
+//! \brief     Pitch aware CPU copy and format conversion for vaGetImage/vaPutImage
+//! \details   Frames are described plane by plane with their own pitch, so a
+//!            surface and an image of different pitches or plane offsets can be
+//!            copied without going through a full data_size memcpy. Conversion
+//!            is supported inside each layout family: NV12/I420/YV12, YUY2/UYVY,
+//!            P010/P016 and the 8-bit RGB32 orders. Rows are processed with
+//!            SSE4.1 or AVX2 kernels picked at run time, with streaming loads
+//!            and stores on write-combined mappings, and large frames are split
+//!            into row bands over a few threads. The file only depends on libc
+//!            and pthread so that it can be built into the ULT.
+//!
+
+#ifndef __MEDIA_LIBVA_IMAGE_COPY_H__
+#define __MEDIA_LIBVA_IMAGE_COPY_H__
+
+#include <stdint.h>
+
+#define DDI_IMAGE_COPY_MAX_PLANES           3
+#define DDI_IMAGE_COPY_MAX_THREADS          4
+
+//!
+//! \brief    Frames smaller than this are copied on the calling thread only
+//!
+#define DDI_IMAGE_COPY_PARALLEL_THRESHOLD   (2 * 1024 * 1024)
+
+typedef enum _DDI_IMAGE_COPY_FORMAT
+{
+    DDI_IMAGE_COPY_FORMAT_UNKNOWN = 0,
+    DDI_IMAGE_COPY_FORMAT_NV12,             //!< Y, UV
+    DDI_IMAGE_COPY_FORMAT_I420,             //!< Y, U, V
+    DDI_IMAGE_COPY_FORMAT_YV12,             //!< Y, V, U
+    DDI_IMAGE_COPY_FORMAT_YUY2,
+    DDI_IMAGE_COPY_FORMAT_UYVY,
+    DDI_IMAGE_COPY_FORMAT_P010,             //!< Y, UV, 10 bits in the MSBs of each word
+    DDI_IMAGE_COPY_FORMAT_P016,             //!< Y, UV
+    DDI_IMAGE_COPY_FORMAT_RGBA,             //!< R, G, B, A bytes in memory
+    DDI_IMAGE_COPY_FORMAT_BGRA,
+    DDI_IMAGE_COPY_FORMAT_RGBX,
+    DDI_IMAGE_COPY_FORMAT_BGRX,
+    DDI_IMAGE_COPY_FORMAT_COUNT
+} DDI_IMAGE_COPY_FORMAT;
+
+//!
+//! \brief    One side of a copy
+//! \details  Planes are in the order the format defines them and point at the
+//!           first pixel of the region to copy, see DdiImageCopy_SetOrigin.
+//!
+typedef struct _DDI_IMAGE_COPY_FRAME
+{
+    DDI_IMAGE_COPY_FORMAT   format;
+    uint8_t                 *plane[DDI_IMAGE_COPY_MAX_PLANES];
+    uint32_t                pitch[DDI_IMAGE_COPY_MAX_PLANES];
+    bool                    writeCombined;      //!< GTT or other uncached mapping
+} DDI_IMAGE_COPY_FRAME, *PDDI_IMAGE_COPY_FRAME;
+
+//!
+//! \brief    Get the number of planes of a format
+//! \param    [in] format
+//!           Copy format
+//! \return   uint32_t
+//!           Plane count, 0 for an unknown format
+//!
+uint32_t DdiImageCopy_GetPlaneNum(DDI_IMAGE_COPY_FORMAT format);
+
+//!
+//! \brief    Check if a region can start at (x, y)
+//! \details  The origin has to be on a chroma sample: even x for 4:2:2 and 4:2:0,
+//!           even y for 4:2:0.
+//! \param    [in] format
+//!           Copy format
+//! \param    [in] x
+//!           Horizontal origin in pixels
+//! \param    [in] y
+//!           Vertical origin in pixels
+//! \return   bool
+//!           true if the origin is valid
+//!
+bool DdiImageCopy_IsOriginAligned(DDI_IMAGE_COPY_FORMAT format, uint32_t x, uint32_t y);
+
+//!
+//! \brief    Move the planes of a frame to the pixel at (x, y)
+//! \param    [in, out] frame
+//!           Frame whose planes point at pixel (0, 0)
+//! \param    [in] x
+//!           Horizontal origin in pixels, see DdiImageCopy_IsOriginAligned
+//! \param    [in] y
+//!           Vertical origin in pixels, see DdiImageCopy_IsOriginAligned
+//! \return   void
+//!
+void DdiImageCopy_SetOrigin(PDDI_IMAGE_COPY_FRAME frame, uint32_t x, uint32_t y);
+
+//!
+//! \brief    Check if a conversion is supported
+//! \param    [in] srcFormat
+//!           Source format
+//! \param    [in] dstFormat
+//!           Destination format
+//! \return   bool
+//!           true if DdiImageCopy_CopyFrame can convert between the formats
+//!
+bool DdiImageCopy_IsSupported(DDI_IMAGE_COPY_FORMAT srcFormat, DDI_IMAGE_COPY_FORMAT dstFormat);
+
+//!
+//! \brief    Copy and convert a region
+//! \details  4:2:0 formats need an even width and height except for the last
+//!           column and row of the frame, packed 4:2:2 formats an even width.
+//! \param    [in] src
+//!           Source frame
+//! \param    [in] dst
+//!           Destination frame
+//! \param    [in] width
+//!           Region width in pixels
+//! \param    [in] height
+//!           Region height in pixels
+//! \param    [in] maxThreads
+//!           Upper bound of threads to use, 1 to stay on the calling thread
+//! \return   bool
+//!           true if success, false if the conversion or the frame is invalid
+//!
+bool DdiImageCopy_CopyFrame(
+    const DDI_IMAGE_COPY_FRAME  *src,
+    const DDI_IMAGE_COPY_FRAME  *dst,
+    uint32_t                    width,
+    uint32_t                    height,
+    uint32_t                    maxThreads);
+
+#endif // __MEDIA_LIBVA_IMAGE_COPY_H__
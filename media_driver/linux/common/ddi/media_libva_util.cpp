@@ -38,11 +38,13 @@
 #include "media_libva_util.h"
 #include "mos_utilities.h"
 #include "mos_os.h"
+#include "mos_lock_profile.h"
 #include "hwinfo_linux.h"
 #include "media_ddi_decode_base.h"
 #include "media_ddi_encode_base.h"
 #include "media_libva_decoder.h"
 #include "media_libva_encoder.h"
+#include "media_libva_vp.h"
 #include "media_libva_caps.h"
 
 #ifdef DEBUG
@@ -836,6 +838,11 @@ void* DdiMediaUtil_LockSurface(DDI_MEDIA_SURFACE  *surface, uint32_t flag)
 {
     DDI_CHK_NULL(surface, "nullptr surface", nullptr);
     DDI_CHK_NULL(surface->bo, "nullptr surface->bo", nullptr);
+
+    // The CPU would not wait for render jobs or decode pictures still held in a batch
+    DdiVp_SubmitPendingRender(surface);
+    DdiDecode_SubmitPendingPictures(surface);
+
     if((false == surface->bMapped) && (0 == surface->iRefCount))
     {
         if (surface->pMediaCtx->bIsAtomSOC)
@@ -1154,12 +1161,17 @@ VAStatus DdiMediaUtil_FillPositionToRect(RECT *rect, int16_t offset_x, int16_t o
 
 void DdiMediaUtil_InitMutex(PMEDIA_MUTEX_T  mutex)
 {
-    pthread_mutex_init(mutex, nullptr);
+    MosLockProfile_InitMutex(mutex, nullptr, false);
+}
+
+void DdiMediaUtil_InitNamedMutex(PMEDIA_MUTEX_T  mutex, const char *name, bool adaptiveSpin)
+{
+    MosLockProfile_InitMutex(mutex, name, adaptiveSpin);
 }
 
 void DdiMediaUtil_DestroyMutex(PMEDIA_MUTEX_T  mutex)
 {
-    int32_t ret = pthread_mutex_destroy(mutex);
+    int32_t ret = MosLockProfile_DestroyMutex(mutex);
     if(ret != 0)
     {
         DDI_NORMALMESSAGE("can't destroy the mutex!\n");
@@ -1168,7 +1180,7 @@ void DdiMediaUtil_DestroyMutex(PMEDIA_MUTEX_T  mutex)
 
 void DdiMediaUtil_LockMutex(PMEDIA_MUTEX_T  mutex)
 {
-    int32_t ret = pthread_mutex_lock(mutex);
+    int32_t ret = MosLockProfile_Lock(mutex);
     if(ret != 0)
     {
         DDI_NORMALMESSAGE("can't lock the mutex!\n");
@@ -1177,7 +1189,7 @@ void DdiMediaUtil_LockMutex(PMEDIA_MUTEX_T  mutex)
 
 void DdiMediaUtil_UnLockMutex(PMEDIA_MUTEX_T  mutex)
 {
-    int32_t ret = pthread_mutex_unlock(mutex);
+    int32_t ret = MosLockProfile_Unlock(mutex);
     if(ret != 0)
     {
         DDI_NORMALMESSAGE("can't unlock the mutex!\n");
@@ -129,6 +129,18 @@ void     DdiMediaUtil_FreeBuffer(DDI_MEDIA_BUFFER  *buf);
 //!
 void     DdiMediaUtil_InitMutex(PMEDIA_MUTEX_T  mutex);
 
+//!
+//! \brief  Init mutex under a site name of the lock profile
+//!
+//! \param  [in] mutex
+//!         Pointer to media mutex thread
+//! \param  [in] name
+//!         Static site name
+//! \param  [in] adaptiveSpin
+//!         Spin a while before sleeping when the mutex is locked, for short critical sections
+//!
+void     DdiMediaUtil_InitNamedMutex(PMEDIA_MUTEX_T  mutex, const char *name, bool adaptiveSpin);
+
 //!
 //! \brief  Destroy mutex
 //! 
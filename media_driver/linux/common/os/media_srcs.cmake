@@ -25,6 +25,10 @@ set(TMP_SOURCES_
     ${CMAKE_CURRENT_LIST_DIR}/hwinfo_linux.c
     ${CMAKE_CURRENT_LIST_DIR}/mos_context_specific.cpp
     ${CMAKE_CURRENT_LIST_DIR}/mos_graphicsresource_specific.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/mos_metrics_specific.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/mos_copy_specific.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/mos_lock_profile.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/mos_resource_recycler.cpp
     ${CMAKE_CURRENT_LIST_DIR}/mos_os_specific.c
     ${CMAKE_CURRENT_LIST_DIR}/mos_util_debug_specific.c
     ${CMAKE_CURRENT_LIST_DIR}/mos_util_devult_specific.cpp
@@ -47,6 +51,9 @@ set(TMP_HEADERS_
     ${CMAKE_CURRENT_LIST_DIR}/mos_commandbuffer_specific.h
     ${CMAKE_CURRENT_LIST_DIR}/mos_gpucontext_specific.h
     ${CMAKE_CURRENT_LIST_DIR}/mos_auxtable_mgr.h
+    ${CMAKE_CURRENT_LIST_DIR}/mos_vdbox_load.h
+    ${CMAKE_CURRENT_LIST_DIR}/mos_lock_profile.h
+    ${CMAKE_CURRENT_LIST_DIR}/mos_resource_recycler.h
 )
 
 if(${Media_Scalability_Supported} STREQUAL "yes")
@@ -0,0 +1,563 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_copy_specific.cpp
+//! \brief     Linux implementation of the CPU copy and fill routines
+//! \details   Only depends on libc and pthread so that it can be built into the ULT.
+//!
+
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <immintrin.h>
+#include "mos_copy.h"
+
+#define MOS_COPY_TARGET_SSE2        __attribute__((target("sse2")))
+#define MOS_COPY_TARGET_SSE4_1      __attribute__((target("sse4.1")))
+#define MOS_COPY_TARGET_AVX2        __attribute__((target("avx2")))
+#define MOS_COPY_TARGET_AVX512      __attribute__((target("avx512f")))
+
+//!
+//! \brief    Parallel chunks start on page boundaries of the destination
+//!
+#define MOS_COPY_CHUNK_ALIGN        4096
+
+typedef struct _MOS_COPY_KERNELS
+{
+    void (*pfnCopyToWC)(uint8_t *dst, const uint8_t *src, size_t bytes);
+    void (*pfnCopyFromWC)(uint8_t *dst, const uint8_t *src, size_t bytes);
+    void (*pfnFillWC)(uint8_t *dst, uint8_t value, size_t bytes);
+} MOS_COPY_KERNELS;
+
+typedef struct _MOS_COPY_BAND
+{
+    uint8_t         *dst;
+    const uint8_t   *src;
+    uint32_t        dstPitch;
+    uint32_t        srcPitch;
+    size_t          rowBytes;
+    uint32_t        rows;
+    MOS_COPY_MEMORY memory;
+} MOS_COPY_BAND;
+
+//!
+//! \brief    Bytes to copy before p is aligned to align
+//!
+static inline size_t MosCopy_GetHead(const void *p, size_t align, size_t bytes)
+{
+    size_t head = (align - ((uintptr_t)p & (align - 1))) & (align - 1);
+    return (head < bytes) ? head : bytes;
+}
+
+//------------------------------------------------------------------------------
+// C kernels
+//------------------------------------------------------------------------------
+static void MosCopy_CopyToWC_C(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    memcpy(dst, src, bytes);
+}
+
+static void MosCopy_FillWC_C(uint8_t *dst, uint8_t value, size_t bytes)
+{
+    memset(dst, value, bytes);
+}
+
+//------------------------------------------------------------------------------
+// SSE2 kernels: movntdq stores, WC reads stay plain loads
+//------------------------------------------------------------------------------
+static MOS_COPY_TARGET_SSE2 void MosCopy_CopyToWC_SSE2(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(dst, 16, bytes);
+    memcpy(dst, src, head);
+    dst   += head;
+    src   += head;
+    bytes -= head;
+
+    // Four stores of a line in flight keep the WC buffers busy
+    for (; bytes >= 64; bytes -= 64, dst += 64, src += 64)
+    {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)src);
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(src + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i *)(src + 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i *)(src + 48));
+        _mm_stream_si128((__m128i *)dst,        v0);
+        _mm_stream_si128((__m128i *)(dst + 16), v1);
+        _mm_stream_si128((__m128i *)(dst + 32), v2);
+        _mm_stream_si128((__m128i *)(dst + 48), v3);
+    }
+    for (; bytes >= 16; bytes -= 16, dst += 16, src += 16)
+    {
+        _mm_stream_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+    }
+    memcpy(dst, src, bytes);
+}
+
+static MOS_COPY_TARGET_SSE2 void MosCopy_FillWC_SSE2(uint8_t *dst, uint8_t value, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(dst, 16, bytes);
+    memset(dst, value, head);
+    dst   += head;
+    bytes -= head;
+
+    __m128i v = _mm_set1_epi8((char)value);
+    for (; bytes >= 16; bytes -= 16, dst += 16)
+    {
+        _mm_stream_si128((__m128i *)dst, v);
+    }
+    memset(dst, value, bytes);
+}
+
+//------------------------------------------------------------------------------
+// SSE4.1 kernels: movntdqa loads
+//------------------------------------------------------------------------------
+static MOS_COPY_TARGET_SSE4_1 void MosCopy_CopyFromWC_SSE4_1(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(src, 16, bytes);
+    memcpy(dst, src, head);
+    dst   += head;
+    src   += head;
+    bytes -= head;
+
+    // Streaming loads are not ordered with the stores before them
+    _mm_mfence();
+
+    for (; bytes >= 64; bytes -= 64, dst += 64, src += 64)
+    {
+        __m128i v0 = _mm_stream_load_si128((__m128i *)src);
+        __m128i v1 = _mm_stream_load_si128((__m128i *)(src + 16));
+        __m128i v2 = _mm_stream_load_si128((__m128i *)(src + 32));
+        __m128i v3 = _mm_stream_load_si128((__m128i *)(src + 48));
+        _mm_storeu_si128((__m128i *)dst,        v0);
+        _mm_storeu_si128((__m128i *)(dst + 16), v1);
+        _mm_storeu_si128((__m128i *)(dst + 32), v2);
+        _mm_storeu_si128((__m128i *)(dst + 48), v3);
+    }
+    for (; bytes >= 16; bytes -= 16, dst += 16, src += 16)
+    {
+        _mm_storeu_si128((__m128i *)dst, _mm_stream_load_si128((__m128i *)src));
+    }
+    memcpy(dst, src, bytes);
+}
+
+//------------------------------------------------------------------------------
+// AVX2 kernels
+//------------------------------------------------------------------------------
+static MOS_COPY_TARGET_AVX2 void MosCopy_CopyToWC_AVX2(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(dst, 32, bytes);
+    memcpy(dst, src, head);
+    dst   += head;
+    src   += head;
+    bytes -= head;
+
+    for (; bytes >= 128; bytes -= 128, dst += 128, src += 128)
+    {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)src);
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(src + 32));
+        __m256i v2 = _mm256_loadu_si256((const __m256i *)(src + 64));
+        __m256i v3 = _mm256_loadu_si256((const __m256i *)(src + 96));
+        _mm256_stream_si256((__m256i *)dst,        v0);
+        _mm256_stream_si256((__m256i *)(dst + 32), v1);
+        _mm256_stream_si256((__m256i *)(dst + 64), v2);
+        _mm256_stream_si256((__m256i *)(dst + 96), v3);
+    }
+    for (; bytes >= 32; bytes -= 32, dst += 32, src += 32)
+    {
+        _mm256_stream_si256((__m256i *)dst, _mm256_loadu_si256((const __m256i *)src));
+    }
+    memcpy(dst, src, bytes);
+}
+
+static MOS_COPY_TARGET_AVX2 void MosCopy_CopyFromWC_AVX2(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(src, 32, bytes);
+    memcpy(dst, src, head);
+    dst   += head;
+    src   += head;
+    bytes -= head;
+
+    _mm_mfence();
+
+    for (; bytes >= 128; bytes -= 128, dst += 128, src += 128)
+    {
+        __m256i v0 = _mm256_stream_load_si256((__m256i *)src);
+        __m256i v1 = _mm256_stream_load_si256((__m256i *)(src + 32));
+        __m256i v2 = _mm256_stream_load_si256((__m256i *)(src + 64));
+        __m256i v3 = _mm256_stream_load_si256((__m256i *)(src + 96));
+        _mm256_storeu_si256((__m256i *)dst,        v0);
+        _mm256_storeu_si256((__m256i *)(dst + 32), v1);
+        _mm256_storeu_si256((__m256i *)(dst + 64), v2);
+        _mm256_storeu_si256((__m256i *)(dst + 96), v3);
+    }
+    for (; bytes >= 32; bytes -= 32, dst += 32, src += 32)
+    {
+        _mm256_storeu_si256((__m256i *)dst, _mm256_stream_load_si256((__m256i *)src));
+    }
+    memcpy(dst, src, bytes);
+}
+
+static MOS_COPY_TARGET_AVX2 void MosCopy_FillWC_AVX2(uint8_t *dst, uint8_t value, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(dst, 32, bytes);
+    memset(dst, value, head);
+    dst   += head;
+    bytes -= head;
+
+    __m256i v = _mm256_set1_epi8((char)value);
+    for (; bytes >= 32; bytes -= 32, dst += 32)
+    {
+        _mm256_stream_si256((__m256i *)dst, v);
+    }
+    memset(dst, value, bytes);
+}
+
+//------------------------------------------------------------------------------
+// AVX-512 kernels, one store per cache line
+//------------------------------------------------------------------------------
+static MOS_COPY_TARGET_AVX512 void MosCopy_CopyToWC_AVX512(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(dst, 64, bytes);
+    memcpy(dst, src, head);
+    dst   += head;
+    src   += head;
+    bytes -= head;
+
+    for (; bytes >= 256; bytes -= 256, dst += 256, src += 256)
+    {
+        __m512i v0 = _mm512_loadu_si512((const void *)src);
+        __m512i v1 = _mm512_loadu_si512((const void *)(src + 64));
+        __m512i v2 = _mm512_loadu_si512((const void *)(src + 128));
+        __m512i v3 = _mm512_loadu_si512((const void *)(src + 192));
+        _mm512_stream_si512((__m512i *)dst,         v0);
+        _mm512_stream_si512((__m512i *)(dst + 64),  v1);
+        _mm512_stream_si512((__m512i *)(dst + 128), v2);
+        _mm512_stream_si512((__m512i *)(dst + 192), v3);
+    }
+    for (; bytes >= 64; bytes -= 64, dst += 64, src += 64)
+    {
+        _mm512_stream_si512((__m512i *)dst, _mm512_loadu_si512((const void *)src));
+    }
+    memcpy(dst, src, bytes);
+}
+
+static MOS_COPY_TARGET_AVX512 void MosCopy_CopyFromWC_AVX512(uint8_t *dst, const uint8_t *src, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(src, 64, bytes);
+    memcpy(dst, src, head);
+    dst   += head;
+    src   += head;
+    bytes -= head;
+
+    _mm_mfence();
+
+    for (; bytes >= 256; bytes -= 256, dst += 256, src += 256)
+    {
+        __m512i v0 = _mm512_stream_load_si512((void *)src);
+        __m512i v1 = _mm512_stream_load_si512((void *)(src + 64));
+        __m512i v2 = _mm512_stream_load_si512((void *)(src + 128));
+        __m512i v3 = _mm512_stream_load_si512((void *)(src + 192));
+        _mm512_storeu_si512((void *)dst,         v0);
+        _mm512_storeu_si512((void *)(dst + 64),  v1);
+        _mm512_storeu_si512((void *)(dst + 128), v2);
+        _mm512_storeu_si512((void *)(dst + 192), v3);
+    }
+    for (; bytes >= 64; bytes -= 64, dst += 64, src += 64)
+    {
+        _mm512_storeu_si512((void *)dst, _mm512_stream_load_si512((void *)src));
+    }
+    memcpy(dst, src, bytes);
+}
+
+static MOS_COPY_TARGET_AVX512 void MosCopy_FillWC_AVX512(uint8_t *dst, uint8_t value, size_t bytes)
+{
+    size_t head = MosCopy_GetHead(dst, 64, bytes);
+    memset(dst, value, head);
+    dst   += head;
+    bytes -= head;
+
+    __m512i v = _mm512_set1_epi8((char)value);
+    for (; bytes >= 64; bytes -= 64, dst += 64)
+    {
+        _mm512_stream_si512((__m512i *)dst, v);
+    }
+    memset(dst, value, bytes);
+}
+
+static const MOS_COPY_KERNELS g_mosCopyKernels[MOS_COPY_ISA_NUM] =
+{
+    { MosCopy_CopyToWC_C,      MosCopy_CopyToWC_C,        MosCopy_FillWC_C      },
+    { MosCopy_CopyToWC_SSE2,   MosCopy_CopyToWC_C,        MosCopy_FillWC_SSE2   },
+    { MosCopy_CopyToWC_SSE2,   MosCopy_CopyFromWC_SSE4_1, MosCopy_FillWC_SSE2   },
+    { MosCopy_CopyToWC_AVX2,   MosCopy_CopyFromWC_AVX2,   MosCopy_FillWC_AVX2   },
+    { MosCopy_CopyToWC_AVX512, MosCopy_CopyFromWC_AVX512, MosCopy_FillWC_AVX512 },
+};
+
+static const char * const g_mosCopyIsaNames[MOS_COPY_ISA_NUM] =
+{
+    "C",
+    "SSE2",
+    "SSE4.1",
+    "AVX2",
+    "AVX-512",
+};
+
+static int32_t s_mosCopyIsa = -1;
+
+static bool MosCopy_IsSupported(MOS_COPY_ISA isa)
+{
+    switch (isa)
+    {
+        case MOS_COPY_ISA_C:
+            return true;
+        case MOS_COPY_ISA_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case MOS_COPY_ISA_SSE4_1:
+            return __builtin_cpu_supports("sse4.1");
+        case MOS_COPY_ISA_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case MOS_COPY_ISA_AVX512:
+            return __builtin_cpu_supports("avx512f");
+        default:
+            return false;
+    }
+}
+
+MOS_COPY_ISA MosCopy_GetIsa()
+{
+    int32_t isa = __atomic_load_n(&s_mosCopyIsa, __ATOMIC_RELAXED);
+    if (isa < 0)
+    {
+        // Threads racing here all store the same value
+        isa = MOS_COPY_ISA_NUM - 1;
+        while (!MosCopy_IsSupported((MOS_COPY_ISA)isa))
+        {
+            isa--;
+        }
+        __atomic_store_n(&s_mosCopyIsa, isa, __ATOMIC_RELAXED);
+    }
+    return (MOS_COPY_ISA)isa;
+}
+
+bool MosCopy_SetIsa(MOS_COPY_ISA isa)
+{
+    if (isa < MOS_COPY_ISA_C || isa >= MOS_COPY_ISA_NUM || !MosCopy_IsSupported(isa))
+    {
+        return false;
+    }
+    __atomic_store_n(&s_mosCopyIsa, (int32_t)isa, __ATOMIC_RELAXED);
+    return true;
+}
+
+const char *MosCopy_GetIsaName(MOS_COPY_ISA isa)
+{
+    return (isa >= MOS_COPY_ISA_C && isa < MOS_COPY_ISA_NUM) ? g_mosCopyIsaNames[isa] : "Unknown";
+}
+
+//------------------------------------------------------------------------------
+// Linear, 2D and parallel copies
+//------------------------------------------------------------------------------
+static void MosCopy_CopyLinear(uint8_t *dst, const uint8_t *src, size_t bytes, MOS_COPY_MEMORY memory)
+{
+    const MOS_COPY_KERNELS *kernels = &g_mosCopyKernels[MosCopy_GetIsa()];
+
+    switch (memory)
+    {
+        case MOS_COPY_MEMORY_TO_WC:
+            kernels->pfnCopyToWC(dst, src, bytes);
+            break;
+        case MOS_COPY_MEMORY_FROM_WC:
+            kernels->pfnCopyFromWC(dst, src, bytes);
+            break;
+        default:
+            memcpy(dst, src, bytes);
+            break;
+    }
+}
+
+static void MosCopy_RunBand(const MOS_COPY_BAND *band)
+{
+    uint8_t       *dst = band->dst;
+    const uint8_t *src = band->src;
+
+    for (uint32_t y = 0; y < band->rows; y++, dst += band->dstPitch, src += band->srcPitch)
+    {
+        MosCopy_CopyLinear(dst, src, band->rowBytes, band->memory);
+    }
+
+    // Drain the streaming stores before the caller unlocks the destination
+    _mm_sfence();
+}
+
+static void *MosCopy_BandThread(void *arg)
+{
+    MosCopy_RunBand((const MOS_COPY_BAND *)arg);
+    return nullptr;
+}
+
+static uint32_t MosCopy_GetThreadNum(uint64_t bytes, uint32_t maxThreads)
+{
+    if (bytes < MOS_COPY_PARALLEL_THRESHOLD || maxThreads <= 1)
+    {
+        return 1;
+    }
+
+    long     cpuNum    = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threadNum = (maxThreads < MOS_COPY_MAX_THREADS) ? maxThreads : MOS_COPY_MAX_THREADS;
+    return (cpuNum > 0 && (uint32_t)cpuNum < threadNum) ? (uint32_t)cpuNum : threadNum;
+}
+
+//!
+//! \brief    Run the bands, the first one on the calling thread
+//! \details  A band whose thread could not be created runs inline as well.
+//!
+static void MosCopy_RunBands(const MOS_COPY_BAND *bands, uint32_t bandNum)
+{
+    pthread_t threads[MOS_COPY_MAX_THREADS];
+    bool      started[MOS_COPY_MAX_THREADS] = {};
+
+    for (uint32_t i = 1; i < bandNum; i++)
+    {
+        started[i] = (pthread_create(&threads[i], nullptr, MosCopy_BandThread, (void *)&bands[i]) == 0);
+    }
+
+    MosCopy_RunBand(&bands[0]);
+
+    for (uint32_t i = 1; i < bandNum; i++)
+    {
+        if (started[i])
+        {
+            pthread_join(threads[i], nullptr);
+        }
+        else
+        {
+            MosCopy_RunBand(&bands[i]);
+        }
+    }
+}
+
+void MosCopy_Copy(void *dst, const void *src, size_t bytes, MOS_COPY_MEMORY memory)
+{
+    if (dst == nullptr || src == nullptr || bytes == 0)
+    {
+        return;
+    }
+
+    MosCopy_CopyLinear((uint8_t *)dst, (const uint8_t *)src, bytes, memory);
+    if (memory == MOS_COPY_MEMORY_TO_WC)
+    {
+        _mm_sfence();
+    }
+}
+
+void MosCopy_CopyParallel(void *dst, const void *src, size_t bytes, MOS_COPY_MEMORY memory, uint32_t maxThreads)
+{
+    if (dst == nullptr || src == nullptr || bytes == 0)
+    {
+        return;
+    }
+
+    uint32_t threadNum = MosCopy_GetThreadNum(bytes, maxThreads);
+    if (threadNum == 1)
+    {
+        MosCopy_Copy(dst, src, bytes, memory);
+        return;
+    }
+
+    size_t chunk = (bytes + threadNum - 1) / threadNum;
+    chunk        = (chunk + MOS_COPY_CHUNK_ALIGN - 1) & ~((size_t)MOS_COPY_CHUNK_ALIGN - 1);
+
+    MOS_COPY_BAND bands[MOS_COPY_MAX_THREADS];
+    uint32_t      bandNum = 0;
+
+    for (size_t offset = 0; offset < bytes && bandNum < threadNum; offset += chunk, bandNum++)
+    {
+        bands[bandNum].dst      = (uint8_t *)dst + offset;
+        bands[bandNum].src      = (const uint8_t *)src + offset;
+        bands[bandNum].dstPitch = 0;
+        bands[bandNum].srcPitch = 0;
+        bands[bandNum].rowBytes = (offset + chunk < bytes) ? chunk : bytes - offset;
+        bands[bandNum].rows     = 1;
+        bands[bandNum].memory   = memory;
+    }
+
+    MosCopy_RunBands(bands, bandNum);
+}
+
+void MosCopy_Copy2D(
+    void            *dst,
+    uint32_t        dstPitch,
+    const void      *src,
+    uint32_t        srcPitch,
+    uint32_t        rowBytes,
+    uint32_t        rows,
+    MOS_COPY_MEMORY memory,
+    uint32_t        maxThreads)
+{
+    if (dst == nullptr || src == nullptr || rowBytes == 0 || rows == 0)
+    {
+        return;
+    }
+
+    // Contiguous rows are one linear copy
+    if (rowBytes == dstPitch && rowBytes == srcPitch)
+    {
+        MosCopy_CopyParallel(dst, src, (size_t)rowBytes * rows, memory, maxThreads);
+        return;
+    }
+
+    uint32_t threadNum = MosCopy_GetThreadNum((uint64_t)rowBytes * rows, maxThreads);
+    uint32_t bandRows  = (rows + threadNum - 1) / threadNum;
+
+    MOS_COPY_BAND bands[MOS_COPY_MAX_THREADS];
+    uint32_t      bandNum = 0;
+
+    for (uint32_t row = 0; row < rows && bandNum < threadNum; row += bandRows, bandNum++)
+    {
+        bands[bandNum].dst      = (uint8_t *)dst + (size_t)row * dstPitch;
+        bands[bandNum].src      = (const uint8_t *)src + (size_t)row * srcPitch;
+        bands[bandNum].dstPitch = dstPitch;
+        bands[bandNum].srcPitch = srcPitch;
+        bands[bandNum].rowBytes = rowBytes;
+        bands[bandNum].rows     = (row + bandRows < rows) ? bandRows : rows - row;
+        bands[bandNum].memory   = memory;
+    }
+
+    MosCopy_RunBands(bands, bandNum);
+}
+
+void MosCopy_Fill(void *dst, uint8_t value, size_t bytes, bool dstWC)
+{
+    if (dst == nullptr || bytes == 0)
+    {
+        return;
+    }
+
+    if (dstWC)
+    {
+        g_mosCopyKernels[MosCopy_GetIsa()].pfnFillWC((uint8_t *)dst, value, bytes);
+        _mm_sfence();
+    }
+    else
+    {
+        memset(dst, value, bytes);
+    }
+}
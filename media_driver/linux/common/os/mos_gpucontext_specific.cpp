@@ -608,6 +608,8 @@ MOS_STATUS GpuContextSpecific::SubmitCommandBuffer(
             {
                 execFlag = I915_EXEC_BSD | I915_EXEC_BSD_RING2;
             }
+
+            Mos_Specific_ChargeVdboxLoad(osInterface, execFlag);
         }
 	else
 	{
@@ -0,0 +1,542 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_lock_profile.cpp
+//! \brief     Contention profile of the driver mutexes
+//!
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "mos_lock_profile.h"
+
+#define MOS_LOCK_PROFILE_MUTEX_TOMBSTONE    ((const void *)1)
+#define MOS_LOCK_PROFILE_TOMBSTONE_MAX      (MOS_LOCK_PROFILE_MUTEX_MAX / 8)    //!< Tombstones that trigger a rehash
+
+typedef struct _MOS_LOCK_SITE_COUNTERS
+{
+    uint64_t    acquisitions;
+    uint64_t    contended;
+    uint64_t    waitNs;
+    uint64_t    maxWaitNs;
+    uint64_t    holdNs;
+    uint64_t    maxHoldNs;
+} __attribute__((aligned(64))) MOS_LOCK_SITE_COUNTERS;
+
+typedef struct _MOS_LOCK_PROFILE_SHARD
+{
+    MOS_LOCK_SITE_COUNTERS  site[MOS_LOCK_PROFILE_SITE_MAX];
+} MOS_LOCK_PROFILE_SHARD;
+
+//!
+//! \brief    Slot of the open addressed table from mutex to site
+//! \details  The site is written before the mutex, so lookups need no lock.
+//!           Destroyed mutexes leave tombstones so that probing chains stay
+//!           intact. Past MOS_LOCK_PROFILE_TOMBSTONE_MAX the table is rehashed,
+//!           lookups retry when they overlap a rehash.
+//!
+typedef struct _MOS_LOCK_PROFILE_MUTEX
+{
+    const void  *mutex;
+    uint32_t    site;
+} MOS_LOCK_PROFILE_MUTEX;
+
+typedef struct _MOS_LOCK_PROFILE_HELD
+{
+    const void  *mutex;
+    uint32_t    site;
+    uint64_t    acquiredNs;
+} MOS_LOCK_PROFILE_HELD;
+
+static bool                     s_enabled       = false;
+static MOS_LOCK_PROFILE_SHARD   s_shards[MOS_LOCK_PROFILE_SHARD_NUM];
+static uint32_t                 s_nextShard     = 0;
+static __thread int32_t         t_shard         = -1;
+
+static pthread_mutex_t          s_registryMutex = PTHREAD_MUTEX_INITIALIZER;
+static char                     s_siteNames[MOS_LOCK_PROFILE_SITE_MAX][MOS_LOCK_PROFILE_NAME_LEN] = { "Unnamed" };
+static uint32_t                 s_siteNum       = 1;
+static MOS_LOCK_PROFILE_MUTEX   s_mutexes[MOS_LOCK_PROFILE_MUTEX_MAX];
+static uint32_t                 s_tombstoneNum  = 0;
+static uint32_t                 s_mutexesSeq    = 0;    //!< Odd while the table is rehashed
+
+static __thread MOS_LOCK_PROFILE_HELD   t_held[MOS_LOCK_PROFILE_HELD_MAX];
+static __thread uint32_t                t_heldNum = 0;
+
+static inline uint64_t MosLockProfile_GetTimeNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static inline uint32_t MosLockProfile_Hash(const void *mutex)
+{
+    return (uint32_t)((((uintptr_t)mutex >> 3) * 0x9e3779b97f4a7c15ull) >> 32) % MOS_LOCK_PROFILE_MUTEX_MAX;
+}
+
+static inline MOS_LOCK_SITE_COUNTERS *MosLockProfile_GetCounters(uint32_t site)
+{
+    if (t_shard < 0)
+    {
+        t_shard = (int32_t)(__atomic_fetch_add(&s_nextShard, 1, __ATOMIC_RELAXED) % MOS_LOCK_PROFILE_SHARD_NUM);
+    }
+    return &s_shards[t_shard].site[site];
+}
+
+static inline void MosLockProfile_Max(uint64_t *max, uint64_t value)
+{
+    uint64_t old = __atomic_load_n(max, __ATOMIC_RELAXED);
+    while (value > old &&
+           !__atomic_compare_exchange_n(max, &old, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+//!
+//! \brief    Probe the table for the site of a mutex, 0 if it has no name
+//!
+static uint32_t MosLockProfile_ProbeSite(const void *mutex)
+{
+    uint32_t slot = MosLockProfile_Hash(mutex);
+    for (uint32_t i = 0; i < MOS_LOCK_PROFILE_MUTEX_MAX; i++, slot = (slot + 1) % MOS_LOCK_PROFILE_MUTEX_MAX)
+    {
+        const void *key = __atomic_load_n(&s_mutexes[slot].mutex, __ATOMIC_ACQUIRE);
+        if (key == mutex)
+        {
+            return __atomic_load_n(&s_mutexes[slot].site, __ATOMIC_RELAXED);
+        }
+        if (key == nullptr)
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+//!
+//! \brief    Get the site of a mutex, 0 if it has no name
+//!
+static uint32_t MosLockProfile_FindSite(const void *mutex)
+{
+    uint32_t seq, site;
+    do
+    {
+        seq  = __atomic_load_n(&s_mutexesSeq, __ATOMIC_ACQUIRE);
+        site = MosLockProfile_ProbeSite(mutex);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&s_mutexesSeq, __ATOMIC_RELAXED));
+    return site;
+}
+
+//!
+//! \brief    Rebuild the table without its tombstones
+//! \details  Called with the registry mutex held.
+//!
+static void MosLockProfile_Rehash()
+{
+    static MOS_LOCK_PROFILE_MUTEX live[MOS_LOCK_PROFILE_MUTEX_MAX];
+    uint32_t                      liveNum = 0;
+
+    for (uint32_t slot = 0; slot < MOS_LOCK_PROFILE_MUTEX_MAX; slot++)
+    {
+        const void *key = s_mutexes[slot].mutex;
+        if (key != nullptr && key != MOS_LOCK_PROFILE_MUTEX_TOMBSTONE)
+        {
+            live[liveNum++] = s_mutexes[slot];
+        }
+    }
+
+    __atomic_store_n(&s_mutexesSeq, s_mutexesSeq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (uint32_t slot = 0; slot < MOS_LOCK_PROFILE_MUTEX_MAX; slot++)
+    {
+        __atomic_store_n(&s_mutexes[slot].mutex, (const void *)nullptr, __ATOMIC_RELAXED);
+    }
+    for (uint32_t i = 0; i < liveNum; i++)
+    {
+        uint32_t slot = MosLockProfile_Hash(live[i].mutex);
+        while (s_mutexes[slot].mutex != nullptr)
+        {
+            slot = (slot + 1) % MOS_LOCK_PROFILE_MUTEX_MAX;
+        }
+        __atomic_store_n(&s_mutexes[slot].site, live[i].site, __ATOMIC_RELAXED);
+        __atomic_store_n(&s_mutexes[slot].mutex, live[i].mutex, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&s_mutexesSeq, s_mutexesSeq + 1, __ATOMIC_RELEASE);
+    s_tombstoneNum = 0;
+}
+
+//!
+//! \brief    Get the site of a name, adding it if there is room
+//! \details  Called with the registry mutex held.
+//!
+static uint32_t MosLockProfile_GetSite(const char *name)
+{
+    for (uint32_t site = 1; site < s_siteNum; site++)
+    {
+        if (strncmp(s_siteNames[site], name, MOS_LOCK_PROFILE_NAME_LEN - 1) == 0)
+        {
+            return site;
+        }
+    }
+    if (s_siteNum == MOS_LOCK_PROFILE_SITE_MAX)
+    {
+        return 0;
+    }
+    strncpy(s_siteNames[s_siteNum], name, MOS_LOCK_PROFILE_NAME_LEN - 1);
+    return s_siteNum++;
+}
+
+void MosLockProfile_NameMutex(const pthread_mutex_t *mutex, const char *name)
+{
+    if (mutex == nullptr || name == nullptr)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_registryMutex);
+
+    uint32_t site     = MosLockProfile_GetSite(name);
+    int32_t  freeSlot = -1;
+    uint32_t slot     = MosLockProfile_Hash(mutex);
+    for (uint32_t i = 0; i < MOS_LOCK_PROFILE_MUTEX_MAX; i++, slot = (slot + 1) % MOS_LOCK_PROFILE_MUTEX_MAX)
+    {
+        const void *key = s_mutexes[slot].mutex;
+        if (key == mutex)
+        {
+            __atomic_store_n(&s_mutexes[slot].site, site, __ATOMIC_RELAXED);
+            goto finish;
+        }
+        if (freeSlot < 0 && (key == nullptr || key == MOS_LOCK_PROFILE_MUTEX_TOMBSTONE))
+        {
+            freeSlot = (int32_t)slot;
+        }
+        if (key == nullptr)
+        {
+            break;
+        }
+    }
+
+    // A full table leaves the mutex unnamed
+    if (freeSlot >= 0)
+    {
+        if (s_mutexes[freeSlot].mutex == MOS_LOCK_PROFILE_MUTEX_TOMBSTONE)
+        {
+            s_tombstoneNum--;
+        }
+        __atomic_store_n(&s_mutexes[freeSlot].site, site, __ATOMIC_RELAXED);
+        __atomic_store_n(&s_mutexes[freeSlot].mutex, (const void *)mutex, __ATOMIC_RELEASE);
+    }
+
+finish:
+    pthread_mutex_unlock(&s_registryMutex);
+}
+
+void MosLockProfile_ForgetMutex(const pthread_mutex_t *mutex)
+{
+    if (mutex == nullptr)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&s_registryMutex);
+
+    uint32_t slot = MosLockProfile_Hash(mutex);
+    for (uint32_t i = 0; i < MOS_LOCK_PROFILE_MUTEX_MAX; i++, slot = (slot + 1) % MOS_LOCK_PROFILE_MUTEX_MAX)
+    {
+        const void *key = s_mutexes[slot].mutex;
+        if (key == mutex)
+        {
+            if (s_mutexes[(slot + 1) % MOS_LOCK_PROFILE_MUTEX_MAX].mutex != nullptr)
+            {
+                // Keep probing chains that run through the slot intact
+                __atomic_store_n(&s_mutexes[slot].mutex, MOS_LOCK_PROFILE_MUTEX_TOMBSTONE, __ATOMIC_RELEASE);
+                s_tombstoneNum++;
+                break;
+            }
+
+            // The slot ends its chain, so do the tombstones right before it
+            __atomic_store_n(&s_mutexes[slot].mutex, (const void *)nullptr, __ATOMIC_RELEASE);
+            for (slot = (slot + MOS_LOCK_PROFILE_MUTEX_MAX - 1) % MOS_LOCK_PROFILE_MUTEX_MAX;
+                 s_mutexes[slot].mutex == MOS_LOCK_PROFILE_MUTEX_TOMBSTONE;
+                 slot = (slot + MOS_LOCK_PROFILE_MUTEX_MAX - 1) % MOS_LOCK_PROFILE_MUTEX_MAX)
+            {
+                __atomic_store_n(&s_mutexes[slot].mutex, (const void *)nullptr, __ATOMIC_RELEASE);
+                s_tombstoneNum--;
+            }
+            break;
+        }
+        if (key == nullptr)
+        {
+            break;
+        }
+    }
+
+    if (s_tombstoneNum > MOS_LOCK_PROFILE_TOMBSTONE_MAX)
+    {
+        MosLockProfile_Rehash();
+    }
+
+    pthread_mutex_unlock(&s_registryMutex);
+}
+
+int32_t MosLockProfile_InitMutex(pthread_mutex_t *mutex, const char *name, bool adaptiveSpin)
+{
+    int32_t ret = 0;
+
+#ifdef PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP
+    if (adaptiveSpin)
+    {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+        ret = pthread_mutex_init(mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+    else
+#endif
+    {
+        ret = pthread_mutex_init(mutex, nullptr);
+    }
+
+    if (ret == 0)
+    {
+        MosLockProfile_NameMutex(mutex, name);
+    }
+    return ret;
+}
+
+int32_t MosLockProfile_DestroyMutex(pthread_mutex_t *mutex)
+{
+    MosLockProfile_ForgetMutex(mutex);
+    return pthread_mutex_destroy(mutex);
+}
+
+int32_t MosLockProfile_Lock(pthread_mutex_t *mutex)
+{
+    if (!__atomic_load_n(&s_enabled, __ATOMIC_RELAXED))
+    {
+        return pthread_mutex_lock(mutex);
+    }
+
+    uint32_t site       = MosLockProfile_FindSite(mutex);
+    uint64_t waitNs     = 0;
+    uint64_t acquiredNs = 0;
+    bool     contended  = false;
+
+    int32_t ret = pthread_mutex_trylock(mutex);
+    if (ret == EBUSY)
+    {
+        uint64_t startNs = MosLockProfile_GetTimeNs();
+        ret        = pthread_mutex_lock(mutex);
+        acquiredNs = MosLockProfile_GetTimeNs();
+        waitNs     = acquiredNs - startNs;
+        contended  = true;
+    }
+    else
+    {
+        acquiredNs = MosLockProfile_GetTimeNs();
+    }
+
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    MOS_LOCK_SITE_COUNTERS *counters = MosLockProfile_GetCounters(site);
+    __atomic_fetch_add(&counters->acquisitions, 1, __ATOMIC_RELAXED);
+    if (contended)
+    {
+        __atomic_fetch_add(&counters->contended, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&counters->waitNs, waitNs, __ATOMIC_RELAXED);
+        MosLockProfile_Max(&counters->maxWaitNs, waitNs);
+    }
+
+    if (t_heldNum < MOS_LOCK_PROFILE_HELD_MAX)
+    {
+        t_held[t_heldNum].mutex      = mutex;
+        t_held[t_heldNum].site       = site;
+        t_held[t_heldNum].acquiredNs = acquiredNs;
+        t_heldNum++;
+    }
+    return 0;
+}
+
+int32_t MosLockProfile_Unlock(pthread_mutex_t *mutex)
+{
+    // Held entries exist only for mutexes locked with profiling on; the
+    // unlock is counted even if profiling was turned off meanwhile.
+    for (int32_t i = (int32_t)t_heldNum - 1; i >= 0; i--)
+    {
+        if (t_held[i].mutex == mutex)
+        {
+            uint64_t holdNs = MosLockProfile_GetTimeNs() - t_held[i].acquiredNs;
+
+            MOS_LOCK_SITE_COUNTERS *counters = MosLockProfile_GetCounters(t_held[i].site);
+            __atomic_fetch_add(&counters->holdNs, holdNs, __ATOMIC_RELAXED);
+            MosLockProfile_Max(&counters->maxHoldNs, holdNs);
+
+            // Mutexes are not always released in reverse order
+            for (uint32_t j = (uint32_t)i + 1; j < t_heldNum; j++)
+            {
+                t_held[j - 1] = t_held[j];
+            }
+            t_heldNum--;
+            break;
+        }
+    }
+
+    return pthread_mutex_unlock(mutex);
+}
+
+void MosLockProfile_Enable(bool enable)
+{
+    __atomic_store_n(&s_enabled, enable, __ATOMIC_RELAXED);
+}
+
+bool MosLockProfile_IsEnabled()
+{
+    return __atomic_load_n(&s_enabled, __ATOMIC_RELAXED);
+}
+
+void MosLockProfile_Reset()
+{
+    for (uint32_t s = 0; s < MOS_LOCK_PROFILE_SHARD_NUM; s++)
+    {
+        for (uint32_t site = 0; site < MOS_LOCK_PROFILE_SITE_MAX; site++)
+        {
+            MOS_LOCK_SITE_COUNTERS *counters = &s_shards[s].site[site];
+            __atomic_store_n(&counters->acquisitions, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&counters->contended,    0, __ATOMIC_RELAXED);
+            __atomic_store_n(&counters->waitNs,       0, __ATOMIC_RELAXED);
+            __atomic_store_n(&counters->maxWaitNs,    0, __ATOMIC_RELAXED);
+            __atomic_store_n(&counters->holdNs,       0, __ATOMIC_RELAXED);
+            __atomic_store_n(&counters->maxHoldNs,    0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+uint32_t MosLockProfile_GetStats(PMOS_LOCK_SITE_STATS stats, uint32_t maxSites)
+{
+    uint32_t statNum = 0;
+
+    pthread_mutex_lock(&s_registryMutex);
+
+    for (uint32_t site = 0; site < s_siteNum && statNum < maxSites; site++)
+    {
+        MOS_LOCK_SITE_STATS total;
+        memset(&total, 0, sizeof(total));
+        memcpy(total.name, s_siteNames[site], MOS_LOCK_PROFILE_NAME_LEN);
+
+        for (uint32_t s = 0; s < MOS_LOCK_PROFILE_SHARD_NUM; s++)
+        {
+            const MOS_LOCK_SITE_COUNTERS *counters = &s_shards[s].site[site];
+            uint64_t maxWaitNs = __atomic_load_n(&counters->maxWaitNs, __ATOMIC_RELAXED);
+            uint64_t maxHoldNs = __atomic_load_n(&counters->maxHoldNs, __ATOMIC_RELAXED);
+
+            total.acquisitions += __atomic_load_n(&counters->acquisitions, __ATOMIC_RELAXED);
+            total.contended    += __atomic_load_n(&counters->contended, __ATOMIC_RELAXED);
+            total.waitNs       += __atomic_load_n(&counters->waitNs, __ATOMIC_RELAXED);
+            total.holdNs       += __atomic_load_n(&counters->holdNs, __ATOMIC_RELAXED);
+            total.maxWaitNs     = (maxWaitNs > total.maxWaitNs) ? maxWaitNs : total.maxWaitNs;
+            total.maxHoldNs     = (maxHoldNs > total.maxHoldNs) ? maxHoldNs : total.maxHoldNs;
+        }
+
+        if (total.acquisitions > 0)
+        {
+            stats[statNum++] = total;
+        }
+    }
+
+    pthread_mutex_unlock(&s_registryMutex);
+    return statNum;
+}
+
+void MosLockProfile_Report(FILE *fp)
+{
+    MOS_LOCK_SITE_STATS stats[MOS_LOCK_PROFILE_SITE_MAX];
+    uint32_t            statNum = MosLockProfile_GetStats(stats, MOS_LOCK_PROFILE_SITE_MAX);
+
+    // Insertion sort by total wait, there are few sites
+    for (uint32_t i = 1; i < statNum; i++)
+    {
+        MOS_LOCK_SITE_STATS stat = stats[i];
+        uint32_t            j    = i;
+        for (; j > 0 && stats[j - 1].waitNs < stat.waitNs; j--)
+        {
+            stats[j] = stats[j - 1];
+        }
+        stats[j] = stat;
+    }
+
+    fprintf(fp, "%-32s %12s %12s %8s %12s %10s %10s %12s %10s %10s\n",
+        "Site", "Acquired", "Contended", "Cont%", "Wait(ms)", "AvgWt(us)", "MaxWt(us)",
+        "Hold(ms)", "AvgHd(ns)", "MaxHd(us)");
+
+    for (uint32_t i = 0; i < statNum; i++)
+    {
+        const MOS_LOCK_SITE_STATS &stat = stats[i];
+        fprintf(fp, "%-32s %12llu %12llu %8.2f %12.3f %10.2f %10.2f %12.3f %10llu %10.2f\n",
+            stat.name,
+            (unsigned long long)stat.acquisitions,
+            (unsigned long long)stat.contended,
+            100.0 * stat.contended / stat.acquisitions,
+            stat.waitNs / 1e6,
+            stat.contended ? stat.waitNs / 1e3 / stat.contended : 0.0,
+            stat.maxWaitNs / 1e3,
+            stat.holdNs / 1e6,
+            (unsigned long long)(stat.holdNs / stat.acquisitions),
+            stat.maxHoldNs / 1e3);
+    }
+}
+
+bool MosLockProfile_Dump(const char *path)
+{
+    if (path == nullptr || path[0] == '\0')
+    {
+        return false;
+    }
+
+    char        fileName[256];
+    const char  *pid = strstr(path, "%d");
+    if (pid)
+    {
+        snprintf(fileName, sizeof(fileName), "%.*s%d%s", (int32_t)(pid - path), path, (int32_t)getpid(), pid + 2);
+    }
+    else
+    {
+        snprintf(fileName, sizeof(fileName), "%s", path);
+    }
+
+    FILE *fp = fopen(fileName, "w");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    MosLockProfile_Report(fp);
+    fclose(fp);
+    return true;
+}
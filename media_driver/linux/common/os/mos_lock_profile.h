@@ -0,0 +1,175 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_lock_profile.h
+//! \brief     Contention profile of the driver mutexes
+//! \details   MOS_LockMutex, DdiMediaUtil_LockMutex and the CM CSync all lock
+//!            through MosLockProfile_Lock. A mutex is given a static site name
+//!            when it is created ("DdiSurfaceHeap", "CmQueueEvent", ...), and
+//!            all mutexes of a name add up to one site. When profiling is on
+//!            every site counts acquisitions, contended acquisitions, total
+//!            and max wait time and total and max hold time, in thread
+//!            sharded counters like mos_metrics. When it is off locking costs
+//!            one relaxed load on top of the pthread call.
+//!            Mutexes of short critical sections can be created adaptive:
+//!            a waiter spins a while on the owner before it sleeps in the
+//!            kernel.
+//!            Only depends on libc and pthread so that the ULT can build it.
+//!
+
+#ifndef __MOS_LOCK_PROFILE_H__
+#define __MOS_LOCK_PROFILE_H__
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define MOS_LOCK_PROFILE_SITE_MAX       64          //!< Site names, the first one holds the unnamed mutexes
+#define MOS_LOCK_PROFILE_NAME_LEN       32
+#define MOS_LOCK_PROFILE_MUTEX_MAX      1024        //!< Named mutexes alive at a time, more count as unnamed
+#define MOS_LOCK_PROFILE_SHARD_NUM      16
+#define MOS_LOCK_PROFILE_HELD_MAX       16          //!< Mutexes held at a time by a thread, more go without hold time
+
+//!
+//! \brief    Merged counters of a site
+//!
+typedef struct _MOS_LOCK_SITE_STATS
+{
+    char        name[MOS_LOCK_PROFILE_NAME_LEN];
+    uint64_t    acquisitions;
+    uint64_t    contended;                      //!< Acquisitions that found the mutex locked
+    uint64_t    waitNs;
+    uint64_t    maxWaitNs;
+    uint64_t    holdNs;
+    uint64_t    maxHoldNs;
+} MOS_LOCK_SITE_STATS, *PMOS_LOCK_SITE_STATS;
+
+//!
+//! \brief    Initialize a mutex under a site name
+//! \param    [out] mutex
+//!           Mutex to initialize
+//! \param    [in] name
+//!           Static site name, nullptr for an unnamed mutex
+//! \param    [in] adaptiveSpin
+//!           Spin before sleeping when the mutex is locked, for critical
+//!           sections of a few hundred nanoseconds
+//! \return   int32_t
+//!           Result of pthread_mutex_init
+//!
+int32_t MosLockProfile_InitMutex(pthread_mutex_t *mutex, const char *name, bool adaptiveSpin);
+
+//!
+//! \brief    Destroy a mutex and drop its name
+//! \param    [in] mutex
+//!           Mutex to destroy
+//! \return   int32_t
+//!           Result of pthread_mutex_destroy
+//!
+int32_t MosLockProfile_DestroyMutex(pthread_mutex_t *mutex);
+
+//!
+//! \brief    Give a site name to a mutex initialized elsewhere
+//! \param    [in] mutex
+//!           Mutex, e.g. a static one from PTHREAD_MUTEX_INITIALIZER
+//! \param    [in] name
+//!           Static site name
+//! \return   void
+//!
+void MosLockProfile_NameMutex(const pthread_mutex_t *mutex, const char *name);
+
+//!
+//! \brief    Drop the name of a mutex, before its memory is reused
+//! \param    [in] mutex
+//!           Mutex
+//! \return   void
+//!
+void MosLockProfile_ForgetMutex(const pthread_mutex_t *mutex);
+
+//!
+//! \brief    Lock a mutex
+//! \param    [in] mutex
+//!           Mutex to lock
+//! \return   int32_t
+//!           Result of pthread_mutex_lock
+//!
+int32_t MosLockProfile_Lock(pthread_mutex_t *mutex);
+
+//!
+//! \brief    Unlock a mutex
+//! \param    [in] mutex
+//!           Mutex to unlock
+//! \return   int32_t
+//!           Result of pthread_mutex_unlock
+//!
+int32_t MosLockProfile_Unlock(pthread_mutex_t *mutex);
+
+//!
+//! \brief    Turn profiling on or off
+//! \details  Mutexes held while it is turned on are counted from their next
+//!           acquisition.
+//! \param    [in] enable
+//!           true to profile
+//! \return   void
+//!
+void MosLockProfile_Enable(bool enable);
+
+//!
+//! \brief    Check if profiling is on
+//! \return   bool
+//!
+bool MosLockProfile_IsEnabled();
+
+//!
+//! \brief    Clear the counters of all sites
+//! \return   void
+//!
+void MosLockProfile_Reset();
+
+//!
+//! \brief    Get the merged counters of the sites acquired at least once
+//! \param    [out] stats
+//!           Array to fill
+//! \param    [in] maxSites
+//!           Size of the array
+//! \return   uint32_t
+//!           Number of sites filled
+//!
+uint32_t MosLockProfile_GetStats(PMOS_LOCK_SITE_STATS stats, uint32_t maxSites);
+
+//!
+//! \brief    Print a table of the sites, most waited on first
+//! \param    [in] fp
+//!           Stream to print to
+//! \return   void
+//!
+void MosLockProfile_Report(FILE *fp);
+
+//!
+//! \brief    Write the report to a file
+//! \param    [in] path
+//!           File to create, "%d" in it is replaced by the pid
+//! \return   bool
+//!           true if the file was written
+//!
+bool MosLockProfile_Dump(const char *path);
+
+#endif // __MOS_LOCK_PROFILE_H__
@@ -0,0 +1,154 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_metrics_specific.cpp
+//! \brief     Linux implementation of the driver metrics registry
+//! \details   Only depends on libc and pthread so that it can be built into the ULT.
+//!
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "mos_metrics.h"
+
+static MOS_METRICS_SEGMENT      s_privateSegment;
+static PMOS_METRICS_SEGMENT     s_segment       = &s_privateSegment;
+static uint32_t                 s_nextShard     = 0;
+static __thread int32_t         t_shard         = -1;
+
+static pthread_mutex_t          s_exportMutex   = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t                 s_exportCount   = 0;
+static char                     s_shmName[64];
+
+uint64_t MosMetrics_GetTimeNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+PMOS_METRICS_SEGMENT MosMetrics_GetSegment()
+{
+    return __atomic_load_n(&s_segment, __ATOMIC_ACQUIRE);
+}
+
+//!
+//! \brief    Get the shard of the calling thread
+//! \details  Threads are assigned round robin on their first record. Past
+//!           MOS_METRICS_SHARD_NUM threads shards are shared, which stays
+//!           correct since all updates are atomic.
+//!
+static inline PMOS_METRICS_SHARD MosMetrics_GetShard()
+{
+    if (t_shard < 0)
+    {
+        t_shard = (int32_t)(__atomic_fetch_add(&s_nextShard, 1, __ATOMIC_RELAXED) % MOS_METRICS_SHARD_NUM);
+    }
+    return &MosMetrics_GetSegment()->shard[t_shard];
+}
+
+void MosMetrics_Record(MOS_METRIC_ID id, uint64_t ns)
+{
+    if ((uint32_t)id < MOS_METRIC_NUM)
+    {
+        MosMetrics_AddToShard(MosMetrics_GetShard(), id, ns, true);
+    }
+}
+
+void MosMetrics_Count(MOS_METRIC_ID id)
+{
+    if ((uint32_t)id < MOS_METRIC_NUM)
+    {
+        MosMetrics_AddToShard(MosMetrics_GetShard(), id, 0, false);
+    }
+}
+
+bool MosMetrics_Export()
+{
+    bool exported = false;
+
+    pthread_mutex_lock(&s_exportMutex);
+
+    if (s_exportCount > 0)
+    {
+        s_exportCount++;
+        exported = true;
+        goto finish;
+    }
+
+    {
+        snprintf(s_shmName, sizeof(s_shmName), MOS_METRICS_SHM_PREFIX "%d", (int32_t)getpid());
+
+        int32_t fd = shm_open(s_shmName, O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            goto finish;
+        }
+
+        void *addr = MAP_FAILED;
+        if (ftruncate(fd, sizeof(MOS_METRICS_SEGMENT)) == 0)
+        {
+            addr = mmap(nullptr, sizeof(MOS_METRICS_SEGMENT), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+
+        if (addr == MAP_FAILED)
+        {
+            shm_unlink(s_shmName);
+            goto finish;
+        }
+
+        // Events recorded by other threads while the segment is switched may be lost.
+        // A segment left from an earlier export is not unmapped for the same reason.
+        PMOS_METRICS_SEGMENT segment = (PMOS_METRICS_SEGMENT)addr;
+        memcpy(segment, MosMetrics_GetSegment(), sizeof(MOS_METRICS_SEGMENT));
+        segment->metricNum = MOS_METRIC_NUM;
+        segment->bucketNum = MOS_METRICS_BUCKET_NUM;
+        segment->shardNum  = MOS_METRICS_SHARD_NUM;
+        segment->pid       = (uint32_t)getpid();
+        segment->startNs   = MosMetrics_GetTimeNs();
+        segment->version   = MOS_METRICS_VERSION;
+        __atomic_store_n(&segment->magic, MOS_METRICS_MAGIC, __ATOMIC_RELEASE);
+
+        __atomic_store_n(&s_segment, segment, __ATOMIC_RELEASE);
+        s_exportCount = 1;
+        exported      = true;
+    }
+
+finish:
+    pthread_mutex_unlock(&s_exportMutex);
+    return exported;
+}
+
+void MosMetrics_Unexport()
+{
+    pthread_mutex_lock(&s_exportMutex);
+    if (s_exportCount > 0 && --s_exportCount == 0)
+    {
+        shm_unlink(s_shmName);
+    }
+    pthread_mutex_unlock(&s_exportMutex);
+}
@@ -49,6 +49,9 @@
 #include <sys/shm.h>
 #include <sys/sem.h>
 #include <sys/types.h>
+#include "mos_vdbox_load.h"
+#include "mos_metrics.h"
+#include "mos_resource_recycler.h"
 #endif
 
 //!
@@ -66,6 +69,11 @@
 //!
 #define DUAL_VDBOX_KEY ('D'<<24|'V'<<8|'X'<<0)
 
+//!
+//! \brief Two VDBOX load history shared memory key
+//!
+#define DUAL_VDBOX_LOAD_KEY ('D'<<24|'V'<<16|'L'<<8|'X'<<0)
+
 //MemNinja graphics counter
 extern int32_t MosMemAllocCounterGfx;
 
@@ -651,6 +659,13 @@ void DestroyIPC(PMOS_CONTEXT pOsContext)
             pOsContext->pShm = MOS_LINUX_SHM_INVALID;
 
             if (iAttachedNum) --iAttachedNum;
+
+            if (MOS_LINUX_IPC_INVALID_ID != pOsContext->loadShmid)
+            {
+                DetachDestroyShm(pOsContext->loadShmid, pOsContext->pLoadShm);
+                pOsContext->loadShmid = MOS_LINUX_IPC_INVALID_ID;
+                pOsContext->pLoadShm  = MOS_LINUX_SHM_INVALID;
+            }
             UnLockSemaphore(pOsContext->semid);
         }
     }
@@ -663,8 +678,11 @@ MOS_STATUS CreateIPC(PMOS_CONTEXT pOsContext)
     pOsContext->semid = MOS_LINUX_IPC_INVALID_ID;
     pOsContext->shmid = MOS_LINUX_IPC_INVALID_ID;
     pOsContext->pShm = MOS_LINUX_SHM_INVALID;
+    pOsContext->loadShmid = MOS_LINUX_IPC_INVALID_ID;
+    pOsContext->pLoadShm  = MOS_LINUX_SHM_INVALID;
 
     struct semid_ds buf;
+    MOS_USER_FEATURE_VALUE_DATA userFeatureData;
     //wait and retry untill to get a valid semaphore
     for (int i = 0; i < MOS_LINUX_SEM_MAX_TRIES; i ++)
     {
@@ -688,9 +706,42 @@ MOS_STATUS CreateIPC(PMOS_CONTEXT pOsContext)
     UnLockSemaphore(pOsContext->semid);
     MOS_CHK_STATUS_SAFE(eStatus);
 
+    // The load history lives in its own segment so that the layout of the
+    // session counters stays compatible with drivers that do not know it.
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_VDBOX_LOAD_AWARE_BALANCING_ID,
+        &userFeatureData);
+    if (userFeatureData.bData)
+    {
+        LockSemaphore(pOsContext->semid);
+        if (ConnectCreateShm(DUAL_VDBOX_LOAD_KEY, sizeof(VDBOX_LOAD), &pOsContext->loadShmid, &pOsContext->pLoadShm) != MOS_STATUS_SUCCESS)
+        {
+            MOS_OS_NORMALMESSAGE("VDBox load history is not available, balancing by session count.");
+            pOsContext->loadShmid = MOS_LINUX_IPC_INVALID_ID;
+            pOsContext->pLoadShm  = MOS_LINUX_SHM_INVALID;
+        }
+        UnLockSemaphore(pOsContext->semid);
+    }
+
 finish:
     return eStatus;
 }
+
+//!
+//! \brief    Get the time base of the VDBox load history
+//! \details  Uses the monotonic clock so that all processes agree on the
+//!           bucket epochs and wall clock adjustments do not reset the history.
+//! \return   uint64_t
+//!           Time in milliseconds
+//!
+static uint64_t Mos_Specific_GetVdboxLoadTime()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 #endif
 
 GpuContextSpecific* Linux_GetGpuContext(PMOS_INTERFACE pOsInterface, uint32_t gpuContextHandle)
@@ -1722,6 +1773,7 @@ MOS_STATUS Mos_Specific_AllocateResource(
     GMM_RESOURCE_TYPE       resourceType;
 
     MOS_OS_FUNCTION_ENTER;
+    MOS_METRICS_SCOPE(MOS_METRIC_RESOURCE_ALLOCATE);
 
     if( nullptr == pOsResource)
     {
@@ -1749,6 +1801,12 @@ MOS_STATUS Mos_Specific_AllocateResource(
 
     if ((pOsInterface->modulizedMosEnabled) && (!Mos_Solo_IsEnabled()) && (osContextValid == true))
     {
+        MosResourceRecycler *recycler = MosResourceRecycler::Instance();
+        if (recycler->Acquire(pOsInterface, pParams, pOsResource))
+        {
+            return MOS_STATUS_SUCCESS;
+        }
+
         pOsResource->pGfxResource = GraphicsResource::CreateGraphicResource(GraphicsResource::osSpecificResource);
         if (pOsResource->pGfxResource == nullptr)
         {
@@ -1784,6 +1842,7 @@ MOS_STATUS Mos_Specific_AllocateResource(
         MOS_MEMNINJA_GFX_ALLOC_MESSAGE(pOsResource->pGmmResInfo, bufname, pOsInterface->Component,
             (uint32_t)pOsResource->pGmmResInfo->GetSizeSurface(), pParams->dwArraySize, functionName, filename, line);
 
+        recycler->Register(pOsInterface, pParams, pOsResource);
         return eStatus;
     }
 
@@ -2129,6 +2188,7 @@ void Mos_Specific_FreeResource(
     PMOS_RESOURCE    pOsResource)
 {
     MOS_OS_FUNCTION_ENTER;
+    MOS_METRICS_SCOPE(MOS_METRIC_RESOURCE_FREE);
 
     if( nullptr == pOsInterface )
     {
@@ -2163,6 +2223,12 @@ void Mos_Specific_FreeResource(
             return;
         }
 
+        if (MosResourceRecycler::Instance()->Recycle(pOsInterface, pOsResource))
+        {
+            MOS_ZeroMemory(pOsResource, sizeof(*pOsResource));
+            return;
+        }
+
         GraphicsResource::SetMemAllocCounterGfx(MosMemAllocCounterGfx);
 
         if (pOsResource && pOsResource->pGfxResource)
@@ -2837,6 +2903,7 @@ MOS_STATUS Mos_Specific_GetCommandBuffer(
     uint32_t                dwFlags)
 {
     MOS_OS_FUNCTION_ENTER;
+    MOS_METRICS_SCOPE(MOS_METRIC_GET_CMD_BUFFER);
 
     MOS_OS_CHK_NULL_RETURN(pOsInterface);
     MOS_OS_CHK_NULL_RETURN(pCmdBuffer);
@@ -3277,6 +3344,7 @@ MOS_STATUS Mos_Specific_SubmitCommandBuffer(
     int32_t               bNullRendering)
 {
     MOS_OS_FUNCTION_ENTER;
+    MOS_METRICS_SCOPE(MOS_METRIC_SUBMIT_CMD_BUFFER);
 
     MOS_OS_CHK_NULL_RETURN(pOsInterface);
     MOS_OS_CHK_NULL_RETURN(pCmdBuffer);
@@ -3495,6 +3563,8 @@ MOS_STATUS Mos_Specific_SubmitCommandBuffer(
             {
                 ExecFlag = I915_EXEC_BSD | I915_EXEC_BSD_RING2;
             }
+
+            Mos_Specific_ChargeVdboxLoad(pOsInterface, ExecFlag);
         }
 	else
 	{
@@ -5429,7 +5499,29 @@ MOS_STATUS Mos_Specific_CreateVideoNodeAssociation(
 
     pVDBoxWorkLoad = (PVDBOX_WORKLOAD)pOsContext->pShm;
 
-    if (bSetVideoNode)
+    if (!bSetVideoNode && pOsContext->pLoadShm != MOS_LINUX_SHM_INVALID)
+    {
+        // Pick the node with less recent work; session count and the ping-pong
+        // index only decide between nodes that are about equally busy.
+        uint32_t node = MosVdboxLoad_SelectNode(
+            (PVDBOX_LOAD)pOsContext->pLoadShm,
+            pVDBoxWorkLoad->uiVDBoxCount,
+            pVDBoxWorkLoad->uiRingIndex,
+            Mos_Specific_GetVdboxLoadTime());
+
+        *pVideoNodeOrdinal = node ? MOS_GPU_NODE_VIDEO2 : MOS_GPU_NODE_VIDEO;
+        pVDBoxWorkLoad->uiVDBoxCount[node]++;
+        pVDBoxWorkLoad->uiRingIndex = !node;
+
+        // Reserve one frame of work up front so that sessions created in a
+        // burst do not all land on the node that was idle a moment ago.
+        MosVdboxLoad_Charge(
+            (PVDBOX_LOAD)pOsContext->pLoadShm,
+            node,
+            pOsInterface->dwVdboxWorkload,
+            Mos_Specific_GetVdboxLoadTime());
+    }
+    else if (bSetVideoNode)
     {
         if (*pVideoNodeOrdinal == MOS_GPU_NODE_VIDEO)
         {
@@ -5522,6 +5614,48 @@ MOS_STATUS Mos_Specific_DestroyVideoNodeAssociation(
 }
 #endif
 
+void Mos_Specific_ChargeVdboxLoad(
+    PMOS_INTERFACE              pOsInterface,
+    uint32_t                    execFlag)
+{
+#ifndef ANDROID
+    PMOS_CONTEXT pOsContext;
+    uint32_t     node;
+
+    MOS_OS_CHK_NULL_NO_STATUS_RETURN(pOsInterface);
+    pOsContext = pOsInterface->pOsContext;
+    MOS_OS_CHK_NULL_NO_STATUS_RETURN(pOsContext);
+
+    if (!pOsContext->bKMDHasVCS2 || pOsContext->pLoadShm == MOS_LINUX_SHM_INVALID)
+    {
+        return;
+    }
+
+    if (execFlag == (I915_EXEC_BSD | I915_EXEC_BSD_RING1))
+    {
+        node = 0;
+    }
+    else if (execFlag == (I915_EXEC_BSD | I915_EXEC_BSD_RING2))
+    {
+        node = 1;
+    }
+    else
+    {
+        return;
+    }
+
+    // Sessions that do not report their frame size still count by submission rate.
+    MosVdboxLoad_Charge(
+        (PVDBOX_LOAD)pOsContext->pLoadShm,
+        node,
+        pOsInterface->dwVdboxWorkload ? pOsInterface->dwVdboxWorkload : 1,
+        Mos_Specific_GetVdboxLoadTime());
+#else
+    MOS_UNUSED(pOsInterface);
+    MOS_UNUSED(execFlag);
+#endif
+}
+
 MOS_VDBOX_NODE_IND Mos_Specific_GetVdboxNodeId(
     PMOS_INTERFACE pOsInterface,
     PMOS_COMMAND_BUFFER pCmdBuffer)
@@ -5557,7 +5691,16 @@ MOS_VDBOX_NODE_IND Mos_Specific_GetVdboxNodeId(
         ret = drmIoctl(pOsInterface->pOsContext->fd, DRM_IOCTL_I915_LOAD_BALANCING_HINT,
             &vdbox_load_query);
 
-        if (ret) {
+        if (ret && pOsInterface->pOsContext->pLoadShm != MOS_LINUX_SHM_INVALID) {
+            // No KMD hint, use the load history shared by the UMD instead.
+            idx = MosVdboxLoad_SelectNode(
+                (PVDBOX_LOAD)pOsInterface->pOsContext->pLoadShm,
+                nullptr,
+                0,
+                Mos_Specific_GetVdboxLoadTime()) ? MOS_VDBOX_NODE_2 : MOS_VDBOX_NODE_1;
+
+            pCmdBuffer->iVdboxNodeIndex = idx;
+        } else if (ret) {
             MOS_OS_ASSERTMESSAGE("Failed to query KMD for balancing hint:"
                 " error %d (falling back to ctx assigment)", ret);
         } else {
@@ -514,6 +514,8 @@ struct _MOS_OS_CONTEXT
     int32_t             semid;
     int32_t             shmid;
     void                *pShm;
+    int32_t             loadShmid;                 //!< Shared VDBox load history, see mos_vdbox_load.h
+    void                *pLoadShm;
 
     uint32_t            *pTranscryptedKernels;     //!< The cached version for current set of transcrypted and authenticated kernels
     uint32_t            uiTranscryptedKernelsSize; //!< Size in bytes of the cached version of transcrypted and authenticated kernels
@@ -796,6 +798,21 @@ void Mos_Specific_SetResourceFormat(
     PMOS_RESOURCE               pOsResource,
     MOS_FORMAT                  mosFormat);
 
+//!
+//! \brief    Charge a VCS submission to the shared VDBox load history
+//! \details  Adds the per submission workload of the OS interface to the node
+//!           the command buffer is executed on. No-op when load aware
+//!           balancing is disabled or the node is not a VCS ring.
+//! \param    PMOS_INTERFACE pOsInterface
+//!           [in] Pointer to OS interface structure
+//! \param    uint32_t execFlag
+//!           [in] i915 exec flag of the submission
+//! \return   void
+//!
+void Mos_Specific_ChargeVdboxLoad(
+    PMOS_INTERFACE              pOsInterface,
+    uint32_t                    execFlag);
+
 //!
 //! \brief    Get SetMarker enabled flag
 //! \details  Get SetMarker enabled flag from OsInterface
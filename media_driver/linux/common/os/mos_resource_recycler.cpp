@@ -0,0 +1,401 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_resource_recycler.cpp
+//! \brief     Reuse of freed resources by allocations of the same description
+//!
+
+#include <tuple>
+#include "mos_resource_recycler.h"
+#include "mos_graphicsresource.h"
+#include "mos_context.h"
+#include "mos_util_debug.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    MOS_FUNC_EXPORT void MOS_SetResourceRecyclerSize(uint64_t maxSize)
+    {
+        MosResourceRecycler::Instance()->SetMaxSize(maxSize);
+    }
+
+    MOS_FUNC_EXPORT uint32_t MOS_GetResourceRecyclerStats(PMOS_RESOURCE_RECYCLER_STATS pStats, uint32_t uiMaxStats)
+    {
+        return MosResourceRecycler::Instance()->GetStats(pStats, uiMaxStats);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+bool MosResourceRecycler::Key::operator<(const Key &other) const
+{
+    return std::tie(type, format, width, height, depth, arraySize, tileType, isCompressed, compressionMode, notLockable, isPersistent) <
+        std::tie(other.type, other.format, other.width, other.height, other.depth, other.arraySize, other.tileType,
+            other.isCompressed, other.compressionMode, other.notLockable, other.isPersistent);
+}
+
+MosResourceRecycler::MosResourceRecycler()
+{
+    MOS_USER_FEATURE_VALUE_DATA userFeatureData;
+    MOS_ZeroMemory(&userFeatureData, sizeof(userFeatureData));
+    MOS_UserFeature_ReadValue_ID(
+        nullptr,
+        __MEDIA_USER_FEATURE_VALUE_MEDIA_RESOURCE_RECYCLER_SIZE_ID,
+        &userFeatureData);
+    m_maxSize = (uint64_t)MOS_MAX(userFeatureData.i32Data, 0) << 20;
+
+    m_mutex = MOS_CreateNamedMutex("MosResourceRecycler", true);
+
+    // m_mutex is destroyed after MemNinja report, this will cause fake memory leak,
+    // the following 2 lines is to circumvent Memninja counter validation and log parser
+    MosMemAllocCounter--;
+    MOS_MEMNINJA_FREE_MESSAGE(m_mutex, __FUNCTION__, __FILE__, __LINE__);
+
+    if (m_mutex == nullptr)
+    {
+        m_maxSize = 0;
+    }
+}
+
+MosResourceRecycler::~MosResourceRecycler()
+{
+    if (m_mutex != nullptr)
+    {
+        MOS_DestroyMutex(m_mutex);
+        m_mutex = nullptr;
+    }
+}
+
+MosResourceRecycler *MosResourceRecycler::Instance()
+{
+    static MosResourceRecycler instance;
+    return &instance;
+}
+
+bool MosResourceRecycler::GetKey(PMOS_ALLOC_GFXRES_PARAMS params, Key &key)
+{
+    // The pages of a system memory resource belong to the caller. Overlay,
+    // flip chain and SVM resources get GMM flags that the key does not hold.
+    if (params == nullptr ||
+        params->pSystemMemory != nullptr ||
+        params->Flags.bOverlay ||
+        params->Flags.bFlipChain ||
+        params->Flags.bSVM)
+    {
+        return false;
+    }
+
+    MOS_ZeroMemory(&key, sizeof(key));
+    key.type            = params->Type;
+    key.format          = params->Format;
+    key.width           = params->dwWidth;
+    key.height          = (params->Type == MOS_GFXRES_BUFFER) ? 0 : params->dwHeight;
+    key.depth           = (params->Type == MOS_GFXRES_VOLUME) ? params->dwDepth : 0;
+    key.arraySize       = MOS_MAX(params->dwArraySize, 1);
+    key.tileType        = params->TileType;
+    key.isCompressed    = params->bIsCompressed ? 1 : 0;
+    key.compressionMode = key.isCompressed ? params->CompressionMode : MOS_MMC_DISABLED;
+    key.notLockable     = params->Flags.bNotLockable ? 1 : 0;
+    key.isPersistent    = params->bIsPersistent ? 1 : 0;
+
+    return true;
+}
+
+MOS_RESOURCE_RECYCLER_STATS *MosResourceRecycler::GetKeyStats(Device &device, const Key &key)
+{
+    auto it = device.stats.find(key);
+    if (it != device.stats.end())
+    {
+        return &it->second;
+    }
+    if (device.stats.size() >= MOS_RESOURCE_RECYCLER_STATS_MAX)
+    {
+        return nullptr;
+    }
+
+    MOS_RESOURCE_RECYCLER_STATS stats;
+    MOS_ZeroMemory(&stats, sizeof(stats));
+    stats.type         = key.type;
+    stats.format       = key.format;
+    stats.width        = key.width;
+    stats.height       = key.height;
+    stats.tileType     = key.tileType;
+    stats.isCompressed = key.isCompressed;
+
+    return &device.stats.insert(std::make_pair(key, stats)).first->second;
+}
+
+void MosResourceRecycler::FreeEntry(Entry &entry, OsContext *osContext)
+{
+    GraphicsResource::SetMemAllocCounterGfx(MosMemAllocCounterGfx);
+    entry.gfxResource->Free(osContext);
+    MosMemAllocCounterGfx = GraphicsResource::GetMemAllocCounterGfx();
+    MOS_MEMNINJA_GFX_FREE_MESSAGE(entry.gmmResInfo, __FUNCTION__, __FILE__, __LINE__);
+
+    MOS_Delete(entry.gfxResource);
+}
+
+void MosResourceRecycler::SetMaxSize(uint64_t maxSize)
+{
+    if (m_mutex == nullptr)
+    {
+        return;
+    }
+
+    MOS_LockMutex(m_mutex);
+    m_maxSize = maxSize;
+    if (m_maxSize == 0)
+    {
+        // Resources allocated from now on are not registered, their addresses
+        // must not match stale registrations when the recycler comes back
+        for (auto &device : m_devices)
+        {
+            device.second.allocated.clear();
+        }
+    }
+    MOS_UnlockMutex(m_mutex);
+}
+
+bool MosResourceRecycler::Acquire(PMOS_INTERFACE osInterface, PMOS_ALLOC_GFXRES_PARAMS params, PMOS_RESOURCE resource)
+{
+    Key key;
+    if (!IsEnabled() ||
+        osInterface == nullptr ||
+        osInterface->pOsContext == nullptr ||
+        resource == nullptr ||
+        !GetKey(params, key))
+    {
+        return false;
+    }
+
+    MOS_LockMutex(m_mutex);
+    Device &device = m_devices[osInterface->pOsContext->bufmgr];
+    MOS_RESOURCE_RECYCLER_STATS *stats = GetKeyStats(device, key);
+
+    auto range = device.entries.equal_range(key);
+    if (range.first == range.second)
+    {
+        if (stats)
+        {
+            stats->misses++;
+        }
+        MOS_UnlockMutex(m_mutex);
+        return false;
+    }
+
+    for (auto it = range.first; it != range.second; it++)
+    {
+        // The new owner may write the resource from the CPU or from another
+        // engine, so only a resource the GPU is done with can be handed out
+        if (mos_bo_busy(it->second.bo))
+        {
+            continue;
+        }
+
+        GraphicsResource *gfxResource = it->second.gfxResource;
+        device.size -= it->second.size;
+        device.entries.erase(it);
+        device.allocated[gfxResource] = key;
+        if (stats)
+        {
+            stats->hits++;
+        }
+        MOS_UnlockMutex(m_mutex);
+
+        resource->pGfxResource = gfxResource;
+        gfxResource->ConvertToMosResource(resource);
+
+        // Named after the new owner, not the allocation it was recycled from
+        gfxResource->SetName(params->pBufName);
+        resource->bufname = gfxResource->GetName();
+        return true;
+    }
+
+    if (stats)
+    {
+        stats->busy++;
+    }
+    MOS_UnlockMutex(m_mutex);
+    return false;
+}
+
+void MosResourceRecycler::Register(PMOS_INTERFACE osInterface, PMOS_ALLOC_GFXRES_PARAMS params, PMOS_RESOURCE resource)
+{
+    Key key;
+    if (!IsEnabled() ||
+        osInterface == nullptr ||
+        osInterface->pOsContext == nullptr ||
+        resource == nullptr ||
+        resource->pGfxResource == nullptr ||
+        !GetKey(params, key))
+    {
+        return;
+    }
+
+    MOS_LockMutex(m_mutex);
+    m_devices[osInterface->pOsContext->bufmgr].allocated[resource->pGfxResource] = key;
+    MOS_UnlockMutex(m_mutex);
+}
+
+bool MosResourceRecycler::Recycle(PMOS_INTERFACE osInterface, PMOS_RESOURCE resource)
+{
+    if (!IsEnabled() ||
+        osInterface == nullptr ||
+        osInterface->pOsContext == nullptr ||
+        osInterface->osContextPtr == nullptr ||
+        resource == nullptr ||
+        resource->pGfxResource == nullptr ||
+        resource->bConvertedFromDDIResource)
+    {
+        return false;
+    }
+
+    MOS_LockMutex(m_mutex);
+    auto deviceIt = m_devices.find(osInterface->pOsContext->bufmgr);
+    if (deviceIt == m_devices.end())
+    {
+        MOS_UnlockMutex(m_mutex);
+        return false;
+    }
+
+    Device &device = deviceIt->second;
+    auto allocatedIt = device.allocated.find(resource->pGfxResource);
+    if (allocatedIt == device.allocated.end())
+    {
+        MOS_UnlockMutex(m_mutex);
+        return false;
+    }
+    Key key = allocatedIt->second;
+    device.allocated.erase(allocatedIt);
+
+    if (resource->bo == nullptr || resource->pGmmResInfo == nullptr)
+    {
+        MOS_UnlockMutex(m_mutex);
+        return false;
+    }
+
+    Entry entry;
+    entry.gfxResource = resource->pGfxResource;
+    entry.bo          = resource->bo;
+    entry.gmmResInfo  = resource->pGmmResInfo;
+    entry.size        = resource->pGmmResInfo->GetSizeSurface();
+    entry.lastUse     = ++m_sequence;
+    if (entry.size > m_maxSize)
+    {
+        MOS_UnlockMutex(m_mutex);
+        return false;
+    }
+
+    device.entries.insert(std::make_pair(key, entry));
+    device.size += entry.size;
+    MOS_RESOURCE_RECYCLER_STATS *stats = GetKeyStats(device, key);
+    if (stats)
+    {
+        stats->recycled++;
+    }
+
+    // Free the least recently recycled resources above the limit
+    while (device.size > m_maxSize)
+    {
+        auto oldest = device.entries.begin();
+        for (auto it = device.entries.begin(); it != device.entries.end(); it++)
+        {
+            if (it->second.lastUse < oldest->second.lastUse)
+            {
+                oldest = it;
+            }
+        }
+
+        stats = GetKeyStats(device, oldest->first);
+        if (stats)
+        {
+            stats->evicted++;
+        }
+        device.size -= oldest->second.size;
+        FreeEntry(oldest->second, osInterface->osContextPtr);
+        device.entries.erase(oldest);
+    }
+    MOS_UnlockMutex(m_mutex);
+
+    return true;
+}
+
+void MosResourceRecycler::Drain(MOS_BUFMGR *bufmgr, OsContext *osContext)
+{
+    if (m_mutex == nullptr || osContext == nullptr)
+    {
+        return;
+    }
+
+    MOS_LockMutex(m_mutex);
+    auto deviceIt = m_devices.find(bufmgr);
+    if (deviceIt == m_devices.end())
+    {
+        MOS_UnlockMutex(m_mutex);
+        return;
+    }
+
+    Device &device = deviceIt->second;
+    for (auto &stats : device.stats)
+    {
+        const MOS_RESOURCE_RECYCLER_STATS &s = stats.second;
+        MOS_OS_NORMALMESSAGE("Resource recycler: type %d format %d %dx%d tile %d compressed %d: "
+            "%llu hits, %llu misses, %llu busy, %llu recycled, %llu evicted.",
+            s.type, s.format, s.width, s.height, s.tileType, s.isCompressed,
+            (unsigned long long)s.hits, (unsigned long long)s.misses, (unsigned long long)s.busy,
+            (unsigned long long)s.recycled, (unsigned long long)s.evicted);
+    }
+
+    for (auto &entry : device.entries)
+    {
+        FreeEntry(entry.second, osContext);
+    }
+    m_devices.erase(deviceIt);
+    MOS_UnlockMutex(m_mutex);
+}
+
+uint32_t MosResourceRecycler::GetStats(PMOS_RESOURCE_RECYCLER_STATS stats, uint32_t maxStats)
+{
+    if (m_mutex == nullptr || stats == nullptr)
+    {
+        return 0;
+    }
+
+    uint32_t statNum = 0;
+    MOS_LockMutex(m_mutex);
+    for (auto &device : m_devices)
+    {
+        for (auto &keyStats : device.second.stats)
+        {
+            if (statNum >= maxStats)
+            {
+                break;
+            }
+            stats[statNum++] = keyStats.second;
+        }
+    }
+    MOS_UnlockMutex(m_mutex);
+
+    return statNum;
+}
@@ -0,0 +1,203 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_resource_recycler.h
+//! \brief     Reuse of freed resources by allocations of the same description
+//! \details   Every Mos_Specific_AllocateResource builds the GMM parameters,
+//!            creates a GMM resource info and allocates a BO, and every
+//!            FreeResource tears both down again. Codec and VP allocate the
+//!            same intermediate surfaces and buffers over and over. The
+//!            recycler keeps freed resources per device, keyed by their
+//!            allocation parameters, and hands one back fully initialized
+//!            when an allocation with the same parameters comes in and its
+//!            BO is idle on the GPU.
+//!
+
+#ifndef __MOS_RESOURCE_RECYCLER_H__
+#define __MOS_RESOURCE_RECYCLER_H__
+
+#include <map>
+#include "mos_os.h"
+
+#define MOS_RESOURCE_RECYCLER_STATS_MAX     256     //!< Descriptors with statistics per device, more are not counted
+
+//!
+//! \brief    Statistics of one allocation description
+//!
+typedef struct _MOS_RESOURCE_RECYCLER_STATS
+{
+    MOS_GFXRES_TYPE     type;
+    MOS_FORMAT          format;
+    uint32_t            width;                  //!< Bytes for a buffer
+    uint32_t            height;
+    MOS_TILE_TYPE       tileType;
+    int32_t             isCompressed;
+    uint64_t            hits;                   //!< Allocations served from the recycler
+    uint64_t            misses;                 //!< Allocations with no resource of the description kept
+    uint64_t            busy;                   //!< Allocations which only found resources still used by the GPU
+    uint64_t            recycled;               //!< Frees kept by the recycler
+    uint64_t            evicted;                //!< Kept resources freed for the size limit
+} MOS_RESOURCE_RECYCLER_STATS, *PMOS_RESOURCE_RECYCLER_STATS;
+
+class GraphicsResource;
+class OsContext;
+
+//!
+//! \class   MosResourceRecycler
+//! \brief   Process wide recycler of freed resources, one set per device
+//! \details Only resources of the modular MOS path are recycled: their GMM
+//!          client and BO manager belong to the device, not to the OS
+//!          interface that allocated them.
+//!
+class MosResourceRecycler
+{
+public:
+    //!
+    //! \brief  Get the recycler
+    //! \return Pointer to the recycler
+    //!
+    static MosResourceRecycler *Instance();
+
+    //!
+    //! \brief  Check if the recycler keeps resources
+    //! \return true if enabled
+    //!
+    bool IsEnabled() { return m_maxSize != 0; }
+
+    //!
+    //! \brief  Set the max size of the resources kept per device
+    //! \details Resources kept above the new size are freed on the next recycle.
+    //! \param  [in] maxSize
+    //!         Size in bytes, 0 disables the recycler
+    //! \return void
+    //!
+    void SetMaxSize(uint64_t maxSize);
+
+    //!
+    //! \brief  Take a kept resource for an allocation
+    //! \param  [in] osInterface
+    //!         OS interface of the allocation
+    //! \param  [in] params
+    //!         Allocation parameters
+    //! \param  [out] resource
+    //!         Filled like by a new allocation on success
+    //! \return bool
+    //!         true if a resource was taken, false to allocate a new one
+    //!
+    bool Acquire(PMOS_INTERFACE osInterface, PMOS_ALLOC_GFXRES_PARAMS params, PMOS_RESOURCE resource);
+
+    //!
+    //! \brief  Remember the parameters of a new allocation
+    //! \details Only registered resources are kept when they are freed.
+    //! \param  [in] osInterface
+    //!         OS interface of the allocation
+    //! \param  [in] params
+    //!         Allocation parameters
+    //! \param  [in] resource
+    //!         Allocated resource
+    //! \return void
+    //!
+    void Register(PMOS_INTERFACE osInterface, PMOS_ALLOC_GFXRES_PARAMS params, PMOS_RESOURCE resource);
+
+    //!
+    //! \brief  Keep a resource that is freed
+    //! \param  [in] osInterface
+    //!         OS interface freeing the resource
+    //! \param  [in] resource
+    //!         Resource to free
+    //! \return bool
+    //!         true if the recycler took the resource, false to free it
+    //!
+    bool Recycle(PMOS_INTERFACE osInterface, PMOS_RESOURCE resource);
+
+    //!
+    //! \brief  Free all resources kept for a device and log its statistics
+    //! \param  [in] bufmgr
+    //!         BO manager of the device
+    //! \param  [in] osContext
+    //!         OS context of the device used to free the resources
+    //! \return void
+    //!
+    void Drain(MOS_BUFMGR *bufmgr, OsContext *osContext);
+
+    //!
+    //! \brief  Get the statistics of all devices
+    //! \param  [out] stats
+    //!         Array to fill
+    //! \param  [in] maxStats
+    //!         Size of the array
+    //! \return uint32_t
+    //!         Number of descriptions filled
+    //!
+    uint32_t GetStats(PMOS_RESOURCE_RECYCLER_STATS stats, uint32_t maxStats);
+
+private:
+    MosResourceRecycler();
+    ~MosResourceRecycler();
+
+    struct Key
+    {
+        MOS_GFXRES_TYPE         type;
+        MOS_FORMAT              format;
+        uint32_t                width;
+        uint32_t                height;
+        uint32_t                depth;
+        uint32_t                arraySize;
+        MOS_TILE_TYPE           tileType;
+        int32_t                 isCompressed;
+        MOS_RESOURCE_MMC_MODE   compressionMode;
+        int32_t                 notLockable;
+        int32_t                 isPersistent;
+
+        bool operator<(const Key &other) const;
+    };
+
+    struct Entry
+    {
+        GraphicsResource    *gfxResource;
+        MOS_LINUX_BO        *bo;
+        GMM_RESOURCE_INFO   *gmmResInfo;
+        uint64_t            size;
+        uint64_t            lastUse;        //!< Recycle sequence number, the lowest is evicted first
+    };
+
+    struct Device
+    {
+        std::multimap<Key, Entry>           entries;
+        std::map<GraphicsResource *, Key>   allocated;  //!< Registered resources not freed yet
+        std::map<Key, MOS_RESOURCE_RECYCLER_STATS> stats;
+        uint64_t                            size = 0;
+    };
+
+    static bool GetKey(PMOS_ALLOC_GFXRES_PARAMS params, Key &key);
+
+    MOS_RESOURCE_RECYCLER_STATS *GetKeyStats(Device &device, const Key &key);
+
+    void FreeEntry(Entry &entry, OsContext *osContext);
+
+    std::map<MOS_BUFMGR *, Device>  m_devices;
+    PMOS_MUTEX                      m_mutex    = nullptr;
+    uint64_t                        m_maxSize  = 0;
+    uint64_t                        m_sequence = 0;
+};
+
+#endif // __MOS_RESOURCE_RECYCLER_H__
@@ -27,6 +27,8 @@
 #include "mos_utilities_specific.h"
 #include "mos_utilities.h"
 #include "mos_util_debug.h"
+#include "mos_metrics.h"
+#include "mos_lock_profile.h"
 #include <fcntl.h>     // open
 #include <stdlib.h>    // atoi
 #include <string.h>    // strlen, strcat, etc.
@@ -109,6 +111,19 @@ double MOS_GetTime()
     return double(ts.tv_sec) * 1000000.0 + double(ts.tv_nsec) / 1000.0;
 }
 
+//!
+//! \brief    Get current monotonic time
+//! \details  Get time in us from CLOCK_MONOTONIC
+//! \return   double
+//!           Returns time in us
+//!
+double MOS_GetMonotonicTime()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return double(ts.tv_sec) * 1000000.0 + double(ts.tv_nsec) / 1000.0;
+}
+
 //!
 //! \brief Linux specific user feature define, used in MOS_UserFeature_ParsePath
 //!        They can be unified with the win definitions, since they are identical.
@@ -149,6 +164,8 @@ MosUtilUserInterface  *utilUserInterface = nullptr;
 MOS_MUTEX gMosUtilMutex = PTHREAD_MUTEX_INITIALIZER;
 
 static uint32_t uiMOSUtilInitCount = 0; // number count of mos utilities init
+static bool     bMosMetricsExported = false; // metrics segment published in shared memory
+static char     cMosLockProfileFile[MOS_USER_CONTROL_MAX_DATA_SIZE]; // lock profile report written on close
 
 MOS_STATUS MOS_SecureStrcat(char  *strDestination, size_t numberOfElements, const char * const strSource)
 {
@@ -2185,6 +2202,32 @@ MOS_STATUS MOS_OS_Utilities_Init()
         MosMemAllocFakeCounter = 0;
         MosMemAllocCounterGfx  = 0;
         MOS_TraceEventInit();
+
+        MOS_USER_FEATURE_VALUE_DATA UserFeatureData;
+        MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+        MOS_USER_FEATURE_INVALID_KEY_ASSERT(MOS_UserFeature_ReadValue_ID(
+            nullptr,
+            __MEDIA_USER_FEATURE_VALUE_MEDIA_METRICS_EXPORT_ID,
+            &UserFeatureData));
+        bMosMetricsExported = UserFeatureData.bData && MosMetrics_Export();
+
+        MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+        MOS_ZeroMemory(cMosLockProfileFile, sizeof(cMosLockProfileFile));
+        UserFeatureData.StringData.pStringData = cMosLockProfileFile;
+        UserFeatureData.StringData.uMaxSize    = sizeof(cMosLockProfileFile);
+        MOS_UserFeature_ReadValue_ID(
+            nullptr,
+            __MEDIA_USER_FEATURE_VALUE_MEDIA_LOCK_PROFILE_OUTPUT_FILE_ID,
+            &UserFeatureData);
+        if (UserFeatureData.StringData.uSize > 0 && UserFeatureData.StringData.uSize < sizeof(cMosLockProfileFile))
+        {
+            cMosLockProfileFile[UserFeatureData.StringData.uSize] = '\0';
+            MosLockProfile_Enable(cMosLockProfileFile[0] != '\0');
+        }
+        else
+        {
+            cMosLockProfileFile[0] = '\0';
+        }
     }
     uiMOSUtilInitCount++;
 
@@ -2205,6 +2248,15 @@ MOS_STATUS MOS_OS_Utilities_Close()
     if (uiMOSUtilInitCount == 0 )
     {
         MOS_TraceEventClose();
+        if (bMosMetricsExported)
+        {
+            MosMetrics_Unexport();
+            bMosMetricsExported = false;
+        }
+        if (cMosLockProfileFile[0] != '\0')
+        {
+            MosLockProfile_Dump(cMosLockProfileFile);
+        }
         MosMemAllocCounter -= MosMemAllocFakeCounter;
         MemoryCounter = MosMemAllocCounter + MosMemAllocCounterGfx;
         MosMemAllocCounterNoUserFeature = MosMemAllocCounter;
@@ -2631,14 +2683,20 @@ MOS_STATUS MOS_WaitThread(
 }
 
 PMOS_MUTEX MOS_CreateMutex()
+{
+    return MOS_CreateNamedMutex(nullptr, false);
+}
+
+PMOS_MUTEX MOS_CreateNamedMutex(const char *name, bool adaptiveSpin)
 {
     PMOS_MUTEX pMutex;
 
     pMutex = (PMOS_MUTEX)MOS_AllocMemory(sizeof(*pMutex));
     if (pMutex != nullptr)
     {
-        if (pthread_mutex_init(pMutex, nullptr))
+        if (MosLockProfile_InitMutex(pMutex, name, adaptiveSpin))
         {
+            MOS_FreeMemory(pMutex);
             pMutex = nullptr;
         }
     }
@@ -2652,7 +2710,7 @@ MOS_STATUS MOS_DestroyMutex(PMOS_MUTEX pMutex)
 
     if (pMutex)
     {
-        if (pthread_mutex_destroy(pMutex))
+        if (MosLockProfile_DestroyMutex(pMutex))
         {
             eStatus = MOS_STATUS_UNKNOWN;
         }
@@ -2666,7 +2724,7 @@ MOS_STATUS MOS_LockMutex(PMOS_MUTEX pMutex)
 {
     MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
 
-    if (pthread_mutex_lock(pMutex))
+    if (MosLockProfile_Lock(pMutex))
     {
         eStatus = MOS_STATUS_UNKNOWN;
     }
@@ -2678,7 +2736,7 @@ MOS_STATUS MOS_UnlockMutex(PMOS_MUTEX pMutex)
 {
     MOS_STATUS eStatus = MOS_STATUS_SUCCESS;
 
-    if (pthread_mutex_unlock(pMutex))
+    if (MosLockProfile_Unlock(pMutex))
     {
         eStatus = MOS_STATUS_UNKNOWN;
     }
@@ -2686,6 +2744,25 @@ MOS_STATUS MOS_UnlockMutex(PMOS_MUTEX pMutex)
     return eStatus;
 }
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    MOS_FUNC_EXPORT void MOS_SetLockProfileEnable(bool enable)
+    {
+        MosLockProfile_Reset();
+        MosLockProfile_Enable(enable);
+    }
+
+    MOS_FUNC_EXPORT uint32_t MOS_GetLockProfileStats(PMOS_LOCK_SITE_STATS pStats, uint32_t uiMaxSites)
+    {
+        return MosLockProfile_GetStats(pStats, uiMaxSites);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
 PMOS_SEMAPHORE MOS_CreateSemaphore(
     uint32_t            uiInitialCount,
     uint32_t            uiMaximumCount)
@@ -0,0 +1,187 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+//!
+//! \file      mos_vdbox_load.h
+//! \brief     Weighted VDBox load tracking shared between processes
+//! \details   Every process that submits to VCS0/VCS1 charges the work of each
+//!            submission (in macroblocks) to a per node history kept in a SysV
+//!            shared memory segment. The history is a ring of time buckets; a
+//!            bucket packs {epoch, work} in one 64-bit word so it can be updated
+//!            with a single compare-and-swap, without taking the IPC semaphore.
+//!            Buckets older than the window are ignored and younger ones are
+//!            weighted linearly by age, which gives the load a natural decay
+//!            and makes completed work drop out without explicit bookkeeping.
+//!            The helpers are free of OS dependencies so that the policy can be
+//!            replayed by the ULT.
+//!
+
+#ifndef __MOS_VDBOX_LOAD_H__
+#define __MOS_VDBOX_LOAD_H__
+
+#include <stdint.h>
+
+#define MOS_VDBOX_LOAD_NODE_NUM         2
+#define MOS_VDBOX_LOAD_BUCKET_NUM       8
+#define MOS_VDBOX_LOAD_BUCKET_SHIFT     7   //!< 128 ms per bucket, ~1 s window
+
+//!
+//! \brief    Loads within 1/8 of each other are treated as balanced
+//!
+#define MOS_VDBOX_LOAD_TOLERANCE_SHIFT  3
+
+typedef struct _VDBOX_LOAD
+{
+    uint64_t    bucket[MOS_VDBOX_LOAD_NODE_NUM][MOS_VDBOX_LOAD_BUCKET_NUM];   //!< {epoch:32, work:32}
+} VDBOX_LOAD, *PVDBOX_LOAD;
+
+//!
+//! \brief    Charge work to a VDBox node
+//! \param    [in] load
+//!           Shared load history
+//! \param    [in] node
+//!           Node index, 0 for VCS0 and 1 for VCS1
+//! \param    [in] work
+//!           Work to charge, in macroblocks
+//! \param    [in] timeMs
+//!           Monotonic time in milliseconds, same clock in all processes
+//! \return   void
+//!
+static inline void MosVdboxLoad_Charge(
+    PVDBOX_LOAD     load,
+    uint32_t        node,
+    uint32_t        work,
+    uint64_t        timeMs)
+{
+    if (load == nullptr || node >= MOS_VDBOX_LOAD_NODE_NUM || work == 0)
+    {
+        return;
+    }
+
+    uint32_t  epoch  = (uint32_t)(timeMs >> MOS_VDBOX_LOAD_BUCKET_SHIFT);
+    uint64_t *bucket = &load->bucket[node][epoch % MOS_VDBOX_LOAD_BUCKET_NUM];
+    uint64_t  oldVal = __atomic_load_n(bucket, __ATOMIC_RELAXED);
+    uint64_t  newVal;
+
+    do
+    {
+        uint32_t oldEpoch = (uint32_t)(oldVal >> 32);
+        uint32_t oldWork  = (uint32_t)oldVal;
+
+        // A bucket left over from an earlier lap of the ring starts from zero;
+        // one a racing process already advanced past our epoch is added to.
+        if ((int32_t)(epoch - oldEpoch) > 0)
+        {
+            oldWork = 0;
+        }
+        else
+        {
+            epoch = oldEpoch;
+        }
+
+        uint32_t newWork = (oldWork > UINT32_MAX - work) ? UINT32_MAX : oldWork + work;
+        newVal = ((uint64_t)epoch << 32) | newWork;
+    } while (!__atomic_compare_exchange_n(bucket, &oldVal, newVal, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+//!
+//! \brief    Get the decayed load of a VDBox node
+//! \param    [in] load
+//!           Shared load history
+//! \param    [in] node
+//!           Node index, 0 for VCS0 and 1 for VCS1
+//! \param    [in] timeMs
+//!           Monotonic time in milliseconds
+//! \return   uint64_t
+//!           Work in the window, each bucket weighted by how recent it is
+//!
+static inline uint64_t MosVdboxLoad_Get(
+    PVDBOX_LOAD     load,
+    uint32_t        node,
+    uint64_t        timeMs)
+{
+    if (load == nullptr || node >= MOS_VDBOX_LOAD_NODE_NUM)
+    {
+        return 0;
+    }
+
+    uint32_t epoch = (uint32_t)(timeMs >> MOS_VDBOX_LOAD_BUCKET_SHIFT);
+    uint64_t sum   = 0;
+
+    for (uint32_t i = 0; i < MOS_VDBOX_LOAD_BUCKET_NUM; i++)
+    {
+        uint64_t val = __atomic_load_n(&load->bucket[node][i], __ATOMIC_RELAXED);
+        int32_t  age = (int32_t)(epoch - (uint32_t)(val >> 32));
+
+        if (age < 0)
+        {
+            age = 0;
+        }
+        if (age < MOS_VDBOX_LOAD_BUCKET_NUM)
+        {
+            sum += (uint64_t)(uint32_t)val * (MOS_VDBOX_LOAD_BUCKET_NUM - age);
+        }
+    }
+
+    return sum;
+}
+
+//!
+//! \brief    Select the least loaded VDBox node
+//! \details  Picks the node with the lower decayed load. When the loads are
+//!           within tolerance (e.g. both engines idle) the node with fewer
+//!           sessions wins, and a full tie falls back to the ping-pong index.
+//! \param    [in] load
+//!           Shared load history
+//! \param    [in] sessionCount
+//!           Sessions currently associated with each node, may be nullptr
+//! \param    [in] pingPong
+//!           Node to use when everything else is equal
+//! \param    [in] timeMs
+//!           Monotonic time in milliseconds
+//! \return   uint32_t
+//!           Node index, 0 for VCS0 and 1 for VCS1
+//!
+static inline uint32_t MosVdboxLoad_SelectNode(
+    PVDBOX_LOAD     load,
+    const uint32_t  *sessionCount,
+    uint32_t        pingPong,
+    uint64_t        timeMs)
+{
+    uint64_t load0 = MosVdboxLoad_Get(load, 0, timeMs);
+    uint64_t load1 = MosVdboxLoad_Get(load, 1, timeMs);
+    uint64_t diff  = (load0 > load1) ? load0 - load1 : load1 - load0;
+    uint64_t peak  = (load0 > load1) ? load0 : load1;
+
+    if (diff > (peak >> MOS_VDBOX_LOAD_TOLERANCE_SHIFT))
+    {
+        return (load0 < load1) ? 0 : 1;
+    }
+
+    if (sessionCount && sessionCount[0] != sessionCount[1])
+    {
+        return (sessionCount[0] < sessionCount[1]) ? 0 : 1;
+    }
+
+    return pingPong ? 1 : 0;
+}
+
+#endif // __MOS_VDBOX_LOAD_H__
@@ -248,10 +248,12 @@ MOS_STATUS RenderHal_SendSurfaces_PatchList(
     SendSurfaceParams.pIndirectStateBase  = pIndirectState;
     SendSurfaceParams.iIndirectStateBase  = IndirectStateBase;
 
-    // Send binding tables and surface states for all phases
+    // Send binding tables and surface states for all phases, the ones of the
+    // jobs already in the command buffer have been sent with them
     SendBtParams.iSurfaceStateBase = pStateHeap->iSurfaceStateOffset;
-    iBindingTableOffs = pStateHeap->iBindingTableOffset;
-    for (i = pStateHeap->iCurrentBindingTable; i > 0; i--,
+    iBindingTableOffs = pStateHeap->iBindingTableOffset +
+                        pRenderHal->BatchState.iFirstBindingTable * pStateHeap->iBindingTableSize;
+    for (i = pStateHeap->iCurrentBindingTable - pRenderHal->BatchState.iFirstBindingTable; i > 0; i--,
          iBindingTableOffs += pStateHeap->iBindingTableSize)
     {
         // Binding tables entries (input/output)
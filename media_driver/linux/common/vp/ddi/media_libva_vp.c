@@ -258,6 +258,165 @@ PVPHAL_RENDER_PARAMS VpGetRenderParams(PDDI_VP_CONTEXT pVpCtx)
     return pVpCtx->pVpHalRenderParams;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+//! \purpose Submit the render jobs batched in a VP context
+//! \details The caller holds the PendingMutex of the media context. The surfaces
+//!          of the job being built stay in the list, its Render adds the job to
+//!          the batch only after this.
+//! \params
+//! [in]  pVpCtx : VP context
+//! [out] None
+//! \returns VA_STATUS_SUCCESS if call succeeds
+/////////////////////////////////////////////////////////////////////////////////////////////
+static VAStatus DdiVp_FlushPendingRender(PDDI_VP_CONTEXT pVpCtx)
+{
+    MOS_STATUS eStatus;
+    uint32_t   uiNumSubmitted;
+
+    DDI_CHK_NULL(pVpCtx, "Null pVpCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    uiNumSubmitted = pVpCtx->uiNumPendingSurfaces - pVpCtx->uiNumJobSurfaces;
+    for (uint32_t i = 0; i < uiNumSubmitted; i++)
+    {
+        pVpCtx->pPendingSurfaces[i]->pPendingVpCtx = nullptr;
+    }
+    for (uint32_t i = 0; i < pVpCtx->uiNumJobSurfaces; i++)
+    {
+        pVpCtx->pPendingSurfaces[i] = pVpCtx->pPendingSurfaces[uiNumSubmitted + i];
+    }
+    pVpCtx->uiNumPendingSurfaces = pVpCtx->uiNumJobSurfaces;
+
+    if (pVpCtx->pVpHal == nullptr)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    DdiMediaUtil_LockMutex(&pVpCtx->RenderMutex);
+    eStatus = pVpCtx->pVpHal->FlushRenderBatch();
+    DdiMediaUtil_UnLockMutex(&pVpCtx->RenderMutex);
+
+    if (MOS_FAILED(eStatus))
+    {
+        VP_DDI_ASSERTMESSAGE("Failed to submit batched render jobs.");
+        return VA_STATUS_ERROR_OPERATION_FAILED;
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+//! \purpose Submit the render jobs batched in a VP context from its own thread
+//! \details Ends the job being built, its surfaces are submitted too
+//! \params
+//! [in]  pMediaCtx : media context
+//! [in]  pVpCtx : VP context
+//! [out] None
+//! \returns VA_STATUS_SUCCESS if call succeeds
+/////////////////////////////////////////////////////////////////////////////////////////////
+static VAStatus DdiVp_SubmitContextRender(PDDI_MEDIA_CONTEXT pMediaCtx, PDDI_VP_CONTEXT pVpCtx)
+{
+    VAStatus vaStatus;
+
+    DDI_CHK_NULL(pMediaCtx, "Null pMediaCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(pVpCtx, "Null pVpCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    DdiMediaUtil_LockMutex(&pMediaCtx->PendingMutex);
+    pVpCtx->uiNumJobSurfaces = 0;
+    vaStatus = DdiVp_FlushPendingRender(pVpCtx);
+    DdiMediaUtil_UnLockMutex(&pMediaCtx->PendingMutex);
+
+    return vaStatus;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+//! \purpose Record a surface used by the render job being built
+//! \params
+//! [in]  pVpCtx : VP context
+//! [in]  pMediaSurf : source or target surface
+//! [out] None
+//! \returns VA_STATUS_SUCCESS if call succeeds
+/////////////////////////////////////////////////////////////////////////////////////////////
+static VAStatus DdiVp_AddPendingSurface(PDDI_VP_CONTEXT pVpCtx, PDDI_MEDIA_SURFACE pMediaSurf)
+{
+    PDDI_VP_CONTEXT pOtherVpCtx;
+    uint32_t        uiFirstJobSurface;
+    VAStatus        vaStatus;
+
+    DDI_CHK_NULL(pVpCtx, "Null pVpCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
+    DDI_CHK_NULL(pMediaSurf, "Null pMediaSurf.", VA_STATUS_ERROR_INVALID_SURFACE);
+    DDI_CHK_NULL(pMediaSurf->pMediaCtx, "Null pMediaCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
+
+    if (!pVpCtx->bRenderBatch)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    vaStatus = VA_STATUS_SUCCESS;
+    DdiMediaUtil_LockMutex(&pMediaSurf->pMediaCtx->PendingMutex);
+
+    uiFirstJobSurface = pVpCtx->uiNumPendingSurfaces - pVpCtx->uiNumJobSurfaces;
+    pOtherVpCtx       = (PDDI_VP_CONTEXT)pMediaSurf->pPendingVpCtx;
+    if (pOtherVpCtx == pVpCtx)
+    {
+        // Used by a batched job too, move it to the job so that a flush from
+        // another thread before the Render keeps it
+        for (uint32_t i = 0; i < uiFirstJobSurface; i++)
+        {
+            if (pVpCtx->pPendingSurfaces[i] == pMediaSurf)
+            {
+                pVpCtx->pPendingSurfaces[i]                     = pVpCtx->pPendingSurfaces[uiFirstJobSurface - 1];
+                pVpCtx->pPendingSurfaces[uiFirstJobSurface - 1] = pMediaSurf;
+                pVpCtx->uiNumJobSurfaces++;
+                break;
+            }
+        }
+    }
+    else
+    {
+        // Jobs of another context using the surface have to reach the GPU first
+        if (pOtherVpCtx)
+        {
+            vaStatus = DdiVp_FlushPendingRender(pOtherVpCtx);
+        }
+        if (vaStatus == VA_STATUS_SUCCESS && pVpCtx->uiNumPendingSurfaces >= DDI_VP_MAX_PENDING_SURFACES)
+        {
+            vaStatus = DdiVp_FlushPendingRender(pVpCtx);
+        }
+        if (vaStatus == VA_STATUS_SUCCESS && pVpCtx->uiNumPendingSurfaces < DDI_VP_MAX_PENDING_SURFACES)
+        {
+            pVpCtx->pPendingSurfaces[pVpCtx->uiNumPendingSurfaces++] = pMediaSurf;
+            pVpCtx->uiNumJobSurfaces++;
+            pMediaSurf->pPendingVpCtx                                = pVpCtx;
+        }
+    }
+
+    DdiMediaUtil_UnLockMutex(&pMediaSurf->pMediaCtx->PendingMutex);
+
+    return vaStatus;
+}
+
+VAStatus DdiVp_SubmitPendingRender(PDDI_MEDIA_SURFACE surface)
+{
+    VAStatus vaStatus;
+
+    if (surface == nullptr || surface->pMediaCtx == nullptr || surface->pPendingVpCtx == nullptr)
+    {
+        return VA_STATUS_SUCCESS;
+    }
+
+    // The owner clears pPendingVpCtx under PendingMutex, and DdiVp_DestroyContext
+    // flushes under it before freeing the context
+    vaStatus = VA_STATUS_SUCCESS;
+    DdiMediaUtil_LockMutex(&surface->pMediaCtx->PendingMutex);
+    if (surface->pPendingVpCtx)
+    {
+        vaStatus = DdiVp_FlushPendingRender((PDDI_VP_CONTEXT)surface->pPendingVpCtx);
+    }
+    DdiMediaUtil_UnLockMutex(&surface->pMediaCtx->PendingMutex);
+
+    return vaStatus;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //! \purpose Destroy VPHAL Driver Reference Params
 //! \params
@@ -771,6 +930,9 @@ DdiVp_SetProcPipelineParams(
     DDI_CHK_NULL(pMediaSrcSurf, "Null pMediaSrcSurf.", VA_STATUS_ERROR_INVALID_BUFFER);
     DDI_CHK_NULL(pOsInterface, "Null pOsInterface.", VA_STATUS_ERROR_INVALID_BUFFER);
 
+    vaStatus = DdiVp_AddPendingSurface(pVpCtx, pMediaSrcSurf);
+    DDI_CHK_RET(vaStatus, "Failed to add pending source surface");
+
     // increment surface count
     pVpHalRenderParams->uSrcCount++;
 
@@ -1340,11 +1502,29 @@ DdiVp_InitVpHal(
 
     if (nullptr != pVpHal)
     {
+        MOS_USER_FEATURE_VALUE_DATA UserFeatureData;
+
         VpHalSettings.maxPhases                = VP_SETTING_MAX_PHASES;
         VpHalSettings.mediaStates              = VP_SETTING_MEDIA_STATES;
         VpHalSettings.sameSampleThreshold      = VP_SETTING_SAME_SAMPLE_THRESHOLD;
         VpHalSettings.disableDnDi              = false;
 
+        // Composite jobs batched in one command buffer
+        MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+        MOS_USER_FEATURE_INVALID_KEY_ASSERT(MOS_UserFeature_ReadValue_ID(
+            nullptr,
+            __VPHAL_RNDR_BATCH_SIZE_ID,
+            &UserFeatureData));
+        VpHalSettings.renderBatchSize          = UserFeatureData.u32Data;
+
+        MOS_ZeroMemory(&UserFeatureData, sizeof(UserFeatureData));
+        MOS_USER_FEATURE_INVALID_KEY_ASSERT(MOS_UserFeature_ReadValue_ID(
+            nullptr,
+            __VPHAL_RNDR_BATCH_WINDOW_ID,
+            &UserFeatureData));
+        VpHalSettings.renderBatchWindow        = UserFeatureData.u32Data;
+        pVpCtx->bRenderBatch                   = (VpHalSettings.renderBatchSize > 1);
+
         // Allocate resources (state heaps, resources, KDLL)
         if (MOS_FAILED(pVpHal->Allocate(&VpHalSettings)))
         {
@@ -2501,6 +2681,7 @@ VAStatus DdiVp_CreateContext (
     // init pVpCtx
     vaStatus = DdiVp_InitCtx(pVaDrvCtx, pVpCtx);
     DDI_CHK_RET(vaStatus, "VA_STATUS_ERROR_OPERATION_FAILED");
+    DdiMediaUtil_InitMutex(&pVpCtx->RenderMutex);
 
     DdiMediaUtil_LockMutex(&pMediaCtx->VpMutex);
 
@@ -2508,6 +2689,7 @@ VAStatus DdiVp_CreateContext (
     pVaCtxHeapElmt = DdiMediaUtil_AllocPVAContextFromHeap(pMediaCtx->pVpCtxHeap);
     if (nullptr == pVaCtxHeapElmt)
     {
+        DdiMediaUtil_DestroyMutex(&pVpCtx->RenderMutex);
         MOS_FreeMemAndSetNull(pVpCtx);
         DdiMediaUtil_UnLockMutex(&pMediaCtx->VpMutex);
         VP_DDI_ASSERTMESSAGE("VP Context number exceeds maximum.");
@@ -2567,6 +2749,9 @@ VAStatus DdiVp_DestroyContext (
         pVpCtx->pCpDdiInterface = NULL;
     }
 
+    // submit batched jobs, their surfaces must not point at a freed context
+    DdiVp_SubmitContextRender(pMediaCtx, pVpCtx);
+
     // destroy vphal
     vaStatus  = DdiVp_DestroyVpHal(pVpCtx);
 
@@ -2576,6 +2761,7 @@ VAStatus DdiVp_DestroyContext (
     // remove from context array
     DdiMediaUtil_LockMutex(&pMediaCtx->VpMutex);
     // destroy vp context
+    DdiMediaUtil_DestroyMutex(&pVpCtx->RenderMutex);
     MOS_FreeMemAndSetNull(pVpCtx);
     DdiMediaUtil_ReleasePVAContextFromHeap(pMediaCtx->pVpCtxHeap, uiVpIndex);
 
@@ -2646,6 +2832,23 @@ VAStatus DdiVp_BeginPicture(
 
     pMediaTgtSurf->pVpCtx = pVpCtx;
 
+    // A new job starts, keep room for all its surfaces in the pending list
+    if (pVpCtx->bRenderBatch && pVpHalRenderParams->uDstCount == 0)
+    {
+        vaStatus = VA_STATUS_SUCCESS;
+        DdiMediaUtil_LockMutex(&pMediaDrvCtx->PendingMutex);
+        pVpCtx->uiNumJobSurfaces = 0;
+        if (pVpCtx->uiNumPendingSurfaces + VPHAL_MAX_SOURCES + VPHAL_MAX_TARGETS > DDI_VP_MAX_PENDING_SURFACES)
+        {
+            vaStatus = DdiVp_FlushPendingRender(pVpCtx);
+        }
+        DdiMediaUtil_UnLockMutex(&pMediaDrvCtx->PendingMutex);
+        DDI_CHK_RET(vaStatus, "Failed to submit pending render jobs");
+    }
+
+    vaStatus = DdiVp_AddPendingSurface(pVpCtx, pMediaTgtSurf);
+    DDI_CHK_RET(vaStatus, "Failed to add pending render target");
+
     // Setup Target VpHal Surface
     pVpHalTgtSurf->SurfType      = SURF_OUT_RENDERTARGET;
     pVpHalTgtSurf->rcSrc.top     = 0;
@@ -2819,16 +3022,21 @@ VAStatus DdiVp_EndPicture (
         VADriverContextP    pVaDrvCtx,
         VAContextID         vaCtxID)
 {
+    PDDI_MEDIA_CONTEXT      pMediaCtx;
     PDDI_VP_CONTEXT         pVpCtx;
     uint32_t                uiCtxType;
     VphalState              *pVpHal;
     MOS_STATUS              eStatus;
+    bool                    bBatched;
 
     VP_DDI_FUNCTION_ENTER;
     DDI_CHK_NULL(pVaDrvCtx,
                     "Null pVaDrvCtx.",
                     VA_STATUS_ERROR_INVALID_CONTEXT);
 
+    pMediaCtx = DdiMedia_GetMediaContext(pVaDrvCtx);
+    DDI_CHK_NULL(pMediaCtx, "Null pMediaCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
+
     //get VP Context
     pVpCtx = (PDDI_VP_CONTEXT)DdiMedia_GetContextFromContextID (pVaDrvCtx, vaCtxID, &uiCtxType);
     DDI_CHK_NULL(pVpCtx, "Null pVpCtx.", VA_STATUS_ERROR_INVALID_CONTEXT);
@@ -2839,7 +3047,12 @@ VAStatus DdiVp_EndPicture (
 
     pVpHal  = pVpCtx->pVpHal;
     DDI_CHK_NULL(pVpHal, "Null pVpHal.", VA_STATUS_ERROR_INVALID_PARAMETER);
-    eStatus = pVpHal->Render(pVpCtx->pVpHalRenderParams);
+
+    // Another thread may submit the batch meanwhile
+    DdiMediaUtil_LockMutex(&pVpCtx->RenderMutex);
+    eStatus  = pVpHal->Render(pVpCtx->pVpHalRenderParams);
+    bBatched = pVpHal->IsRenderBatchPending();
+    DdiMediaUtil_UnLockMutex(&pVpCtx->RenderMutex);
 
 #if (_DEBUG || _RELEASE_INTERNAL)
     VpDumpProcPipelineParams(pVaDrvCtx, pVpCtx);
@@ -2856,6 +3069,18 @@ VAStatus DdiVp_EndPicture (
     // Reset render target count for next render call
     pVpCtx->pVpHalRenderParams->uDstCount = 0;
 
+    // Jobs that did not stay in the batch (e.g. VEBOX) are on the GPU already
+    if (pVpCtx->bRenderBatch)
+    {
+        DdiMediaUtil_LockMutex(&pMediaCtx->PendingMutex);
+        pVpCtx->uiNumJobSurfaces = 0;
+        if (pVpCtx->uiNumPendingSurfaces && !bBatched)
+        {
+            DdiVp_FlushPendingRender(pVpCtx);
+        }
+        DdiMediaUtil_UnLockMutex(&pMediaCtx->PendingMutex);
+    }
+
     if (MOS_FAILED(eStatus))
     {
         VP_DDI_ASSERTMESSAGE("Failed to call render function.");
@@ -2933,6 +3158,9 @@ VAStatus DdiVp_VideoProcessPipeline(
         return vaStatus;
     }
 
+    // The caller accesses the output right away
+    vaStatus = DdiVp_SubmitContextRender(DdiMedia_GetMediaContext(pVaDrvCtx), pVpCtx);
+
     MOS_FreeMemory(pInputPipelineParam);
     return vaStatus;
 }
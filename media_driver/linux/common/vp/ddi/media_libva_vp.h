@@ -56,6 +56,9 @@
 #endif
 #define NUM_SURFS 1
 
+// Surfaces read or written by the jobs batched in one VP context
+#define DDI_VP_MAX_PENDING_SURFACES  64
+
 #if (_DEBUG || _RELEASE_INTERNAL)
 typedef struct _DDI_VP_DUMP_PARAM
 {
@@ -96,6 +99,16 @@ typedef struct DDI_VP_CONTEXT
 
     DDI_VP_FRAMEID_TRACER                     FrameIDTracer;
 
+    // Render batching, surfaces of the jobs not submitted yet. The list is
+    // protected by the PendingMutex of the media context, the batch in VPHAL
+    // by RenderMutex; the surfaces of the job being built are the last
+    // uiNumJobSurfaces entries.
+    bool                                      bRenderBatch;
+    PDDI_MEDIA_SURFACE                        pPendingSurfaces[DDI_VP_MAX_PENDING_SURFACES];
+    uint32_t                                  uiNumPendingSurfaces;
+    uint32_t                                  uiNumJobSurfaces;
+    MEDIA_MUTEX_T                             RenderMutex;
+
 #if (_DEBUG || _RELEASE_INTERNAL)
     DDI_VP_DUMP_PARAM                         *pCurVpDumpDDIParam;
     DDI_VP_DUMP_PARAM                         *pPreVpDumpDDIParam;
@@ -200,5 +213,17 @@ PVPHAL_RENDER_PARAMS VpGetRenderParams(PDDI_VP_CONTEXT pVpCtx);
 
 PDDI_VP_CONTEXT DdiVp_GetVpContextFromContextID(VADriverContextP ctx, VAContextID vaCtxID);
 
+//!
+//! \brief    Submit the VP jobs batched with a surface
+//! \details  Must be called before the CPU, another context or the app accesses
+//!           a surface that a batched composite job reads or writes. Safe to call
+//!           from any thread, it serializes with the Render of the owning context.
+//! \param    [in] surface
+//!           Pointer to the media surface
+//! \return   VAStatus
+//!           VA_STATUS_SUCCESS if success, else fail reason
+//!
+VAStatus DdiVp_SubmitPendingRender(PDDI_MEDIA_SURFACE surface);
+
 #endif //_MEDIA_LIBVA_VP_H_
 
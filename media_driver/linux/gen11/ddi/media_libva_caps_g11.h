@@ -59,7 +59,7 @@ public:
     //!
     virtual VAStatus Init()
     {
-        return LoadProfileEntrypoints();
+        return LoadSharedProfileEntrypoints();
     }
 
     //!
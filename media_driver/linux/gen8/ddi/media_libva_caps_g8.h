@@ -41,10 +41,15 @@ public:
     //!
     MediaLibvaCapsG8(DDI_MEDIA_CONTEXT *mediaCtx) : MediaLibvaCaps(mediaCtx)
     {
-        LoadProfileEntrypoints();
         return;
     }
 
+    virtual VAStatus Init()
+    {
+        LoadSharedProfileEntrypoints();
+        return VA_STATUS_SUCCESS;
+    }
+
 protected:
     virtual VAStatus GetPlatformSpecificAttrib(
             VAProfile profile,
@@ -46,7 +46,7 @@ public:
 
     virtual VAStatus Init()
     {
-        LoadProfileEntrypoints();
+        LoadSharedProfileEntrypoints();
         return VA_STATUS_SUCCESS;
     }
 protected:
@@ -0,0 +1,264 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include "gtest/gtest.h"
+#include "cm_kernel_data.h"
+
+using namespace std;
+using namespace CMRT_UMD;
+
+//!
+//! \brief  HAL kernel param of a per-frame filter: scalar and surface args,
+//!         one per-thread arg, indirect data, a 26Z thread space with
+//!         coordinates and move instructions
+//!
+class CmKernelDataTest : public testing::Test
+{
+protected:
+
+    static const uint32_t m_argNum      = 8;
+    static const uint32_t m_tsWidth     = 16;
+    static const uint32_t m_tsHeight    = 8;
+    static const uint32_t m_threadNum   = m_tsWidth * m_tsHeight;
+    static const uint32_t m_waveNum     = m_tsWidth + 2 * (m_tsHeight - 1);
+    static const uint32_t m_indirectNum = 64;
+    static const uint32_t m_movInsSize  = 256;
+
+    //!
+    //! \brief  Stand-in of the kernel owning the data, CmKernelData only
+    //!         keeps the pointer
+    //!
+    CmKernelRT *Kernel()
+    {
+        return reinterpret_cast<CmKernelRT *>(&m_kernelStandIn);
+    }
+
+    static uint8_t *NewArray(uint32_t size, uint8_t seed)
+    {
+        uint8_t *data = MOS_NewArray(uint8_t, size);
+        for (uint32_t i = 0; i < size; i++)
+        {
+            data[i] = (uint8_t)(seed + i);
+        }
+        return data;
+    }
+
+    //!
+    //! \brief  Fills the param the way CmKernelRT::CreateKernelDataInternal
+    //!         does, all arrays owned by the kernel data
+    //!
+    void Populate(CmKernelData *kernelData, uint8_t seed)
+    {
+        PCM_HAL_KERNEL_PARAM param = kernelData->GetHalCmKernelData();
+
+        param->numArgs    = m_argNum;
+        param->numThreads = m_threadNum;
+        for (uint32_t i = 0; i < m_argNum; i++)
+        {
+            PCM_HAL_KERNEL_ARG_PARAM arg = &param->argParams[i];
+            arg->kind      = (i & 1) ? CM_ARGUMENT_SURFACE2D : CM_ARGUMENT_GENERAL;
+            arg->unitSize  = (i & 1) ? sizeof(uint32_t) : 16;
+            arg->unitCount = 1;
+            arg->perThread = false;
+        }
+        param->argParams[m_argNum - 1].kind      = CM_ARGUMENT_GENERAL;
+        param->argParams[m_argNum - 1].unitCount = m_threadNum;
+        param->argParams[m_argNum - 1].perThread = true;
+        for (uint32_t i = 0; i < m_argNum; i++)
+        {
+            PCM_HAL_KERNEL_ARG_PARAM arg = &param->argParams[i];
+            arg->firstValue = NewArray(arg->unitCount * arg->unitSize, (uint8_t)(seed + i));
+        }
+
+        param->indirectDataParam.indirectDataSize = m_indirectNum;
+        param->indirectDataParam.indirectData     = NewArray(m_indirectNum, seed);
+        param->indirectDataParam.surfaceCount     = 2;
+        param->indirectDataParam.surfaceInfo      = MOS_NewArray(CM_INDIRECT_SURFACE_INFO, 2);
+        memset(param->indirectDataParam.surfaceInfo, seed, 2 * sizeof(CM_INDIRECT_SURFACE_INFO));
+
+        PCM_HAL_KERNEL_THREADSPACE_PARAM threadSpace = &param->kernelThreadSpaceParam;
+        threadSpace->threadSpaceWidth  = m_tsWidth;
+        threadSpace->threadSpaceHeight = m_tsHeight;
+        threadSpace->patternType       = CM_WAVEFRONT26Z;
+        threadSpace->threadCoordinates = MOS_NewArray(CM_HAL_SCOREBOARD, m_threadNum);
+        for (uint32_t i = 0; i < m_threadNum; i++)
+        {
+            memset(&threadSpace->threadCoordinates[i], 0, sizeof(CM_HAL_SCOREBOARD));
+            threadSpace->threadCoordinates[i].x    = i % m_tsWidth;
+            threadSpace->threadCoordinates[i].y    = i / m_tsWidth;
+            threadSpace->threadCoordinates[i].mask = seed;
+        }
+        threadSpace->dispatchInfo.numWaves         = m_waveNum;
+        threadSpace->dispatchInfo.numThreadsInWave = MOS_NewArray(uint32_t, m_waveNum);
+        for (uint32_t i = 0; i < m_waveNum; i++)
+        {
+            threadSpace->dispatchInfo.numThreadsInWave[i] = seed + i;
+        }
+
+        param->movInsDataSize = m_movInsSize;
+        param->movInsData     = NewArray(m_movInsSize, seed);
+
+        SamplerParam sampler = {};
+        sampler.samplerTableIndex = seed;
+        param->samplerHeap->push_back(sampler);
+    }
+
+    //!
+    //! \brief  Checks that the clone holds the values of the source in arrays
+    //!         of its own
+    //!
+    void ExpectDeepCopy(CmKernelData *source, CmKernelData *clone)
+    {
+        PCM_HAL_KERNEL_PARAM src = source->GetHalCmKernelData();
+        PCM_HAL_KERNEL_PARAM dst = clone->GetHalCmKernelData();
+
+        ASSERT_EQ(src->numArgs, dst->numArgs);
+        for (uint32_t i = 0; i < src->numArgs; i++)
+        {
+            uint32_t size = src->argParams[i].unitCount * src->argParams[i].unitSize;
+            EXPECT_EQ(src->argParams[i].kind, dst->argParams[i].kind) << "Arg " << i;
+            EXPECT_NE(src->argParams[i].firstValue, dst->argParams[i].firstValue) << "Arg " << i;
+            EXPECT_EQ(0, memcmp(src->argParams[i].firstValue, dst->argParams[i].firstValue, size)) << "Arg " << i;
+        }
+
+        EXPECT_NE(src->indirectDataParam.indirectData, dst->indirectDataParam.indirectData);
+        EXPECT_EQ(0, memcmp(src->indirectDataParam.indirectData, dst->indirectDataParam.indirectData, m_indirectNum));
+        EXPECT_NE(src->indirectDataParam.surfaceInfo, dst->indirectDataParam.surfaceInfo);
+        EXPECT_EQ(0, memcmp(src->indirectDataParam.surfaceInfo, dst->indirectDataParam.surfaceInfo,
+                            2 * sizeof(CM_INDIRECT_SURFACE_INFO)));
+
+        PCM_HAL_KERNEL_THREADSPACE_PARAM srcTs = &src->kernelThreadSpaceParam;
+        PCM_HAL_KERNEL_THREADSPACE_PARAM dstTs = &dst->kernelThreadSpaceParam;
+        EXPECT_NE(srcTs->threadCoordinates, dstTs->threadCoordinates);
+        EXPECT_EQ(0, memcmp(srcTs->threadCoordinates, dstTs->threadCoordinates, m_threadNum * sizeof(CM_HAL_SCOREBOARD)));
+        EXPECT_NE(srcTs->dispatchInfo.numThreadsInWave, dstTs->dispatchInfo.numThreadsInWave);
+        EXPECT_EQ(0, memcmp(srcTs->dispatchInfo.numThreadsInWave, dstTs->dispatchInfo.numThreadsInWave,
+                            m_waveNum * sizeof(uint32_t)));
+
+        EXPECT_NE(src->movInsData, dst->movInsData);
+        EXPECT_EQ(0, memcmp(src->movInsData, dst->movInsData, m_movInsSize));
+
+        // The sampler heap is rebuilt by the kernel when the clone is updated
+        EXPECT_NE(src->samplerHeap, dst->samplerHeap);
+        EXPECT_TRUE(dst->samplerHeap->empty());
+    }
+
+    uint64_t m_kernelStandIn = 0;
+};
+
+TEST_F(CmKernelDataTest, CloneIsIndependent)
+{
+    CmKernelData *source = nullptr;
+    CmKernelData *clone  = nullptr;
+    ASSERT_EQ(CM_SUCCESS, CmKernelData::Create(Kernel(), source));
+    Populate(source, 0x10);
+    source->SetKernelDataSize(0x400);
+
+    ASSERT_EQ(CM_SUCCESS, CmKernelData::Clone(source, clone));
+    ASSERT_NE(nullptr, clone);
+    EXPECT_TRUE(source->IsInUse());
+    EXPECT_FALSE(clone->IsInUse());
+    EXPECT_EQ(0x400, clone->GetKernelDataSize());
+    ExpectDeepCopy(source, clone);
+
+    // Writes to the source after the clone, as a task still holding it
+    // would see, leave the clone untouched
+    PCM_HAL_KERNEL_PARAM src = source->GetHalCmKernelData();
+    PCM_HAL_KERNEL_PARAM dst = clone->GetHalCmKernelData();
+    for (uint32_t i = 0; i < m_argNum; i++)
+    {
+        memset(src->argParams[i].firstValue, 0xFF, src->argParams[i].unitCount * src->argParams[i].unitSize);
+    }
+    memset(src->indirectDataParam.indirectData, 0xFF, m_indirectNum);
+    src->kernelThreadSpaceParam.threadCoordinates[0].x = -1;
+    src->movInsData[0]                                  = 0xFF;
+    src->samplerHeap->clear();
+    for (uint32_t i = 0; i < m_argNum; i++)
+    {
+        EXPECT_EQ((uint8_t)(0x10 + i), dst->argParams[i].firstValue[0]) << "Arg " << i;
+    }
+    EXPECT_EQ(0x10, dst->indirectDataParam.indirectData[0]);
+    EXPECT_EQ(0, dst->kernelThreadSpaceParam.threadCoordinates[0].x);
+    EXPECT_EQ(0x10, dst->movInsData[0]);
+
+    // And the source outlives the clone, each freeing its own arrays
+    CmKernelData::Destroy(clone);
+    EXPECT_EQ(nullptr, clone);
+    EXPECT_EQ(0xFF, src->argParams[0].firstValue[0]);
+    CmKernelData::Destroy(source);
+    EXPECT_EQ(nullptr, source);
+}
+
+TEST_F(CmKernelDataTest, CloneNull)
+{
+    CmKernelData *clone = nullptr;
+    EXPECT_EQ(CM_NULL_POINTER, CmKernelData::Clone(nullptr, clone));
+    EXPECT_EQ(nullptr, clone);
+}
+
+//!
+//! \brief  Kernel data cost of enqueuing the same kernel again while the
+//!         previous task is in flight, with one scalar arg changed: the full
+//!         rebuild against the clone of the in-use data patched with the arg
+//!
+TEST_F(CmKernelDataTest, EnqueueRepeatBenchmark)
+{
+    const uint32_t enqueueNum = 20000;
+
+    CmKernelData *inUse = nullptr;
+    ASSERT_EQ(CM_SUCCESS, CmKernelData::Create(Kernel(), inUse));
+    Populate(inUse, 0x10);
+
+    double rebuild = 0, clone = 0;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        auto start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < enqueueNum; i++)
+        {
+            CmKernelData *kernelData = nullptr;
+            ASSERT_EQ(CM_SUCCESS, CmKernelData::Create(Kernel(), kernelData));
+            Populate(kernelData, (uint8_t)i);
+            CmKernelData::Destroy(kernelData);
+        }
+        auto mid = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < enqueueNum; i++)
+        {
+            CmKernelData *kernelData = nullptr;
+            ASSERT_EQ(CM_SUCCESS, CmKernelData::Clone(inUse, kernelData));
+            PCM_HAL_KERNEL_ARG_PARAM arg = &kernelData->GetHalCmKernelData()->argParams[0];
+            memset(arg->firstValue, (uint8_t)i, arg->unitCount * arg->unitSize);
+            CmKernelData::Destroy(kernelData);
+        }
+        auto end = chrono::steady_clock::now();
+
+        // The first pass warms up the caches and the heap
+        rebuild = chrono::duration<double, nano>(mid - start).count() / enqueueNum;
+        clone   = chrono::duration<double, nano>(end - mid).count() / enqueueNum;
+    }
+
+    CmKernelData::Destroy(inUse);
+
+    cout << "Kernel data of a repeated enqueue (" << m_argNum << " args, " << m_threadNum << " threads): "
+         << fixed << setprecision(1) << rebuild << " ns rebuilt, " << clone << " ns cloned and patched" << endl;
+}
@@ -0,0 +1,243 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <malloc.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "cm_visa.h"
+#include "kernel_test.h"
+
+using namespace std;
+
+//!
+//! \brief  Builds programs of many kernels out of the DoNothing kernel
+//!
+class CmVisaTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        vISA::ISAfile isaFile(BROADWELL_DONOTHING_ISA, sizeof(BROADWELL_DONOTHING_ISA));
+        ASSERT_TRUE(isaFile.readFile());
+
+        vISA::Kernel *kernel = isaFile.getHeader()->getKernelInfo()[0];
+        ASSERT_EQ(1u, kernel->getGenBinaryInfo().size());
+        vISA::GenBinary *binary = kernel->getGenBinaryInfo()[0];
+
+        m_nameLen     = kernel->getNameLen();
+        m_bodyOffset  = kernel->getOffset();
+        m_bodySize    = kernel->getSize();
+        m_inputOffset = kernel->getInputOffset() - m_bodyOffset;
+        m_platform    = binary->getGenPlatform();
+        m_binOffset   = binary->getBinaryOffset();
+        m_binSize     = binary->getBinarySize();
+
+        vISA::KernelBody *body = isaFile.getKernelBody(0);
+        ASSERT_NE(nullptr, body);
+        m_stringCount = body->getStringCount();
+    }
+
+    static void Append(vector<uint8_t> &program, uint32_t value, uint32_t bytes)
+    {
+        for (uint32_t i = 0; i < bytes; i++)
+        {
+            program.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+
+    //!
+    //! \brief  Program of kernels "Kernel0000", "Kernel0001", ... sharing
+    //!         one gen binary
+    //!
+    vector<uint8_t> BuildProgram(uint32_t kernelCount)
+    {
+        const uint32_t nameLen   = 10;
+        const uint32_t entrySize = 1 + nameLen + 4 * 3 + 2 + 2 + 1 + (1 + 4 + 4);
+        const uint32_t bodyStart = 4 + 1 + 1 + 2 + kernelCount * entrySize + 2 + 2;
+        const uint32_t binStart  = bodyStart + kernelCount * m_bodySize;
+
+        // magic number and version
+        vector<uint8_t> program(BROADWELL_DONOTHING_ISA, BROADWELL_DONOTHING_ISA + 6);
+        Append(program, kernelCount, 2);
+        for (uint32_t i = 0; i < kernelCount; i++)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "Kernel%04u", i % 10000);
+            Append(program, nameLen, 1);
+            program.insert(program.end(), name, name + nameLen);
+            Append(program, bodyStart + i * m_bodySize, 4);
+            Append(program, m_bodySize, 4);
+            Append(program, bodyStart + i * m_bodySize + m_inputOffset, 4);
+            Append(program, 0, 2);  // num_syms_variable
+            Append(program, 0, 2);  // num_syms_function
+            Append(program, 1, 1);  // num_gen_binaries
+            Append(program, m_platform, 1);
+            Append(program, binStart, 4);
+            Append(program, m_binSize, 4);
+        }
+        Append(program, 0, 2);      // num_variables
+        Append(program, 0, 2);      // num_functions
+        EXPECT_EQ(bodyStart, program.size());
+
+        for (uint32_t i = 0; i < kernelCount; i++)
+        {
+            program.insert(program.end(),
+                           BROADWELL_DONOTHING_ISA + m_bodyOffset,
+                           BROADWELL_DONOTHING_ISA + m_bodyOffset + m_bodySize);
+        }
+        program.insert(program.end(),
+                       BROADWELL_DONOTHING_ISA + m_binOffset,
+                       BROADWELL_DONOTHING_ISA + m_binOffset + m_binSize);
+        return program;
+    }
+
+    static size_t HeapInUse()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks;
+#else
+        return (size_t)mallinfo().uordblks;
+#endif
+    }
+
+    uint32_t m_nameLen     = 0;
+    uint32_t m_bodyOffset  = 0;
+    uint32_t m_bodySize    = 0;
+    uint32_t m_inputOffset = 0;
+    uint32_t m_platform    = 0;
+    uint32_t m_binOffset   = 0;
+    uint32_t m_binSize     = 0;
+    uint32_t m_stringCount = 0;
+};
+
+TEST_F(CmVisaTest, LazyKernelBodies)
+{
+    const uint32_t kernelCount = 16;
+
+    vector<uint8_t> program = BuildProgram(kernelCount);
+    vISA::ISAfile   isaFile(program.data(), (unsigned)program.size());
+    ASSERT_TRUE(isaFile.readFile());
+    ASSERT_EQ(kernelCount, isaFile.getHeader()->getNumKernels());
+    EXPECT_STREQ("Kernel0010", isaFile.getHeader()->getKernelInfo()[10]->getName());
+
+    vISA::KernelBody *body = isaFile.getKernelBody(10);
+    ASSERT_NE(nullptr, body);
+    EXPECT_EQ(m_stringCount, body->getStringCount());
+    EXPECT_EQ(m_stringCount, body->getStringPool().size());
+    EXPECT_STREQ("DoNothing", body->getStringPool()[0]->getString());
+    EXPECT_EQ(body, isaFile.getKernelBody(10));
+    EXPECT_EQ(nullptr, isaFile.getKernelBody(kernelCount));
+
+    // The rest are parsed from a copy after the original is gone
+    vector<uint8_t> copy = program;
+    isaFile.setBuffer(copy.data(), (unsigned)copy.size());
+    memset(program.data(), 0xff, program.size());
+
+    vector<vISA::KernelBody *> &bodies = isaFile.getKernelsData();
+    ASSERT_EQ(kernelCount, bodies.size());
+    EXPECT_EQ(body, bodies[10]);
+    for (uint32_t i = 0; i < kernelCount; i++)
+    {
+        ASSERT_NE(nullptr, bodies[i]) << "kernel " << i;
+        EXPECT_EQ(m_stringCount, bodies[i]->getStringCount());
+    }
+}
+
+TEST_F(CmVisaTest, BadOffsets)
+{
+    // Truncated anywhere before the end of the kernel body
+    for (uint32_t size = 0; size < m_bodyOffset + m_bodySize; size++)
+    {
+        vector<uint8_t> program(BROADWELL_DONOTHING_ISA, BROADWELL_DONOTHING_ISA + size);
+        vISA::ISAfile   isaFile(program.data(), size);
+        EXPECT_FALSE(isaFile.readFile()) << "size " << size;
+    }
+
+    // Kernel body past the end of the buffer
+    const uint32_t  sizeField = 4 + 1 + 1 + 2 + 1 + m_nameLen + 4;
+    vector<uint8_t> program(BROADWELL_DONOTHING_ISA, BROADWELL_DONOTHING_ISA + sizeof(BROADWELL_DONOTHING_ISA));
+    program[sizeField + 3] = 0x80;
+    {
+        vISA::ISAfile isaFile(program.data(), (unsigned)program.size());
+        EXPECT_FALSE(isaFile.readFile());
+    }
+
+    // Header claims a short body and the buffer ends inside the string pool
+    program.resize(m_bodyOffset + 20);
+    program[sizeField]     = 10;
+    program[sizeField + 1] = 0;
+    program[sizeField + 2] = 0;
+    program[sizeField + 3] = 0;
+    {
+        vISA::ISAfile isaFile(program.data(), (unsigned)program.size());
+        ASSERT_TRUE(isaFile.readFile());
+        EXPECT_EQ(nullptr, isaFile.getKernelBody(0));
+        EXPECT_EQ(nullptr, isaFile.getKernelsData()[0]);
+    }
+}
+
+//!
+//! \brief  Load time and heap of a program of many kernels of which one is
+//!         created, parsing all the bodies up front or only the one created
+//!
+TEST_F(CmVisaTest, LoadBenchmark)
+{
+    const uint32_t kernelCount = 256;
+    const uint32_t iterations  = 20;
+
+    vector<uint8_t> program = BuildProgram(kernelCount);
+
+    double eagerUs = 0, lazyUs = 0;
+    size_t eagerHeap = 0, lazyHeap = 0;
+    for (uint32_t lazy = 0; lazy < 2; lazy++)
+    {
+        auto start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            size_t        heap = HeapInUse();
+            vISA::ISAfile isaFile(program.data(), (unsigned)program.size());
+            ASSERT_TRUE(isaFile.readFile());
+            if (lazy)
+            {
+                ASSERT_NE(nullptr, isaFile.getKernelBody(kernelCount / 2));
+                lazyHeap = HeapInUse() - heap;
+            }
+            else
+            {
+                ASSERT_EQ(kernelCount, isaFile.getKernelsData().size());
+                eagerHeap = HeapInUse() - heap;
+            }
+        }
+        double us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count() / (double)iterations;
+        (lazy ? lazyUs : eagerUs) = us;
+    }
+
+    cout << kernelCount << " kernels, " << program.size() << " bytes: all bodies "
+         << eagerUs << " us " << eagerHeap << " heap bytes, one body "
+         << lazyUs << " us " << lazyHeap << " heap bytes" << endl;
+    if (eagerHeap)  // not counted under sanitizers
+    {
+        EXPECT_LT(lazyHeap, eagerHeap);
+    }
+}
@@ -0,0 +1,444 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "codec_def_common.h"
+#include "codec_def_common_encode.h"
+
+using namespace std;
+
+static const uint32_t g_guardSize = 8;
+static const uint8_t  g_guard     = 0xA5;
+
+//!
+//! \brief  The bit writers the CPU header packers used before
+//!         CodecHal_PutBits, as reference
+//!
+namespace RefWriter
+{
+    // codechal_encoder_base.h PutBit/PutBitsSub/PutBits
+    static void PutBit(BSBuffer *bsbuffer, uint32_t code)
+    {
+        if (code & 1)
+        {
+            *(bsbuffer->pCurrent) = (*(bsbuffer->pCurrent) | (uint8_t)(0x01 << (7 - bsbuffer->BitOffset)));
+        }
+
+        bsbuffer->BitOffset++;
+        if (bsbuffer->BitOffset == 8)
+        {
+            bsbuffer->BitOffset = 0;
+            bsbuffer->pCurrent++;
+            *(bsbuffer->pCurrent) = 0;
+        }
+    }
+
+    static void PutBitsSub(BSBuffer *bsbuffer, uint32_t code, uint32_t length)
+    {
+        uint8_t *byte = bsbuffer->pCurrent;
+
+        code <<= (32 - length);
+        length += bsbuffer->BitOffset;
+        code >>= bsbuffer->BitOffset;
+
+        byte[0] = (uint8_t)((code >> 24) | byte[0]);
+        byte[1] = (uint8_t)(code >> 16);
+        if (length > 16)
+        {
+            byte[2] = (uint8_t)(code >> 8);
+            byte[3] = (uint8_t)code;
+        }
+        else
+        {
+            byte[2] = 0;
+        }
+
+        bsbuffer->pCurrent += (length >> 3);
+        bsbuffer->BitOffset = (length & 7);
+    }
+
+    static void PutBits(BSBuffer *bsbuffer, uint32_t code, uint32_t length)
+    {
+        if (length >= 24)
+        {
+            PutBitsSub(bsbuffer, code >> 16, length - 16);
+            PutBitsSub(bsbuffer, code & 0xFFFF, 16);
+        }
+        else
+        {
+            PutBitsSub(bsbuffer, code, length);
+        }
+    }
+
+    // codechal_encode_avc_base.cpp PutVLCCode
+    static void PutVLCCode(BSBuffer *bsbuffer, uint32_t code)
+    {
+        uint32_t code1    = code + 1;
+        uint8_t  bitcount = 0;
+        while (code1)
+        {
+            code1 >>= 1;
+            bitcount++;
+        }
+
+        if (bitcount == 1)
+        {
+            PutBit(bsbuffer, 1);
+        }
+        else
+        {
+            uint8_t  leadingZeroBits = bitcount - 1;
+            uint32_t bits            = code + 1 - (1 << leadingZeroBits);
+            PutBits(bsbuffer, 1, leadingZeroBits + 1);
+            PutBits(bsbuffer, bits, leadingZeroBits);
+        }
+    }
+
+    // media_libvpx_vp9.cpp vp9_wb_write_literal
+    static void Vp9WriteLiteral(uint8_t *buffer, uint32_t &bitOffset, uint32_t data, uint32_t bits)
+    {
+        for (int32_t bit = (int32_t)bits - 1; bit >= 0; bit--)
+        {
+            const uint32_t p = bitOffset / 8;
+            const uint32_t q = 7 - bitOffset % 8;
+            const uint32_t b = (data >> bit) & 1;
+            if (q == 7)
+            {
+                buffer[p] = (uint8_t)(b << q);
+            }
+            else
+            {
+                buffer[p] &= ~(1 << q);
+                buffer[p] |= b << q;
+            }
+            bitOffset++;
+        }
+    }
+}
+
+//!
+//! \brief  Random code sequences written with CodecHal_PutBits/PutUe and
+//!         with the reference writers
+//! \details The reference buffers get slack because the old writers store
+//!          past the last bit. The buffer of CodecHal_PutBits is exactly as
+//!          long as the written bits, with guard bytes behind it.
+//!
+class CodecBitWriterTest : public testing::Test
+{
+protected:
+
+    struct Code
+    {
+        uint32_t value;
+        uint32_t length;
+    };
+
+    static void InitBuffer(BSBuffer &bsBuffer, vector<uint8_t> &data)
+    {
+        memset(&bsBuffer, 0, sizeof(bsBuffer));
+        bsBuffer.pBase    = data.data();
+        bsBuffer.pCurrent = data.data();
+    }
+
+    static uint32_t BitCount(const BSBuffer &bsBuffer)
+    {
+        return (uint32_t)(bsBuffer.pCurrent - bsBuffer.pBase) * 8 + bsBuffer.BitOffset;
+    }
+
+    //!
+    //! \brief  Codes of 1 to 32 bits, biased to the short ones of headers
+    //!
+    vector<Code> RandomCodes(uint32_t count)
+    {
+        vector<Code> codes(count);
+        for (auto &code : codes)
+        {
+            code.length = (m_rand() % 4) ? 1 + m_rand() % 8 : 1 + m_rand() % 32;
+            code.value  = (uint32_t)m_rand();
+        }
+        return codes;
+    }
+
+    //!
+    //! \brief  Buffer of the exact size of the bits, followed by guard bytes
+    //!
+    static vector<uint8_t> GuardedBuffer(uint32_t bits)
+    {
+        vector<uint8_t> data((bits + 7) / 8 + g_guardSize, g_guard);
+        return data;
+    }
+
+    static void CheckGuard(const vector<uint8_t> &data, uint32_t bits, uint32_t iteration)
+    {
+        for (size_t i = (bits + 7) / 8; i < data.size(); i++)
+        {
+            ASSERT_EQ(g_guard, data[i]) << "iteration " << iteration << ": written past the last bit at byte " << i;
+        }
+    }
+
+    mt19937 m_rand{ 20180601 };
+};
+
+TEST_F(CodecBitWriterTest, PutBitsMatchesPutBitsSub)
+{
+    for (uint32_t iteration = 0; iteration < 2000; iteration++)
+    {
+        vector<Code> codes = RandomCodes(1 + m_rand() % 64);
+        uint32_t     bits  = 0;
+        for (auto &code : codes)
+        {
+            bits += code.length;
+        }
+
+        vector<uint8_t> ref(bits / 8 + 8, 0);
+        BSBuffer        refBuffer;
+        InitBuffer(refBuffer, ref);
+        for (auto &code : codes)
+        {
+            RefWriter::PutBits(&refBuffer, code.value & (uint32_t)((1ull << code.length) - 1), code.length);
+        }
+
+        vector<uint8_t> out = GuardedBuffer(bits);
+        BSBuffer        outBuffer;
+        InitBuffer(outBuffer, out);
+        for (auto &code : codes)
+        {
+            CodecHal_PutBits(&outBuffer, code.value, code.length);
+        }
+
+        ASSERT_EQ(bits, BitCount(refBuffer));
+        ASSERT_EQ(bits, BitCount(outBuffer));
+        ASSERT_EQ(0, memcmp(ref.data(), out.data(), (bits + 7) / 8)) << "iteration " << iteration;
+        CheckGuard(out, bits, iteration);
+    }
+}
+
+TEST_F(CodecBitWriterTest, PutUeMatchesPutVLCCode)
+{
+    for (uint32_t iteration = 0; iteration < 2000; iteration++)
+    {
+        vector<uint32_t> values(1 + m_rand() % 32);
+        for (auto &value : values)
+        {
+            // Mostly small, some up to the 63-bit codes split over three writes
+            uint32_t shift = (m_rand() % 4) ? m_rand() % 8 : m_rand() % 32;
+            value          = (uint32_t)m_rand() >> (31 - shift);
+            value          = (value == 0xFFFFFFFF) ? 0 : value;
+        }
+
+        vector<uint8_t> ref(values.size() * 8 + 8, 0);
+        BSBuffer        refBuffer;
+        InitBuffer(refBuffer, ref);
+        for (auto value : values)
+        {
+            RefWriter::PutVLCCode(&refBuffer, value);
+        }
+        uint32_t bits = BitCount(refBuffer);
+
+        vector<uint8_t> out = GuardedBuffer(bits);
+        BSBuffer        outBuffer;
+        InitBuffer(outBuffer, out);
+        for (auto value : values)
+        {
+            CodecHal_PutUe(&outBuffer, value);
+        }
+
+        ASSERT_EQ(bits, BitCount(outBuffer)) << "iteration " << iteration;
+        ASSERT_EQ(0, memcmp(ref.data(), out.data(), (bits + 7) / 8)) << "iteration " << iteration;
+        CheckGuard(out, bits, iteration);
+    }
+}
+
+TEST_F(CodecBitWriterTest, PutBitsMatchesVp9Literal)
+{
+    for (uint32_t iteration = 0; iteration < 2000; iteration++)
+    {
+        vector<Code> codes = RandomCodes(1 + m_rand() % 64);
+        uint32_t     bits  = 0;
+        for (auto &code : codes)
+        {
+            // The VP9 header writes literals of up to 16 bits
+            code.length = 1 + code.length % 16;
+            bits += code.length;
+        }
+
+        // The VP9 writer is exact, so both get guard bytes
+        vector<uint8_t> ref    = GuardedBuffer(bits);
+        uint32_t        refBit = 0;
+        for (auto &code : codes)
+        {
+            RefWriter::Vp9WriteLiteral(ref.data(), refBit, code.value, code.length);
+        }
+
+        vector<uint8_t> out = GuardedBuffer(bits);
+        BSBuffer        outBuffer;
+        InitBuffer(outBuffer, out);
+        for (auto &code : codes)
+        {
+            CodecHal_PutBits(&outBuffer, code.value, code.length);
+        }
+
+        ASSERT_EQ(refBit, BitCount(outBuffer));
+        ASSERT_EQ(ref, out) << "iteration " << iteration;
+    }
+}
+
+//!
+//! \brief  A write ending on a byte boundary leaves the next byte alone,
+//!         and the next write ignores whatever the buffer held there
+//!
+TEST_F(CodecBitWriterTest, ByteBoundary)
+{
+    uint8_t  data[3] = { 0, g_guard, g_guard };
+    BSBuffer bsBuffer;
+    memset(&bsBuffer, 0, sizeof(bsBuffer));
+    bsBuffer.pBase    = data;
+    bsBuffer.pCurrent = data;
+
+    CodecHal_PutBits(&bsBuffer, 0x5, 3);
+    CodecHal_PutBits(&bsBuffer, 0x1F, 5);
+    EXPECT_EQ(0xBF, data[0]);
+    EXPECT_EQ(g_guard, data[1]);
+    EXPECT_EQ(data + 1, bsBuffer.pCurrent);
+    EXPECT_EQ(0, bsBuffer.BitOffset);
+
+    CodecHal_PutBits(&bsBuffer, 0x1, 1);
+    EXPECT_EQ(0x80, data[1]);
+    EXPECT_EQ(g_guard, data[2]);
+
+    CodecHal_ByteAlign(&bsBuffer);
+    EXPECT_EQ(0x80, data[1]);
+    EXPECT_EQ(g_guard, data[2]);
+    EXPECT_EQ(data + 2, bsBuffer.pCurrent);
+}
+
+//!
+//! \brief  The writes of CodechalEncodeAvcBase::PackSliceHeader for a CABAC
+//!         P slice with deblocking control, no reordering and no weights
+//!
+template <class Writer>
+static void PackPSliceHeader(BSBuffer *bsBuffer, uint32_t firstMb, uint32_t frameNum, int32_t qpDelta)
+{
+    Writer::ByteAlign(bsBuffer);
+
+    // SetNalUnit: start code and the header of a reference non-IDR slice
+    uint8_t *byte = bsBuffer->pCurrent;
+    *byte++ = 0;
+    *byte++ = 0;
+    *byte++ = 1;
+    *byte++ = (uint8_t)((1 << 5) | 1);
+    *byte   = 0;
+    bsBuffer->pCurrent = byte;
+
+    Writer::PutUe(bsBuffer, firstMb);                  // first_mb_in_slice
+    Writer::PutUe(bsBuffer, 5);                        // slice_type P, all slices
+    Writer::PutUe(bsBuffer, 0);                        // pic_parameter_set_id
+    Writer::PutBits(bsBuffer, frameNum & 0xFF, 8);     // frame_num
+    Writer::PutBits(bsBuffer, (frameNum * 2) & 0xFF, 8); // pic_order_cnt_lsb
+    Writer::PutBit(bsBuffer, 1);                       // num_ref_idx_active_override_flag
+    Writer::PutUe(bsBuffer, 0);                        // num_ref_idx_l0_active_minus1
+    Writer::PutBit(bsBuffer, 0);                       // ref_pic_list_reordering_flag_l0
+    Writer::PutBit(bsBuffer, 0);                       // adaptive_ref_pic_marking_mode_flag
+    Writer::PutUe(bsBuffer, 0);                        // cabac_init_idc
+    Writer::PutUe(bsBuffer, SIGNED(qpDelta));          // slice_qp_delta
+    Writer::PutUe(bsBuffer, 0);                        // disable_deblocking_filter_idc
+    Writer::PutUe(bsBuffer, SIGNED(2));                // slice_alpha_c0_offset_div2
+    Writer::PutUe(bsBuffer, SIGNED(2));                // slice_beta_offset_div2
+}
+
+struct RefSliceWriter
+{
+    static void PutBit(BSBuffer *bsBuffer, uint32_t code) { RefWriter::PutBit(bsBuffer, code); }
+    static void PutBits(BSBuffer *bsBuffer, uint32_t code, uint32_t length) { RefWriter::PutBits(bsBuffer, code, length); }
+    static void PutUe(BSBuffer *bsBuffer, uint32_t code) { RefWriter::PutVLCCode(bsBuffer, code); }
+
+    // The bit at a time alignment of the packers before CodecHal_ByteAlign
+    static void ByteAlign(BSBuffer *bsBuffer)
+    {
+        while (bsBuffer->BitOffset)
+        {
+            RefWriter::PutBit(bsBuffer, 0);
+        }
+    }
+};
+
+struct SliceWriter
+{
+    static void PutBit(BSBuffer *bsBuffer, uint32_t code) { CodecHal_PutBits(bsBuffer, code, 1); }
+    static void PutBits(BSBuffer *bsBuffer, uint32_t code, uint32_t length) { CodecHal_PutBits(bsBuffer, code, length); }
+    static void PutUe(BSBuffer *bsBuffer, uint32_t code) { CodecHal_PutUe(bsBuffer, code); }
+    static void ByteAlign(BSBuffer *bsBuffer) { CodecHal_ByteAlign(bsBuffer); }
+};
+
+//!
+//! \brief  Slice headers of a 1080p frame cut in slices of 8 MBs, packed
+//!         with the old writers and with CodecHal_PutBits
+//!
+TEST_F(CodecBitWriterTest, SliceHeaderBenchmark)
+{
+    const uint32_t mbNum    = 120 * 68;
+    const uint32_t sliceNum = mbNum / 8;
+    const uint32_t frameNum = 200;
+
+    vector<uint8_t> ref(sliceNum * 32 + 8, 0);
+    vector<uint8_t> out(sliceNum * 32 + 8, 0);
+    BSBuffer        refBuffer, outBuffer;
+
+    double refNs = 0, outNs = 0;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        auto start = chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < frameNum; frame++)
+        {
+            InitBuffer(refBuffer, ref);
+            for (uint32_t slice = 0; slice < sliceNum; slice++)
+            {
+                PackPSliceHeader<RefSliceWriter>(&refBuffer, slice * 8, frame, (int32_t)(slice % 7) - 3);
+            }
+        }
+        auto mid = chrono::steady_clock::now();
+        for (uint32_t frame = 0; frame < frameNum; frame++)
+        {
+            InitBuffer(outBuffer, out);
+            for (uint32_t slice = 0; slice < sliceNum; slice++)
+            {
+                PackPSliceHeader<SliceWriter>(&outBuffer, slice * 8, frame, (int32_t)(slice % 7) - 3);
+            }
+        }
+        auto end = chrono::steady_clock::now();
+
+        // The first pass warms up the caches
+        refNs = chrono::duration<double, nano>(mid - start).count() / (frameNum * sliceNum);
+        outNs = chrono::duration<double, nano>(end - mid).count() / (frameNum * sliceNum);
+    }
+
+    uint32_t bits = BitCount(refBuffer);
+    ASSERT_EQ(bits, BitCount(outBuffer));
+    ASSERT_EQ(0, memcmp(ref.data(), out.data(), (bits + 7) / 8));
+
+    cout << "AVC P slice headers, " << sliceNum << " slices per frame: " << fixed << setprecision(1)
+         << refNs << " ns with PutBitsSub, " << outNs << " ns with CodecHal_PutBits per slice" << endl;
+}
@@ -111,3 +111,85 @@ TEST_F(MediaCapsDdiTest, DecodeEncodeProfile)
             << ", Failed function = m_driverLoader.CloseDriver" << endl;
     }
 }
+
+int Test_GetConfigAttributes(VADriverContextP ctx, vector<FeatureID> &featureIDTable, vector<uint32_t> &attribValues)
+{
+    VAConfigAttrib attribList[VAConfigAttribTypeMax];
+
+    for (auto it = featureIDTable.begin(); it != featureIDTable.end(); ++it)
+    {
+        for (int i = 0; i < VAConfigAttribTypeMax; i++)
+        {
+            attribList[i].type  = (VAConfigAttribType)i;
+            attribList[i].value = 0;
+        }
+
+        int ret = ctx->vtable->vaGetConfigAttributes(ctx, it->profile, it->entrypoint, attribList, VAConfigAttribTypeMax);
+        if (ret)
+        {
+            return ret;
+        }
+
+        for (int i = 0; i < VAConfigAttribTypeMax; i++)
+        {
+            attribValues.push_back(attribList[i].value);
+        }
+    }
+
+    return VA_STATUS_SUCCESS;
+}
+
+//!
+//! \brief  The first display builds the caps snapshot, the second adopts it
+//! \details Under the ULT flag the driver checks every lookup of the flattened
+//!          attribute lists against the std::map path they replace while
+//!          building the snapshot, and fails vaInitialize on a difference.
+//!          The second display is held against the RefCapsTable reference and
+//!          must answer vaGetConfigAttributes like the first.
+//!
+TEST_F(MediaCapsDdiTest, SharedCapsSnapshot)
+{
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+
+    for (int i = 0; i < m_driverLoader.GetPlatformNum(); i++)
+    {
+        // The second display of the same device adopts the caps tables built by the first one
+        DriverDllLoader   secondLoader;
+        vector<FeatureID> firstFeatureIDTable;
+        vector<FeatureID> secondFeatureIDTable;
+        vector<uint32_t>  firstAttribValues;
+        vector<uint32_t>  secondAttribValues;
+        vector<FeatureID> refFeatureIDTable = m_capsData.GetRefFeatureIDTable(DeviceConfigTable[platforms[i]]);
+
+        int ret = m_driverLoader.InitDriver(platforms[i]);
+        ASSERT_EQ(VA_STATUS_SUCCESS , ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = m_driverLoader.InitDriver, flattened caps differ from the maps?" << endl;
+
+        ret = secondLoader.InitDriver(platforms[i]);
+        EXPECT_EQ(VA_STATUS_SUCCESS , ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = secondLoader.InitDriver" << endl;
+
+        ret = Test_QueryConfigProfiles(&m_driverLoader.m_ctx, firstFeatureIDTable);
+        EXPECT_EQ(VA_STATUS_SUCCESS , ret);
+        ret = Test_QueryConfigProfiles(&secondLoader.m_ctx, secondFeatureIDTable);
+        EXPECT_EQ(VA_STATUS_SUCCESS , ret);
+
+        ret = Test_GetConfigAttributes(&m_driverLoader.m_ctx, firstFeatureIDTable, firstAttribValues);
+        EXPECT_EQ(VA_STATUS_SUCCESS , ret);
+        ret = Test_GetConfigAttributes(&secondLoader.m_ctx, firstFeatureIDTable, secondAttribValues);
+        EXPECT_EQ(VA_STATUS_SUCCESS , ret);
+
+        EXPECT_TRUE((CompareFeatureIDTable(secondFeatureIDTable, refFeatureIDTable))) << "Platform = "
+            << g_platformName[platforms[i]] << ", Failed function = CompareFeatureIDTable" << endl;
+        EXPECT_TRUE(firstAttribValues == secondAttribValues) << "Platform = "
+            << g_platformName[platforms[i]] << ", Failed function = Test_GetConfigAttributes" << endl;
+
+        ret = secondLoader.CloseDriver(false);
+        EXPECT_EQ (VA_STATUS_SUCCESS , ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = secondLoader.CloseDriver" << endl;
+
+        ret = m_driverLoader.CloseDriver();
+        EXPECT_EQ (VA_STATUS_SUCCESS , ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = m_driverLoader.CloseDriver" << endl;
+    }
+}
@@ -0,0 +1,235 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <thread>
+#include "ddi_test_decode.h"
+
+using namespace std;
+
+static const int64_t g_poolIdleTimeMs = 100;
+
+//!
+//! \brief  AVC streams decoded on contexts taken from the decode context pool
+//! \details The pooled contexts are told apart from new ones by the memory
+//!          allocation counter of the driver: a parked context keeps its
+//!          allocations until it is reused or evicted.
+//!
+class MediaDecodeContextPoolDdiTest : public testing::Test
+{
+protected:
+
+    //!
+    //! \brief  Loads the driver with a pool of two contexts
+    //! \return bool
+    //!         false if the test cannot run on the platform
+    //!
+    bool InitDriver(Platform_t platform)
+    {
+        m_driverLoader.SetUserFeature("Decode Context Pool Size", 2);
+        m_driverLoader.SetUserFeature("Decode Context Pool Idle Time", g_poolIdleTimeMs);
+        int ret = m_driverLoader.InitDriver(platform);
+        m_driverLoader.ClearUserFeatures();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = m_driverLoader.InitDriver" << endl;
+        if (ret != VA_STATUS_SUCCESS)
+        {
+            return false;
+        }
+        if (!m_driverLoader.UserFeaturesForced())
+        {
+            cout << "The driver cannot force user features, skipped" << endl;
+            m_driverLoader.CloseDriver();
+            return false;
+        }
+        return true;
+    }
+
+    int32_t MemCounter()
+    {
+        return m_driverLoader.GetDriverSymbols().MOS_GetMemNinjaCounter();
+    }
+
+    VAContextID CreateContext(DecTestData *decData, VAConfigID config)
+    {
+        VADriverContextP     ctx       = &m_driverLoader.m_ctx;
+        vector<VASurfaceID> &resources = decData->GetResources();
+        VAContextID          context   = VA_INVALID_ID;
+
+        int ret = ctx->vtable->vaCreateContext(ctx, config, decData->GetWidth(), decData->GetHeight(),
+            VA_PROGRESSIVE, &resources[0], resources.size(), &context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateContext" << endl;
+        return context;
+    }
+
+    //!
+    //! \brief  Decodes all frames of the test data and waits for each of them
+    //!
+    void DecodeStream(DecTestData *decData, VAContextID context, Platform_t platform)
+    {
+        VADriverContextP              ctx       = &m_driverLoader.m_ctx;
+        vector<VASurfaceID>          &resources = decData->GetResources();
+        vector<vector<CompBufConif>> &compBufs  = decData->GetCompBuffers();
+
+        CmdValidator::GpuCmdsValidationInit(g_gpuCmdFactoryDecodeAVCLong, platform);
+
+        for (int i = 0; i < decData->m_num_frames; i++)
+        {
+            int ret = ctx->vtable->vaBeginPicture(ctx, context, resources[0]);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaBeginPicture" << endl;
+
+            for (int j = 0; j < compBufs[i].size(); j++)
+            {
+                ret = ctx->vtable->vaCreateBuffer(ctx, context, compBufs[i][j].bufType, compBufs[i][j].bufSize, 1,
+                    compBufs[i][j].pData, &compBufs[i][j].bufID);
+                EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+            }
+
+            decData->UpdateCompBuffers(i);
+            for (int j = 0; j < compBufs[i].size(); j++)
+            {
+                ret = ctx->vtable->vaRenderPicture(ctx, context, &compBufs[i][j].bufID, 1);
+                EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaRenderPicture" << endl;
+            }
+
+            ret = ctx->vtable->vaEndPicture(ctx, context);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaEndPicture" << endl;
+
+            VASurfaceStatus surfaceStatus;
+            do
+            {
+                ret = ctx->vtable->vaQuerySurfaceStatus(ctx, resources[0], &surfaceStatus);
+            } while (ret == VA_STATUS_SUCCESS && surfaceStatus != VASurfaceReady);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaQuerySurfaceStatus" << endl;
+
+            for (int j = 0; j < compBufs[i].size(); j++)
+            {
+                ctx->vtable->vaDestroyBuffer(ctx, compBufs[i][j].bufID);
+            }
+        }
+    }
+
+    DriverDllLoader     m_driverLoader;
+    DecTestDataFactory  m_decDataFactory;
+    DecodeTestConfig    m_decTestCfg;
+};
+
+//!
+//! \brief  A stream decoded on a pooled context emits the commands of a
+//!         stream decoded on a new one
+//!
+TEST_F(MediaDecodeContextPoolDdiTest, ReusedContextDecodes)
+{
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int i = 0; i < m_driverLoader.GetPlatformNum(); i++)
+    {
+        DecTestData *decData = m_decDataFactory.GetDecTestData("AVC-Long");
+        if (!m_decTestCfg.IsDecTestEnabled(DeviceConfigTable[platforms[i]], decData->GetFeatureID()) ||
+            !InitDriver(platforms[i]))
+        {
+            delete decData;
+            continue;
+        }
+
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+        VAConfigID       config;
+        int ret = ctx->vtable->vaCreateConfig(ctx, decData->GetFeatureID().profile, decData->GetFeatureID().entrypoint,
+            (VAConfigAttrib *)&(decData->GetConfAttrib()[0]), decData->GetConfAttrib().size(), &config);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateConfig" << endl;
+
+        vector<VASurfaceID> &resources = decData->GetResources();
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, decData->GetWidth(), decData->GetHeight(),
+            &resources[0], resources.size(), nullptr, 0);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+
+        VAContextID context = CreateContext(decData, config);
+        DecodeStream(decData, context, platforms[i]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, context));
+        int32_t parked = MemCounter();
+
+        // Taking the parked context allocates nothing, the stream state is reset
+        context = CreateContext(decData, config);
+        EXPECT_LE(MemCounter(), parked) << "Platform = " << g_platformName[platforms[i]]
+            << ", the context is not taken from the pool" << endl;
+        DecodeStream(decData, context, platforms[i]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, context));
+
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &resources[0], resources.size()));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyConfig(ctx, config));
+        delete decData;
+
+        ret = m_driverLoader.CloseDriver();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = m_driverLoader.CloseDriver" << endl;
+    }
+}
+
+//!
+//! \brief  A parked context is destroyed once its idle time is over,
+//!         without any further call into the driver
+//!
+TEST_F(MediaDecodeContextPoolDdiTest, IdleContextEvicted)
+{
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int i = 0; i < m_driverLoader.GetPlatformNum(); i++)
+    {
+        DecTestData *decData = m_decDataFactory.GetDecTestData("AVC-Long");
+        if (!m_decTestCfg.IsDecTestEnabled(DeviceConfigTable[platforms[i]], decData->GetFeatureID()) ||
+            !InitDriver(platforms[i]))
+        {
+            delete decData;
+            continue;
+        }
+
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+        VAConfigID       config;
+        int ret = ctx->vtable->vaCreateConfig(ctx, decData->GetFeatureID().profile, decData->GetFeatureID().entrypoint,
+            (VAConfigAttrib *)&(decData->GetConfAttrib()[0]), decData->GetConfAttrib().size(), &config);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateConfig" << endl;
+
+        vector<VASurfaceID> &resources = decData->GetResources();
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, decData->GetWidth(), decData->GetHeight(),
+            &resources[0], resources.size(), nullptr, 0);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+
+        VAContextID context = CreateContext(decData, config);
+        DecodeStream(decData, context, platforms[i]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, context));
+        int32_t parked = MemCounter();
+
+        bool evicted = false;
+        for (int32_t waited = 0; !evicted && waited < 20 * g_poolIdleTimeMs; waited += 10)
+        {
+            this_thread::sleep_for(chrono::milliseconds(10));
+            evicted = MemCounter() < parked;
+        }
+        EXPECT_TRUE(evicted) << "Platform = " << g_platformName[platforms[i]]
+            << ", the parked context is kept past its idle time" << endl;
+
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &resources[0], resources.size()));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyConfig(ctx, config));
+        delete decData;
+
+        ret = m_driverLoader.CloseDriver();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = m_driverLoader.CloseDriver" << endl;
+    }
+}
@@ -0,0 +1,267 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <vector>
+#include "cmd_validator.h"
+#include "driver_loader.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+class MediaDecodeJpegBatchDdiTest : public testing::Test
+{
+protected:
+
+    //!
+    //! \brief  Loads the driver with the JPEG decode batch size forced
+    //! \return bool
+    //!         false if the test cannot run on the platform
+    //!
+    bool InitDriver(Platform_t platform, uint32_t batchSize);
+
+    //!
+    //! \brief  Decodes the pictures of a synthetic 64x64 4:2:0 baseline
+    //!         JPEG round robin into the surfaces
+    //! \return double
+    //!         CPU seconds spent from the first vaBeginPicture to the last
+    //!         vaEndPicture, negative on failure
+    //!
+    double DecodePictures(Platform_t platform, uint32_t pictureNum);
+
+    DriverDllLoader m_driverLoader;
+};
+
+static double GetProcessCpuTime()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+bool MediaDecodeJpegBatchDdiTest::InitDriver(Platform_t platform, uint32_t batchSize)
+{
+    // The batch size is read when the context allocates the codec
+    m_driverLoader.SetUserFeature("JPEG Decode Batch Size", batchSize);
+    int ret = m_driverLoader.InitDriver(platform);
+    m_driverLoader.ClearUserFeatures();
+    EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+        << ", Failed function = m_driverLoader.InitDriver" << endl;
+    if (ret != VA_STATUS_SUCCESS)
+    {
+        return false;
+    }
+    if (!m_driverLoader.UserFeaturesForced())
+    {
+        cout << "The driver cannot force user features, skipped" << endl;
+        m_driverLoader.CloseDriver();
+        return false;
+    }
+    return true;
+}
+
+double MediaDecodeJpegBatchDdiTest::DecodePictures(Platform_t platform, uint32_t pictureNum)
+{
+    const uint32_t width      = 64;
+    const uint32_t height     = 64;
+    const uint32_t surfaceNum = 16;
+
+    VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+    VAConfigID config_id;
+    if (ctx->vtable->vaCreateConfig(ctx, VAProfileJPEGBaseline, VAEntrypointVLD, nullptr, 0, &config_id) != VA_STATUS_SUCCESS)
+    {
+        return -1.0;
+    }
+
+    vector<VASurfaceID> surfaces(surfaceNum, VA_INVALID_ID);
+    int ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, width, height, &surfaces[0], surfaceNum, nullptr, 0);
+    EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+        << ", Failed function = vaCreateSurfaces2" << endl;
+
+    VAContextID context_id;
+    ret = ctx->vtable->vaCreateContext(ctx, config_id, width, height, VA_PROGRESSIVE, &surfaces[0], surfaceNum, &context_id);
+    EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+        << ", Failed function = vaCreateContext" << endl;
+
+    VAPictureParameterBufferJPEGBaseline picParam;
+    memset(&picParam, 0, sizeof(picParam));
+    picParam.picture_width  = width;
+    picParam.picture_height = height;
+    picParam.num_components = 3;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        picParam.components[i].component_id             = i + 1;
+        picParam.components[i].h_sampling_factor        = (i == 0) ? 2 : 1;
+        picParam.components[i].v_sampling_factor        = (i == 0) ? 2 : 1;
+        picParam.components[i].quantiser_table_selector = (i == 0) ? 0 : 1;
+    }
+
+    // Every picture carries the same tables, as the frames of an MJPEG stream do
+    VAIQMatrixBufferJPEGBaseline iqMatrix;
+    memset(&iqMatrix, 0, sizeof(iqMatrix));
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        iqMatrix.load_quantiser_table[i] = 1;
+        for (uint32_t j = 0; j < 64; j++)
+        {
+            iqMatrix.quantiser_table[i][j] = (uint8_t)(1 + (j >> 2) + i * 4);
+        }
+    }
+
+    VAHuffmanTableBufferJPEGBaseline huffmanTable;
+    memset(&huffmanTable, 0, sizeof(huffmanTable));
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        huffmanTable.load_huffman_table[i] = 1;
+        for (uint32_t j = 0; j < 12; j++)
+        {
+            huffmanTable.huffman_table[i].num_dc_codes[j] = (j == 2) ? 1 : 0;
+            huffmanTable.huffman_table[i].dc_values[j]    = (uint8_t)j;
+        }
+        huffmanTable.huffman_table[i].num_ac_codes[1] = 2;
+        huffmanTable.huffman_table[i].ac_values[0]    = 0x00;
+        huffmanTable.huffman_table[i].ac_values[1]    = 0x01;
+    }
+
+    uint8_t sliceData[256];
+    memset(sliceData, 0, sizeof(sliceData));
+
+    VASliceParameterBufferJPEGBaseline sliceParam;
+    memset(&sliceParam, 0, sizeof(sliceParam));
+    sliceParam.slice_data_size = sizeof(sliceData);
+    sliceParam.slice_data_flag = VA_SLICE_DATA_FLAG_ALL;
+    sliceParam.num_components  = 3;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        sliceParam.components[i].component_selector = i + 1;
+        sliceParam.components[i].dc_table_selector  = (i == 0) ? 0 : 1;
+        sliceParam.components[i].ac_table_selector  = (i == 0) ? 0 : 1;
+    }
+    sliceParam.num_mcus = (width / 16) * (height / 16);
+
+    CompBufConif compBufs[] = {
+        { VAPictureParameterBufferType,  sizeof(picParam),     &picParam,     VA_INVALID_ID },
+        { VAIQMatrixBufferType,          sizeof(iqMatrix),     &iqMatrix,     VA_INVALID_ID },
+        { VAHuffmanTableBufferType,      sizeof(huffmanTable), &huffmanTable, VA_INVALID_ID },
+        { VASliceParameterBufferType,    sizeof(sliceParam),   &sliceParam,   VA_INVALID_ID },
+        { VASliceDataBufferType,         sizeof(sliceData),    sliceData,     VA_INVALID_ID },
+    };
+    const uint32_t compBufNum = sizeof(compBufs) / sizeof(compBufs[0]);
+
+    double start = GetProcessCpuTime();
+    for (uint32_t i = 0; i < pictureNum; i++)
+    {
+        VASurfaceID surface = surfaces[i % surfaceNum];
+        ret = ctx->vtable->vaBeginPicture(ctx, context_id, surface);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = vaBeginPicture" << endl;
+
+        for (uint32_t j = 0; j < compBufNum; j++)
+        {
+            ret = ctx->vtable->vaCreateBuffer(ctx, context_id, compBufs[j].bufType, compBufs[j].bufSize, 1,
+                compBufs[j].pData, &compBufs[j].bufID);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+                << ", Failed function = vaCreateBuffer" << endl;
+        }
+        for (uint32_t j = 0; j < compBufNum; j++)
+        {
+            ret = ctx->vtable->vaRenderPicture(ctx, context_id, &compBufs[j].bufID, 1);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+                << ", Failed function = vaRenderPicture" << endl;
+        }
+
+        ret = ctx->vtable->vaEndPicture(ctx, context_id);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = vaEndPicture" << endl;
+
+        for (uint32_t j = 0; j < compBufNum; j++)
+        {
+            ctx->vtable->vaDestroyBuffer(ctx, compBufs[j].bufID);
+        }
+    }
+
+    // Submits the pictures still pending in the batch
+    for (uint32_t i = 0; i < surfaceNum; i++)
+    {
+        ret = ctx->vtable->vaSyncSurface(ctx, surfaces[i]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = vaSyncSurface" << endl;
+    }
+    double cpuTime = GetProcessCpuTime() - start;
+
+    ret = ctx->vtable->vaDestroyContext(ctx, context_id);
+    EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+        << ", Failed function = vaDestroyContext" << endl;
+
+    ret = ctx->vtable->vaDestroySurfaces(ctx, &surfaces[0], surfaceNum);
+    EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+        << ", Failed function = vaDestroySurfaces" << endl;
+    ctx->vtable->vaDestroyConfig(ctx, config_id);
+
+    return cpuTime;
+}
+
+//!
+//! \brief  Pictures per CPU second of a stream of small JPEG pictures,
+//!         submitted one by one and in batches
+//! \details The mock device does not execute the command buffers, so only
+//!          the CPU side of the decode is measured.
+//!
+TEST_F(MediaDecodeJpegBatchDdiTest, Throughput)
+{
+    const uint32_t pictureNum   = 512;
+    const uint32_t batchSizes[] = { 1, 4, 16 };
+
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int i = 0; i < m_driverLoader.GetPlatformNum(); i++)
+    {
+        for (uint32_t batchSize : batchSizes)
+        {
+            if (!InitDriver(platforms[i], batchSize))
+            {
+                break;
+            }
+
+            // No command expectations, the synthetic pictures are not checked
+            CmdValidator::GpuCmdsValidationInit(nullptr, platforms[i]);
+
+            double cpuTime = DecodePictures(platforms[i], pictureNum);
+            if (cpuTime >= 0.0)
+            {
+                cout << g_platformName[platforms[i]] << " batch " << setw(2) << batchSize << ": "
+                     << fixed << setprecision(0) << pictureNum / cpuTime << " pictures per CPU second" << endl;
+            }
+
+            int ret = m_driverLoader.CloseDriver();
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[i]]
+                << ", Failed function = m_driverLoader.CloseDriver" << endl;
+
+            if (cpuTime < 0.0)
+            {
+                // No JPEG decode on this platform
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,218 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "ddi_test_decode.h"
+
+using namespace std;
+
+//!
+//! \brief  vaSyncSurface on AVC frames decoded by two interleaved contexts,
+//!         synced in another order than they were submitted
+//! \details The mock device cannot complete the status reports, so the codec
+//!          runs on the null hardware path, which reports every frame done.
+//!          The sync order drains the reports of a context past frames not
+//!          waited on yet and waits on frames whose report is already drained.
+//!
+class MediaDecodeSyncOrderDdiTest : public testing::Test
+{
+protected:
+
+    struct Stream
+    {
+        DecTestData *decData;
+        VAConfigID   config;
+        VAContextID  context;
+    };
+
+    //!
+    //! \brief  Loads the driver on the null hardware path
+    //! \return bool
+    //!         false if the test cannot run on the platform
+    //!
+    bool InitDriver(Platform_t platform)
+    {
+        m_driverLoader.SetUserFeature("NullHWAccelerationEnable", 1);
+        int ret = m_driverLoader.InitDriver(platform);
+        m_driverLoader.ClearUserFeatures();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = m_driverLoader.InitDriver" << endl;
+        if (ret != VA_STATUS_SUCCESS)
+        {
+            return false;
+        }
+        if (!m_driverLoader.UserFeaturesForced())
+        {
+            cout << "The driver cannot force user features, skipped" << endl;
+            m_driverLoader.CloseDriver();
+            return false;
+        }
+        return true;
+    }
+
+    void CreateStream(Stream &stream)
+    {
+        VADriverContextP     ctx       = &m_driverLoader.m_ctx;
+        DecTestData         *decData   = stream.decData;
+        vector<VASurfaceID> &resources = decData->GetResources();
+
+        int ret = ctx->vtable->vaCreateConfig(ctx, decData->GetFeatureID().profile, decData->GetFeatureID().entrypoint,
+            (VAConfigAttrib *)&(decData->GetConfAttrib()[0]), decData->GetConfAttrib().size(), &stream.config);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateConfig" << endl;
+
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, decData->GetWidth(), decData->GetHeight(),
+            &resources[0], resources.size(), nullptr, 0);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+
+        ret = ctx->vtable->vaCreateContext(ctx, stream.config, decData->GetWidth(), decData->GetHeight(),
+            VA_PROGRESSIVE, &resources[0], resources.size(), &stream.context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateContext" << endl;
+    }
+
+    void DestroyStream(Stream &stream)
+    {
+        VADriverContextP     ctx       = &m_driverLoader.m_ctx;
+        vector<VASurfaceID> &resources = stream.decData->GetResources();
+
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, stream.context));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &resources[0], resources.size()));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyConfig(ctx, stream.config));
+    }
+
+    //!
+    //! \brief  Decodes a frame of the stream into its own surface, without waiting
+    //!
+    void DecodeFrame(Stream &stream, int frame)
+    {
+        VADriverContextP              ctx       = &m_driverLoader.m_ctx;
+        vector<VASurfaceID>          &resources = stream.decData->GetResources();
+        vector<vector<CompBufConif>> &compBufs  = stream.decData->GetCompBuffers();
+
+        int ret = ctx->vtable->vaBeginPicture(ctx, stream.context, resources[frame]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaBeginPicture" << endl;
+
+        for (int j = 0; j < compBufs[frame].size(); j++)
+        {
+            ret = ctx->vtable->vaCreateBuffer(ctx, stream.context, compBufs[frame][j].bufType, compBufs[frame][j].bufSize, 1,
+                compBufs[frame][j].pData, &compBufs[frame][j].bufID);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+        }
+
+        stream.decData->UpdateCompBuffers(frame);
+        for (int j = 0; j < compBufs[frame].size(); j++)
+        {
+            ret = ctx->vtable->vaRenderPicture(ctx, stream.context, &compBufs[frame][j].bufID, 1);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaRenderPicture" << endl;
+        }
+
+        ret = ctx->vtable->vaEndPicture(ctx, stream.context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaEndPicture" << endl;
+
+        for (int j = 0; j < compBufs[frame].size(); j++)
+        {
+            ctx->vtable->vaDestroyBuffer(ctx, compBufs[frame][j].bufID);
+        }
+    }
+
+    DriverDllLoader     m_driverLoader;
+    DecTestDataFactory  m_decDataFactory;
+    DecodeTestConfig    m_decTestCfg;
+};
+
+TEST_F(MediaDecodeSyncOrderDdiTest, OutOfOrderSync)
+{
+#if (_DEBUG || _RELEASE_INTERNAL)
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int i = 0; i < m_driverLoader.GetPlatformNum(); i++)
+    {
+        Stream streams[2];
+        streams[0].decData = m_decDataFactory.GetDecTestData("AVC-Long");
+        streams[1].decData = m_decDataFactory.GetDecTestData("AVC-Long");
+        if (!m_decTestCfg.IsDecTestEnabled(DeviceConfigTable[platforms[i]], streams[0].decData->GetFeatureID()) ||
+            !InitDriver(platforms[i]))
+        {
+            delete streams[0].decData;
+            delete streams[1].decData;
+            continue;
+        }
+
+        VADriverContextP ctx       = &m_driverLoader.m_ctx;
+        int              frameNum  = streams[0].decData->m_num_frames;
+        ASSERT_GE(frameNum, 3);
+
+        CmdValidator::GpuCmdsValidationInit(g_gpuCmdFactoryDecodeAVCLong, platforms[i]);
+        CreateStream(streams[0]);
+        CreateStream(streams[1]);
+
+        // The frames of the two contexts are submitted interleaved
+        for (int frame = 0; frame < frameNum; frame++)
+        {
+            DecodeFrame(streams[0], frame);
+            DecodeFrame(streams[1], frame);
+        }
+
+        // Last frame of one context first, then frames already drained by it,
+        // then the other context from its middle
+        vector<pair<int, int>> syncOrder;
+        syncOrder.push_back(make_pair(1, frameNum - 1));
+        syncOrder.push_back(make_pair(0, 1));
+        syncOrder.push_back(make_pair(1, 0));
+        syncOrder.push_back(make_pair(0, 0));
+        for (int frame = frameNum - 1; frame >= 2; frame--)
+        {
+            syncOrder.push_back(make_pair(0, frame));
+        }
+        for (int frame = 1; frame < frameNum - 1; frame++)
+        {
+            syncOrder.push_back(make_pair(1, frame));
+        }
+
+        for (auto &sync : syncOrder)
+        {
+            VASurfaceID surface = streams[sync.first].decData->GetResources()[sync.second];
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, surface))
+                << "Platform = " << g_platformName[platforms[i]] << ", context " << sync.first
+                << ", frame " << sync.second << ", Failed function = vaSyncSurface" << endl;
+
+            VASurfaceStatus surfaceStatus;
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaQuerySurfaceStatus(ctx, surface, &surfaceStatus));
+            EXPECT_EQ(VASurfaceReady, surfaceStatus);
+        }
+
+        // Once drained, a report keeps answering later waits
+        for (int frame = 0; frame < frameNum; frame++)
+        {
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, streams[0].decData->GetResources()[frame]));
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, streams[1].decData->GetResources()[frame]));
+        }
+
+        DestroyStream(streams[1]);
+        DestroyStream(streams[0]);
+        delete streams[0].decData;
+        delete streams[1].decData;
+
+        int ret = m_driverLoader.CloseDriver();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = m_driverLoader.CloseDriver" << endl;
+    }
+#else
+    cout << "The null hardware path is only built in debug and release internal drivers, skipped" << endl;
+#endif
+}
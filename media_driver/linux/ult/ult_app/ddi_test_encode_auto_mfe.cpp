@@ -0,0 +1,294 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "cmd_validator.h"
+#include "driver_loader.h"
+#include "gtest/gtest.h"
+#include "test_data_encode.h"
+
+using namespace std;
+
+void UltGetCmdBuf(PMOS_COMMAND_BUFFER pCmdBuffer);
+
+static atomic<uint32_t> g_submissions(0);
+
+static void CountSubmission(PMOS_COMMAND_BUFFER pCmdBuffer)
+{
+    g_submissions++;
+    UltGetCmdBuf(pCmdBuffer);
+}
+
+//!
+//! \brief  Independent AVC streams batched by the automatic MFE scheduler
+//! \details The mock device does not execute the command buffers, the
+//!          submissions are counted where MOS hands them to the device.
+//!
+class MediaEncodeAutoMfeDdiTest : public testing::Test
+{
+protected:
+
+    struct Stream
+    {
+        EncTestData *data    = nullptr;
+        VAConfigID   config  = VA_INVALID_ID;
+        VAContextID  context = VA_INVALID_ID;
+    };
+
+    //!
+    //! \brief  Loads the driver on SKL with auto MFE enabled
+    //! \return bool
+    //!         false if the test cannot run
+    //!
+    bool InitDriver(int64_t window)
+    {
+        vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+        bool               skl       = false;
+        for (auto platform : platforms)
+        {
+            skl = skl || platform == igfxSKLAKE;
+        }
+        if (!skl)
+        {
+            cout << "Auto MFE needs SKL, skipped" << endl;
+            return false;
+        }
+
+        m_driverLoader.SetUserFeature("Encode Auto MFE Enable", 1);
+        m_driverLoader.SetUserFeature("Encode Auto MFE Window", window);
+        int ret = m_driverLoader.InitDriver(igfxSKLAKE);
+        m_driverLoader.ClearUserFeatures();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = m_driverLoader.InitDriver" << endl;
+        if (ret != VA_STATUS_SUCCESS)
+        {
+            return false;
+        }
+        if (!m_driverLoader.UserFeaturesForced())
+        {
+            cout << "The driver cannot force user features, skipped" << endl;
+            m_driverLoader.CloseDriver();
+            return false;
+        }
+
+        CmdValidator::GpuCmdsValidationInit(nullptr, igfxSKLAKE);
+        *m_driverLoader.GetDriverSymbols().ppfnUltGetCmdBuf = CountSubmission;
+        return true;
+    }
+
+    void CreateStream(Stream &stream, FeatureID featureId)
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        stream.data = new EncTestDataAVC(featureId);
+        int ret = ctx->vtable->vaCreateConfig(ctx, featureId.profile, featureId.entrypoint,
+            &stream.data->GetConfAttrib()[0], stream.data->GetConfAttrib().size(), &stream.config);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateConfig" << endl;
+
+        vector<VASurfaceID> &resources = stream.data->GetResources();
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, stream.data->GetWidth(), stream.data->GetHeight(),
+            &resources[0], resources.size(), &stream.data->GetSurfAttrib()[0], stream.data->GetSurfAttrib().size());
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+
+        ret = ctx->vtable->vaCreateContext(ctx, stream.config, stream.data->GetWidth(), stream.data->GetHeight(),
+            VA_PROGRESSIVE, &resources[0], resources.size(), &stream.context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateContext" << endl;
+    }
+
+    void DestroyStream(Stream &stream)
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        vector<VASurfaceID> &resources = stream.data->GetResources();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, stream.context));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &resources[0], resources.size()));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyConfig(ctx, stream.config));
+        delete stream.data;
+        stream.data = nullptr;
+    }
+
+    //!
+    //! \brief  Begin, render and end a frame without waiting for it
+    //!
+    void EncodeFrame(Stream &stream, int frame)
+    {
+        VADriverContextP              ctx      = &m_driverLoader.m_ctx;
+        vector<vector<CompBufConif>> &compBufs = stream.data->GetCompBuffers();
+
+        int ret = ctx->vtable->vaBeginPicture(ctx, stream.context, stream.data->GetResources()[0]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaBeginPicture" << endl;
+
+        ret = ctx->vtable->vaCreateBuffer(ctx, stream.context, compBufs[frame][0].bufType,
+            compBufs[frame][0].bufSize, 1, compBufs[frame][0].pData, &compBufs[frame][0].bufID);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+
+        stream.data->UpdateCompBuffers(frame);
+        for (uint32_t j = 1; j < compBufs[frame].size(); j++)
+        {
+            ret = ctx->vtable->vaCreateBuffer(ctx, stream.context, compBufs[frame][j].bufType,
+                compBufs[frame][j].bufSize, 1, compBufs[frame][j].pData, &compBufs[frame][j].bufID);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+            ret = ctx->vtable->vaRenderPicture(ctx, stream.context, &compBufs[frame][j].bufID, 1);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaRenderPicture" << endl;
+        }
+
+        ret = ctx->vtable->vaEndPicture(ctx, stream.context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaEndPicture" << endl;
+    }
+
+    //!
+    //! \brief  Wait for the frame and release its buffers
+    //!
+    void FinishFrame(Stream &stream, int frame)
+    {
+        VADriverContextP              ctx      = &m_driverLoader.m_ctx;
+        vector<vector<CompBufConif>> &compBufs = stream.data->GetCompBuffers();
+        VASurfaceID                   surface  = stream.data->GetResources()[0];
+
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, surface));
+
+        VASurfaceStatus status = VASurfaceRendering;
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaQuerySurfaceStatus(ctx, surface, &status));
+        EXPECT_EQ(VASurfaceReady, status);
+
+        for (uint32_t j = 0; j < compBufs[frame].size(); j++)
+        {
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyBuffer(ctx, compBufs[frame][j].bufID));
+        }
+    }
+
+    DriverDllLoader m_driverLoader;
+};
+
+//!
+//! \brief  A frame without a batch partner is submitted by the deadline,
+//!         not by the next call of the application
+//!
+TEST_F(MediaEncodeAutoMfeDdiTest, DeadlineFlush)
+{
+    if (!InitDriver(5000))
+    {
+        return;
+    }
+
+    Stream streams[2];
+    CreateStream(streams[0], TEST_Intel_Encode_AVC);
+    CreateStream(streams[1], TEST_Intel_Encode_AVC);
+
+    g_submissions = 0;
+    EncodeFrame(streams[0], 0);
+    EXPECT_EQ(0u, g_submissions.load()) << "the frame must wait for the other stream";
+
+    // No call into the driver until well past the 5 ms window
+    for (uint32_t i = 0; i < 100 && g_submissions.load() == 0; i++)
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    EXPECT_NE(0u, g_submissions.load()) << "the deadline timer did not submit the frame";
+
+    FinishFrame(streams[0], 0);
+
+    DestroyStream(streams[0]);
+    DestroyStream(streams[1]);
+    EXPECT_EQ(VA_STATUS_SUCCESS, m_driverLoader.CloseDriver());
+}
+
+//!
+//! \brief  Frames of compatible streams go in one submission, waits on
+//!         surfaces of other streams do not break the batch
+//!
+TEST_F(MediaEncodeAutoMfeDdiTest, BatchCompatibleStreams)
+{
+    // Long enough for the timer to stay out of the way
+    if (!InitDriver(1000000))
+    {
+        return;
+    }
+
+    Stream streams[2];
+    CreateStream(streams[0], TEST_Intel_Encode_AVC);
+    CreateStream(streams[1], TEST_Intel_Encode_AVC);
+    VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+    for (int frame = 0; frame < ENC_FRAME_NUM; frame++)
+    {
+        g_submissions = 0;
+        EncodeFrame(streams[0], frame);
+
+        // Neither a surface of the idle stream nor an unrelated one flushes
+        VASurfaceStatus status = VASurfaceRendering;
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, streams[1].data->GetResources()[0]));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaQuerySurfaceStatus(ctx, streams[1].data->GetResources()[1], &status));
+        EXPECT_EQ(0u, g_submissions.load()) << "frame " << frame;
+
+        EncodeFrame(streams[1], frame);
+        EXPECT_NE(0u, g_submissions.load()) << "frame " << frame << ": both streams have a frame";
+
+        FinishFrame(streams[0], frame);
+        FinishFrame(streams[1], frame);
+    }
+
+    DestroyStream(streams[0]);
+    DestroyStream(streams[1]);
+    EXPECT_EQ(VA_STATUS_SUCCESS, m_driverLoader.CloseDriver());
+}
+
+//!
+//! \brief  A frame of another profile closes the pending batch instead of
+//!         joining it
+//!
+TEST_F(MediaEncodeAutoMfeDdiTest, IncompatibleStreams)
+{
+    if (!InitDriver(1000000))
+    {
+        return;
+    }
+
+    const FeatureID avcHigh = { VAProfileH264High, VAEntrypointEncSlice };
+
+    Stream streams[3];
+    CreateStream(streams[0], TEST_Intel_Encode_AVC);
+    CreateStream(streams[1], avcHigh);
+    CreateStream(streams[2], TEST_Intel_Encode_AVC);
+
+    g_submissions = 0;
+    EncodeFrame(streams[0], 0);
+    EXPECT_EQ(0u, g_submissions.load());
+
+    // The Main frame goes alone, the High one waits
+    EncodeFrame(streams[1], 0);
+    uint32_t submissions = g_submissions.load();
+    EXPECT_NE(0u, submissions);
+
+    // Syncing the Main frame does not touch the pending High one
+    FinishFrame(streams[0], 0);
+    EXPECT_EQ(submissions, g_submissions.load());
+
+    FinishFrame(streams[1], 0);
+    EXPECT_NE(submissions, g_submissions.load());
+
+    for (auto &stream : streams)
+    {
+        DestroyStream(stream);
+    }
+    EXPECT_EQ(VA_STATUS_SUCCESS, m_driverLoader.CloseDriver());
+}
@@ -0,0 +1,240 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <iomanip>
+#include <time.h>
+#include <vector>
+#include "cmd_validator.h"
+#include "driver_loader.h"
+#include "gtest/gtest.h"
+#include "test_data_encode.h"
+
+using namespace std;
+
+//!
+//! \brief  CBR AVC encode with MB BRC on SKL, where every MbEnc pass asks
+//!         UpdateMbBrcConstantDataBuffer for the MbBrc constant data
+//! \details The mock device does not execute the command buffers, so the
+//!          CPU time of vaEndPicture is the cost of preparing a frame.
+//!
+class MediaEncodeAvcMbBrcDdiTest : public testing::Test
+{
+protected:
+
+    static const uint32_t m_width       = 320;
+    static const uint32_t m_height      = 240;
+    static const uint32_t m_surfaceNum  = 4;
+    // CODECHAL_ENCODE_RECYCLED_BUFFER_NUM, the encoder moves to the next
+    // MbBrc constant data buffer on every frame
+    static const uint32_t m_recycledNum = 6;
+
+    //!
+    //! \brief  Loads the driver on SKL and creates a CBR context
+    //! \return bool
+    //!         false if the test cannot run
+    //!
+    bool Init()
+    {
+        bool skl = false;
+        for (auto platform : m_driverLoader.GetPlatforms())
+        {
+            skl = skl || platform == igfxSKLAKE;
+        }
+        if (!skl)
+        {
+            cout << "AVC MbBrc encode needs SKL, skipped" << endl;
+            return false;
+        }
+
+        int ret = m_driverLoader.InitDriver(igfxSKLAKE);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = m_driverLoader.InitDriver" << endl;
+        if (ret != VA_STATUS_SUCCESS)
+        {
+            return false;
+        }
+        CmdValidator::GpuCmdsValidationInit(nullptr, igfxSKLAKE);
+
+        VADriverContextP ctx    = &m_driverLoader.m_ctx;
+        VAConfigAttrib   attrib = { VAConfigAttribRateControl, VA_RC_CBR };
+        ret = ctx->vtable->vaCreateConfig(ctx, VAProfileH264High, VAEntrypointEncSlice, &attrib, 1, &m_config);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateConfig" << endl;
+
+        m_surfaces.assign(m_surfaceNum, VA_INVALID_ID);
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, m_width, m_height, &m_surfaces[0], m_surfaceNum, nullptr, 0);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+
+        ret = ctx->vtable->vaCreateContext(ctx, m_config, m_width, m_height, VA_PROGRESSIVE, &m_surfaces[0], m_surfaceNum, &m_context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateContext" << endl;
+        return true;
+    }
+
+    void Destroy()
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, m_context));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &m_surfaces[0], m_surfaceNum));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyConfig(ctx, m_config));
+        EXPECT_EQ(VA_STATUS_SUCCESS, m_driverLoader.CloseDriver());
+    }
+
+    static double ThreadCpuUs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+    }
+
+    //!
+    //! \brief  Encodes an IDR frame then P frames each referencing the one
+    //!         before, the sequence params are only sent with the IDR frame
+    //!         like applications do
+    //! \param  [in] toggle8x8
+    //!         Flip transform_8x8_mode_flag every m_recycledNum frames, so
+    //!         that each recycled buffer sees another key on every use and
+    //!         the MbBrc constant data is rebuilt on every frame
+    //! \return double
+    //!         CPU us of vaEndPicture per frame, once every buffer is filled
+    //!
+    double EncodeFrames(uint32_t frameNum, bool toggle8x8)
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+        AvcEncBufs       bufs;
+        double           cpuUs = 0;
+
+        VAEncSequenceParameterBufferH264 *sps = bufs.GetSpsBuf();
+        sps->bits_per_second                  = 2000000;
+
+        struct
+        {
+            VAEncMiscParameterBuffer      header;
+            VAEncMiscParameterRateControl rc;
+        } miscRc;
+        memset(&miscRc, 0, sizeof(miscRc));
+        miscRc.header.type                    = VAEncMiscParameterTypeRateControl;
+        miscRc.rc.bits_per_second             = sps->bits_per_second;
+        miscRc.rc.target_percentage           = 100;
+        miscRc.rc.rc_flags.bits.mb_rate_control = 1;
+
+        for (uint32_t frame = 0; frame < frameNum; frame++)
+        {
+            VASurfaceID current = m_surfaces[frame % m_surfaceNum];
+            VASurfaceID ref     = m_surfaces[(frame + m_surfaceNum - 1) % m_surfaceNum];
+
+            VABufferID codedBuf = VA_INVALID_ID;
+            int ret = ctx->vtable->vaCreateBuffer(ctx, m_context, VAEncCodedBufferType, m_width * m_height * 3 / 2, 1, nullptr, &codedBuf);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+
+            VAEncPictureParameterBufferH264 *pps = bufs.GetPpsBuf();
+            VAEncSliceParameterBufferH264   *slc = bufs.GetSlcBuf();
+            pps->coded_buf                        = codedBuf;
+            pps->CurrPic.picture_id               = current;
+            pps->CurrPic.frame_idx                = frame & 0xf;
+            pps->CurrPic.TopFieldOrderCnt         = (frame * 2) & 0xff;
+            pps->CurrPic.BottomFieldOrderCnt      = pps->CurrPic.TopFieldOrderCnt + 1;
+            pps->frame_num                        = frame & 0xf;
+            pps->pic_init_qp                      = 0x1c;
+            pps->pic_fields.value                 = frame ? 0x30a : 0x30b;
+            if (toggle8x8)
+            {
+                pps->pic_fields.bits.transform_8x8_mode_flag = ((frame / m_recycledNum) & 1) ? 0 : 1;
+            }
+            slc->slice_type = frame ? 0 : 7;
+            if (frame)
+            {
+                pps->ReferenceFrames[0].picture_id          = ref;
+                pps->ReferenceFrames[0].flags               = VA_PICTURE_H264_SHORT_TERM_REFERENCE;
+                pps->ReferenceFrames[0].TopFieldOrderCnt    = ((frame - 1) * 2) & 0xff;
+                pps->ReferenceFrames[0].BottomFieldOrderCnt = pps->ReferenceFrames[0].TopFieldOrderCnt + 1;
+                slc->RefPicList0[0]                         = pps->ReferenceFrames[0];
+            }
+
+            vector<CompBufConif> compBufs;
+            if (frame == 0)
+            {
+                compBufs.push_back({ VAEncSequenceParameterBufferType, bufs.GetSpsSize(), sps, VA_INVALID_ID });
+            }
+            compBufs.push_back({ VAEncPictureParameterBufferType, bufs.GetPpsSize(), pps, VA_INVALID_ID });
+            compBufs.push_back({ VAEncMiscParameterBufferType, sizeof(miscRc), &miscRc, VA_INVALID_ID });
+            compBufs.push_back({ VAEncSliceParameterBufferType, bufs.GetSlcSize(), slc, VA_INVALID_ID });
+
+            ret = ctx->vtable->vaBeginPicture(ctx, m_context, current);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaBeginPicture" << endl;
+            for (auto &compBuf : compBufs)
+            {
+                ret = ctx->vtable->vaCreateBuffer(ctx, m_context, compBuf.bufType, compBuf.bufSize, 1, compBuf.pData, &compBuf.bufID);
+                EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+                ret = ctx->vtable->vaRenderPicture(ctx, m_context, &compBuf.bufID, 1);
+                EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaRenderPicture" << endl;
+            }
+
+            double start = ThreadCpuUs();
+            ret = ctx->vtable->vaEndPicture(ctx, m_context);
+            double end = ThreadCpuUs();
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaEndPicture" << endl;
+
+            // The first round fills every recycled buffer in both cases
+            if (frame >= 2 * m_recycledNum)
+            {
+                cpuUs += end - start;
+            }
+
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, current));
+            for (auto &compBuf : compBufs)
+            {
+                ctx->vtable->vaDestroyBuffer(ctx, compBuf.bufID);
+            }
+            ctx->vtable->vaDestroyBuffer(ctx, codedBuf);
+        }
+
+        return cpuUs / (frameNum - 2 * m_recycledNum);
+    }
+
+    DriverDllLoader     m_driverLoader;
+    VAConfigID          m_config  = VA_INVALID_ID;
+    VAContextID         m_context = VA_INVALID_ID;
+    vector<VASurfaceID> m_surfaces;
+};
+
+//!
+//! \brief  CPU per frame with the MbBrc constant data found in place against
+//!         rebuilt on every frame
+//!
+TEST_F(MediaEncodeAvcMbBrcDdiTest, ConstantDataBenchmark)
+{
+    const uint32_t frameNum = 2 * m_recycledNum + 120;
+
+    double cpuUs[2] = {};
+    for (uint32_t toggle8x8 = 0; toggle8x8 < 2; toggle8x8++)
+    {
+        if (!Init())
+        {
+            return;
+        }
+        cpuUs[toggle8x8] = EncodeFrames(frameNum, toggle8x8 != 0);
+        Destroy();
+    }
+
+    cout << "AVC CBR MbBrc vaEndPicture CPU per frame: " << fixed << setprecision(1)
+         << cpuUs[0] << " us with the constant data in place, "
+         << cpuUs[1] << " us rebuilding it" << endl;
+}
@@ -0,0 +1,317 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "cmd_validator.h"
+#include "driver_loader.h"
+#include "gtest/gtest.h"
+#include "test_data_encode.h"
+
+using namespace std;
+
+void UltGetCmdBuf(PMOS_COMMAND_BUFFER pCmdBuffer);
+
+static atomic<uint32_t> g_jpegSubmissions(0);
+
+static void CountJpegSubmission(PMOS_COMMAND_BUFFER pCmdBuffer)
+{
+    g_jpegSubmissions++;
+    UltGetCmdBuf(pCmdBuffer);
+}
+
+//!
+//! \brief  Small JPEG pictures batched in one submission by the encoder
+//! \details The mock device does not execute the command buffers, the
+//!          submissions are counted where MOS hands them to the device.
+//!
+class MediaEncodeJpegBatchDdiTest : public testing::Test
+{
+protected:
+
+    static const uint32_t m_width      = 64;
+    static const uint32_t m_height     = 64;
+    static const uint32_t m_surfaceNum = 8;
+    static const uint32_t m_batchSize  = 4;
+
+    //!
+    //! \brief  Loads the driver with the JPEG encode batch size forced and
+    //!         creates a context over m_surfaceNum surfaces
+    //! \return bool
+    //!         false if the platform has no JPEG encode or the batch size
+    //!         cannot be forced
+    //!
+    bool Init(Platform_t platform)
+    {
+        m_driverLoader.SetUserFeature("JPEG Encode Batch Size", m_batchSize);
+        int ret = m_driverLoader.InitDriver(platform);
+        m_driverLoader.ClearUserFeatures();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = m_driverLoader.InitDriver" << endl;
+        if (ret != VA_STATUS_SUCCESS)
+        {
+            return false;
+        }
+
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+        if (!m_driverLoader.UserFeaturesForced() ||
+            ctx->vtable->vaCreateConfig(ctx, TEST_Intel_Encode_JPEG.profile, TEST_Intel_Encode_JPEG.entrypoint,
+                nullptr, 0, &m_config) != VA_STATUS_SUCCESS)
+        {
+            m_driverLoader.CloseDriver();
+            return false;
+        }
+
+        CmdValidator::GpuCmdsValidationInit(nullptr, platform);
+        *m_driverLoader.GetDriverSymbols().ppfnUltGetCmdBuf = CountJpegSubmission;
+
+        m_surfaces.assign(m_surfaceNum, VA_INVALID_ID);
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, m_width, m_height, &m_surfaces[0], m_surfaceNum, nullptr, 0);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+
+        ret = ctx->vtable->vaCreateContext(ctx, m_config, m_width, m_height, VA_PROGRESSIVE, &m_surfaces[0], m_surfaceNum, &m_context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateContext" << endl;
+
+        m_codedBufs.assign(m_surfaceNum, VA_INVALID_ID);
+        for (uint32_t i = 0; i < m_surfaceNum; i++)
+        {
+            ret = ctx->vtable->vaCreateBuffer(ctx, m_context, VAEncCodedBufferType, m_width * m_height * 3, 1, nullptr, &m_codedBufs[i]);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+        }
+        return true;
+    }
+
+    void Destroy()
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        for (uint32_t i = 0; i < m_surfaceNum; i++)
+        {
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyBuffer(ctx, m_codedBufs[i]));
+        }
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, m_context));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &m_surfaces[0], m_surfaceNum));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyConfig(ctx, m_config));
+        EXPECT_EQ(VA_STATUS_SUCCESS, m_driverLoader.CloseDriver());
+    }
+
+    //!
+    //! \brief  Begin, render and end a 4:2:0 picture read from the surface
+    //!
+    void EncodePicture(uint32_t index)
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        VAEncPictureParameterBufferJPEG picParam;
+        memset(&picParam, 0, sizeof(picParam));
+        picParam.reconstructed_picture  = m_surfaces[index];
+        picParam.picture_width          = m_width;
+        picParam.picture_height         = m_height;
+        picParam.coded_buf              = m_codedBufs[index];
+        picParam.pic_flags.bits.huffman = 1;
+        picParam.sample_bit_depth       = 8;
+        picParam.num_scan               = 1;
+        picParam.num_components         = 3;
+        picParam.quality                = 50;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            picParam.component_id[i]             = i + 1;
+            picParam.quantiser_table_selector[i] = (i == 0) ? 0 : 1;
+        }
+
+        VAQMatrixBufferJPEG qMatrix;
+        memset(&qMatrix, 0, sizeof(qMatrix));
+        qMatrix.load_lum_quantiser_matrix    = 1;
+        qMatrix.load_chroma_quantiser_matrix = 1;
+        for (uint32_t j = 0; j < 64; j++)
+        {
+            qMatrix.lum_quantiser_matrix[j]    = (uint8_t)(1 + (j >> 2));
+            qMatrix.chroma_quantiser_matrix[j] = (uint8_t)(5 + (j >> 2));
+        }
+
+        VAHuffmanTableBufferJPEGBaseline huffmanTable;
+        memset(&huffmanTable, 0, sizeof(huffmanTable));
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            huffmanTable.load_huffman_table[i] = 1;
+            for (uint32_t j = 0; j < 12; j++)
+            {
+                huffmanTable.huffman_table[i].num_dc_codes[j] = (j == 2) ? 1 : 0;
+                huffmanTable.huffman_table[i].dc_values[j]    = (uint8_t)j;
+            }
+            huffmanTable.huffman_table[i].num_ac_codes[1] = 2;
+            huffmanTable.huffman_table[i].ac_values[0]    = 0x00;
+            huffmanTable.huffman_table[i].ac_values[1]    = 0x01;
+        }
+
+        VAEncSliceParameterBufferJPEG sliceParam;
+        memset(&sliceParam, 0, sizeof(sliceParam));
+        sliceParam.num_components = 3;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            sliceParam.components[i].component_selector = i + 1;
+            sliceParam.components[i].dc_table_selector  = (i == 0) ? 0 : 1;
+            sliceParam.components[i].ac_table_selector  = (i == 0) ? 0 : 1;
+        }
+
+        CompBufConif compBufs[] = {
+            { VAEncPictureParameterBufferType, sizeof(picParam),     &picParam,     VA_INVALID_ID },
+            { VAQMatrixBufferType,             sizeof(qMatrix),      &qMatrix,      VA_INVALID_ID },
+            { VAHuffmanTableBufferType,        sizeof(huffmanTable), &huffmanTable, VA_INVALID_ID },
+            { VAEncSliceParameterBufferType,   sizeof(sliceParam),   &sliceParam,   VA_INVALID_ID },
+        };
+
+        int ret = ctx->vtable->vaBeginPicture(ctx, m_context, m_surfaces[index]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaBeginPicture" << endl;
+        for (auto &compBuf : compBufs)
+        {
+            ret = ctx->vtable->vaCreateBuffer(ctx, m_context, compBuf.bufType, compBuf.bufSize, 1, compBuf.pData, &compBuf.bufID);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+            ret = ctx->vtable->vaRenderPicture(ctx, m_context, &compBuf.bufID, 1);
+            EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaRenderPicture" << endl;
+        }
+        ret = ctx->vtable->vaEndPicture(ctx, m_context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaEndPicture" << endl;
+
+        for (auto &compBuf : compBufs)
+        {
+            ctx->vtable->vaDestroyBuffer(ctx, compBuf.bufID);
+        }
+    }
+
+    //!
+    //! \brief  Every surface is ready after waiting on it
+    //!
+    void CheckSurfaces()
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        for (uint32_t i = 0; i < m_surfaceNum; i++)
+        {
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, m_surfaces[i])) << "surface " << i;
+
+            VASurfaceStatus status = VASurfaceRendering;
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaQuerySurfaceStatus(ctx, m_surfaces[i], &status)) << "surface " << i;
+            EXPECT_EQ(VASurfaceReady, status) << "surface " << i;
+        }
+    }
+
+    DriverDllLoader     m_driverLoader;
+    VAConfigID          m_config  = VA_INVALID_ID;
+    VAContextID         m_context = VA_INVALID_ID;
+    vector<VASurfaceID> m_surfaces;
+    vector<VABufferID>  m_codedBufs;
+};
+
+//!
+//! \brief  A full batch goes in one submission, the rest is submitted by
+//!         waiting on any of its surfaces
+//!
+TEST_F(MediaEncodeJpegBatchDdiTest, SubmitPictures)
+{
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int p = 0; p < m_driverLoader.GetPlatformNum(); p++)
+    {
+        if (!Init(platforms[p]))
+        {
+            continue;
+        }
+
+        g_jpegSubmissions = 0;
+        for (uint32_t i = 0; i < m_batchSize; i++)
+        {
+            EncodePicture(i);
+            EXPECT_EQ((i + 1) / m_batchSize, g_jpegSubmissions.load()) << g_platformName[platforms[p]] << " picture " << i;
+        }
+
+        // Waiting on the first surface of a partial batch submits all of it
+        for (uint32_t i = m_batchSize; i < m_surfaceNum - 1; i++)
+        {
+            EncodePicture(i);
+        }
+        EXPECT_EQ(1u, g_jpegSubmissions.load()) << g_platformName[platforms[p]];
+        VASurfaceStatus status = VASurfaceRendering;
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaQuerySurfaceStatus(ctx, m_surfaces[m_batchSize], &status));
+        EXPECT_EQ(2u, g_jpegSubmissions.load()) << g_platformName[platforms[p]];
+
+        // A lone picture is submitted by waiting on it
+        EncodePicture(m_surfaceNum - 1);
+        CheckSurfaces();
+        EXPECT_EQ(3u, g_jpegSubmissions.load()) << g_platformName[platforms[p]];
+
+        Destroy();
+    }
+}
+
+//!
+//! \brief  Another thread waits on the surfaces while the pictures are
+//!         batched, every picture is submitted exactly once
+//!
+TEST_F(MediaEncodeJpegBatchDdiTest, SyncFromAnotherThread)
+{
+    const uint32_t rounds = 64;
+
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int p = 0; p < m_driverLoader.GetPlatformNum(); p++)
+    {
+        if (!Init(platforms[p]))
+        {
+            continue;
+        }
+
+        VADriverContextP ctx  = &m_driverLoader.m_ctx;
+        atomic<bool>     done(false);
+        thread waiter([&]() {
+            for (uint32_t i = 0; !done.load(); i = (i + 1) % m_surfaceNum)
+            {
+                VASurfaceStatus status = VASurfaceRendering;
+                ctx->vtable->vaQuerySurfaceStatus(ctx, m_surfaces[i], &status);
+                if (i == 0)
+                {
+                    ctx->vtable->vaSyncSurface(ctx, m_surfaces[m_surfaceNum / 2]);
+                }
+            }
+        });
+
+        g_jpegSubmissions = 0;
+        for (uint32_t round = 0; round < rounds; round++)
+        {
+            for (uint32_t i = 0; i < m_surfaceNum; i++)
+            {
+                EncodePicture(i);
+            }
+            // A picture is never left behind by a submission from the waiter
+            CheckSurfaces();
+        }
+        done = true;
+        waiter.join();
+
+        // No more submissions than pictures, no fewer than full batches
+        uint32_t submissions = g_jpegSubmissions.load();
+        EXPECT_LE(submissions, rounds * m_surfaceNum) << g_platformName[platforms[p]];
+        EXPECT_GE(submissions, rounds * m_surfaceNum / m_batchSize) << g_platformName[platforms[p]];
+
+        Destroy();
+    }
+}
@@ -0,0 +1,136 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "driver_loader.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+class MediaLockProfileDdiTest : public testing::Test
+{
+protected:
+
+    DriverDllLoader m_driverLoader;
+};
+
+//!
+//! \brief  Creates and destroys surfaces and images from several threads at
+//!         once and checks that the heap mutexes show up in the profile
+//!
+TEST_F(MediaLockProfileDdiTest, SurfaceAndImageHeaps)
+{
+    const uint32_t threadNum  = 8;
+    const uint32_t iterations = 200;
+
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    ASSERT_LT(0, m_driverLoader.GetPlatformNum());
+
+    int ret = m_driverLoader.InitDriver(platforms[0]);
+    ASSERT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[0]]
+        << ", Failed function = m_driverLoader.InitDriver" << endl;
+
+    const DriverSymbols &drvSyms = m_driverLoader.GetDriverSymbols();
+    VADriverContextP     ctx     = &m_driverLoader.m_ctx;
+    if (!drvSyms.MOS_SetLockProfileEnable || !drvSyms.MOS_GetLockProfileStats)
+    {
+        cout << "The driver has no lock profile, skipped" << endl;
+        m_driverLoader.CloseDriver();
+        return;
+    }
+    drvSyms.MOS_SetLockProfileEnable(true);
+
+    vector<thread>   threads;
+    vector<VAStatus> results(threadNum, VA_STATUS_SUCCESS);
+    for (uint32_t t = 0; t < threadNum; t++)
+    {
+        threads.push_back(thread([&, t]() {
+            VAImageFormat format = {};
+            format.fourcc        = VA_FOURCC_NV12;
+            format.byte_order    = VA_LSB_FIRST;
+            format.bits_per_pixel = 12;
+
+            for (uint32_t i = 0; i < iterations && results[t] == VA_STATUS_SUCCESS; i++)
+            {
+                VASurfaceID surface = VA_INVALID_ID;
+                results[t] = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, 64, 64, &surface, 1, nullptr, 0);
+                if (results[t] != VA_STATUS_SUCCESS)
+                {
+                    break;
+                }
+
+                VAImage image;
+                memset(&image, 0, sizeof(image));
+                results[t] = ctx->vtable->vaCreateImage(ctx, &format, 64, 64, &image);
+                if (results[t] == VA_STATUS_SUCCESS)
+                {
+                    results[t] = ctx->vtable->vaDestroyImage(ctx, image.image_id);
+                }
+
+                VAStatus status = ctx->vtable->vaDestroySurfaces(ctx, &surface, 1);
+                if (results[t] == VA_STATUS_SUCCESS)
+                {
+                    results[t] = status;
+                }
+            }
+        }));
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    for (uint32_t t = 0; t < threadNum; t++)
+    {
+        EXPECT_EQ(VA_STATUS_SUCCESS, results[t]) << "Thread = " << t;
+    }
+
+    MOS_LOCK_SITE_STATS stats[MOS_LOCK_PROFILE_SITE_MAX];
+    uint32_t            statNum     = drvSyms.MOS_GetLockProfileStats(stats, MOS_LOCK_PROFILE_SITE_MAX);
+    bool                surfaceHeap = false;
+    bool                imageHeap   = false;
+    for (uint32_t i = 0; i < statNum; i++)
+    {
+        cout << stats[i].name << ": " << stats[i].acquisitions << " acquisitions, " << stats[i].contended
+             << " contended, " << stats[i].waitNs << " ns waited, " << stats[i].holdNs << " ns held" << endl;
+
+        EXPECT_LE(stats[i].contended, stats[i].acquisitions) << stats[i].name;
+        if (strcmp(stats[i].name, "DdiSurfaceHeap") == 0)
+        {
+            surfaceHeap = true;
+            EXPECT_LE(2ull * threadNum * iterations, stats[i].acquisitions);
+        }
+        else if (strcmp(stats[i].name, "DdiImageHeap") == 0)
+        {
+            imageHeap = true;
+            EXPECT_LT(0u, stats[i].acquisitions);
+        }
+    }
+    EXPECT_TRUE(surfaceHeap);
+    EXPECT_TRUE(imageHeap);
+
+    drvSyms.MOS_SetLockProfileEnable(false);
+
+    ret = m_driverLoader.CloseDriver();
+    EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[0]]
+        << ", Failed function = m_driverLoader.CloseDriver" << endl;
+}
@@ -0,0 +1,144 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <iomanip>
+#include <vector>
+#include "cmd_validator.h"
+#include "driver_loader.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+class MediaResourceRecyclerDdiTest : public testing::Test
+{
+protected:
+
+    //!
+    //! \brief  Creates and destroys an AVC decode context over and over,
+    //!         which allocates and frees the same codec resources each time
+    //! \return double
+    //!         Average microseconds of a create and destroy pair, negative
+    //!         if the platform has no AVC decode
+    //!
+    double ChurnDecodeContexts(Platform_t platform, uint32_t iterations);
+
+    DriverDllLoader m_driverLoader;
+};
+
+double MediaResourceRecyclerDdiTest::ChurnDecodeContexts(Platform_t platform, uint32_t iterations)
+{
+    const uint32_t width      = 1920;
+    const uint32_t height     = 1088;
+    const uint32_t surfaceNum = 4;
+
+    VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+    VAConfigID config_id;
+    if (ctx->vtable->vaCreateConfig(ctx, VAProfileH264Main, VAEntrypointVLD, nullptr, 0, &config_id) != VA_STATUS_SUCCESS)
+    {
+        return -1.0;
+    }
+
+    vector<VASurfaceID> surfaces(surfaceNum, VA_INVALID_ID);
+    int ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_YUV420, width, height, &surfaces[0], surfaceNum, nullptr, 0);
+    EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+        << ", Failed function = vaCreateSurfaces2" << endl;
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        VAContextID context_id;
+        ret = ctx->vtable->vaCreateContext(ctx, config_id, width, height, VA_PROGRESSIVE, &surfaces[0], surfaceNum, &context_id);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = vaCreateContext" << endl;
+
+        ret = ctx->vtable->vaDestroyContext(ctx, context_id);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = vaDestroyContext" << endl;
+    }
+    double us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count() / (double)iterations;
+
+    ctx->vtable->vaDestroySurfaces(ctx, &surfaces[0], surfaceNum);
+    ctx->vtable->vaDestroyConfig(ctx, config_id);
+
+    return us;
+}
+
+//!
+//! \brief  Cost of decode context churn with and without the recycler
+//! \details The mock BO manager makes allocations cheap, so the numbers
+//!          mostly show the GMM and MOS side of an allocation.
+//!
+TEST_F(MediaResourceRecyclerDdiTest, DecodeContextChurn)
+{
+    const uint32_t iterations = 50;
+
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int i = 0; i < m_driverLoader.GetPlatformNum(); i++)
+    {
+        int ret = m_driverLoader.InitDriver(platforms[i]);
+        ASSERT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = m_driverLoader.InitDriver" << endl;
+        CmdValidator::GpuCmdsValidationInit(nullptr, platforms[i]);
+
+        const DriverSymbols &drvSyms = m_driverLoader.GetDriverSymbols();
+        if (!drvSyms.MOS_SetResourceRecyclerSize || !drvSyms.MOS_GetResourceRecyclerStats)
+        {
+            cout << "The driver has no resource recycler, skipped" << endl;
+            m_driverLoader.CloseDriver();
+            return;
+        }
+
+        drvSyms.MOS_SetResourceRecyclerSize(0);
+        double offUs = ChurnDecodeContexts(platforms[i], iterations);
+
+        drvSyms.MOS_SetResourceRecyclerSize(256ull << 20);
+        double onUs = ChurnDecodeContexts(platforms[i], iterations);
+
+        if (offUs >= 0.0)
+        {
+            cout << g_platformName[platforms[i]] << " AVC decode context create+destroy: recycler off "
+                 << fixed << setprecision(1) << offUs << " us, on " << onUs << " us" << endl;
+
+            MOS_RESOURCE_RECYCLER_STATS stats[MOS_RESOURCE_RECYCLER_STATS_MAX];
+            uint32_t statNum = drvSyms.MOS_GetResourceRecyclerStats(stats, MOS_RESOURCE_RECYCLER_STATS_MAX);
+            uint64_t hits    = 0;
+            for (uint32_t j = 0; j < statNum; j++)
+            {
+                cout << "  type " << stats[j].type << " format " << stats[j].format << " " << stats[j].width << "x"
+                     << stats[j].height << " tile " << stats[j].tileType << ": " << stats[j].hits << " hits, "
+                     << stats[j].misses << " misses, " << stats[j].busy << " busy, " << stats[j].evicted << " evicted" << endl;
+                EXPECT_LE(stats[j].hits, stats[j].recycled) << "Platform = " << g_platformName[platforms[i]];
+                hits += stats[j].hits;
+            }
+            // Every context after the first one finds the resources of the last
+            EXPECT_LT(0u, hits) << "Platform = " << g_platformName[platforms[i]];
+        }
+
+        drvSyms.MOS_SetResourceRecyclerSize(0);
+
+        // Frees the kept resources, which the memory leak check would see otherwise
+        ret = m_driverLoader.CloseDriver();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platforms[i]]
+            << ", Failed function = m_driverLoader.CloseDriver" << endl;
+    }
+}
@@ -0,0 +1,305 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <va/va_vpp.h>
+#include "cmd_validator.h"
+#include "driver_loader.h"
+#include "gtest/gtest.h"
+
+using namespace std;
+
+void UltGetCmdBuf(PMOS_COMMAND_BUFFER pCmdBuffer);
+
+static atomic<uint32_t> g_vpSubmissions(0);
+static mutex            g_vpStreamMutex;
+static vector<int32_t>  g_vpStreamSizes;
+
+//!
+//! \brief  Validates and records each command buffer submitted
+//!
+static void CheckVpSubmission(PMOS_COMMAND_BUFFER pCmdBuffer)
+{
+    g_vpSubmissions++;
+    UltGetCmdBuf(pCmdBuffer);
+
+    lock_guard<mutex> lock(g_vpStreamMutex);
+    g_vpStreamSizes.push_back((int32_t)((pCmdBuffer->pCmdPtr - pCmdBuffer->pCmdBase) * sizeof(uint32_t)));
+}
+
+//!
+//! \brief  RGB composite jobs batched in one render command buffer
+//! \details RGB sources keep the jobs on the composite path, which is the
+//!          only one that batches. The mock device does not execute the
+//!          command buffers; they are checked by CmdValidator where MOS hands
+//!          them to the device.
+//!
+class MediaVpRenderBatchDdiTest : public testing::Test
+{
+protected:
+
+    static const uint32_t m_width      = 64;
+    static const uint32_t m_height     = 64;
+    static const uint32_t m_targetNum  = 8;
+    static const uint32_t m_batchSize  = 4;
+
+    //!
+    //! \brief  Loads the driver with the render batch size forced and by
+    //!         default a window long enough not to submit on its own
+    //! \return bool
+    //!         false if the platform has no VP or the batch size cannot be
+    //!         forced
+    //!
+    bool Init(Platform_t platform, uint32_t windowUs = 60000000)
+    {
+        m_driverLoader.SetUserFeature("VP Render Batch Size", m_batchSize);
+        m_driverLoader.SetUserFeature("VP Render Batch Window", windowUs);
+        int ret = m_driverLoader.InitDriver(platform);
+        m_driverLoader.ClearUserFeatures();
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Platform = " << g_platformName[platform]
+            << ", Failed function = m_driverLoader.InitDriver" << endl;
+        if (ret != VA_STATUS_SUCCESS)
+        {
+            return false;
+        }
+
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+        if (!m_driverLoader.UserFeaturesForced() ||
+            ctx->vtable->vaCreateConfig(ctx, VAProfileNone, VAEntrypointVideoProc, nullptr, 0, &m_config) != VA_STATUS_SUCCESS)
+        {
+            m_driverLoader.CloseDriver();
+            return false;
+        }
+
+        CmdValidator::GpuCmdsValidationInit(nullptr, platform);
+        *m_driverLoader.GetDriverSymbols().ppfnUltGetCmdBuf = CheckVpSubmission;
+
+        m_sources.assign(m_targetNum, VA_INVALID_ID);
+        m_targets.assign(m_targetNum, VA_INVALID_ID);
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_RGB32, m_width, m_height, &m_sources[0], m_targetNum, nullptr, 0);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+        ret = ctx->vtable->vaCreateSurfaces2(ctx, VA_RT_FORMAT_RGB32, m_width / 2, m_height / 2, &m_targets[0], m_targetNum, nullptr, 0);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateSurfaces2" << endl;
+
+        ret = ctx->vtable->vaCreateContext(ctx, m_config, m_width / 2, m_height / 2, 0, nullptr, 0, &m_context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateContext" << endl;
+
+        g_vpSubmissions = 0;
+        g_vpStreamSizes.clear();
+        return true;
+    }
+
+    void Destroy()
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyContext(ctx, m_context));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &m_sources[0], m_targetNum));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroySurfaces(ctx, &m_targets[0], m_targetNum));
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaDestroyConfig(ctx, m_config));
+        EXPECT_EQ(VA_STATUS_SUCCESS, m_driverLoader.CloseDriver());
+    }
+
+    //!
+    //! \brief  Scales source to target index by half
+    //!
+    void RenderJob(uint32_t index)
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        VARectangle srcRegion = { 0, 0, (uint16_t)m_width, (uint16_t)m_height };
+        VARectangle dstRegion = { 0, 0, (uint16_t)(m_width / 2), (uint16_t)(m_height / 2) };
+
+        VAProcPipelineParameterBuffer pipelineParam;
+        memset(&pipelineParam, 0, sizeof(pipelineParam));
+        pipelineParam.surface        = m_sources[index];
+        pipelineParam.surface_region = &srcRegion;
+        pipelineParam.output_region  = &dstRegion;
+
+        int ret = ctx->vtable->vaBeginPicture(ctx, m_context, m_targets[index]);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaBeginPicture" << endl;
+
+        VABufferID buffer = VA_INVALID_ID;
+        ret = ctx->vtable->vaCreateBuffer(ctx, m_context, VAProcPipelineParameterBufferType, sizeof(pipelineParam), 1, &pipelineParam, &buffer);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaCreateBuffer" << endl;
+        ret = ctx->vtable->vaRenderPicture(ctx, m_context, &buffer, 1);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaRenderPicture" << endl;
+
+        ret = ctx->vtable->vaEndPicture(ctx, m_context);
+        EXPECT_EQ(VA_STATUS_SUCCESS, ret) << "Failed function = vaEndPicture" << endl;
+
+        ctx->vtable->vaDestroyBuffer(ctx, buffer);
+    }
+
+    //!
+    //! \brief  Every target is ready after waiting on it
+    //!
+    void CheckTargets()
+    {
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+
+        for (uint32_t i = 0; i < m_targetNum; i++)
+        {
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaSyncSurface(ctx, m_targets[i])) << "target " << i;
+
+            VASurfaceStatus status = VASurfaceRendering;
+            EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaQuerySurfaceStatus(ctx, m_targets[i], &status)) << "target " << i;
+            EXPECT_EQ(VASurfaceReady, status) << "target " << i;
+        }
+    }
+
+    DriverDllLoader     m_driverLoader;
+    VAConfigID          m_config  = VA_INVALID_ID;
+    VAContextID         m_context = VA_INVALID_ID;
+    vector<VASurfaceID> m_sources;
+    vector<VASurfaceID> m_targets;
+};
+
+//!
+//! \brief  A full batch goes in one command buffer holding all its jobs,
+//!         a partial one is submitted by waiting on any of its targets
+//!
+TEST_F(MediaVpRenderBatchDdiTest, BatchedCommandStream)
+{
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int p = 0; p < m_driverLoader.GetPlatformNum(); p++)
+    {
+        if (!Init(platforms[p]))
+        {
+            continue;
+        }
+
+        // A lone job, submitted by the wait
+        RenderJob(0);
+        EXPECT_EQ(0u, g_vpSubmissions.load()) << g_platformName[platforms[p]];
+        CheckTargets();
+        EXPECT_EQ(1u, g_vpSubmissions.load()) << g_platformName[platforms[p]];
+
+        for (uint32_t i = 0; i < m_batchSize; i++)
+        {
+            RenderJob(i);
+            EXPECT_EQ(1 + (i + 1) / m_batchSize, g_vpSubmissions.load()) << g_platformName[platforms[p]] << " job " << i;
+        }
+
+        // The jobs are appended to one stream, each with its own commands
+        ASSERT_EQ(2u, g_vpStreamSizes.size()) << g_platformName[platforms[p]];
+        EXPECT_GT(g_vpStreamSizes[1], g_vpStreamSizes[0]) << g_platformName[platforms[p]];
+
+        // Querying one target of a partial batch submits all of it
+        for (uint32_t i = m_batchSize; i < m_targetNum; i++)
+        {
+            RenderJob(i);
+        }
+        EXPECT_EQ(2u, g_vpSubmissions.load()) << g_platformName[platforms[p]];
+        VASurfaceStatus status = VASurfaceRendering;
+        VADriverContextP ctx = &m_driverLoader.m_ctx;
+        EXPECT_EQ(VA_STATUS_SUCCESS, ctx->vtable->vaQuerySurfaceStatus(ctx, m_targets[m_targetNum - 1], &status));
+        EXPECT_EQ(3u, g_vpSubmissions.load()) << g_platformName[platforms[p]];
+        CheckTargets();
+
+        Destroy();
+    }
+}
+
+//!
+//! \brief  Another thread waits on the targets while the jobs are batched,
+//!         every job is submitted and the stream stays valid
+//!
+TEST_F(MediaVpRenderBatchDdiTest, SyncFromAnotherThread)
+{
+    const uint32_t rounds = 64;
+
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int p = 0; p < m_driverLoader.GetPlatformNum(); p++)
+    {
+        if (!Init(platforms[p]))
+        {
+            continue;
+        }
+
+        VADriverContextP ctx  = &m_driverLoader.m_ctx;
+        atomic<bool>     done(false);
+        thread waiter([&]() {
+            for (uint32_t i = 0; !done.load(); i = (i + 1) % m_targetNum)
+            {
+                VASurfaceStatus status = VASurfaceRendering;
+                ctx->vtable->vaQuerySurfaceStatus(ctx, m_targets[i], &status);
+                if (i == 0)
+                {
+                    ctx->vtable->vaSyncSurface(ctx, m_sources[m_targetNum / 2]);
+                }
+            }
+        });
+
+        for (uint32_t round = 0; round < rounds; round++)
+        {
+            for (uint32_t i = 0; i < m_targetNum; i++)
+            {
+                RenderJob(i);
+            }
+            // A job is never left behind by a submission from the waiter
+            CheckTargets();
+        }
+        done = true;
+        waiter.join();
+
+        // No more submissions than jobs, no fewer than full batches
+        uint32_t submissions = g_vpSubmissions.load();
+        EXPECT_LE(submissions, rounds * m_targetNum) << g_platformName[platforms[p]];
+        EXPECT_GE(submissions, rounds * m_targetNum / m_batchSize) << g_platformName[platforms[p]];
+
+        Destroy();
+    }
+}
+
+//!
+//! \brief  The window is checked when rendering, an expired batch waits
+//!         for the next job which submits it before starting a new batch
+//!
+TEST_F(MediaVpRenderBatchDdiTest, WindowCheckedOnNextRender)
+{
+    const uint32_t windowUs = 2000;
+
+    vector<Platform_t> platforms = m_driverLoader.GetPlatforms();
+    for (int p = 0; p < m_driverLoader.GetPlatformNum(); p++)
+    {
+        if (!Init(platforms[p], windowUs))
+        {
+            continue;
+        }
+
+        RenderJob(0);
+        this_thread::sleep_for(chrono::microseconds(4 * windowUs));
+        EXPECT_EQ(0u, g_vpSubmissions.load()) << g_platformName[platforms[p]];
+
+        RenderJob(1);
+        EXPECT_EQ(1u, g_vpSubmissions.load()) << g_platformName[platforms[p]];
+        CheckTargets();
+        EXPECT_EQ(2u, g_vpSubmissions.load()) << g_platformName[platforms[p]];
+
+        Destroy();
+    }
+}
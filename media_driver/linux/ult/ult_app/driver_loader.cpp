@@ -117,9 +117,29 @@ VAStatus DriverDllLoader::InitDriver(Platform_t platform_id)
     }
     m_drvSyms.MOS_SetUltFlag(1);
     *m_drvSyms.ppfnUltGetCmdBuf = UltGetCmdBuf;
+    if (m_drvSyms.MOS_SetUltUserFeature)
+    {
+        for (auto &userFeature : m_userFeatures)
+        {
+            m_drvSyms.MOS_SetUltUserFeature(userFeature.first.c_str(), userFeature.second);
+        }
+    }
     return m_drvSyms.__vaDriverInit_(&m_ctx);
 }
 
+void DriverDllLoader::SetUserFeature(const char *valueName, int64_t value)
+{
+    for (auto &userFeature : m_userFeatures)
+    {
+        if (userFeature.first == valueName)
+        {
+            userFeature.second = value;
+            return;
+        }
+    }
+    m_userFeatures.push_back(std::make_pair(std::string(valueName), value));
+}
+
 VAStatus DriverDllLoader::LoadDriverSymbols()
 {
     const int buf_len         = 256;
@@ -147,7 +167,12 @@ VAStatus DriverDllLoader::LoadDriverSymbols()
             m_drvSyms.MOS_SetUltFlag            = (MOS_SetUltFlagFunc)dlsym(m_umdhandle, "MOS_SetUltFlag");
             m_drvSyms.MOS_GetMemNinjaCounter    = (MOS_GetMemNinjaCounterFunc)dlsym(m_umdhandle, "MOS_GetMemNinjaCounter");
             m_drvSyms.MOS_GetMemNinjaCounterGfx = (MOS_GetMemNinjaCounterFunc)dlsym(m_umdhandle, "MOS_GetMemNinjaCounterGfx");
+            m_drvSyms.MOS_SetLockProfileEnable  = (MOS_SetLockProfileEnableFunc)dlsym(m_umdhandle, "MOS_SetLockProfileEnable");
+            m_drvSyms.MOS_GetLockProfileStats   = (MOS_GetLockProfileStatsFunc)dlsym(m_umdhandle, "MOS_GetLockProfileStats");
+            m_drvSyms.MOS_SetResourceRecyclerSize  = (MOS_SetResourceRecyclerSizeFunc)dlsym(m_umdhandle, "MOS_SetResourceRecyclerSize");
+            m_drvSyms.MOS_GetResourceRecyclerStats = (MOS_GetResourceRecyclerStatsFunc)dlsym(m_umdhandle, "MOS_GetResourceRecyclerStats");
             m_drvSyms.ppfnUltGetCmdBuf          = (UltGetCmdBufFunc *)dlsym(m_umdhandle, "pfnUltGetCmdBuf");
+            m_drvSyms.MOS_SetUltUserFeature     = (MOS_SetUltUserFeatureFunc)dlsym(m_umdhandle, "MOS_SetUltUserFeature");
             break;
         }
     }
@@ -22,10 +22,14 @@
 #ifndef __DRIVER_LOADER_H__
 #define __DRIVER_LOADER_H__
 
+#include <string>
+#include <utility>
 #include <vector>
 #include "devconfig.h"
 #include "mos_defs_specific.h"
 #include "mos_os.h"
+#include "mos_lock_profile.h"
+#include "mos_resource_recycler.h"
 #include "va/va_drmcommon.h"
 #include "va/va_backend.h"
 #include "va/va_backend_vpp.h"
@@ -77,6 +81,16 @@ typedef int32_t (*MOS_GetMemNinjaCounterFunc)();
 
 typedef void (*UltGetCmdBufFunc)(PMOS_COMMAND_BUFFER pCmdBuffer);
 
+typedef void (*MOS_SetLockProfileEnableFunc)(bool enable);
+
+typedef uint32_t (*MOS_GetLockProfileStatsFunc)(PMOS_LOCK_SITE_STATS pStats, uint32_t uiMaxSites);
+
+typedef void (*MOS_SetUltUserFeatureFunc)(const char *valueName, int64_t value);
+
+typedef void (*MOS_SetResourceRecyclerSizeFunc)(uint64_t maxSize);
+
+typedef uint32_t (*MOS_GetResourceRecyclerStatsFunc)(PMOS_RESOURCE_RECYCLER_STATS pStats, uint32_t uiMaxStats);
+
 struct DriverSymbols
 {
     bool Initialized() const
@@ -100,6 +114,13 @@ struct DriverSymbols
     MOS_GetMemNinjaCounterFunc  MOS_GetMemNinjaCounter;
     MOS_GetMemNinjaCounterFunc  MOS_GetMemNinjaCounterGfx;
 
+    // Optional, not checked by Initialized()
+    MOS_SetUltUserFeatureFunc   MOS_SetUltUserFeature;
+    MOS_SetLockProfileEnableFunc MOS_SetLockProfileEnable;
+    MOS_GetLockProfileStatsFunc MOS_GetLockProfileStats;
+    MOS_SetResourceRecyclerSizeFunc MOS_SetResourceRecyclerSize;
+    MOS_GetResourceRecyclerStatsFunc MOS_GetResourceRecyclerStats;
+
     // Data
     UltGetCmdBufFunc            *ppfnUltGetCmdBuf;
 };
@@ -120,6 +141,19 @@ public:
 
     VAStatus InitDriver(Platform_t platform_id);
 
+    //!
+    //! \brief  Force a user feature value in the drivers initialized after
+    //!         the call, until ClearUserFeatures()
+    //!
+    void SetUserFeature(const char *valueName, int64_t value);
+
+    //!
+    //! \brief  Whether the initialized driver takes the forced user features
+    //!
+    bool UserFeaturesForced() const { return m_drvSyms.MOS_SetUltUserFeature != nullptr; }
+
+    void ClearUserFeatures() { m_userFeatures.clear(); }
+
     VAStatus CloseDriver(bool detectMemLeak = true);
 
 public:
@@ -140,6 +174,7 @@ private:
     drm_state                   m_drmstate        = {};
     Platform_t                  m_currentPlatform = igfxSKLAKE;
     std::vector<Platform_t>     m_platformArray;
+    std::vector<std::pair<std::string, int64_t>> m_userFeatures;
 };
 
 #endif // __DRIVER_LOADER_H__
@@ -0,0 +1,298 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include "gtest/gtest.h"
+#include "hal_kerneldll.h"
+
+using namespace std;
+
+extern const Kdll_RuleEntry g_KdllRuleTable_g8[];
+extern const Kdll_RuleEntry g_KdllRuleTable_g9[];
+extern const Kdll_RuleEntry g_KdllRuleTable_g10[];
+extern const Kdll_RuleEntry g_KdllRuleTable_g11[];
+
+//!
+//! \brief  Runs the compiled and the linear rule search side by side
+//! \details The linear search is the same state with the compiled index
+//!          taken away. Every rule set of a table seeds a search state that
+//!          satisfies its non format conditions, and from each seed the
+//!          Src0, Src1 and Layer formats are swept over every MOS format and
+//!          color space. The compiled index only filters on those formats,
+//!          so this covers every decision it can take differently.
+//!
+class KernelDllRuleTest : public testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        MOS_FreeMemory(m_state.pSortedRules);
+        MOS_FreeMemory(m_state.pRuleSetMasks);
+        MOS_FreeMemory(m_state.pRuleIndex);
+        MOS_FreeMemory(m_state.pRuleIndexOffset);
+    }
+
+    void Compile(const Kdll_RuleEntry *rules)
+    {
+        MOS_ZeroMemory(&m_state, sizeof(m_state));
+        m_state.pRuleTableDefault = rules;
+        ASSERT_TRUE(KernelDll_SortRuleTable(&m_state));
+        ASSERT_NE(nullptr, m_state.pRuleIndex);
+
+        m_linear            = m_state;
+        m_linear.pRuleIndex = nullptr;
+    }
+
+    //!
+    //! \brief  First format of a format condition that satisfies it
+    //!
+    static MOS_FORMAT ConcreteFormat(MOS_FORMAT match, VPHAL_CSPACE cspace)
+    {
+        for (int32_t format = Format_None; format < Format_Count; format++)
+        {
+            if (KernelDll_IsFormat((MOS_FORMAT)format, cspace, match))
+            {
+                return (MOS_FORMAT)format;
+            }
+        }
+        return match;
+    }
+
+    //!
+    //! \brief  Search state that meets the conditions of a rule set
+    //!
+    static void Seed(Kdll_SearchState *search, Kdll_ParserState state, const Kdll_RuleEntrySet *ruleSet)
+    {
+        Kdll_FilterEntry *filter = &search->Filter[0];
+        uint32_t          seen[RID_IsConstOutAlpha + 1] = {};
+
+        search->pFilter        = filter;
+        search->state          = state;
+        search->cspace         = CSpace_sRGB;
+        filter->cspace         = CSpace_sRGB;
+        filter->format         = Format_A8R8G8B8;
+        search->src0_format    = Format_A8R8G8B8;
+        search->src1_format    = Format_None;
+        search->target_format  = Format_A8R8G8B8;
+
+        const Kdll_RuleEntry *entry = ruleSet->pRuleEntry;
+        for (int32_t i = 0; i < ruleSet->iMatchCount; i++, entry++)
+        {
+            // The first entry of an "Or" list is enough
+            if (entry->id > RID_IsConstOutAlpha || seen[entry->id]++)
+            {
+                continue;
+            }
+
+            switch (entry->id)
+            {
+                case RID_IsTargetCspace:     search->cspace = (VPHAL_CSPACE)entry->value; break;
+                case RID_IsLayerID:          filter->layer = (Kdll_Layer)entry->value; break;
+                case RID_IsLayerFormat:      filter->format = ConcreteFormat((MOS_FORMAT)entry->value, filter->cspace); break;
+                case RID_IsParserState:      search->state = (Kdll_ParserState)entry->value; break;
+                case RID_IsRenderMethod:     filter->RenderMethod = (Kdll_RenderMethod)entry->value; break;
+                case RID_IsShuffling:        search->ShuffleSamplerData = (Kdll_Shuffling)entry->value; break;
+                case RID_IsDualOutput:       filter->dualout = entry->value ? true : false; break;
+                case RID_IsLayerRotation:    filter->rotation = (VPHAL_ROTATION)entry->value; break;
+                case RID_IsRTRotate:         search->bRTRotate = entry->value ? true : false; break;
+                case RID_IsSrc0Format:       search->src0_format = ConcreteFormat((MOS_FORMAT)entry->value, search->cspace); break;
+                case RID_IsSrc0Sampling:     search->src0_sampling = (Kdll_Sampling)entry->value; break;
+                case RID_IsSrc0Rotation:     search->src0_rotation = (VPHAL_ROTATION)entry->value; break;
+                case RID_IsSrc0ColorFill:    search->src0_colorfill = entry->value; break;
+                case RID_IsSrc0LumaKey:      search->src0_lumakey = entry->value; break;
+                case RID_IsSrc0Procamp:      filter->procamp = entry->value; break;
+                case RID_IsSrc0Internal:     search->src0_internal = (Kdll_IntFormat)entry->value; break;
+                case RID_IsSrc0Coeff:        search->src0_coeff = (Kdll_CoeffID)entry->value; break;
+                case RID_IsSrc0Processing:   search->src0_process = (Kdll_Processing)entry->value; break;
+                case RID_IsSrc0Chromasiting: filter->chromasiting = entry->value; break;
+                case RID_IsSrc1Format:       search->src1_format = ConcreteFormat((MOS_FORMAT)entry->value, search->cspace); break;
+                case RID_IsSrc1Sampling:     search->src1_sampling = (Kdll_Sampling)entry->value; break;
+                case RID_IsSrc1LumaKey:      search->src1_lumakey = entry->value; break;
+                case RID_IsSrc1Procamp:      filter->procamp = entry->value; break;
+                case RID_IsSrc1Internal:     search->src1_internal = (Kdll_IntFormat)entry->value; break;
+                case RID_IsSrc1Coeff:        search->src1_coeff = (Kdll_CoeffID)entry->value; break;
+                case RID_IsSrc1Processing:   search->src1_process = (Kdll_Processing)entry->value; break;
+                case RID_IsSrc1Chromasiting: filter->chromasiting = entry->value; break;
+                case RID_IsLayerNumber:      search->layer_number = entry->value; break;
+                case RID_IsQuadrant:         search->quadrant = entry->value; break;
+                case RID_IsCSCBeforeMix:     search->bCscBeforeMix = entry->value ? true : false; break;
+                case RID_IsTargetFormat:     search->target_format = (MOS_FORMAT)entry->value; break;
+                case RID_Is64BSaveEnabled:   search->b64BSaveEnabled = entry->value ? true : false; break;
+                case RID_IsTargetTileType:   search->target_tiletype = (MOS_TILE_TYPE)entry->value; break;
+                case RID_IsProcampEnabled:   search->bProcamp = entry->value ? true : false; break;
+                case RID_IsSetCoeffMode:     filter->SetCSCCoeffMode = (Kdll_SetCSCCoeffMethod)entry->value; break;
+                case RID_IsConstOutAlpha:    filter->bFillOutputAlphaWithConstant = entry->value ? true : false; break;
+                default:                     break;
+            }
+        }
+    }
+
+    //!
+    //! \brief  Both searches must pick the same rule set, or both none
+    //!
+    void Check(Kdll_SearchState *search)
+    {
+        bool                      found    = KernelDll_FindRule(&m_state, search);
+        const Kdll_RuleEntrySet  *compiled = search->pMatchingRuleSet;
+        bool                      expected = KernelDll_FindRule(&m_linear, search);
+
+        m_lookups++;
+        m_matches += expected ? 1 : 0;
+        if (found != expected || compiled != search->pMatchingRuleSet)
+        {
+            m_mismatches++;
+            if (m_mismatches <= 10)
+            {
+                ADD_FAILURE() << "state " << search->state << " src0 " << search->src0_format
+                              << " src1 " << search->src1_format << " layer " << search->pFilter->format
+                              << " cspace " << search->cspace << "/" << search->pFilter->cspace
+                              << ": compiled " << (compiled ? compiled - m_state.pSortedRules : -1)
+                              << ", linear " << (expected ? search->pMatchingRuleSet - m_state.pSortedRules : -1);
+            }
+        }
+    }
+
+    void Sweep(const Kdll_RuleEntry *rules)
+    {
+        Compile(rules);
+
+        unique_ptr<Kdll_SearchState> seed(new Kdll_SearchState);
+        unique_ptr<Kdll_SearchState> search(new Kdll_SearchState);
+
+        m_lookups = m_matches = m_mismatches = 0;
+        for (int32_t state = 0; state < Parser_Count; state++)
+        {
+            // The empty seed, then one per rule set
+            for (int32_t r = -1; r < m_state.iDllRuleCount[state]; r++)
+            {
+                MOS_ZeroMemory(seed.get(), sizeof(Kdll_SearchState));
+                if (r >= 0)
+                {
+                    Seed(seed.get(), (Kdll_ParserState)state, m_state.pDllRuleTable[state] + r);
+                }
+                else
+                {
+                    seed->pFilter = &seed->Filter[0];
+                    seed->state   = (Kdll_ParserState)state;
+                }
+
+                for (int32_t cspace = CSpace_None; cspace < CSpace_Count; cspace++)
+                {
+                    for (int32_t format = Format_Invalid; format < Format_Count; format++)
+                    {
+                        // Src0, with the color space of the palette
+                        memcpy(search.get(), seed.get(), sizeof(Kdll_SearchState));
+                        search->pFilter     = &search->Filter[0];
+                        search->cspace      = (VPHAL_CSPACE)cspace;
+                        search->src0_format = (MOS_FORMAT)format;
+                        Check(search.get());
+
+                        // Layer
+                        memcpy(search.get(), seed.get(), sizeof(Kdll_SearchState));
+                        search->pFilter         = &search->Filter[0];
+                        search->pFilter->cspace = (VPHAL_CSPACE)cspace;
+                        search->pFilter->format = (MOS_FORMAT)format;
+                        Check(search.get());
+
+                        // Src1
+                        memcpy(search.get(), seed.get(), sizeof(Kdll_SearchState));
+                        search->pFilter     = &search->Filter[0];
+                        search->cspace      = (VPHAL_CSPACE)cspace;
+                        search->src1_format = (MOS_FORMAT)format;
+                        Check(search.get());
+                    }
+                }
+            }
+        }
+
+        cout << m_lookups << " lookups, " << m_matches << " matched" << endl;
+        EXPECT_EQ(0u, m_mismatches);
+        EXPECT_GT(m_matches, 0u);
+    }
+
+    Kdll_State m_state  = {};
+    Kdll_State m_linear = {};
+    uint64_t   m_lookups    = 0;
+    uint64_t   m_matches    = 0;
+    uint64_t   m_mismatches = 0;
+};
+
+TEST_F(KernelDllRuleTest, SweepGen8)
+{
+    Sweep(g_KdllRuleTable_g8);
+}
+
+TEST_F(KernelDllRuleTest, SweepGen9)
+{
+    Sweep(g_KdllRuleTable_g9);
+}
+
+TEST_F(KernelDllRuleTest, SweepGen10)
+{
+    Sweep(g_KdllRuleTable_g10);
+}
+
+TEST_F(KernelDllRuleTest, SweepGen11)
+{
+    Sweep(g_KdllRuleTable_g11);
+}
+
+//!
+//! \brief  Lookup time of the compiled and the linear search over the seeds
+//!
+TEST_F(KernelDllRuleTest, LookupTime)
+{
+    Compile(g_KdllRuleTable_g9);
+
+    const uint32_t               iterations = 20;
+    unique_ptr<Kdll_SearchState> search(new Kdll_SearchState);
+    double                       ns[3]   = {};
+    uint64_t                     lookups = 0;
+
+    // Compiled, linear, then seeding alone to take out of both
+    for (uint32_t pass = 0; pass < 3; pass++)
+    {
+        Kdll_State *state = (pass == 0) ? &m_state : &m_linear;
+        lookups = 0;
+        auto start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            for (int32_t s = 0; s < Parser_Count; s++)
+            {
+                for (int32_t r = 0; r < m_state.iDllRuleCount[s]; r++)
+                {
+                    MOS_ZeroMemory(search.get(), sizeof(Kdll_SearchState));
+                    Seed(search.get(), (Kdll_ParserState)s, m_state.pDllRuleTable[s] + r);
+                    if (pass < 2)
+                    {
+                        KernelDll_FindRule(state, search.get());
+                    }
+                    lookups++;
+                }
+            }
+        }
+        ns[pass] = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / (double)lookups;
+    }
+
+    cout << "rule lookup: compiled " << ns[0] - ns[2] << " ns, linear " << ns[1] - ns[2] << " ns" << endl;
+}
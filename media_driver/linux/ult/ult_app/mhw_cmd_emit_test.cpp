@@ -0,0 +1,674 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include "gtest/gtest.h"
+#include "mhw_utilities.h"
+#include "mhw_vdbox_mfx_hwcmd_g9_skl.h"
+#include "mhw_vebox_g9_X.h"
+
+using namespace std;
+
+typedef mhw_vdbox_mfx_g9_skl Cmds;
+
+//!
+//! \brief  The picture level MFX commands of an AVC decode that MHW builds
+//!         in place, with fields set the way MHW sets them
+//!
+template <class TCmd>
+static void FillCmd(TCmd &cmd, uint32_t frame);
+
+template <>
+void FillCmd(Cmds::MFX_PIPE_MODE_SELECT_CMD &cmd, uint32_t frame)
+{
+    cmd.DW1.StandardSelect                              = 2;
+    cmd.DW1.PreDeblockingOutputEnablePredeblockoutenable = frame & 1;
+    cmd.DW1.DecoderShortFormatMode                      = 1;
+}
+
+template <>
+void FillCmd(Cmds::MFX_SURFACE_STATE_CMD &cmd, uint32_t frame)
+{
+    cmd.DW1.SurfaceId     = frame & 3;
+    cmd.DW2.Height        = 1079;
+    cmd.DW2.Width         = 1919;
+    cmd.DW3.SurfacePitch  = 2047;
+    cmd.DW4.YOffsetForUCb = 1088;
+}
+
+template <>
+void FillCmd(Cmds::MFX_IND_OBJ_BASE_ADDR_STATE_CMD &cmd, uint32_t frame)
+{
+    cmd.DW1.Value = frame << 12;
+    cmd.DW2.Value = 1;
+}
+
+template <>
+void FillCmd(Cmds::MFX_BSP_BUF_BASE_ADDR_STATE_CMD &cmd, uint32_t frame)
+{
+    cmd.DW1.Value = frame << 6;
+    cmd.DW2.Value = 1;
+}
+
+template <>
+void FillCmd(Cmds::MFX_AVC_IMG_STATE_CMD &cmd, uint32_t frame)
+{
+    cmd.DW1.FrameSize   = 8160;
+    cmd.DW2.FrameWidth  = 119;
+    cmd.DW2.FrameHeight = 67;
+    cmd.DW3.Value       = frame;
+}
+
+template <>
+void FillCmd(Cmds::MFX_AVC_DIRECTMODE_STATE_CMD &cmd, uint32_t frame)
+{
+    for (uint32_t i = 0; i < 34; i++)
+    {
+        cmd.PocList[i] = frame * 2 + i;
+    }
+}
+
+//!
+//! \brief  Emission of the AVC picture commands the way MHW did it, built on
+//!         the stack and copied, and built in place with Mhw_BeginCmd
+//! \details The copy goes to a batch buffer, so the old path is the real
+//!          Mhw_AddCommandBB and not a copy of Mos_AddCommand, which needs
+//!          the OS interface. Both write the same bytes to plain memory.
+//!
+class MhwCmdEmitTest : public testing::Test
+{
+protected:
+
+    static const uint32_t m_frameNum = 64;
+
+    void SetUp()
+    {
+        m_bbData.assign(m_frameNum * FrameSize(), 0);
+        m_cbData.assign(m_frameNum * FrameSize() / sizeof(uint32_t), 0);
+    }
+
+    static uint32_t FrameSize()
+    {
+        return sizeof(Cmds::MFX_PIPE_MODE_SELECT_CMD) + sizeof(Cmds::MFX_SURFACE_STATE_CMD) +
+               sizeof(Cmds::MFX_IND_OBJ_BASE_ADDR_STATE_CMD) + sizeof(Cmds::MFX_BSP_BUF_BASE_ADDR_STATE_CMD) +
+               sizeof(Cmds::MFX_AVC_IMG_STATE_CMD) + sizeof(Cmds::MFX_AVC_DIRECTMODE_STATE_CMD);
+    }
+
+    void ResetBatchBuffer()
+    {
+        memset(&m_batchBuffer, 0, sizeof(m_batchBuffer));
+        m_batchBuffer.pData      = m_bbData.data();
+        m_batchBuffer.iSize      = (int32_t)m_bbData.size();
+        m_batchBuffer.iRemaining = m_batchBuffer.iSize;
+    }
+
+    void ResetCmdBuffer()
+    {
+        memset(&m_cmdBuffer, 0, sizeof(m_cmdBuffer));
+        m_cmdBuffer.pCmdBase   = m_cbData.data();
+        m_cmdBuffer.pCmdPtr    = m_cbData.data();
+        m_cmdBuffer.iRemaining = (int32_t)(m_cbData.size() * sizeof(uint32_t));
+    }
+
+    template <class TCmd>
+    MOS_STATUS AddOnStack(uint32_t frame)
+    {
+        TCmd cmd;
+        FillCmd(cmd, frame);
+        return Mhw_AddCommandBB(&m_batchBuffer, &cmd, sizeof(cmd));
+    }
+
+    template <class TCmd>
+    MOS_STATUS AddInPlace(uint32_t frame)
+    {
+        MOS_STATUS eStatus = Mhw_ReserveCmdSpace(&m_cmdBuffer, sizeof(TCmd));
+        if (eStatus != MOS_STATUS_SUCCESS)
+        {
+            return eStatus;
+        }
+        auto &cmd = Mhw_BeginCmd<TCmd>(&m_cmdBuffer);
+        FillCmd(cmd, frame);
+        Mhw_EndCmd(&m_cmdBuffer, cmd);
+        return MOS_STATUS_SUCCESS;
+    }
+
+    template <class TCmd, bool inPlace>
+    MOS_STATUS Add(uint32_t frame)
+    {
+        return inPlace ? AddInPlace<TCmd>(frame) : AddOnStack<TCmd>(frame);
+    }
+
+    //!
+    //! \brief  Emits the picture commands of all frames
+    //! \return int32_t
+    //!         Bytes emitted, negative on failure
+    //!
+    template <bool inPlace>
+    int32_t EmitFrames()
+    {
+        for (uint32_t frame = 0; frame < m_frameNum; frame++)
+        {
+            if (Add<Cmds::MFX_PIPE_MODE_SELECT_CMD, inPlace>(frame) != MOS_STATUS_SUCCESS ||
+                Add<Cmds::MFX_SURFACE_STATE_CMD, inPlace>(frame) != MOS_STATUS_SUCCESS ||
+                Add<Cmds::MFX_IND_OBJ_BASE_ADDR_STATE_CMD, inPlace>(frame) != MOS_STATUS_SUCCESS ||
+                Add<Cmds::MFX_BSP_BUF_BASE_ADDR_STATE_CMD, inPlace>(frame) != MOS_STATUS_SUCCESS ||
+                Add<Cmds::MFX_AVC_IMG_STATE_CMD, inPlace>(frame) != MOS_STATUS_SUCCESS ||
+                Add<Cmds::MFX_AVC_DIRECTMODE_STATE_CMD, inPlace>(frame) != MOS_STATUS_SUCCESS)
+            {
+                return -1;
+            }
+        }
+        return inPlace ? m_cmdBuffer.iOffset : m_batchBuffer.iCurrent;
+    }
+
+    MHW_BATCH_BUFFER    m_batchBuffer;
+    MOS_COMMAND_BUFFER  m_cmdBuffer;
+    vector<uint8_t>     m_bbData;
+    vector<uint32_t>    m_cbData;
+};
+
+TEST_F(MhwCmdEmitTest, InPlaceMatchesOnStack)
+{
+    ResetBatchBuffer();
+    ASSERT_EQ((int32_t)m_bbData.size(), EmitFrames<false>());
+    EXPECT_EQ(0, m_batchBuffer.iRemaining);
+
+    memset(m_cbData.data(), 0xA5, m_cbData.size() * sizeof(uint32_t));
+    ResetCmdBuffer();
+    ASSERT_EQ((int32_t)m_bbData.size(), EmitFrames<true>());
+    EXPECT_EQ(0, m_cmdBuffer.iRemaining);
+    EXPECT_EQ(m_cbData.data() + m_cbData.size(), m_cmdBuffer.pCmdPtr);
+    EXPECT_EQ(0, memcmp(m_bbData.data(), m_cbData.data(), m_bbData.size()));
+}
+
+TEST_F(MhwCmdEmitTest, NoSpace)
+{
+    ResetCmdBuffer();
+    m_cmdBuffer.iRemaining = sizeof(Cmds::MFX_AVC_IMG_STATE_CMD) - sizeof(uint32_t);
+    EXPECT_NE(MOS_STATUS_SUCCESS, AddInPlace<Cmds::MFX_AVC_IMG_STATE_CMD>(0));
+    EXPECT_EQ(m_cbData.data(), m_cmdBuffer.pCmdPtr);
+    EXPECT_EQ(0, m_cmdBuffer.iOffset);
+}
+
+//!
+//! \brief  Time to emit the picture commands, per frame
+//!
+TEST_F(MhwCmdEmitTest, Benchmark)
+{
+    const uint32_t roundNum = 2000;
+
+    double onStack = 0, inPlace = 0;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        auto start = chrono::steady_clock::now();
+        for (uint32_t round = 0; round < roundNum; round++)
+        {
+            ResetBatchBuffer();
+            ASSERT_LT(0, EmitFrames<false>());
+        }
+        auto mid = chrono::steady_clock::now();
+        for (uint32_t round = 0; round < roundNum; round++)
+        {
+            ResetCmdBuffer();
+            ASSERT_LT(0, EmitFrames<true>());
+        }
+        auto end = chrono::steady_clock::now();
+
+        // The first pass warms up the caches
+        onStack = chrono::duration<double, nano>(mid - start).count() / (roundNum * m_frameNum);
+        inPlace = chrono::duration<double, nano>(end - mid).count() / (roundNum * m_frameNum);
+    }
+
+    cout << "AVC picture commands (" << FrameSize() << " bytes): " << fixed << setprecision(1)
+         << onStack << " ns on the stack, " << inPlace << " ns in place per frame" << endl;
+}
+
+//!
+//! \brief  Resources of the VEBOX commands; the fake OS interface gives each
+//!         a graphics address from its index and records the patch entries
+//!
+static const uint32_t            g_veboxResourceNum = 12;
+static MOS_RESOURCE              g_veboxResources[g_veboxResourceNum];
+static vector<MOS_PATCH_ENTRY_PARAMS> g_patchEntries;
+static vector<uint8_t>           g_veboxHeapMem;
+
+static MOS_STATUS FakeRegisterResource(PMOS_INTERFACE, PMOS_RESOURCE, int32_t, int32_t)
+{
+    return MOS_STATUS_SUCCESS;
+}
+
+static int32_t FakeGetResourceAllocationIndex(PMOS_INTERFACE, PMOS_RESOURCE resource)
+{
+    return (int32_t)(resource - g_veboxResources);
+}
+
+static uint64_t FakeGetResourceGfxAddress(PMOS_INTERFACE, PMOS_RESOURCE resource)
+{
+    return ((uint64_t)(resource - g_veboxResources) + 1) << 32 | 0x10000000;
+}
+
+static MOS_STATUS FakeSetPatchEntry(PMOS_INTERFACE, PMOS_PATCH_ENTRY_PARAMS params)
+{
+    g_patchEntries.push_back(*params);
+    return MOS_STATUS_SUCCESS;
+}
+
+#if MOS_MESSAGES_ENABLED
+static MOS_STATUS FakeAllocateResource(PMOS_INTERFACE, PMOS_ALLOC_GFXRES_PARAMS params, const char *, const char *, int32_t, PMOS_RESOURCE)
+#else
+static MOS_STATUS FakeAllocateResource(PMOS_INTERFACE, PMOS_ALLOC_GFXRES_PARAMS params, PMOS_RESOURCE)
+#endif
+{
+    g_veboxHeapMem.assign(params->dwBytes, 0);
+    return MOS_STATUS_SUCCESS;
+}
+
+static void *FakeLockResource(PMOS_INTERFACE, PMOS_RESOURCE, PMOS_LOCK_PARAMS)
+{
+    return g_veboxHeapMem.data();
+}
+
+//!
+//! \brief  Resource of a VEBOX command as the old emission added it
+//!
+struct VeboxCmdResource
+{
+    PMOS_RESOURCE resource;
+    uint32_t      offset;
+    uint32_t     *pdwCmd;
+    uint32_t      location;
+    bool          writable;
+    bool          sharedMocs;
+};
+
+//!
+//! \brief  Gen9 VEBOX_STATE and VEB_DI_IECP of a DN/DI frame, emitted by the
+//!         real MhwVeboxInterfaceG9 and by the old path: the command built on
+//!         the stack, its resources added the same way and Mos_AddCommand
+//!
+class MhwVeboxCmdEmitTest : public testing::Test
+{
+protected:
+
+    static const uint32_t m_frameNum = 64;
+
+    MhwVeboxCmdEmitTest() : m_vebox(InitOsInterface(&m_osInterface))
+    {
+    }
+
+    static PMOS_INTERFACE InitOsInterface(PMOS_INTERFACE osInterface)
+    {
+        MOS_ZeroMemory(osInterface, sizeof(*osInterface));
+        osInterface->bUsesGfxAddress               = true;
+        osInterface->pfnRegisterResource           = FakeRegisterResource;
+        osInterface->pfnGetResourceAllocationIndex = FakeGetResourceAllocationIndex;
+        osInterface->pfnGetResourceGfxAddress      = FakeGetResourceGfxAddress;
+        osInterface->pfnSetPatchEntry              = FakeSetPatchEntry;
+        osInterface->pfnAllocateResource           = FakeAllocateResource;
+        osInterface->pfnLockResource               = FakeLockResource;
+        return osInterface;
+    }
+
+    void SetUp()
+    {
+        MOS_ZeroMemory(&m_veboxHeap, sizeof(m_veboxHeap));
+        m_veboxHeap.uiDndiStateOffset            = 0x40;
+        m_veboxHeap.uiIecpStateOffset            = 0x400;
+        m_veboxHeap.uiGamutStateOffset           = 0xC00;
+        m_veboxHeap.uiVertexTableOffset          = 0x1400;
+        m_veboxHeap.uiCapturePipeStateOffset     = 0x1C00;
+        m_veboxHeap.uiGammaCorrectionStateOffset = 0x1D00;
+        m_veboxHeap.uiInstanceSize               = 0x3000;
+        m_vebox.m_veboxHeap                      = &m_veboxHeap;
+
+        m_cbData.assign(m_frameNum * FrameSize() / sizeof(uint32_t), 0);
+        g_patchEntries.reserve(m_frameNum * 20);
+    }
+
+    void TearDown()
+    {
+        m_vebox.m_veboxHeap = nullptr;
+        g_patchEntries.clear();
+    }
+
+    static uint32_t FrameSize()
+    {
+        return sizeof(mhw_vebox_g9_X::VEBOX_STATE_CMD) + sizeof(mhw_vebox_g9_X::VEB_DI_IECP_CMD);
+    }
+
+    void ResetCmdBuffer()
+    {
+        memset(&m_cmdBuffer, 0, sizeof(m_cmdBuffer));
+        m_cmdBuffer.pCmdBase   = m_cbData.data();
+        m_cmdBuffer.pCmdPtr    = m_cbData.data();
+        m_cmdBuffer.iRemaining = (int32_t)(m_cbData.size() * sizeof(uint32_t));
+        g_patchEntries.clear();
+    }
+
+    //!
+    //! \brief  Parameters of the frame, DN and DI alternate with the frame number
+    //!
+    void SetFrameParams(uint32_t frame)
+    {
+        m_veboxHeap.uiCurState = frame % 3;
+
+        MOS_ZeroMemory(&m_stateParams, sizeof(m_stateParams));
+        m_stateParams.VeboxMode.GlobalIECPEnable      = 1;
+        m_stateParams.VeboxMode.DNEnable              = 1;
+        m_stateParams.VeboxMode.DIEnable              = frame & 1;
+        m_stateParams.VeboxMode.DNDIFirstFrame        = frame == 0;
+        m_stateParams.VeboxMode.DIOutputFrames        = frame & 1;
+        m_stateParams.VeboxMode.SingleSliceVeboxEnable = 1;
+
+        MOS_ZeroMemory(&m_diIecpParams, sizeof(m_diIecpParams));
+        m_diIecpParams.dwStartingX                          = 0;
+        m_diIecpParams.dwEndingX                            = 1919;
+        m_diIecpParams.dwCurrInputSurfOffset                = 0;
+        m_diIecpParams.CurInputSurfMMCState                 = (frame & 2) ? MOS_MEMCOMP_HORIZONTAL : MOS_MEMCOMP_DISABLED;
+        m_diIecpParams.CurrInputSurfCtrl.Value              = 0x2;
+        m_diIecpParams.pOsResCurrInput                      = &g_veboxResources[1];
+        m_diIecpParams.pOsResPrevInput                      = (frame & 1) ? &g_veboxResources[2] : nullptr;
+        m_diIecpParams.pOsResStmmInput                      = &g_veboxResources[3];
+        m_diIecpParams.StmmInputSurfCtrl.Value              = 0x4;
+        m_diIecpParams.pOsResStmmOutput                     = &g_veboxResources[4];
+        m_diIecpParams.pOsResDenoisedCurrOutput             = &g_veboxResources[5];
+        m_diIecpParams.pOsResCurrOutput                     = &g_veboxResources[6];
+        m_diIecpParams.CurrOutputSurfCtrl.Value             = 0x6;
+        m_diIecpParams.pOsResPrevOutput                     = (frame & 1) ? &g_veboxResources[7] : nullptr;
+        m_diIecpParams.pOsResStatisticsOutput               = &g_veboxResources[8];
+        m_diIecpParams.pOsResLaceOrAceOrRgbHistogram        = &g_veboxResources[9];
+    }
+
+    MOS_STATUS AddVeboxStateOnStack()
+    {
+        mhw_vebox_g9_X::VEBOX_STATE_CMD cmd;
+        PMHW_VEBOX_MODE                 veboxMode    = &m_stateParams.VeboxMode;
+        uint32_t                        instanceBase = m_veboxHeap.uiInstanceSize * m_veboxHeap.uiCurState;
+
+        cmd.DW1.DownsampleMethod422to420 = 1;
+        cmd.DW1.DownsampleMethod444to422 = 1;
+
+        PMOS_RESOURCE heapResource = &m_veboxHeap.DriverResource;
+        VeboxCmdResource resources[] = {
+            {heapResource, m_veboxHeap.uiDndiStateOffset + instanceBase,            &cmd.DW2.Value,        2,  false, false},
+            {heapResource, m_veboxHeap.uiIecpStateOffset + instanceBase,            &cmd.DW4.Value,        4,  false, true},
+            {heapResource, m_veboxHeap.uiGamutStateOffset + instanceBase,           &cmd.DW6.Value,        6,  false, true},
+            {heapResource, m_veboxHeap.uiVertexTableOffset + instanceBase,          &cmd.DW8.Value,        8,  false, true},
+            {heapResource, m_veboxHeap.uiCapturePipeStateOffset + instanceBase,     &cmd.DW10.Value,       10, false, true},
+            {heapResource, m_veboxHeap.uiGammaCorrectionStateOffset + instanceBase, &cmd.DW14_15.Value[0], 14, false, true}};
+        MOS_STATUS eStatus = AddResources(resources, sizeof(resources) / sizeof(resources[0]), MOS_VEBOX_STATE, 0);
+        if (eStatus != MOS_STATUS_SUCCESS)
+        {
+            return eStatus;
+        }
+
+        cmd.DW1.ColorGamutExpansionEnable    = veboxMode->ColorGamutExpansionEnable;
+        cmd.DW1.ColorGamutCompressionEnable  = veboxMode->ColorGamutCompressionEnable;
+        cmd.DW1.GlobalIecpEnable             = veboxMode->GlobalIECPEnable;
+        cmd.DW1.DnEnable                     = veboxMode->DNEnable;
+        cmd.DW1.DiEnable                     = veboxMode->DIEnable;
+        cmd.DW1.DnDiFirstFrame               = veboxMode->DNDIFirstFrame;
+        cmd.DW1.DiOutputFrames               = veboxMode->DIOutputFrames;
+        cmd.DW1.DemosaicEnable               = veboxMode->DemosaicEnable;
+        cmd.DW1.VignetteEnable               = veboxMode->VignetteEnable;
+        cmd.DW1.AlphaPlaneEnable             = veboxMode->AlphaPlaneEnable;
+        cmd.DW1.HotPixelFilteringEnable      = veboxMode->HotPixelFilteringEnable;
+        cmd.DW1.SingleSliceVeboxEnable       = veboxMode->SingleSliceVeboxEnable;
+        cmd.DW1.LaceCorrectionEnable         = veboxMode->LACECorrectionEnable;
+        cmd.DW1.DisableEncoderStatistics     = veboxMode->DisableEncoderStatistics;
+        cmd.DW1.DisableTemporalDenoiseFilter = veboxMode->DisableTemporalDenoiseFilter;
+        cmd.DW1.SinglePipeEnable             = veboxMode->SinglePipeIECPEnable;
+        cmd.DW1.ForwardGammaCorrectionEnable = veboxMode->ForwardGammaCorrectionEnable;
+
+        return Mos_AddCommand(&m_cmdBuffer, &cmd, cmd.byteSize);
+    }
+
+    MOS_STATUS AddVeboxDiIecpOnStack()
+    {
+        mhw_vebox_g9_X::VEB_DI_IECP_CMD cmd;
+        PMHW_VEBOX_DI_IECP_CMD_PARAMS   params = &m_diIecpParams;
+
+        cmd.DW2.CurrentFrameSurfaceControlBitsMemoryCompressionEnable =
+            (params->CurInputSurfMMCState != MOS_MEMCOMP_DISABLED) ? 1 : 0;
+        cmd.DW2.CurrentFrameSurfaceControlBitsMemoryCompressionMode =
+            (params->CurInputSurfMMCState == MOS_MEMCOMP_HORIZONTAL) ? 0 : 1;
+        VeboxCmdResource currInput = {params->pOsResCurrInput, params->dwCurrInputSurfOffset, &cmd.DW2.Value, 2, false, false};
+        MOS_STATUS eStatus = AddResources(&currInput, 1, MOS_VEBOX_DI_IECP, MHW_VEBOX_DI_IECP_SHIFT);
+        if (eStatus != MOS_STATUS_SUCCESS)
+        {
+            return eStatus;
+        }
+        if (params->CurInputSurfMMCState == 0)
+        {
+            cmd.DW2.Value = (cmd.DW2.Value & 0xFFFFF800) + params->CurrInputSurfCtrl.Value;
+        }
+
+        VeboxCmdResource resources[] = {
+            {params->pOsResPrevInput,               params->PrevInputSurfCtrl.Value + params->dwPrevInputSurfOffset,   &cmd.DW4.Value,  4,  false, false},
+            {params->pOsResStmmInput,               params->StmmInputSurfCtrl.Value,                                   &cmd.DW6.Value,  6,  false, false},
+            {params->pOsResStmmOutput,              params->StmmOutputSurfCtrl.Value,                                  &cmd.DW8.Value,  8,  true,  false},
+            {params->pOsResDenoisedCurrOutput,      params->DenoisedCurrOutputSurfCtrl.Value,                          &cmd.DW10.Value, 10, true,  false},
+            {params->pOsResCurrOutput,              params->CurrOutputSurfCtrl.Value + params->dwCurrOutputSurfOffset, &cmd.DW12.Value, 12, true,  false},
+            {params->pOsResPrevOutput,              params->PrevOutputSurfCtrl.Value,                                  &cmd.DW14.Value, 14, true,  false},
+            {params->pOsResStatisticsOutput,        params->StatisticsOutputSurfCtrl.Value,                            &cmd.DW16.Value, 16, true,  false},
+            {params->pOsResAlphaOrVignette,         params->AlphaOrVignetteSurfCtrl.Value,                             &cmd.DW18.Value, 18, true,  false},
+            {params->pOsResLaceOrAceOrRgbHistogram, params->LaceOrAceOrRgbHistogramSurfCtrl.Value,                     &cmd.DW20.Value, 20, true,  false},
+            {params->pOsResSkinScoreSurface,        params->SkinScoreSurfaceSurfCtrl.Value,                            &cmd.DW22.Value, 22, true,  false}};
+        eStatus = AddResources(resources, sizeof(resources) / sizeof(resources[0]), MOS_VEBOX_DI_IECP, 0);
+        if (eStatus != MOS_STATUS_SUCCESS)
+        {
+            return eStatus;
+        }
+
+        cmd.DW1.EndingX   = params->dwEndingX;
+        cmd.DW1.StartingX = params->dwStartingX;
+
+        return Mos_AddCommand(&m_cmdBuffer, &cmd, cmd.byteSize);
+    }
+
+    MOS_STATUS AddResources(VeboxCmdResource *resources, uint32_t num, MOS_HW_COMMAND hwCommandType, uint32_t lsbNum)
+    {
+        for (uint32_t i = 0; i < num; i++)
+        {
+            if (resources[i].resource == nullptr)
+            {
+                continue;
+            }
+
+            MHW_RESOURCE_PARAMS resourceParams;
+            MOS_ZeroMemory(&resourceParams, sizeof(resourceParams));
+            resourceParams.dwLsbNum        = lsbNum;
+            resourceParams.presResource    = resources[i].resource;
+            resourceParams.dwOffset        = resources[i].offset;
+            resourceParams.pdwCmd          = resources[i].pdwCmd;
+            resourceParams.dwLocationInCmd = resources[i].location;
+            resourceParams.bIsWritable     = resources[i].writable;
+            resourceParams.HwCommandType   = hwCommandType;
+            if (resources[i].sharedMocs)
+            {
+                resourceParams.dwSharedMocsOffset = 1 - resourceParams.dwLocationInCmd;
+            }
+
+            MOS_STATUS eStatus = m_vebox.pfnAddResourceToCmd(&m_osInterface, &m_cmdBuffer, &resourceParams);
+            if (eStatus != MOS_STATUS_SUCCESS)
+            {
+                return eStatus;
+            }
+        }
+        return MOS_STATUS_SUCCESS;
+    }
+
+    //!
+    //! \brief  Emits the VEBOX commands of all frames
+    //! \return int32_t
+    //!         Bytes emitted, negative on failure
+    //!
+    template <bool inPlace>
+    int32_t EmitFrames()
+    {
+        for (uint32_t frame = 0; frame < m_frameNum; frame++)
+        {
+            SetFrameParams(frame);
+            MOS_STATUS eStatus = inPlace ?
+                m_vebox.AddVeboxState(&m_cmdBuffer, &m_stateParams, false) : AddVeboxStateOnStack();
+            if (eStatus == MOS_STATUS_SUCCESS)
+            {
+                eStatus = inPlace ?
+                    m_vebox.AddVeboxDiIecp(&m_cmdBuffer, &m_diIecpParams) : AddVeboxDiIecpOnStack();
+            }
+            if (eStatus != MOS_STATUS_SUCCESS)
+            {
+                return -1;
+            }
+        }
+        return m_cmdBuffer.iOffset;
+    }
+
+    MOS_INTERFACE                m_osInterface;
+    MhwVeboxInterfaceG9          m_vebox;
+    MHW_VEBOX_HEAP               m_veboxHeap;
+    MHW_VEBOX_STATE_CMD_PARAMS   m_stateParams;
+    MHW_VEBOX_DI_IECP_CMD_PARAMS m_diIecpParams;
+    MOS_COMMAND_BUFFER           m_cmdBuffer;
+    vector<uint32_t>             m_cbData;
+};
+
+TEST_F(MhwVeboxCmdEmitTest, InPlaceMatchesOnStack)
+{
+    ResetCmdBuffer();
+    ASSERT_EQ((int32_t)(m_cbData.size() * sizeof(uint32_t)), EmitFrames<false>());
+    vector<uint32_t>               onStackCmds    = m_cbData;
+    vector<MOS_PATCH_ENTRY_PARAMS> onStackEntries = g_patchEntries;
+
+    memset(m_cbData.data(), 0xA5, m_cbData.size() * sizeof(uint32_t));
+    ResetCmdBuffer();
+    ASSERT_EQ((int32_t)(m_cbData.size() * sizeof(uint32_t)), EmitFrames<true>());
+    EXPECT_EQ(0, m_cmdBuffer.iRemaining);
+    EXPECT_EQ(m_cbData.data() + m_cbData.size(), m_cmdBuffer.pCmdPtr);
+    EXPECT_EQ(0, memcmp(onStackCmds.data(), m_cbData.data(), m_cbData.size() * sizeof(uint32_t)));
+
+    // Resources added while the command is built in place keep the offsets of the old path
+    ASSERT_FALSE(onStackEntries.empty());
+    ASSERT_EQ(onStackEntries.size(), g_patchEntries.size());
+    for (size_t i = 0; i < g_patchEntries.size(); i++)
+    {
+        EXPECT_EQ(onStackEntries[i].presResource, g_patchEntries[i].presResource) << "Patch entry " << i;
+        EXPECT_EQ(onStackEntries[i].uiResourceOffset, g_patchEntries[i].uiResourceOffset) << "Patch entry " << i;
+        EXPECT_EQ(onStackEntries[i].uiPatchOffset, g_patchEntries[i].uiPatchOffset) << "Patch entry " << i;
+        EXPECT_EQ(onStackEntries[i].bWrite, g_patchEntries[i].bWrite) << "Patch entry " << i;
+        EXPECT_EQ(onStackEntries[i].HwCommandType, g_patchEntries[i].HwCommandType) << "Patch entry " << i;
+        EXPECT_EQ(onStackEntries[i].forceDwordOffset, g_patchEntries[i].forceDwordOffset) << "Patch entry " << i;
+    }
+}
+
+TEST_F(MhwVeboxCmdEmitTest, NoSpace)
+{
+    ResetCmdBuffer();
+    SetFrameParams(0);
+    m_cmdBuffer.iRemaining = sizeof(mhw_vebox_g9_X::VEBOX_STATE_CMD) - sizeof(uint32_t);
+    EXPECT_NE(MOS_STATUS_SUCCESS, m_vebox.AddVeboxState(&m_cmdBuffer, &m_stateParams, false));
+    EXPECT_EQ(m_cbData.data(), m_cmdBuffer.pCmdPtr);
+    EXPECT_EQ(0, m_cmdBuffer.iOffset);
+    EXPECT_TRUE(g_patchEntries.empty());
+}
+
+//!
+//! \brief  An IECP block changed by AddVeboxIecpAceState or AddVeboxGamutState
+//!         is built again by the next UpdateVeboxIecpState, not kept as the
+//!         block of the same params
+//!
+TEST_F(MhwVeboxCmdEmitTest, AddStateForgetsIecpBlock)
+{
+    // The memo covers the instances of a heap made by CreateHeap
+    m_vebox.m_veboxHeap = nullptr;
+    ASSERT_EQ(MOS_STATUS_SUCCESS, m_vebox.CreateHeap());
+
+    const uint8_t *iecpState = m_vebox.m_veboxHeap->pLockedDriverResourceMem + m_vebox.m_veboxHeap->uiIecpStateOffset;
+    const size_t   iecpSize  = sizeof(mhw_vebox_g9_X::VEBOX_IECP_STATE_CMD);
+
+    MHW_VEBOX_IECP_PARAMS iecpParams;
+    MOS_ZeroMemory(&iecpParams, sizeof(iecpParams));
+    ASSERT_EQ(MOS_STATUS_SUCCESS, m_vebox.UpdateVeboxIecpState(&iecpParams));
+    vector<uint8_t> built(iecpState, iecpState + iecpSize);
+
+    MHW_VEBOX_IECP_PARAMS aceParams;
+    MOS_ZeroMemory(&aceParams, sizeof(aceParams));
+    aceParams.ColorPipeParams.bActive    = true;
+    aceParams.ColorPipeParams.bEnableACE = true;
+    aceParams.AceParams.bActive          = true;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        aceParams.AceParams.wACEPWLF_X[i] = (uint16_t)(64 + 128 * i);
+        aceParams.AceParams.wACEPWLF_Y[i] = (uint16_t)(32 + 128 * i);
+    }
+    ASSERT_EQ(MOS_STATUS_SUCCESS, m_vebox.AddVeboxIecpAceState(&aceParams));
+    ASSERT_NE(0, memcmp(built.data(), iecpState, iecpSize));
+    ASSERT_EQ(MOS_STATUS_SUCCESS, m_vebox.UpdateVeboxIecpState(&iecpParams));
+    EXPECT_EQ(0, memcmp(built.data(), iecpState, iecpSize));
+
+    MHW_VEBOX_GAMUT_PARAMS gamutParams;
+    MOS_ZeroMemory(&gamutParams, sizeof(gamutParams));
+    gamutParams.GCompMode = MHW_GAMUT_MODE_BASIC;
+    gamutParams.ColorSpace = MHW_CSpace_BT709;
+    gamutParams.dstColorSpace = MHW_CSpace_BT601;
+    ASSERT_EQ(MOS_STATUS_SUCCESS, m_vebox.AddVeboxGamutState(nullptr, &gamutParams));
+    ASSERT_NE(0, memcmp(built.data(), iecpState, iecpSize));
+    ASSERT_EQ(MOS_STATUS_SUCCESS, m_vebox.UpdateVeboxIecpState(&iecpParams));
+    EXPECT_EQ(0, memcmp(built.data(), iecpState, iecpSize));
+
+    EXPECT_EQ(MOS_STATUS_SUCCESS, m_vebox.DestroyHeap());
+}
+
+//!
+//! \brief  Time to emit the VEBOX commands, per frame
+//!
+TEST_F(MhwVeboxCmdEmitTest, Benchmark)
+{
+    const uint32_t roundNum = 2000;
+
+    double onStack = 0, inPlace = 0;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        auto start = chrono::steady_clock::now();
+        for (uint32_t round = 0; round < roundNum; round++)
+        {
+            ResetCmdBuffer();
+            ASSERT_LT(0, EmitFrames<false>());
+        }
+        auto mid = chrono::steady_clock::now();
+        for (uint32_t round = 0; round < roundNum; round++)
+        {
+            ResetCmdBuffer();
+            ASSERT_LT(0, EmitFrames<true>());
+        }
+        auto end = chrono::steady_clock::now();
+
+        // The first pass warms up the caches
+        onStack = chrono::duration<double, nano>(mid - start).count() / (roundNum * m_frameNum);
+        inPlace = chrono::duration<double, nano>(end - mid).count() / (roundNum * m_frameNum);
+    }
+
+    cout << "VEBOX_STATE and VEB_DI_IECP (" << FrameSize() << " bytes): " << fixed << setprecision(1)
+         << onStack << " ns on the stack, " << inPlace << " ns in place per frame" << endl;
+}
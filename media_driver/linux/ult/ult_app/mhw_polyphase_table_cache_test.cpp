@@ -0,0 +1,243 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "mhw_polyphase_table_cache.h"
+#include "mhw_state_heap.h"
+#include "mhw_utilities.h"
+
+using namespace std;
+
+//!
+//! \brief  A call of Mhw_CalcPolyphaseTablesY, UV or UVOffset
+//!
+struct TableCall
+{
+    uint32_t                        coefNum;
+    function<MOS_STATUS(int32_t *)> calc;
+};
+
+//!
+//! \brief  The tables SFC and AVS set up to scale a 1080p source to each of
+//!         the heights, luma of NV12 and RGB and chroma with and without
+//!         siting offset
+//!
+static vector<TableCall> GetCalls(const vector<uint32_t> &heights)
+{
+    vector<TableCall> calls;
+    for (uint32_t height : heights)
+    {
+        float sf    = 1080.0F / height;
+        float scale = MOS_MIN(1.0F, height / 1080.0F);
+
+        calls.push_back({NUM_POLYPHASE_Y_ENTRIES * NUM_HW_POLYPHASE_TABLES, [=](int32_t *coefs) {
+            return Mhw_CalcPolyphaseTablesY(coefs, scale, MHW_Y_PLANE, Format_NV12, 0.0F, true, NUM_HW_POLYPHASE_TABLES);
+        }});
+        calls.push_back({NUM_POLYPHASE_Y_ENTRIES * MHW_NUM_HW_POLYPHASE_TABLES, [=](int32_t *coefs) {
+            return Mhw_CalcPolyphaseTablesY(coefs, scale, MHW_GENERIC_PLANE, Format_A8R8G8B8, 0.0F, false, MHW_NUM_HW_POLYPHASE_TABLES);
+        }});
+        calls.push_back({MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT, [=](int32_t *coefs) {
+            return Mhw_CalcPolyphaseTablesUV(coefs, 3.0F, sf);
+        }});
+        calls.push_back({MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT, [=](int32_t *coefs) {
+            return Mhw_CalcPolyphaseTablesUVOffset(coefs, 3.0F, sf, 2);
+        }});
+    }
+    return calls;
+}
+
+//!
+//! \brief  The tables of the renditions of a 1080p source
+//!
+static vector<TableCall> GetRenditionCalls()
+{
+    return GetCalls({ 144, 240, 360, 480, 540, 720, 900, 1080 });
+}
+
+//!
+//! \brief  Pushes every table out of the cache shared by the process
+//!
+static void EvictTables()
+{
+    int32_t coefs[MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT];
+    for (uint32_t i = 0; i < MHW_POLYPHASE_TABLE_CACHE_NUM; i++)
+    {
+        Mhw_CalcPolyphaseTablesUV(coefs, 2.0F, 100.0F + i);
+    }
+}
+
+//!
+//! \brief  Tables of the calls generated by the MHW functions, none cached
+//!
+static vector<vector<int32_t>> GenerateTables(const vector<TableCall> &calls)
+{
+    MhwPolyphaseTableCache *cache = MhwPolyphaseTableCache::GetInstance();
+
+    vector<vector<int32_t>> tables;
+    for (auto &call : calls)
+    {
+        EvictTables();
+        uint32_t hits = cache->GetHitCount();
+
+        tables.push_back(vector<int32_t>(call.coefNum));
+        EXPECT_EQ(MOS_STATUS_SUCCESS, call.calc(tables.back().data()));
+        EXPECT_EQ(hits, cache->GetHitCount());
+    }
+    return tables;
+}
+
+TEST(MhwPolyphaseTableCacheTest, SameTableAsGenerator)
+{
+    MhwPolyphaseTableCache  *cache    = MhwPolyphaseTableCache::GetInstance();
+    vector<TableCall>       calls     = GetRenditionCalls();
+    vector<vector<int32_t>> expected  = GenerateTables(calls);
+    int32_t                 coefs[MHW_POLYPHASE_TABLE_CACHE_COEF_NUM];
+
+    // First pass generates, later passes hit
+    ASSERT_LE(calls.size(), MHW_POLYPHASE_TABLE_CACHE_NUM);
+    EvictTables();
+    uint32_t hits = cache->GetHitCount();
+    for (uint32_t pass = 0; pass < 3; pass++)
+    {
+        for (uint32_t i = 0; i < calls.size(); i++)
+        {
+            memset(coefs, 0xcd, sizeof(coefs));
+            ASSERT_EQ(MOS_STATUS_SUCCESS, calls[i].calc(coefs));
+            ASSERT_EQ(0, memcmp(expected[i].data(), coefs, calls[i].coefNum * sizeof(int32_t)))
+                << "pass " << pass << " call " << i;
+        }
+    }
+    EXPECT_EQ(2 * calls.size(), cache->GetHitCount() - hits);
+
+    // A scale factor one ulp away is a table of its own
+    hits = cache->GetHitCount();
+    ASSERT_EQ(MOS_STATUS_SUCCESS, Mhw_CalcPolyphaseTablesUV(coefs, 3.0F, nextafterf(1080.0F / 144, 100.0F)));
+    EXPECT_EQ(hits, cache->GetHitCount());
+}
+
+TEST(MhwPolyphaseTableCacheTest, Replacement)
+{
+    MhwPolyphaseTableCache *cache = new MhwPolyphaseTableCache;
+    const uint32_t         coefNum = MHW_SCALER_UV_WIN_SIZE * MHW_TABLE_PHASE_COUNT;
+    int32_t                coefs[coefNum] = {};
+    float                  key;
+
+    for (uint32_t i = 0; i <= MHW_POLYPHASE_TABLE_CACHE_NUM; i++)
+    {
+        key = 1.0F + i / 16.0F;
+        cache->Put(&key, sizeof(key), coefs, coefNum);
+    }
+
+    // The oldest table is replaced, the newest is kept
+    EXPECT_TRUE(cache->Get(&key, sizeof(key), coefs, coefNum));
+    key = 1.0F;
+    EXPECT_FALSE(cache->Get(&key, sizeof(key), coefs, coefNum));
+
+    // Tables larger than an entry are not kept
+    vector<int32_t> large(MHW_POLYPHASE_TABLE_CACHE_COEF_NUM + 1, 1);
+    cache->Put(&key, sizeof(key), large.data(), (uint32_t)large.size());
+    EXPECT_FALSE(cache->Get(&key, sizeof(key), large.data(), (uint32_t)large.size()));
+
+    delete cache;
+}
+
+//!
+//! \brief  Threads asking for more tables than the cache keeps, so that
+//!         tables are generated, replaced and handed out concurrently
+//!
+TEST(MhwPolyphaseTableCacheTest, Threads)
+{
+    vector<TableCall>       calls    = GetRenditionCalls();
+    vector<vector<int32_t>> expected = GenerateTables(calls);
+    vector<thread>          threads;
+    bool                    mismatch[8] = {};
+
+    for (uint32_t t = 0; t < 8; t++)
+    {
+        threads.push_back(thread([&, t]() {
+            int32_t coefs[MHW_POLYPHASE_TABLE_CACHE_COEF_NUM];
+            for (uint32_t i = 0; i < 400; i++)
+            {
+                uint32_t call = (i * 7 + t) % calls.size();
+                if (i % 16 == 0)
+                {
+                    EvictTables();
+                }
+                mismatch[t] |= calls[call].calc(coefs) != MOS_STATUS_SUCCESS;
+                mismatch[t] |= memcmp(expected[call].data(), coefs, calls[call].coefNum * sizeof(int32_t)) != 0;
+            }
+        }));
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    for (uint32_t t = 0; t < 8; t++)
+    {
+        EXPECT_FALSE(mismatch[t]) << "thread " << t;
+    }
+}
+
+//!
+//! \brief  Time of the MHW calls when the tables are generated and when they
+//!         are handed out by the cache
+//!
+TEST(MhwPolyphaseTableCacheTest, Overhead)
+{
+    const uint32_t iterations = 20000;
+
+    MhwPolyphaseTableCache *cache = MhwPolyphaseTableCache::GetInstance();
+    int32_t                 coefs[MHW_POLYPHASE_TABLE_CACHE_COEF_NUM];
+
+    // Called in order, more tables than the cache keeps always miss
+    vector<uint32_t> heights;
+    for (uint32_t height = 100; height < 100 + MHW_POLYPHASE_TABLE_CACHE_NUM; height++)
+    {
+        heights.push_back(height);
+    }
+    vector<TableCall> calls = GetCalls(heights);
+    uint32_t          hits  = cache->GetHitCount();
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        calls[i % calls.size()].calc(coefs);
+    }
+    auto generateNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / iterations;
+    EXPECT_EQ(hits, cache->GetHitCount());
+
+    calls = GetRenditionCalls();
+    start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        calls[i % calls.size()].calc(coefs);
+    }
+    auto cacheNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / iterations;
+    EXPECT_EQ(iterations - calls.size(), cache->GetHitCount() - hits);
+
+    cout << "Polyphase table generate: " << generateNs << " ns, cache: " << cacheNs << " ns" << endl;
+}
@@ -0,0 +1,195 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "mhw_vebox_state_memo.h"
+
+using namespace std;
+
+//!
+//! \brief  Heap layout of a platform with 3 instances, and stand-in params
+//!         of a filter setting
+//!
+const uint32_t kInstanceNum = 3;
+const uint32_t kStateSize   = 1024;
+
+struct TestParams
+{
+    uint32_t threshold;
+    uint32_t strength;
+    bool     enable;
+};
+
+//!
+//! \brief  Stand-in for AddVeboxDndiState, a full block from the params
+//!
+static void BuildState(const TestParams &params, uint8_t *state)
+{
+    for (uint32_t i = 0; i < kStateSize; i++)
+    {
+        state[i] = (uint8_t)(params.threshold * 31 + params.strength * (i + 7) + (params.enable ? i : 0));
+    }
+}
+
+//!
+//! \brief  Fills the block of the instance the way UpdateVeboxDndiState does
+//!
+static void UpdateState(MhwVeboxStateMemo &memo, uint8_t *heap, uint32_t instance, const TestParams &params)
+{
+    uint8_t *state = heap + instance * kStateSize;
+    if (!memo.Restore(instance, &params, state))
+    {
+        BuildState(params, state);
+        memo.Save(instance, &params, state);
+    }
+}
+
+static TestParams MakeParams(uint32_t threshold, uint32_t strength)
+{
+    TestParams params;
+    memset(&params, 0, sizeof(params));
+    params.threshold = threshold;
+    params.strength  = strength;
+    params.enable    = (strength & 1) != 0;
+    return params;
+}
+
+TEST(MhwVeboxStateMemoTest, SameBlockAsBuild)
+{
+    MhwVeboxStateMemo memo;
+    memo.Init(kInstanceNum, sizeof(TestParams), kStateSize);
+
+    vector<uint8_t> heap(kInstanceNum * kStateSize, 0);
+    vector<uint8_t> expected(kStateSize);
+
+    // Two streams with different settings taking turns of 6 frames on the heap,
+    // one of them changing its setting every 4 turns
+    for (uint32_t frame = 0; frame < 96; frame++)
+    {
+        uint32_t   instance = frame % kInstanceNum;
+        TestParams params   = MakeParams(((frame / 6) & 1) ? 8 : 16, 1 + frame / 24);
+
+        UpdateState(memo, heap.data(), instance, params);
+
+        BuildState(params, expected.data());
+        ASSERT_EQ(0, memcmp(expected.data(), heap.data() + instance * kStateSize, kStateSize)) << "frame " << frame;
+    }
+
+    EXPECT_GT(memo.GetSkipCount(), 0u);
+    EXPECT_GT(memo.GetCopyCount(), 0u);
+}
+
+TEST(MhwVeboxStateMemoTest, SkipAndCopy)
+{
+    MhwVeboxStateMemo memo;
+    memo.Init(kInstanceNum, sizeof(TestParams), kStateSize);
+
+    vector<uint8_t> heap(kInstanceNum * kStateSize, 0);
+    TestParams      params = MakeParams(4, 2);
+
+    // First round builds once and copies into the other instances
+    for (uint32_t instance = 0; instance < kInstanceNum; instance++)
+    {
+        UpdateState(memo, heap.data(), instance, params);
+    }
+    EXPECT_EQ(0u, memo.GetSkipCount());
+    EXPECT_EQ(kInstanceNum - 1, memo.GetCopyCount());
+
+    // Later rounds find every instance holding the block
+    for (uint32_t instance = 0; instance < kInstanceNum; instance++)
+    {
+        UpdateState(memo, heap.data(), instance, params);
+    }
+    EXPECT_EQ(kInstanceNum, memo.GetSkipCount());
+    EXPECT_EQ(kInstanceNum - 1, memo.GetCopyCount());
+
+    // A block changed after build is copied again
+    memo.Forget(1);
+    heap[kStateSize] ^= 0xff;
+    UpdateState(memo, heap.data(), 1, params);
+    EXPECT_EQ(kInstanceNum, memo.GetCopyCount());
+
+    vector<uint8_t> expected(kStateSize);
+    BuildState(params, expected.data());
+    EXPECT_EQ(0, memcmp(expected.data(), heap.data() + kStateSize, kStateSize));
+
+    // Nothing is found after a clear
+    memo.Clear();
+    EXPECT_FALSE(memo.Restore(0, &params, heap.data()));
+}
+
+TEST(MhwVeboxStateMemoTest, Replacement)
+{
+    MhwVeboxStateMemo memo;
+    memo.Init(kInstanceNum, sizeof(TestParams), kStateSize);
+
+    vector<uint8_t> heap(kInstanceNum * kStateSize, 0);
+    TestParams      oldest = MakeParams(0, 3);
+
+    UpdateState(memo, heap.data(), 0, oldest);
+    for (uint32_t i = 1; i <= MHW_VEBOX_STATE_MEMO_NUM; i++)
+    {
+        UpdateState(memo, heap.data(), 1, MakeParams(i, 3));
+    }
+
+    // The oldest setting is replaced, the newer ones are still found
+    TestParams newest = MakeParams(MHW_VEBOX_STATE_MEMO_NUM, 3);
+    EXPECT_FALSE(memo.Restore(2, &oldest, heap.data() + 2 * kStateSize));
+    EXPECT_TRUE(memo.Restore(2, &newest, heap.data() + 2 * kStateSize));
+
+    // Built again, the setting gets a new id, so instance 0 still holding the
+    // first build is copied to rather than skipped
+    UpdateState(memo, heap.data(), 2, oldest);
+    EXPECT_TRUE(memo.Restore(0, &oldest, heap.data()));
+    EXPECT_EQ(0u, memo.GetSkipCount());
+}
+
+TEST(MhwVeboxStateMemoTest, Overhead)
+{
+    const uint32_t iterations = 1000000;
+
+    MhwVeboxStateMemo memo;
+    memo.Init(kInstanceNum, sizeof(TestParams), kStateSize);
+
+    vector<uint8_t> heap(kInstanceNum * kStateSize, 0);
+    TestParams      params = MakeParams(4, 2);
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        BuildState(params, heap.data() + (i % kInstanceNum) * kStateSize);
+    }
+    auto buildNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / iterations;
+
+    start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        UpdateState(memo, heap.data(), i % kInstanceNum, params);
+    }
+    auto memoNs  = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / iterations;
+
+    cout << "Block build: " << buildNs << " ns, memo: " << memoNs << " ns" << endl;
+
+    EXPECT_EQ(iterations - kInstanceNum, memo.GetSkipCount());
+}
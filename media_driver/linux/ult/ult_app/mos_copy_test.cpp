@@ -0,0 +1,259 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+#include "gtest/gtest.h"
+#include "mos_copy.h"
+
+using namespace std;
+
+const MOS_COPY_MEMORY kMemories[] = { MOS_COPY_MEMORY_CACHED, MOS_COPY_MEMORY_TO_WC, MOS_COPY_MEMORY_FROM_WC };
+const char * const    kMemoryNames[] = { "cached", "to WC", "from WC" };
+
+//!
+//! \brief  Runs the test body once for every instruction set of the CPU
+//!
+class MosCopyTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_defaultIsa = MosCopy_GetIsa();
+        for (int32_t isa = MOS_COPY_ISA_C; isa < MOS_COPY_ISA_NUM; isa++)
+        {
+            if (MosCopy_SetIsa((MOS_COPY_ISA)isa))
+            {
+                m_isas.push_back((MOS_COPY_ISA)isa);
+            }
+        }
+        MosCopy_SetIsa(m_defaultIsa);
+    }
+
+    void TearDown() override
+    {
+        MosCopy_SetIsa(m_defaultIsa);
+    }
+
+    static void FillPattern(uint8_t *data, size_t size, uint32_t seed)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            data[i] = (uint8_t)((i * 131 + seed * 7 + (i >> 8)) & 0xff);
+        }
+    }
+
+    MOS_COPY_ISA         m_defaultIsa = MOS_COPY_ISA_C;
+    vector<MOS_COPY_ISA> m_isas;
+};
+
+TEST_F(MosCopyTest, Linear)
+{
+    const size_t sizes[] = { 0, 1, 15, 16, 17, 63, 64, 65, 255, 256, 257, 1000, 4096 + 37 };
+    const size_t guard   = 64;
+
+    vector<uint8_t> src(8192 + 2 * guard), dst(8192 + 2 * guard), expected(8192 + 2 * guard);
+
+    for (auto isa : m_isas)
+    {
+        ASSERT_TRUE(MosCopy_SetIsa(isa));
+        for (uint32_t m = 0; m < 3; m++)
+        {
+            for (size_t size : sizes)
+            {
+                // Misalign both sides differently so heads and tails are both taken
+                for (size_t srcOffset = 0; srcOffset < 64; srcOffset += 13)
+                {
+                    for (size_t dstOffset = 0; dstOffset < 64; dstOffset += 7)
+                    {
+                        FillPattern(src.data(), src.size(), (uint32_t)(size + srcOffset));
+                        memset(dst.data(), 0x5a, dst.size());
+                        expected = dst;
+                        memcpy(&expected[guard + dstOffset], &src[guard + srcOffset], size);
+
+                        MosCopy_Copy(&dst[guard + dstOffset], &src[guard + srcOffset], size, kMemories[m]);
+                        ASSERT_EQ(expected, dst) << MosCopy_GetIsaName(isa) << " " << kMemoryNames[m]
+                                                 << " size " << size << " src +" << srcOffset << " dst +" << dstOffset;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(MosCopyTest, Pitched)
+{
+    const uint32_t rowBytes = 1920 + 3;
+    const uint32_t rows     = 67;
+    const uint32_t srcPitch = 2048 + 5;
+    const uint32_t dstPitch = 2048 + 64;
+
+    vector<uint8_t> src(srcPitch * rows), dst(dstPitch * rows), expected(dstPitch * rows);
+    FillPattern(src.data(), src.size(), 1);
+
+    for (auto isa : m_isas)
+    {
+        ASSERT_TRUE(MosCopy_SetIsa(isa));
+        for (uint32_t m = 0; m < 3; m++)
+        {
+            for (uint32_t threads = 1; threads <= MOS_COPY_MAX_THREADS; threads *= 2)
+            {
+                memset(dst.data(), 0, dst.size());
+                expected = dst;
+                for (uint32_t y = 0; y < rows; y++)
+                {
+                    memcpy(&expected[y * dstPitch], &src[y * srcPitch], rowBytes);
+                }
+
+                MosCopy_Copy2D(dst.data(), dstPitch, src.data(), srcPitch, rowBytes, rows, kMemories[m], threads);
+                ASSERT_EQ(expected, dst) << MosCopy_GetIsaName(isa) << " " << kMemoryNames[m] << " threads " << threads;
+            }
+        }
+    }
+}
+
+TEST_F(MosCopyTest, Parallel)
+{
+    // Above the threshold and not a multiple of the chunk alignment
+    const size_t size = MOS_COPY_PARALLEL_THRESHOLD * 3 + 4096 * 5 + 77;
+
+    vector<uint8_t> src(size + 1), dst(size + 1);
+    FillPattern(src.data(), src.size(), 2);
+
+    for (uint32_t m = 0; m < 3; m++)
+    {
+        memset(dst.data(), 0, dst.size());
+        MosCopy_CopyParallel(&dst[1], &src[1], size - 1, kMemories[m], MOS_COPY_MAX_THREADS);
+        EXPECT_EQ(0, dst[0]);
+        EXPECT_EQ(0, memcmp(&dst[1], &src[1], size - 1)) << kMemoryNames[m];
+
+        // A band per thread of a pitched copy above the threshold
+        memset(dst.data(), 0, dst.size());
+        MosCopy_Copy2D(dst.data(), 4096, src.data(), 4096, 4000, (uint32_t)(size / 4096), kMemories[m], MOS_COPY_MAX_THREADS);
+        for (size_t y = 0; y < size / 4096; y++)
+        {
+            ASSERT_EQ(0, memcmp(&dst[y * 4096], &src[y * 4096], 4000)) << kMemoryNames[m] << " row " << y;
+            ASSERT_EQ(0, dst[y * 4096 + 4000]) << kMemoryNames[m] << " row " << y;
+        }
+    }
+}
+
+TEST_F(MosCopyTest, Fill)
+{
+    const size_t sizes[] = { 0, 1, 31, 64, 100, 1000, 65536 + 3 };
+    const size_t guard   = 64;
+
+    vector<uint8_t> dst(65536 + 256), expected(65536 + 256);
+
+    for (auto isa : m_isas)
+    {
+        ASSERT_TRUE(MosCopy_SetIsa(isa));
+        for (size_t size : sizes)
+        {
+            for (size_t offset = 0; offset < 64; offset += 9)
+            {
+                for (uint32_t wc = 0; wc < 2; wc++)
+                {
+                    memset(dst.data(), 0x11, dst.size());
+                    expected = dst;
+                    memset(&expected[guard + offset], 0xa7, size);
+
+                    MosCopy_Fill(&dst[guard + offset], 0xa7, size, wc != 0);
+                    ASSERT_EQ(expected, dst) << MosCopy_GetIsaName(isa) << " size " << size << " +" << offset << " wc " << wc;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(MosCopyTest, UnsupportedIsa)
+{
+    MOS_COPY_ISA isa = MosCopy_GetIsa();
+    EXPECT_FALSE(MosCopy_SetIsa(MOS_COPY_ISA_NUM));
+    EXPECT_EQ(isa, MosCopy_GetIsa());
+    EXPECT_TRUE(MosCopy_SetIsa(MOS_COPY_ISA_C));
+    EXPECT_STREQ("C", MosCopy_GetIsaName(MOS_COPY_ISA_C));
+}
+
+//!
+//! \brief  Bandwidth of every instruction set for sizes from L1 to DRAM
+//! \details Cached buffers stand in for the WC mappings, which only exist
+//!          with a device. The numbers show the cost of the streaming
+//!          instructions on cached memory, not the gain on WC memory.
+//!
+TEST_F(MosCopyTest, Bandwidth)
+{
+    const size_t sizes[] = { 4096, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+
+    vector<uint8_t> src(sizes[3] + 64), dst(sizes[3] + 64);
+    FillPattern(src.data(), src.size(), 3);
+
+    cout << setw(8) << "ISA" << setw(10) << "memory";
+    for (size_t size : sizes)
+    {
+        cout << setw(10) << (size / 1024) << "K";
+    }
+    cout << "  (GB/s)" << endl;
+
+    for (auto isa : m_isas)
+    {
+        ASSERT_TRUE(MosCopy_SetIsa(isa));
+        for (uint32_t m = 0; m < 3; m++)
+        {
+            cout << setw(8) << MosCopy_GetIsaName(isa) << setw(10) << kMemoryNames[m];
+            for (size_t size : sizes)
+            {
+                uint32_t iterations = (uint32_t)(256 * 1024 * 1024 / size);
+                if (iterations > 20000)
+                {
+                    iterations = 20000;
+                }
+
+                auto start = chrono::steady_clock::now();
+                for (uint32_t i = 0; i < iterations; i++)
+                {
+                    MosCopy_Copy(dst.data(), src.data(), size, kMemories[m]);
+                }
+                double ns = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+                cout << setw(11) << fixed << setprecision(1) << (double)size * iterations / ns;
+            }
+            cout << endl;
+        }
+    }
+
+    // Multi-megabyte copy on one thread and on all of them
+    const size_t size = sizes[3];
+    for (uint32_t threads = 1; threads <= MOS_COPY_MAX_THREADS; threads *= 2)
+    {
+        auto start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            MosCopy_CopyParallel(dst.data(), src.data(), size, MOS_COPY_MEMORY_FROM_WC, threads);
+        }
+        double ns = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        cout << "16M from WC, " << threads << " threads: " << fixed << setprecision(1) << (double)size * 16 / ns << " GB/s" << endl;
+    }
+
+    EXPECT_EQ(0, memcmp(dst.data(), src.data(), size));
+}
@@ -0,0 +1,340 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "gtest/gtest.h"
+#include "mos_lock_profile.h"
+
+using namespace std;
+
+class MosLockProfileTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        MosLockProfile_Enable(true);
+        MosLockProfile_Reset();
+    }
+
+    void TearDown() override
+    {
+        MosLockProfile_Enable(false);
+    }
+
+    static bool FindSite(const char *name, MOS_LOCK_SITE_STATS &stat)
+    {
+        MOS_LOCK_SITE_STATS stats[MOS_LOCK_PROFILE_SITE_MAX];
+        uint32_t            statNum = MosLockProfile_GetStats(stats, MOS_LOCK_PROFILE_SITE_MAX);
+        for (uint32_t i = 0; i < statNum; i++)
+        {
+            if (strcmp(stats[i].name, name) == 0)
+            {
+                stat = stats[i];
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+TEST_F(MosLockProfileTest, Uncontended)
+{
+    pthread_mutex_t mutex[2];
+    ASSERT_EQ(0, MosLockProfile_InitMutex(&mutex[0], "TestUncontended", false));
+    ASSERT_EQ(0, MosLockProfile_InitMutex(&mutex[1], "TestUncontended", true));
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        // Released out of order
+        ASSERT_EQ(0, MosLockProfile_Lock(&mutex[0]));
+        ASSERT_EQ(0, MosLockProfile_Lock(&mutex[1]));
+        ASSERT_EQ(0, MosLockProfile_Unlock(&mutex[0]));
+        ASSERT_EQ(0, MosLockProfile_Unlock(&mutex[1]));
+    }
+
+    MOS_LOCK_SITE_STATS stat;
+    ASSERT_TRUE(FindSite("TestUncontended", stat));
+    EXPECT_EQ(200u, stat.acquisitions);
+    EXPECT_EQ(0u, stat.contended);
+    EXPECT_EQ(0u, stat.waitNs);
+    EXPECT_GE(stat.holdNs, stat.maxHoldNs);
+
+    // Unnamed mutexes, and no counting when profiling is off
+    pthread_mutex_t unnamed;
+    ASSERT_EQ(0, MosLockProfile_InitMutex(&unnamed, nullptr, false));
+    MosLockProfile_Lock(&unnamed);
+    MosLockProfile_Unlock(&unnamed);
+    MosLockProfile_Enable(false);
+    MosLockProfile_Lock(&mutex[0]);
+    MosLockProfile_Unlock(&mutex[0]);
+    MosLockProfile_Enable(true);
+
+    ASSERT_TRUE(FindSite("TestUncontended", stat));
+    EXPECT_EQ(200u, stat.acquisitions);
+    ASSERT_TRUE(FindSite("Unnamed", stat));
+    EXPECT_EQ(1u, stat.acquisitions);
+
+    // A destroyed mutex loses its name
+    MosLockProfile_DestroyMutex(&mutex[0]);
+    ASSERT_EQ(0, pthread_mutex_init(&mutex[0], nullptr));
+    MosLockProfile_Lock(&mutex[0]);
+    MosLockProfile_Unlock(&mutex[0]);
+    ASSERT_TRUE(FindSite("Unnamed", stat));
+    EXPECT_EQ(2u, stat.acquisitions);
+
+    pthread_mutex_destroy(&mutex[0]);
+    MosLockProfile_DestroyMutex(&mutex[1]);
+    MosLockProfile_DestroyMutex(&unnamed);
+}
+
+TEST_F(MosLockProfileTest, Contended)
+{
+    const uint32_t threadNum  = 8;
+    const uint32_t iterations = 2000;
+
+    pthread_mutex_t hot, cold;
+    MosLockProfile_InitMutex(&hot, "TestHot", true);
+    MosLockProfile_InitMutex(&cold, "TestCold", false);
+
+    uint64_t       counter = 0;
+    vector<thread> threads;
+    for (uint32_t t = 0; t < threadNum; t++)
+    {
+        threads.push_back(thread([&]() {
+            for (uint32_t i = 0; i < iterations; i++)
+            {
+                MosLockProfile_Lock(&hot);
+                counter++;
+                MosLockProfile_Unlock(&hot);
+            }
+        }));
+    }
+
+    // Held long enough that some thread must wait on it
+    MosLockProfile_Lock(&cold);
+    thread waiter([&]() {
+        MosLockProfile_Lock(&cold);
+        MosLockProfile_Unlock(&cold);
+    });
+    usleep(20000);
+    MosLockProfile_Unlock(&cold);
+    waiter.join();
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+    EXPECT_EQ((uint64_t)threadNum * iterations, counter);
+
+    MOS_LOCK_SITE_STATS stat;
+    ASSERT_TRUE(FindSite("TestHot", stat));
+    EXPECT_EQ((uint64_t)threadNum * iterations, stat.acquisitions);
+    EXPECT_LE(stat.contended, stat.acquisitions);
+    EXPECT_GE(stat.waitNs, stat.maxWaitNs);
+
+    ASSERT_TRUE(FindSite("TestCold", stat));
+    EXPECT_EQ(2u, stat.acquisitions);
+    EXPECT_EQ(1u, stat.contended);
+    EXPECT_GE(stat.maxWaitNs, 10000000u);
+    EXPECT_GE(stat.maxHoldNs, 10000000u);
+
+    // The most waited on site comes first
+    char   *text = nullptr;
+    size_t textSize = 0;
+    FILE   *fp = open_memstream(&text, &textSize);
+    ASSERT_NE(nullptr, fp);
+    MosLockProfile_Report(fp);
+    fclose(fp);
+
+    string report(text, textSize);
+    free(text);
+    cout << report;
+    EXPECT_LT(report.find("TestCold"), report.find("TestHot"));
+
+    MosLockProfile_DestroyMutex(&hot);
+    MosLockProfile_DestroyMutex(&cold);
+}
+
+TEST_F(MosLockProfileTest, Dump)
+{
+    pthread_mutex_t mutex;
+    MosLockProfile_InitMutex(&mutex, "TestDump", false);
+    MosLockProfile_Lock(&mutex);
+    MosLockProfile_Unlock(&mutex);
+
+    ASSERT_TRUE(MosLockProfile_Dump("/tmp/mos_lock_profile_test.%d.txt"));
+
+    string path = "/tmp/mos_lock_profile_test." + to_string(getpid()) + ".txt";
+    FILE   *fp  = fopen(path.c_str(), "r");
+    ASSERT_NE(nullptr, fp);
+    char buf[4096] = {};
+    EXPECT_GT(fread(buf, 1, sizeof(buf) - 1, fp), 0u);
+    fclose(fp);
+    unlink(path.c_str());
+
+    EXPECT_NE(nullptr, strstr(buf, "TestDump"));
+    EXPECT_FALSE(MosLockProfile_Dump(""));
+
+    MosLockProfile_DestroyMutex(&mutex);
+}
+
+//!
+//! \brief  Cost of a lock and unlock pair with profiling off and on
+//!
+TEST_F(MosLockProfileTest, Overhead)
+{
+    const uint32_t iterations = 1000000;
+
+    pthread_mutex_t mutex;
+    MosLockProfile_InitMutex(&mutex, "TestOverhead", false);
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        pthread_mutex_lock(&mutex);
+        pthread_mutex_unlock(&mutex);
+    }
+    auto pthreadNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / (double)iterations;
+
+    MosLockProfile_Enable(false);
+    start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        MosLockProfile_Lock(&mutex);
+        MosLockProfile_Unlock(&mutex);
+    }
+    auto offNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / (double)iterations;
+
+    MosLockProfile_Enable(true);
+    start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        MosLockProfile_Lock(&mutex);
+        MosLockProfile_Unlock(&mutex);
+    }
+    auto onNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / (double)iterations;
+
+    cout << "lock+unlock: pthread " << pthreadNs << " ns, profile off " << offNs << " ns, profile on " << onNs << " ns" << endl;
+
+    MOS_LOCK_SITE_STATS stat;
+    ASSERT_TRUE(FindSite("TestOverhead", stat));
+    EXPECT_EQ(iterations, stat.acquisitions);
+
+    MosLockProfile_DestroyMutex(&mutex);
+}
+
+//!
+//! \brief  Lookups stay short and the table keeps room after many named
+//!         mutexes were created and destroyed
+//!
+TEST_F(MosLockProfileTest, Churn)
+{
+    const uint32_t churnNum   = 20000;
+    const uint32_t churnAlive = 64;
+    const uint32_t liveNum    = 512;
+    const uint32_t iterations = 1000000;
+
+    pthread_mutex_t unnamed;
+    ASSERT_EQ(0, MosLockProfile_InitMutex(&unnamed, nullptr, false));
+
+    auto lockTime = [&]() {
+        auto start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            MosLockProfile_Lock(&unnamed);
+            MosLockProfile_Unlock(&unnamed);
+        }
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count() / (double)iterations;
+    };
+
+    double freshNs = lockTime();
+
+    pthread_mutex_t locker;
+    ASSERT_EQ(0, MosLockProfile_InitMutex(&locker, "TestChurnLocker", false));
+    bool     stop      = false;
+    uint64_t lockerNum = 0;
+    thread   lockerThread([&]() {
+        // Lookups that overlap a rehash still find the site
+        while (!__atomic_load_n(&stop, __ATOMIC_RELAXED))
+        {
+            MosLockProfile_Lock(&locker);
+            __atomic_store_n(&lockerNum, lockerNum + 1, __ATOMIC_RELAXED);
+            MosLockProfile_Unlock(&locker);
+        }
+    });
+    while (__atomic_load_n(&lockerNum, __ATOMIC_RELAXED) == 0)
+    {
+        this_thread::yield();
+    }
+
+    // Distinct addresses, as mutexes of contexts created and destroyed over
+    // a run, with some alive at a time so that destroyed ones leave tombstones
+    vector<pthread_mutex_t> churn(churnNum);
+    for (uint32_t i = 0; i < churnNum; i++)
+    {
+        ASSERT_EQ(0, MosLockProfile_InitMutex(&churn[i], "TestChurn", false));
+        if (i >= churnAlive)
+        {
+            ASSERT_EQ(0, MosLockProfile_DestroyMutex(&churn[i - churnAlive]));
+        }
+    }
+    for (uint32_t i = churnNum - churnAlive; i < churnNum; i++)
+    {
+        ASSERT_EQ(0, MosLockProfile_DestroyMutex(&churn[i]));
+    }
+    __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
+    lockerThread.join();
+
+    double churnedNs = lockTime();
+    cout << "unnamed lock+unlock: fresh table " << freshNs << " ns, after " << churnNum << " named mutexes " << churnedNs << " ns" << endl;
+    EXPECT_LT(churnedNs, freshNs * 4);
+
+    // Every new name still finds a slot
+    vector<pthread_mutex_t> live(liveNum);
+    for (uint32_t i = 0; i < liveNum; i++)
+    {
+        ASSERT_EQ(0, MosLockProfile_InitMutex(&live[i], "TestChurnLive", false));
+    }
+    for (uint32_t i = 0; i < liveNum; i++)
+    {
+        MosLockProfile_Lock(&live[i]);
+        MosLockProfile_Unlock(&live[i]);
+    }
+
+    MOS_LOCK_SITE_STATS stat;
+    ASSERT_TRUE(FindSite("TestChurnLive", stat));
+    EXPECT_EQ(liveNum, stat.acquisitions);
+    EXPECT_FALSE(FindSite("TestChurn", stat));
+    ASSERT_TRUE(FindSite("TestChurnLocker", stat));
+    EXPECT_EQ(lockerNum, stat.acquisitions);
+
+    for (uint32_t i = 0; i < liveNum; i++)
+    {
+        MosLockProfile_DestroyMutex(&live[i]);
+    }
+    MosLockProfile_DestroyMutex(&locker);
+    MosLockProfile_DestroyMutex(&unnamed);
+}
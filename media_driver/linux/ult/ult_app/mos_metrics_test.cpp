@@ -0,0 +1,141 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "mos_metrics.h"
+
+using namespace std;
+
+//!
+//! \brief  Instrumented points hit per frame on a busy decode + VP pipeline,
+//!         rounded up, and the driver CPU time of such a frame
+//!
+const uint32_t kEventsPerFrame = 64;
+const uint64_t kFrameCpuNs     = 2000000;
+
+TEST(MosMetricsTest, Buckets)
+{
+    EXPECT_EQ(0u, MosMetrics_GetBucket(0));
+    EXPECT_EQ(0u, MosMetrics_GetBucket(1));
+    EXPECT_EQ(1u, MosMetrics_GetBucket(2));
+    EXPECT_EQ(1u, MosMetrics_GetBucket(3));
+    EXPECT_EQ(10u, MosMetrics_GetBucket(1024));
+    EXPECT_EQ(MOS_METRICS_BUCKET_NUM - 1u, MosMetrics_GetBucket(UINT64_MAX));
+
+    uint64_t histogram[MOS_METRICS_BUCKET_NUM] = {};
+    EXPECT_EQ(0u, MosMetrics_GetPercentile(histogram, 50));
+    histogram[4]  = 90;
+    histogram[12] = 10;
+    EXPECT_EQ(31u, MosMetrics_GetPercentile(histogram, 50));
+    EXPECT_EQ(8191u, MosMetrics_GetPercentile(histogram, 99));
+}
+
+TEST(MosMetricsTest, ShardedRecord)
+{
+    const uint32_t threadNum = MOS_METRICS_SHARD_NUM + 4;
+    const uint32_t eventNum  = 20000;
+
+    MOS_METRICS_SHARD before, after;
+    MosMetrics_Merge(MosMetrics_GetSegment(), &before);
+
+    vector<thread> threads;
+    for (uint32_t t = 0; t < threadNum; t++)
+    {
+        threads.push_back(thread([=]() {
+            for (uint32_t i = 0; i < eventNum; i++)
+            {
+                MosMetrics_Record(MOS_METRIC_HEAP_WAIT, 100);
+                MosMetrics_Count(MOS_METRIC_RESOURCE_FREE);
+            }
+        }));
+    }
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    MosMetrics_Merge(MosMetrics_GetSegment(), &after);
+
+    const uint64_t events = (uint64_t)threadNum * eventNum;
+    EXPECT_EQ(events, after.count[MOS_METRIC_HEAP_WAIT] - before.count[MOS_METRIC_HEAP_WAIT]);
+    EXPECT_EQ(events * 100, after.totalNs[MOS_METRIC_HEAP_WAIT] - before.totalNs[MOS_METRIC_HEAP_WAIT]);
+    EXPECT_EQ(events, after.histogram[MOS_METRIC_HEAP_WAIT][6] - before.histogram[MOS_METRIC_HEAP_WAIT][6]);
+    EXPECT_EQ(events, after.count[MOS_METRIC_RESOURCE_FREE] - before.count[MOS_METRIC_RESOURCE_FREE]);
+    EXPECT_EQ(before.totalNs[MOS_METRIC_RESOURCE_FREE], after.totalNs[MOS_METRIC_RESOURCE_FREE]);
+}
+
+TEST(MosMetricsTest, SharedMemoryExport)
+{
+    MosMetrics_Record(MOS_METRIC_SUBMIT_CMD_BUFFER, 1000);
+    ASSERT_TRUE(MosMetrics_Export());
+
+    char name[64];
+    snprintf(name, sizeof(name), MOS_METRICS_SHM_PREFIX "%d", (int32_t)getpid());
+
+    int32_t fd = shm_open(name, O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    const MOS_METRICS_SEGMENT *segment = (const MOS_METRICS_SEGMENT *)mmap(
+        nullptr, sizeof(MOS_METRICS_SEGMENT), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(MAP_FAILED, (void *)segment);
+
+    EXPECT_EQ((uint32_t)MOS_METRICS_MAGIC, segment->magic);
+    EXPECT_EQ((uint32_t)MOS_METRIC_NUM, segment->metricNum);
+    EXPECT_EQ((uint32_t)getpid(), segment->pid);
+
+    // Counts from before the export are carried over and new ones are visible to the reader
+    MOS_METRICS_SHARD total;
+    MosMetrics_Merge(segment, &total);
+    uint64_t submits = total.count[MOS_METRIC_SUBMIT_CMD_BUFFER];
+    EXPECT_GE(submits, 1u);
+
+    MosMetrics_Record(MOS_METRIC_SUBMIT_CMD_BUFFER, 1000);
+    MosMetrics_Merge(segment, &total);
+    EXPECT_EQ(submits + 1, total.count[MOS_METRIC_SUBMIT_CMD_BUFFER]);
+
+    munmap((void *)segment, sizeof(MOS_METRICS_SEGMENT));
+
+    MosMetrics_Unexport();
+    EXPECT_LT(shm_open(name, O_RDONLY, 0), 0);
+}
+
+TEST(MosMetricsTest, Overhead)
+{
+    const uint32_t iterations = 1000000;
+
+    uint64_t start = MosMetrics_GetTimeNs();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        MOS_METRICS_SCOPE(MOS_METRIC_GET_CMD_BUFFER);
+    }
+    uint64_t scopeNs = (MosMetrics_GetTimeNs() - start) / iterations;
+
+    double frameOverhead = 100.0 * scopeNs * kEventsPerFrame / kFrameCpuNs;
+    cout << "Metrics scope: " << scopeNs << " ns, " << frameOverhead << "% of frame CPU" << endl;
+
+    EXPECT_LT(frameOverhead, 1.0);
+}
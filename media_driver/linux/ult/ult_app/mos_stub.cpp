@@ -19,10 +19,25 @@
 * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 * OTHER DEALINGS IN THE SOFTWARE.
 */
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include "mos_utilities.h"
+#include "mos_os.h"
 
 using namespace std;
 
+// The allocation counter of mos_utilities.c that MOS_New and MOS_NewArray count with
+int32_t MosMemAllocCounter = 0;
+
+#if MOS_MESSAGES_ENABLED
+// Time stamp of the allocation messages
+double MOS_GetTime()
+{
+    return 0;
+}
+#endif
+
 #ifdef __cplusplus
     extern "C" {
 #endif
@@ -35,6 +50,140 @@ void MOS_ZeroMemory(void *pDestination, size_t stLength)
     }
 }
 
+void MOS_FillMemory(void *pDestination, size_t stLength, uint8_t bFill)
+{
+    if(pDestination != nullptr)
+    {
+        memset(pDestination, bFill, stLength);
+    }
+}
+
+// With messages enabled the header turns the names into macros of the Utils versions
+#if MOS_MESSAGES_ENABLED
+void *MOS_AllocAndZeroMemoryUtils(size_t size, const char *functionName, const char *filename, int32_t line)
+{
+    return calloc(1, size);
+}
+
+void MOS_FreeMemoryUtils(void *ptr, const char *functionName, const char *filename, int32_t line)
+{
+    free(ptr);
+}
+
+void MOS_Message(
+    MOS_MESSAGE_LEVEL level,
+    const PCCHAR      logtag,
+    MOS_COMPONENT_ID  compID,
+    uint8_t           subCompID,
+    const PCCHAR      functionName,
+    int32_t           lineNum,
+    const PCCHAR      message,
+                      ...)
+{
+}
+#else
+void *MOS_AllocAndZeroMemory(size_t size)
+{
+    return calloc(1, size);
+}
+
+void MOS_FreeMemory(void *ptr)
+{
+    free(ptr);
+}
+#endif
+
+#if MOS_ASSERT_ENABLED
+void _MOS_Assert(MOS_COMPONENT_ID compID, uint8_t subCompID)
+{
+}
+#endif
+
+#if (_DEBUG || _RELEASE_INTERNAL)
+// Debug only reads of MHW, such as the media reset threshold, see no keys and keep their defaults
+MOS_STATUS MOS_UserFeature_ReadValue_ID(
+    PMOS_USER_FEATURE_INTERFACE  pOsUserFeatureInterface,
+    uint32_t                     ValueID,
+    PMOS_USER_FEATURE_VALUE_DATA pValueData)
+{
+    return MOS_STATUS_USER_FEATURE_KEY_OPEN_FAILED;
+}
+#endif
+
+MOS_STATUS MOS_SecureMemcpy(void *pDestination, size_t dstLength, const void *pSource, size_t srcLength)
+{
+    if(pDestination == nullptr || pSource == nullptr)
+    {
+        return MOS_STATUS_NULL_POINTER;
+    }
+    if(dstLength < srcLength)
+    {
+        return MOS_STATUS_INVALID_PARAMETER;
+    }
+    memcpy(pDestination, pSource, srcLength);
+    return MOS_STATUS_SUCCESS;
+}
+
+// The math of mos_utilities.c that the polyphase tables of mhw_utilities.c use
+
+float MOS_Sinc(float x)
+{
+    return (MOS_ABS(x) < 1e-9f) ? 1.0F : (float)(sin(x) / x);
+}
+
+float MOS_Lanczos(float x, uint32_t dwNumEntries, float fLanczosT)
+{
+    uint32_t dwNumHalfEntries = dwNumEntries >> 1;
+    if (fLanczosT < dwNumHalfEntries)
+    {
+        fLanczosT = (float)dwNumHalfEntries;
+    }
+    if (MOS_ABS(x) >= dwNumHalfEntries)
+    {
+        return 0.0;
+    }
+    x *= MOS_PI;
+    return MOS_Sinc(x) * MOS_Sinc(x / fLanczosT);
+}
+
+float MOS_Lanczos_g(float x, uint32_t dwNumEntries, float fLanczosT)
+{
+    uint32_t dwNumHalfEntries = (dwNumEntries >> 1) + (dwNumEntries & 1);
+    if (fLanczosT < dwNumHalfEntries)
+    {
+        fLanczosT = (float)dwNumHalfEntries;
+    }
+    if (x > (dwNumEntries >> 1) || (- x) >= dwNumHalfEntries)
+    {
+        return 0.0;
+    }
+    x *= MOS_PI;
+    return MOS_Sinc(x) * MOS_Sinc(x / fLanczosT);
+}
+
+// The command buffer and resource helpers of mos_os.c and mos_os_specific.c that the VEBOX commands use
+
+MOS_STATUS Mos_AddCommand(PMOS_COMMAND_BUFFER pCmdBuffer, const void *pCmd, uint32_t dwCmdSize)
+{
+    uint32_t dwCmdSizeDwAligned = MOS_ALIGN_CEIL(dwCmdSize, sizeof(uint32_t));
+
+    pCmdBuffer->iOffset    += dwCmdSizeDwAligned;
+    pCmdBuffer->iRemaining -= dwCmdSizeDwAligned;
+    if (pCmdBuffer->iRemaining < 0)
+    {
+        return MOS_STATUS_UNKNOWN;
+    }
+
+    MOS_SecureMemcpy(pCmdBuffer->pCmdPtr, dwCmdSize, pCmd, dwCmdSize);
+    pCmdBuffer->pCmdPtr += (dwCmdSizeDwAligned / sizeof(uint32_t));
+    return MOS_STATUS_SUCCESS;
+}
+
+int32_t Mos_ResourceIsNull(PMOS_RESOURCE pOsResource)
+{
+    return pOsResource == nullptr || pOsResource->bo == nullptr;
+}
+
 #ifdef __cplusplus
     } // extern "C" 
 #endif
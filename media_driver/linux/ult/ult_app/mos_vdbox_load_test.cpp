@@ -0,0 +1,174 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "mos_vdbox_load.h"
+
+using namespace std;
+
+//!
+//! \brief  Synthetic codec session, one per simulated process
+//!
+struct VdboxSimSession
+{
+    uint32_t startMs;
+    uint32_t endMs;
+    uint32_t frameMbs;  // macroblocks per frame
+    uint32_t fps;
+};
+
+//!
+//! \brief  Replays a session mix against both balancing policies
+//! \details Sessions are associated with a node when they start and then submit
+//!          one frame per frame interval until they end. The imbalance is the
+//!          difference of the macroblocks sent to each node over their sum.
+//!
+class VdboxLoadSimulator
+{
+public:
+    double Run(const vector<VdboxSimSession> &sessions, bool loadAware)
+    {
+        VDBOX_LOAD       load;
+        uint32_t         sessionCount[MOS_VDBOX_LOAD_NODE_NUM] = {};
+        uint32_t         ringIndex = 0;
+        uint64_t         totalMbs[MOS_VDBOX_LOAD_NODE_NUM] = {};
+        vector<uint32_t> node(sessions.size(), 0);
+        uint32_t         endMs = 0;
+
+        memset(&load, 0, sizeof(load));
+        for (auto &session : sessions)
+        {
+            endMs = (session.endMs > endMs) ? session.endMs : endMs;
+        }
+
+        // Start away from zero like a real monotonic clock
+        const uint64_t base = 1000000;
+
+        for (uint32_t t = 0; t < endMs; t++)
+        {
+            for (uint32_t i = 0; i < sessions.size(); i++)
+            {
+                const VdboxSimSession &session = sessions[i];
+
+                if (t == session.startMs)
+                {
+                    if (loadAware)
+                    {
+                        node[i] = MosVdboxLoad_SelectNode(&load, sessionCount, ringIndex, base + t);
+                        ringIndex = !node[i];
+                        MosVdboxLoad_Charge(&load, node[i], session.frameMbs, base + t);
+                    }
+                    else if (sessionCount[0] != sessionCount[1])
+                    {
+                        node[i] = (sessionCount[0] < sessionCount[1]) ? 0 : 1;
+                    }
+                    else
+                    {
+                        node[i]   = ringIndex;
+                        ringIndex = !ringIndex;
+                    }
+                    sessionCount[node[i]]++;
+                }
+
+                if (t >= session.startMs && t < session.endMs &&
+                    (t - session.startMs) % (1000 / session.fps) == 0)
+                {
+                    MosVdboxLoad_Charge(&load, node[i], session.frameMbs, base + t);
+                    totalMbs[node[i]] += session.frameMbs;
+                }
+
+                if (t + 1 == session.endMs)
+                {
+                    sessionCount[node[i]]--;
+                }
+            }
+        }
+
+        uint64_t sum  = totalMbs[0] + totalMbs[1];
+        uint64_t diff = (totalMbs[0] > totalMbs[1]) ? totalMbs[0] - totalMbs[1] : totalMbs[1] - totalMbs[0];
+        return sum ? (double)diff / sum : 0.0;
+    }
+};
+
+TEST(MosVdboxLoadTest, ChargeAndDecay)
+{
+    VDBOX_LOAD load;
+    memset(&load, 0, sizeof(load));
+
+    const uint64_t now    = 1000000;
+    const uint64_t bucket = 1 << MOS_VDBOX_LOAD_BUCKET_SHIFT;
+
+    MosVdboxLoad_Charge(&load, 0, 100, now);
+    MosVdboxLoad_Charge(&load, 0, 100, now);
+    EXPECT_EQ(200u * MOS_VDBOX_LOAD_BUCKET_NUM, MosVdboxLoad_Get(&load, 0, now));
+    EXPECT_EQ(0u, MosVdboxLoad_Get(&load, 1, now));
+
+    // Older work weighs less and drops out after the window
+    EXPECT_EQ(200u * (MOS_VDBOX_LOAD_BUCKET_NUM - 1), MosVdboxLoad_Get(&load, 0, now + bucket));
+    EXPECT_EQ(0u, MosVdboxLoad_Get(&load, 0, now + bucket * MOS_VDBOX_LOAD_BUCKET_NUM));
+
+    // A bucket reused on the next lap of the ring starts from zero
+    MosVdboxLoad_Charge(&load, 0, 10, now + bucket * MOS_VDBOX_LOAD_BUCKET_NUM);
+    EXPECT_EQ(10u * MOS_VDBOX_LOAD_BUCKET_NUM, MosVdboxLoad_Get(&load, 0, now + bucket * MOS_VDBOX_LOAD_BUCKET_NUM));
+
+    EXPECT_EQ(1u, MosVdboxLoad_SelectNode(&load, nullptr, 0, now + bucket * MOS_VDBOX_LOAD_BUCKET_NUM));
+}
+
+TEST(MosVdboxLoadTest, SessionMixImbalance)
+{
+    const uint32_t mbs4k   = 240 * 135;
+    const uint32_t mbs1080 = 120 * 68;
+    const uint32_t mbs240  = 20 * 15;
+
+    vector<vector<VdboxSimSession>> mixes =
+    {
+        // 4K60 encodes interleaved with small decodes
+        {
+            {   0, 10000, mbs4k,  60}, { 500, 10000, mbs240, 30},
+            {1000, 10000, mbs240, 30}, {1500, 10000, mbs4k,  60},
+            {2000, 10000, mbs4k,  60}, {2500, 10000, mbs240, 30},
+            {3000, 10000, mbs240, 30}, {3500, 10000, mbs4k,  60},
+        },
+        // 1080p transcodes coming and going next to long small streams
+        {
+            {   0, 10000, mbs240,  30}, { 200, 10000, mbs240,  30},
+            { 400,  4000, mbs1080, 60}, { 600,  4000, mbs1080, 60},
+            {4500, 10000, mbs1080, 60}, {5000, 10000, mbs240,  30},
+            {5500, 10000, mbs1080, 30}, {6000, 10000, mbs4k,   30},
+        },
+    };
+
+    VdboxLoadSimulator simulator;
+
+    for (uint32_t i = 0; i < mixes.size(); i++)
+    {
+        double countImbalance = simulator.Run(mixes[i], false);
+        double loadImbalance  = simulator.Run(mixes[i], true);
+
+        cout << "Session mix " << i << ": imbalance by session count " << countImbalance
+             << ", by load " << loadImbalance << endl;
+
+        EXPECT_LE(loadImbalance, countImbalance) << "Session mix " << i;
+        EXPECT_LT(loadImbalance, 0.25) << "Session mix " << i;
+    }
+}
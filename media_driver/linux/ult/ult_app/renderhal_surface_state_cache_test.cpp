@@ -0,0 +1,446 @@
+/*
+* Copyright (c) 2018, Intel Corporation
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+* OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+* ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+* OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+#include "renderhal_surface_state_cache.h"
+#include "mhw_state_heap_hwcmd_g9_X.h"
+
+using namespace std;
+
+#define SURFACE_STATE_NUM   64
+
+//!
+//! \brief  RenderHal_AssignSurfaceState on the test SSH
+//!
+static MOS_STATUS AssignSurfaceState(
+    PRENDERHAL_INTERFACE            pRenderHal,
+    RENDERHAL_SURFACE_STATE_TYPE    Type,
+    PRENDERHAL_SURFACE_STATE_ENTRY  *ppSurfaceEntry)
+{
+    PRENDERHAL_STATE_HEAP stateHeap = pRenderHal->pStateHeap;
+    if (stateHeap->iCurrentSurfaceState >= SURFACE_STATE_NUM)
+    {
+        return MOS_STATUS_NO_SPACE;
+    }
+
+    int32_t                        id    = stateHeap->iCurrentSurfaceState++;
+    PRENDERHAL_SURFACE_STATE_ENTRY entry = &stateHeap->pSurfaceEntry[id];
+    MOS_ZeroMemory(entry, sizeof(*entry));
+    entry->iSurfStateID      = id;
+    entry->Type              = Type;
+    entry->dwSurfStateOffset = (uint32_t)-1;
+    entry->pSurfaceState     = stateHeap->pSshBuffer + stateHeap->iSurfaceStateOffset +
+                               id * pRenderHal->pHwSizes->dwSizeSurfaceState;
+    *ppSurfaceEntry = entry;
+    return MOS_STATUS_SUCCESS;
+}
+
+//!
+//! \brief  RenderHal_SetupSurfaceStateOs, the token takes the allocation index
+//!         and offset of the resource as they are when the frame is built
+//!
+static MOS_STATUS SetupSurfaceStateOs(
+    PRENDERHAL_INTERFACE            pRenderHal,
+    PRENDERHAL_SURFACE              pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS pParams,
+    PRENDERHAL_SURFACE_STATE_ENTRY  pSurfaceEntry)
+{
+    PMOS_SURFACE surface = &pRenderHalSurface->OsSurface;
+
+    MOS_ZeroMemory(&pSurfaceEntry->SurfaceToken, sizeof(pSurfaceEntry->SurfaceToken));
+    pSurfaceEntry->SurfaceToken.DW1.SurfaceAllocationIndex = surface->OsResource.iAllocationIndex[0];
+    pSurfaceEntry->SurfaceToken.DW1.SurfaceStateHeapOffset = pSurfaceEntry->dwSurfStateOffset;
+    pSurfaceEntry->SurfaceToken.DW2.SurfaceOffset          = (pSurfaceEntry->YUVPlane == MHW_U_PLANE) ?
+                                                             surface->UPlaneOffset.iSurfaceOffset : surface->dwOffset;
+    pSurfaceEntry->SurfaceToken.DW3.RenderTargetEnable     = pParams->bRenderTarget;
+    pSurfaceEntry->SurfaceToken.DW3.YUVPlane               = pSurfaceEntry->YUVPlane;
+    pSurfaceEntry->SurfaceToken.DW3.SurfaceStateType       = pSurfaceEntry->bAVS;
+    return MOS_STATUS_SUCCESS;
+}
+
+//!
+//! \brief  XRenderHal_Interface_g9::SetupSurfaceState and the Gen9
+//!         SetSurfaceStateEntry, for NV12 and ARGB surfaces. The platform
+//!         interface and state heap of the driver cannot be linked in the ULT,
+//!         so this encodes the Gen9 surface states the same way for the
+//!         surfaces the tests use.
+//!
+static MOS_STATUS SetupSurfaceStateG9(
+    PRENDERHAL_INTERFACE             pRenderHal,
+    PRENDERHAL_SURFACE               pRenderHalSurface,
+    PRENDERHAL_SURFACE_STATE_PARAMS  pParams,
+    int32_t                          *piNumEntries,
+    PRENDERHAL_SURFACE_STATE_ENTRY   *ppSurfaceEntries)
+{
+    static const uint32_t rotationMode[8] = { 0, 1, 2, 3, 0, 0, 0, 0 };
+
+    PMOS_SURFACE surface = &pRenderHalSurface->OsSurface;
+    bool         nv12    = (surface->Format == Format_NV12);
+    int32_t      planes  = (nv12 && !pParams->bAVS) ? 2 : 1;
+    uint32_t     tileMode = (surface->TileType == MOS_TILE_LINEAR) ? 0 : (surface->TileType == MOS_TILE_X) ? 2 : 3;
+
+    pRenderHal->bIsAVS = pParams->bAVS;
+
+    for (int32_t i = 0; i < planes; i++)
+    {
+        PRENDERHAL_SURFACE_STATE_ENTRY entry;
+        MOS_STATUS status = pRenderHal->pfnAssignSurfaceState(pRenderHal, pParams->Type, &entry);
+        if (status != MOS_STATUS_SUCCESS)
+        {
+            return status;
+        }
+
+        entry->pSurface          = surface;
+        entry->YUVPlane          = i ? MHW_U_PLANE : MHW_Y_PLANE;
+        entry->bAVS              = pParams->bAVS;
+        entry->bRenderTarget     = pParams->bRenderTarget;
+        entry->dwWidth           = i ? surface->dwWidth / 2 : surface->dwWidth;
+        entry->dwHeight          = i ? surface->dwHeight / 2 : surface->dwHeight;
+        entry->dwPitch           = surface->dwPitch;
+        entry->bTiledSurface     = (surface->TileType != MOS_TILE_LINEAR);
+        entry->bTileWalk         = (surface->TileType == MOS_TILE_Y);
+        entry->bInterleaveChroma = pParams->bAVS && nv12;
+        entry->dwFormat          = pParams->bAVS ? MHW_MEDIASTATE_SURFACEFORMAT_PLANAR_420_8 :
+                                   !nv12        ? MHW_GFX3DSTATE_SURFACEFORMAT_B8G8R8A8_UNORM :
+                                   i            ? MHW_GFX3DSTATE_SURFACEFORMAT_R8G8_UNORM :
+                                                  MHW_GFX3DSTATE_SURFACEFORMAT_R8_UNORM;
+        entry->dwSurfStateOffset = pRenderHal->pStateHeap->iSurfaceStateOffset +
+                                   entry->iSurfStateID * pRenderHal->pHwSizes->dwSizeSurfaceState;
+
+        if (entry->bAVS)
+        {
+            auto cmd = (mhw_state_heap_g9_X::MEDIA_SURFACE_STATE_CMD *)entry->pSurfaceState;
+            *cmd = mhw_state_heap_g9_X::MEDIA_SURFACE_STATE_CMD();
+            cmd->DW0.Rotation                        = rotationMode[pRenderHalSurface->Rotation];
+            cmd->DW1.Width                           = entry->dwWidth - 1;
+            cmd->DW1.Height                          = entry->dwHeight - 1;
+            cmd->DW2.SurfaceFormat                   = entry->dwFormat;
+            cmd->DW2.InterleaveChroma                = entry->bInterleaveChroma;
+            cmd->DW2.SurfacePitch                    = entry->dwPitch - 1;
+            cmd->DW2.TileMode                        = tileMode;
+            cmd->DW2.MemoryCompressionEnable         = surface->bIsCompressed;
+            cmd->DW3.XOffsetForUCb                   = (uint32_t)surface->UPlaneOffset.iLockSurfaceOffset % surface->dwPitch;
+            cmd->DW3.YOffsetForUCb                   = (uint32_t)surface->UPlaneOffset.iLockSurfaceOffset / surface->dwPitch;
+            cmd->DW5.SurfaceMemoryObjectControlState = pParams->MemObjCtl;
+        }
+        else
+        {
+            auto cmd = (mhw_state_heap_g9_X::RENDER_SURFACE_STATE_CMD *)entry->pSurfaceState;
+            *cmd = mhw_state_heap_g9_X::RENDER_SURFACE_STATE_CMD();
+            cmd->DW0.SurfaceType                        = GFX3DSTATE_SURFACETYPE_2D;
+            cmd->DW0.SurfaceFormat                      = entry->dwFormat;
+            cmd->DW0.TileMode                           = tileMode;
+            cmd->DW0.SurfaceHorizontalAlignment         = 1;
+            cmd->DW0.SurfaceVerticalAlignment           = 1;
+            cmd->DW1.MemoryObjectControlState           = pParams->MemObjCtl;
+            cmd->DW2.Width                              = entry->dwWidth - 1;
+            cmd->DW2.Height                             = entry->dwHeight - 1;
+            cmd->DW3.SurfacePitch                       = entry->dwPitch - 1;
+            cmd->DW4.RenderTargetAndSampleUnormRotation = rotationMode[pRenderHalSurface->Rotation];
+            cmd->DW7.MemoryCompressionEnable            = surface->bIsCompressed;
+            cmd->DW7.ShaderChannelSelectAlpha           = cmd->SHADER_CHANNEL_SELECT_ALPHA_ALPHA;
+            cmd->DW7.ShaderChannelSelectBlue            = cmd->SHADER_CHANNEL_SELECT_BLUE_BLUE;
+            cmd->DW7.ShaderChannelSelectGreen           = cmd->SHADER_CHANNEL_SELECT_GREEN_GREEN;
+            cmd->DW7.ShaderChannelSelectRed             = cmd->SHADER_CHANNEL_SELECT_RED_RED;
+        }
+
+        status = pRenderHal->pfnSetupSurfaceStateOs(pRenderHal, pRenderHalSurface, pParams, entry);
+        if (status != MOS_STATUS_SUCCESS)
+        {
+            return status;
+        }
+        ppSurfaceEntries[i] = entry;
+    }
+
+    *piNumEntries = planes;
+    return MOS_STATUS_SUCCESS;
+}
+
+class RenderHalSurfaceStateCacheTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        MOS_ZeroMemory(&m_renderHal, sizeof(m_renderHal));
+        MOS_ZeroMemory(&m_stateHeap, sizeof(m_stateHeap));
+        MOS_ZeroMemory(&m_hwSizes, sizeof(m_hwSizes));
+
+        m_hwSizes.dwSizeSurfaceState       = mhw_state_heap_g9_X::RENDER_SURFACE_STATE_CMD::byteSize;
+        m_stateHeap.pSshBuffer             = m_ssh;
+        m_stateHeap.iSurfaceStateOffset    = 0;
+        m_stateHeap.pSurfaceEntry          = m_surfaceEntries;
+        m_renderHal.pStateHeap             = &m_stateHeap;
+        m_renderHal.pHwSizes               = &m_hwSizes;
+        m_renderHal.pfnAssignSurfaceState  = AssignSurfaceState;
+        m_renderHal.pfnSetupSurfaceStateOs = SetupSurfaceStateOs;
+        m_renderHal.pSurfaceStateCache     = (PRENDERHAL_SURFACE_STATE_CACHE)MOS_AllocAndZeroMemory(
+            sizeof(RENDERHAL_SURFACE_STATE_CACHE));
+        ASSERT_NE(nullptr, m_renderHal.pSurfaceStateCache);
+    }
+
+    void TearDown() override
+    {
+        MOS_FreeMemory(m_renderHal.pSurfaceStateCache);
+    }
+
+    //!
+    //! \brief  Start a frame, the SSH is filled with garbage as a recycled one would be
+    //!
+    void NewFrame()
+    {
+        m_stateHeap.iCurrentSurfaceState = 0;
+        memset(m_ssh, 0xcd, sizeof(m_ssh));
+        memset(m_surfaceEntries, 0xcd, sizeof(m_surfaceEntries));
+    }
+
+    //!
+    //! \brief  RenderHal_SetupSurfaceState with the cache enabled
+    //!
+    MOS_STATUS SetupCached(
+        PRENDERHAL_SURFACE              surface,
+        PRENDERHAL_SURFACE_STATE_PARAMS params,
+        int32_t                         *numEntries,
+        PRENDERHAL_SURFACE_STATE_ENTRY  *entries,
+        bool                            *hit)
+    {
+        RENDERHAL_SURFACE_STATE_CACHE_KEY key;
+        RenderHal_GetSurfaceStateCacheKey(surface, params, &key);
+
+        PRENDERHAL_SURFACE_STATE_CACHE_ENTRY cacheEntry =
+            RenderHal_FindSurfaceStateCacheEntry(m_renderHal.pSurfaceStateCache, &key);
+        *hit = (cacheEntry != nullptr);
+        if (cacheEntry)
+        {
+            return RenderHal_CopySurfaceStateCacheEntry(&m_renderHal, cacheEntry, surface, params, numEntries, entries);
+        }
+
+        MOS_STATUS status = SetupSurfaceStateG9(&m_renderHal, surface, params, numEntries, entries);
+        if (status == MOS_STATUS_SUCCESS)
+        {
+            RenderHal_AddSurfaceStateCacheEntry(&m_renderHal, &key, surface, params, *numEntries, entries);
+        }
+        return status;
+    }
+
+    //!
+    //! \brief  Set up the surfaces in a new frame, cached or from scratch
+    //! \return The SSH and the surface state entries the frame used
+    //!
+    vector<uint8_t> SetupFrame(vector<RENDERHAL_SURFACE> &surfaces, vector<RENDERHAL_SURFACE_STATE_PARAMS> &params, bool cached, uint32_t *hits)
+    {
+        NewFrame();
+        *hits = 0;
+        for (size_t i = 0; i < surfaces.size(); i++)
+        {
+            PRENDERHAL_SURFACE_STATE_ENTRY entries[MHW_MAX_SURFACE_PLANES];
+            int32_t                        numEntries = 0;
+            bool                           hit        = false;
+            MOS_STATUS status = cached ?
+                SetupCached(&surfaces[i], &params[i], &numEntries, entries, &hit) :
+                SetupSurfaceStateG9(&m_renderHal, &surfaces[i], &params[i], &numEntries, entries);
+            EXPECT_EQ(MOS_STATUS_SUCCESS, status);
+            *hits += hit;
+        }
+
+        vector<uint8_t> used(m_ssh, m_ssh + m_stateHeap.iCurrentSurfaceState * m_hwSizes.dwSizeSurfaceState);
+        const uint8_t *entryBytes = (const uint8_t *)m_surfaceEntries;
+        used.insert(used.end(), entryBytes, entryBytes + m_stateHeap.iCurrentSurfaceState * sizeof(m_surfaceEntries[0]));
+        return used;
+    }
+
+    RENDERHAL_INTERFACE             m_renderHal;
+    RENDERHAL_STATE_HEAP            m_stateHeap;
+    MHW_RENDER_STATE_SIZES          m_hwSizes;
+    uint8_t                         m_ssh[SURFACE_STATE_NUM * mhw_state_heap_g9_X::RENDER_SURFACE_STATE_CMD::byteSize];
+    RENDERHAL_SURFACE_STATE_ENTRY   m_surfaceEntries[SURFACE_STATE_NUM];
+};
+
+//!
+//! \brief  A 1080p NV12 surface standing for the resource of the index
+//!
+static RENDERHAL_SURFACE GetNv12Surface(uint32_t index)
+{
+    RENDERHAL_SURFACE surface;
+    MOS_ZeroMemory(&surface, sizeof(surface));
+    surface.OsSurface.Format                          = Format_NV12;
+    surface.OsSurface.TileType                        = MOS_TILE_Y;
+    surface.OsSurface.dwWidth                         = 1920;
+    surface.OsSurface.dwHeight                        = 1080;
+    surface.OsSurface.dwPitch                         = 2048;
+    surface.OsSurface.UPlaneOffset.iSurfaceOffset     = 2048 * 1088;
+    surface.OsSurface.UPlaneOffset.iLockSurfaceOffset = 2048 * 1088;
+    surface.OsSurface.OsResource.pGmmResInfo          = (GMM_RESOURCE_INFO *)(uintptr_t)(0x10000 + index * 0x240);
+    surface.OsSurface.OsResource.iAllocationIndex[0]  = index;
+    surface.Rotation                                  = MHW_ROTATION_IDENTITY;
+    return surface;
+}
+
+//!
+//! \brief  The surfaces of a composite of the layers: the sampler (Y and UV)
+//!         and AVS states of each NV12 layer and an ARGB render target
+//!
+static void GetCompositeSurfaces(
+    uint32_t                                layers,
+    vector<RENDERHAL_SURFACE>               &surfaces,
+    vector<RENDERHAL_SURFACE_STATE_PARAMS>  &params)
+{
+    RENDERHAL_SURFACE_STATE_PARAMS param;
+
+    for (uint32_t i = 0; i < layers; i++)
+    {
+        MOS_ZeroMemory(&param, sizeof(param));
+        param.Type      = RENDERHAL_SURFACE_TYPE_G9;
+        param.MemObjCtl = 0x2;
+        surfaces.push_back(GetNv12Surface(i));
+        params.push_back(param);
+
+        param.Type = RENDERHAL_SURFACE_TYPE_ADV_G9;
+        param.bAVS = true;
+        surfaces.push_back(GetNv12Surface(i));
+        params.push_back(param);
+    }
+
+    RENDERHAL_SURFACE target = GetNv12Surface(layers);
+    target.OsSurface.Format   = Format_A8R8G8B8;
+    target.OsSurface.dwPitch  = 1920 * 4;
+    target.Rotation           = MHW_ROTATION_90;
+    MOS_ZeroMemory(&param, sizeof(param));
+    param.Type          = RENDERHAL_SURFACE_TYPE_G9;
+    param.bRenderTarget = true;
+    param.MemObjCtl     = 0x4;
+    surfaces.push_back(target);
+    params.push_back(param);
+}
+
+TEST_F(RenderHalSurfaceStateCacheTest, HitMatchesFreshSetup)
+{
+    vector<RENDERHAL_SURFACE>              surfaces;
+    vector<RENDERHAL_SURFACE_STATE_PARAMS> params;
+    GetCompositeSurfaces(4, surfaces, params);
+
+    uint32_t        hits   = 0;
+    vector<uint8_t> filled = SetupFrame(surfaces, params, true, &hits);
+    EXPECT_EQ(0u, hits);
+
+    // The next frame uses new allocation indexes, only the token may follow them
+    for (size_t i = 0; i < surfaces.size(); i++)
+    {
+        surfaces[i].OsSurface.OsResource.iAllocationIndex[0] += 100;
+    }
+
+    vector<uint8_t> copied = SetupFrame(surfaces, params, true, &hits);
+    EXPECT_EQ(surfaces.size(), hits);
+    vector<uint8_t> fresh  = SetupFrame(surfaces, params, false, &hits);
+
+    ASSERT_EQ(fresh.size(), copied.size());
+    EXPECT_EQ(0, memcmp(fresh.data(), copied.data(), fresh.size()));
+    EXPECT_EQ(100u, m_surfaceEntries[0].SurfaceToken.DW1.SurfaceAllocationIndex);
+}
+
+TEST_F(RenderHalSurfaceStateCacheTest, ChangedSetupMisses)
+{
+    RENDERHAL_SURFACE              surface = GetNv12Surface(0);
+    RENDERHAL_SURFACE_STATE_PARAMS params;
+    MOS_ZeroMemory(&params, sizeof(params));
+    params.Type      = RENDERHAL_SURFACE_TYPE_G9;
+    params.MemObjCtl = 0x2;
+
+    PRENDERHAL_SURFACE_STATE_ENTRY entries[MHW_MAX_SURFACE_PLANES];
+    int32_t                        numEntries;
+    bool                           hit;
+
+    NewFrame();
+    ASSERT_EQ(MOS_STATUS_SUCCESS, SetupCached(&surface, &params, &numEntries, entries, &hit));
+    EXPECT_FALSE(hit);
+    ASSERT_EQ(MOS_STATUS_SUCCESS, SetupCached(&surface, &params, &numEntries, entries, &hit));
+    EXPECT_TRUE(hit);
+
+    RENDERHAL_SURFACE_STATE_PARAMS otherMocs = params;
+    otherMocs.MemObjCtl = 0x4;
+    ASSERT_EQ(MOS_STATUS_SUCCESS, SetupCached(&surface, &otherMocs, &numEntries, entries, &hit));
+    EXPECT_FALSE(hit);
+
+    RENDERHAL_SURFACE otherSize = surface;
+    otherSize.OsSurface.dwHeight = 720;
+    ASSERT_EQ(MOS_STATUS_SUCCESS, SetupCached(&otherSize, &params, &numEntries, entries, &hit));
+    EXPECT_FALSE(hit);
+
+    RENDERHAL_SURFACE otherRotation = surface;
+    otherRotation.Rotation = MHW_ROTATION_180;
+    ASSERT_EQ(MOS_STATUS_SUCCESS, SetupCached(&otherRotation, &params, &numEntries, entries, &hit));
+    EXPECT_FALSE(hit);
+
+    RENDERHAL_SURFACE otherResource = GetNv12Surface(1);
+    ASSERT_EQ(MOS_STATUS_SUCCESS, SetupCached(&otherResource, &params, &numEntries, entries, &hit));
+    EXPECT_FALSE(hit);
+
+    RENDERHAL_SURFACE_STATE_PARAMS avs = params;
+    avs.Type = RENDERHAL_SURFACE_TYPE_ADV_G9;
+    avs.bAVS = true;
+    ASSERT_EQ(MOS_STATUS_SUCCESS, SetupCached(&surface, &avs, &numEntries, entries, &hit));
+    EXPECT_FALSE(hit);
+    EXPECT_EQ(1, numEntries);
+}
+
+TEST_F(RenderHalSurfaceStateCacheTest, SetupTime)
+{
+    const uint32_t frames = 20000;
+
+    for (uint32_t layers : { 1u, 4u, 8u })
+    {
+        vector<RENDERHAL_SURFACE>              surfaces;
+        vector<RENDERHAL_SURFACE_STATE_PARAMS> params;
+        GetCompositeSurfaces(layers, surfaces, params);
+
+        uint32_t hits;
+        double   ns[2];
+        for (int cached = 0; cached < 2; cached++)
+        {
+            SetupFrame(surfaces, params, cached, &hits);
+
+            auto start = chrono::steady_clock::now();
+            for (uint32_t f = 0; f < frames; f++)
+            {
+                m_stateHeap.iCurrentSurfaceState = 0;
+                for (size_t i = 0; i < surfaces.size(); i++)
+                {
+                    PRENDERHAL_SURFACE_STATE_ENTRY entries[MHW_MAX_SURFACE_PLANES];
+                    int32_t                        numEntries;
+                    bool                           hit;
+                    if (cached)
+                    {
+                        SetupCached(&surfaces[i], &params[i], &numEntries, entries, &hit);
+                    }
+                    else
+                    {
+                        SetupSurfaceStateG9(&m_renderHal, &surfaces[i], &params[i], &numEntries, entries);
+                    }
+                }
+            }
+            ns[cached] = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / frames;
+        }
+
+        cout << "Surface state setup, " << layers << " layers: " << ns[0] << " ns per frame, cache: " << ns[1] << " ns" << endl;
+    }
+}